@@ -0,0 +1,402 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_CloudCheckCache.h"
+#include "GfnSdk_Threading.h"
+
+#include <string.h>
+
+// Cache entry 0 holds GfnCloudCheck results, entries 1 and up hold GfnGetCloudType results
+// for each requested cloud type.
+#define GFN_CC_CACHE_CLOUD_CHECK_ENTRY 0
+#define GFN_CC_CACHE_ENTRY_COUNT (1 + CC_CLOUD_TYPE_ANY + 1)
+
+typedef struct gfnCloudCheckCacheEntry
+{
+    bool valid;
+    bool inFlight;
+    uint64_t expiresMs;
+    unsigned int generation;        // Incremented every time an in-flight call completes
+    GfnRuntimeError status;         // Result of the most recent call
+    bool isCloudEnvironment;
+    GfnCloudType detectedCloudType;
+} gfnCloudCheckCacheEntry;
+
+// Callers waiting for their turn to call into the SDK, in arrival order
+typedef struct gfnCloudCheckCacheWaiter
+{
+    struct gfnCloudCheckCacheWaiter* pNext;
+} gfnCloudCheckCacheWaiter;
+
+typedef struct gfnCloudCheckCache
+{
+    bool initialized;
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+    GfnCloudCheckCacheConfig config;
+
+    gfnCloudCheckCacheEntry entries[GFN_CC_CACHE_ENTRY_COUNT];
+    gfnCloudCheckCacheWaiter* pWaitHead;
+    gfnCloudCheckCacheWaiter* pWaitTail;
+    bool callInProgress;
+    uint64_t nextCallAllowedMs;
+
+    GfnCloudCheckCacheStats stats;
+} gfnCloudCheckCache;
+
+static gfnCloudCheckCache s_gfnCcCache;
+
+// Must be called with the lock held
+static void gfnCloudCheckCacheRemoveWaiter(gfnCloudCheckCacheWaiter* pWaiter)
+{
+    gfnCloudCheckCacheWaiter** ppLink = &s_gfnCcCache.pWaitHead;
+    gfnCloudCheckCacheWaiter* pPrev = NULL;
+
+    while (*ppLink != NULL && *ppLink != pWaiter)
+    {
+        pPrev = *ppLink;
+        ppLink = &(*ppLink)->pNext;
+    }
+    if (*ppLink == NULL)
+    {
+        return;
+    }
+    *ppLink = pWaiter->pNext;
+    if (s_gfnCcCache.pWaitTail == pWaiter)
+    {
+        s_gfnCcCache.pWaitTail = pPrev;
+    }
+}
+
+// Must be called with the lock held. Waits until the caller is first in line, no other call is in
+// progress and the minimum interval since the previous call has elapsed. A caller retrying a
+// throttled call keeps its place at the head of the line instead of queueing behind later callers.
+static GfnRuntimeError gfnCloudCheckCacheAcquire(uint64_t deadlineMs, bool retry, bool* pWaited)
+{
+    gfnCloudCheckCacheWaiter waiter;
+    uint64_t now = 0;
+    uint64_t waitMs = 0;
+
+    waiter.pNext = NULL;
+    if (retry)
+    {
+        waiter.pNext = s_gfnCcCache.pWaitHead;
+        s_gfnCcCache.pWaitHead = &waiter;
+        if (s_gfnCcCache.pWaitTail == NULL)
+        {
+            s_gfnCcCache.pWaitTail = &waiter;
+        }
+    }
+    else
+    {
+        if (s_gfnCcCache.pWaitTail != NULL)
+        {
+            s_gfnCcCache.pWaitTail->pNext = &waiter;
+        }
+        else
+        {
+            s_gfnCcCache.pWaitHead = &waiter;
+        }
+        s_gfnCcCache.pWaitTail = &waiter;
+    }
+
+    for (;;)
+    {
+        now = gfnSdkGetTimeMs();
+        if (s_gfnCcCache.pWaitHead == &waiter && !s_gfnCcCache.callInProgress && now >= s_gfnCcCache.nextCallAllowedMs)
+        {
+            gfnCloudCheckCacheRemoveWaiter(&waiter);
+            s_gfnCcCache.callInProgress = true;
+            return gfnSuccess;
+        }
+        if (now >= deadlineMs)
+        {
+            gfnCloudCheckCacheRemoveWaiter(&waiter);
+            gfnSdkCondBroadcast(&s_gfnCcCache.cond);
+            return gfnTimedOut;
+        }
+
+        *pWaited = true;
+        waitMs = deadlineMs - now;
+        if (s_gfnCcCache.pWaitHead == &waiter && !s_gfnCcCache.callInProgress && s_gfnCcCache.nextCallAllowedMs - now < waitMs)
+        {
+            waitMs = s_gfnCcCache.nextCallAllowedMs - now;
+        }
+        gfnSdkCondTimedWait(&s_gfnCcCache.cond, &s_gfnCcCache.lock, (uint32_t)waitMs);
+    }
+}
+
+// Must be called with the lock held
+static void gfnCloudCheckCacheRelease(GfnRuntimeError status)
+{
+    uint64_t intervalMs = s_gfnCcCache.config.minCallIntervalMs;
+
+    if (status == gfnThrottled)
+    {
+        // The SDK counted calls we did not make, back off further before the next attempt
+        intervalMs *= 2;
+    }
+    s_gfnCcCache.callInProgress = false;
+    s_gfnCcCache.nextCallAllowedMs = gfnSdkGetTimeMs() + intervalMs;
+    gfnSdkCondBroadcast(&s_gfnCcCache.cond);
+}
+
+// Must be called with the lock held. The lock is released while calling into the SDK.
+static GfnRuntimeError gfnCloudCheckCachePacedCall(unsigned int entryIndex, const GfnCloudCheckChallenge* challenge,
+    GfnCloudCheckResponse* response, bool* pIsCloudEnvironment, GfnCloudType* pDetectedCloudType)
+{
+    uint64_t deadlineMs = gfnSdkGetTimeMs() + s_gfnCcCache.config.maxWaitMs;
+    GfnRuntimeError status = gfnSuccess;
+    bool waited = false;
+    bool retry = false;
+
+    for (;;)
+    {
+        waited = false;
+        status = gfnCloudCheckCacheAcquire(deadlineMs, retry, &waited);
+        if (GFNSDK_FAILED(status))
+        {
+            return status;
+        }
+        if (waited)
+        {
+            s_gfnCcCache.stats.paced++;
+            s_gfnCcCache.stats.throttleAvoided++;
+        }
+        gfnSdkMutexUnlock(&s_gfnCcCache.lock);
+
+        if (entryIndex == GFN_CC_CACHE_CLOUD_CHECK_ENTRY)
+        {
+            status = GfnCloudCheck(challenge, response, pIsCloudEnvironment);
+        }
+        else
+        {
+            status = GfnGetCloudType((GfnCloudType)(entryIndex - 1), challenge, response, pDetectedCloudType);
+        }
+
+        gfnSdkMutexLock(&s_gfnCcCache.lock);
+        gfnCloudCheckCacheRelease(status);
+        if (status != gfnThrottled)
+        {
+            return status;
+        }
+        s_gfnCcCache.stats.throttledRetries++;
+        retry = true;
+    }
+}
+
+// Serves a call without challenge or response from the cache, from another caller's in-flight
+// call, or by making the call and publishing its result.
+static GfnRuntimeError gfnCloudCheckCacheSharedCall(unsigned int entryIndex, bool* pIsCloudEnvironment, GfnCloudType* pDetectedCloudType)
+{
+    gfnCloudCheckCacheEntry* pEntry = &s_gfnCcCache.entries[entryIndex];
+    GfnRuntimeError status = gfnSuccess;
+    bool isCloudEnvironment = false;
+    GfnCloudType detectedCloudType = CC_CLOUD_TYPE_NULL;
+    unsigned int generation = 0;
+    uint64_t now = 0;
+
+    gfnSdkMutexLock(&s_gfnCcCache.lock);
+    now = gfnSdkGetTimeMs();
+    if (pEntry->valid && now < pEntry->expiresMs)
+    {
+        s_gfnCcCache.stats.hits++;
+        if (s_gfnCcCache.callInProgress || now < s_gfnCcCache.nextCallAllowedMs)
+        {
+            s_gfnCcCache.stats.throttleAvoided++;
+        }
+    }
+    else if (pEntry->inFlight)
+    {
+        s_gfnCcCache.stats.coalesced++;
+        s_gfnCcCache.stats.throttleAvoided++;
+        generation = pEntry->generation;
+        while (pEntry->generation == generation)
+        {
+            gfnSdkCondWait(&s_gfnCcCache.cond, &s_gfnCcCache.lock);
+        }
+    }
+    else
+    {
+        s_gfnCcCache.stats.misses++;
+        pEntry->inFlight = true;
+        status = gfnCloudCheckCachePacedCall(entryIndex, NULL, NULL, &isCloudEnvironment, &detectedCloudType);
+
+        pEntry->inFlight = false;
+        pEntry->generation++;
+        pEntry->status = status;
+        pEntry->isCloudEnvironment = isCloudEnvironment;
+        pEntry->detectedCloudType = detectedCloudType;
+        // Only successful results are worth reusing, failures are reported to the callers
+        // that shared this call and the next caller tries again
+        pEntry->valid = GFNSDK_SUCCEEDED(status);
+        pEntry->expiresMs = gfnSdkGetTimeMs() + s_gfnCcCache.config.resultTtlMs;
+        gfnSdkCondBroadcast(&s_gfnCcCache.cond);
+    }
+
+    status = pEntry->status;
+    if (pIsCloudEnvironment != NULL)
+    {
+        *pIsCloudEnvironment = pEntry->isCloudEnvironment;
+    }
+    if (pDetectedCloudType != NULL)
+    {
+        *pDetectedCloudType = pEntry->detectedCloudType;
+    }
+    gfnSdkMutexUnlock(&s_gfnCcCache.lock);
+    return status;
+}
+
+GfnRuntimeError GfnCloudCheckCacheInitialize(const GfnCloudCheckCacheConfig* pConfig)
+{
+    if (s_gfnCcCache.initialized)
+    {
+        return gfnInvalidParameter;
+    }
+
+    memset(&s_gfnCcCache, 0, sizeof(s_gfnCcCache));
+    if (pConfig != NULL)
+    {
+        s_gfnCcCache.config = *pConfig;
+    }
+    if (s_gfnCcCache.config.resultTtlMs == 0)
+    {
+        s_gfnCcCache.config.resultTtlMs = GFN_CLOUD_CHECK_CACHE_DEFAULT_TTL_MS;
+    }
+    if (s_gfnCcCache.config.minCallIntervalMs == 0)
+    {
+        s_gfnCcCache.config.minCallIntervalMs = GFN_CLOUD_CHECK_CACHE_DEFAULT_INTERVAL_MS;
+    }
+    if (s_gfnCcCache.config.maxWaitMs == 0)
+    {
+        s_gfnCcCache.config.maxWaitMs = GFN_CLOUD_CHECK_CACHE_DEFAULT_MAX_WAIT_MS;
+    }
+
+    if (!gfnSdkMutexInit(&s_gfnCcCache.lock))
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkCondInit(&s_gfnCcCache.cond))
+    {
+        gfnSdkMutexDestroy(&s_gfnCcCache.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnCcCache.initialized = true;
+    return gfnSuccess;
+}
+
+void GfnCloudCheckCacheShutdown(void)
+{
+    if (!s_gfnCcCache.initialized)
+    {
+        return;
+    }
+    s_gfnCcCache.initialized = false;
+    gfnSdkCondDestroy(&s_gfnCcCache.cond);
+    gfnSdkMutexDestroy(&s_gfnCcCache.lock);
+}
+
+GfnRuntimeError GfnCloudCheckCached(const GfnCloudCheckChallenge* challenge, GfnCloudCheckResponse* response, bool* isCloudEnvironment)
+{
+    GfnRuntimeError status = gfnSuccess;
+    bool localIsCloudEnvironment = false;
+
+    if (!s_gfnCcCache.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (challenge == NULL && response == NULL)
+    {
+        return gfnCloudCheckCacheSharedCall(GFN_CC_CACHE_CLOUD_CHECK_ENTRY, isCloudEnvironment, NULL);
+    }
+
+    gfnSdkMutexLock(&s_gfnCcCache.lock);
+    status = gfnCloudCheckCachePacedCall(GFN_CC_CACHE_CLOUD_CHECK_ENTRY, challenge, response, &localIsCloudEnvironment, NULL);
+    gfnSdkMutexUnlock(&s_gfnCcCache.lock);
+    if (isCloudEnvironment != NULL)
+    {
+        *isCloudEnvironment = localIsCloudEnvironment;
+    }
+    return status;
+}
+
+GfnRuntimeError GfnGetCloudTypeCached(GfnCloudType requested_cloud_type, const GfnCloudCheckChallenge* challenge,
+    GfnCloudCheckResponse* response, GfnCloudType* detected_cloud_type)
+{
+    GfnRuntimeError status = gfnSuccess;
+    unsigned int entryIndex = 1 + (unsigned int)requested_cloud_type;
+
+    if (!s_gfnCcCache.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (detected_cloud_type == NULL || entryIndex >= GFN_CC_CACHE_ENTRY_COUNT)
+    {
+        return gfnInvalidParameter;
+    }
+    if (challenge == NULL && response == NULL)
+    {
+        return gfnCloudCheckCacheSharedCall(entryIndex, NULL, detected_cloud_type);
+    }
+
+    gfnSdkMutexLock(&s_gfnCcCache.lock);
+    status = gfnCloudCheckCachePacedCall(entryIndex, challenge, response, NULL, detected_cloud_type);
+    gfnSdkMutexUnlock(&s_gfnCcCache.lock);
+    return status;
+}
+
+void GfnCloudCheckCacheInvalidate(void)
+{
+    unsigned int i = 0;
+
+    if (!s_gfnCcCache.initialized)
+    {
+        return;
+    }
+    gfnSdkMutexLock(&s_gfnCcCache.lock);
+    for (i = 0; i < GFN_CC_CACHE_ENTRY_COUNT; i++)
+    {
+        s_gfnCcCache.entries[i].valid = false;
+    }
+    gfnSdkMutexUnlock(&s_gfnCcCache.lock);
+}
+
+void GfnCloudCheckCacheGetStats(GfnCloudCheckCacheStats* pStats)
+{
+    if (pStats == NULL)
+    {
+        return;
+    }
+    if (!s_gfnCcCache.initialized)
+    {
+        memset(pStats, 0, sizeof(*pStats));
+        return;
+    }
+    gfnSdkMutexLock(&s_gfnCcCache.lock);
+    *pStats = s_gfnCcCache.stats;
+    gfnSdkMutexUnlock(&s_gfnCcCache.lock);
+}
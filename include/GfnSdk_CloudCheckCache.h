@@ -0,0 +1,191 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Single-flight and TTL caching layer for GfnCloudCheck and GfnGetCloudType
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_CloudCheckCache.h
+*
+* Optional single-flight and caching layer for the Cloud Check APIs
+*/
+///
+/// @page cloud_check_cache Cloud Check Cache
+///
+/// @section cloud_check_cache_introduction Introduction
+/// @ref GfnCloudCheck and @ref GfnGetCloudType are rate limited, and fail with gfnThrottled when
+/// called in rapid succession. Titles where several subsystems perform cloud checks independently
+/// can use the functions in this header instead, which share calls between subsystems:
+///
+/// - Calls without a challenge and without a response are answered from a cache for
+///   @ref GfnCloudCheckCacheConfig::resultTtlMs after a successful call. If no cached result is
+///   available, concurrent callers share a single in-flight call and all receive its result.
+/// - Calls with a challenge or a response need their own attestation data, so they are never
+///   shared. Instead, they are queued in arrival order and paced so that calls into the SDK are
+///   at least @ref GfnCloudCheckCacheConfig::minCallIntervalMs apart. If the SDK still reports
+///   gfnThrottled, the call is retried after a back-off, ahead of later callers, until
+///   @ref GfnCloudCheckCacheConfig::maxWaitMs has elapsed.
+///
+/// All functions block the calling thread until a result is available, like the functions they wrap.
+///
+
+#ifndef __NV_GFNSDK_CLOUD_CHECK_CACHE_H__
+#define __NV_GFNSDK_CLOUD_CHECK_CACHE_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Default for @ref GfnCloudCheckCacheConfig::resultTtlMs
+#define GFN_CLOUD_CHECK_CACHE_DEFAULT_TTL_MS 60000
+/// @brief Default for @ref GfnCloudCheckCacheConfig::minCallIntervalMs
+#define GFN_CLOUD_CHECK_CACHE_DEFAULT_INTERVAL_MS 1000
+/// @brief Default for @ref GfnCloudCheckCacheConfig::maxWaitMs
+#define GFN_CLOUD_CHECK_CACHE_DEFAULT_MAX_WAIT_MS 30000
+
+/// @brief Configuration passed to @ref GfnCloudCheckCacheInitialize. Zero selects the default for any field.
+typedef struct GfnCloudCheckCacheConfig
+{
+    unsigned int resultTtlMs;        ///< Time a successful result of a call without challenge is reused
+    unsigned int minCallIntervalMs;  ///< Minimum time between two calls into the SDK
+    unsigned int maxWaitMs;          ///< Maximum time a call waits for its turn, including retries after gfnThrottled
+} GfnCloudCheckCacheConfig;
+
+/// @brief Counters returned by @ref GfnCloudCheckCacheGetStats
+typedef struct GfnCloudCheckCacheStats
+{
+    unsigned int hits;              ///< Calls without challenge answered from the cache
+    unsigned int misses;            ///< Calls without challenge that had to call into the SDK
+    unsigned int coalesced;         ///< Calls without challenge that shared another caller's in-flight call
+    unsigned int paced;             ///< Calls delayed to respect the minimum call interval
+    unsigned int throttledRetries;  ///< Calls into the SDK that returned gfnThrottled and were retried
+    unsigned int throttleAvoided;   ///< Calls that would have reached the SDK within the minimum call interval
+                                    ///< of another call, but were answered from the cache, coalesced, or paced instead
+} GfnCloudCheckCacheStats;
+
+///
+/// @par Description
+/// Initializes the cloud check cache.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pConfig                    - Optional configuration. NULL selects the defaults.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - The cache is already initialized
+/// @retval gfnUnableToAllocateMemory - Synchronization primitives could not be created
+GfnRuntimeError GfnCloudCheckCacheInitialize(const GfnCloudCheckCacheConfig* pConfig);
+
+///
+/// @par Description
+/// Shuts down the cloud check cache.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Must not be called while other threads are inside the functions of this header.
+void GfnCloudCheckCacheShutdown(void);
+
+///
+/// @par Description
+/// Same as @ref GfnCloudCheck, with calls shared, cached and paced as described in @ref cloud_check_cache.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param challenge                 - Optional challenge. Calls with a challenge are never shared or cached.
+/// @param response                  - Optional response. Calls with a response are never shared or cached.
+///                                    The caller owns the returned attestation data and must free it with @ref GfnFree.
+/// @param isCloudEnvironment        - Optional output parameter, that receives true value if the caller is in the GFN environment.
+///
+/// @retval gfnAPINotInit            - @ref GfnCloudCheckCacheInitialize was not called
+/// @retval gfnTimedOut              - The call could not be made within @ref GfnCloudCheckCacheConfig::maxWaitMs
+/// @return Otherwise, the result of @ref GfnCloudCheck
+GfnRuntimeError GfnCloudCheckCached(const GfnCloudCheckChallenge* challenge, GfnCloudCheckResponse* response, bool* isCloudEnvironment);
+
+///
+/// @par Description
+/// Same as @ref GfnGetCloudType, with calls shared, cached and paced as described in @ref cloud_check_cache.
+/// Results are cached separately for each requested cloud type.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows
+///
+/// @retval gfnAPINotInit            - @ref GfnCloudCheckCacheInitialize was not called
+/// @retval gfnTimedOut              - The call could not be made within @ref GfnCloudCheckCacheConfig::maxWaitMs
+/// @return Otherwise, the result of @ref GfnGetCloudType
+GfnRuntimeError GfnGetCloudTypeCached(GfnCloudType requested_cloud_type, const GfnCloudCheckChallenge* challenge,
+    GfnCloudCheckResponse* response, GfnCloudType* detected_cloud_type);
+
+///
+/// @par Description
+/// Discards all cached results, so that the next call without challenge calls into the SDK.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+void GfnCloudCheckCacheInvalidate(void);
+
+///
+/// @par Description
+/// Returns a snapshot of the cache counters.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pStats                    - Receives the counters
+void GfnCloudCheckCacheGetStats(GfnCloudCheckCacheStats* pStats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_CLOUD_CHECK_CACHE_H__
@@ -0,0 +1,914 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#ifdef __linux__
+// readahead
+#   define _GNU_SOURCE
+#endif
+
+#include "GfnSdk_InstallPrefetch.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#define GFN_PREFETCH_DEFAULT_MANIFEST "gfn_prefetch_manifest.txt"
+#define GFN_PREFETCH_DEFAULT_THREADS 4
+#define GFN_PREFETCH_MAX_THREADS 16
+#define GFN_PREFETCH_DEFAULT_BUDGET_BYTES (1024ULL * 1024 * 1024)
+#define GFN_PREFETCH_DEFAULT_BUDGET_MS 60000
+// Reads are issued in chunks of this size, so that the budgets and shutdown are checked often
+#define GFN_PREFETCH_CHUNK_SIZE (4 * 1024 * 1024)
+#define GFN_PREFETCH_MAX_MANIFEST_SIZE (64 * 1024 * 1024)
+
+typedef struct gfnPrefetchFile
+{
+    char* pchPath;
+    int priority;
+    unsigned int line;
+    uint64_t bytes;                     // 0 for the whole file
+} gfnPrefetchFile;
+
+typedef struct gfnPrefetchRecord
+{
+    char* pchPath;
+    uint64_t extent;
+} gfnPrefetchRecord;
+
+typedef struct gfnInstallPrefetch
+{
+    bool initialized;
+    bool stopping;
+    GfnInstallPrefetchConfig config;
+    char* pchManifestPath;
+
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+
+    gfnPrefetchFile* pFiles;
+    unsigned int numFiles;
+    unsigned int nextFile;
+    bool budgetExhausted;
+    uint64_t bytesReserved;
+    uint64_t beginMs;
+    uint64_t endMs;
+    unsigned int numRunning;
+    GfnSdkThread threads[GFN_PREFETCH_MAX_THREADS];
+    unsigned int numThreads;
+
+    // Accesses recorded during a profiling run, in the order the files were first accessed, and
+    // an open addressing index over them holding record index + 1
+    gfnPrefetchRecord* pRecords;
+    unsigned int numRecords;
+    unsigned int recordsCapacity;
+    uint32_t* pRecordIndex;
+    uint32_t recordIndexSize;           // Power of two
+
+    GfnInstallPrefetchStats stats;
+} gfnInstallPrefetch;
+
+static gfnInstallPrefetch s_gfnPrefetch;
+
+static char* gfnPrefetchCopyString(const char* pchString, size_t length)
+{
+    char* pchCopy = (char*)malloc(length + 1);
+
+    if (pchCopy != NULL)
+    {
+        memcpy(pchCopy, pchString, length);
+        pchCopy[length] = '\0';
+    }
+    return pchCopy;
+}
+
+static bool gfnPrefetchIsAbsolute(const char* pchPath)
+{
+#ifdef _WIN32
+    if (((pchPath[0] >= 'A' && pchPath[0] <= 'Z') || (pchPath[0] >= 'a' && pchPath[0] <= 'z')) && pchPath[1] == ':')
+    {
+        return true;
+    }
+    return pchPath[0] == '\\' || pchPath[0] == '/';
+#else
+    return pchPath[0] == '/';
+#endif
+}
+
+static bool gfnPrefetchIsSeparator(char c)
+{
+#ifdef _WIN32
+    return c == '\\' || c == '/';
+#else
+    return c == '/';
+#endif
+}
+
+// Returns pchPath as is if it is absolute, else joined to pchBase
+static char* gfnPrefetchResolvePath(const char* pchBase, const char* pchPath, size_t pathLength)
+{
+    size_t baseLength = strlen(pchBase);
+    bool separator = false;
+    char* pchResolved = NULL;
+
+    if (gfnPrefetchIsAbsolute(pchPath) || baseLength == 0)
+    {
+        return gfnPrefetchCopyString(pchPath, pathLength);
+    }
+    separator = !gfnPrefetchIsSeparator(pchBase[baseLength - 1]);
+    pchResolved = (char*)malloc(baseLength + (separator ? 1 : 0) + pathLength + 1);
+    if (pchResolved != NULL)
+    {
+        memcpy(pchResolved, pchBase, baseLength);
+        if (separator)
+        {
+            pchResolved[baseLength] = '/';
+        }
+        memcpy(pchResolved + baseLength + (separator ? 1 : 0), pchPath, pathLength);
+        pchResolved[baseLength + (separator ? 1 : 0) + pathLength] = '\0';
+    }
+    return pchResolved;
+}
+
+static int gfnPrefetchCompareFiles(const void* pA, const void* pB)
+{
+    const gfnPrefetchFile* pFileA = (const gfnPrefetchFile*)pA;
+    const gfnPrefetchFile* pFileB = (const gfnPrefetchFile*)pB;
+
+    if (pFileA->priority != pFileB->priority)
+    {
+        return pFileA->priority > pFileB->priority ? -1 : 1;
+    }
+    return pFileA->line < pFileB->line ? -1 : (pFileA->line > pFileB->line ? 1 : 0);
+}
+
+static void gfnPrefetchFreeFiles(void)
+{
+    unsigned int i = 0;
+
+    for (i = 0; i < s_gfnPrefetch.numFiles; i++)
+    {
+        free(s_gfnPrefetch.pFiles[i].pchPath);
+    }
+    free(s_gfnPrefetch.pFiles);
+    s_gfnPrefetch.pFiles = NULL;
+    s_gfnPrefetch.numFiles = 0;
+}
+
+static char* gfnPrefetchReadText(const char* pchPath)
+{
+    FILE* pFile = fopen(pchPath, "rb");
+    long size = 0;
+    char* pchText = NULL;
+
+    if (pFile == NULL)
+    {
+        return NULL;
+    }
+    if (fseek(pFile, 0, SEEK_END) == 0)
+    {
+        size = ftell(pFile);
+    }
+    if (size >= 0 && size <= GFN_PREFETCH_MAX_MANIFEST_SIZE && fseek(pFile, 0, SEEK_SET) == 0)
+    {
+        pchText = (char*)malloc((size_t)size + 1);
+        if (pchText != NULL)
+        {
+            if (fread(pchText, 1, (size_t)size, pFile) == (size_t)size)
+            {
+                pchText[size] = '\0';
+            }
+            else
+            {
+                free(pchText);
+                pchText = NULL;
+            }
+        }
+    }
+    fclose(pFile);
+    return pchText;
+}
+
+// Parses the manifest into s_gfnPrefetch.pFiles, sorted highest priority first
+static GfnRuntimeError gfnPrefetchLoadManifest(const char* pchBuildPath)
+{
+    char* pchManifestPath = NULL;
+    char* pchText = NULL;
+    char* pchLine = NULL;
+    char* pchNext = NULL;
+    char* pchEnd = NULL;
+    char* pchPath = NULL;
+    size_t pathLength = 0;
+    unsigned int capacity = 0;
+    unsigned int line = 0;
+    long priority = 0;
+    unsigned long long bytes = 0;
+    gfnPrefetchFile* pGrown = NULL;
+    GfnRuntimeError result = gfnSuccess;
+
+    pchManifestPath = gfnPrefetchResolvePath(pchBuildPath, s_gfnPrefetch.pchManifestPath, strlen(s_gfnPrefetch.pchManifestPath));
+    if (pchManifestPath == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    pchText = gfnPrefetchReadText(pchManifestPath);
+    free(pchManifestPath);
+    if (pchText == NULL)
+    {
+        return gfnNoData;
+    }
+
+    for (pchLine = pchText; pchLine != NULL && result == gfnSuccess; pchLine = pchNext)
+    {
+        line++;
+        pchNext = strchr(pchLine, '\n');
+        if (pchNext != NULL)
+        {
+            *pchNext++ = '\0';
+        }
+        while (*pchLine == ' ' || *pchLine == '\t')
+        {
+            pchLine++;
+        }
+        if (*pchLine == '\0' || *pchLine == '#' || *pchLine == '\r')
+        {
+            continue;
+        }
+
+        priority = strtol(pchLine, &pchEnd, 10);
+        if (pchEnd == pchLine)
+        {
+            continue;
+        }
+        pchLine = pchEnd;
+        bytes = strtoull(pchLine, &pchEnd, 10);
+        if (pchEnd == pchLine)
+        {
+            continue;
+        }
+        pchPath = pchEnd;
+        while (*pchPath == ' ' || *pchPath == '\t')
+        {
+            pchPath++;
+        }
+        pathLength = strlen(pchPath);
+        while (pathLength > 0 && (pchPath[pathLength - 1] == '\r' || pchPath[pathLength - 1] == ' ' || pchPath[pathLength - 1] == '\t'))
+        {
+            pathLength--;
+        }
+        if (pathLength == 0)
+        {
+            continue;
+        }
+
+        if (s_gfnPrefetch.numFiles == capacity)
+        {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            pGrown = (gfnPrefetchFile*)realloc(s_gfnPrefetch.pFiles, capacity * sizeof(gfnPrefetchFile));
+            if (pGrown == NULL)
+            {
+                result = gfnUnableToAllocateMemory;
+                break;
+            }
+            s_gfnPrefetch.pFiles = pGrown;
+        }
+        s_gfnPrefetch.pFiles[s_gfnPrefetch.numFiles].pchPath = gfnPrefetchResolvePath(pchBuildPath, pchPath, pathLength);
+        if (s_gfnPrefetch.pFiles[s_gfnPrefetch.numFiles].pchPath == NULL)
+        {
+            result = gfnUnableToAllocateMemory;
+            break;
+        }
+        s_gfnPrefetch.pFiles[s_gfnPrefetch.numFiles].priority = (int)priority;
+        s_gfnPrefetch.pFiles[s_gfnPrefetch.numFiles].line = line;
+        s_gfnPrefetch.pFiles[s_gfnPrefetch.numFiles].bytes = bytes;
+        s_gfnPrefetch.numFiles++;
+    }
+    free(pchText);
+
+    if (result != gfnSuccess)
+    {
+        gfnPrefetchFreeFiles();
+        return result;
+    }
+    if (s_gfnPrefetch.numFiles == 0)
+    {
+        return gfnNoData;
+    }
+    qsort(s_gfnPrefetch.pFiles, s_gfnPrefetch.numFiles, sizeof(gfnPrefetchFile), gfnPrefetchCompareFiles);
+    return gfnSuccess;
+}
+
+// Reserves the next chunk of a file against the budgets. Returns 0 when nothing more should be read.
+static uint64_t gfnPrefetchReserve(uint64_t remaining)
+{
+    uint64_t chunk = remaining < GFN_PREFETCH_CHUNK_SIZE ? remaining : GFN_PREFETCH_CHUNK_SIZE;
+
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    if (s_gfnPrefetch.stopping || s_gfnPrefetch.budgetExhausted)
+    {
+        chunk = 0;
+    }
+    else if (s_gfnPrefetch.bytesReserved >= s_gfnPrefetch.config.budgetBytes
+        || gfnSdkGetTimeMs() - s_gfnPrefetch.beginMs >= s_gfnPrefetch.config.budgetMs)
+    {
+        s_gfnPrefetch.budgetExhausted = true;
+        chunk = 0;
+    }
+    else
+    {
+        if (chunk > s_gfnPrefetch.config.budgetBytes - s_gfnPrefetch.bytesReserved)
+        {
+            chunk = s_gfnPrefetch.config.budgetBytes - s_gfnPrefetch.bytesReserved;
+        }
+        s_gfnPrefetch.bytesReserved += chunk;
+    }
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+    return chunk;
+}
+
+static void gfnPrefetchRelease(uint64_t chunk, bool prefetched)
+{
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    if (prefetched)
+    {
+        s_gfnPrefetch.stats.bytesPrefetched += chunk;
+    }
+    else
+    {
+        s_gfnPrefetch.bytesReserved -= chunk;
+    }
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+}
+
+// Brings up to bytes bytes from the start of the file into the page cache. Returns false if the
+// file could not be opened, and the bytes prefetched in *pPrefetched.
+static bool gfnPrefetchFileData(const gfnPrefetchFile* pFile, unsigned char* pBuffer, uint64_t* pPrefetched)
+{
+    uint64_t size = 0;
+    uint64_t offset = 0;
+    uint64_t chunk = 0;
+    bool prefetched = false;
+#ifdef _WIN32
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    LARGE_INTEGER fileSize;
+    DWORD toRead = 0;
+    DWORD read = 0;
+    uint64_t done = 0;
+#elif __linux__
+    int fd = -1;
+    struct stat fileStat;
+#endif
+
+    *pPrefetched = 0;
+#ifdef _WIN32
+    // Windows has no way to populate the file cache without reading, so the file is read
+    // sequentially into a scratch buffer, which the cache manager follows with read-ahead
+    hFile = CreateFileA(pFile->pchPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    if (GetFileSizeEx(hFile, &fileSize))
+    {
+        size = (uint64_t)fileSize.QuadPart;
+    }
+#elif __linux__
+    fd = open(pFile->pchPath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (fstat(fd, &fileStat) == 0)
+    {
+        size = (uint64_t)fileStat.st_size;
+    }
+#endif
+    if (pFile->bytes != 0 && pFile->bytes < size)
+    {
+        size = pFile->bytes;
+    }
+
+    while (offset < size)
+    {
+        chunk = gfnPrefetchReserve(size - offset);
+        if (chunk == 0)
+        {
+            break;
+        }
+#ifdef _WIN32
+        (void)prefetched;
+        for (done = 0; done < chunk; done += read)
+        {
+            toRead = (DWORD)(chunk - done < GFN_PREFETCH_CHUNK_SIZE ? chunk - done : GFN_PREFETCH_CHUNK_SIZE);
+            if (!ReadFile(hFile, pBuffer, toRead, &read, NULL) || read == 0)
+            {
+                break;
+            }
+        }
+        prefetched = done == chunk;
+#elif __linux__
+        (void)pBuffer;
+        // readahead waits for the reads to be queued, which keeps the I/O threads from flooding
+        // the device. File systems without readahead support get the advisory hint instead.
+        prefetched = readahead(fd, (off64_t)offset, (size_t)chunk) == 0
+            || posix_fadvise(fd, (off_t)offset, (off_t)chunk, POSIX_FADV_WILLNEED) == 0;
+#endif
+        gfnPrefetchRelease(chunk, prefetched);
+        if (!prefetched)
+        {
+            break;
+        }
+        offset += chunk;
+        *pPrefetched += chunk;
+    }
+
+#ifdef _WIN32
+    CloseHandle(hFile);
+#elif __linux__
+    close(fd);
+#endif
+    return true;
+}
+
+// Drops a reference on the running prefetch and finishes it with the last one. Called with the lock held.
+static void gfnPrefetchLeave(void)
+{
+    if (--s_gfnPrefetch.numRunning == 0)
+    {
+        s_gfnPrefetch.stats.numSkipped += s_gfnPrefetch.numFiles - s_gfnPrefetch.nextFile;
+        s_gfnPrefetch.endMs = gfnSdkGetTimeMs();
+        s_gfnPrefetch.stats.finished = true;
+        gfnSdkCondBroadcast(&s_gfnPrefetch.cond);
+    }
+}
+
+static void gfnPrefetchThread(void* pContext)
+{
+    gfnPrefetchFile* pFile = NULL;
+    unsigned char* pBuffer = NULL;
+    uint64_t prefetched = 0;
+    bool opened = false;
+
+    (void)pContext;
+#ifdef _WIN32
+    pBuffer = (unsigned char*)malloc(GFN_PREFETCH_CHUNK_SIZE);
+#endif
+
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    while (!s_gfnPrefetch.stopping && !s_gfnPrefetch.budgetExhausted && s_gfnPrefetch.nextFile < s_gfnPrefetch.numFiles)
+    {
+        pFile = &s_gfnPrefetch.pFiles[s_gfnPrefetch.nextFile++];
+        gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+
+#ifdef _WIN32
+        opened = pBuffer != NULL && gfnPrefetchFileData(pFile, pBuffer, &prefetched);
+#else
+        opened = gfnPrefetchFileData(pFile, pBuffer, &prefetched);
+#endif
+
+        gfnSdkMutexLock(&s_gfnPrefetch.lock);
+        if (!opened)
+        {
+            s_gfnPrefetch.stats.numMissing++;
+        }
+        else if (prefetched > 0)
+        {
+            s_gfnPrefetch.stats.numPrefetched++;
+        }
+        else if (s_gfnPrefetch.budgetExhausted)
+        {
+            s_gfnPrefetch.stats.numSkipped++;
+        }
+    }
+
+    gfnPrefetchLeave();
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+    free(pBuffer);
+}
+
+static GfnApplicationCallbackResult GFN_CALLBACK gfnPrefetchOnInstall(const TitleInstallationInformation* pInfo, void* pContext)
+{
+    (void)pContext;
+
+    if (pInfo != NULL && pInfo->pchBuildPath != NULL)
+    {
+        GfnInstallPrefetchBegin(pInfo->pchBuildPath);
+    }
+    if (s_gfnPrefetch.config.installCallback != NULL)
+    {
+        return s_gfnPrefetch.config.installCallback(pInfo, s_gfnPrefetch.config.pInstallContext);
+    }
+    return crCallbackSuccess;
+}
+
+static uint32_t gfnPrefetchHashPath(const char* pchPath)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*pchPath != '\0')
+    {
+        hash = (hash ^ (unsigned char)*pchPath++) * 16777619u;
+    }
+    return hash;
+}
+
+// Grows the record index to newSize slots and reinserts every record
+static bool gfnPrefetchGrowRecordIndex(uint32_t newSize)
+{
+    uint32_t* pIndex = (uint32_t*)calloc(newSize, sizeof(uint32_t));
+    uint32_t slot = 0;
+    unsigned int i = 0;
+
+    if (pIndex == NULL)
+    {
+        return false;
+    }
+    for (i = 0; i < s_gfnPrefetch.numRecords; i++)
+    {
+        slot = gfnPrefetchHashPath(s_gfnPrefetch.pRecords[i].pchPath) & (newSize - 1);
+        while (pIndex[slot] != 0)
+        {
+            slot = (slot + 1) & (newSize - 1);
+        }
+        pIndex[slot] = i + 1;
+    }
+    free(s_gfnPrefetch.pRecordIndex);
+    s_gfnPrefetch.pRecordIndex = pIndex;
+    s_gfnPrefetch.recordIndexSize = newSize;
+    return true;
+}
+
+static void gfnPrefetchFreeRecords(void)
+{
+    unsigned int i = 0;
+
+    for (i = 0; i < s_gfnPrefetch.numRecords; i++)
+    {
+        free(s_gfnPrefetch.pRecords[i].pchPath);
+    }
+    free(s_gfnPrefetch.pRecords);
+    free(s_gfnPrefetch.pRecordIndex);
+    s_gfnPrefetch.pRecords = NULL;
+    s_gfnPrefetch.pRecordIndex = NULL;
+    s_gfnPrefetch.numRecords = 0;
+    s_gfnPrefetch.recordsCapacity = 0;
+    s_gfnPrefetch.recordIndexSize = 0;
+}
+
+GfnRuntimeError GfnInstallPrefetchInitialize(const GfnInstallPrefetchConfig* pConfig)
+{
+    const char* pchManifestPath = NULL;
+
+    if (s_gfnPrefetch.initialized)
+    {
+        return gfnInvalidParameter;
+    }
+
+    memset(&s_gfnPrefetch, 0, sizeof(s_gfnPrefetch));
+    if (pConfig != NULL)
+    {
+        s_gfnPrefetch.config = *pConfig;
+    }
+    if (s_gfnPrefetch.config.numThreads == 0)
+    {
+        s_gfnPrefetch.config.numThreads = GFN_PREFETCH_DEFAULT_THREADS;
+    }
+    else if (s_gfnPrefetch.config.numThreads > GFN_PREFETCH_MAX_THREADS)
+    {
+        s_gfnPrefetch.config.numThreads = GFN_PREFETCH_MAX_THREADS;
+    }
+    if (s_gfnPrefetch.config.budgetBytes == 0)
+    {
+        s_gfnPrefetch.config.budgetBytes = GFN_PREFETCH_DEFAULT_BUDGET_BYTES;
+    }
+    if (s_gfnPrefetch.config.budgetMs == 0)
+    {
+        s_gfnPrefetch.config.budgetMs = GFN_PREFETCH_DEFAULT_BUDGET_MS;
+    }
+    pchManifestPath = s_gfnPrefetch.config.pchManifestPath != NULL ? s_gfnPrefetch.config.pchManifestPath : GFN_PREFETCH_DEFAULT_MANIFEST;
+    s_gfnPrefetch.pchManifestPath = gfnPrefetchCopyString(pchManifestPath, strlen(pchManifestPath));
+    s_gfnPrefetch.config.pchManifestPath = s_gfnPrefetch.pchManifestPath;
+    if (s_gfnPrefetch.pchManifestPath == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkMutexInit(&s_gfnPrefetch.lock))
+    {
+        free(s_gfnPrefetch.pchManifestPath);
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkCondInit(&s_gfnPrefetch.cond))
+    {
+        gfnSdkMutexDestroy(&s_gfnPrefetch.lock);
+        free(s_gfnPrefetch.pchManifestPath);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnPrefetch.stats.manifestResult = gfnSuccess;
+    s_gfnPrefetch.initialized = true;
+    return gfnSuccess;
+}
+
+void GfnInstallPrefetchShutdown(void)
+{
+    unsigned int i = 0;
+
+    if (!s_gfnPrefetch.initialized)
+    {
+        return;
+    }
+
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    s_gfnPrefetch.stopping = true;
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+    for (i = 0; i < s_gfnPrefetch.numThreads; i++)
+    {
+        gfnSdkThreadJoin(s_gfnPrefetch.threads[i]);
+    }
+    gfnPrefetchFreeFiles();
+    gfnPrefetchFreeRecords();
+    free(s_gfnPrefetch.pchManifestPath);
+
+    s_gfnPrefetch.initialized = false;
+    gfnSdkCondDestroy(&s_gfnPrefetch.cond);
+    gfnSdkMutexDestroy(&s_gfnPrefetch.lock);
+    memset(&s_gfnPrefetch, 0, sizeof(s_gfnPrefetch));
+}
+
+GfnRuntimeError GfnInstallPrefetchStart(void)
+{
+    if (!s_gfnPrefetch.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (s_gfnPrefetch.config.manualCallback)
+    {
+        return gfnInvalidParameter;
+    }
+    return GfnRegisterInstallCallback(gfnPrefetchOnInstall, NULL);
+}
+
+GfnRuntimeError GfnInstallPrefetchBegin(const char* pchBuildPath)
+{
+    unsigned int i = 0;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (!s_gfnPrefetch.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pchBuildPath == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    if (s_gfnPrefetch.stats.started || s_gfnPrefetch.stopping)
+    {
+        gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+        return gfnInvalidParameter;
+    }
+    s_gfnPrefetch.stats.started = true;
+    s_gfnPrefetch.beginMs = gfnSdkGetTimeMs();
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+
+    result = gfnPrefetchLoadManifest(pchBuildPath);
+
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    s_gfnPrefetch.stats.manifestResult = result;
+    s_gfnPrefetch.stats.numFiles = s_gfnPrefetch.numFiles;
+    if (result != gfnSuccess)
+    {
+        s_gfnPrefetch.endMs = gfnSdkGetTimeMs();
+        s_gfnPrefetch.stats.finished = true;
+        gfnSdkCondBroadcast(&s_gfnPrefetch.cond);
+        gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+        return result;
+    }
+    // Begin holds a reference of its own while it starts the threads, so that the prefetch
+    // cannot finish between two of them
+    s_gfnPrefetch.numRunning = 1;
+    for (i = 0; i < s_gfnPrefetch.config.numThreads && i < s_gfnPrefetch.numFiles; i++)
+    {
+        s_gfnPrefetch.numRunning++;
+        gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+        if (!gfnSdkThreadCreate(&s_gfnPrefetch.threads[s_gfnPrefetch.numThreads], gfnPrefetchThread, NULL))
+        {
+            gfnSdkMutexLock(&s_gfnPrefetch.lock);
+            s_gfnPrefetch.numRunning--;
+            break;
+        }
+        s_gfnPrefetch.numThreads++;
+        gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    }
+    gfnPrefetchLeave();
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+    return s_gfnPrefetch.numThreads > 0 ? gfnSuccess : gfnUnableToAllocateMemory;
+}
+
+GfnRuntimeError GfnInstallPrefetchWait(unsigned int timeoutMs)
+{
+    uint64_t deadlineMs = 0;
+    uint64_t nowMs = 0;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (!s_gfnPrefetch.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    deadlineMs = gfnSdkGetTimeMs() + timeoutMs;
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    if (!s_gfnPrefetch.stats.started)
+    {
+        result = gfnNoData;
+    }
+    while (result == gfnSuccess && !s_gfnPrefetch.stats.finished)
+    {
+        nowMs = gfnSdkGetTimeMs();
+        if (nowMs >= deadlineMs)
+        {
+            result = gfnTimedOut;
+            break;
+        }
+        gfnSdkCondTimedWait(&s_gfnPrefetch.cond, &s_gfnPrefetch.lock, (uint32_t)(deadlineMs - nowMs));
+    }
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+    return result;
+}
+
+GfnRuntimeError GfnInstallPrefetchGetStats(GfnInstallPrefetchStats* pStats)
+{
+    if (!s_gfnPrefetch.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pStats == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    *pStats = s_gfnPrefetch.stats;
+    if (pStats->started)
+    {
+        pStats->elapsedMs = (pStats->finished ? s_gfnPrefetch.endMs : gfnSdkGetTimeMs()) - s_gfnPrefetch.beginMs;
+    }
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnInstallPrefetchRecordAccess(const char* pchPath, uint64_t offset, uint64_t size)
+{
+    uint32_t slot = 0;
+    uint32_t index = 0;
+    gfnPrefetchRecord* pGrown = NULL;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (!s_gfnPrefetch.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pchPath == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    // The index is kept at most half full
+    if (2 * (s_gfnPrefetch.numRecords + 1) > s_gfnPrefetch.recordIndexSize
+        && !gfnPrefetchGrowRecordIndex(s_gfnPrefetch.recordIndexSize == 0 ? 256 : s_gfnPrefetch.recordIndexSize * 2))
+    {
+        gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    slot = gfnPrefetchHashPath(pchPath) & (s_gfnPrefetch.recordIndexSize - 1);
+    while ((index = s_gfnPrefetch.pRecordIndex[slot]) != 0 && strcmp(s_gfnPrefetch.pRecords[index - 1].pchPath, pchPath) != 0)
+    {
+        slot = (slot + 1) & (s_gfnPrefetch.recordIndexSize - 1);
+    }
+
+    if (index == 0)
+    {
+        if (s_gfnPrefetch.numRecords == s_gfnPrefetch.recordsCapacity)
+        {
+            pGrown = (gfnPrefetchRecord*)realloc(s_gfnPrefetch.pRecords,
+                (s_gfnPrefetch.recordsCapacity == 0 ? 64 : s_gfnPrefetch.recordsCapacity * 2) * sizeof(gfnPrefetchRecord));
+            if (pGrown == NULL)
+            {
+                result = gfnUnableToAllocateMemory;
+            }
+            else
+            {
+                s_gfnPrefetch.pRecords = pGrown;
+                s_gfnPrefetch.recordsCapacity = s_gfnPrefetch.recordsCapacity == 0 ? 64 : s_gfnPrefetch.recordsCapacity * 2;
+            }
+        }
+        if (result == gfnSuccess)
+        {
+            s_gfnPrefetch.pRecords[s_gfnPrefetch.numRecords].pchPath = gfnPrefetchCopyString(pchPath, strlen(pchPath));
+            s_gfnPrefetch.pRecords[s_gfnPrefetch.numRecords].extent = 0;
+            if (s_gfnPrefetch.pRecords[s_gfnPrefetch.numRecords].pchPath == NULL)
+            {
+                result = gfnUnableToAllocateMemory;
+            }
+            else
+            {
+                index = ++s_gfnPrefetch.numRecords;
+                s_gfnPrefetch.pRecordIndex[slot] = index;
+            }
+        }
+    }
+    if (index != 0 && offset + size > s_gfnPrefetch.pRecords[index - 1].extent)
+    {
+        s_gfnPrefetch.pRecords[index - 1].extent = offset + size;
+    }
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+    return result;
+}
+
+GfnRuntimeError GfnInstallPrefetchSaveManifest(const char* pchManifestPath, const char* pchBuildPath)
+{
+    FILE* pFile = NULL;
+    const char* pchPath = NULL;
+    size_t buildLength = 0;
+    unsigned int i = 0;
+    bool written = false;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (!s_gfnPrefetch.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pchManifestPath == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    buildLength = pchBuildPath != NULL ? strlen(pchBuildPath) : 0;
+    while (buildLength > 0 && gfnPrefetchIsSeparator(pchBuildPath[buildLength - 1]))
+    {
+        buildLength--;
+    }
+
+    gfnSdkMutexLock(&s_gfnPrefetch.lock);
+    if (s_gfnPrefetch.numRecords == 0)
+    {
+        result = gfnNoData;
+    }
+    else if ((pFile = fopen(pchManifestPath, "w")) == NULL)
+    {
+        result = gfnInternalError;
+    }
+    else
+    {
+        written = fprintf(pFile, "# priority bytes path\n") > 0;
+        for (i = 0; i < s_gfnPrefetch.numRecords && written; i++)
+        {
+            pchPath = s_gfnPrefetch.pRecords[i].pchPath;
+            if (buildLength > 0 && strncmp(pchPath, pchBuildPath, buildLength) == 0 && gfnPrefetchIsSeparator(pchPath[buildLength]))
+            {
+                pchPath += buildLength + 1;
+            }
+            // Files read first get the highest priority
+            written = fprintf(pFile, "%u %llu %s\n", s_gfnPrefetch.numRecords - i,
+                (unsigned long long)s_gfnPrefetch.pRecords[i].extent, pchPath) > 0;
+        }
+        if (fclose(pFile) != 0 || !written)
+        {
+            result = gfnInternalError;
+        }
+    }
+    gfnSdkMutexUnlock(&s_gfnPrefetch.lock);
+    return result;
+}
@@ -0,0 +1,272 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Page cache prefetching of hot build files when a title is installed
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_InstallPrefetch.h
+*
+* Optional page cache prefetch of the build files listed in a manifest, built on
+* @ref GfnRegisterInstallCallback
+*/
+///
+/// @page install_prefetch Install Prefetch
+///
+/// @section install_prefetch_introduction Introduction
+/// GeForce NOW calls the install callback right after it set up the title, before its first
+/// launch, with the path of the build files in @ref TitleInstallationInformation::pchBuildPath.
+/// The first launch then reads its assets from storage. Reading the hottest of those files into
+/// the page cache from the install callback lets the first launch find them in memory.
+///
+/// - The files are listed in a manifest, in priority order, with the number of bytes to read
+///   from each. The manifest is best recorded from a profiling run of the first launch, with
+///   @ref GfnInstallPrefetchRecordAccess and @ref GfnInstallPrefetchSaveManifest.
+/// - When the install callback arrives, the helper reads the manifest and returns right away. A
+///   few I/O threads then prefetch the files, highest priority first: readahead, or
+///   posix_fadvise where readahead is not supported, on Linux, and sequential reads on Windows.
+/// - Prefetching stops once the byte or time budget is used up, so that it does not compete with
+///   the launch for I/O for long. The bytes prefetched and the time taken are reported by
+///   @ref GfnInstallPrefetchGetStats.
+///
+/// @section install_prefetch_manifest Manifest format
+/// A text file with one file per line: a priority, the number of bytes to prefetch from the start
+/// of the file (0 for the whole file), and the path, separated by spaces. Relative paths are
+/// relative to the build path. Files with a higher priority are prefetched first. Empty lines and
+/// lines starting with '#' are ignored.
+///
+/// @code
+/// # priority bytes path
+/// 100 0 data/shaders.pak
+/// 90 16777216 data/textures.pak
+/// @endcode
+
+#ifndef __NV_GFNSDK_INSTALL_PREFETCH_H__
+#define __NV_GFNSDK_INSTALL_PREFETCH_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Configuration passed to @ref GfnInstallPrefetchInitialize. Zero members select the defaults.
+typedef struct GfnInstallPrefetchConfig
+{
+    const char* pchManifestPath;        ///< Manifest path, relative to the build path unless absolute. NULL for "gfn_prefetch_manifest.txt". Copied.
+    unsigned int numThreads;            ///< I/O threads, 0 for 4
+    uint64_t budgetBytes;               ///< Most bytes to prefetch, 0 for 1 GiB
+    unsigned int budgetMs;              ///< No new reads are issued after this long, 0 for 60000
+    bool manualCallback;                ///< Do not register the install callback; the application calls @ref GfnInstallPrefetchBegin
+    InstallCallbackSig installCallback; ///< Optional, called after the prefetch started when GeForce NOW installs the title
+    void* pInstallContext;              ///< Passed unmodified to installCallback
+} GfnInstallPrefetchConfig;
+
+/// @brief Progress and results of a prefetch. Times are in milliseconds.
+typedef struct GfnInstallPrefetchStats
+{
+    bool started;                       ///< @ref GfnInstallPrefetchBegin was called
+    bool finished;                      ///< All I/O threads are done
+    unsigned int numFiles;              ///< Files listed in the manifest
+    unsigned int numPrefetched;         ///< Files prefetched, fully or up to the budget
+    unsigned int numMissing;            ///< Files that could not be opened
+    unsigned int numSkipped;            ///< Files not prefetched because the budget was used up
+    uint64_t bytesPrefetched;
+    uint64_t elapsedMs;                 ///< From @ref GfnInstallPrefetchBegin to the end of the prefetch, or until now
+    GfnRuntimeError manifestResult;     ///< Result of reading the manifest
+} GfnInstallPrefetchStats;
+
+///
+/// @par Description
+/// Sets up the install prefetch helper.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call once at application start, after @ref GfnInitializeSdk.
+///
+/// @param pConfig                    - Configuration, or NULL for the defaults
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - The helper is already set up
+/// @retval gfnUnableToAllocateMemory - The helper could not be set up
+GfnRuntimeError GfnInstallPrefetchInitialize(const GfnInstallPrefetchConfig* pConfig);
+
+///
+/// @par Description
+/// Stops issuing reads, waits for the I/O threads, and releases the helper and any recorded accesses.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call after @ref GfnShutdownSdk, so that the install callback can no longer arrive.
+void GfnInstallPrefetchShutdown(void);
+
+///
+/// @par Description
+/// Registers the install callback of the helper, which calls @ref GfnInstallPrefetchBegin
+/// with the build path and then the application's install callback.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call after @ref GfnInstallPrefetchInitialize, instead of registering the install callback directly.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnInstallPrefetchInitialize was not called
+/// @retval gfnInvalidParameter       - @ref GfnInstallPrefetchConfig::manualCallback is set
+/// @return Otherwise, the error returned by @ref GfnRegisterInstallCallback
+GfnRuntimeError GfnInstallPrefetchStart(void);
+
+///
+/// @par Description
+/// Reads the manifest and starts prefetching its files in the background.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Called by the install callback of the helper, or by the application's own install callback
+/// if @ref GfnInstallPrefetchConfig::manualCallback is set. Returns without waiting for the reads.
+///
+/// @param pchBuildPath               - @ref TitleInstallationInformation::pchBuildPath
+///
+/// @retval gfnSuccess                - The prefetch started
+/// @retval gfnAPINotInit             - @ref GfnInstallPrefetchInitialize was not called
+/// @retval gfnInvalidParameter       - pchBuildPath is NULL, or a prefetch already started
+/// @retval gfnNoData                 - The manifest does not exist or lists no files
+/// @retval gfnUnableToAllocateMemory - The manifest could not be read, or the I/O threads could not be started
+GfnRuntimeError GfnInstallPrefetchBegin(const char* pchBuildPath);
+
+///
+/// @par Description
+/// Waits until the prefetch finished.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param timeoutMs                  - Longest time to wait, in milliseconds
+///
+/// @retval gfnSuccess                - The prefetch finished
+/// @retval gfnAPINotInit             - @ref GfnInstallPrefetchInitialize was not called
+/// @retval gfnNoData                 - No prefetch was started
+/// @retval gfnTimedOut               - The prefetch is still running
+GfnRuntimeError GfnInstallPrefetchWait(unsigned int timeoutMs);
+
+///
+/// @par Description
+/// Retrieves the progress and results of the prefetch.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pStats                     - Receives the statistics
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnInstallPrefetchInitialize was not called
+/// @retval gfnInvalidParameter       - pStats is NULL
+GfnRuntimeError GfnInstallPrefetchGetStats(GfnInstallPrefetchStats* pStats);
+
+///
+/// @par Description
+/// Records a read from a file during a profiling run. The first access to each file sets its
+/// place in the manifest, and the furthest byte read sets how much of it is prefetched.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call from the application's file loading code during a profiling run of the first launch.
+/// Can be called from several threads at the same time.
+///
+/// @param pchPath                    - Path of the file
+/// @param offset                     - Offset of the read
+/// @param size                       - Size of the read
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnInstallPrefetchInitialize was not called
+/// @retval gfnInvalidParameter       - pchPath is NULL
+/// @retval gfnUnableToAllocateMemory - The access could not be recorded
+GfnRuntimeError GfnInstallPrefetchRecordAccess(const char* pchPath, uint64_t offset, uint64_t size);
+
+///
+/// @par Description
+/// Writes the recorded accesses as a manifest, in the order the files were first accessed.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call at the end of the profiling run, and ship the manifest with the build.
+///
+/// @param pchManifestPath            - Path of the manifest to write
+/// @param pchBuildPath               - Paths under this directory are written relative to it. Can be NULL.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnInstallPrefetchInitialize was not called
+/// @retval gfnInvalidParameter       - pchManifestPath is NULL
+/// @retval gfnNoData                 - No access was recorded
+/// @retval gfnInternalError          - The manifest could not be written
+GfnRuntimeError GfnInstallPrefetchSaveManifest(const char* pchManifestPath, const char* pchBuildPath);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_INSTALL_PREFETCH_H__
@@ -0,0 +1,679 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_MessageRpc.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Request IDs carry the slot index in the low bits and a generation counter in the high bits,
+// so a late response to a completed request can never be matched to a newer request that
+// reuses the same slot.
+#define GFN_RPC_SLOT_BITS 8
+#define GFN_RPC_SLOT_MASK ((1u << GFN_RPC_SLOT_BITS) - 1)
+#define GFN_RPC_NO_SLOT 0xFFFF
+#define GFN_RPC_WHEEL_SIZE 256
+#define GFN_RPC_WHEEL_MASK (GFN_RPC_WHEEL_SIZE - 1)
+#define GFN_RPC_PREFIX_LEN (sizeof(GFN_RPC_MESSAGE_PREFIX) - 1)
+// Prefix, type character, separator, up to 8 hex digits of ID, separator
+#define GFN_RPC_MAX_HEADER_LEN (GFN_RPC_PREFIX_LEN + 2 + 8 + 1)
+
+#if (GFN_RPC_MAX_IN_FLIGHT > (1 << GFN_RPC_SLOT_BITS))
+#   error "GFN_RPC_MAX_IN_FLIGHT does not fit in the request ID slot bits"
+#endif
+
+typedef struct gfnRpcSlot
+{
+    GfnRpcRequestId id;                 // 0 while the slot is free
+    unsigned int generation;
+    GfnRpcResponseCallbackSig callback;
+    void* pUserContext;
+    unsigned int rounds;                // Remaining full wheel revolutions before expiry
+    unsigned short bucket;
+    unsigned short prev;                // Timer wheel bucket list links
+    unsigned short next;                // Also used as the free list link while the slot is free
+} gfnRpcSlot;
+
+typedef struct gfnRpcCompletion
+{
+    GfnRpcResponseCallbackSig callback;
+    void* pUserContext;
+    GfnRpcRequestId id;
+} gfnRpcCompletion;
+
+typedef struct gfnRpcState
+{
+    // The lock and condition variables are created by the first initialization and live until
+    // the process exits, since the SDK may still deliver a message after shutdown
+    bool syncReady;
+    bool initialized;
+    bool stopping;
+    GfnSdkMutex lock;
+    GfnSdkCondVar timerCond;
+    GfnSdkCondVar idleCond;
+    GfnSdkThread timerThread;
+    unsigned int dispatching;           // Messages being delivered to application callbacks
+
+    GfnRpcRequestCallbackSig requestCallback;
+    MessageCallbackSig passthroughCallback;
+    void* pUserContext;
+
+    gfnRpcSlot slots[GFN_RPC_MAX_IN_FLIGHT];
+    unsigned short freeHead;
+    unsigned int inFlight;
+
+    unsigned short wheel[GFN_RPC_WHEEL_SIZE];
+    unsigned int cursor;
+    uint64_t lastTickMs;
+} gfnRpcState;
+
+static gfnRpcState s_gfnRpc;
+
+// Must be called with the lock held
+static void gfnRpcWheelInsert(gfnRpcSlot* pSlot, unsigned short slotIndex, unsigned int timeoutMs)
+{
+    uint64_t now = gfnSdkGetTimeMs();
+    uint64_t ticks = 0;
+
+    if (s_gfnRpc.inFlight == 0)
+    {
+        // The wheel only advances while requests are outstanding, restart the tick clock
+        s_gfnRpc.lastTickMs = now;
+    }
+    // Measure from the last processed tick so that a partially elapsed tick is not counted
+    ticks = (timeoutMs + (now - s_gfnRpc.lastTickMs) + GFN_RPC_TIMER_TICK_MS - 1) / GFN_RPC_TIMER_TICK_MS;
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+
+    pSlot->bucket = (unsigned short)((s_gfnRpc.cursor + ticks) & GFN_RPC_WHEEL_MASK);
+    pSlot->rounds = (unsigned int)((ticks - 1) / GFN_RPC_WHEEL_SIZE);
+    pSlot->prev = GFN_RPC_NO_SLOT;
+    pSlot->next = s_gfnRpc.wheel[pSlot->bucket];
+    if (pSlot->next != GFN_RPC_NO_SLOT)
+    {
+        s_gfnRpc.slots[pSlot->next].prev = slotIndex;
+    }
+    s_gfnRpc.wheel[pSlot->bucket] = slotIndex;
+}
+
+// Must be called with the lock held
+static void gfnRpcWheelRemove(gfnRpcSlot* pSlot)
+{
+    if (pSlot->prev != GFN_RPC_NO_SLOT)
+    {
+        s_gfnRpc.slots[pSlot->prev].next = pSlot->next;
+    }
+    else
+    {
+        s_gfnRpc.wheel[pSlot->bucket] = pSlot->next;
+    }
+    if (pSlot->next != GFN_RPC_NO_SLOT)
+    {
+        s_gfnRpc.slots[pSlot->next].prev = pSlot->prev;
+    }
+}
+
+// Must be called with the lock held. Returns the slot index, or GFN_RPC_NO_SLOT if all are in use.
+static unsigned short gfnRpcAllocSlot(void)
+{
+    unsigned short slotIndex = s_gfnRpc.freeHead;
+    gfnRpcSlot* pSlot = NULL;
+
+    if (slotIndex == GFN_RPC_NO_SLOT)
+    {
+        return GFN_RPC_NO_SLOT;
+    }
+    pSlot = &s_gfnRpc.slots[slotIndex];
+    s_gfnRpc.freeHead = pSlot->next;
+
+    // Skip generation 0 for slot 0 so that a request ID is never 0
+    pSlot->generation++;
+    if (pSlot->generation > (0xFFFFFFFFu >> GFN_RPC_SLOT_BITS))
+    {
+        pSlot->generation = 1;
+    }
+    pSlot->id = (pSlot->generation << GFN_RPC_SLOT_BITS) | slotIndex;
+    return slotIndex;
+}
+
+// Must be called with the lock held. The slot must already be unlinked from the wheel.
+static void gfnRpcFreeSlot(gfnRpcSlot* pSlot, unsigned short slotIndex)
+{
+    pSlot->id = 0;
+    pSlot->callback = NULL;
+    pSlot->pUserContext = NULL;
+    pSlot->next = s_gfnRpc.freeHead;
+    s_gfnRpc.freeHead = slotIndex;
+    s_gfnRpc.inFlight--;
+}
+
+// Must be called with the lock held. Unlinks and frees the in-flight request with the given ID,
+// returning its completion information. Returns false if the request is not in flight.
+static bool gfnRpcTakeRequest(GfnRpcRequestId requestId, gfnRpcCompletion* pCompletion)
+{
+    unsigned short slotIndex = (unsigned short)(requestId & GFN_RPC_SLOT_MASK);
+    gfnRpcSlot* pSlot = NULL;
+
+    if (requestId == 0 || slotIndex >= GFN_RPC_MAX_IN_FLIGHT)
+    {
+        return false;
+    }
+    pSlot = &s_gfnRpc.slots[slotIndex];
+    if (pSlot->id != requestId)
+    {
+        return false;
+    }
+
+    pCompletion->callback = pSlot->callback;
+    pCompletion->pUserContext = pSlot->pUserContext;
+    pCompletion->id = requestId;
+    gfnRpcWheelRemove(pSlot);
+    gfnRpcFreeSlot(pSlot, slotIndex);
+    return true;
+}
+
+static void gfnRpcComplete(const gfnRpcCompletion* pCompletion, GfnRuntimeError status, const GfnString* pResponse)
+{
+    if (pCompletion->callback != NULL)
+    {
+        pCompletion->callback(status, pCompletion->id, pResponse, pCompletion->pUserContext);
+    }
+}
+
+// Must be called with the lock held. Advances the wheel by one tick and moves expired requests
+// into pExpired, returning the number of requests added.
+static unsigned int gfnRpcWheelAdvance(gfnRpcCompletion* pExpired)
+{
+    unsigned int count = 0;
+    unsigned short slotIndex = GFN_RPC_NO_SLOT;
+    unsigned short nextIndex = GFN_RPC_NO_SLOT;
+    gfnRpcSlot* pSlot = NULL;
+
+    s_gfnRpc.cursor = (s_gfnRpc.cursor + 1) & GFN_RPC_WHEEL_MASK;
+    for (slotIndex = s_gfnRpc.wheel[s_gfnRpc.cursor]; slotIndex != GFN_RPC_NO_SLOT; slotIndex = nextIndex)
+    {
+        pSlot = &s_gfnRpc.slots[slotIndex];
+        nextIndex = pSlot->next;
+        if (pSlot->rounds > 0)
+        {
+            pSlot->rounds--;
+            continue;
+        }
+        pExpired[count].callback = pSlot->callback;
+        pExpired[count].pUserContext = pSlot->pUserContext;
+        pExpired[count].id = pSlot->id;
+        count++;
+        gfnRpcWheelRemove(pSlot);
+        gfnRpcFreeSlot(pSlot, slotIndex);
+    }
+    return count;
+}
+
+static void gfnRpcTimerThread(void* pContext)
+{
+    // Every in-flight request can expire at most once per pass, so this cannot overflow
+    static gfnRpcCompletion s_expired[GFN_RPC_MAX_IN_FLIGHT];
+    unsigned int expiredCount = 0;
+    unsigned int i = 0;
+    uint64_t now = 0;
+
+    (void)pContext;
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    while (!s_gfnRpc.stopping)
+    {
+        if (s_gfnRpc.inFlight == 0)
+        {
+            gfnSdkCondWait(&s_gfnRpc.timerCond, &s_gfnRpc.lock);
+            continue;
+        }
+
+        now = gfnSdkGetTimeMs();
+        if (now - s_gfnRpc.lastTickMs < GFN_RPC_TIMER_TICK_MS)
+        {
+            gfnSdkCondTimedWait(&s_gfnRpc.timerCond, &s_gfnRpc.lock,
+                (uint32_t)(GFN_RPC_TIMER_TICK_MS - (now - s_gfnRpc.lastTickMs)));
+            continue;
+        }
+
+        expiredCount = 0;
+        while (now - s_gfnRpc.lastTickMs >= GFN_RPC_TIMER_TICK_MS && s_gfnRpc.inFlight > 0)
+        {
+            s_gfnRpc.lastTickMs += GFN_RPC_TIMER_TICK_MS;
+            expiredCount += gfnRpcWheelAdvance(&s_expired[expiredCount]);
+        }
+        if (s_gfnRpc.inFlight == 0)
+        {
+            s_gfnRpc.lastTickMs = now;
+        }
+
+        if (expiredCount > 0)
+        {
+            // Callbacks run without the lock so they can issue new requests
+            gfnSdkMutexUnlock(&s_gfnRpc.lock);
+            for (i = 0; i < expiredCount; i++)
+            {
+                gfnRpcComplete(&s_expired[i], gfnTimedOut, NULL);
+            }
+            gfnSdkMutexLock(&s_gfnRpc.lock);
+        }
+    }
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+}
+
+// Parses "<hex id>:" at the start of pch. Returns the number of characters consumed, or 0 on error.
+static unsigned int gfnRpcParseId(const char* pch, unsigned int length, GfnRpcRequestId* pId)
+{
+    unsigned int i = 0;
+    GfnRpcRequestId id = 0;
+    char c = 0;
+
+    for (i = 0; i < length && i <= 8; i++)
+    {
+        c = pch[i];
+        if (c == ':')
+        {
+            if (i == 0 || id == 0)
+            {
+                return 0;
+            }
+            *pId = id;
+            return i + 1;
+        }
+        if (c >= '0' && c <= '9')
+        {
+            id = (id << 4) | (GfnRpcRequestId)(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            id = (id << 4) | (GfnRpcRequestId)(c - 'a' + 10);
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+// Must be called with the lock held. Registers a message delivery to an application callback,
+// so that shutdown waits for it to return. Returns false if the helper is shut down.
+static bool gfnRpcBeginDispatch(void)
+{
+    if (!s_gfnRpc.initialized || s_gfnRpc.stopping)
+    {
+        return false;
+    }
+    s_gfnRpc.dispatching++;
+    return true;
+}
+
+static void gfnRpcEndDispatch(void)
+{
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    s_gfnRpc.dispatching--;
+    if (s_gfnRpc.dispatching == 0)
+    {
+        gfnSdkCondBroadcast(&s_gfnRpc.idleCond);
+    }
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+}
+
+static GfnApplicationCallbackResult GFN_CALLBACK gfnRpcOnMessage(const GfnString* pStrData, void* pUnused)
+{
+    const char* pch = NULL;
+    unsigned int length = 0;
+    unsigned int consumed = 0;
+    char type = 0;
+    GfnRpcRequestId id = 0;
+    GfnString payload;
+    gfnRpcCompletion completion;
+    bool found = false;
+    GfnRpcRequestCallbackSig requestCallback = NULL;
+    MessageCallbackSig passthroughCallback = NULL;
+    void* pUserContext = NULL;
+    GfnApplicationCallbackResult result = crCallbackSuccess;
+
+    (void)pUnused;
+    if (pStrData == NULL || pStrData->pchString == NULL)
+    {
+        return crCallbackFailure;
+    }
+    pch = pStrData->pchString;
+    length = pStrData->length;
+
+    if (length < GFN_RPC_PREFIX_LEN + 2 || memcmp(pch, GFN_RPC_MESSAGE_PREFIX, GFN_RPC_PREFIX_LEN) != 0)
+    {
+        gfnSdkMutexLock(&s_gfnRpc.lock);
+        passthroughCallback = s_gfnRpc.passthroughCallback;
+        pUserContext = s_gfnRpc.pUserContext;
+        found = passthroughCallback != NULL && gfnRpcBeginDispatch();
+        gfnSdkMutexUnlock(&s_gfnRpc.lock);
+        if (!found)
+        {
+            return crCallbackSuccess;
+        }
+        result = passthroughCallback(pStrData, pUserContext);
+        gfnRpcEndDispatch();
+        return result;
+    }
+
+    type = pch[GFN_RPC_PREFIX_LEN];
+    if ((type != 'q' && type != 'r') || pch[GFN_RPC_PREFIX_LEN + 1] != ':')
+    {
+        return crCallbackFailure;
+    }
+    pch += GFN_RPC_PREFIX_LEN + 2;
+    length -= GFN_RPC_PREFIX_LEN + 2;
+    consumed = gfnRpcParseId(pch, length, &id);
+    if (consumed == 0)
+    {
+        return crCallbackFailure;
+    }
+    payload.pchString = pch + consumed;
+    payload.length = length - consumed;
+
+    if (type == 'q')
+    {
+        gfnSdkMutexLock(&s_gfnRpc.lock);
+        requestCallback = s_gfnRpc.requestCallback;
+        pUserContext = s_gfnRpc.pUserContext;
+        found = requestCallback != NULL && gfnRpcBeginDispatch();
+        gfnSdkMutexUnlock(&s_gfnRpc.lock);
+        if (!found)
+        {
+            return crCallbackFailure;
+        }
+        requestCallback(id, &payload, pUserContext);
+        gfnRpcEndDispatch();
+        return crCallbackSuccess;
+    }
+
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    found = s_gfnRpc.initialized && gfnRpcTakeRequest(id, &completion);
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+
+    if (!found)
+    {
+        // Late response to a request that already timed out or was canceled
+        return crCallbackFailure;
+    }
+    gfnRpcComplete(&completion, gfnSuccess, &payload);
+    return crCallbackSuccess;
+}
+
+static GfnRuntimeError gfnRpcSendFramed(char type, GfnRpcRequestId id, const char* pchPayload, unsigned int length)
+{
+    char message[GFN_RPC_MAX_MESSAGE_LEN];
+    int headerLen = 0;
+
+    headerLen = snprintf(message, sizeof(message), GFN_RPC_MESSAGE_PREFIX "%c:%x:", type, id);
+    if (headerLen < 0 || (unsigned int)headerLen + length > GFN_RPC_MAX_MESSAGE_LEN - 1)
+    {
+        return gfnInvalidParameter;
+    }
+    if (length > 0)
+    {
+        memcpy(message + headerLen, pchPayload, length);
+    }
+    message[headerLen + length] = '\0';
+    return GfnSendMessage(message, (unsigned int)headerLen + length);
+}
+
+// Creates the synchronization primitives on first use. They are never destroyed, so that a
+// message the SDK delivers while the helper is shut down or re-initialized finds a valid lock.
+static bool gfnRpcInitSync(void)
+{
+    if (s_gfnRpc.syncReady)
+    {
+        return true;
+    }
+    if (!gfnSdkMutexInit(&s_gfnRpc.lock))
+    {
+        return false;
+    }
+    if (!gfnSdkCondInit(&s_gfnRpc.timerCond))
+    {
+        gfnSdkMutexDestroy(&s_gfnRpc.lock);
+        return false;
+    }
+    if (!gfnSdkCondInit(&s_gfnRpc.idleCond))
+    {
+        gfnSdkCondDestroy(&s_gfnRpc.timerCond);
+        gfnSdkMutexDestroy(&s_gfnRpc.lock);
+        return false;
+    }
+    s_gfnRpc.syncReady = true;
+    return true;
+}
+
+GfnRuntimeError GfnRpcInitialize(GfnRpcRequestCallbackSig requestCallback, MessageCallbackSig passthroughCallback, void* pUserContext)
+{
+    GfnRuntimeError status = gfnSuccess;
+    unsigned int i = 0;
+
+    if (s_gfnRpc.initialized)
+    {
+        return gfnInvalidParameter;
+    }
+    if (!gfnRpcInitSync())
+    {
+        return gfnUnableToAllocateMemory;
+    }
+
+    // The state is reset under the lock rather than cleared wholesale, since the message callback
+    // of a previous initialization may still be running
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    memset(s_gfnRpc.slots, 0, sizeof(s_gfnRpc.slots));
+    for (i = 0; i < GFN_RPC_MAX_IN_FLIGHT; i++)
+    {
+        s_gfnRpc.slots[i].next = (unsigned short)(i + 1 < GFN_RPC_MAX_IN_FLIGHT ? i + 1 : GFN_RPC_NO_SLOT);
+    }
+    for (i = 0; i < GFN_RPC_WHEEL_SIZE; i++)
+    {
+        s_gfnRpc.wheel[i] = GFN_RPC_NO_SLOT;
+    }
+    s_gfnRpc.freeHead = 0;
+    s_gfnRpc.inFlight = 0;
+    s_gfnRpc.cursor = 0;
+    s_gfnRpc.lastTickMs = 0;
+    s_gfnRpc.stopping = false;
+    s_gfnRpc.requestCallback = requestCallback;
+    s_gfnRpc.passthroughCallback = passthroughCallback;
+    s_gfnRpc.pUserContext = pUserContext;
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+
+    if (!gfnSdkThreadCreate(&s_gfnRpc.timerThread, gfnRpcTimerThread, NULL))
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    s_gfnRpc.initialized = true;
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+
+    status = GfnRegisterMessageCallback(gfnRpcOnMessage, NULL);
+    if (GFNSDK_FAILED(status))
+    {
+        GfnRpcShutdown();
+    }
+    return status;
+}
+
+void GfnRpcShutdown(void)
+{
+    static gfnRpcCompletion s_canceled[GFN_RPC_MAX_IN_FLIGHT];
+    unsigned int canceledCount = 0;
+    unsigned int i = 0;
+
+    if (!s_gfnRpc.initialized)
+    {
+        return;
+    }
+
+    // Stop delivering messages to the application first, and wait for deliveries in progress
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    s_gfnRpc.stopping = true;
+    gfnSdkCondSignal(&s_gfnRpc.timerCond);
+    while (s_gfnRpc.dispatching > 0)
+    {
+        gfnSdkCondWait(&s_gfnRpc.idleCond, &s_gfnRpc.lock);
+    }
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+    gfnSdkThreadJoin(s_gfnRpc.timerThread);
+
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    for (i = 0; i < GFN_RPC_MAX_IN_FLIGHT; i++)
+    {
+        if (s_gfnRpc.slots[i].id != 0 && gfnRpcTakeRequest(s_gfnRpc.slots[i].id, &s_canceled[canceledCount]))
+        {
+            canceledCount++;
+        }
+    }
+    s_gfnRpc.initialized = false;
+    s_gfnRpc.requestCallback = NULL;
+    s_gfnRpc.passthroughCallback = NULL;
+    s_gfnRpc.pUserContext = NULL;
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+
+    for (i = 0; i < canceledCount; i++)
+    {
+        gfnRpcComplete(&s_canceled[i], gfnCanceled, NULL);
+    }
+    // The SDK has no way to unregister the message callback, so it stays registered but drops
+    // every message from now on, without calling into the application.
+}
+
+GfnRuntimeError GfnRpcSendRequest(const char* pchPayload, unsigned int length, unsigned int timeoutMs,
+    GfnRpcResponseCallbackSig responseCallback, void* pUserContext, GfnRpcRequestId* pRequestId)
+{
+    GfnRuntimeError status = gfnSuccess;
+    GfnRpcRequestId requestId = 0;
+    unsigned short slotIndex = GFN_RPC_NO_SLOT;
+    gfnRpcSlot* pSlot = NULL;
+    gfnRpcCompletion unused;
+
+    if (!s_gfnRpc.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (responseCallback == NULL || (pchPayload == NULL && length > 0)
+        || length > GFN_RPC_MAX_MESSAGE_LEN - 1 - GFN_RPC_MAX_HEADER_LEN)
+    {
+        return gfnInvalidParameter;
+    }
+    if (timeoutMs == 0)
+    {
+        timeoutMs = GFN_RPC_DEFAULT_TIMEOUT_MS;
+    }
+
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    slotIndex = gfnRpcAllocSlot();
+    if (slotIndex == GFN_RPC_NO_SLOT)
+    {
+        gfnSdkMutexUnlock(&s_gfnRpc.lock);
+        return gfnThrottled;
+    }
+    pSlot = &s_gfnRpc.slots[slotIndex];
+    pSlot->callback = responseCallback;
+    pSlot->pUserContext = pUserContext;
+    gfnRpcWheelInsert(pSlot, slotIndex, timeoutMs);
+    s_gfnRpc.inFlight++;
+    requestId = pSlot->id;
+    gfnSdkCondSignal(&s_gfnRpc.timerCond);
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+
+    // The ID is published before sending, since the response can arrive before GfnSendMessage returns
+    if (pRequestId != NULL)
+    {
+        *pRequestId = requestId;
+    }
+
+    status = gfnRpcSendFramed('q', requestId, pchPayload, length);
+    if (GFNSDK_FAILED(status))
+    {
+        // The request never left, so withdraw it without invoking the callback
+        gfnSdkMutexLock(&s_gfnRpc.lock);
+        gfnRpcTakeRequest(requestId, &unused);
+        gfnSdkMutexUnlock(&s_gfnRpc.lock);
+        if (pRequestId != NULL)
+        {
+            *pRequestId = 0;
+        }
+    }
+    return status;
+}
+
+GfnRuntimeError GfnRpcSendResponse(GfnRpcRequestId requestId, const char* pchPayload, unsigned int length)
+{
+    if (!s_gfnRpc.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (requestId == 0 || (pchPayload == NULL && length > 0))
+    {
+        return gfnInvalidParameter;
+    }
+    return gfnRpcSendFramed('r', requestId, pchPayload, length);
+}
+
+GfnRuntimeError GfnRpcCancelRequest(GfnRpcRequestId requestId)
+{
+    gfnRpcCompletion completion;
+    bool found = false;
+
+    if (!s_gfnRpc.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    found = gfnRpcTakeRequest(requestId, &completion);
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+
+    if (!found)
+    {
+        return gfnNoData;
+    }
+    gfnRpcComplete(&completion, gfnCanceled, NULL);
+    return gfnSuccess;
+}
+
+unsigned int GfnRpcGetInFlightCount(void)
+{
+    unsigned int inFlight = 0;
+
+    if (!s_gfnRpc.initialized)
+    {
+        return 0;
+    }
+    gfnSdkMutexLock(&s_gfnRpc.lock);
+    inFlight = s_gfnRpc.inFlight;
+    gfnSdkMutexUnlock(&s_gfnRpc.lock);
+    return inFlight;
+}
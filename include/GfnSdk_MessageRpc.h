@@ -0,0 +1,242 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Request/response RPC helper layered over GfnSendMessage and GfnRegisterMessageCallback
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_MessageRpc.h
+*
+* Optional RPC helper for the custom message channel
+*/
+///
+/// @page message_rpc Custom Message RPC Helper
+///
+/// @section message_rpc_introduction Introduction
+/// @ref GfnSendMessage is fire-and-forget, and @ref GfnRegisterMessageCallback delivers every
+/// incoming message to a single callback. Applications that exchange request/response pairs with
+/// their client application otherwise have to correlate them by hand, typically allowing only one
+/// request in flight at a time. This helper tags each request with a correlation ID so that many
+/// requests can be in flight at once, responses can arrive in any order, and every request is
+/// completed exactly once: with the response, on timeout, or on cancellation.
+///
+/// @section message_rpc_wire_format Wire Format
+/// RPC traffic is carried as regular custom messages with a small text header:
+///
+/// Message  | Format
+/// -------- | -------------------------------------
+/// Request  | `#gfnrpc:q:<id>:<payload>`
+/// Response | `#gfnrpc:r:<id>:<payload>`
+///
+/// `<id>` is the request ID in lowercase hexadecimal. The client side of the channel must echo
+/// the ID of a request in its response. Messages without the `#gfnrpc:` prefix are not RPC
+/// traffic and are forwarded unmodified to the passthrough callback given at initialization.
+///
+/// @section message_rpc_threading Threading
+/// Timeouts are tracked by a hashed timer wheel serviced by a single helper thread, which only
+/// runs while requests are outstanding. Completion callbacks are invoked without any internal
+/// lock held, either on the thread that delivered the response message or on the timer thread,
+/// so they may issue new requests. Callbacks should return quickly.
+///
+
+#ifndef __NV_GFNSDK_MESSAGE_RPC_H__
+#define __NV_GFNSDK_MESSAGE_RPC_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Prefix that identifies RPC traffic on the custom message channel
+#define GFN_RPC_MESSAGE_PREFIX "#gfnrpc:"
+/// @brief Maximum number of requests that can be in flight at the same time
+#define GFN_RPC_MAX_IN_FLIGHT 256
+/// @brief Maximum length of a framed message, matching the @ref GfnSendMessage limit
+#define GFN_RPC_MAX_MESSAGE_LEN 8192
+/// @brief Timeout applied to requests sent with a timeout of 0
+#define GFN_RPC_DEFAULT_TIMEOUT_MS 5000
+/// @brief Granularity of the timeout timer wheel
+#define GFN_RPC_TIMER_TICK_MS 10
+
+/// @brief Identifies an RPC request. Never 0 for a valid request.
+typedef unsigned int GfnRpcRequestId;
+
+///
+/// @brief Callback invoked exactly once when a request completes
+///
+/// @param status       - gfnSuccess if a response was received, gfnTimedOut if the request
+///                       timed out, gfnCanceled if it was canceled or the helper was shut down
+/// @param requestId    - ID of the request being completed
+/// @param pResponse    - Response payload when status is gfnSuccess, NULL otherwise. The payload
+///                       is only valid for the duration of the callback.
+/// @param pUserContext - Context passed to @ref GfnRpcSendRequest
+///
+typedef void (GFN_CALLBACK *GfnRpcResponseCallbackSig)(GfnRuntimeError status, GfnRpcRequestId requestId, const GfnString* pResponse, void* pUserContext);
+
+///
+/// @brief Callback invoked when a request arrives from the other side of the channel
+///
+/// @param requestId    - ID to pass to @ref GfnRpcSendResponse. Responses may be sent from any
+///                       thread, at any later time, and in any order.
+/// @param pRequest     - Request payload, only valid for the duration of the callback
+/// @param pUserContext - Context passed to @ref GfnRpcInitialize
+///
+typedef void (GFN_CALLBACK *GfnRpcRequestCallbackSig)(GfnRpcRequestId requestId, const GfnString* pRequest, void* pUserContext);
+
+///
+/// @par Description
+/// Initializes the RPC helper and registers it as the custom message callback through
+/// @ref GfnRegisterMessageCallback.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call once after @ref GfnInitializeSdk, instead of calling @ref GfnRegisterMessageCallback
+/// directly. Messages that are not RPC traffic are forwarded to passthroughCallback.
+///
+/// @param requestCallback          - Called for incoming requests. Can be NULL if the application
+///                                   only sends requests, in which case incoming requests are dropped.
+/// @param passthroughCallback      - Called for incoming messages that are not RPC traffic. Can be NULL.
+/// @param pUserContext             - Pointer to user context passed unmodified to both callbacks. Can be NULL.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - The helper is already initialized
+/// @retval gfnUnableToAllocateMemory - Synchronization primitives could not be created
+/// @return Otherwise, the error returned by @ref GfnRegisterMessageCallback
+GfnRuntimeError GfnRpcInitialize(GfnRpcRequestCallbackSig requestCallback, MessageCallbackSig passthroughCallback, void* pUserContext);
+
+///
+/// @par Description
+/// Shuts down the RPC helper. Every request still in flight is completed with gfnCanceled
+/// before this function returns. Message deliveries already inside requestCallback or
+/// passthroughCallback are waited for, and no callback is called after this function returns.
+/// The SDK message callback stays registered, but drops every message until the helper is
+/// initialized again.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call before @ref GfnShutdownSdk. Must not be called from an RPC callback.
+void GfnRpcShutdown(void);
+
+///
+/// @par Description
+/// Sends a request over the custom message channel without waiting for the response.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Use to pipeline requests to the other side of the channel. Each request completes through
+/// responseCallback exactly once, unless this function returns an error, in which case the
+/// callback is never called.
+///
+/// @param pchPayload               - Request payload. Does not need to be NUL-terminated.
+/// @param length                   - Length of pchPayload in characters. The framed message cannot
+///                                   exceed @ref GFN_RPC_MAX_MESSAGE_LEN.
+/// @param timeoutMs                - Time to wait for the response. 0 selects @ref GFN_RPC_DEFAULT_TIMEOUT_MS.
+/// @param responseCallback         - Called when the request completes
+/// @param pUserContext             - Pointer to user context passed unmodified to responseCallback. Can be NULL.
+/// @param pRequestId               - Optional, receives the ID of the request
+///
+/// @retval gfnSuccess              - The request was sent
+/// @retval gfnAPINotInit           - @ref GfnRpcInitialize was not called
+/// @retval gfnInvalidParameter     - Callback was NULL, or the payload is too long
+/// @retval gfnThrottled            - @ref GFN_RPC_MAX_IN_FLIGHT requests are already in flight
+/// @return Otherwise, the error returned by @ref GfnSendMessage
+GfnRuntimeError GfnRpcSendRequest(const char* pchPayload, unsigned int length, unsigned int timeoutMs,
+    GfnRpcResponseCallbackSig responseCallback, void* pUserContext, GfnRpcRequestId* pRequestId);
+
+///
+/// @par Description
+/// Sends the response to a request received through the request callback.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param requestId                - ID received by the request callback
+/// @param pchPayload               - Response payload. Does not need to be NUL-terminated.
+/// @param length                   - Length of pchPayload in characters
+///
+/// @retval gfnSuccess              - The response was sent
+/// @retval gfnAPINotInit           - @ref GfnRpcInitialize was not called
+/// @retval gfnInvalidParameter     - Request ID was 0, or the payload is too long
+/// @return Otherwise, the error returned by @ref GfnSendMessage
+GfnRuntimeError GfnRpcSendResponse(GfnRpcRequestId requestId, const char* pchPayload, unsigned int length);
+
+///
+/// @par Description
+/// Cancels a request that is still in flight. Its callback is called with gfnCanceled before
+/// this function returns. A response that arrives later is dropped.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param requestId                - ID of the request to cancel
+///
+/// @retval gfnSuccess              - The request was canceled
+/// @retval gfnAPINotInit           - @ref GfnRpcInitialize was not called
+/// @retval gfnNoData               - The request already completed, or the ID is unknown
+GfnRuntimeError GfnRpcCancelRequest(GfnRpcRequestId requestId);
+
+///
+/// @par Description
+/// Returns the number of requests currently in flight.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+unsigned int GfnRpcGetInFlightCount(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_MESSAGE_RPC_H__
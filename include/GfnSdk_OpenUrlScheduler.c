@@ -0,0 +1,389 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_OpenUrlScheduler.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define GFN_OPEN_URL_SECOND_WINDOW_MS 1000
+#define GFN_OPEN_URL_MINUTE_WINDOW_MS 60000
+
+// Tokens return to a bucket one window after they were spent, which mirrors the server's
+// sliding window limits exactly. The ring holds the times at which outstanding tokens were spent.
+typedef struct gfnOpenUrlBucket
+{
+    uint64_t spentMs[GFN_OPEN_URL_PER_MINUTE_LIMIT];
+    unsigned int capacity;
+    unsigned int windowMs;
+    unsigned int oldest;
+    unsigned int spent;
+} gfnOpenUrlBucket;
+
+typedef struct gfnOpenUrlWaiter
+{
+    GfnOpenUrlCallbackSig callback;
+    void* pUserContext;
+    struct gfnOpenUrlWaiter* pNext;
+} gfnOpenUrlWaiter;
+
+typedef struct gfnOpenUrlRequest
+{
+    char* pchUrl;
+    size_t length;
+    uint32_t hash;
+    unsigned int throttledRetries;
+    gfnOpenUrlWaiter* pWaiters;
+} gfnOpenUrlRequest;
+
+typedef struct gfnOpenUrlScheduler
+{
+    bool initialized;
+    bool stopping;
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+    GfnSdkThread thread;
+
+    gfnOpenUrlBucket perSecond;
+    gfnOpenUrlBucket perMinute;
+    uint64_t holdUntilMs;
+
+    gfnOpenUrlRequest queue[GFN_OPEN_URL_MAX_QUEUED];
+    unsigned int head;
+    unsigned int count;
+} gfnOpenUrlScheduler;
+
+static gfnOpenUrlScheduler s_gfnOpenUrl;
+
+static void gfnOpenUrlBucketInit(gfnOpenUrlBucket* pBucket, unsigned int capacity, unsigned int windowMs)
+{
+    memset(pBucket, 0, sizeof(*pBucket));
+    pBucket->capacity = capacity;
+    pBucket->windowMs = windowMs;
+}
+
+// Returns tokens whose window has elapsed, then the time to wait until a token is available
+static uint64_t gfnOpenUrlBucketWaitMs(gfnOpenUrlBucket* pBucket, uint64_t now)
+{
+    while (pBucket->spent > 0 && now - pBucket->spentMs[pBucket->oldest] >= pBucket->windowMs)
+    {
+        pBucket->oldest = (pBucket->oldest + 1) % pBucket->capacity;
+        pBucket->spent--;
+    }
+    if (pBucket->spent < pBucket->capacity)
+    {
+        return 0;
+    }
+    return pBucket->windowMs - (now - pBucket->spentMs[pBucket->oldest]);
+}
+
+static void gfnOpenUrlBucketSpend(gfnOpenUrlBucket* pBucket, uint64_t now)
+{
+    pBucket->spentMs[(pBucket->oldest + pBucket->spent) % pBucket->capacity] = now;
+    pBucket->spent++;
+}
+
+static bool gfnOpenUrlIsValidChar(unsigned char c)
+{
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+    {
+        return true;
+    }
+    // RFC 3986 unreserved and reserved characters, plus the percent-encoding escape
+    return c != '\0' && strchr("-._~:/?#[]@!$&'()*+,;=%", c) != NULL;
+}
+
+static bool gfnOpenUrlHasScheme(const char* pchUrl, const char* pchScheme)
+{
+    size_t i = 0;
+
+    for (i = 0; pchScheme[i] != '\0'; i++)
+    {
+        char c = pchUrl[i];
+        if (c >= 'A' && c <= 'Z')
+        {
+            c = (char)(c - 'A' + 'a');
+        }
+        if (c != pchScheme[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Validates the URL and computes its length and FNV-1a hash in a single pass
+static bool gfnOpenUrlValidate(const char* pchUrl, size_t* pLength, uint32_t* pHash)
+{
+    size_t length = 0;
+    uint32_t hash = 2166136261u;
+
+    if (pchUrl == NULL)
+    {
+        return false;
+    }
+    for (length = 0; pchUrl[length] != '\0'; length++)
+    {
+        if (length >= GFN_OPEN_URL_MAX_LEN_WITH_NULL - 1 || !gfnOpenUrlIsValidChar((unsigned char)pchUrl[length]))
+        {
+            return false;
+        }
+        hash = (hash ^ (unsigned char)pchUrl[length]) * 16777619u;
+    }
+    if (!gfnOpenUrlHasScheme(pchUrl, "http://") && !gfnOpenUrlHasScheme(pchUrl, "https://"))
+    {
+        return false;
+    }
+    *pLength = length;
+    *pHash = hash;
+    return true;
+}
+
+static void gfnOpenUrlComplete(gfnOpenUrlRequest* pRequest, GfnRuntimeError status)
+{
+    gfnOpenUrlWaiter* pWaiter = pRequest->pWaiters;
+    gfnOpenUrlWaiter* pNext = NULL;
+
+    for (; pWaiter != NULL; pWaiter = pNext)
+    {
+        pNext = pWaiter->pNext;
+        if (pWaiter->callback != NULL)
+        {
+            pWaiter->callback(status, pRequest->pchUrl, pWaiter->pUserContext);
+        }
+        free(pWaiter);
+    }
+    free(pRequest->pchUrl);
+    memset(pRequest, 0, sizeof(*pRequest));
+}
+
+static void gfnOpenUrlThread(void* pContext)
+{
+    gfnOpenUrlRequest request;
+    GfnRuntimeError status = gfnSuccess;
+    uint64_t now = 0;
+    uint64_t waitMs = 0;
+    uint64_t bucketWaitMs = 0;
+
+    (void)pContext;
+    gfnSdkMutexLock(&s_gfnOpenUrl.lock);
+    while (!s_gfnOpenUrl.stopping)
+    {
+        if (s_gfnOpenUrl.count == 0)
+        {
+            gfnSdkCondWait(&s_gfnOpenUrl.cond, &s_gfnOpenUrl.lock);
+            continue;
+        }
+
+        now = gfnSdkGetTimeMs();
+        waitMs = gfnOpenUrlBucketWaitMs(&s_gfnOpenUrl.perSecond, now);
+        bucketWaitMs = gfnOpenUrlBucketWaitMs(&s_gfnOpenUrl.perMinute, now);
+        if (bucketWaitMs > waitMs)
+        {
+            waitMs = bucketWaitMs;
+        }
+        if (s_gfnOpenUrl.holdUntilMs > now && s_gfnOpenUrl.holdUntilMs - now > waitMs)
+        {
+            waitMs = s_gfnOpenUrl.holdUntilMs - now;
+        }
+        if (waitMs > 0)
+        {
+            gfnSdkCondTimedWait(&s_gfnOpenUrl.cond, &s_gfnOpenUrl.lock, (uint32_t)waitMs);
+            continue;
+        }
+
+        request = s_gfnOpenUrl.queue[s_gfnOpenUrl.head];
+        memset(&s_gfnOpenUrl.queue[s_gfnOpenUrl.head], 0, sizeof(gfnOpenUrlRequest));
+        s_gfnOpenUrl.head = (s_gfnOpenUrl.head + 1) % GFN_OPEN_URL_MAX_QUEUED;
+        s_gfnOpenUrl.count--;
+        gfnOpenUrlBucketSpend(&s_gfnOpenUrl.perSecond, now);
+        gfnOpenUrlBucketSpend(&s_gfnOpenUrl.perMinute, now);
+        gfnSdkMutexUnlock(&s_gfnOpenUrl.lock);
+
+        status = GfnOpenURLOnClient(request.pchUrl);
+
+        gfnSdkMutexLock(&s_gfnOpenUrl.lock);
+        if (status == gfnThrottled && request.throttledRetries < GFN_OPEN_URL_MAX_THROTTLED_RETRIES
+            && s_gfnOpenUrl.count < GFN_OPEN_URL_MAX_QUEUED && !s_gfnOpenUrl.stopping)
+        {
+            // Someone else is spending tokens too. Put the request back at the front of the
+            // queue and give the server's second window time to drain.
+            request.throttledRetries++;
+            s_gfnOpenUrl.head = (s_gfnOpenUrl.head + GFN_OPEN_URL_MAX_QUEUED - 1) % GFN_OPEN_URL_MAX_QUEUED;
+            s_gfnOpenUrl.queue[s_gfnOpenUrl.head] = request;
+            s_gfnOpenUrl.count++;
+            s_gfnOpenUrl.holdUntilMs = gfnSdkGetTimeMs() + GFN_OPEN_URL_SECOND_WINDOW_MS;
+            continue;
+        }
+        gfnSdkMutexUnlock(&s_gfnOpenUrl.lock);
+        gfnOpenUrlComplete(&request, status);
+        gfnSdkMutexLock(&s_gfnOpenUrl.lock);
+    }
+    gfnSdkMutexUnlock(&s_gfnOpenUrl.lock);
+}
+
+GfnRuntimeError GfnOpenUrlSchedulerInitialize(void)
+{
+    if (s_gfnOpenUrl.initialized)
+    {
+        return gfnInvalidParameter;
+    }
+
+    memset(&s_gfnOpenUrl, 0, sizeof(s_gfnOpenUrl));
+    gfnOpenUrlBucketInit(&s_gfnOpenUrl.perSecond, GFN_OPEN_URL_PER_SECOND_LIMIT, GFN_OPEN_URL_SECOND_WINDOW_MS);
+    gfnOpenUrlBucketInit(&s_gfnOpenUrl.perMinute, GFN_OPEN_URL_PER_MINUTE_LIMIT, GFN_OPEN_URL_MINUTE_WINDOW_MS);
+
+    if (!gfnSdkMutexInit(&s_gfnOpenUrl.lock))
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkCondInit(&s_gfnOpenUrl.cond))
+    {
+        gfnSdkMutexDestroy(&s_gfnOpenUrl.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkThreadCreate(&s_gfnOpenUrl.thread, gfnOpenUrlThread, NULL))
+    {
+        gfnSdkCondDestroy(&s_gfnOpenUrl.cond);
+        gfnSdkMutexDestroy(&s_gfnOpenUrl.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnOpenUrl.initialized = true;
+    return gfnSuccess;
+}
+
+void GfnOpenUrlSchedulerShutdown(void)
+{
+    unsigned int i = 0;
+
+    if (!s_gfnOpenUrl.initialized)
+    {
+        return;
+    }
+
+    gfnSdkMutexLock(&s_gfnOpenUrl.lock);
+    s_gfnOpenUrl.stopping = true;
+    gfnSdkCondSignal(&s_gfnOpenUrl.cond);
+    gfnSdkMutexUnlock(&s_gfnOpenUrl.lock);
+    gfnSdkThreadJoin(s_gfnOpenUrl.thread);
+
+    // The thread is gone, so the queue can be drained without the lock
+    s_gfnOpenUrl.initialized = false;
+    for (i = 0; i < s_gfnOpenUrl.count; i++)
+    {
+        gfnOpenUrlComplete(&s_gfnOpenUrl.queue[(s_gfnOpenUrl.head + i) % GFN_OPEN_URL_MAX_QUEUED], gfnCanceled);
+    }
+    s_gfnOpenUrl.count = 0;
+    gfnSdkCondDestroy(&s_gfnOpenUrl.cond);
+    gfnSdkMutexDestroy(&s_gfnOpenUrl.lock);
+}
+
+GfnRuntimeError GfnOpenURLOnClientScheduled(const char* pchUrl, GfnOpenUrlCallbackSig callback, void* pUserContext)
+{
+    size_t length = 0;
+    uint32_t hash = 0;
+    unsigned int i = 0;
+    gfnOpenUrlRequest* pRequest = NULL;
+    gfnOpenUrlWaiter* pWaiter = NULL;
+    gfnOpenUrlWaiter** ppTail = NULL;
+    char* pchCopy = NULL;
+
+    if (!s_gfnOpenUrl.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (!gfnOpenUrlValidate(pchUrl, &length, &hash))
+    {
+        return gfnInvalidParameter;
+    }
+
+    // Allocate outside of the lock, the common case is a new URL
+    pWaiter = (gfnOpenUrlWaiter*)malloc(sizeof(gfnOpenUrlWaiter));
+    if (pWaiter == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    pWaiter->callback = callback;
+    pWaiter->pUserContext = pUserContext;
+    pWaiter->pNext = NULL;
+
+    gfnSdkMutexLock(&s_gfnOpenUrl.lock);
+    for (i = 0; i < s_gfnOpenUrl.count; i++)
+    {
+        pRequest = &s_gfnOpenUrl.queue[(s_gfnOpenUrl.head + i) % GFN_OPEN_URL_MAX_QUEUED];
+        if (pRequest->hash == hash && pRequest->length == length && memcmp(pRequest->pchUrl, pchUrl, length) == 0)
+        {
+            // Collapse into the queued request, callers are notified in the order they asked
+            for (ppTail = &pRequest->pWaiters; *ppTail != NULL; ppTail = &(*ppTail)->pNext)
+            {
+            }
+            *ppTail = pWaiter;
+            gfnSdkMutexUnlock(&s_gfnOpenUrl.lock);
+            return gfnSuccess;
+        }
+    }
+    if (s_gfnOpenUrl.count >= GFN_OPEN_URL_MAX_QUEUED)
+    {
+        gfnSdkMutexUnlock(&s_gfnOpenUrl.lock);
+        free(pWaiter);
+        return gfnThrottled;
+    }
+    pchCopy = (char*)malloc(length + 1);
+    if (pchCopy == NULL)
+    {
+        gfnSdkMutexUnlock(&s_gfnOpenUrl.lock);
+        free(pWaiter);
+        return gfnUnableToAllocateMemory;
+    }
+    memcpy(pchCopy, pchUrl, length + 1);
+
+    pRequest = &s_gfnOpenUrl.queue[(s_gfnOpenUrl.head + s_gfnOpenUrl.count) % GFN_OPEN_URL_MAX_QUEUED];
+    pRequest->pchUrl = pchCopy;
+    pRequest->length = length;
+    pRequest->hash = hash;
+    pRequest->throttledRetries = 0;
+    pRequest->pWaiters = pWaiter;
+    s_gfnOpenUrl.count++;
+    gfnSdkCondSignal(&s_gfnOpenUrl.cond);
+    gfnSdkMutexUnlock(&s_gfnOpenUrl.lock);
+    return gfnSuccess;
+}
+
+unsigned int GfnOpenUrlSchedulerGetQueuedCount(void)
+{
+    unsigned int count = 0;
+
+    if (!s_gfnOpenUrl.initialized)
+    {
+        return 0;
+    }
+    gfnSdkMutexLock(&s_gfnOpenUrl.lock);
+    count = s_gfnOpenUrl.count;
+    gfnSdkMutexUnlock(&s_gfnOpenUrl.lock);
+    return count;
+}
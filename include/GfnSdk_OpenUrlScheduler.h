@@ -0,0 +1,163 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Client-side rate limiting scheduler for GfnOpenURLOnClient
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_OpenUrlScheduler.h
+*
+* Optional rate limiting scheduler for @ref GfnOpenURLOnClient
+*/
+///
+/// @page open_url_scheduler Open URL Scheduler
+///
+/// @section open_url_scheduler_introduction Introduction
+/// @ref GfnOpenURLOnClient is limited to @ref GFN_OPEN_URL_PER_SECOND_LIMIT requests per second
+/// and @ref GFN_OPEN_URL_PER_MINUTE_LIMIT requests per minute, and calls above either limit fail
+/// with gfnThrottled. This scheduler models both limits locally as token buckets, where each
+/// token returns to its bucket one full window after it was spent. Requests that arrive while a
+/// bucket is empty are queued and released by a helper thread as soon as tokens are available,
+/// so no IPC call is spent on a request the server would throttle.
+///
+/// Requests for a URL that is already queued are collapsed into the queued request, and every
+/// caller is notified when it completes. Requests the server would reject are failed locally:
+/// NULL URLs, URLs of @ref GFN_OPEN_URL_MAX_LEN_WITH_NULL characters or more, URLs that do not
+/// use the http or https scheme, and URLs containing characters outside of the RFC 3986 set.
+/// Non-ASCII characters must be percent-encoded.
+///
+/// Completion callbacks are invoked on the scheduler thread, without any internal lock held.
+///
+
+#ifndef __NV_GFNSDK_OPEN_URL_SCHEDULER_H__
+#define __NV_GFNSDK_OPEN_URL_SCHEDULER_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Number of @ref GfnOpenURLOnClient calls allowed per second
+#define GFN_OPEN_URL_PER_SECOND_LIMIT 5
+/// @brief Number of @ref GfnOpenURLOnClient calls allowed per minute
+#define GFN_OPEN_URL_PER_MINUTE_LIMIT 25
+/// @brief Maximum URL length accepted by the client browser, including the NUL terminator
+#define GFN_OPEN_URL_MAX_LEN_WITH_NULL 2048
+/// @brief Maximum number of distinct URLs waiting in the queue
+#define GFN_OPEN_URL_MAX_QUEUED 64
+/// @brief Number of times a request is requeued if the server still reports gfnThrottled,
+/// for example because the application also calls @ref GfnOpenURLOnClient directly
+#define GFN_OPEN_URL_MAX_THROTTLED_RETRIES 3
+
+///
+/// @brief Callback invoked once for every accepted @ref GfnOpenURLOnClientScheduled call
+///
+/// @param status       - Result of the @ref GfnOpenURLOnClient call made for the request, or
+///                       gfnCanceled if the scheduler was shut down before it was sent
+/// @param pchUrl       - The requested URL, only valid for the duration of the callback
+/// @param pUserContext - Context passed to @ref GfnOpenURLOnClientScheduled
+///
+typedef void (GFN_CALLBACK *GfnOpenUrlCallbackSig)(GfnRuntimeError status, const char* pchUrl, void* pUserContext);
+
+///
+/// @par Description
+/// Starts the Open URL scheduler.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call once after @ref GfnInitializeSdk
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - The scheduler is already running
+/// @retval gfnUnableToAllocateMemory - The scheduler thread could not be created
+GfnRuntimeError GfnOpenUrlSchedulerInitialize(void);
+
+///
+/// @par Description
+/// Stops the Open URL scheduler. Requests still in the queue are completed with gfnCanceled
+/// before this function returns.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call before @ref GfnShutdownSdk. Must not be called from a scheduler callback.
+void GfnOpenUrlSchedulerShutdown(void);
+
+///
+/// @par Description
+/// Requests the client application to open a URL in their local web browser, as soon as doing
+/// so does not exceed the API rate limits.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Use instead of @ref GfnOpenURLOnClient when the application may open URLs in bursts.
+///
+/// @param pchUrl                   - A URL which should be opened on the client's local browser
+/// @param callback                 - Optional, called once the request completes
+/// @param pUserContext             - Pointer to user context passed unmodified to callback. Can be NULL.
+///
+/// @retval gfnSuccess                - The request was queued, or merged into an identical queued request
+/// @retval gfnAPINotInit             - @ref GfnOpenUrlSchedulerInitialize was not called
+/// @retval gfnInvalidParameter       - The URL is NULL, too long, or malformed. The callback is not called.
+/// @retval gfnThrottled              - The queue is full. The callback is not called.
+/// @retval gfnUnableToAllocateMemory - The request could not be queued. The callback is not called.
+GfnRuntimeError GfnOpenURLOnClientScheduled(const char* pchUrl, GfnOpenUrlCallbackSig callback, void* pUserContext);
+
+///
+/// @par Description
+/// Returns the number of distinct URLs waiting in the queue.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+unsigned int GfnOpenUrlSchedulerGetQueuedCount(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_OPEN_URL_SCHEDULER_H__
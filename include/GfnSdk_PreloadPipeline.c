@@ -0,0 +1,958 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_PreloadPipeline.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GFN_PRELOAD_DEFAULT_THREADS 4
+#define GFN_PRELOAD_MAX_THREADS 64
+#define GFN_PRELOAD_DEFAULT_READY_BUDGET_MS 30000
+#define GFN_PRELOAD_DEFAULT_SAFETY_MARGIN_MS 3000
+
+typedef struct gfnPreloadTask
+{
+    char* pchName;
+    GfnPreloadStage stage;
+    bool critical;
+    GfnPreloadTaskSig run;
+    void* pUserContext;
+    GfnPreloadTaskId* pDependencies;
+    unsigned int numDependencies;
+    int priority;
+    unsigned int estimatedMs;
+
+    GfnPreloadTaskId* pDependents;      // Built when the pipeline starts
+    unsigned int numDependents;
+    unsigned int numPending;            // Unfinished dependencies, plus one for user tasks until SessionInit
+    bool dependencyFailed;
+    bool deferred;
+    bool neededForReady;                // Critical, or a critical task depends on it, directly or not
+
+    GfnPreloadTaskStatus status;
+    GfnRuntimeError result;
+    uint64_t startedMs;
+    uint64_t durationMs;
+} gfnPreloadTask;
+
+// Runnable tasks of one worker. The owner takes the newest task, thieves the oldest.
+typedef struct gfnPreloadWorker
+{
+    GfnSdkMutex lock;
+    GfnPreloadTaskId* pQueue;           // Ring buffer with room for every task
+    unsigned int head;
+    unsigned int count;
+    GfnSdkThread thread;
+    bool threadValid;
+} gfnPreloadWorker;
+
+typedef struct gfnPreloadPipeline
+{
+    bool initialized;
+    bool started;
+    bool stopping;
+    GfnPreloadPipelineConfig config;
+
+    // Protects everything below, except the worker queues. Taken before a worker lock, never after.
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;                 // Signaled when tasks are queued, when a task finishes, and on shutdown
+
+    gfnPreloadTask* pTasks;
+    unsigned int numTasks;
+    unsigned int capacity;
+
+    gfnPreloadWorker* pWorkers;
+    unsigned int numWorkers;
+    unsigned int nextWorker;            // Worker receiving the next task queued from outside the pool
+    unsigned int numQueued;             // Tasks in the worker queues and the user queue
+
+    // Runnable user stage tasks, a binary heap ordered by priority, then by task id
+    GfnPreloadTaskId* pUserQueue;
+    unsigned int numUserQueued;
+    // User stage tasks deferred until after ready
+    GfnPreloadTaskId* pDeferred;
+    unsigned int numDeferred;
+    uint64_t readyDeadlineMs;           // Time GfnAppReady is called at the latest, once the session started
+    GfnSdkThread deadlineThread;
+    bool deadlineThreadValid;
+
+    unsigned int numRemaining[GfnPreloadStageCount];
+    unsigned int numCriticalRemaining;
+    bool criticalFailed;
+    char criticalStatus[128];           // Status passed to GfnAppReady on failure
+    bool sessionStarted;
+    char* pchSessionParams;
+    GfnPreloadPipelineStats stats;
+} gfnPreloadPipeline;
+
+static gfnPreloadPipeline s_gfnPreload;
+
+static void gfnPreloadPush(gfnPreloadWorker* pWorker, GfnPreloadTaskId id)
+{
+    gfnSdkMutexLock(&pWorker->lock);
+    pWorker->pQueue[(pWorker->head + pWorker->count) % s_gfnPreload.numTasks] = id;
+    pWorker->count++;
+    gfnSdkMutexUnlock(&pWorker->lock);
+}
+
+static bool gfnPreloadRunsBefore(GfnPreloadTaskId a, GfnPreloadTaskId b)
+{
+    const gfnPreloadTask* pA = &s_gfnPreload.pTasks[a];
+    const gfnPreloadTask* pB = &s_gfnPreload.pTasks[b];
+
+    return pA->priority > pB->priority || (pA->priority == pB->priority && a < b);
+}
+
+static void gfnPreloadUserQueuePush(GfnPreloadTaskId id)
+{
+    GfnPreloadTaskId* pHeap = s_gfnPreload.pUserQueue;
+    unsigned int i = s_gfnPreload.numUserQueued++;
+    unsigned int parent = 0;
+
+    while (i > 0)
+    {
+        parent = (i - 1) / 2;
+        if (!gfnPreloadRunsBefore(id, pHeap[parent]))
+        {
+            break;
+        }
+        pHeap[i] = pHeap[parent];
+        i = parent;
+    }
+    pHeap[i] = id;
+}
+
+static GfnPreloadTaskId gfnPreloadUserQueuePop(void)
+{
+    GfnPreloadTaskId* pHeap = s_gfnPreload.pUserQueue;
+    GfnPreloadTaskId top = pHeap[0];
+    GfnPreloadTaskId last = pHeap[--s_gfnPreload.numUserQueued];
+    unsigned int i = 0;
+    unsigned int child = 0;
+
+    while ((child = 2 * i + 1) < s_gfnPreload.numUserQueued)
+    {
+        if (child + 1 < s_gfnPreload.numUserQueued && gfnPreloadRunsBefore(pHeap[child + 1], pHeap[child]))
+        {
+            child++;
+        }
+        if (!gfnPreloadRunsBefore(pHeap[child], last))
+        {
+            break;
+        }
+        pHeap[i] = pHeap[child];
+        i = child;
+    }
+    pHeap[i] = last;
+    return top;
+}
+
+// Called with the pipeline lock held. Takes the user stage task to run next, deferring the tasks
+// that would not finish before the ready deadline. Only tasks that neither ready nor other tasks
+// wait for are deferred, so deferring never holds up the critical tasks.
+static bool gfnPreloadPopUser(GfnPreloadTaskId* pId)
+{
+    gfnPreloadTask* pTask = NULL;
+    GfnPreloadTaskId id = 0;
+    uint64_t nowMs = gfnSdkGetTimeMs();
+
+    while (s_gfnPreload.numUserQueued > 0)
+    {
+        id = gfnPreloadUserQueuePop();
+        pTask = &s_gfnPreload.pTasks[id];
+        if (!s_gfnPreload.stats.readyReported && !pTask->deferred && !pTask->dependencyFailed && !pTask->neededForReady
+            && pTask->numDependents == 0 && pTask->estimatedMs > 0 && nowMs + pTask->estimatedMs > s_gfnPreload.readyDeadlineMs)
+        {
+            pTask->deferred = true;
+            s_gfnPreload.pDeferred[s_gfnPreload.numDeferred++] = id;
+            s_gfnPreload.stats.numDeferred++;
+            s_gfnPreload.numQueued--;
+            continue;
+        }
+        *pId = id;
+        return true;
+    }
+    return false;
+}
+
+// Called with the pipeline lock held. Queues a task whose dependencies all finished.
+static void gfnPreloadQueue(gfnPreloadWorker* pWorker, GfnPreloadTaskId id)
+{
+    if (s_gfnPreload.pTasks[id].stage == GfnPreloadStageUser)
+    {
+        gfnPreloadUserQueuePush(id);
+        s_gfnPreload.numQueued++;
+        return;
+    }
+    if (pWorker == NULL)
+    {
+        pWorker = &s_gfnPreload.pWorkers[s_gfnPreload.nextWorker];
+        s_gfnPreload.nextWorker = (s_gfnPreload.nextWorker + 1) % s_gfnPreload.numWorkers;
+    }
+    gfnPreloadPush(pWorker, id);
+    s_gfnPreload.numQueued++;
+}
+
+static bool gfnPreloadPopOwn(gfnPreloadWorker* pWorker, GfnPreloadTaskId* pId)
+{
+    bool found = false;
+
+    gfnSdkMutexLock(&pWorker->lock);
+    if (pWorker->count > 0)
+    {
+        pWorker->count--;
+        *pId = pWorker->pQueue[(pWorker->head + pWorker->count) % s_gfnPreload.numTasks];
+        found = true;
+    }
+    gfnSdkMutexUnlock(&pWorker->lock);
+    return found;
+}
+
+static bool gfnPreloadSteal(gfnPreloadWorker* pVictim, GfnPreloadTaskId* pId)
+{
+    bool found = false;
+
+    gfnSdkMutexLock(&pVictim->lock);
+    if (pVictim->count > 0)
+    {
+        *pId = pVictim->pQueue[pVictim->head];
+        pVictim->head = (pVictim->head + 1) % s_gfnPreload.numTasks;
+        pVictim->count--;
+        found = true;
+    }
+    gfnSdkMutexUnlock(&pVictim->lock);
+    return found;
+}
+
+// Called with the pipeline lock held. Returns true if GfnAppReady should be called now, which
+// atDeadline forces. Success is only reported once every critical task succeeded.
+static bool gfnPreloadTakeReady(bool atDeadline, bool* pSuccess)
+{
+    unsigned int i = 0;
+
+    if (!s_gfnPreload.sessionStarted || s_gfnPreload.stats.readyReported)
+    {
+        return false;
+    }
+    if (!s_gfnPreload.criticalFailed && s_gfnPreload.numCriticalRemaining > 0 && !atDeadline)
+    {
+        return false;
+    }
+    if (!s_gfnPreload.criticalFailed && s_gfnPreload.numCriticalRemaining > 0)
+    {
+        snprintf(s_gfnPreload.criticalStatus, sizeof(s_gfnPreload.criticalStatus),
+            "Ready deadline reached with %u critical tasks still loading", s_gfnPreload.numCriticalRemaining);
+    }
+    *pSuccess = !s_gfnPreload.criticalFailed && s_gfnPreload.numCriticalRemaining == 0;
+    s_gfnPreload.stats.readyReported = true;
+    s_gfnPreload.stats.readySuccess = *pSuccess;
+    s_gfnPreload.stats.readyMs = gfnSdkGetTimeMs();
+    s_gfnPreload.stats.timeToReadyMs = s_gfnPreload.stats.readyMs - s_gfnPreload.stats.sessionInitMs;
+    s_gfnPreload.stats.readyAtDeadline = (s_gfnPreload.numCriticalRemaining > 0 && !s_gfnPreload.criticalFailed);
+    s_gfnPreload.stats.numCriticalPending = s_gfnPreload.numCriticalRemaining;
+
+    // The deferred tasks run now, in priority order
+    for (i = 0; i < s_gfnPreload.numDeferred; i++)
+    {
+        gfnPreloadUserQueuePush(s_gfnPreload.pDeferred[i]);
+        s_gfnPreload.numQueued++;
+    }
+    s_gfnPreload.numDeferred = 0;
+    gfnSdkCondBroadcast(&s_gfnPreload.cond);
+    return true;
+}
+
+// Called without the pipeline lock held, once, by the thread that took the ready decision
+static void gfnPreloadReportReady(bool success)
+{
+    GfnRuntimeError result = GfnAppReady(success, success ? "Preload complete" : s_gfnPreload.criticalStatus);
+    GfnPreloadPipelineStats stats;
+
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    s_gfnPreload.stats.readyResult = result;
+    stats = s_gfnPreload.stats;
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+
+    if (s_gfnPreload.config.readyCallback != NULL)
+    {
+        s_gfnPreload.config.readyCallback(success, &stats, s_gfnPreload.config.pReadyContext);
+    }
+}
+
+// Called with the pipeline lock held, after a task finished, failed or was skipped
+static void gfnPreloadFinish(gfnPreloadWorker* pWorker, gfnPreloadTask* pTask)
+{
+    GfnPreloadStageStats* pStage = &s_gfnPreload.stats.stages[pTask->stage];
+    unsigned int i = 0;
+
+    switch (pTask->status)
+    {
+    case GfnPreloadTaskSucceeded:
+        pStage->numSucceeded++;
+        break;
+    case GfnPreloadTaskFailed:
+        pStage->numFailed++;
+        break;
+    default:
+        pStage->numSkipped++;
+        break;
+    }
+    pStage->taskMs += pTask->durationMs;
+
+    if (pTask->critical)
+    {
+        s_gfnPreload.numCriticalRemaining--;
+        if (pTask->status != GfnPreloadTaskSucceeded && !s_gfnPreload.criticalFailed)
+        {
+            s_gfnPreload.criticalFailed = true;
+            snprintf(s_gfnPreload.criticalStatus, sizeof(s_gfnPreload.criticalStatus), "Loading %s %s: %s",
+                pTask->pchName, pTask->status == GfnPreloadTaskFailed ? "failed" : "skipped",
+                GfnErrorToString(pTask->result));
+        }
+    }
+
+    for (i = 0; i < pTask->numDependents; i++)
+    {
+        gfnPreloadTask* pDependent = &s_gfnPreload.pTasks[pTask->pDependents[i]];
+        if (pTask->status != GfnPreloadTaskSucceeded)
+        {
+            pDependent->dependencyFailed = true;
+        }
+        if (--pDependent->numPending == 0)
+        {
+            // Keep the follow-up work on this worker; idle workers steal it if needed
+            gfnPreloadQueue(pWorker, pTask->pDependents[i]);
+        }
+    }
+
+    if (--s_gfnPreload.numRemaining[pTask->stage] == 0)
+    {
+        pStage->finishedMs = gfnSdkGetTimeMs();
+        pStage->wallMs = pStage->finishedMs - pStage->startedMs;
+    }
+    gfnSdkCondBroadcast(&s_gfnPreload.cond);
+}
+
+static void gfnPreloadRun(gfnPreloadWorker* pWorker, GfnPreloadTaskId id, bool stolen)
+{
+    gfnPreloadTask* pTask = &s_gfnPreload.pTasks[id];
+    GfnRuntimeError result = gfnCanceled;
+    const char* pchSessionParams = NULL;
+    bool ready = false;
+    bool success = false;
+    bool skip = false;
+
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    s_gfnPreload.numQueued--;
+    if (stolen)
+    {
+        s_gfnPreload.stats.numSteals++;
+    }
+    skip = pTask->dependencyFailed;
+    pTask->status = skip ? GfnPreloadTaskSkipped : GfnPreloadTaskRunning;
+    pTask->startedMs = gfnSdkGetTimeMs();
+    // The session parameters do not change once the user stage started
+    pchSessionParams = (pTask->stage == GfnPreloadStageUser) ? s_gfnPreload.pchSessionParams : NULL;
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+
+    if (!skip)
+    {
+        result = pTask->run(pchSessionParams, pTask->pUserContext);
+    }
+
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    pTask->durationMs = gfnSdkGetTimeMs() - pTask->startedMs;
+    pTask->result = result;
+    if (!skip)
+    {
+        pTask->status = GFNSDK_SUCCEEDED(result) ? GfnPreloadTaskSucceeded : GfnPreloadTaskFailed;
+    }
+    gfnPreloadFinish(pWorker, pTask);
+    ready = gfnPreloadTakeReady(false, &success);
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+
+    if (ready)
+    {
+        gfnPreloadReportReady(success);
+    }
+}
+
+static void gfnPreloadWorkerThread(void* pContext)
+{
+    gfnPreloadWorker* pWorker = (gfnPreloadWorker*)pContext;
+    unsigned int index = (unsigned int)(pWorker - s_gfnPreload.pWorkers);
+    GfnPreloadTaskId id = 0;
+    unsigned int i = 0;
+    bool found = false;
+
+    for (;;)
+    {
+        // User stage tasks are on the path to ready, so they go first
+        gfnSdkMutexLock(&s_gfnPreload.lock);
+        found = gfnPreloadPopUser(&id);
+        gfnSdkMutexUnlock(&s_gfnPreload.lock);
+        if (found)
+        {
+            gfnPreloadRun(pWorker, id, false);
+            continue;
+        }
+
+        found = gfnPreloadPopOwn(pWorker, &id);
+        if (found)
+        {
+            gfnPreloadRun(pWorker, id, false);
+            continue;
+        }
+        for (i = 1; i < s_gfnPreload.numWorkers && !found; i++)
+        {
+            found = gfnPreloadSteal(&s_gfnPreload.pWorkers[(index + i) % s_gfnPreload.numWorkers], &id);
+        }
+        if (found)
+        {
+            gfnPreloadRun(pWorker, id, true);
+            continue;
+        }
+
+        gfnSdkMutexLock(&s_gfnPreload.lock);
+        while (s_gfnPreload.numQueued == 0 && !s_gfnPreload.stopping)
+        {
+            gfnSdkCondWait(&s_gfnPreload.cond, &s_gfnPreload.lock);
+        }
+        if (s_gfnPreload.stopping)
+        {
+            gfnSdkMutexUnlock(&s_gfnPreload.lock);
+            return;
+        }
+        gfnSdkMutexUnlock(&s_gfnPreload.lock);
+    }
+}
+
+// Calls GfnAppReady at the ready deadline if the critical tasks have not finished by then
+static void gfnPreloadDeadlineThread(void* pContext)
+{
+    uint64_t nowMs = 0;
+    bool ready = false;
+    bool success = false;
+
+    (void)pContext;
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    while (!s_gfnPreload.stopping && !s_gfnPreload.stats.readyReported)
+    {
+        if (!s_gfnPreload.sessionStarted)
+        {
+            gfnSdkCondWait(&s_gfnPreload.cond, &s_gfnPreload.lock);
+            continue;
+        }
+        nowMs = gfnSdkGetTimeMs();
+        if (nowMs >= s_gfnPreload.readyDeadlineMs)
+        {
+            ready = gfnPreloadTakeReady(true, &success);
+            break;
+        }
+        gfnSdkCondTimedWait(&s_gfnPreload.cond, &s_gfnPreload.lock, (uint32_t)(s_gfnPreload.readyDeadlineMs - nowMs));
+    }
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+
+    if (ready)
+    {
+        gfnPreloadReportReady(success);
+    }
+}
+
+static GfnApplicationCallbackResult GFN_CALLBACK gfnPreloadSessionInit(const char* pchSessionParams, void* pContext)
+{
+    (void)pContext;
+    // Only queues the user stage, so the SDK callback thread is released right away
+    return GFNSDK_SUCCEEDED(GfnPreloadPipelineBeginSession(pchSessionParams)) ? crCallbackSuccess : crCallbackFailure;
+}
+
+// Builds the dependents lists. Dependencies always refer to earlier tasks, so the graph has no cycles.
+static bool gfnPreloadBuildGraph(void)
+{
+    unsigned int i = 0;
+    unsigned int j = 0;
+    gfnPreloadTask* pTask = NULL;
+    gfnPreloadTask* pDependency = NULL;
+
+    for (i = 0; i < s_gfnPreload.numTasks; i++)
+    {
+        pTask = &s_gfnPreload.pTasks[i];
+        for (j = 0; j < pTask->numDependencies; j++)
+        {
+            s_gfnPreload.pTasks[pTask->pDependencies[j]].numDependents++;
+        }
+    }
+    for (i = 0; i < s_gfnPreload.numTasks; i++)
+    {
+        pTask = &s_gfnPreload.pTasks[i];
+        if (pTask->numDependents > 0)
+        {
+            pTask->pDependents = (GfnPreloadTaskId*)malloc(pTask->numDependents * sizeof(GfnPreloadTaskId));
+            if (pTask->pDependents == NULL)
+            {
+                return false;
+            }
+            pTask->numDependents = 0;
+        }
+    }
+    for (i = 0; i < s_gfnPreload.numTasks; i++)
+    {
+        pTask = &s_gfnPreload.pTasks[i];
+        pTask->numPending = pTask->numDependencies + (pTask->stage == GfnPreloadStageUser ? 1 : 0);
+        for (j = 0; j < pTask->numDependencies; j++)
+        {
+            pDependency = &s_gfnPreload.pTasks[pTask->pDependencies[j]];
+            pDependency->pDependents[pDependency->numDependents++] = i;
+        }
+    }
+    // Dependencies always have lower ids, so one pass from the last task marks everything the
+    // critical tasks wait for
+    for (i = s_gfnPreload.numTasks; i-- > 0;)
+    {
+        pTask = &s_gfnPreload.pTasks[i];
+        pTask->neededForReady = pTask->neededForReady || pTask->critical;
+        for (j = 0; j < pTask->numDependencies && pTask->neededForReady; j++)
+        {
+            s_gfnPreload.pTasks[pTask->pDependencies[j]].neededForReady = true;
+        }
+    }
+    return true;
+}
+
+static void gfnPreloadStopWorkers(void)
+{
+    unsigned int i = 0;
+
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    s_gfnPreload.stopping = true;
+    gfnSdkCondBroadcast(&s_gfnPreload.cond);
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+
+    for (i = 0; i < s_gfnPreload.numWorkers; i++)
+    {
+        if (s_gfnPreload.pWorkers[i].threadValid)
+        {
+            gfnSdkThreadJoin(s_gfnPreload.pWorkers[i].thread);
+            s_gfnPreload.pWorkers[i].threadValid = false;
+        }
+    }
+    if (s_gfnPreload.deadlineThreadValid)
+    {
+        gfnSdkThreadJoin(s_gfnPreload.deadlineThread);
+        s_gfnPreload.deadlineThreadValid = false;
+    }
+}
+
+GfnRuntimeError GfnPreloadPipelineInitialize(const GfnPreloadPipelineConfig* pConfig)
+{
+    if (s_gfnPreload.initialized)
+    {
+        return gfnInvalidParameter;
+    }
+
+    memset(&s_gfnPreload, 0, sizeof(s_gfnPreload));
+    if (pConfig != NULL)
+    {
+        s_gfnPreload.config = *pConfig;
+    }
+    if (s_gfnPreload.config.numThreads == 0)
+    {
+        s_gfnPreload.config.numThreads = GFN_PRELOAD_DEFAULT_THREADS;
+    }
+    else if (s_gfnPreload.config.numThreads > GFN_PRELOAD_MAX_THREADS)
+    {
+        s_gfnPreload.config.numThreads = GFN_PRELOAD_MAX_THREADS;
+    }
+    if (s_gfnPreload.config.readyBudgetMs == 0)
+    {
+        s_gfnPreload.config.readyBudgetMs = GFN_PRELOAD_DEFAULT_READY_BUDGET_MS;
+    }
+    if (s_gfnPreload.config.readySafetyMarginMs == 0)
+    {
+        s_gfnPreload.config.readySafetyMarginMs = GFN_PRELOAD_DEFAULT_SAFETY_MARGIN_MS;
+    }
+    if (!gfnSdkMutexInit(&s_gfnPreload.lock))
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkCondInit(&s_gfnPreload.cond))
+    {
+        gfnSdkMutexDestroy(&s_gfnPreload.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnPreload.initialized = true;
+    return gfnSuccess;
+}
+
+void GfnPreloadPipelineShutdown(void)
+{
+    unsigned int i = 0;
+
+    if (!s_gfnPreload.initialized)
+    {
+        return;
+    }
+
+    if (s_gfnPreload.pWorkers != NULL)
+    {
+        gfnPreloadStopWorkers();
+        for (i = 0; i < s_gfnPreload.numWorkers; i++)
+        {
+            gfnSdkMutexDestroy(&s_gfnPreload.pWorkers[i].lock);
+            free(s_gfnPreload.pWorkers[i].pQueue);
+        }
+        free(s_gfnPreload.pWorkers);
+    }
+    for (i = 0; i < s_gfnPreload.numTasks; i++)
+    {
+        free(s_gfnPreload.pTasks[i].pchName);
+        free(s_gfnPreload.pTasks[i].pDependencies);
+        free(s_gfnPreload.pTasks[i].pDependents);
+    }
+    free(s_gfnPreload.pTasks);
+    free(s_gfnPreload.pUserQueue);
+    free(s_gfnPreload.pDeferred);
+    free(s_gfnPreload.pchSessionParams);
+
+    s_gfnPreload.initialized = false;
+    gfnSdkCondDestroy(&s_gfnPreload.cond);
+    gfnSdkMutexDestroy(&s_gfnPreload.lock);
+    memset(&s_gfnPreload, 0, sizeof(s_gfnPreload));
+}
+
+GfnRuntimeError GfnPreloadAddTask(const GfnPreloadTaskDesc* pDesc, GfnPreloadTaskId* pId)
+{
+    gfnPreloadTask* pTask = NULL;
+    gfnPreloadTask* pTasks = NULL;
+    unsigned int capacity = 0;
+    unsigned int i = 0;
+    const char* pchName = NULL;
+    size_t nameLength = 0;
+
+    if (!s_gfnPreload.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pDesc == NULL || pDesc->run == NULL || (unsigned int)pDesc->stage >= GfnPreloadStageCount
+        || (pDesc->numDependencies > 0 && pDesc->pDependencies == NULL) || s_gfnPreload.started)
+    {
+        return gfnInvalidParameter;
+    }
+    for (i = 0; i < pDesc->numDependencies; i++)
+    {
+        // Only earlier tasks can be dependencies, which rules out cycles
+        if (pDesc->pDependencies[i] >= s_gfnPreload.numTasks
+            || s_gfnPreload.pTasks[pDesc->pDependencies[i]].stage > pDesc->stage)
+        {
+            return gfnInvalidParameter;
+        }
+    }
+
+    if (s_gfnPreload.numTasks == s_gfnPreload.capacity)
+    {
+        capacity = (s_gfnPreload.capacity == 0) ? 16 : s_gfnPreload.capacity * 2;
+        pTasks = (gfnPreloadTask*)realloc(s_gfnPreload.pTasks, capacity * sizeof(gfnPreloadTask));
+        if (pTasks == NULL)
+        {
+            return gfnUnableToAllocateMemory;
+        }
+        s_gfnPreload.pTasks = pTasks;
+        s_gfnPreload.capacity = capacity;
+    }
+
+    pTask = &s_gfnPreload.pTasks[s_gfnPreload.numTasks];
+    memset(pTask, 0, sizeof(*pTask));
+    pchName = (pDesc->pchName != NULL) ? pDesc->pchName : "";
+    nameLength = strlen(pchName) + 1;
+    pTask->pchName = (char*)malloc(nameLength);
+    if (pDesc->numDependencies > 0)
+    {
+        pTask->pDependencies = (GfnPreloadTaskId*)malloc(pDesc->numDependencies * sizeof(GfnPreloadTaskId));
+    }
+    if (pTask->pchName == NULL || (pDesc->numDependencies > 0 && pTask->pDependencies == NULL))
+    {
+        free(pTask->pchName);
+        free(pTask->pDependencies);
+        return gfnUnableToAllocateMemory;
+    }
+    memcpy(pTask->pchName, pchName, nameLength);
+    if (pDesc->numDependencies > 0)
+    {
+        memcpy(pTask->pDependencies, pDesc->pDependencies, pDesc->numDependencies * sizeof(GfnPreloadTaskId));
+    }
+    pTask->numDependencies = pDesc->numDependencies;
+    pTask->stage = pDesc->stage;
+    pTask->critical = pDesc->critical;
+    pTask->run = pDesc->run;
+    pTask->pUserContext = pDesc->pUserContext;
+    pTask->priority = pDesc->priority;
+    pTask->estimatedMs = pDesc->estimatedMs;
+    pTask->status = GfnPreloadTaskPending;
+
+    s_gfnPreload.stats.stages[pDesc->stage].numTasks++;
+    s_gfnPreload.numRemaining[pDesc->stage]++;
+    if (pDesc->critical)
+    {
+        s_gfnPreload.numCriticalRemaining++;
+    }
+    if (pId != NULL)
+    {
+        *pId = s_gfnPreload.numTasks;
+    }
+    s_gfnPreload.numTasks++;
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnPreloadPipelineStart(void)
+{
+    unsigned int i = 0;
+    unsigned int queueSize = 0;
+    gfnPreloadWorker* pWorker = NULL;
+    bool failed = false;
+
+    if (!s_gfnPreload.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (s_gfnPreload.started)
+    {
+        return gfnInvalidParameter;
+    }
+
+    if (!gfnPreloadBuildGraph())
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnPreload.numWorkers = s_gfnPreload.config.numThreads;
+    s_gfnPreload.pWorkers = (gfnPreloadWorker*)calloc(s_gfnPreload.numWorkers, sizeof(gfnPreloadWorker));
+    if (s_gfnPreload.pWorkers == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    queueSize = (s_gfnPreload.numTasks > 0) ? s_gfnPreload.numTasks : 1;
+    s_gfnPreload.pUserQueue = (GfnPreloadTaskId*)malloc(queueSize * sizeof(GfnPreloadTaskId));
+    s_gfnPreload.pDeferred = (GfnPreloadTaskId*)malloc(queueSize * sizeof(GfnPreloadTaskId));
+    if (s_gfnPreload.pUserQueue == NULL || s_gfnPreload.pDeferred == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    for (i = 0; i < s_gfnPreload.numWorkers && !failed; i++)
+    {
+        pWorker = &s_gfnPreload.pWorkers[i];
+        pWorker->pQueue = (GfnPreloadTaskId*)malloc(queueSize * sizeof(GfnPreloadTaskId));
+        if (pWorker->pQueue == NULL || !gfnSdkMutexInit(&pWorker->lock))
+        {
+            free(pWorker->pQueue);
+            s_gfnPreload.numWorkers = i;
+            failed = true;
+        }
+    }
+    if (failed)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnPreload.started = true;
+    s_gfnPreload.stats.numThreads = s_gfnPreload.numWorkers;
+
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    s_gfnPreload.stats.stages[GfnPreloadStageCommon].startedMs = gfnSdkGetTimeMs();
+    if (s_gfnPreload.numRemaining[GfnPreloadStageCommon] == 0)
+    {
+        s_gfnPreload.stats.stages[GfnPreloadStageCommon].finishedMs = s_gfnPreload.stats.stages[GfnPreloadStageCommon].startedMs;
+    }
+    for (i = 0; i < s_gfnPreload.numTasks; i++)
+    {
+        if (s_gfnPreload.pTasks[i].numPending == 0)
+        {
+            gfnPreloadQueue(NULL, i);
+        }
+    }
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+
+    for (i = 0; i < s_gfnPreload.numWorkers && !failed; i++)
+    {
+        pWorker = &s_gfnPreload.pWorkers[i];
+        pWorker->threadValid = gfnSdkThreadCreate(&pWorker->thread, gfnPreloadWorkerThread, pWorker);
+        failed = !pWorker->threadValid;
+    }
+    if (!failed)
+    {
+        s_gfnPreload.deadlineThreadValid = gfnSdkThreadCreate(&s_gfnPreload.deadlineThread, gfnPreloadDeadlineThread, NULL);
+        failed = !s_gfnPreload.deadlineThreadValid;
+    }
+    if (failed)
+    {
+        gfnPreloadStopWorkers();
+        return gfnUnableToAllocateMemory;
+    }
+
+    if (s_gfnPreload.config.manualSessionInit)
+    {
+        return gfnSuccess;
+    }
+    return GfnRegisterSessionInitCallback(gfnPreloadSessionInit, NULL);
+}
+
+GfnRuntimeError GfnPreloadPipelineBeginSession(const char* pchSessionParams)
+{
+    char* pchCopy = NULL;
+    size_t length = 0;
+    unsigned int i = 0;
+    bool ready = false;
+    bool success = false;
+    GfnPreloadStageStats* pStage = NULL;
+
+    if (!s_gfnPreload.initialized || !s_gfnPreload.started)
+    {
+        return gfnAPINotInit;
+    }
+    if (pchSessionParams != NULL)
+    {
+        length = strlen(pchSessionParams) + 1;
+        pchCopy = (char*)malloc(length);
+        if (pchCopy == NULL)
+        {
+            return gfnUnableToAllocateMemory;
+        }
+        memcpy(pchCopy, pchSessionParams, length);
+    }
+
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    if (s_gfnPreload.sessionStarted)
+    {
+        gfnSdkMutexUnlock(&s_gfnPreload.lock);
+        free(pchCopy);
+        return gfnInvalidParameter;
+    }
+    s_gfnPreload.sessionStarted = true;
+    s_gfnPreload.pchSessionParams = pchCopy;
+    s_gfnPreload.stats.sessionInitMs = gfnSdkGetTimeMs();
+    s_gfnPreload.readyDeadlineMs = s_gfnPreload.stats.sessionInitMs;
+    if (s_gfnPreload.config.readyBudgetMs > s_gfnPreload.config.readySafetyMarginMs)
+    {
+        s_gfnPreload.readyDeadlineMs += s_gfnPreload.config.readyBudgetMs - s_gfnPreload.config.readySafetyMarginMs;
+    }
+    pStage = &s_gfnPreload.stats.stages[GfnPreloadStageUser];
+    pStage->startedMs = s_gfnPreload.stats.sessionInitMs;
+    if (s_gfnPreload.numRemaining[GfnPreloadStageUser] == 0)
+    {
+        pStage->finishedMs = pStage->startedMs;
+    }
+    for (i = 0; i < s_gfnPreload.numTasks; i++)
+    {
+        if (s_gfnPreload.pTasks[i].stage == GfnPreloadStageUser && --s_gfnPreload.pTasks[i].numPending == 0)
+        {
+            gfnPreloadQueue(NULL, i);
+        }
+    }
+    gfnSdkCondBroadcast(&s_gfnPreload.cond);
+    ready = gfnPreloadTakeReady(false, &success);
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+
+    if (ready)
+    {
+        gfnPreloadReportReady(success);
+    }
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnPreloadPipelineWait(GfnPreloadStage stage, unsigned int timeoutMs)
+{
+    uint64_t deadlineMs = 0;
+    uint64_t nowMs = 0;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (!s_gfnPreload.initialized || !s_gfnPreload.started)
+    {
+        return gfnAPINotInit;
+    }
+    if ((unsigned int)stage >= GfnPreloadStageCount)
+    {
+        return gfnInvalidParameter;
+    }
+
+    deadlineMs = gfnSdkGetTimeMs() + timeoutMs;
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    while (s_gfnPreload.numRemaining[stage] > 0)
+    {
+        nowMs = gfnSdkGetTimeMs();
+        if (nowMs >= deadlineMs)
+        {
+            result = gfnTimedOut;
+            break;
+        }
+        gfnSdkCondTimedWait(&s_gfnPreload.cond, &s_gfnPreload.lock, (uint32_t)(deadlineMs - nowMs));
+    }
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+    return result;
+}
+
+GfnRuntimeError GfnPreloadGetTaskInfo(GfnPreloadTaskId id, GfnPreloadTaskInfo* pInfo)
+{
+    gfnPreloadTask* pTask = NULL;
+
+    if (!s_gfnPreload.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pInfo == NULL || id >= s_gfnPreload.numTasks)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    pTask = &s_gfnPreload.pTasks[id];
+    pInfo->pchName = pTask->pchName;
+    pInfo->stage = pTask->stage;
+    pInfo->status = pTask->status;
+    pInfo->result = pTask->result;
+    pInfo->deferred = pTask->deferred;
+    pInfo->startedMs = pTask->startedMs;
+    pInfo->durationMs = pTask->durationMs;
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnPreloadPipelineGetStats(GfnPreloadPipelineStats* pStats)
+{
+    if (!s_gfnPreload.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pStats == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&s_gfnPreload.lock);
+    *pStats = s_gfnPreload.stats;
+    gfnSdkMutexUnlock(&s_gfnPreload.lock);
+    return gfnSuccess;
+}
@@ -0,0 +1,363 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Staged, parallel asset pre-loading for pre-warm launches
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_PreloadPipeline.h
+*
+* Optional asset pre-load pipeline for the pre-warm flow built on @ref GfnRegisterSessionInitCallback
+* and @ref GfnAppReady
+*/
+///
+/// @page preload_pipeline Preload Pipeline
+///
+/// @section preload_pipeline_introduction Introduction
+/// A pre-warmed application loads everything it can before a user connects, and only the
+/// user's own data once the SessionInit callback arrives. The time between SessionInit and
+/// @ref GfnAppReady is what the user waits for, so both stages should load as much as possible
+/// in parallel, and report ready as soon as the data the first frame needs is loaded.
+///
+/// The pipeline runs application load tasks on a pool of worker threads:
+///
+/// - Tasks are registered with @ref GfnPreloadAddTask before the pipeline starts, each with the
+///   stage it belongs to and the tasks it depends on. A task runs once all of its dependencies
+///   succeeded. If a dependency fails, the task is skipped.
+/// - Common stage tasks start with @ref GfnPreloadPipelineStart. User stage tasks start once
+///   SessionInit arrives, and may depend on common stage tasks.
+/// - Every worker has its own queue. Tasks made runnable by a finished task go to the queue of
+///   the worker that finished it, and idle workers steal the oldest task from other queues.
+/// - Once SessionInit arrived and every task marked critical succeeded, @ref GfnAppReady is
+///   called with success. If a critical task fails or is skipped, it is called right away with
+///   failure. Non-critical tasks keep loading after ready.
+///
+/// Task functions run on the worker threads and must be safe to run in parallel with each other.
+/// Timing of both stages and of the time to ready is available from
+/// @ref GfnPreloadPipelineGetStats.
+///
+/// @section preload_pipeline_deadline Ready deadline
+/// GeForce NOW expects @ref GfnAppReady within 30 seconds of SessionInit, and starts streaming
+/// without it afterwards. The pipeline keeps that budget from the moment SessionInit arrives:
+///
+/// - Runnable user stage tasks are taken in order of @ref GfnPreloadTaskDesc::priority, ahead of
+///   any common stage work that is still queued.
+/// - Before ready, a non-critical user stage task whose @ref GfnPreloadTaskDesc::estimatedMs would
+///   end past the budget minus the safety margin is deferred until after ready, so it does not
+///   hold up tasks that still fit. Critical tasks, tasks that other tasks depend on, and tasks
+///   that critical tasks depend on are never deferred.
+/// - Once only the safety margin is left, GfnAppReady is called even if critical tasks are still
+///   running, so the application, not the timeout, decides what the user sees first. It reports
+///   failure in that case, with the number of critical tasks still loading as the status.
+///
+/// The number of deferred tasks, and whether ready was reported at the deadline, are part of
+/// @ref GfnPreloadPipelineStats.
+///
+
+#ifndef __NV_GFNSDK_PRELOAD_PIPELINE_H__
+#define __NV_GFNSDK_PRELOAD_PIPELINE_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Identifies a task added with @ref GfnPreloadAddTask
+typedef unsigned int GfnPreloadTaskId;
+
+/// @brief Stage a preload task belongs to
+typedef enum GfnPreloadStage
+{
+    GfnPreloadStageCommon = 0,      ///< Loads data shared by all users, during pre-warm
+    GfnPreloadStageUser,            ///< Loads data of the connected user, once SessionInit arrives
+    GfnPreloadStageCount
+} GfnPreloadStage;
+
+/// @brief State of a preload task
+typedef enum GfnPreloadTaskStatus
+{
+    GfnPreloadTaskPending = 0,      ///< Waiting for its stage or its dependencies
+    GfnPreloadTaskRunning,
+    GfnPreloadTaskSucceeded,
+    GfnPreloadTaskFailed,
+    GfnPreloadTaskSkipped           ///< A dependency failed or was skipped
+} GfnPreloadTaskStatus;
+
+///
+/// @brief Load task run by a pipeline worker thread
+///
+/// @param pchSessionParams - For user stage tasks, the parameters passed to SessionInit. NULL for common stage tasks.
+/// @param pUserContext     - Context from @ref GfnPreloadTaskDesc::pUserContext
+///
+/// @return gfnSuccess, or an error that fails the task
+///
+typedef GfnRuntimeError (GFN_CALLBACK *GfnPreloadTaskSig)(const char* pchSessionParams, void* pUserContext);
+
+/// @brief Description of a preload task passed to @ref GfnPreloadAddTask
+typedef struct GfnPreloadTaskDesc
+{
+    const char* pchName;                        ///< Name used in reports. Copied.
+    GfnPreloadStage stage;
+    bool critical;                              ///< GfnAppReady waits for the task to succeed
+    GfnPreloadTaskSig run;
+    void* pUserContext;                         ///< Passed unmodified to run
+    const GfnPreloadTaskId* pDependencies;      ///< Tasks that must succeed first. Copied.
+    unsigned int numDependencies;
+    int priority;                               ///< User stage: runnable tasks with a higher priority run first
+    unsigned int estimatedMs;                   ///< User stage: expected run time, 0 if unknown. Unknown tasks are never deferred.
+} GfnPreloadTaskDesc;
+
+/// @brief State and timing of a task. Times are from @ref gfnSdkGetTimeMs.
+typedef struct GfnPreloadTaskInfo
+{
+    const char* pchName;            ///< Valid until @ref GfnPreloadPipelineShutdown
+    GfnPreloadStage stage;
+    GfnPreloadTaskStatus status;
+    GfnRuntimeError result;         ///< Result of the task function once it ran
+    bool deferred;                  ///< The task was deferred until after ready
+    uint64_t startedMs;             ///< 0 until the task runs
+    uint64_t durationMs;
+} GfnPreloadTaskInfo;
+
+/// @brief Timing of a stage. Times are from @ref gfnSdkGetTimeMs.
+typedef struct GfnPreloadStageStats
+{
+    unsigned int numTasks;
+    unsigned int numSucceeded;
+    unsigned int numFailed;
+    unsigned int numSkipped;
+    uint64_t startedMs;             ///< Pipeline start for the common stage, SessionInit for the user stage. 0 until then.
+    uint64_t finishedMs;            ///< Time the last task of the stage finished, 0 until then
+    uint64_t wallMs;                ///< finishedMs - startedMs
+    uint64_t taskMs;                ///< Sum of the run times of the stage's tasks; taskMs / wallMs is the achieved parallelism
+} GfnPreloadStageStats;
+
+/// @brief Statistics of the pipeline returned by @ref GfnPreloadPipelineGetStats
+typedef struct GfnPreloadPipelineStats
+{
+    GfnPreloadStageStats stages[GfnPreloadStageCount];
+    unsigned int numThreads;
+    unsigned int numSteals;         ///< Tasks a worker took from the queue of another worker
+    uint64_t sessionInitMs;         ///< Time SessionInit arrived, 0 until then
+    bool readyReported;             ///< GfnAppReady was called
+    bool readySuccess;              ///< Value passed to GfnAppReady
+    GfnRuntimeError readyResult;    ///< Result of GfnAppReady
+    uint64_t readyMs;               ///< Time GfnAppReady was called
+    uint64_t timeToReadyMs;         ///< readyMs - sessionInitMs
+    bool readyAtDeadline;           ///< GfnAppReady was called at the safety margin, before all critical tasks finished
+    unsigned int numDeferred;       ///< User stage tasks deferred until after ready
+    unsigned int numCriticalPending;    ///< Critical tasks that had not finished when GfnAppReady was called
+} GfnPreloadPipelineStats;
+
+///
+/// @brief Callback invoked on a worker thread after the pipeline called @ref GfnAppReady
+///
+/// @param success      - Value passed to GfnAppReady
+/// @param pStats       - Statistics at the time of the call, only valid for the duration of the callback
+/// @param pUserContext - Context from @ref GfnPreloadPipelineConfig::pReadyContext
+///
+typedef void (GFN_CALLBACK *GfnPreloadReadyCallbackSig)(bool success, const GfnPreloadPipelineStats* pStats, void* pUserContext);
+
+/// @brief Configuration passed to @ref GfnPreloadPipelineInitialize
+typedef struct GfnPreloadPipelineConfig
+{
+    unsigned int numThreads;                ///< Worker threads, 0 for 4
+    bool manualSessionInit;                 ///< Do not register for SessionInit; the application calls @ref GfnPreloadPipelineBeginSession
+    unsigned int readyBudgetMs;             ///< Time allowed from SessionInit to GfnAppReady, 0 for 30000
+    unsigned int readySafetyMarginMs;       ///< GfnAppReady is called at the latest this long before the budget runs out, 0 for 3000
+    GfnPreloadReadyCallbackSig readyCallback;   ///< Optional
+    void* pReadyContext;                    ///< Passed unmodified to readyCallback
+} GfnPreloadPipelineConfig;
+
+///
+/// @par Description
+/// Sets up an empty preload pipeline.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call once at application start, after @ref GfnInitializeSdk.
+///
+/// @param pConfig                    - Configuration, or NULL for the defaults
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - The pipeline is already set up
+/// @retval gfnUnableToAllocateMemory - The lock could not be created
+GfnRuntimeError GfnPreloadPipelineInitialize(const GfnPreloadPipelineConfig* pConfig);
+
+///
+/// @par Description
+/// Stops the worker threads after the tasks they are running, and releases the pipeline. Tasks
+/// that have not started are not run.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call after @ref GfnShutdownSdk, so that SessionInit can no longer arrive. Must not be called
+/// from a task or the ready callback.
+void GfnPreloadPipelineShutdown(void);
+
+///
+/// @par Description
+/// Adds a load task to the pipeline.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call before @ref GfnPreloadPipelineStart. Dependencies must have been added before.
+///
+/// @param pDesc                      - The task
+/// @param pId                        - Optional, receives the id of the task
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnPreloadPipelineInitialize was not called
+/// @retval gfnInvalidParameter       - pDesc or its run function is NULL, a dependency is unknown, a common
+///                                     stage task depends on a user stage task, or the pipeline is started
+/// @retval gfnUnableToAllocateMemory - The task could not be stored
+GfnRuntimeError GfnPreloadAddTask(const GfnPreloadTaskDesc* pDesc, GfnPreloadTaskId* pId);
+
+///
+/// @par Description
+/// Starts the worker threads and the common stage, and registers for SessionInit unless
+/// @ref GfnPreloadPipelineConfig::manualSessionInit is set. Returns without waiting.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call once during pre-warm, after all tasks were added.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnPreloadPipelineInitialize was not called
+/// @retval gfnInvalidParameter       - The pipeline is already started
+/// @retval gfnUnableToAllocateMemory - The worker or deadline threads could not be started
+/// @return Otherwise, the error returned by @ref GfnRegisterSessionInitCallback. The common stage keeps running.
+GfnRuntimeError GfnPreloadPipelineStart(void);
+
+///
+/// @par Description
+/// Starts the user stage and the ready budget clock, as if SessionInit arrived with the given
+/// parameters. Called by the pipeline's SessionInit callback, or by the application if it
+/// handles SessionInit itself.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pchSessionParams           - Parameters passed to SessionInit. Copied. Can be NULL.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - The pipeline is not started
+/// @retval gfnInvalidParameter       - The user stage already started
+/// @retval gfnUnableToAllocateMemory - The parameters could not be copied
+GfnRuntimeError GfnPreloadPipelineBeginSession(const char* pchSessionParams);
+
+///
+/// @par Description
+/// Waits for all tasks of a stage to finish.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Must not be called from a task or the ready callback.
+///
+/// @param stage                     - The stage to wait for
+/// @param timeoutMs                 - Maximum time to wait
+///
+/// @retval gfnSuccess               - Every task of the stage finished
+/// @retval gfnTimedOut              - Tasks of the stage are still pending or running
+/// @retval gfnAPINotInit            - The pipeline is not started
+/// @retval gfnInvalidParameter      - Unknown stage
+GfnRuntimeError GfnPreloadPipelineWait(GfnPreloadStage stage, unsigned int timeoutMs);
+
+///
+/// @par Description
+/// Retrieves the state and timing of a task.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param id                        - The task
+/// @param pInfo                     - Receives the state of the task
+///
+/// @retval gfnSuccess               - On success
+/// @retval gfnAPINotInit            - @ref GfnPreloadPipelineInitialize was not called
+/// @retval gfnInvalidParameter      - Unknown task, or pInfo is NULL
+GfnRuntimeError GfnPreloadGetTaskInfo(GfnPreloadTaskId id, GfnPreloadTaskInfo* pInfo);
+
+///
+/// @par Description
+/// Retrieves the stage timing and time to ready of the pipeline.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pStats                    - Receives the statistics
+///
+/// @retval gfnSuccess               - On success
+/// @retval gfnAPINotInit            - @ref GfnPreloadPipelineInitialize was not called
+/// @retval gfnInvalidParameter      - pStats is NULL
+GfnRuntimeError GfnPreloadPipelineGetStats(GfnPreloadPipelineStats* pStats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_PRELOAD_PIPELINE_H__
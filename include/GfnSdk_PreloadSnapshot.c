@@ -0,0 +1,612 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_PreloadSnapshot.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#   include <errno.h>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#define GFN_SNAPSHOT_MAGIC "GFNSNAP"
+#define GFN_SNAPSHOT_FORMAT_VERSION 1
+
+// File layout: header, section table sorted by id, then the section data, each aligned to
+// GFN_PRELOAD_SNAPSHOT_ALIGNMENT. All offsets are from the start of the file.
+typedef struct gfnSnapshotHeader
+{
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t headerSize;
+    uint64_t buildId;
+    uint64_t fileSize;
+    uint64_t contentHash;       // Hash of everything after the header
+    uint32_t numSections;
+    uint32_t alignment;
+    uint64_t reserved[2];
+} gfnSnapshotHeader;
+
+typedef struct gfnSnapshotSection
+{
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+} gfnSnapshotSection;
+
+typedef struct gfnSnapshotWriterSection
+{
+    uint32_t id;
+    void* pData;
+    size_t size;
+} gfnSnapshotWriterSection;
+
+struct GfnPreloadSnapshotWriter
+{
+    GfnSdkMutex lock;
+    gfnSnapshotWriterSection* pSections;
+    unsigned int numSections;
+    unsigned int capacity;
+};
+
+struct GfnPreloadSnapshot
+{
+    const unsigned char* pBase;
+    const gfnSnapshotHeader* pHeader;
+    const gfnSnapshotSection* pSections;
+    uint64_t openMs;
+};
+
+// XXH64 with a seed of 0, fast enough that validating the snapshot costs little next to
+// reading it
+#define GFN_SNAPSHOT_PRIME1 0x9E3779B185EBCA87ULL
+#define GFN_SNAPSHOT_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define GFN_SNAPSHOT_PRIME3 0x165667B19E3779F9ULL
+#define GFN_SNAPSHOT_PRIME4 0x85EBCA77C2B2AE63ULL
+#define GFN_SNAPSHOT_PRIME5 0x27D4EB2F165667C5ULL
+
+static uint64_t gfnSnapshotRotl(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t gfnSnapshotRead64(const unsigned char* p)
+{
+    uint64_t value = 0;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t gfnSnapshotRound(uint64_t acc, uint64_t input)
+{
+    acc += input * GFN_SNAPSHOT_PRIME2;
+    acc = gfnSnapshotRotl(acc, 31);
+    return acc * GFN_SNAPSHOT_PRIME1;
+}
+
+static uint64_t gfnSnapshotMergeRound(uint64_t acc, uint64_t value)
+{
+    acc ^= gfnSnapshotRound(0, value);
+    return acc * GFN_SNAPSHOT_PRIME1 + GFN_SNAPSHOT_PRIME4;
+}
+
+static uint64_t gfnSnapshotHash(const unsigned char* p, size_t length)
+{
+    const unsigned char* pEnd = p + length;
+    uint64_t hash = 0;
+    uint64_t v1 = GFN_SNAPSHOT_PRIME1 + GFN_SNAPSHOT_PRIME2;
+    uint64_t v2 = GFN_SNAPSHOT_PRIME2;
+    uint64_t v3 = 0;
+    uint64_t v4 = 0 - GFN_SNAPSHOT_PRIME1;
+    uint32_t word = 0;
+
+    if (length >= 32)
+    {
+        while ((size_t)(pEnd - p) >= 32)
+        {
+            v1 = gfnSnapshotRound(v1, gfnSnapshotRead64(p));
+            v2 = gfnSnapshotRound(v2, gfnSnapshotRead64(p + 8));
+            v3 = gfnSnapshotRound(v3, gfnSnapshotRead64(p + 16));
+            v4 = gfnSnapshotRound(v4, gfnSnapshotRead64(p + 24));
+            p += 32;
+        }
+        hash = gfnSnapshotRotl(v1, 1) + gfnSnapshotRotl(v2, 7) + gfnSnapshotRotl(v3, 12) + gfnSnapshotRotl(v4, 18);
+        hash = gfnSnapshotMergeRound(hash, v1);
+        hash = gfnSnapshotMergeRound(hash, v2);
+        hash = gfnSnapshotMergeRound(hash, v3);
+        hash = gfnSnapshotMergeRound(hash, v4);
+    }
+    else
+    {
+        hash = GFN_SNAPSHOT_PRIME5;
+    }
+    hash += (uint64_t)length;
+
+    while ((size_t)(pEnd - p) >= 8)
+    {
+        hash ^= gfnSnapshotRound(0, gfnSnapshotRead64(p));
+        hash = gfnSnapshotRotl(hash, 27) * GFN_SNAPSHOT_PRIME1 + GFN_SNAPSHOT_PRIME4;
+        p += 8;
+    }
+    if ((size_t)(pEnd - p) >= 4)
+    {
+        memcpy(&word, p, sizeof(word));
+        hash ^= (uint64_t)word * GFN_SNAPSHOT_PRIME1;
+        hash = gfnSnapshotRotl(hash, 23) * GFN_SNAPSHOT_PRIME2 + GFN_SNAPSHOT_PRIME3;
+        p += 4;
+    }
+    while (p < pEnd)
+    {
+        hash ^= (uint64_t)(*p) * GFN_SNAPSHOT_PRIME5;
+        hash = gfnSnapshotRotl(hash, 11) * GFN_SNAPSHOT_PRIME1;
+        p++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= GFN_SNAPSHOT_PRIME2;
+    hash ^= hash >> 29;
+    hash *= GFN_SNAPSHOT_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+static uint64_t gfnSnapshotAlign(uint64_t offset)
+{
+    return (offset + GFN_PRELOAD_SNAPSHOT_ALIGNMENT - 1) & ~(uint64_t)(GFN_PRELOAD_SNAPSHOT_ALIGNMENT - 1);
+}
+
+static int gfnSnapshotCompareSections(const void* pLeft, const void* pRight)
+{
+    uint32_t left = ((const gfnSnapshotWriterSection*)pLeft)->id;
+    uint32_t right = ((const gfnSnapshotWriterSection*)pRight)->id;
+
+    return (left > right) - (left < right);
+}
+
+// Renames the fully written temporary file over the snapshot
+static bool gfnSnapshotReplaceFile(const char* pchFrom, const char* pchTo)
+{
+#ifdef _WIN32
+    return MoveFileExA(pchFrom, pchTo, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(pchFrom, pchTo) == 0;
+#endif
+}
+
+// Maps the whole file read-only. Returns gfnNoData if the file does not exist.
+static GfnRuntimeError gfnSnapshotMapFile(const char* pchPath, const unsigned char** ppBase, uint64_t* pSize)
+{
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+    LARGE_INTEGER size;
+    DWORD error = 0;
+    void* pView = NULL;
+
+    file = CreateFileA(pchPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        error = GetLastError();
+        return (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND) ? gfnNoData : gfnInternalError;
+    }
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(gfnSnapshotHeader)
+        || (uint64_t)size.QuadPart > (uint64_t)SIZE_MAX)
+    {
+        CloseHandle(file);
+        return gfnNoData;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping != NULL)
+    {
+        pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        // The view keeps the mapping and the file open
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    if (pView == NULL)
+    {
+        return gfnInternalError;
+    }
+    *ppBase = (const unsigned char*)pView;
+    *pSize = (uint64_t)size.QuadPart;
+    return gfnSuccess;
+#elif __linux__
+    struct stat fileStat;
+    void* pView = MAP_FAILED;
+    int fd = open(pchPath, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return (errno == ENOENT || errno == ENOTDIR) ? gfnNoData : gfnInternalError;
+    }
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(gfnSnapshotHeader)
+        || (uint64_t)fileStat.st_size > (uint64_t)SIZE_MAX)
+    {
+        close(fd);
+        return gfnNoData;
+    }
+    pView = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file open
+    close(fd);
+    if (pView == MAP_FAILED)
+    {
+        return gfnInternalError;
+    }
+    *ppBase = (const unsigned char*)pView;
+    *pSize = (uint64_t)fileStat.st_size;
+    return gfnSuccess;
+#endif
+}
+
+static void gfnSnapshotUnmapFile(const unsigned char* pBase, uint64_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(pBase);
+#elif __linux__
+    munmap((void*)pBase, (size_t)size);
+#endif
+}
+
+// Checks everything but the content hash
+static GfnRuntimeError gfnSnapshotValidateLayout(const unsigned char* pBase, uint64_t fileSize, uint64_t buildId)
+{
+    const gfnSnapshotHeader* pHeader = (const gfnSnapshotHeader*)pBase;
+    const gfnSnapshotSection* pSections = (const gfnSnapshotSection*)(pBase + sizeof(gfnSnapshotHeader));
+    uint64_t tableEnd = 0;
+    unsigned int i = 0;
+
+    if (memcmp(pHeader->magic, GFN_SNAPSHOT_MAGIC, sizeof(pHeader->magic)) != 0)
+    {
+        return gfnNoData;
+    }
+    if (pHeader->formatVersion != GFN_SNAPSHOT_FORMAT_VERSION || pHeader->headerSize != sizeof(gfnSnapshotHeader)
+        || pHeader->alignment != GFN_PRELOAD_SNAPSHOT_ALIGNMENT || pHeader->buildId != buildId)
+    {
+        return gfnIncompatibleVersion;
+    }
+    if (pHeader->fileSize != fileSize)
+    {
+        return gfnNoData;
+    }
+    tableEnd = sizeof(gfnSnapshotHeader) + (uint64_t)pHeader->numSections * sizeof(gfnSnapshotSection);
+    if (tableEnd > fileSize)
+    {
+        return gfnNoData;
+    }
+    for (i = 0; i < pHeader->numSections; i++)
+    {
+        if (pSections[i].offset < tableEnd || pSections[i].offset % GFN_PRELOAD_SNAPSHOT_ALIGNMENT != 0
+            || pSections[i].offset > fileSize || pSections[i].size > fileSize - pSections[i].offset
+            || (i > 0 && pSections[i].id <= pSections[i - 1].id))
+        {
+            return gfnNoData;
+        }
+    }
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnPreloadSnapshotWriterCreate(GfnPreloadSnapshotWriter** ppWriter)
+{
+    GfnPreloadSnapshotWriter* pWriter = NULL;
+
+    if (ppWriter == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    pWriter = (GfnPreloadSnapshotWriter*)calloc(1, sizeof(GfnPreloadSnapshotWriter));
+    if (pWriter == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkMutexInit(&pWriter->lock))
+    {
+        free(pWriter);
+        return gfnUnableToAllocateMemory;
+    }
+    *ppWriter = pWriter;
+    return gfnSuccess;
+}
+
+void GfnPreloadSnapshotWriterDestroy(GfnPreloadSnapshotWriter* pWriter)
+{
+    unsigned int i = 0;
+
+    if (pWriter == NULL)
+    {
+        return;
+    }
+    for (i = 0; i < pWriter->numSections; i++)
+    {
+        free(pWriter->pSections[i].pData);
+    }
+    free(pWriter->pSections);
+    gfnSdkMutexDestroy(&pWriter->lock);
+    free(pWriter);
+}
+
+GfnRuntimeError GfnPreloadSnapshotWriterAddSection(GfnPreloadSnapshotWriter* pWriter, uint32_t sectionId, const void* pData, size_t size)
+{
+    gfnSnapshotWriterSection* pSections = NULL;
+    void* pCopy = NULL;
+    unsigned int capacity = 0;
+    unsigned int i = 0;
+
+    if (pWriter == NULL || (pData == NULL && size > 0))
+    {
+        return gfnInvalidParameter;
+    }
+    // Copy outside the lock, so tasks adding large sections do not wait on each other
+    pCopy = malloc(size > 0 ? size : 1);
+    if (pCopy == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (size > 0)
+    {
+        memcpy(pCopy, pData, size);
+    }
+
+    gfnSdkMutexLock(&pWriter->lock);
+    for (i = 0; i < pWriter->numSections; i++)
+    {
+        if (pWriter->pSections[i].id == sectionId)
+        {
+            gfnSdkMutexUnlock(&pWriter->lock);
+            free(pCopy);
+            return gfnInvalidParameter;
+        }
+    }
+    if (pWriter->numSections == pWriter->capacity)
+    {
+        capacity = (pWriter->capacity > 0) ? pWriter->capacity * 2 : 16;
+        pSections = (gfnSnapshotWriterSection*)realloc(pWriter->pSections, capacity * sizeof(gfnSnapshotWriterSection));
+        if (pSections == NULL)
+        {
+            gfnSdkMutexUnlock(&pWriter->lock);
+            free(pCopy);
+            return gfnUnableToAllocateMemory;
+        }
+        pWriter->pSections = pSections;
+        pWriter->capacity = capacity;
+    }
+    pWriter->pSections[pWriter->numSections].id = sectionId;
+    pWriter->pSections[pWriter->numSections].pData = pCopy;
+    pWriter->pSections[pWriter->numSections].size = size;
+    pWriter->numSections++;
+    gfnSdkMutexUnlock(&pWriter->lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnPreloadSnapshotWriterSave(GfnPreloadSnapshotWriter* pWriter, const char* pchPath, uint64_t buildId)
+{
+    gfnSnapshotHeader header;
+    gfnSnapshotSection* pTable = NULL;
+    unsigned char* pImage = NULL;
+    char* pchTempPath = NULL;
+    uint64_t tableEnd = 0;
+    uint64_t fileSize = 0;
+    uint64_t offset = 0;
+    size_t pathLength = 0;
+    unsigned int i = 0;
+    FILE* pFile = NULL;
+    bool written = false;
+
+    if (pWriter == NULL || pchPath == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&pWriter->lock);
+    qsort(pWriter->pSections, pWriter->numSections, sizeof(gfnSnapshotWriterSection), gfnSnapshotCompareSections);
+    tableEnd = sizeof(gfnSnapshotHeader) + (uint64_t)pWriter->numSections * sizeof(gfnSnapshotSection);
+    fileSize = tableEnd;
+    for (i = 0; i < pWriter->numSections; i++)
+    {
+        fileSize = gfnSnapshotAlign(fileSize) + pWriter->pSections[i].size;
+    }
+    if (fileSize <= (uint64_t)SIZE_MAX)
+    {
+        pImage = (unsigned char*)calloc(1, (size_t)fileSize);
+    }
+    if (pImage == NULL)
+    {
+        gfnSdkMutexUnlock(&pWriter->lock);
+        return gfnUnableToAllocateMemory;
+    }
+    pTable = (gfnSnapshotSection*)(pImage + sizeof(gfnSnapshotHeader));
+    offset = tableEnd;
+    for (i = 0; i < pWriter->numSections; i++)
+    {
+        offset = gfnSnapshotAlign(offset);
+        pTable[i].id = pWriter->pSections[i].id;
+        pTable[i].offset = offset;
+        pTable[i].size = pWriter->pSections[i].size;
+        if (pWriter->pSections[i].size > 0)
+        {
+            memcpy(pImage + offset, pWriter->pSections[i].pData, pWriter->pSections[i].size);
+        }
+        offset += pWriter->pSections[i].size;
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GFN_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.formatVersion = GFN_SNAPSHOT_FORMAT_VERSION;
+    header.headerSize = sizeof(gfnSnapshotHeader);
+    header.buildId = buildId;
+    header.fileSize = fileSize;
+    header.numSections = pWriter->numSections;
+    header.alignment = GFN_PRELOAD_SNAPSHOT_ALIGNMENT;
+    gfnSdkMutexUnlock(&pWriter->lock);
+
+    header.contentHash = gfnSnapshotHash(pImage + sizeof(gfnSnapshotHeader), (size_t)(fileSize - sizeof(gfnSnapshotHeader)));
+    memcpy(pImage, &header, sizeof(header));
+
+    pathLength = strlen(pchPath);
+    pchTempPath = (char*)malloc(pathLength + sizeof(".tmp"));
+    if (pchTempPath == NULL)
+    {
+        free(pImage);
+        return gfnUnableToAllocateMemory;
+    }
+    memcpy(pchTempPath, pchPath, pathLength);
+    memcpy(pchTempPath + pathLength, ".tmp", sizeof(".tmp"));
+
+    pFile = fopen(pchTempPath, "wb");
+    if (pFile != NULL)
+    {
+        written = fwrite(pImage, 1, (size_t)fileSize, pFile) == (size_t)fileSize;
+        written = (fclose(pFile) == 0) && written;
+        if (written)
+        {
+            written = gfnSnapshotReplaceFile(pchTempPath, pchPath);
+        }
+        if (!written)
+        {
+            remove(pchTempPath);
+        }
+    }
+    free(pchTempPath);
+    free(pImage);
+    return written ? gfnSuccess : gfnInternalError;
+}
+
+GfnRuntimeError GfnPreloadSnapshotOpen(const char* pchPath, uint64_t buildId, GfnPreloadSnapshot** ppSnapshot)
+{
+    GfnPreloadSnapshot* pSnapshot = NULL;
+    const unsigned char* pBase = NULL;
+    const gfnSnapshotHeader* pHeader = NULL;
+    uint64_t startMs = gfnSdkGetTimeMs();
+    uint64_t fileSize = 0;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (pchPath == NULL || ppSnapshot == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    *ppSnapshot = NULL;
+
+    result = gfnSnapshotMapFile(pchPath, &pBase, &fileSize);
+    if (result != gfnSuccess)
+    {
+        return result;
+    }
+    pHeader = (const gfnSnapshotHeader*)pBase;
+    result = gfnSnapshotValidateLayout(pBase, fileSize, buildId);
+    if (result == gfnSuccess
+        && gfnSnapshotHash(pBase + sizeof(gfnSnapshotHeader), (size_t)(fileSize - sizeof(gfnSnapshotHeader))) != pHeader->contentHash)
+    {
+        result = gfnNoData;
+    }
+    if (result == gfnSuccess)
+    {
+        pSnapshot = (GfnPreloadSnapshot*)calloc(1, sizeof(GfnPreloadSnapshot));
+        if (pSnapshot == NULL)
+        {
+            result = gfnUnableToAllocateMemory;
+        }
+    }
+    if (result != gfnSuccess)
+    {
+        gfnSnapshotUnmapFile(pBase, fileSize);
+        return result;
+    }
+
+    pSnapshot->pBase = pBase;
+    pSnapshot->pHeader = pHeader;
+    pSnapshot->pSections = (const gfnSnapshotSection*)(pBase + sizeof(gfnSnapshotHeader));
+    pSnapshot->openMs = gfnSdkGetTimeMs() - startMs;
+    *ppSnapshot = pSnapshot;
+    return gfnSuccess;
+}
+
+void GfnPreloadSnapshotClose(GfnPreloadSnapshot* pSnapshot)
+{
+    if (pSnapshot == NULL)
+    {
+        return;
+    }
+    gfnSnapshotUnmapFile(pSnapshot->pBase, pSnapshot->pHeader->fileSize);
+    free(pSnapshot);
+}
+
+GfnRuntimeError GfnPreloadSnapshotFindSection(const GfnPreloadSnapshot* pSnapshot, uint32_t sectionId, const void** ppData, size_t* pSize)
+{
+    unsigned int low = 0;
+    unsigned int high = 0;
+    unsigned int middle = 0;
+
+    if (pSnapshot == NULL || ppData == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    // The section table is sorted by id
+    high = pSnapshot->pHeader->numSections;
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        if (pSnapshot->pSections[middle].id < sectionId)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if (low == pSnapshot->pHeader->numSections || pSnapshot->pSections[low].id != sectionId)
+    {
+        return gfnNoData;
+    }
+    *ppData = pSnapshot->pBase + pSnapshot->pSections[low].offset;
+    if (pSize != NULL)
+    {
+        *pSize = (size_t)pSnapshot->pSections[low].size;
+    }
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnPreloadSnapshotGetInfo(const GfnPreloadSnapshot* pSnapshot, GfnPreloadSnapshotInfo* pInfo)
+{
+    if (pSnapshot == NULL || pInfo == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    pInfo->buildId = pSnapshot->pHeader->buildId;
+    pInfo->fileSize = pSnapshot->pHeader->fileSize;
+    pInfo->numSections = pSnapshot->pHeader->numSections;
+    pInfo->openMs = pSnapshot->openMs;
+    return gfnSuccess;
+}
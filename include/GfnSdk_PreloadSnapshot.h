@@ -0,0 +1,252 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Memory-mapped snapshots of pre-warm common data
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_PreloadSnapshot.h
+*
+* Optional snapshot file for the common data prepared during pre-warm, see @ref preload_pipeline
+*/
+///
+/// @page preload_snapshot Preload Snapshot
+///
+/// @section preload_snapshot_introduction Introduction
+/// Every pre-warmed instance of an application prepares the same common data: parsed
+/// configuration, decompressed tables, baked lookups. Once one instance prepared it, the
+/// result can be stored in a snapshot file, and later pre-warms map that file read-only
+/// instead of preparing the data again.
+///
+/// - During the common stage, each task adds the data it prepared to a
+///   @ref GfnPreloadSnapshotWriter as a section with an application defined id.
+///   @ref GfnPreloadSnapshotWriterSave then writes all sections to the snapshot file.
+/// - Later pre-warms open the file with @ref GfnPreloadSnapshotOpen, which maps it read-only
+///   and validates it against a content hash and the application's build id. Tasks look up
+///   their section with @ref GfnPreloadSnapshotFindSection and use it in place.
+/// - If the file is missing, stale or damaged, @ref GfnPreloadSnapshotOpen fails and the
+///   application prepares the data as usual, which is also the path that writes a new snapshot.
+///
+/// @section preload_snapshot_layout Section data
+/// The file can be mapped at any address, so section data must not contain pointers. Refer to
+/// other data with offsets from the start of the section instead. Each section starts on a
+/// @ref GFN_PRELOAD_SNAPSHOT_ALIGNMENT byte boundary of the mapping.
+///
+/// Data is stored in the byte order and layout of the machine that wrote it. Change the build
+/// id passed to @ref GfnPreloadSnapshotWriterSave and @ref GfnPreloadSnapshotOpen whenever the
+/// application, its data or its section layout changes, so that older snapshots are rejected.
+
+#ifndef __NV_GFNSDK_PRELOAD_SNAPSHOT_H__
+#define __NV_GFNSDK_PRELOAD_SNAPSHOT_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Alignment of section data within the snapshot, in bytes
+#define GFN_PRELOAD_SNAPSHOT_ALIGNMENT 64
+
+/// @brief Collects the sections of a snapshot to write. Safe to use from several threads.
+typedef struct GfnPreloadSnapshotWriter GfnPreloadSnapshotWriter;
+
+/// @brief A snapshot mapped read-only into memory
+typedef struct GfnPreloadSnapshot GfnPreloadSnapshot;
+
+/// @brief Information about an open snapshot
+typedef struct GfnPreloadSnapshotInfo
+{
+    uint64_t buildId;           ///< Build id the snapshot was written with
+    uint64_t fileSize;          ///< Size of the file in bytes
+    unsigned int numSections;
+    uint64_t openMs;            ///< Time taken to map and validate the file
+} GfnPreloadSnapshotInfo;
+
+///
+/// @par Description
+/// Creates an empty snapshot writer.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param ppWriter                   - Receives the writer
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - ppWriter is NULL
+/// @retval gfnUnableToAllocateMemory - The writer could not be created
+GfnRuntimeError GfnPreloadSnapshotWriterCreate(GfnPreloadSnapshotWriter** ppWriter);
+
+///
+/// @par Description
+/// Releases a snapshot writer and the data added to it.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+void GfnPreloadSnapshotWriterDestroy(GfnPreloadSnapshotWriter* pWriter);
+
+///
+/// @par Description
+/// Adds a section to the snapshot. The data is copied.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call from the common stage task that prepared the data. Data must be position independent,
+/// see @ref preload_snapshot_layout.
+///
+/// @param pWriter                    - The writer
+/// @param sectionId                  - Application defined id of the section, unique within the snapshot
+/// @param pData                      - Section data, may be NULL if size is 0
+/// @param size                       - Size of the section data in bytes
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - pWriter is NULL, pData is NULL with a non-zero size, or sectionId was already added
+/// @retval gfnUnableToAllocateMemory - The data could not be copied
+GfnRuntimeError GfnPreloadSnapshotWriterAddSection(GfnPreloadSnapshotWriter* pWriter, uint32_t sectionId, const void* pData, size_t size);
+
+///
+/// @par Description
+/// Writes the sections added so far to a snapshot file. The file is written under a temporary
+/// name and then renamed, so a concurrent @ref GfnPreloadSnapshotOpen sees either the old or
+/// the new snapshot, never a partial one.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call once the common stage finished, for example after @ref GfnPreloadPipelineWait.
+///
+/// @param pWriter                    - The writer
+/// @param pchPath                    - Path of the snapshot file
+/// @param buildId                    - Identifies the application build and data layout
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - pWriter or pchPath is NULL
+/// @retval gfnUnableToAllocateMemory - The file image could not be assembled
+/// @retval gfnInternalError          - The file could not be written
+GfnRuntimeError GfnPreloadSnapshotWriterSave(GfnPreloadSnapshotWriter* pWriter, const char* pchPath, uint64_t buildId);
+
+///
+/// @par Description
+/// Maps a snapshot file read-only and validates it: the header, the section table, the build
+/// id and the content hash of the whole file.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call before starting the common stage. On failure, prepare the data as usual.
+///
+/// @param pchPath                    - Path of the snapshot file
+/// @param buildId                    - Build id the snapshot must have been written with
+/// @param ppSnapshot                 - Receives the snapshot
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - pchPath or ppSnapshot is NULL
+/// @retval gfnNoData                 - The file does not exist, or is truncated or damaged
+/// @retval gfnIncompatibleVersion    - The file was written by another build or version of the format
+/// @retval gfnUnableToAllocateMemory - The snapshot could not be created
+/// @retval gfnInternalError          - The file could not be mapped
+GfnRuntimeError GfnPreloadSnapshotOpen(const char* pchPath, uint64_t buildId, GfnPreloadSnapshot** ppSnapshot);
+
+///
+/// @par Description
+/// Unmaps a snapshot. Pointers to its sections become invalid.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+void GfnPreloadSnapshotClose(GfnPreloadSnapshot* pSnapshot);
+
+///
+/// @par Description
+/// Looks up a section of an open snapshot.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Can be called from several threads at the same time. The data is read-only and stays
+/// valid until @ref GfnPreloadSnapshotClose.
+///
+/// @param pSnapshot                  - The snapshot
+/// @param sectionId                  - Id of the section
+/// @param ppData                     - Receives a pointer to the section data
+/// @param pSize                      - Optional, receives the size of the section data
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - pSnapshot or ppData is NULL
+/// @retval gfnNoData                 - The snapshot has no such section
+GfnRuntimeError GfnPreloadSnapshotFindSection(const GfnPreloadSnapshot* pSnapshot, uint32_t sectionId, const void** ppData, size_t* pSize);
+
+///
+/// @par Description
+/// Retrieves information about an open snapshot.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - pSnapshot or pInfo is NULL
+GfnRuntimeError GfnPreloadSnapshotGetInfo(const GfnPreloadSnapshot* pSnapshot, GfnPreloadSnapshotInfo* pInfo);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_PRELOAD_SNAPSHOT_H__
@@ -0,0 +1,680 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_Retry.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// ISO 3166-1 Alpha-2 code plus terminator
+#define GFN_RETRY_COUNTRY_CODE_LEN 3
+
+typedef struct gfnRetryTask
+{
+    bool inUse;
+    bool executing;
+    bool cancelRequested;
+    GfnRetryHandle handle;
+    GfnRetryPolicy policy;
+    GfnRetryOperationSig operation;
+    void* pOperationContext;
+    GfnRetryCompletionSig completion;
+    void* pUserContext;
+    unsigned int attempts;
+    uint64_t dueMs;
+    uint64_t deadlineMs;            // 0 for no deadline
+} gfnRetryTask;
+
+typedef struct gfnRetryScheduler
+{
+    bool initialized;
+    bool stopping;
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+    GfnSdkThread thread;
+
+    GfnRetryPolicy policies[gfnRetryApiCount];
+    gfnRetryTask tasks[GFN_RETRY_MAX_PENDING];
+    gfnRetryTask* heap[GFN_RETRY_MAX_PENDING];   // Min-heap of waiting tasks ordered by dueMs
+    unsigned int heapCount;
+    GfnRetryHandle nextHandle;
+    uint32_t rngState;
+} gfnRetryScheduler;
+
+static gfnRetryScheduler s_gfnRetry;
+
+// Default policies, indexed by GfnRetryApi
+static const GfnRetryPolicy s_gfnRetryDefaultPolicies[gfnRetryApiCount] =
+{
+    { 5, 250, 4000, 50, 30000 },    // gfnRetryApiGeneric
+    { 5, 250, 4000, 50, 30000 },    // gfnRetryApiGetPartnerData
+    { 5, 250, 4000, 50, 30000 },    // gfnRetryApiGetPartnerSecureData
+    { 5, 250, 4000, 50, 30000 },    // gfnRetryApiGetClientIp
+    { 5, 250, 4000, 50, 30000 },    // gfnRetryApiGetClientCountryCode
+    { 5, 1000, 8000, 50, 60000 },   // gfnRetryApiCloudCheck
+    { 5, 1000, 12000, 25, 90000 },  // gfnRetryApiOpenURLOnClient, limited per second and per minute
+    { 8, 50, 1000, 50, 10000 },     // gfnRetryApiSendMessage, limited to 30 messages per second
+};
+
+// Must be called with the lock held
+static uint32_t gfnRetryRandom(void)
+{
+    // xorshift32, quality is not a concern for jitter
+    uint32_t x = s_gfnRetry.rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_gfnRetry.rngState = x;
+    return x;
+}
+
+// Must be called with the lock held
+static uint64_t gfnRetryBackoffMs(const gfnRetryTask* pTask)
+{
+    uint64_t backoffMs = pTask->policy.initialBackoffMs;
+    unsigned int i = 0;
+
+    for (i = 1; i < pTask->attempts && backoffMs < pTask->policy.maxBackoffMs; i++)
+    {
+        backoffMs *= 2;
+    }
+    if (backoffMs > pTask->policy.maxBackoffMs)
+    {
+        backoffMs = pTask->policy.maxBackoffMs;
+    }
+    if (pTask->policy.jitterPercent > 0)
+    {
+        backoffMs -= gfnRetryRandom() % (backoffMs * pTask->policy.jitterPercent / 100 + 1);
+    }
+    return backoffMs;
+}
+
+static void gfnRetryHeapSwap(unsigned int a, unsigned int b)
+{
+    gfnRetryTask* pTemp = s_gfnRetry.heap[a];
+    s_gfnRetry.heap[a] = s_gfnRetry.heap[b];
+    s_gfnRetry.heap[b] = pTemp;
+}
+
+static void gfnRetryHeapSiftUp(unsigned int i)
+{
+    while (i > 0 && s_gfnRetry.heap[(i - 1) / 2]->dueMs > s_gfnRetry.heap[i]->dueMs)
+    {
+        gfnRetryHeapSwap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void gfnRetryHeapSiftDown(unsigned int i)
+{
+    unsigned int smallest = i;
+    unsigned int child = 0;
+
+    for (;;)
+    {
+        child = 2 * i + 1;
+        if (child < s_gfnRetry.heapCount && s_gfnRetry.heap[child]->dueMs < s_gfnRetry.heap[smallest]->dueMs)
+        {
+            smallest = child;
+        }
+        child++;
+        if (child < s_gfnRetry.heapCount && s_gfnRetry.heap[child]->dueMs < s_gfnRetry.heap[smallest]->dueMs)
+        {
+            smallest = child;
+        }
+        if (smallest == i)
+        {
+            return;
+        }
+        gfnRetryHeapSwap(i, smallest);
+        i = smallest;
+    }
+}
+
+// Must be called with the lock held
+static void gfnRetryHeapPush(gfnRetryTask* pTask)
+{
+    s_gfnRetry.heap[s_gfnRetry.heapCount] = pTask;
+    s_gfnRetry.heapCount++;
+    gfnRetryHeapSiftUp(s_gfnRetry.heapCount - 1);
+}
+
+// Must be called with the lock held
+static void gfnRetryHeapRemoveAt(unsigned int i)
+{
+    s_gfnRetry.heapCount--;
+    if (i == s_gfnRetry.heapCount)
+    {
+        return;
+    }
+    s_gfnRetry.heap[i] = s_gfnRetry.heap[s_gfnRetry.heapCount];
+    gfnRetryHeapSiftDown(i);
+    gfnRetryHeapSiftUp(i);
+}
+
+// Must be called with the lock held. Releases the task and calls its completion with the lock dropped.
+static void gfnRetryComplete(gfnRetryTask* pTask, GfnRuntimeError status)
+{
+    GfnRetryCompletionSig completion = pTask->completion;
+    void* pOperationContext = pTask->pOperationContext;
+    void* pUserContext = pTask->pUserContext;
+    unsigned int attempts = pTask->attempts;
+
+    memset(pTask, 0, sizeof(*pTask));
+    gfnSdkMutexUnlock(&s_gfnRetry.lock);
+    completion(status, attempts, pOperationContext, pUserContext);
+    gfnSdkMutexLock(&s_gfnRetry.lock);
+}
+
+static void gfnRetryThread(void* pContext)
+{
+    gfnRetryTask* pTask = NULL;
+    GfnRuntimeError status = gfnSuccess;
+    uint64_t now = 0;
+
+    (void)pContext;
+    gfnSdkMutexLock(&s_gfnRetry.lock);
+    while (!s_gfnRetry.stopping)
+    {
+        if (s_gfnRetry.heapCount == 0)
+        {
+            gfnSdkCondWait(&s_gfnRetry.cond, &s_gfnRetry.lock);
+            continue;
+        }
+        now = gfnSdkGetTimeMs();
+        pTask = s_gfnRetry.heap[0];
+        if (pTask->dueMs > now)
+        {
+            gfnSdkCondTimedWait(&s_gfnRetry.cond, &s_gfnRetry.lock, (uint32_t)(pTask->dueMs - now));
+            continue;
+        }
+
+        gfnRetryHeapRemoveAt(0);
+        pTask->executing = true;
+        gfnSdkMutexUnlock(&s_gfnRetry.lock);
+
+        status = pTask->operation(pTask->pOperationContext);
+
+        gfnSdkMutexLock(&s_gfnRetry.lock);
+        pTask->executing = false;
+        pTask->attempts++;
+        if (GfnRetryIsTransientError(status) && pTask->attempts < pTask->policy.maxAttempts)
+        {
+            if (pTask->cancelRequested || s_gfnRetry.stopping)
+            {
+                gfnRetryComplete(pTask, gfnCanceled);
+                continue;
+            }
+            pTask->dueMs = gfnSdkGetTimeMs() + gfnRetryBackoffMs(pTask);
+            if (pTask->deadlineMs == 0 || pTask->dueMs <= pTask->deadlineMs)
+            {
+                gfnRetryHeapPush(pTask);
+                continue;
+            }
+        }
+        // Success, a permanent error, or out of attempts or time: report the last result
+        gfnRetryComplete(pTask, status);
+    }
+    gfnSdkMutexUnlock(&s_gfnRetry.lock);
+}
+
+GfnRuntimeError GfnRetryInitialize(void)
+{
+    if (s_gfnRetry.initialized)
+    {
+        return gfnInvalidParameter;
+    }
+
+    memset(&s_gfnRetry, 0, sizeof(s_gfnRetry));
+    memcpy(s_gfnRetry.policies, s_gfnRetryDefaultPolicies, sizeof(s_gfnRetry.policies));
+    s_gfnRetry.nextHandle = 1;
+    s_gfnRetry.rngState = (uint32_t)gfnSdkGetTimeMs() | 1u;
+
+    if (!gfnSdkMutexInit(&s_gfnRetry.lock))
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkCondInit(&s_gfnRetry.cond))
+    {
+        gfnSdkMutexDestroy(&s_gfnRetry.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkThreadCreate(&s_gfnRetry.thread, gfnRetryThread, NULL))
+    {
+        gfnSdkCondDestroy(&s_gfnRetry.cond);
+        gfnSdkMutexDestroy(&s_gfnRetry.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnRetry.initialized = true;
+    return gfnSuccess;
+}
+
+void GfnRetryShutdown(void)
+{
+    if (!s_gfnRetry.initialized)
+    {
+        return;
+    }
+
+    gfnSdkMutexLock(&s_gfnRetry.lock);
+    s_gfnRetry.stopping = true;
+    gfnSdkCondSignal(&s_gfnRetry.cond);
+    gfnSdkMutexUnlock(&s_gfnRetry.lock);
+    gfnSdkThreadJoin(s_gfnRetry.thread);
+
+    gfnSdkMutexLock(&s_gfnRetry.lock);
+    while (s_gfnRetry.heapCount > 0)
+    {
+        gfnRetryTask* pTask = s_gfnRetry.heap[0];
+        gfnRetryHeapRemoveAt(0);
+        gfnRetryComplete(pTask, gfnCanceled);
+    }
+    s_gfnRetry.initialized = false;
+    gfnSdkMutexUnlock(&s_gfnRetry.lock);
+
+    gfnSdkCondDestroy(&s_gfnRetry.cond);
+    gfnSdkMutexDestroy(&s_gfnRetry.lock);
+}
+
+GfnRuntimeError GfnRetrySetPolicy(GfnRetryApi api, const GfnRetryPolicy* pPolicy)
+{
+    if ((unsigned int)api >= gfnRetryApiCount || pPolicy == NULL || pPolicy->maxAttempts == 0 || pPolicy->jitterPercent > 100)
+    {
+        return gfnInvalidParameter;
+    }
+    if (!s_gfnRetry.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    gfnSdkMutexLock(&s_gfnRetry.lock);
+    s_gfnRetry.policies[api] = *pPolicy;
+    gfnSdkMutexUnlock(&s_gfnRetry.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnRetryGetPolicy(GfnRetryApi api, GfnRetryPolicy* pPolicy)
+{
+    if ((unsigned int)api >= gfnRetryApiCount || pPolicy == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    if (!s_gfnRetry.initialized)
+    {
+        *pPolicy = s_gfnRetryDefaultPolicies[api];
+        return gfnSuccess;
+    }
+    gfnSdkMutexLock(&s_gfnRetry.lock);
+    *pPolicy = s_gfnRetry.policies[api];
+    gfnSdkMutexUnlock(&s_gfnRetry.lock);
+    return gfnSuccess;
+}
+
+bool GfnRetryIsTransientError(GfnRuntimeError status)
+{
+    return status == gfnThrottled || status == gfnTimedOut || status == gfnIPCFailure;
+}
+
+GfnRuntimeError GfnRetrySubmit(GfnRetryApi api, GfnRetryOperationSig operation, void* pOperationContext,
+    GfnRetryCompletionSig completion, void* pUserContext, GfnRetryHandle* pHandle)
+{
+    gfnRetryTask* pTask = NULL;
+    unsigned int i = 0;
+
+    if (!s_gfnRetry.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if ((unsigned int)api >= gfnRetryApiCount || operation == NULL || completion == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&s_gfnRetry.lock);
+    for (i = 0; i < GFN_RETRY_MAX_PENDING; i++)
+    {
+        if (!s_gfnRetry.tasks[i].inUse)
+        {
+            pTask = &s_gfnRetry.tasks[i];
+            break;
+        }
+    }
+    if (pTask == NULL)
+    {
+        gfnSdkMutexUnlock(&s_gfnRetry.lock);
+        return gfnThrottled;
+    }
+
+    pTask->inUse = true;
+    pTask->handle = s_gfnRetry.nextHandle++;
+    if (s_gfnRetry.nextHandle == 0)
+    {
+        s_gfnRetry.nextHandle = 1;
+    }
+    pTask->policy = s_gfnRetry.policies[api];
+    pTask->operation = operation;
+    pTask->pOperationContext = pOperationContext;
+    pTask->completion = completion;
+    pTask->pUserContext = pUserContext;
+    pTask->dueMs = gfnSdkGetTimeMs();
+    pTask->deadlineMs = pTask->policy.deadlineMs > 0 ? pTask->dueMs + pTask->policy.deadlineMs : 0;
+    gfnRetryHeapPush(pTask);
+    if (pHandle != NULL)
+    {
+        *pHandle = pTask->handle;
+    }
+    gfnSdkCondSignal(&s_gfnRetry.cond);
+    gfnSdkMutexUnlock(&s_gfnRetry.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnRetryCancel(GfnRetryHandle handle)
+{
+    gfnRetryTask* pTask = NULL;
+    unsigned int i = 0;
+
+    if (!s_gfnRetry.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (handle == 0)
+    {
+        return gfnNoData;
+    }
+
+    gfnSdkMutexLock(&s_gfnRetry.lock);
+    for (i = 0; i < GFN_RETRY_MAX_PENDING; i++)
+    {
+        if (s_gfnRetry.tasks[i].inUse && s_gfnRetry.tasks[i].handle == handle)
+        {
+            pTask = &s_gfnRetry.tasks[i];
+            break;
+        }
+    }
+    if (pTask == NULL || pTask->cancelRequested)
+    {
+        gfnSdkMutexUnlock(&s_gfnRetry.lock);
+        return gfnNoData;
+    }
+    if (pTask->executing)
+    {
+        // The scheduler thread completes the call once the attempt returns
+        pTask->cancelRequested = true;
+        gfnSdkMutexUnlock(&s_gfnRetry.lock);
+        return gfnSuccess;
+    }
+    for (i = 0; i < s_gfnRetry.heapCount; i++)
+    {
+        if (s_gfnRetry.heap[i] == pTask)
+        {
+            gfnRetryHeapRemoveAt(i);
+            break;
+        }
+    }
+    gfnRetryComplete(pTask, gfnCanceled);
+    gfnSdkMutexUnlock(&s_gfnRetry.lock);
+    return gfnSuccess;
+}
+
+// ============================================================================================
+// Typed helpers
+// ============================================================================================
+
+typedef struct gfnRetryStringOperation
+{
+    GfnRetryApi api;
+    const char* pchData;
+    char countryCode[GFN_RETRY_COUNTRY_CODE_LEN];
+    GfnRetryStringCallbackSig callback;
+    void* pUserContext;
+} gfnRetryStringOperation;
+
+typedef struct gfnRetryCloudCheckOperation
+{
+    GfnCloudCheckChallenge challenge;
+    GfnCloudCheckResponse response;
+    bool hasChallenge;
+    bool isCloudEnvironment;
+    GfnRetryCloudCheckCallbackSig callback;
+    void* pUserContext;
+    // The nonce copy follows the structure
+} gfnRetryCloudCheckOperation;
+
+typedef struct gfnRetryMessageOperation
+{
+    GfnRetryApi api;
+    unsigned int length;
+    GfnRetryStatusCallbackSig callback;
+    void* pUserContext;
+    // The URL or message copy follows the structure
+} gfnRetryMessageOperation;
+
+static GfnRuntimeError gfnRetryStringOperationRun(void* pOperationContext)
+{
+    gfnRetryStringOperation* pOperation = (gfnRetryStringOperation*)pOperationContext;
+
+    switch (pOperation->api)
+    {
+    case gfnRetryApiGetPartnerData:
+        return GfnGetPartnerData(&pOperation->pchData);
+    case gfnRetryApiGetPartnerSecureData:
+        return GfnGetPartnerSecureData(&pOperation->pchData);
+    case gfnRetryApiGetClientIp:
+        return GfnGetClientIpV4(&pOperation->pchData);
+    case gfnRetryApiGetClientCountryCode:
+        pOperation->pchData = pOperation->countryCode;
+        return GfnGetClientCountryCode(pOperation->countryCode, GFN_RETRY_COUNTRY_CODE_LEN);
+    default:
+        return gfnInvalidParameter;
+    }
+}
+
+static void GFN_CALLBACK gfnRetryStringOperationComplete(GfnRuntimeError status, unsigned int attempts, void* pOperationContext, void* pUserContext)
+{
+    gfnRetryStringOperation* pOperation = (gfnRetryStringOperation*)pOperationContext;
+
+    (void)attempts;
+    (void)pUserContext;
+    pOperation->callback(status, GFNSDK_SUCCEEDED(status) ? pOperation->pchData : NULL, pOperation->pUserContext);
+    free(pOperation);
+}
+
+static GfnRuntimeError gfnRetrySubmitStringOperation(GfnRetryApi api, GfnRetryStringCallbackSig callback, void* pUserContext)
+{
+    gfnRetryStringOperation* pOperation = NULL;
+    GfnRuntimeError status = gfnSuccess;
+
+    if (callback == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    pOperation = (gfnRetryStringOperation*)calloc(1, sizeof(gfnRetryStringOperation));
+    if (pOperation == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    pOperation->api = api;
+    pOperation->callback = callback;
+    pOperation->pUserContext = pUserContext;
+
+    status = GfnRetrySubmit(api, gfnRetryStringOperationRun, pOperation, gfnRetryStringOperationComplete, NULL, NULL);
+    if (GFNSDK_FAILED(status))
+    {
+        free(pOperation);
+    }
+    return status;
+}
+
+GfnRuntimeError GfnGetPartnerDataWithRetry(GfnRetryStringCallbackSig callback, void* pUserContext)
+{
+    return gfnRetrySubmitStringOperation(gfnRetryApiGetPartnerData, callback, pUserContext);
+}
+
+GfnRuntimeError GfnGetPartnerSecureDataWithRetry(GfnRetryStringCallbackSig callback, void* pUserContext)
+{
+    return gfnRetrySubmitStringOperation(gfnRetryApiGetPartnerSecureData, callback, pUserContext);
+}
+
+GfnRuntimeError GfnGetClientIpV4WithRetry(GfnRetryStringCallbackSig callback, void* pUserContext)
+{
+    return gfnRetrySubmitStringOperation(gfnRetryApiGetClientIp, callback, pUserContext);
+}
+
+GfnRuntimeError GfnGetClientCountryCodeWithRetry(GfnRetryStringCallbackSig callback, void* pUserContext)
+{
+    return gfnRetrySubmitStringOperation(gfnRetryApiGetClientCountryCode, callback, pUserContext);
+}
+
+static GfnRuntimeError gfnRetryCloudCheckOperationRun(void* pOperationContext)
+{
+    gfnRetryCloudCheckOperation* pOperation = (gfnRetryCloudCheckOperation*)pOperationContext;
+
+    if (!pOperation->hasChallenge)
+    {
+        return GfnCloudCheck(NULL, NULL, &pOperation->isCloudEnvironment);
+    }
+    return GfnCloudCheck(&pOperation->challenge, &pOperation->response, &pOperation->isCloudEnvironment);
+}
+
+static void GFN_CALLBACK gfnRetryCloudCheckOperationComplete(GfnRuntimeError status, unsigned int attempts, void* pOperationContext, void* pUserContext)
+{
+    gfnRetryCloudCheckOperation* pOperation = (gfnRetryCloudCheckOperation*)pOperationContext;
+
+    (void)attempts;
+    (void)pUserContext;
+    pOperation->callback(status, pOperation->isCloudEnvironment, pOperation->hasChallenge ? &pOperation->response : NULL, pOperation->pUserContext);
+    free(pOperation);
+}
+
+GfnRuntimeError GfnCloudCheckWithRetry(const GfnCloudCheckChallenge* challenge, GfnRetryCloudCheckCallbackSig callback, void* pUserContext)
+{
+    gfnRetryCloudCheckOperation* pOperation = NULL;
+    GfnRuntimeError status = gfnSuccess;
+    unsigned int nonceSize = 0;
+
+    if (callback == NULL || (challenge != NULL && challenge->nonce == NULL && challenge->nonceSize > 0))
+    {
+        return gfnInvalidParameter;
+    }
+    if (challenge != NULL)
+    {
+        nonceSize = challenge->nonceSize;
+    }
+    pOperation = (gfnRetryCloudCheckOperation*)calloc(1, sizeof(gfnRetryCloudCheckOperation) + nonceSize);
+    if (pOperation == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (challenge != NULL)
+    {
+        pOperation->hasChallenge = true;
+        pOperation->challenge.nonce = challenge->nonce != NULL ? (const char*)(pOperation + 1) : NULL;
+        pOperation->challenge.nonceSize = nonceSize;
+        if (nonceSize > 0)
+        {
+            memcpy(pOperation + 1, challenge->nonce, nonceSize);
+        }
+    }
+    pOperation->callback = callback;
+    pOperation->pUserContext = pUserContext;
+
+    status = GfnRetrySubmit(gfnRetryApiCloudCheck, gfnRetryCloudCheckOperationRun, pOperation, gfnRetryCloudCheckOperationComplete, NULL, NULL);
+    if (GFNSDK_FAILED(status))
+    {
+        free(pOperation);
+    }
+    return status;
+}
+
+static GfnRuntimeError gfnRetryMessageOperationRun(void* pOperationContext)
+{
+    gfnRetryMessageOperation* pOperation = (gfnRetryMessageOperation*)pOperationContext;
+    const char* pchData = (const char*)(pOperation + 1);
+
+    if (pOperation->api == gfnRetryApiOpenURLOnClient)
+    {
+        return GfnOpenURLOnClient(pchData);
+    }
+    return GfnSendMessage(pchData, pOperation->length);
+}
+
+static void GFN_CALLBACK gfnRetryMessageOperationComplete(GfnRuntimeError status, unsigned int attempts, void* pOperationContext, void* pUserContext)
+{
+    gfnRetryMessageOperation* pOperation = (gfnRetryMessageOperation*)pOperationContext;
+
+    (void)attempts;
+    (void)pUserContext;
+    if (pOperation->callback != NULL)
+    {
+        pOperation->callback(status, pOperation->pUserContext);
+    }
+    free(pOperation);
+}
+
+static GfnRuntimeError gfnRetrySubmitMessageOperation(GfnRetryApi api, const char* pchData, unsigned int length,
+    GfnRetryStatusCallbackSig callback, void* pUserContext)
+{
+    gfnRetryMessageOperation* pOperation = NULL;
+    GfnRuntimeError status = gfnSuccess;
+
+    pOperation = (gfnRetryMessageOperation*)malloc(sizeof(gfnRetryMessageOperation) + length + 1);
+    if (pOperation == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    pOperation->api = api;
+    pOperation->length = length;
+    pOperation->callback = callback;
+    pOperation->pUserContext = pUserContext;
+    memcpy(pOperation + 1, pchData, length);
+    ((char*)(pOperation + 1))[length] = '\0';
+
+    status = GfnRetrySubmit(api, gfnRetryMessageOperationRun, pOperation, gfnRetryMessageOperationComplete, NULL, NULL);
+    if (GFNSDK_FAILED(status))
+    {
+        free(pOperation);
+    }
+    return status;
+}
+
+GfnRuntimeError GfnOpenURLOnClientWithRetry(const char* pchUrl, GfnRetryStatusCallbackSig callback, void* pUserContext)
+{
+    if (pchUrl == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    return gfnRetrySubmitMessageOperation(gfnRetryApiOpenURLOnClient, pchUrl, (unsigned int)strlen(pchUrl), callback, pUserContext);
+}
+
+GfnRuntimeError GfnSendMessageWithRetry(const char* pchMessage, unsigned int length, GfnRetryStatusCallbackSig callback, void* pUserContext)
+{
+    if (pchMessage == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    return gfnRetrySubmitMessageOperation(gfnRetryApiSendMessage, pchMessage, length, callback, pUserContext);
+}
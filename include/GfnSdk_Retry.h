@@ -0,0 +1,354 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Asynchronous retry scheduler for SDK calls that fail with transient errors
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_Retry.h
+*
+* Optional asynchronous retry scheduler for wrapper API calls
+*/
+///
+/// @page retry_scheduler Retry Scheduler
+///
+/// @section retry_scheduler_introduction Introduction
+/// Many wrapper API calls can fail with transient errors: gfnThrottled, gfnTimedOut and gfnIPCFailure.
+/// Instead of sleeping and retrying on the game thread, titles can submit these calls to the retry
+/// scheduler. The calls are made on a scheduler thread, and a call that fails with a transient error
+/// is retried with exponential back-off and jitter until it succeeds, fails with another error,
+/// runs out of attempts or would exceed its deadline. The final result is reported through a
+/// completion callback on the scheduler thread.
+///
+/// Each API has its own @ref GfnRetryPolicy, which can be changed with @ref GfnRetrySetPolicy.
+/// Typed helpers are provided for the commonly retried APIs, and @ref GfnRetrySubmit accepts any
+/// other operation.
+///
+/// Attempts are made one at a time on the scheduler thread, so a completion callback that blocks
+/// delays every other pending call.
+///
+
+#ifndef __NV_GFNSDK_RETRY_H__
+#define __NV_GFNSDK_RETRY_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Maximum number of calls that can be pending in the scheduler at the same time
+#define GFN_RETRY_MAX_PENDING 128
+
+/// @brief APIs with their own retry policy
+typedef enum GfnRetryApi
+{
+    gfnRetryApiGeneric = 0,             ///< Policy used by @ref GfnRetrySubmit callers that do not pick a specific API
+    gfnRetryApiGetPartnerData,          ///< @ref GfnGetPartnerDataWithRetry
+    gfnRetryApiGetPartnerSecureData,    ///< @ref GfnGetPartnerSecureDataWithRetry
+    gfnRetryApiGetClientIp,             ///< @ref GfnGetClientIpV4WithRetry
+    gfnRetryApiGetClientCountryCode,    ///< @ref GfnGetClientCountryCodeWithRetry
+    gfnRetryApiCloudCheck,              ///< @ref GfnCloudCheckWithRetry
+    gfnRetryApiOpenURLOnClient,         ///< @ref GfnOpenURLOnClientWithRetry
+    gfnRetryApiSendMessage,             ///< @ref GfnSendMessageWithRetry
+    gfnRetryApiCount
+} GfnRetryApi;
+
+/// @brief Retry policy for an API
+typedef struct GfnRetryPolicy
+{
+    unsigned int maxAttempts;       ///< Maximum number of attempts, including the first one. Must be at least 1.
+    unsigned int initialBackoffMs;  ///< Delay before the first retry. Doubles for every following retry.
+    unsigned int maxBackoffMs;      ///< Upper bound for the delay between two attempts
+    unsigned int jitterPercent;     ///< Up to this percentage of each delay is randomly removed, 0 to 100,
+                                    ///< so that callers that failed together do not retry together
+    unsigned int deadlineMs;        ///< No retry is scheduled past this time after the call was submitted. 0 for no deadline.
+} GfnRetryPolicy;
+
+/// @brief Identifies a call submitted to the scheduler. Never 0 for a valid call.
+typedef unsigned int GfnRetryHandle;
+
+/// @brief Operation submitted through @ref GfnRetrySubmit. Called once per attempt on the scheduler thread.
+typedef GfnRuntimeError (*GfnRetryOperationSig)(void* pOperationContext);
+
+///
+/// @brief Callback invoked once when a call submitted through @ref GfnRetrySubmit completes
+///
+/// @param status               - Result of the last attempt, or gfnCanceled
+/// @param attempts             - Number of attempts made
+/// @param pOperationContext    - Operation context passed to @ref GfnRetrySubmit
+/// @param pUserContext         - User context passed to @ref GfnRetrySubmit
+///
+typedef void (GFN_CALLBACK *GfnRetryCompletionSig)(GfnRuntimeError status, unsigned int attempts, void* pOperationContext, void* pUserContext);
+
+/// @brief Completion callback for typed helpers that only report a status
+typedef void (GFN_CALLBACK *GfnRetryStatusCallbackSig)(GfnRuntimeError status, void* pUserContext);
+
+/// @brief Completion callback for typed helpers that return a string. See each helper for string ownership.
+typedef void (GFN_CALLBACK *GfnRetryStringCallbackSig)(GfnRuntimeError status, const char* pchData, void* pUserContext);
+
+/// @brief Completion callback for @ref GfnCloudCheckWithRetry
+typedef void (GFN_CALLBACK *GfnRetryCloudCheckCallbackSig)(GfnRuntimeError status, bool isCloudEnvironment, GfnCloudCheckResponse* pResponse, void* pUserContext);
+
+///
+/// @par Description
+/// Starts the retry scheduler thread.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - The scheduler is already running
+/// @retval gfnUnableToAllocateMemory - The scheduler thread could not be created
+GfnRuntimeError GfnRetryInitialize(void);
+
+///
+/// @par Description
+/// Stops the retry scheduler. Calls still pending are completed with gfnCanceled before this
+/// function returns.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call before @ref GfnShutdownSdk. Must not be called from a completion callback.
+void GfnRetryShutdown(void);
+
+///
+/// @par Description
+/// Replaces the retry policy of an API. Calls already submitted keep their policy.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @retval gfnSuccess              - On success
+/// @retval gfnInvalidParameter     - Unknown API, NULL policy, maxAttempts of 0 or jitterPercent above 100
+GfnRuntimeError GfnRetrySetPolicy(GfnRetryApi api, const GfnRetryPolicy* pPolicy);
+
+///
+/// @par Description
+/// Returns the retry policy of an API.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @retval gfnSuccess              - On success
+/// @retval gfnInvalidParameter     - Unknown API or NULL policy
+GfnRuntimeError GfnRetryGetPolicy(GfnRetryApi api, GfnRetryPolicy* pPolicy);
+
+///
+/// @par Description
+/// Returns true for errors the scheduler considers transient: gfnThrottled, gfnTimedOut and gfnIPCFailure.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+bool GfnRetryIsTransientError(GfnRuntimeError status);
+
+///
+/// @par Description
+/// Submits an operation to the retry scheduler. The first attempt is made on the scheduler thread
+/// as soon as possible, and the call never blocks waiting for it.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param api                      - API whose retry policy applies
+/// @param operation                - Called once per attempt
+/// @param pOperationContext        - Passed unmodified to operation and completion. Must stay valid until completion is called.
+/// @param completion               - Called once when the call completes
+/// @param pUserContext             - Passed unmodified to completion. Can be NULL.
+/// @param pHandle                  - Optional, receives a handle that can be passed to @ref GfnRetryCancel
+///
+/// @retval gfnSuccess                - The operation was submitted
+/// @retval gfnAPINotInit             - @ref GfnRetryInitialize was not called
+/// @retval gfnInvalidParameter       - Unknown API, or NULL operation or completion
+/// @retval gfnThrottled              - @ref GFN_RETRY_MAX_PENDING calls are already pending
+/// @retval gfnUnableToAllocateMemory - The call could not be queued
+GfnRuntimeError GfnRetrySubmit(GfnRetryApi api, GfnRetryOperationSig operation, void* pOperationContext,
+    GfnRetryCompletionSig completion, void* pUserContext, GfnRetryHandle* pHandle);
+
+///
+/// @par Description
+/// Cancels a pending call. If the call is waiting for its next attempt, it is completed with
+/// gfnCanceled before this function returns. If an attempt is in progress, the call completes
+/// with the result of that attempt, or with gfnCanceled if it would have been retried.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @retval gfnSuccess              - The call was canceled, or will complete after the current attempt
+/// @retval gfnAPINotInit           - @ref GfnRetryInitialize was not called
+/// @retval gfnNoData               - The call already completed, or the handle is unknown
+GfnRuntimeError GfnRetryCancel(GfnRetryHandle handle);
+
+///
+/// @par Description
+/// Calls @ref GfnGetPartnerData on the scheduler thread, with retries.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param callback                 - Receives the partner data on success. Call @ref GfnFree to free the memory.
+/// @param pUserContext             - Passed unmodified to callback. Can be NULL.
+///
+/// @return The same values as @ref GfnRetrySubmit
+GfnRuntimeError GfnGetPartnerDataWithRetry(GfnRetryStringCallbackSig callback, void* pUserContext);
+
+///
+/// @par Description
+/// Calls @ref GfnGetPartnerSecureData on the scheduler thread, with retries.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param callback                 - Receives the secure partner data on success. Call @ref GfnFree to free the memory.
+/// @param pUserContext             - Passed unmodified to callback. Can be NULL.
+///
+/// @return The same values as @ref GfnRetrySubmit
+GfnRuntimeError GfnGetPartnerSecureDataWithRetry(GfnRetryStringCallbackSig callback, void* pUserContext);
+
+///
+/// @par Description
+/// Calls @ref GfnGetClientIpV4 on the scheduler thread, with retries.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param callback                 - Receives the client IP on success. Call @ref GfnFree to free the memory.
+/// @param pUserContext             - Passed unmodified to callback. Can be NULL.
+///
+/// @return The same values as @ref GfnRetrySubmit
+GfnRuntimeError GfnGetClientIpV4WithRetry(GfnRetryStringCallbackSig callback, void* pUserContext);
+
+///
+/// @par Description
+/// Calls @ref GfnGetClientCountryCode on the scheduler thread, with retries.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param callback                 - Receives the country code on success. The string is only valid for
+///                                   the duration of the callback and must not be freed.
+/// @param pUserContext             - Passed unmodified to callback. Can be NULL.
+///
+/// @return The same values as @ref GfnRetrySubmit
+GfnRuntimeError GfnGetClientCountryCodeWithRetry(GfnRetryStringCallbackSig callback, void* pUserContext);
+
+///
+/// @par Description
+/// Calls @ref GfnCloudCheck on the scheduler thread, with retries.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param challenge                - Optional challenge. The nonce is copied, so it can be released once this function returns.
+/// @param callback                 - Receives the result. When a challenge was given, pResponse holds the attestation data,
+///                                   which the callback must free with @ref GfnFree. Otherwise pResponse is NULL.
+/// @param pUserContext             - Passed unmodified to callback. Can be NULL.
+///
+/// @return The same values as @ref GfnRetrySubmit
+GfnRuntimeError GfnCloudCheckWithRetry(const GfnCloudCheckChallenge* challenge, GfnRetryCloudCheckCallbackSig callback, void* pUserContext);
+
+///
+/// @par Description
+/// Calls @ref GfnOpenURLOnClient on the scheduler thread, with retries.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pchUrl                   - URL to open. It is copied, so it can be released once this function returns.
+/// @param callback                 - Optional, receives the result
+/// @param pUserContext             - Passed unmodified to callback. Can be NULL.
+///
+/// @return The same values as @ref GfnRetrySubmit
+GfnRuntimeError GfnOpenURLOnClientWithRetry(const char* pchUrl, GfnRetryStatusCallbackSig callback, void* pUserContext);
+
+///
+/// @par Description
+/// Calls @ref GfnSendMessage on the scheduler thread, with retries.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pchMessage               - Message to send. It is copied, so it can be released once this function returns.
+/// @param length                   - Length of pchMessage in characters
+/// @param callback                 - Optional, receives the result
+/// @param pUserContext             - Passed unmodified to callback. Can be NULL.
+///
+/// @return The same values as @ref GfnRetrySubmit
+GfnRuntimeError GfnSendMessageWithRetry(const char* pchMessage, unsigned int length, GfnRetryStatusCallbackSig callback, void* pUserContext);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_RETRY_H__
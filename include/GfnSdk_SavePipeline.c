@@ -0,0 +1,1008 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_SavePipeline.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#   include <fcntl.h>
+#   include <io.h>
+#elif __linux__
+#   include <unistd.h>
+#endif
+
+#define GFN_SAVE_DEFAULT_BLOCK_SIZE 4096
+#define GFN_SAVE_DEFAULT_MAX_DIRTY_BYTES (1024 * 1024)
+#define GFN_SAVE_DEFAULT_MIN_INTERVAL_MS 2000
+#define GFN_SAVE_DEFAULT_MAX_INTERVAL_MS 60000
+#define GFN_SAVE_DEFAULT_COMPACT_RATIO 4
+// Background checkpoints happen about this many times over the remaining session time
+#define GFN_SAVE_CHECKPOINTS_PER_SESSION 10
+// The log is not compacted this close to the end of the session, so that a flush from the exit
+// callback never waits for a full rewrite
+#define GFN_SAVE_NO_COMPACT_REMAINING_SEC 60
+// Longest run of blocks stored in one log record
+#define GFN_SAVE_MAX_RECORD_SIZE (16 * 1024 * 1024)
+
+#define GFN_SAVE_RECORD_MAGIC 0x56415347u   // "GSAV"
+#define GFN_SAVE_RECORD_BLOCK 1
+#define GFN_SAVE_RECORD_COMMIT 2
+
+// Log record. A block record is followed by size bytes of region data. A commit record ends a
+// checkpoint: regionId holds the number of block records in it, offset the checkpoint sequence
+// number, and checksum the chained checksum of the block record headers.
+typedef struct gfnSaveRecord
+{
+    uint32_t magic;
+    uint32_t type;
+    uint32_t regionId;
+    uint32_t size;
+    uint64_t offset;
+    uint64_t checksum;
+} gfnSaveRecord;
+
+typedef struct gfnSaveRegion
+{
+    char* pchName;
+    unsigned char* pData;
+    size_t size;
+    unsigned char* pDirty;              // One flag per block
+    size_t numBlocks;
+} gfnSaveRegion;
+
+// Range of region data copied into the staging buffer by a capture
+typedef struct gfnSaveCapture
+{
+    uint32_t regionId;
+    uint32_t size;
+    uint64_t offset;
+    size_t stagingOffset;
+} gfnSaveCapture;
+
+typedef struct gfnSavePipeline
+{
+    bool initialized;
+    bool started;
+    bool stopping;
+    GfnSavePipelineConfig config;
+    char* pchLogPath;
+    char* pchTempPath;
+
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+
+    gfnSaveRegion* pRegions;
+    unsigned int numRegions;
+    unsigned int capacity;
+    uint64_t dirtyBytes;
+    bool checkpointRequested;
+
+    // Owned by the thread writing a checkpoint, while writing is set
+    bool writing;
+    FILE* pLog;
+    bool rewriteLog;                    // The log could not be repaired after a failed append
+    uint64_t sequence;
+    unsigned char* pStaging;
+    size_t stagingCapacity;
+    gfnSaveCapture* pCaptures;
+    size_t capturesCapacity;
+
+    GfnSdkThread thread;
+    bool threadValid;
+    uint64_t sessionQueryMs;            // Time of the last GfnGetSessionInfo call
+
+    GfnSavePipelineStats stats;
+} gfnSavePipeline;
+
+static gfnSavePipeline s_gfnSave;
+
+static uint64_t gfnSaveChecksum(const void* pData, size_t size, uint64_t checksum)
+{
+    const unsigned char* p = (const unsigned char*)pData;
+    uint64_t word = 0;
+
+    checksum ^= 0x9E3779B97F4A7C15ULL;
+    while (size >= 8)
+    {
+        memcpy(&word, p, sizeof(word));
+        checksum = (checksum ^ word) * 0x100000001B3ULL;
+        checksum ^= checksum >> 29;
+        p += 8;
+        size -= 8;
+    }
+    while (size > 0)
+    {
+        checksum = (checksum ^ *p) * 0x100000001B3ULL;
+        p++;
+        size--;
+    }
+    checksum ^= checksum >> 32;
+    return checksum;
+}
+
+static char* gfnSaveCopyString(const char* pchString, const char* pchSuffix)
+{
+    size_t length = strlen(pchString);
+    size_t suffixLength = strlen(pchSuffix);
+    char* pchCopy = (char*)malloc(length + suffixLength + 1);
+
+    if (pchCopy != NULL)
+    {
+        memcpy(pchCopy, pchString, length);
+        memcpy(pchCopy + length, pchSuffix, suffixLength + 1);
+    }
+    return pchCopy;
+}
+
+static size_t gfnSaveBlockLength(const gfnSaveRegion* pRegion, size_t block)
+{
+    size_t offset = block * s_gfnSave.config.blockSize;
+    size_t remaining = pRegion->size - offset;
+
+    return (remaining < s_gfnSave.config.blockSize) ? remaining : s_gfnSave.config.blockSize;
+}
+
+// Called with the pipeline lock held
+static void gfnSaveMarkBlocks(gfnSaveRegion* pRegion, size_t offset, size_t size)
+{
+    size_t block = offset / s_gfnSave.config.blockSize;
+    size_t lastBlock = (offset + size - 1) / s_gfnSave.config.blockSize;
+
+    for (; block <= lastBlock; block++)
+    {
+        if (!pRegion->pDirty[block])
+        {
+            pRegion->pDirty[block] = 1;
+            s_gfnSave.dirtyBytes += gfnSaveBlockLength(pRegion, block);
+        }
+    }
+}
+
+static bool gfnSaveSyncFile(FILE* pFile)
+{
+    if (fflush(pFile) != 0)
+    {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(pFile)) == 0;
+#elif __linux__
+    return fsync(fileno(pFile)) == 0;
+#endif
+}
+
+static bool gfnSaveReplaceFile(const char* pchFrom, const char* pchTo)
+{
+#ifdef _WIN32
+    return MoveFileExA(pchFrom, pchTo, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(pchFrom, pchTo) == 0;
+#endif
+}
+
+// Called by the thread owning the staging buffers. Copies the dirty blocks, or all of them, under
+// the state lock and clears them. Returns the number of captures.
+static GfnRuntimeError gfnSaveCaptureBlocks(bool all, size_t* pNumCaptures, uint64_t* pBytes)
+{
+    gfnSaveRegion* pRegion = NULL;
+    gfnSaveCapture* pCapture = NULL;
+    size_t numCaptures = 0;
+    size_t stagingSize = 0;
+    size_t runStart = 0;
+    size_t runLength = 0;
+    size_t block = 0;
+    size_t blockLength = 0;
+    unsigned int i = 0;
+    void* pGrown = NULL;
+    int pass = 0;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (s_gfnSave.config.lockState != NULL)
+    {
+        s_gfnSave.config.lockState(true, s_gfnSave.config.pLockContext);
+    }
+    gfnSdkMutexLock(&s_gfnSave.lock);
+
+    // The first pass sizes the buffers, the second copies the blocks, so that a failed allocation
+    // leaves every block dirty
+    for (pass = 0; pass < 2 && result == gfnSuccess; pass++)
+    {
+        numCaptures = 0;
+        stagingSize = 0;
+        for (i = 0; i < s_gfnSave.numRegions; i++)
+        {
+            pRegion = &s_gfnSave.pRegions[i];
+            runLength = 0;
+            for (block = 0; block <= pRegion->numBlocks; block++)
+            {
+                blockLength = (block < pRegion->numBlocks) ? gfnSaveBlockLength(pRegion, block) : 0;
+                if (block < pRegion->numBlocks && (all || pRegion->pDirty[block])
+                    && runLength + blockLength <= GFN_SAVE_MAX_RECORD_SIZE)
+                {
+                    if (runLength == 0)
+                    {
+                        runStart = block * s_gfnSave.config.blockSize;
+                    }
+                    runLength += blockLength;
+                    if (pass == 1)
+                    {
+                        pRegion->pDirty[block] = 0;
+                    }
+                    continue;
+                }
+                if (runLength > 0)
+                {
+                    if (pass == 1)
+                    {
+                        pCapture = &s_gfnSave.pCaptures[numCaptures];
+                        pCapture->regionId = i;
+                        pCapture->size = (uint32_t)runLength;
+                        pCapture->offset = runStart;
+                        pCapture->stagingOffset = stagingSize;
+                        memcpy(s_gfnSave.pStaging + stagingSize, pRegion->pData + runStart, runLength);
+                    }
+                    numCaptures++;
+                    stagingSize += runLength;
+                    runLength = 0;
+                    // The block that ended the run because it was too long starts the next one
+                    if (block < pRegion->numBlocks && (all || pRegion->pDirty[block]))
+                    {
+                        block--;
+                    }
+                }
+            }
+        }
+        if (pass == 0 && numCaptures > s_gfnSave.capturesCapacity)
+        {
+            pGrown = realloc(s_gfnSave.pCaptures, numCaptures * sizeof(gfnSaveCapture));
+            if (pGrown == NULL)
+            {
+                result = gfnUnableToAllocateMemory;
+                break;
+            }
+            s_gfnSave.pCaptures = (gfnSaveCapture*)pGrown;
+            s_gfnSave.capturesCapacity = numCaptures;
+        }
+        if (pass == 0 && stagingSize > s_gfnSave.stagingCapacity)
+        {
+            pGrown = realloc(s_gfnSave.pStaging, stagingSize);
+            if (pGrown == NULL)
+            {
+                result = gfnUnableToAllocateMemory;
+                break;
+            }
+            s_gfnSave.pStaging = (unsigned char*)pGrown;
+            s_gfnSave.stagingCapacity = stagingSize;
+        }
+    }
+    if (result == gfnSuccess)
+    {
+        s_gfnSave.dirtyBytes = 0;
+    }
+
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+    if (s_gfnSave.config.lockState != NULL)
+    {
+        s_gfnSave.config.lockState(false, s_gfnSave.config.pLockContext);
+    }
+    *pNumCaptures = (result == gfnSuccess) ? numCaptures : 0;
+    *pBytes = (result == gfnSuccess) ? stagingSize : 0;
+    return result;
+}
+
+// Marks captured blocks dirty again after they could not be written
+static void gfnSaveRestoreCaptures(size_t numCaptures)
+{
+    size_t i = 0;
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    for (i = 0; i < numCaptures; i++)
+    {
+        gfnSaveMarkBlocks(&s_gfnSave.pRegions[s_gfnSave.pCaptures[i].regionId], (size_t)s_gfnSave.pCaptures[i].offset,
+            s_gfnSave.pCaptures[i].size);
+    }
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+}
+
+// Writes the captures as one checkpoint, and waits until it is on disk
+static bool gfnSaveWriteCheckpoint(FILE* pFile, size_t numCaptures, uint64_t* pLogBytes)
+{
+    gfnSaveRecord record;
+    const gfnSaveCapture* pCapture = NULL;
+    const unsigned char* pData = NULL;
+    uint64_t chain = 0;
+    uint64_t written = 0;
+    size_t i = 0;
+
+    for (i = 0; i < numCaptures; i++)
+    {
+        pCapture = &s_gfnSave.pCaptures[i];
+        pData = s_gfnSave.pStaging + pCapture->stagingOffset;
+        record.magic = GFN_SAVE_RECORD_MAGIC;
+        record.type = GFN_SAVE_RECORD_BLOCK;
+        record.regionId = pCapture->regionId;
+        record.size = pCapture->size;
+        record.offset = pCapture->offset;
+        record.checksum = gfnSaveChecksum(pData, pCapture->size, 0);
+        chain = gfnSaveChecksum(&record, sizeof(record), chain);
+        if (fwrite(&record, sizeof(record), 1, pFile) != 1 || fwrite(pData, 1, pCapture->size, pFile) != pCapture->size)
+        {
+            return false;
+        }
+        written += sizeof(record) + pCapture->size;
+    }
+    record.magic = GFN_SAVE_RECORD_MAGIC;
+    record.type = GFN_SAVE_RECORD_COMMIT;
+    record.regionId = (uint32_t)numCaptures;
+    record.size = 0;
+    record.offset = s_gfnSave.sequence;
+    record.checksum = chain;
+    if (fwrite(&record, sizeof(record), 1, pFile) != 1 || !gfnSaveSyncFile(pFile))
+    {
+        return false;
+    }
+    s_gfnSave.sequence++;
+    *pLogBytes += written + sizeof(record);
+    return true;
+}
+
+// Called by the thread owning the staging buffers after a checkpoint could not be appended.
+// Replay stops at the first damaged record, so whatever part of the checkpoint reached the log
+// is cut off, and later checkpoints follow the last complete one. If that fails, the next
+// checkpoint rewrites the whole log instead of appending to it.
+static void gfnSaveRepairLog(void)
+{
+    bool repaired = false;
+#ifdef _WIN32
+    int fd = -1;
+#endif
+
+    if (s_gfnSave.pLog != NULL)
+    {
+        // Closing can still write buffered data of the failed checkpoint, which is cut off below
+        fclose(s_gfnSave.pLog);
+        s_gfnSave.pLog = NULL;
+    }
+#ifdef _WIN32
+    fd = _open(s_gfnSave.pchLogPath, _O_WRONLY | _O_BINARY);
+    if (fd >= 0)
+    {
+        repaired = _chsize_s(fd, (__int64)s_gfnSave.stats.logBytes) == 0;
+        repaired = (_close(fd) == 0) && repaired;
+    }
+#elif __linux__
+    repaired = truncate(s_gfnSave.pchLogPath, (off_t)s_gfnSave.stats.logBytes) == 0;
+#endif
+    if (repaired)
+    {
+        s_gfnSave.pLog = fopen(s_gfnSave.pchLogPath, "ab");
+    }
+    s_gfnSave.rewriteLog = (s_gfnSave.pLog == NULL);
+}
+
+// Called by the thread owning the staging buffers. Writes the full state to a new log and
+// replaces the current one with it.
+static GfnRuntimeError gfnSaveCompact(uint64_t* pBytes)
+{
+    FILE* pFile = NULL;
+    uint64_t logBytes = 0;
+    size_t numCaptures = 0;
+    GfnRuntimeError result = gfnSaveCaptureBlocks(true, &numCaptures, pBytes);
+    bool written = false;
+
+    if (result != gfnSuccess)
+    {
+        return result;
+    }
+    pFile = fopen(s_gfnSave.pchTempPath, "wb");
+    if (pFile != NULL)
+    {
+        written = gfnSaveWriteCheckpoint(pFile, numCaptures, &logBytes);
+        written = (fclose(pFile) == 0) && written;
+    }
+    if (written)
+    {
+        // The open log is closed first so that it can be replaced on Windows
+        if (s_gfnSave.pLog != NULL)
+        {
+            fclose(s_gfnSave.pLog);
+        }
+        written = gfnSaveReplaceFile(s_gfnSave.pchTempPath, s_gfnSave.pchLogPath);
+        s_gfnSave.pLog = fopen(s_gfnSave.pchLogPath, "ab");
+        written = written && s_gfnSave.pLog != NULL;
+    }
+    if (!written)
+    {
+        remove(s_gfnSave.pchTempPath);
+        gfnSaveRestoreCaptures(numCaptures);
+        s_gfnSave.rewriteLog = s_gfnSave.rewriteLog || s_gfnSave.pLog == NULL;
+        return gfnInternalError;
+    }
+    s_gfnSave.rewriteLog = false;
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    s_gfnSave.stats.logBytes = logBytes;
+    s_gfnSave.stats.numCompactions++;
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+    return gfnSuccess;
+}
+
+// Called by the thread owning the staging buffers. Appends the changes to the log.
+static GfnRuntimeError gfnSaveAppend(uint64_t* pBytes)
+{
+    uint64_t logBytes = 0;
+    size_t numCaptures = 0;
+    GfnRuntimeError result = gfnSaveCaptureBlocks(false, &numCaptures, pBytes);
+
+    if (result != gfnSuccess || numCaptures == 0)
+    {
+        return result;
+    }
+    if (s_gfnSave.pLog == NULL || !gfnSaveWriteCheckpoint(s_gfnSave.pLog, numCaptures, &logBytes))
+    {
+        gfnSaveRestoreCaptures(numCaptures);
+        gfnSaveRepairLog();
+        return gfnInternalError;
+    }
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    s_gfnSave.stats.logBytes += logBytes;
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+    return gfnSuccess;
+}
+
+// Writes a checkpoint once no other one is being written. Returns the time taken, including the wait.
+static GfnRuntimeError gfnSaveCheckpoint(bool compact, uint64_t* pBytes, uint64_t* pDurationMs)
+{
+    uint64_t startMs = gfnSdkGetTimeMs();
+    GfnRuntimeError result = gfnSuccess;
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    while (s_gfnSave.writing)
+    {
+        gfnSdkCondWait(&s_gfnSave.cond, &s_gfnSave.lock);
+    }
+    s_gfnSave.writing = true;
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+
+    *pBytes = 0;
+    result = (compact || s_gfnSave.rewriteLog) ? gfnSaveCompact(pBytes) : gfnSaveAppend(pBytes);
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    s_gfnSave.writing = false;
+    if (result == gfnSuccess)
+    {
+        s_gfnSave.stats.bytesWritten += *pBytes;
+    }
+    else
+    {
+        s_gfnSave.stats.numFailures++;
+    }
+    gfnSdkCondBroadcast(&s_gfnSave.cond);
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+
+    *pDurationMs = gfnSdkGetTimeMs() - startMs;
+    return result;
+}
+
+// Spreads the background checkpoints over the remaining session time, so that they come more
+// often as the end of the session approaches
+static unsigned int gfnSaveNextIntervalMs(void)
+{
+    GfnSessionInfo sessionInfo;
+    uint64_t intervalMs = s_gfnSave.config.maxIntervalMs;
+    uint64_t nowMs = gfnSdkGetTimeMs();
+    unsigned int remainingSec = 0;
+
+    // Checkpoints started by the amount of dirty data can follow each other closely, so the
+    // session is not queried more often than the shortest interval
+    if (s_gfnSave.sessionQueryMs != 0 && nowMs - s_gfnSave.sessionQueryMs < s_gfnSave.config.minIntervalMs)
+    {
+        return s_gfnSave.stats.intervalMs;
+    }
+    s_gfnSave.sessionQueryMs = nowMs;
+    memset(&sessionInfo, 0, sizeof(sessionInfo));
+    if (GfnGetSessionInfo(&sessionInfo) == gfnSuccess && sessionInfo.sessionTimeRemainingSec > 0)
+    {
+        remainingSec = sessionInfo.sessionTimeRemainingSec;
+        intervalMs = (uint64_t)remainingSec * 1000 / GFN_SAVE_CHECKPOINTS_PER_SESSION;
+        if (intervalMs < s_gfnSave.config.minIntervalMs)
+        {
+            intervalMs = s_gfnSave.config.minIntervalMs;
+        }
+        else if (intervalMs > s_gfnSave.config.maxIntervalMs)
+        {
+            intervalMs = s_gfnSave.config.maxIntervalMs;
+        }
+    }
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    s_gfnSave.stats.sessionTimeRemainingSec = remainingSec;
+    s_gfnSave.stats.intervalMs = (unsigned int)intervalMs;
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+    return (unsigned int)intervalMs;
+}
+
+static void gfnSaveThread(void* pContext)
+{
+    uint64_t deadlineMs = 0;
+    uint64_t nowMs = 0;
+    uint64_t bytes = 0;
+    uint64_t durationMs = 0;
+    unsigned int intervalMs = 0;
+    bool failed = false;
+    bool compact = false;
+    bool stopping = false;
+
+    (void)pContext;
+    for (;;)
+    {
+        // After a failure, wait at least the shortest interval instead of retrying right away
+        intervalMs = failed ? s_gfnSave.config.minIntervalMs : gfnSaveNextIntervalMs();
+
+        gfnSdkMutexLock(&s_gfnSave.lock);
+        deadlineMs = gfnSdkGetTimeMs() + intervalMs;
+        while (!s_gfnSave.stopping && !s_gfnSave.checkpointRequested
+            && (failed || s_gfnSave.dirtyBytes < s_gfnSave.config.maxDirtyBytes)
+            && (nowMs = gfnSdkGetTimeMs()) < deadlineMs)
+        {
+            gfnSdkCondTimedWait(&s_gfnSave.cond, &s_gfnSave.lock, (uint32_t)(deadlineMs - nowMs));
+        }
+        stopping = s_gfnSave.stopping;
+        s_gfnSave.checkpointRequested = false;
+        compact = s_gfnSave.stats.logBytes > (uint64_t)s_gfnSave.config.compactRatio * s_gfnSave.stats.stateBytes
+            && (s_gfnSave.stats.sessionTimeRemainingSec == 0 || s_gfnSave.stats.sessionTimeRemainingSec > GFN_SAVE_NO_COMPACT_REMAINING_SEC);
+        gfnSdkMutexUnlock(&s_gfnSave.lock);
+        if (stopping)
+        {
+            break;
+        }
+
+        failed = gfnSaveCheckpoint(compact, &bytes, &durationMs) != gfnSuccess;
+        if (!failed && (bytes > 0 || compact))
+        {
+            gfnSdkMutexLock(&s_gfnSave.lock);
+            s_gfnSave.stats.numCheckpoints++;
+            s_gfnSave.stats.lastCheckpointMs = durationMs;
+            gfnSdkMutexUnlock(&s_gfnSave.lock);
+        }
+    }
+}
+
+static GfnApplicationCallbackResult GFN_CALLBACK gfnSaveOnSave(void* pContext)
+{
+    GfnRuntimeError result = GfnSavePipelineFlush();
+    GfnApplicationCallbackResult callbackResult = crCallbackSuccess;
+
+    (void)pContext;
+    if (s_gfnSave.config.saveCallback != NULL)
+    {
+        callbackResult = s_gfnSave.config.saveCallback(s_gfnSave.config.pCallbackContext);
+    }
+    return (result == gfnSuccess) ? callbackResult : crCallbackFailure;
+}
+
+static GfnApplicationCallbackResult GFN_CALLBACK gfnSaveOnExit(void* pContext)
+{
+    GfnRuntimeError result = GfnSavePipelineFlush();
+    GfnApplicationCallbackResult callbackResult = crCallbackSuccess;
+
+    (void)pContext;
+    if (s_gfnSave.config.exitCallback != NULL)
+    {
+        callbackResult = s_gfnSave.config.exitCallback(s_gfnSave.config.pCallbackContext);
+    }
+    return (result == gfnSuccess) ? callbackResult : crCallbackFailure;
+}
+
+// Applies the checkpoints of a log read into memory, up to the first incomplete or damaged one
+static bool gfnSaveReplay(const unsigned char* pLog, size_t size)
+{
+    gfnSaveRecord record;
+    gfnSaveRecord block;
+    size_t position = 0;
+    size_t batchStart = 0;
+    size_t applyPosition = 0;
+    uint64_t chain = 0;
+    uint32_t numBlocks = 0;
+    uint32_t i = 0;
+    gfnSaveRegion* pRegion = NULL;
+    bool restored = false;
+
+    while (size - position >= sizeof(record))
+    {
+        memcpy(&record, pLog + position, sizeof(record));
+        if (record.magic != GFN_SAVE_RECORD_MAGIC)
+        {
+            break;
+        }
+        if (record.type == GFN_SAVE_RECORD_BLOCK)
+        {
+            if (record.regionId >= s_gfnSave.numRegions || record.size > size - position - sizeof(record)
+                || record.offset > s_gfnSave.pRegions[record.regionId].size
+                || record.size > s_gfnSave.pRegions[record.regionId].size - record.offset
+                || gfnSaveChecksum(pLog + position + sizeof(record), record.size, 0) != record.checksum)
+            {
+                break;
+            }
+            chain = gfnSaveChecksum(&record, sizeof(record), chain);
+            numBlocks++;
+            position += sizeof(record) + record.size;
+            continue;
+        }
+        if (record.type != GFN_SAVE_RECORD_COMMIT || record.regionId != numBlocks || record.checksum != chain)
+        {
+            break;
+        }
+
+        // The checkpoint is complete, apply its blocks
+        applyPosition = batchStart;
+        for (i = 0; i < numBlocks; i++)
+        {
+            memcpy(&block, pLog + applyPosition, sizeof(block));
+            pRegion = &s_gfnSave.pRegions[block.regionId];
+            memcpy(pRegion->pData + block.offset, pLog + applyPosition + sizeof(block), block.size);
+            applyPosition += sizeof(block) + block.size;
+        }
+        s_gfnSave.sequence = record.offset + 1;
+        restored = true;
+        position += sizeof(record);
+        batchStart = position;
+        chain = 0;
+        numBlocks = 0;
+    }
+    return restored;
+}
+
+GfnRuntimeError GfnSavePipelineInitialize(const GfnSavePipelineConfig* pConfig)
+{
+    if (s_gfnSave.initialized || pConfig == NULL || pConfig->pchLogPath == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    memset(&s_gfnSave, 0, sizeof(s_gfnSave));
+    s_gfnSave.config = *pConfig;
+    if (s_gfnSave.config.blockSize == 0)
+    {
+        s_gfnSave.config.blockSize = GFN_SAVE_DEFAULT_BLOCK_SIZE;
+    }
+    else if (s_gfnSave.config.blockSize > GFN_SAVE_MAX_RECORD_SIZE)
+    {
+        s_gfnSave.config.blockSize = GFN_SAVE_MAX_RECORD_SIZE;
+    }
+    if (s_gfnSave.config.maxDirtyBytes == 0)
+    {
+        s_gfnSave.config.maxDirtyBytes = GFN_SAVE_DEFAULT_MAX_DIRTY_BYTES;
+    }
+    if (s_gfnSave.config.minIntervalMs == 0)
+    {
+        s_gfnSave.config.minIntervalMs = GFN_SAVE_DEFAULT_MIN_INTERVAL_MS;
+    }
+    if (s_gfnSave.config.maxIntervalMs == 0)
+    {
+        s_gfnSave.config.maxIntervalMs = GFN_SAVE_DEFAULT_MAX_INTERVAL_MS;
+    }
+    if (s_gfnSave.config.maxIntervalMs < s_gfnSave.config.minIntervalMs)
+    {
+        s_gfnSave.config.maxIntervalMs = s_gfnSave.config.minIntervalMs;
+    }
+    if (s_gfnSave.config.compactRatio == 0)
+    {
+        s_gfnSave.config.compactRatio = GFN_SAVE_DEFAULT_COMPACT_RATIO;
+    }
+    s_gfnSave.pchLogPath = gfnSaveCopyString(pConfig->pchLogPath, "");
+    s_gfnSave.pchTempPath = gfnSaveCopyString(pConfig->pchLogPath, ".tmp");
+    s_gfnSave.config.pchLogPath = s_gfnSave.pchLogPath;
+    if (s_gfnSave.pchLogPath == NULL || s_gfnSave.pchTempPath == NULL)
+    {
+        free(s_gfnSave.pchLogPath);
+        free(s_gfnSave.pchTempPath);
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkMutexInit(&s_gfnSave.lock))
+    {
+        free(s_gfnSave.pchLogPath);
+        free(s_gfnSave.pchTempPath);
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkCondInit(&s_gfnSave.cond))
+    {
+        gfnSdkMutexDestroy(&s_gfnSave.lock);
+        free(s_gfnSave.pchLogPath);
+        free(s_gfnSave.pchTempPath);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnSave.stats.lastFlushResult = gfnSuccess;
+    s_gfnSave.initialized = true;
+    return gfnSuccess;
+}
+
+void GfnSavePipelineShutdown(void)
+{
+    unsigned int i = 0;
+
+    if (!s_gfnSave.initialized)
+    {
+        return;
+    }
+
+    if (s_gfnSave.started)
+    {
+        gfnSdkMutexLock(&s_gfnSave.lock);
+        s_gfnSave.stopping = true;
+        gfnSdkCondBroadcast(&s_gfnSave.cond);
+        gfnSdkMutexUnlock(&s_gfnSave.lock);
+        if (s_gfnSave.threadValid)
+        {
+            gfnSdkThreadJoin(s_gfnSave.thread);
+        }
+        GfnSavePipelineFlush();
+    }
+    if (s_gfnSave.pLog != NULL)
+    {
+        fclose(s_gfnSave.pLog);
+    }
+    for (i = 0; i < s_gfnSave.numRegions; i++)
+    {
+        free(s_gfnSave.pRegions[i].pchName);
+        free(s_gfnSave.pRegions[i].pDirty);
+    }
+    free(s_gfnSave.pRegions);
+    free(s_gfnSave.pStaging);
+    free(s_gfnSave.pCaptures);
+    free(s_gfnSave.pchLogPath);
+    free(s_gfnSave.pchTempPath);
+
+    s_gfnSave.initialized = false;
+    gfnSdkCondDestroy(&s_gfnSave.cond);
+    gfnSdkMutexDestroy(&s_gfnSave.lock);
+    memset(&s_gfnSave, 0, sizeof(s_gfnSave));
+}
+
+GfnRuntimeError GfnSaveAddRegion(const GfnSaveRegionDesc* pDesc, GfnSaveRegionId* pId)
+{
+    gfnSaveRegion* pRegion = NULL;
+    gfnSaveRegion* pRegions = NULL;
+    unsigned int capacity = 0;
+
+    if (!s_gfnSave.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pDesc == NULL || pDesc->pData == NULL || pDesc->size == 0 || s_gfnSave.started)
+    {
+        return gfnInvalidParameter;
+    }
+
+    if (s_gfnSave.numRegions == s_gfnSave.capacity)
+    {
+        capacity = (s_gfnSave.capacity > 0) ? s_gfnSave.capacity * 2 : 8;
+        pRegions = (gfnSaveRegion*)realloc(s_gfnSave.pRegions, capacity * sizeof(gfnSaveRegion));
+        if (pRegions == NULL)
+        {
+            return gfnUnableToAllocateMemory;
+        }
+        s_gfnSave.pRegions = pRegions;
+        s_gfnSave.capacity = capacity;
+    }
+    pRegion = &s_gfnSave.pRegions[s_gfnSave.numRegions];
+    memset(pRegion, 0, sizeof(*pRegion));
+    pRegion->pchName = gfnSaveCopyString((pDesc->pchName != NULL) ? pDesc->pchName : "", "");
+    pRegion->numBlocks = (pDesc->size + s_gfnSave.config.blockSize - 1) / s_gfnSave.config.blockSize;
+    pRegion->pDirty = (unsigned char*)calloc(pRegion->numBlocks, 1);
+    if (pRegion->pchName == NULL || pRegion->pDirty == NULL)
+    {
+        free(pRegion->pchName);
+        free(pRegion->pDirty);
+        return gfnUnableToAllocateMemory;
+    }
+    pRegion->pData = (unsigned char*)pDesc->pData;
+    pRegion->size = pDesc->size;
+
+    s_gfnSave.stats.stateBytes += pDesc->size;
+    if (pId != NULL)
+    {
+        *pId = s_gfnSave.numRegions;
+    }
+    s_gfnSave.numRegions++;
+    s_gfnSave.stats.numRegions = s_gfnSave.numRegions;
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnSavePipelineLoad(void)
+{
+    FILE* pFile = NULL;
+    unsigned char* pLog = NULL;
+    long size = 0;
+    bool read = false;
+    bool restored = false;
+
+    if (!s_gfnSave.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (s_gfnSave.started)
+    {
+        return gfnInvalidParameter;
+    }
+
+    pFile = fopen(s_gfnSave.pchLogPath, "rb");
+    if (pFile == NULL)
+    {
+        return gfnNoData;
+    }
+    if (fseek(pFile, 0, SEEK_END) == 0 && (size = ftell(pFile)) > 0 && fseek(pFile, 0, SEEK_SET) == 0)
+    {
+        pLog = (unsigned char*)malloc((size_t)size);
+        if (pLog == NULL)
+        {
+            fclose(pFile);
+            return gfnUnableToAllocateMemory;
+        }
+        read = fread(pLog, 1, (size_t)size, pFile) == (size_t)size;
+    }
+    fclose(pFile);
+
+    if (read)
+    {
+        restored = gfnSaveReplay(pLog, (size_t)size);
+    }
+    free(pLog);
+    return restored ? gfnSuccess : gfnNoData;
+}
+
+GfnRuntimeError GfnSavePipelineStart(void)
+{
+    uint64_t bytes = 0;
+    uint64_t durationMs = 0;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (!s_gfnSave.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (s_gfnSave.started)
+    {
+        return gfnInvalidParameter;
+    }
+
+    // A new log starts with the full state, which drops whatever the old one held past its last
+    // complete checkpoint
+    result = gfnSaveCheckpoint(true, &bytes, &durationMs);
+    if (result != gfnSuccess)
+    {
+        return result;
+    }
+    s_gfnSave.started = true;
+    s_gfnSave.threadValid = gfnSdkThreadCreate(&s_gfnSave.thread, gfnSaveThread, NULL);
+    if (!s_gfnSave.threadValid)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+
+    if (!s_gfnSave.config.manualCallbacks)
+    {
+        result = GfnRegisterSaveCallback(gfnSaveOnSave, NULL);
+        if (result == gfnSuccess)
+        {
+            result = GfnRegisterExitCallback(gfnSaveOnExit, NULL);
+        }
+    }
+    return result;
+}
+
+GfnRuntimeError GfnSaveMarkDirty(GfnSaveRegionId id, size_t offset, size_t size)
+{
+    bool wake = false;
+
+    if (!s_gfnSave.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (id >= s_gfnSave.numRegions || offset > s_gfnSave.pRegions[id].size || size > s_gfnSave.pRegions[id].size - offset)
+    {
+        return gfnInvalidParameter;
+    }
+    if (size == 0)
+    {
+        return gfnSuccess;
+    }
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    wake = s_gfnSave.dirtyBytes < s_gfnSave.config.maxDirtyBytes;
+    gfnSaveMarkBlocks(&s_gfnSave.pRegions[id], offset, size);
+    wake = wake && s_gfnSave.dirtyBytes >= s_gfnSave.config.maxDirtyBytes;
+    if (wake)
+    {
+        gfnSdkCondBroadcast(&s_gfnSave.cond);
+    }
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnSavePipelineRequestCheckpoint(void)
+{
+    if (!s_gfnSave.initialized || !s_gfnSave.started)
+    {
+        return gfnAPINotInit;
+    }
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    s_gfnSave.checkpointRequested = true;
+    gfnSdkCondBroadcast(&s_gfnSave.cond);
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnSavePipelineFlush(void)
+{
+    uint64_t bytes = 0;
+    uint64_t durationMs = 0;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (!s_gfnSave.initialized || !s_gfnSave.started)
+    {
+        return gfnAPINotInit;
+    }
+
+    result = gfnSaveCheckpoint(false, &bytes, &durationMs);
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    s_gfnSave.stats.numFlushes++;
+    s_gfnSave.stats.lastFlushMs = durationMs;
+    s_gfnSave.stats.lastFlushBytes = bytes;
+    s_gfnSave.stats.lastFlushResult = result;
+    if (durationMs > s_gfnSave.stats.maxFlushMs)
+    {
+        s_gfnSave.stats.maxFlushMs = durationMs;
+    }
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+    return result;
+}
+
+GfnRuntimeError GfnSavePipelineGetStats(GfnSavePipelineStats* pStats)
+{
+    if (!s_gfnSave.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pStats == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&s_gfnSave.lock);
+    *pStats = s_gfnSave.stats;
+    pStats->dirtyBytes = s_gfnSave.dirtyBytes;
+    gfnSdkMutexUnlock(&s_gfnSave.lock);
+    return gfnSuccess;
+}
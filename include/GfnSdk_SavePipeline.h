@@ -0,0 +1,322 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Incremental save of application state for the save and exit callbacks
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_SavePipeline.h
+*
+* Optional incremental save helper built on @ref GfnRegisterSaveCallback, @ref GfnRegisterExitCallback
+* and @ref GfnGetSessionInfo
+*/
+///
+/// @page save_pipeline Save Pipeline
+///
+/// @section save_pipeline_introduction Introduction
+/// When GeForce NOW calls the save or exit callback, the application has to persist the user's
+/// progress before the session is torn down; the exit callback has 5 seconds to return. Writing
+/// the full state at that point is slow and risky. The save pipeline keeps the work done inside
+/// the callbacks small by saving most changes in the background beforehand:
+///
+/// - The application registers the memory regions holding its state with @ref GfnSaveAddRegion,
+///   and reports changes with @ref GfnSaveMarkDirty. Changes are tracked per block.
+/// - A background thread checkpoints periodically: it copies the dirty blocks and appends them to
+///   an append-only log, followed by a commit record. The interval shrinks as the remaining
+///   session time reported by @ref GfnGetSessionInfo runs out, and a checkpoint starts early once
+///   the dirty data exceeds @ref GfnSavePipelineConfig::maxDirtyBytes.
+/// - The save and exit callbacks call @ref GfnSavePipelineFlush, which only has to write what
+///   changed since the last checkpoint, at most about maxDirtyBytes. Its latency is part of
+///   @ref GfnSavePipelineStats.
+/// - Once the log grows past a multiple of the state size, the background thread rewrites it as a
+///   single full checkpoint, unless the session is about to end.
+///
+/// @ref GfnSavePipelineLoad restores the regions from the log at the next launch. Checkpoints
+/// are applied up to the last one that was completely written; a checkpoint cut short by a crash
+/// is ignored. A checkpoint that fails to be written is cut off the log again, or the log is
+/// rewritten in full by the next checkpoint if that is not possible, so later checkpoints are not
+/// lost behind it. The save and exit callbacks return crCallbackFailure when their flush failed.
+///
+/// @section save_pipeline_consistency Consistency
+/// Checkpoints copy the dirty blocks while the application's state lock is held, through
+/// @ref GfnSavePipelineConfig::lockState. Modify the regions and call @ref GfnSaveMarkDirty under
+/// that same lock, so that every checkpoint sees complete changes. The copy is a memcpy of the
+/// dirty blocks only, so the lock is held briefly.
+
+#ifndef __NV_GFNSDK_SAVE_PIPELINE_H__
+#define __NV_GFNSDK_SAVE_PIPELINE_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Identifies a region added with @ref GfnSaveAddRegion
+typedef unsigned int GfnSaveRegionId;
+
+///
+/// @brief Takes or releases the application's state lock
+///
+/// @param lock         - true to take the lock, false to release it
+/// @param pUserContext - Context from @ref GfnSavePipelineConfig::pLockContext
+///
+typedef void (GFN_CALLBACK *GfnSaveStateLockSig)(bool lock, void* pUserContext);
+
+/// @brief Memory region of application state passed to @ref GfnSaveAddRegion
+typedef struct GfnSaveRegionDesc
+{
+    const char* pchName;        ///< Used in diagnostics. Copied.
+    void* pData;                ///< State memory, owned by the application, valid until @ref GfnSavePipelineShutdown
+    size_t size;                ///< Size of the region in bytes. Must stay the same between launches to load the log.
+} GfnSaveRegionDesc;
+
+/// @brief Configuration passed to @ref GfnSavePipelineInitialize. Zero members select the defaults.
+typedef struct GfnSavePipelineConfig
+{
+    const char* pchLogPath;             ///< Path of the save log. Required. Copied.
+    unsigned int blockSize;             ///< Granularity of change tracking in bytes, 0 for 4096
+    size_t maxDirtyBytes;               ///< A checkpoint starts early above this much changed data, 0 for 1 MiB
+    unsigned int minIntervalMs;         ///< Shortest time between background checkpoints, 0 for 2000
+    unsigned int maxIntervalMs;         ///< Longest time between background checkpoints, 0 for 60000
+    unsigned int compactRatio;          ///< The log is rewritten once larger than this many times the state, 0 for 4
+    bool manualCallbacks;               ///< Do not register the save and exit callbacks; the application calls @ref GfnSavePipelineFlush
+    GfnSaveStateLockSig lockState;      ///< Optional, see @ref save_pipeline_consistency
+    void* pLockContext;                 ///< Passed unmodified to lockState
+    SaveCallbackSig saveCallback;       ///< Optional, called after the flush when GeForce NOW requests a save. The flush result is in @ref GfnSavePipelineStats::lastFlushResult.
+    ExitCallbackSig exitCallback;       ///< Optional, called after the flush when GeForce NOW ends the session. The flush result is in @ref GfnSavePipelineStats::lastFlushResult.
+    void* pCallbackContext;             ///< Passed unmodified to saveCallback and exitCallback
+} GfnSavePipelineConfig;
+
+/// @brief Counters and timing of the save pipeline. Times are in milliseconds.
+typedef struct GfnSavePipelineStats
+{
+    unsigned int numRegions;
+    uint64_t stateBytes;                ///< Total size of the regions
+    uint64_t dirtyBytes;                ///< Changed since the last checkpoint, in whole blocks
+    uint64_t logBytes;                  ///< Current size of the log
+    uint64_t bytesWritten;              ///< State data written to the log, including compactions
+    unsigned int numCheckpoints;        ///< Background checkpoints written
+    unsigned int numCompactions;        ///< Times the log was rewritten as a full checkpoint
+    unsigned int numFailures;           ///< Checkpoints and flushes that could not be written
+    uint64_t lastCheckpointMs;          ///< Duration of the last background checkpoint
+    unsigned int intervalMs;            ///< Current interval between background checkpoints
+    unsigned int sessionTimeRemainingSec;   ///< From the last @ref GfnGetSessionInfo, 0 if unknown
+    unsigned int numFlushes;
+    uint64_t lastFlushMs;               ///< Latency of the last flush, including waiting for a running checkpoint
+    uint64_t maxFlushMs;
+    uint64_t lastFlushBytes;            ///< State data written by the last flush
+    GfnRuntimeError lastFlushResult;
+} GfnSavePipelineStats;
+
+///
+/// @par Description
+/// Sets up the save pipeline, without regions.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call once at application start, after @ref GfnInitializeSdk.
+///
+/// @param pConfig                    - Configuration
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - pConfig or its log path is NULL, or the pipeline is already set up
+/// @retval gfnUnableToAllocateMemory - The pipeline could not be set up
+GfnRuntimeError GfnSavePipelineInitialize(const GfnSavePipelineConfig* pConfig);
+
+///
+/// @par Description
+/// Writes the changes made since the last checkpoint, stops the background thread and releases
+/// the pipeline.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call after @ref GfnShutdownSdk, so that the callbacks can no longer arrive. Must not be
+/// called from the state lock callback.
+void GfnSavePipelineShutdown(void);
+
+///
+/// @par Description
+/// Adds a region of application state.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call before @ref GfnSavePipelineLoad and @ref GfnSavePipelineStart, in the same order at every launch.
+///
+/// @param pDesc                      - The region
+/// @param pId                        - Optional, receives the id of the region
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnSavePipelineInitialize was not called
+/// @retval gfnInvalidParameter       - pDesc or its data is NULL, its size is 0, or the pipeline is started
+/// @retval gfnUnableToAllocateMemory - The region could not be stored
+GfnRuntimeError GfnSaveAddRegion(const GfnSaveRegionDesc* pDesc, GfnSaveRegionId* pId);
+
+///
+/// @par Description
+/// Restores the regions from the checkpoints in the log.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call after adding the regions and before @ref GfnSavePipelineStart.
+///
+/// @retval gfnSuccess                - At least one checkpoint was restored
+/// @retval gfnAPINotInit             - @ref GfnSavePipelineInitialize was not called
+/// @retval gfnInvalidParameter       - The pipeline is started
+/// @retval gfnNoData                 - There is no log, or no complete checkpoint in it
+/// @retval gfnUnableToAllocateMemory - The log could not be read into memory
+GfnRuntimeError GfnSavePipelineLoad(void);
+
+///
+/// @par Description
+/// Writes the current state as the first checkpoint of a new log, starts the background thread
+/// and, unless @ref GfnSavePipelineConfig::manualCallbacks is set, registers the save and exit
+/// callbacks.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnSavePipelineInitialize was not called
+/// @retval gfnInvalidParameter       - The pipeline is already started
+/// @retval gfnUnableToAllocateMemory - The background thread could not be started
+/// @retval gfnInternalError          - The log could not be written
+/// @return Otherwise, the error returned by @ref GfnRegisterSaveCallback or @ref GfnRegisterExitCallback.
+///         Background checkpoints keep running.
+GfnRuntimeError GfnSavePipelineStart(void);
+
+///
+/// @par Description
+/// Reports a change to a region.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call after changing the region, under the state lock, see @ref save_pipeline_consistency.
+///
+/// @param id                         - The region
+/// @param offset                     - Offset of the change in the region
+/// @param size                       - Size of the change
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnSavePipelineInitialize was not called
+/// @retval gfnInvalidParameter       - The region is unknown or the change is outside of it
+GfnRuntimeError GfnSaveMarkDirty(GfnSaveRegionId id, size_t offset, size_t size);
+
+///
+/// @par Description
+/// Asks the background thread to write a checkpoint now, without waiting for it.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call at natural save points, such as the end of a level.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - The pipeline is not started
+GfnRuntimeError GfnSavePipelineRequestCheckpoint(void);
+
+///
+/// @par Description
+/// Writes the changes made since the last checkpoint and waits until they are on disk. If a
+/// background checkpoint is being written, waits for it first.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Called by the save and exit callbacks of the pipeline. Call it directly if
+/// @ref GfnSavePipelineConfig::manualCallbacks is set. Must not be called from the state lock callback.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - The pipeline is not started
+/// @retval gfnUnableToAllocateMemory - The changes could not be copied
+/// @retval gfnInternalError          - The log could not be written
+GfnRuntimeError GfnSavePipelineFlush(void);
+
+///
+/// @par Description
+/// Retrieves the counters and timing of the save pipeline.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pStats                     - Receives the statistics
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnSavePipelineInitialize was not called
+/// @retval gfnInvalidParameter       - pStats is NULL
+GfnRuntimeError GfnSavePipelineGetStats(GfnSavePipelineStats* pStats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_SAVE_PIPELINE_H__
@@ -0,0 +1,637 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_StreamControl.h"
+#include "GfnSdk_StreamTimeline.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum gfnStreamOpType
+{
+    gfnStreamOpStart,
+    gfnStreamOpStop
+} gfnStreamOpType;
+
+typedef struct gfnStreamWaiter
+{
+    GfnStartStreamHandle handle;        // 0 for stops
+    StartStreamCallbackSig startCb;
+    StopStreamCallbackSig stopCb;
+    void* context;
+    struct gfnStreamWaiter* pNext;
+} gfnStreamWaiter;
+
+typedef struct gfnStreamOp
+{
+    gfnStreamOpType type;
+    StartStreamInput input;             // Owns copies of the partner data strings
+    unsigned int timeoutMs;
+    gfnStreamWaiter* pWaiters;          // Empty for a start whose callers all canceled
+    bool completed;
+    bool orphaned;                      // Given up on at shutdown, freed by the SDK callback
+    GfnRuntimeError result;
+    StartStreamResponse response;
+    struct gfnStreamOp* pNext;
+} gfnStreamOp;
+
+typedef struct gfnStreamControl
+{
+    bool initialized;
+    bool stopping;
+    uint64_t shutdownDeadlineMs;        // Until when shutdown waits for the request issued to the SDK
+    // The lock and condition variable are created on first initialization and never destroyed,
+    // so that the SDK can still complete a request that shutdown gave up on
+    bool syncReady;
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+    GfnSdkThread thread;
+
+    gfnStreamOp* pHead;                 // Requests not issued yet, in order
+    gfnStreamOp* pTail;
+    gfnStreamOp* pInFlight;             // Request issued to the SDK, at most one
+    gfnStreamWaiter* pCanceled;         // Canceled callers whose callback is still due
+    GfnStartStreamHandle lastHandle;
+    GfnStreamControlStats stats;
+} gfnStreamControl;
+
+static gfnStreamControl s_gfnStreamControl;
+
+static char* gfnStreamControlCopyString(const char* pchString, bool* pOk)
+{
+    size_t length = 0;
+    char* pchCopy = NULL;
+
+    if (pchString == NULL)
+    {
+        return NULL;
+    }
+    length = strlen(pchString) + 1;
+    pchCopy = (char*)malloc(length);
+    if (pchCopy == NULL)
+    {
+        *pOk = false;
+        return NULL;
+    }
+    memcpy(pchCopy, pchString, length);
+    return pchCopy;
+}
+
+static bool gfnStreamControlStringEqual(const char* pchA, const char* pchB)
+{
+    if (pchA == NULL || pchB == NULL)
+    {
+        return pchA == pchB;
+    }
+    return strcmp(pchA, pchB) == 0;
+}
+
+static void gfnStreamControlFreeOp(gfnStreamOp* pOp)
+{
+    free((void*)pOp->input.pchPartnerData);
+    free((void*)pOp->input.pchPartnerSecureData);
+    free(pOp);
+}
+
+static gfnStreamOp* gfnStreamControlNewOp(gfnStreamOpType type, const StartStreamInput* startStreamInput, unsigned int timeoutMs)
+{
+    gfnStreamOp* pOp = (gfnStreamOp*)calloc(1, sizeof(gfnStreamOp));
+    bool ok = true;
+
+    if (pOp == NULL)
+    {
+        return NULL;
+    }
+    pOp->type = type;
+    pOp->timeoutMs = timeoutMs;
+    if (startStreamInput != NULL)
+    {
+        pOp->input.uiTitleId = startStreamInput->uiTitleId;
+        pOp->input.pchPartnerData = gfnStreamControlCopyString(startStreamInput->pchPartnerData, &ok);
+        pOp->input.pchPartnerSecureData = gfnStreamControlCopyString(startStreamInput->pchPartnerSecureData, &ok);
+    }
+    if (!ok)
+    {
+        gfnStreamControlFreeOp(pOp);
+        return NULL;
+    }
+    return pOp;
+}
+
+static void gfnStreamControlAppendWaiter(gfnStreamWaiter** ppList, gfnStreamWaiter* pWaiter)
+{
+    while (*ppList != NULL)
+    {
+        ppList = &(*ppList)->pNext;
+    }
+    *ppList = pWaiter;
+}
+
+static void gfnStreamControlEnqueue(gfnStreamOp* pOp, bool front)
+{
+    if (s_gfnStreamControl.pHead == NULL)
+    {
+        s_gfnStreamControl.pHead = pOp;
+        s_gfnStreamControl.pTail = pOp;
+    }
+    else if (front)
+    {
+        pOp->pNext = s_gfnStreamControl.pHead;
+        s_gfnStreamControl.pHead = pOp;
+    }
+    else
+    {
+        s_gfnStreamControl.pTail->pNext = pOp;
+        s_gfnStreamControl.pTail = pOp;
+    }
+}
+
+static void gfnStreamControlComplete(gfnStreamWaiter* pWaiter, GfnRuntimeError result, StartStreamResponse* pResponse)
+{
+    gfnStreamWaiter* pNext = NULL;
+    StartStreamResponse response;
+
+    for (; pWaiter != NULL; pWaiter = pNext)
+    {
+        pNext = pWaiter->pNext;
+        if (pWaiter->startCb != NULL)
+        {
+            // Each caller gets its own copy, callbacks may modify it
+            memset(&response, 0, sizeof(response));
+            if (pResponse != NULL)
+            {
+                response = *pResponse;
+            }
+            pWaiter->startCb(result, &response, pWaiter->context);
+        }
+        else if (pWaiter->stopCb != NULL)
+        {
+            pWaiter->stopCb(result, pWaiter->context);
+        }
+        free(pWaiter);
+    }
+}
+
+static void GFN_CALLBACK gfnStreamControlStartDone(GfnRuntimeError result, StartStreamResponse* response, void* context)
+{
+    gfnStreamOp* pOp = (gfnStreamOp*)context;
+
+    gfnSdkMutexLock(&s_gfnStreamControl.lock);
+    if (pOp->orphaned)
+    {
+        gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+        gfnStreamControlFreeOp(pOp);
+        return;
+    }
+    pOp->result = result;
+    if (response != NULL)
+    {
+        pOp->response = *response;
+    }
+    pOp->completed = true;
+    gfnSdkCondSignal(&s_gfnStreamControl.cond);
+    gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+}
+
+static void GFN_CALLBACK gfnStreamControlStopDone(GfnRuntimeError result, void* context)
+{
+    gfnStreamControlStartDone(result, NULL, context);
+}
+
+static GfnRuntimeError gfnStreamControlIssue(gfnStreamOp* pOp)
+{
+    GfnRuntimeError result = gfnSuccess;
+
+    if (pOp->type == gfnStreamOpStop)
+    {
+        return GfnStopStreamAsync(gfnStreamControlStopDone, pOp, pOp->timeoutMs);
+    }
+    result = GfnStartStreamAsyncTracked(&pOp->input, gfnStreamControlStartDone, pOp, pOp->timeoutMs);
+    if (result == gfnAPINotInit)
+    {
+        // The stream timeline is optional
+        result = GfnStartStreamAsync(&pOp->input, gfnStreamControlStartDone, pOp, pOp->timeoutMs);
+    }
+    return result;
+}
+
+static void gfnStreamControlThread(void* pContext)
+{
+    gfnStreamOp* pOp = NULL;
+    gfnStreamOp* pAbandon = NULL;
+    gfnStreamWaiter* pWaiters = NULL;
+    GfnRuntimeError result = gfnSuccess;
+    uint64_t nowMs = 0;
+
+    (void)pContext;
+    gfnSdkMutexLock(&s_gfnStreamControl.lock);
+    for (;;)
+    {
+        if (s_gfnStreamControl.pCanceled != NULL)
+        {
+            pWaiters = s_gfnStreamControl.pCanceled;
+            s_gfnStreamControl.pCanceled = NULL;
+            gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+            gfnStreamControlComplete(pWaiters, gfnCanceled, NULL);
+            gfnSdkMutexLock(&s_gfnStreamControl.lock);
+            continue;
+        }
+
+        if (s_gfnStreamControl.pInFlight != NULL)
+        {
+            pOp = s_gfnStreamControl.pInFlight;
+            if (!pOp->completed)
+            {
+                if (!s_gfnStreamControl.stopping)
+                {
+                    gfnSdkCondWait(&s_gfnStreamControl.cond, &s_gfnStreamControl.lock);
+                    continue;
+                }
+                nowMs = gfnSdkGetTimeMs();
+                if (nowMs < s_gfnStreamControl.shutdownDeadlineMs)
+                {
+                    gfnSdkCondTimedWait(&s_gfnStreamControl.cond, &s_gfnStreamControl.lock,
+                        (uint32_t)(s_gfnStreamControl.shutdownDeadlineMs - nowMs));
+                    continue;
+                }
+                // The SDK did not complete the request in time for shutdown. Its callers are
+                // canceled, and the SDK callback frees it whenever it comes.
+                pOp->orphaned = true;
+                gfnStreamControlAppendWaiter(&s_gfnStreamControl.pCanceled, pOp->pWaiters);
+                pOp->pWaiters = NULL;
+                s_gfnStreamControl.pInFlight = NULL;
+                continue;
+            }
+            s_gfnStreamControl.pInFlight = NULL;
+            if (pOp->type == gfnStreamOpStart && pOp->pWaiters == NULL && GFNSDK_SUCCEEDED(pOp->result)
+                && !s_gfnStreamControl.stopping)
+            {
+                // Every caller backed out while the start was in progress, so end the stream
+                // before anything else runs
+                pAbandon = gfnStreamControlNewOp(gfnStreamOpStop, NULL, pOp->timeoutMs);
+                if (pAbandon != NULL)
+                {
+                    gfnStreamControlEnqueue(pAbandon, true);
+                    s_gfnStreamControl.stats.streamsAbandoned++;
+                }
+            }
+            pWaiters = pOp->pWaiters;
+            pOp->pWaiters = NULL;
+            gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+            gfnStreamControlComplete(pWaiters, pOp->result, pOp->type == gfnStreamOpStart ? &pOp->response : NULL);
+            gfnStreamControlFreeOp(pOp);
+            gfnSdkMutexLock(&s_gfnStreamControl.lock);
+            continue;
+        }
+
+        if (s_gfnStreamControl.stopping)
+        {
+            break;
+        }
+        if (s_gfnStreamControl.pHead == NULL)
+        {
+            gfnSdkCondWait(&s_gfnStreamControl.cond, &s_gfnStreamControl.lock);
+            continue;
+        }
+
+        pOp = s_gfnStreamControl.pHead;
+        s_gfnStreamControl.pHead = pOp->pNext;
+        if (s_gfnStreamControl.pHead == NULL)
+        {
+            s_gfnStreamControl.pTail = NULL;
+        }
+        pOp->pNext = NULL;
+        if (pOp->type == gfnStreamOpStart && pOp->pWaiters == NULL)
+        {
+            // Canceled before it was issued
+            gfnStreamControlFreeOp(pOp);
+            continue;
+        }
+
+        if (pOp->type == gfnStreamOpStart)
+        {
+            s_gfnStreamControl.stats.startsIssued++;
+        }
+        else
+        {
+            s_gfnStreamControl.stats.stopsIssued++;
+        }
+        s_gfnStreamControl.pInFlight = pOp;
+        gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+        result = gfnStreamControlIssue(pOp);
+        gfnSdkMutexLock(&s_gfnStreamControl.lock);
+        if (GFNSDK_FAILED(result))
+        {
+            // The SDK only invokes the callback for requests it accepted
+            pOp->result = result;
+            pOp->completed = true;
+        }
+    }
+
+    // Shutting down: everything that was not issued is canceled
+    while (s_gfnStreamControl.pHead != NULL)
+    {
+        pOp = s_gfnStreamControl.pHead;
+        s_gfnStreamControl.pHead = pOp->pNext;
+        gfnStreamControlAppendWaiter(&s_gfnStreamControl.pCanceled, pOp->pWaiters);
+        gfnStreamControlFreeOp(pOp);
+    }
+    s_gfnStreamControl.pTail = NULL;
+    pWaiters = s_gfnStreamControl.pCanceled;
+    s_gfnStreamControl.pCanceled = NULL;
+    gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+    gfnStreamControlComplete(pWaiters, gfnCanceled, NULL);
+}
+
+// Creates the lock and condition variable on first use; they live for the rest of the process
+static bool gfnStreamControlInitSync(void)
+{
+    if (s_gfnStreamControl.syncReady)
+    {
+        return true;
+    }
+    if (!gfnSdkMutexInit(&s_gfnStreamControl.lock))
+    {
+        return false;
+    }
+    if (!gfnSdkCondInit(&s_gfnStreamControl.cond))
+    {
+        gfnSdkMutexDestroy(&s_gfnStreamControl.lock);
+        return false;
+    }
+    s_gfnStreamControl.syncReady = true;
+    return true;
+}
+
+GfnRuntimeError GfnStreamControlInitialize(void)
+{
+    if (s_gfnStreamControl.initialized)
+    {
+        return gfnInvalidParameter;
+    }
+    if (!gfnStreamControlInitSync())
+    {
+        return gfnUnableToAllocateMemory;
+    }
+
+    // Handles keep counting, so a handle from before a shutdown cannot cancel a new start
+    s_gfnStreamControl.stopping = false;
+    s_gfnStreamControl.pHead = NULL;
+    s_gfnStreamControl.pTail = NULL;
+    s_gfnStreamControl.pInFlight = NULL;
+    s_gfnStreamControl.pCanceled = NULL;
+    memset(&s_gfnStreamControl.stats, 0, sizeof(s_gfnStreamControl.stats));
+    if (!gfnSdkThreadCreate(&s_gfnStreamControl.thread, gfnStreamControlThread, NULL))
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnStreamControl.initialized = true;
+    return gfnSuccess;
+}
+
+void GfnStreamControlShutdown(void)
+{
+    if (!s_gfnStreamControl.initialized)
+    {
+        return;
+    }
+
+    gfnSdkMutexLock(&s_gfnStreamControl.lock);
+    s_gfnStreamControl.stopping = true;
+    s_gfnStreamControl.shutdownDeadlineMs = gfnSdkGetTimeMs() + GFN_STREAM_CONTROL_SHUTDOWN_WAIT_MS;
+    gfnSdkCondSignal(&s_gfnStreamControl.cond);
+    gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+    gfnSdkThreadJoin(s_gfnStreamControl.thread);
+
+    s_gfnStreamControl.initialized = false;
+}
+
+GfnRuntimeError GfnStartStreamCancellable(const StartStreamInput* startStreamInput, StartStreamCallbackSig cb, void* context,
+    unsigned int timeoutMs, GfnStartStreamHandle* pHandle)
+{
+    gfnStreamWaiter* pWaiter = NULL;
+    gfnStreamOp* pOp = NULL;
+    gfnStreamOp* pLast = NULL;
+    gfnStreamOp* pScan = NULL;
+    bool afterStop = false;
+
+    if (!s_gfnStreamControl.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (startStreamInput == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    // Allocate outside of the lock, the common case is a new start
+    pWaiter = (gfnStreamWaiter*)calloc(1, sizeof(gfnStreamWaiter));
+    pOp = gfnStreamControlNewOp(gfnStreamOpStart, startStreamInput, timeoutMs);
+    if (pWaiter == NULL || pOp == NULL)
+    {
+        free(pWaiter);
+        if (pOp != NULL)
+        {
+            gfnStreamControlFreeOp(pOp);
+        }
+        return gfnUnableToAllocateMemory;
+    }
+    pWaiter->startCb = cb;
+    pWaiter->context = context;
+
+    gfnSdkMutexLock(&s_gfnStreamControl.lock);
+    pWaiter->handle = ++s_gfnStreamControl.lastHandle;
+    s_gfnStreamControl.stats.startsRequested++;
+
+    // Only the most recent request can be joined; joining an earlier start would hand the
+    // caller a stream that a later stop ends
+    pLast = s_gfnStreamControl.pTail != NULL ? s_gfnStreamControl.pTail : s_gfnStreamControl.pInFlight;
+    if (pLast != NULL && pLast->type == gfnStreamOpStart && !pLast->completed
+        && pLast->input.uiTitleId == pOp->input.uiTitleId
+        && gfnStreamControlStringEqual(pLast->input.pchPartnerData, pOp->input.pchPartnerData)
+        && gfnStreamControlStringEqual(pLast->input.pchPartnerSecureData, pOp->input.pchPartnerSecureData))
+    {
+        gfnStreamControlAppendWaiter(&pLast->pWaiters, pWaiter);
+        s_gfnStreamControl.stats.startsCoalesced++;
+        gfnStreamControlFreeOp(pOp);
+    }
+    else
+    {
+        afterStop = s_gfnStreamControl.pInFlight != NULL && s_gfnStreamControl.pInFlight->type == gfnStreamOpStop;
+        for (pScan = s_gfnStreamControl.pHead; pScan != NULL && !afterStop; pScan = pScan->pNext)
+        {
+            afterStop = pScan->type == gfnStreamOpStop;
+        }
+        if (afterStop)
+        {
+            s_gfnStreamControl.stats.startsSequenced++;
+        }
+        pOp->pWaiters = pWaiter;
+        gfnStreamControlEnqueue(pOp, false);
+        gfnSdkCondSignal(&s_gfnStreamControl.cond);
+    }
+    if (pHandle != NULL)
+    {
+        *pHandle = pWaiter->handle;
+    }
+    gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+    return gfnSuccess;
+}
+
+// Detaches the caller with the handle from op, and queues its callback with gfnCanceled
+static bool gfnStreamControlCancelIn(gfnStreamOp* pOp, GfnStartStreamHandle handle)
+{
+    gfnStreamWaiter** ppWaiter = NULL;
+    gfnStreamWaiter* pWaiter = NULL;
+
+    if (pOp == NULL || pOp->type != gfnStreamOpStart || pOp->completed)
+    {
+        return false;
+    }
+    for (ppWaiter = &pOp->pWaiters; *ppWaiter != NULL; ppWaiter = &(*ppWaiter)->pNext)
+    {
+        if ((*ppWaiter)->handle == handle)
+        {
+            pWaiter = *ppWaiter;
+            *ppWaiter = pWaiter->pNext;
+            pWaiter->pNext = NULL;
+            gfnStreamControlAppendWaiter(&s_gfnStreamControl.pCanceled, pWaiter);
+            s_gfnStreamControl.stats.startsCanceled++;
+            return true;
+        }
+    }
+    return false;
+}
+
+GfnRuntimeError GfnCancelStartStream(GfnStartStreamHandle handle)
+{
+    gfnStreamOp* pOp = NULL;
+    bool found = false;
+
+    if (!s_gfnStreamControl.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (handle == 0)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&s_gfnStreamControl.lock);
+    found = gfnStreamControlCancelIn(s_gfnStreamControl.pInFlight, handle);
+    for (pOp = s_gfnStreamControl.pHead; pOp != NULL && !found; pOp = pOp->pNext)
+    {
+        found = gfnStreamControlCancelIn(pOp, handle);
+    }
+    if (found)
+    {
+        gfnSdkCondSignal(&s_gfnStreamControl.cond);
+    }
+    gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+    return found ? gfnSuccess : gfnInvalidParameter;
+}
+
+GfnRuntimeError GfnStopStreamSequenced(StopStreamCallbackSig cb, void* context, unsigned int timeoutMs)
+{
+    gfnStreamWaiter* pWaiter = NULL;
+    gfnStreamOp* pOp = NULL;
+    gfnStreamOp** ppScan = NULL;
+    gfnStreamOp* pNext = NULL;
+    gfnStreamOp* pQueuedStop = NULL;
+    gfnStreamWaiter* pScanWaiter = NULL;
+
+    if (!s_gfnStreamControl.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    pWaiter = (gfnStreamWaiter*)calloc(1, sizeof(gfnStreamWaiter));
+    pOp = gfnStreamControlNewOp(gfnStreamOpStop, NULL, timeoutMs);
+    if (pWaiter == NULL || pOp == NULL)
+    {
+        free(pWaiter);
+        free(pOp);
+        return gfnUnableToAllocateMemory;
+    }
+    pWaiter->stopCb = cb;
+    pWaiter->context = context;
+
+    gfnSdkMutexLock(&s_gfnStreamControl.lock);
+    // Starts that have not been issued would only be stopped again, so cancel them
+    s_gfnStreamControl.pTail = NULL;
+    for (ppScan = &s_gfnStreamControl.pHead; *ppScan != NULL;)
+    {
+        if ((*ppScan)->type == gfnStreamOpStart)
+        {
+            for (pScanWaiter = (*ppScan)->pWaiters; pScanWaiter != NULL; pScanWaiter = pScanWaiter->pNext)
+            {
+                s_gfnStreamControl.stats.startsCanceled++;
+            }
+            gfnStreamControlAppendWaiter(&s_gfnStreamControl.pCanceled, (*ppScan)->pWaiters);
+            pNext = (*ppScan)->pNext;
+            gfnStreamControlFreeOp(*ppScan);
+            *ppScan = pNext;
+        }
+        else
+        {
+            pQueuedStop = *ppScan;
+            s_gfnStreamControl.pTail = *ppScan;
+            ppScan = &(*ppScan)->pNext;
+        }
+    }
+    if (pQueuedStop != NULL)
+    {
+        gfnStreamControlAppendWaiter(&pQueuedStop->pWaiters, pWaiter);
+        free(pOp);
+    }
+    else
+    {
+        pOp->pWaiters = pWaiter;
+        gfnStreamControlEnqueue(pOp, false);
+    }
+    gfnSdkCondSignal(&s_gfnStreamControl.cond);
+    gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnStreamControlGetStats(GfnStreamControlStats* pStats)
+{
+    if (pStats == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    if (!s_gfnStreamControl.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    gfnSdkMutexLock(&s_gfnStreamControl.lock);
+    *pStats = s_gfnStreamControl.stats;
+    gfnSdkMutexUnlock(&s_gfnStreamControl.lock);
+    return gfnSuccess;
+}
@@ -0,0 +1,220 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Cancellable, coalescing and sequenced stream start and stop requests
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_StreamControl.h
+*
+* Optional request layer over @ref GfnStartStreamAsync and @ref GfnStopStreamAsync
+*/
+///
+/// @page stream_control Stream Control
+///
+/// @section stream_control_introduction Introduction
+/// @ref GfnStartStreamAsync can only be bounded by a timeout: a launcher cannot take back a
+/// start when the user backs out, double clicks start the same stream twice, and a start
+/// made while a stop is still in progress races with it. The functions in this header put a
+/// request layer in front of the asynchronous start and stop calls:
+///
+/// - Every start returns a @ref GfnStartStreamHandle, which @ref GfnCancelStartStream cancels.
+/// - A start for the same title with the same partner data as a start that is queued or in
+///   progress joins that start instead of issuing another one. Each caller gets its own handle
+///   and its own callback.
+/// - Starts and stops are issued to the SDK one at a time, in the order they were requested,
+///   by a helper thread. A start requested while a stop is in progress is issued once the stop
+///   completes, and starts still queued when a stop is requested are canceled, as the stop would
+///   end them right away.
+///
+/// The SDK cannot abort a start once it has been issued. Canceling a handle therefore completes
+/// its callback with gfnCanceled right away. If every caller of an issued start canceled, and the
+/// start then succeeds, the stream nobody is waiting for is stopped again.
+///
+/// No function in this header blocks on the SDK, so they can be called from a UI thread. All
+/// callbacks are invoked on the helper thread, without any internal lock held. Starts are made with
+/// @ref GfnStartStreamAsyncTracked while the stream timeline (@ref stream_timeline) is initialized.
+///
+
+#ifndef __NV_GFNSDK_STREAM_CONTROL_H__
+#define __NV_GFNSDK_STREAM_CONTROL_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Maximum time @ref GfnStreamControlShutdown waits for a start or stop already issued to the SDK
+#define GFN_STREAM_CONTROL_SHUTDOWN_WAIT_MS 2000
+
+/// @brief Identifies a start requested with @ref GfnStartStreamCancellable. Never 0.
+typedef uint64_t GfnStartStreamHandle;
+
+/// @brief Counters returned by @ref GfnStreamControlGetStats
+typedef struct GfnStreamControlStats
+{
+    unsigned int startsRequested;       ///< Calls to @ref GfnStartStreamCancellable that were accepted
+    unsigned int startsIssued;          ///< Starts issued to the SDK
+    unsigned int startsCoalesced;       ///< Requests that joined a start that was queued or in progress
+    unsigned int startsCanceled;        ///< Handles completed with gfnCanceled, by the caller or by a later stop
+    unsigned int startsSequenced;       ///< Starts that had to wait for a stop to complete
+    unsigned int stopsIssued;           ///< Stops issued to the SDK, including those for abandoned streams
+    unsigned int streamsAbandoned;      ///< Streams stopped because every caller canceled their start
+} GfnStreamControlStats;
+
+///
+/// @par Description
+/// Starts the stream control helper thread.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Call once after @ref GfnInitializeSdk
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - Stream control is already running
+/// @retval gfnUnableToAllocateMemory - The helper thread could not be created
+GfnRuntimeError GfnStreamControlInitialize(void);
+
+///
+/// @par Description
+/// Stops the stream control helper thread. Requests that were not issued yet are completed with
+/// gfnCanceled, and a start or stop that was already issued is waited for, before this function
+/// returns. The wait is bounded by @ref GFN_STREAM_CONTROL_SHUTDOWN_WAIT_MS, so a start that can
+/// take minutes does not hold up the caller: if the SDK has not completed the request by then,
+/// its callers are completed with gfnCanceled, and its later completion is ignored.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Call before @ref GfnShutdownSdk. Must not be called from a stream control callback.
+void GfnStreamControlShutdown(void);
+
+///
+/// @par Description
+/// Requests a stream start of an application, see @ref stream_control.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Use instead of @ref GfnStartStreamAsync when the start must be cancellable.
+///
+/// @param startStreamInput           - Pointer to a StartStreamInput structure. Copied before this function returns.
+/// @param cb                         - Optional, called once the start completes or is canceled
+/// @param context                    - User context passed unmodified to cb
+/// @param timeoutMs                  - Time after which attempt to start streaming will be aborted, once issued
+/// @param pHandle                    - Optional, receives the handle that cancels this request
+///
+/// @retval gfnSuccess                - The start was queued, or joined a queued or running start
+/// @retval gfnAPINotInit             - @ref GfnStreamControlInitialize was not called
+/// @retval gfnInvalidParameter       - startStreamInput is NULL. The callback is not called.
+/// @retval gfnUnableToAllocateMemory - The request could not be queued. The callback is not called.
+GfnRuntimeError GfnStartStreamCancellable(const StartStreamInput* startStreamInput, StartStreamCallbackSig cb, void* context,
+    unsigned int timeoutMs, GfnStartStreamHandle* pHandle);
+
+///
+/// @par Description
+/// Cancels a start requested with @ref GfnStartStreamCancellable. Its callback is invoked with
+/// gfnCanceled shortly after, on the helper thread. Returns without waiting.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @param handle                    - The handle returned for the start
+///
+/// @retval gfnSuccess               - The request is canceled
+/// @retval gfnAPINotInit            - @ref GfnStreamControlInitialize was not called
+/// @retval gfnInvalidParameter      - Unknown handle, or the start has already completed or been canceled
+GfnRuntimeError GfnCancelStartStream(GfnStartStreamHandle handle);
+
+///
+/// @par Description
+/// Requests the stream to be stopped, after the starts and stops requested before it.
+/// Starts that are still queued are canceled. A stop requested while another stop is queued
+/// joins it.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Use instead of @ref GfnStopStreamAsync together with @ref GfnStartStreamCancellable.
+///
+/// @param cb                         - Optional, called once the stop completes
+/// @param context                    - User context passed unmodified to cb
+/// @param timeoutMs                  - Time after which attempt to stop streaming will be aborted, once issued
+///
+/// @retval gfnSuccess                - The stop was queued, or joined a queued stop
+/// @retval gfnAPINotInit             - @ref GfnStreamControlInitialize was not called
+/// @retval gfnUnableToAllocateMemory - The request could not be queued. The callback is not called.
+GfnRuntimeError GfnStopStreamSequenced(StopStreamCallbackSig cb, void* context, unsigned int timeoutMs);
+
+///
+/// @par Description
+/// Returns a snapshot of the stream control counters.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @param pStats                    - Receives the counters
+///
+/// @retval gfnSuccess               - On success
+/// @retval gfnInvalidParameter      - pStats is NULL
+/// @retval gfnAPINotInit            - @ref GfnStreamControlInitialize was not called
+GfnRuntimeError GfnStreamControlGetStats(GfnStreamControlStats* pStats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_STREAM_CONTROL_H__
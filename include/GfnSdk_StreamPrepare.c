@@ -0,0 +1,372 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_StreamPrepare.h"
+#include "GfnSdk_StreamTimeline.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct gfnPrepareWaiter
+{
+    GfnPrepareStreamCallbackSig callback;
+    void* pUserContext;
+    struct gfnPrepareWaiter* pNext;
+} gfnPrepareWaiter;
+
+typedef struct gfnStreamPrepare
+{
+    bool initialized;
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+    GfnSdkThread thread;
+    bool threadValid;           // thread has been created and not joined yet
+    bool canceled;
+
+    GfnPrepareStreamInput input;    // Latest request; a running preparation follows title changes
+    bool warmed;
+    unsigned int warmedTitleId;
+    GfnPrepareStreamWarmupSig warmedWith;
+
+    GfnPrepareStreamState state;
+    gfnPrepareWaiter* pWaiters;
+} gfnStreamPrepare;
+
+static gfnStreamPrepare s_gfnPrepare;
+
+static void gfnPrepareAppendWaiter(gfnPrepareWaiter* pWaiter)
+{
+    gfnPrepareWaiter** ppTail = &s_gfnPrepare.pWaiters;
+
+    while (*ppTail != NULL)
+    {
+        ppTail = &(*ppTail)->pNext;
+    }
+    *ppTail = pWaiter;
+}
+
+static bool gfnPrepareNeedsWarmup(void)
+{
+    return s_gfnPrepare.input.warmup != NULL
+        && (!s_gfnPrepare.warmed || s_gfnPrepare.warmedTitleId != s_gfnPrepare.input.uiTitleId
+            || s_gfnPrepare.warmedWith != s_gfnPrepare.input.warmup);
+}
+
+static void gfnPrepareThread(void* pContext)
+{
+    GfnRuntimeError result = gfnSuccess;
+    GfnPrepareStreamInput input;
+    GfnPrepareStreamState state;
+    gfnPrepareWaiter* pWaiter = NULL;
+    gfnPrepareWaiter* pNext = NULL;
+    uint64_t stepStartMs = 0;
+
+    (void)pContext;
+    gfnSdkMutexLock(&s_gfnPrepare.lock);
+
+    // Each step runs without the lock, so callers can join or cancel the preparation meanwhile
+    if (!s_gfnPrepare.canceled)
+    {
+        input = s_gfnPrepare.input;
+        gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+        stepStartMs = gfnSdkGetTimeMs();
+        // Returns right away if the client library is already initialized
+        result = GfnInitializeSdk(input.language);
+        gfnSdkMutexLock(&s_gfnPrepare.lock);
+        s_gfnPrepare.state.libraryMs = gfnSdkGetTimeMs() - stepStartMs;
+    }
+    if (GFNSDK_SUCCEEDED(result) && !s_gfnPrepare.canceled)
+    {
+        gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+        stepStartMs = gfnSdkGetTimeMs();
+        result = GfnStreamTimelineInitialize();
+        if (result == gfnInvalidParameter)
+        {
+            // Already initialized by the application or an earlier preparation
+            result = gfnSuccess;
+        }
+        gfnSdkMutexLock(&s_gfnPrepare.lock);
+        s_gfnPrepare.state.timelineMs = gfnSdkGetTimeMs() - stepStartMs;
+    }
+    while (GFNSDK_SUCCEEDED(result) && !s_gfnPrepare.canceled && gfnPrepareNeedsWarmup())
+    {
+        input = s_gfnPrepare.input;
+        gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+        stepStartMs = gfnSdkGetTimeMs();
+        result = input.warmup(input.uiTitleId, input.pWarmupContext);
+        gfnSdkMutexLock(&s_gfnPrepare.lock);
+        s_gfnPrepare.state.warmupMs += gfnSdkGetTimeMs() - stepStartMs;
+        if (GFNSDK_SUCCEEDED(result))
+        {
+            s_gfnPrepare.warmed = true;
+            s_gfnPrepare.warmedTitleId = input.uiTitleId;
+            s_gfnPrepare.warmedWith = input.warmup;
+        }
+    }
+
+    if (s_gfnPrepare.canceled || result == gfnCanceled)
+    {
+        result = gfnCanceled;
+        s_gfnPrepare.state.status = GfnPrepareStreamCanceled;
+    }
+    else
+    {
+        s_gfnPrepare.state.status = GFNSDK_SUCCEEDED(result) ? GfnPrepareStreamReady : GfnPrepareStreamFailed;
+    }
+    s_gfnPrepare.state.result = result;
+    s_gfnPrepare.state.uiTitleId = s_gfnPrepare.input.uiTitleId;
+    s_gfnPrepare.state.finishedMs = gfnSdkGetTimeMs();
+    state = s_gfnPrepare.state;
+    pWaiter = s_gfnPrepare.pWaiters;
+    s_gfnPrepare.pWaiters = NULL;
+    gfnSdkCondBroadcast(&s_gfnPrepare.cond);
+    gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+
+    for (; pWaiter != NULL; pWaiter = pNext)
+    {
+        pNext = pWaiter->pNext;
+        pWaiter->callback(result, &state, pWaiter->pUserContext);
+        free(pWaiter);
+    }
+}
+
+GfnRuntimeError GfnPrepareStreamInitialize(void)
+{
+    if (s_gfnPrepare.initialized)
+    {
+        return gfnInvalidParameter;
+    }
+
+    memset(&s_gfnPrepare, 0, sizeof(s_gfnPrepare));
+    if (!gfnSdkMutexInit(&s_gfnPrepare.lock))
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkCondInit(&s_gfnPrepare.cond))
+    {
+        gfnSdkMutexDestroy(&s_gfnPrepare.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnPrepare.initialized = true;
+    return gfnSuccess;
+}
+
+void GfnPrepareStreamShutdown(void)
+{
+    bool joinThread = false;
+
+    if (!s_gfnPrepare.initialized)
+    {
+        return;
+    }
+
+    gfnSdkMutexLock(&s_gfnPrepare.lock);
+    s_gfnPrepare.canceled = true;
+    joinThread = s_gfnPrepare.threadValid;
+    s_gfnPrepare.threadValid = false;
+    gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+    if (joinThread)
+    {
+        // The thread invokes the callbacks of its preparation before it exits
+        gfnSdkThreadJoin(s_gfnPrepare.thread);
+    }
+
+    s_gfnPrepare.initialized = false;
+    gfnSdkCondDestroy(&s_gfnPrepare.cond);
+    gfnSdkMutexDestroy(&s_gfnPrepare.lock);
+}
+
+GfnRuntimeError GfnPrepareStream(const GfnPrepareStreamInput* pInput, GfnPrepareStreamCallbackSig callback, void* pUserContext)
+{
+    gfnPrepareWaiter* pWaiter = NULL;
+    GfnPrepareStreamState state;
+    GfnSdkThread thread;
+
+    if (!s_gfnPrepare.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pInput == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    if (callback != NULL)
+    {
+        pWaiter = (gfnPrepareWaiter*)malloc(sizeof(gfnPrepareWaiter));
+        if (pWaiter == NULL)
+        {
+            return gfnUnableToAllocateMemory;
+        }
+        pWaiter->callback = callback;
+        pWaiter->pUserContext = pUserContext;
+        pWaiter->pNext = NULL;
+    }
+
+    gfnSdkMutexLock(&s_gfnPrepare.lock);
+    for (;;)
+    {
+        if (s_gfnPrepare.state.status == GfnPrepareStreamRunning)
+        {
+            // Join the running preparation. It picks up the new title before it finishes, and
+            // the new request revokes an earlier cancellation the thread has not acted on yet.
+            s_gfnPrepare.input = *pInput;
+            s_gfnPrepare.canceled = false;
+            if (pWaiter != NULL)
+            {
+                gfnPrepareAppendWaiter(pWaiter);
+            }
+            gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+            return gfnSuccess;
+        }
+        if (s_gfnPrepare.state.status == GfnPrepareStreamReady && s_gfnPrepare.state.uiTitleId == pInput->uiTitleId
+            && s_gfnPrepare.input.warmup == pInput->warmup)
+        {
+            state = s_gfnPrepare.state;
+            gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+            if (pWaiter != NULL)
+            {
+                pWaiter->callback(gfnSuccess, &state, pWaiter->pUserContext);
+                free(pWaiter);
+            }
+            return gfnSuccess;
+        }
+        if (!s_gfnPrepare.threadValid)
+        {
+            break;
+        }
+        // Reap the thread of the previous preparation, which may still be invoking its callbacks.
+        // Another caller may start a preparation meanwhile, so check again afterwards.
+        thread = s_gfnPrepare.thread;
+        s_gfnPrepare.threadValid = false;
+        gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+        gfnSdkThreadJoin(thread);
+        gfnSdkMutexLock(&s_gfnPrepare.lock);
+    }
+
+    s_gfnPrepare.input = *pInput;
+    s_gfnPrepare.canceled = false;
+    memset(&s_gfnPrepare.state, 0, sizeof(s_gfnPrepare.state));
+    s_gfnPrepare.state.status = GfnPrepareStreamRunning;
+    s_gfnPrepare.state.uiTitleId = pInput->uiTitleId;
+    s_gfnPrepare.state.startedMs = gfnSdkGetTimeMs();
+    if (!gfnSdkThreadCreate(&s_gfnPrepare.thread, gfnPrepareThread, NULL))
+    {
+        s_gfnPrepare.state.status = GfnPrepareStreamFailed;
+        s_gfnPrepare.state.result = gfnUnableToAllocateMemory;
+        s_gfnPrepare.state.finishedMs = s_gfnPrepare.state.startedMs;
+        gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+        free(pWaiter);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnPrepare.threadValid = true;
+    if (pWaiter != NULL)
+    {
+        gfnPrepareAppendWaiter(pWaiter);
+    }
+    gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnCancelPrepareStream(void)
+{
+    if (!s_gfnPrepare.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    gfnSdkMutexLock(&s_gfnPrepare.lock);
+    if (s_gfnPrepare.state.status == GfnPrepareStreamRunning)
+    {
+        s_gfnPrepare.canceled = true;
+    }
+    else if (s_gfnPrepare.state.status == GfnPrepareStreamReady)
+    {
+        s_gfnPrepare.state.status = GfnPrepareStreamNotStarted;
+    }
+    gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+    return gfnSuccess;
+}
+
+bool GfnPrepareStreamIsCanceled(void)
+{
+    bool canceled = false;
+
+    if (!s_gfnPrepare.initialized)
+    {
+        return false;
+    }
+    gfnSdkMutexLock(&s_gfnPrepare.lock);
+    canceled = s_gfnPrepare.canceled;
+    gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+    return canceled;
+}
+
+GfnRuntimeError GfnGetPrepareStreamState(GfnPrepareStreamState* pState)
+{
+    if (pState == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    if (!s_gfnPrepare.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    gfnSdkMutexLock(&s_gfnPrepare.lock);
+    *pState = s_gfnPrepare.state;
+    gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnPrepareStreamWait(unsigned int timeoutMs)
+{
+    GfnRuntimeError result = gfnSuccess;
+    uint64_t deadlineMs = 0;
+    uint64_t now = 0;
+
+    if (!s_gfnPrepare.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    deadlineMs = gfnSdkGetTimeMs() + timeoutMs;
+    gfnSdkMutexLock(&s_gfnPrepare.lock);
+    while (s_gfnPrepare.state.status == GfnPrepareStreamRunning)
+    {
+        now = gfnSdkGetTimeMs();
+        if (now >= deadlineMs)
+        {
+            result = gfnTimedOut;
+            break;
+        }
+        gfnSdkCondTimedWait(&s_gfnPrepare.cond, &s_gfnPrepare.lock, (uint32_t)(deadlineMs - now));
+    }
+    gfnSdkMutexUnlock(&s_gfnPrepare.lock);
+    return result;
+}
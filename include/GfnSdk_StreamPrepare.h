@@ -0,0 +1,262 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Stream pre-flight preparation ahead of GfnStartStream
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_StreamPrepare.h
+*
+* Optional pre-flight preparation for @ref GfnStartStream and @ref GfnStartStreamAsync
+*/
+///
+/// @page stream_prepare Stream Prepare
+///
+/// @section stream_prepare_introduction Introduction
+/// A launcher that only touches the SDK when the user clicks Play pays for all client-side
+/// setup inside the stream start. @ref GfnPrepareStream does the part of that work that does not
+/// need a session on a helper thread, as soon as the launcher knows which title the user is
+/// looking at, for example when its title page opens:
+///
+/// 1. Resolves and initializes the client library with @ref GfnInitializeSdk, unless the
+///    application already did.
+/// 2. Initializes the stream timeline (@ref stream_timeline), which registers the stream
+///    status callback with the client library.
+/// 3. Runs the application's own warm-up for the title, if it provides one, for example to
+///    fetch the launcher token passed as StartStreamInput::pchPartnerSecureData, or to open
+///    connections to the launcher's own services.
+///
+/// Downloading or validating the GeForce NOW client and running the network test happen inside
+/// the client during the stream start, and are not exposed by the SDK, so they cannot be done
+/// ahead of time. Their duration remains visible in the stream timeline.
+///
+/// Preparing is idempotent: a call for the title that is already prepared or being prepared
+/// shares that work, and a call for a different title while a preparation is running only adds
+/// the warm-up for the new title. A later @ref GfnStartStreamTracked or
+/// @ref GfnStartStreamAsyncTracked reuses the prepared state, and the time the preparation saved
+/// it is reported in @ref GfnStreamTimeline::prepareSavedMs.
+///
+/// The application must not call @ref GfnInitializeSdk or @ref GfnShutdownSdk while a
+/// preparation is running. Once the client library has been initialized by a preparation, the
+/// application shuts it down with @ref GfnShutdownSdk as usual.
+///
+
+#ifndef __NV_GFNSDK_STREAM_PREPARE_H__
+#define __NV_GFNSDK_STREAM_PREPARE_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief State of the stream preparation
+typedef enum GfnPrepareStreamStatus
+{
+    GfnPrepareStreamNotStarted = 0,     ///< Never prepared, or the prepared state was discarded
+    GfnPrepareStreamRunning,            ///< A preparation is running on the helper thread
+    GfnPrepareStreamReady,              ///< The stream is prepared
+    GfnPrepareStreamCanceled,           ///< The last preparation was canceled
+    GfnPrepareStreamFailed              ///< The last preparation failed
+} GfnPrepareStreamStatus;
+
+/// @brief Snapshot returned by @ref GfnGetPrepareStreamState. Times are from @ref gfnSdkGetTimeMs.
+typedef struct GfnPrepareStreamState
+{
+    GfnPrepareStreamStatus status;
+    GfnRuntimeError result;         ///< Result of the last preparation once it finished
+    unsigned int uiTitleId;         ///< Title the preparation is for
+    uint64_t startedMs;             ///< Time the preparation started
+    uint64_t finishedMs;            ///< Time the preparation finished, 0 while it is running
+    uint64_t libraryMs;             ///< Time spent initializing the client library
+    uint64_t timelineMs;            ///< Time spent initializing the stream timeline
+    uint64_t warmupMs;              ///< Time spent in the application's warm-up
+} GfnPrepareStreamState;
+
+///
+/// @brief Application warm-up run by the preparation helper thread
+///
+/// Long warm-ups should poll @ref GfnPrepareStreamIsCanceled and return gfnCanceled once it
+/// returns true.
+///
+/// @param uiTitleId    - Title being prepared
+/// @param pUserContext - Context from @ref GfnPrepareStreamInput::pWarmupContext
+///
+/// @return gfnSuccess, or an error that fails the preparation
+///
+typedef GfnRuntimeError (GFN_CALLBACK *GfnPrepareStreamWarmupSig)(unsigned int uiTitleId, void* pUserContext);
+
+///
+/// @brief Callback invoked once for every accepted @ref GfnPrepareStream call
+///
+/// @param status       - gfnSuccess if the stream is prepared, gfnCanceled if the preparation was
+///                       canceled, or the error that failed it
+/// @param pState       - State of the preparation, only valid for the duration of the callback
+/// @param pUserContext - Context passed to @ref GfnPrepareStream
+///
+typedef void (GFN_CALLBACK *GfnPrepareStreamCallbackSig)(GfnRuntimeError status, const GfnPrepareStreamState* pState, void* pUserContext);
+
+/// @brief Input to @ref GfnPrepareStream
+typedef struct GfnPrepareStreamInput
+{
+    GfnDisplayLanguage language;            ///< Passed to @ref GfnInitializeSdk if the client library is not initialized yet
+    unsigned int uiTitleId;                 ///< Title that is likely to be started, as in StartStreamInput::uiTitleId
+    GfnPrepareStreamWarmupSig warmup;       ///< Optional application warm-up for the title
+    void* pWarmupContext;                   ///< Passed unmodified to warmup
+} GfnPrepareStreamInput;
+
+///
+/// @par Description
+/// Sets up stream preparation. Does not initialize the client library.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Call once at application start, before or after @ref GfnInitializeSdk.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - Stream preparation is already set up
+/// @retval gfnUnableToAllocateMemory - The lock could not be created
+GfnRuntimeError GfnPrepareStreamInitialize(void);
+
+///
+/// @par Description
+/// Cancels a running preparation, waits for the helper thread to exit, and discards the
+/// prepared state. Callbacks of a canceled preparation are invoked before this function returns.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Call before @ref GfnShutdownSdk. Must not be called from a prepare or warm-up callback.
+void GfnPrepareStreamShutdown(void);
+
+///
+/// @par Description
+/// Prepares a stream start for a title on a helper thread, see @ref stream_prepare.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Call as soon as the title the user is likely to start is known. Returns without waiting.
+/// Must not be called from a prepare or warm-up callback.
+///
+/// @param pInput                     - The title to prepare for, and the optional warm-up
+/// @param callback                   - Optional, called once the preparation finishes. If the title is
+///                                     already prepared, it is called before this function returns.
+/// @param pUserContext               - Pointer to user context passed unmodified to callback. Can be NULL.
+///
+/// @retval gfnSuccess                - The preparation was started, joined, or is already done
+/// @retval gfnAPINotInit             - @ref GfnPrepareStreamInitialize was not called
+/// @retval gfnInvalidParameter       - pInput is NULL
+/// @retval gfnUnableToAllocateMemory - The helper thread could not be started. The callback is not called.
+GfnRuntimeError GfnPrepareStream(const GfnPrepareStreamInput* pInput, GfnPrepareStreamCallbackSig callback, void* pUserContext);
+
+///
+/// @par Description
+/// Cancels a running preparation after its current step, or discards a prepared state so the
+/// next start is not credited with it. Returns without waiting.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @retval gfnSuccess                - On success, also if there was nothing to cancel
+/// @retval gfnAPINotInit             - @ref GfnPrepareStreamInitialize was not called
+GfnRuntimeError GfnCancelPrepareStream(void);
+
+///
+/// @par Description
+/// Returns true from within a warm-up while its preparation is being canceled.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+bool GfnPrepareStreamIsCanceled(void);
+
+///
+/// @par Description
+/// Retrieves the state of the current or last preparation.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @param pState                    - Receives the state
+///
+/// @retval gfnSuccess               - On success
+/// @retval gfnInvalidParameter      - pState is NULL
+/// @retval gfnAPINotInit            - @ref GfnPrepareStreamInitialize was not called
+GfnRuntimeError GfnGetPrepareStreamState(GfnPrepareStreamState* pState);
+
+///
+/// @par Description
+/// Waits for a running preparation to finish.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Must not be called from a prepare or warm-up callback.
+///
+/// @param timeoutMs                 - Maximum time to wait
+///
+/// @retval gfnSuccess               - No preparation is running
+/// @retval gfnTimedOut              - The preparation is still running
+/// @retval gfnAPINotInit            - @ref GfnPrepareStreamInitialize was not called
+GfnRuntimeError GfnPrepareStreamWait(unsigned int timeoutMs);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_STREAM_PREPARE_H__
@@ -0,0 +1,631 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_StreamTimeline.h"
+#include "GfnSdk_StreamPrepare.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct gfnStreamSession
+{
+    GfnStreamTimeline timeline;
+    uint64_t startMs;
+    GfnStreamStatus phase;      // Last reported status other than an input focus change
+    uint64_t phaseStartMs;
+} gfnStreamSession;
+
+typedef struct gfnStreamAsyncContext
+{
+    uint64_t sessionId;
+    StartStreamCallbackSig cb;
+    void* context;
+} gfnStreamAsyncContext;
+
+// Interval at which a tracked start checks whether a running preparation initialized the timeline
+#define GFN_STREAM_TIMELINE_PREPARE_POLL_MS 10
+
+typedef struct gfnStreamTimelineState
+{
+    bool initialized;
+    // The lock and condition variable are created on first initialization and never destroyed,
+    // so that status updates arriving on SDK threads after shutdown can still take the lock
+    bool syncReady;
+    GfnSdkMutex lock;
+    GfnSdkCondVar idleCond;
+    unsigned int dispatching;   // Status updates being forwarded to the application callback
+
+    StreamStatusCallbackSig appCallback;
+    void* pAppContext;
+
+    // Ring of kept sessions; the newest one is the only one that can still be recording
+    gfnStreamSession sessions[GFN_STREAM_TIMELINE_HISTORY];
+    unsigned int newest;
+    unsigned int count;
+    uint64_t nextSessionId;
+} gfnStreamTimelineState;
+
+static gfnStreamTimelineState s_gfnStreamTimeline;
+
+static gfnStreamSession* gfnStreamTimelineActive(void)
+{
+    gfnStreamSession* pSession = NULL;
+
+    if (s_gfnStreamTimeline.count == 0)
+    {
+        return NULL;
+    }
+    pSession = &s_gfnStreamTimeline.sessions[s_gfnStreamTimeline.newest];
+    return pSession->timeline.finished ? NULL : pSession;
+}
+
+static gfnStreamSession* gfnStreamTimelineFind(uint64_t sessionId)
+{
+    unsigned int i = 0;
+    gfnStreamSession* pSession = NULL;
+
+    for (i = 0; i < s_gfnStreamTimeline.count; i++)
+    {
+        pSession = &s_gfnStreamTimeline.sessions[(s_gfnStreamTimeline.newest + GFN_STREAM_TIMELINE_HISTORY - i) % GFN_STREAM_TIMELINE_HISTORY];
+        if (pSession->timeline.sessionId == sessionId)
+        {
+            return pSession;
+        }
+    }
+    return NULL;
+}
+
+static void gfnStreamTimelineAddDuration(int64_t* pDurationMs, uint64_t durationMs)
+{
+    *pDurationMs = (*pDurationMs < 0 ? 0 : *pDurationMs) + (int64_t)durationMs;
+}
+
+// Credits the time since the current phase began to its duration
+static void gfnStreamTimelineClosePhase(gfnStreamSession* pSession, uint64_t now)
+{
+    if (pSession->phase == GfnStreamStatusNetworkTest)
+    {
+        gfnStreamTimelineAddDuration(&pSession->timeline.networkTestMs, now - pSession->phaseStartMs);
+    }
+    else if (pSession->phase == GfnStreamStatusLoading)
+    {
+        gfnStreamTimelineAddDuration(&pSession->timeline.loadingMs, now - pSession->phaseStartMs);
+    }
+}
+
+static void gfnStreamTimelineRecord(gfnStreamSession* pSession, GfnStreamStatus status, uint64_t now)
+{
+    GfnStreamTimeline* pTimeline = &pSession->timeline;
+
+    if (pTimeline->numEvents < GFN_STREAM_TIMELINE_MAX_EVENTS)
+    {
+        pTimeline->events[pTimeline->numEvents].status = status;
+        pTimeline->events[pTimeline->numEvents].offsetMs = now - pSession->startMs;
+        pTimeline->numEvents++;
+    }
+    else
+    {
+        pTimeline->droppedEvents++;
+    }
+
+    if (status == GfnStreamStatusGotInputFocus || status == GfnStreamStatusLostInputFocus || status == pSession->phase)
+    {
+        return;
+    }
+    gfnStreamTimelineClosePhase(pSession, now);
+    pSession->phase = status;
+    pSession->phaseStartMs = now;
+    if (status == GfnStreamStatusStreaming && pTimeline->timeToStreamMs < 0)
+    {
+        pTimeline->timeToStreamMs = (int64_t)(now - pSession->startMs);
+    }
+    else if (status == GfnStreamStatusDone || status == GfnStreamStatusError)
+    {
+        pTimeline->finished = true;
+    }
+}
+
+// Records the time the start was requested, and waits up to maxWaitMs for a running preparation to
+// initialize the timeline. Only the timeline is waited for, not the rest of the preparation.
+// Returns gfnSuccess once the timeline is initialized, gfnTimedOut if the preparation is still
+// running at the deadline, or gfnAPINotInit.
+static GfnRuntimeError gfnStreamTimelineEnter(uint32_t maxWaitMs, uint64_t* pCallMs, uint64_t* pWaitMs)
+{
+    *pCallMs = gfnSdkGetTimeMs();
+    *pWaitMs = 0;
+    while (!s_gfnStreamTimeline.initialized)
+    {
+        uint32_t sliceMs = GFN_STREAM_TIMELINE_PREPARE_POLL_MS;
+
+        if (*pWaitMs >= maxWaitMs)
+        {
+            return GfnPrepareStreamWait(0) == gfnTimedOut ? gfnTimedOut : gfnAPINotInit;
+        }
+        if (maxWaitMs - *pWaitMs < sliceMs)
+        {
+            sliceMs = (uint32_t)(maxWaitMs - *pWaitMs);
+        }
+        if (GfnPrepareStreamWait(sliceMs) != gfnTimedOut)
+        {
+            // No preparation is running, or it finished
+            *pWaitMs = gfnSdkGetTimeMs() - *pCallMs;
+            break;
+        }
+        *pWaitMs = gfnSdkGetTimeMs() - *pCallMs;
+    }
+    return s_gfnStreamTimeline.initialized ? gfnSuccess : gfnAPINotInit;
+}
+
+// Time a preparation of the title spent before the start was requested, or -1
+static int64_t gfnStreamTimelinePrepareSavedMs(unsigned int uiTitleId, uint64_t callMs)
+{
+    GfnPrepareStreamState state;
+    uint64_t endMs = callMs;
+
+    if (GFNSDK_FAILED(GfnGetPrepareStreamState(&state)) || state.uiTitleId != uiTitleId
+        || (state.status != GfnPrepareStreamReady && state.status != GfnPrepareStreamRunning))
+    {
+        return -1;
+    }
+    if (state.status == GfnPrepareStreamReady && state.finishedMs < callMs)
+    {
+        endMs = state.finishedMs;
+    }
+    return endMs > state.startedMs ? (int64_t)(endMs - state.startedMs) : 0;
+}
+
+static uint64_t gfnStreamTimelineBegin(const StartStreamInput* startStreamInput, bool async, uint64_t callMs, uint64_t waitMs)
+{
+    gfnStreamSession* pSession = NULL;
+    uint64_t sessionId = 0;
+    unsigned int uiTitleId = startStreamInput != NULL ? startStreamInput->uiTitleId : 0;
+    int64_t prepareSavedMs = gfnStreamTimelinePrepareSavedMs(uiTitleId, callMs);
+
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    pSession = gfnStreamTimelineActive();
+    if (pSession != NULL)
+    {
+        // The previous session never reported Done or Error. Its open phase is left unfinished,
+        // as there is no way to tell when it actually ended.
+        pSession->timeline.finished = true;
+    }
+
+    if (s_gfnStreamTimeline.count > 0)
+    {
+        s_gfnStreamTimeline.newest = (s_gfnStreamTimeline.newest + 1) % GFN_STREAM_TIMELINE_HISTORY;
+    }
+    if (s_gfnStreamTimeline.count < GFN_STREAM_TIMELINE_HISTORY)
+    {
+        s_gfnStreamTimeline.count++;
+    }
+    pSession = &s_gfnStreamTimeline.sessions[s_gfnStreamTimeline.newest];
+    memset(pSession, 0, sizeof(*pSession));
+    sessionId = ++s_gfnStreamTimeline.nextSessionId;
+    pSession->timeline.sessionId = sessionId;
+    pSession->timeline.uiTitleId = uiTitleId;
+    pSession->timeline.async = async;
+    pSession->timeline.startResult = gfnSuccess;
+    pSession->timeline.startCallMs = -1;
+    pSession->timeline.timeToStreamMs = -1;
+    pSession->timeline.networkTestMs = -1;
+    pSession->timeline.loadingMs = -1;
+    pSession->timeline.prepareSavedMs = prepareSavedMs;
+    pSession->timeline.prepareWaitMs = (int64_t)waitMs;
+    pSession->phase = GfnStreamStatusInit;
+    pSession->startMs = callMs;
+    pSession->phaseStartMs = pSession->startMs;
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+    return sessionId;
+}
+
+static void gfnStreamTimelineComplete(uint64_t sessionId, GfnRuntimeError result, const StartStreamResponse* response)
+{
+    gfnStreamSession* pSession = NULL;
+    uint64_t now = gfnSdkGetTimeMs();
+
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    // Session ids are never reused, so a start completing after a shutdown finds nothing
+    pSession = s_gfnStreamTimeline.initialized ? gfnStreamTimelineFind(sessionId) : NULL;
+    if (pSession != NULL && !pSession->timeline.completed)
+    {
+        pSession->timeline.completed = true;
+        pSession->timeline.startResult = result;
+        pSession->timeline.downloaded = GFNSDK_SUCCEEDED(result) && response != NULL && response->downloaded;
+        pSession->timeline.startCallMs = (int64_t)(now - pSession->startMs);
+        if (GFNSDK_FAILED(result) && !pSession->timeline.finished)
+        {
+            // The phase the start failed in still took its time
+            gfnStreamTimelineClosePhase(pSession, now);
+            pSession->phase = GfnStreamStatusError;
+            pSession->timeline.finished = true;
+        }
+    }
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+}
+
+static GfnApplicationCallbackResult GFN_CALLBACK gfnStreamTimelineStatusCallback(GfnStreamStatus status, void* pUserContext)
+{
+    gfnStreamSession* pSession = NULL;
+    StreamStatusCallbackSig appCallback = NULL;
+    void* pAppContext = NULL;
+
+    GfnApplicationCallbackResult result = crCallbackSuccess;
+
+    (void)pUserContext;
+    if (!s_gfnStreamTimeline.syncReady)
+    {
+        return crCallbackSuccess;
+    }
+
+    // Status updates that arrive after shutdown find the module uninitialized and are ignored
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    if (!s_gfnStreamTimeline.initialized)
+    {
+        gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+        return crCallbackSuccess;
+    }
+    pSession = gfnStreamTimelineActive();
+    if (pSession != NULL)
+    {
+        gfnStreamTimelineRecord(pSession, status, gfnSdkGetTimeMs());
+    }
+    appCallback = s_gfnStreamTimeline.appCallback;
+    pAppContext = s_gfnStreamTimeline.pAppContext;
+    if (appCallback != NULL)
+    {
+        s_gfnStreamTimeline.dispatching++;
+    }
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+
+    if (appCallback != NULL)
+    {
+        result = appCallback(status, pAppContext);
+
+        gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+        s_gfnStreamTimeline.dispatching--;
+        if (s_gfnStreamTimeline.dispatching == 0)
+        {
+            gfnSdkCondBroadcast(&s_gfnStreamTimeline.idleCond);
+        }
+        gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+    }
+    return result;
+}
+
+static void GFN_CALLBACK gfnStreamTimelineStartCallback(GfnRuntimeError result, StartStreamResponse* response, void* context)
+{
+    gfnStreamAsyncContext* pAsync = (gfnStreamAsyncContext*)context;
+
+    gfnStreamTimelineComplete(pAsync->sessionId, result, response);
+    if (pAsync->cb != NULL)
+    {
+        pAsync->cb(result, response, pAsync->context);
+    }
+    free(pAsync);
+}
+
+// Creates the lock and condition variable on first use; they live for the rest of the process
+static bool gfnStreamTimelineInitSync(void)
+{
+    if (s_gfnStreamTimeline.syncReady)
+    {
+        return true;
+    }
+    if (!gfnSdkMutexInit(&s_gfnStreamTimeline.lock))
+    {
+        return false;
+    }
+    if (!gfnSdkCondInit(&s_gfnStreamTimeline.idleCond))
+    {
+        gfnSdkMutexDestroy(&s_gfnStreamTimeline.lock);
+        return false;
+    }
+    s_gfnStreamTimeline.syncReady = true;
+    return true;
+}
+
+GfnRuntimeError GfnStreamTimelineInitialize(void)
+{
+    GfnRuntimeError result = gfnSuccess;
+
+    if (!gfnStreamTimelineInitSync())
+    {
+        return gfnUnableToAllocateMemory;
+    }
+
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    if (s_gfnStreamTimeline.initialized)
+    {
+        gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+        return gfnInvalidParameter;
+    }
+    // nextSessionId keeps counting, so starts from before a shutdown cannot match new sessions
+    s_gfnStreamTimeline.appCallback = NULL;
+    s_gfnStreamTimeline.pAppContext = NULL;
+    memset(s_gfnStreamTimeline.sessions, 0, sizeof(s_gfnStreamTimeline.sessions));
+    s_gfnStreamTimeline.newest = 0;
+    s_gfnStreamTimeline.count = 0;
+    s_gfnStreamTimeline.initialized = true;
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+
+    result = GfnRegisterStreamStatusCallback(gfnStreamTimelineStatusCallback, NULL);
+    if (GFNSDK_FAILED(result))
+    {
+        gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+        s_gfnStreamTimeline.initialized = false;
+        gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+    }
+    return result;
+}
+
+void GfnStreamTimelineShutdown(void)
+{
+    if (!s_gfnStreamTimeline.initialized)
+    {
+        return;
+    }
+
+    // Stop forwarding status updates, and wait for forwards in progress to return
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    s_gfnStreamTimeline.initialized = false;
+    s_gfnStreamTimeline.appCallback = NULL;
+    s_gfnStreamTimeline.pAppContext = NULL;
+    while (s_gfnStreamTimeline.dispatching > 0)
+    {
+        gfnSdkCondWait(&s_gfnStreamTimeline.idleCond, &s_gfnStreamTimeline.lock);
+    }
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+
+    // Status updates that still arrive on SDK threads take the lock, which is never destroyed,
+    // find the module uninitialized and are ignored
+    GfnRegisterStreamStatusCallback(NULL, NULL);
+}
+
+GfnRuntimeError GfnStreamTimelineRegisterStreamStatusCallback(StreamStatusCallbackSig streamStatusCallback, void* pUserContext)
+{
+    if (!s_gfnStreamTimeline.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    s_gfnStreamTimeline.appCallback = streamStatusCallback;
+    s_gfnStreamTimeline.pAppContext = pUserContext;
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+    return gfnSuccess;
+}
+
+GfnRuntimeError GfnStartStreamTracked(StartStreamInput* startStreamInput, StartStreamResponse* response)
+{
+    GfnRuntimeError result = gfnSuccess;
+    uint64_t sessionId = 0;
+    uint64_t callMs = 0;
+    uint64_t waitMs = 0;
+
+    // GfnStartStream blocks as well, so wait for a running preparation as long as it takes
+    result = gfnStreamTimelineEnter(UINT32_MAX, &callMs, &waitMs);
+    if (GFNSDK_FAILED(result))
+    {
+        return result;
+    }
+
+    sessionId = gfnStreamTimelineBegin(startStreamInput, false, callMs, waitMs);
+    result = GfnStartStream(startStreamInput, response);
+    gfnStreamTimelineComplete(sessionId, result, response);
+    return result;
+}
+
+GfnRuntimeError GfnStartStreamAsyncTracked(const StartStreamInput* startStreamInput, StartStreamCallbackSig cb, void* context, unsigned int timeoutMs)
+{
+    GfnRuntimeError result = gfnSuccess;
+    gfnStreamAsyncContext* pAsync = NULL;
+    uint64_t callMs = 0;
+    uint64_t waitMs = 0;
+
+    // The wait for a running preparation is bounded by the start timeout, and counts against it
+    result = gfnStreamTimelineEnter(timeoutMs, &callMs, &waitMs);
+    if (GFNSDK_FAILED(result))
+    {
+        return result;
+    }
+    if (waitMs > 0)
+    {
+        timeoutMs = waitMs < timeoutMs ? timeoutMs - (unsigned int)waitMs : 1;
+    }
+
+    pAsync = (gfnStreamAsyncContext*)malloc(sizeof(gfnStreamAsyncContext));
+    if (pAsync == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    pAsync->cb = cb;
+    pAsync->context = context;
+    pAsync->sessionId = gfnStreamTimelineBegin(startStreamInput, true, callMs, waitMs);
+
+    result = GfnStartStreamAsync(startStreamInput, gfnStreamTimelineStartCallback, pAsync, timeoutMs);
+    if (GFNSDK_FAILED(result))
+    {
+        // The callback is only invoked for starts that were accepted
+        gfnStreamTimelineComplete(pAsync->sessionId, result, NULL);
+        free(pAsync);
+    }
+    return result;
+}
+
+GfnRuntimeError GfnStreamTimelineGetLatest(GfnStreamTimeline* pTimeline)
+{
+    GfnRuntimeError result = gfnNoData;
+
+    if (pTimeline == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    if (!s_gfnStreamTimeline.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    if (s_gfnStreamTimeline.count > 0)
+    {
+        *pTimeline = s_gfnStreamTimeline.sessions[s_gfnStreamTimeline.newest].timeline;
+        result = gfnSuccess;
+    }
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+    return result;
+}
+
+unsigned int GfnStreamTimelineGetHistory(GfnStreamTimeline* pTimelines, unsigned int maxTimelines)
+{
+    unsigned int i = 0;
+
+    if (pTimelines == NULL || !s_gfnStreamTimeline.initialized)
+    {
+        return 0;
+    }
+
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    for (i = 0; i < s_gfnStreamTimeline.count && i < maxTimelines; i++)
+    {
+        pTimelines[i] = s_gfnStreamTimeline.sessions[(s_gfnStreamTimeline.newest + GFN_STREAM_TIMELINE_HISTORY - i) % GFN_STREAM_TIMELINE_HISTORY].timeline;
+    }
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+    return i;
+}
+
+static int64_t gfnStreamTimelineMetricValue(const GfnStreamTimeline* pTimeline, GfnStreamTimelineMetric metric)
+{
+    switch (metric)
+    {
+    case GfnStreamTimelineMetricTimeToStream:   return pTimeline->timeToStreamMs;
+    case GfnStreamTimelineMetricNetworkTest:    return pTimeline->networkTestMs;
+    case GfnStreamTimelineMetricLoading:        return pTimeline->loadingMs;
+    case GfnStreamTimelineMetricStartCall:      return pTimeline->startCallMs;
+    case GfnStreamTimelineMetricPrepareSaved:   return pTimeline->prepareSavedMs;
+    default:                                    return -1;
+    }
+}
+
+static unsigned int gfnStreamTimelineBucket(uint64_t valueMs)
+{
+    unsigned int bucket = 0;
+
+    while (valueMs > 0 && bucket < GFN_STREAM_TIMELINE_HISTOGRAM_BUCKETS - 1)
+    {
+        valueMs >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+GfnRuntimeError GfnStreamTimelineGetHistogram(GfnStreamTimelineMetric metric, GfnStreamTimelineHistogram* pHistogram)
+{
+    uint64_t values[GFN_STREAM_TIMELINE_HISTORY];
+    uint64_t value = 0;
+    uint64_t sum = 0;
+    int64_t metricValue = 0;
+    unsigned int count = 0;
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    if (pHistogram == NULL || (int)metric < 0 || metric >= GfnStreamTimelineMetricCount)
+    {
+        return gfnInvalidParameter;
+    }
+    if (!s_gfnStreamTimeline.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    for (i = 0; i < s_gfnStreamTimeline.count; i++)
+    {
+        metricValue = gfnStreamTimelineMetricValue(&s_gfnStreamTimeline.sessions[i].timeline, metric);
+        if (metricValue >= 0)
+        {
+            values[count++] = (uint64_t)metricValue;
+        }
+    }
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+
+    // At most GFN_STREAM_TIMELINE_HISTORY values, an insertion sort is all the percentiles need
+    for (i = 1; i < count; i++)
+    {
+        value = values[i];
+        for (j = i; j > 0 && values[j - 1] > value; j--)
+        {
+            values[j] = values[j - 1];
+        }
+        values[j] = value;
+    }
+
+    memset(pHistogram, 0, sizeof(*pHistogram));
+    pHistogram->count = count;
+    if (count == 0)
+    {
+        return gfnSuccess;
+    }
+    for (i = 0; i < count; i++)
+    {
+        sum += values[i];
+        pHistogram->buckets[gfnStreamTimelineBucket(values[i])]++;
+    }
+    pHistogram->minMs = values[0];
+    pHistogram->maxMs = values[count - 1];
+    pHistogram->meanMs = sum / count;
+    // Nearest-rank percentiles
+    pHistogram->p50Ms = values[(count * 50 + 99) / 100 - 1];
+    pHistogram->p90Ms = values[(count * 90 + 99) / 100 - 1];
+    pHistogram->p99Ms = values[(count * 99 + 99) / 100 - 1];
+    return gfnSuccess;
+}
+
+void GfnStreamTimelineReset(void)
+{
+    gfnStreamSession* pSession = NULL;
+
+    if (!s_gfnStreamTimeline.initialized)
+    {
+        return;
+    }
+
+    gfnSdkMutexLock(&s_gfnStreamTimeline.lock);
+    pSession = gfnStreamTimelineActive();
+    if (pSession != NULL)
+    {
+        s_gfnStreamTimeline.sessions[0] = *pSession;
+        s_gfnStreamTimeline.newest = 0;
+        s_gfnStreamTimeline.count = 1;
+    }
+    else
+    {
+        s_gfnStreamTimeline.newest = 0;
+        s_gfnStreamTimeline.count = 0;
+    }
+    gfnSdkMutexUnlock(&s_gfnStreamTimeline.lock);
+}
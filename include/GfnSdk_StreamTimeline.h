@@ -0,0 +1,315 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Per-session timeline and latency histograms for stream start attempts
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_StreamTimeline.h
+*
+* Optional stream session timeline for @ref GfnStartStream and @ref GfnStartStreamAsync
+*/
+///
+/// @page stream_timeline Stream Timeline
+///
+/// @section stream_timeline_introduction Introduction
+/// The stream status callback reports the phases of a stream start one at a time. This module
+/// records them instead: every start made through @ref GfnStartStreamTracked or
+/// @ref GfnStartStreamAsyncTracked opens a new session timeline, and every @ref GfnStreamStatus
+/// reported until the session reaches GfnStreamStatusDone or GfnStreamStatusError is stored
+/// with its offset from the start call. From the transitions the module derives:
+///
+/// - the time to stream, from the start call to the first GfnStreamStatusStreaming
+/// - the time spent in GfnStreamStatusNetworkTest, and in GfnStreamStatusLoading
+/// - the duration of the start call itself, together with its result and
+///   StartStreamResponse::downloaded
+/// - the time saved by an earlier @ref GfnPrepareStream for the title
+///
+/// The last @ref GFN_STREAM_TIMELINE_HISTORY sessions are kept, and
+/// @ref GfnStreamTimelineGetHistogram summarizes any of these metrics over them.
+///
+/// Only one stream status callback can be registered with the SDK, and this module registers
+/// its own. Applications that also need the status updates register with
+/// @ref GfnStreamTimelineRegisterStreamStatusCallback, which receives every update after it
+/// has been recorded. Starts made with @ref GfnStartStream or @ref GfnStartStreamAsync directly
+/// are not tracked.
+///
+
+#ifndef __NV_GFNSDK_STREAM_TIMELINE_H__
+#define __NV_GFNSDK_STREAM_TIMELINE_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Number of status transitions stored per session. Later transitions are counted, not stored.
+#define GFN_STREAM_TIMELINE_MAX_EVENTS 16
+/// @brief Number of sessions kept for @ref GfnStreamTimelineGetHistory and the histograms
+#define GFN_STREAM_TIMELINE_HISTORY 64
+/// @brief Number of buckets in a @ref GfnStreamTimelineHistogram
+#define GFN_STREAM_TIMELINE_HISTOGRAM_BUCKETS 20
+
+/// @brief A status transition, relative to the start call of its session
+typedef struct GfnStreamTimelineEvent
+{
+    GfnStreamStatus status;
+    uint64_t offsetMs;
+} GfnStreamTimelineEvent;
+
+/// @brief Timeline of a single tracked stream start. Durations are -1 until they are known.
+typedef struct GfnStreamTimeline
+{
+    uint64_t sessionId;             ///< Numbered from 1 in the order the starts were made
+    unsigned int uiTitleId;         ///< StartStreamInput::uiTitleId of the start
+    bool async;                     ///< Started with @ref GfnStartStreamAsyncTracked
+    bool completed;                 ///< The start call returned, or its callback was invoked
+    bool finished;                  ///< No further transitions are recorded: the session reached Done or Error,
+                                    ///< the start failed, or a later start replaced it
+    GfnRuntimeError startResult;    ///< Result of the start call. Valid once completed is set.
+    bool downloaded;                ///< StartStreamResponse::downloaded. Valid once completed is set.
+    int64_t startCallMs;            ///< Time until the start call returned, or its callback was invoked
+    int64_t timeToStreamMs;         ///< Time until the first GfnStreamStatusStreaming
+    int64_t networkTestMs;          ///< Total time spent in GfnStreamStatusNetworkTest
+    int64_t loadingMs;              ///< Total time spent in GfnStreamStatusLoading
+    int64_t prepareSavedMs;         ///< Time @ref GfnPrepareStream spent preparing this title before the start,
+                                    ///< which the start did not have to spend. -1 if the title was not prepared.
+    int64_t prepareWaitMs;          ///< Time the start waited for a running @ref GfnPrepareStream to initialize
+                                    ///< the client library and the timeline. Included in the other durations.
+    unsigned int numEvents;         ///< Number of entries in events
+    unsigned int droppedEvents;     ///< Transitions not stored because events was full
+    GfnStreamTimelineEvent events[GFN_STREAM_TIMELINE_MAX_EVENTS];
+} GfnStreamTimeline;
+
+/// @brief Metrics that @ref GfnStreamTimelineGetHistogram can summarize
+typedef enum GfnStreamTimelineMetric
+{
+    GfnStreamTimelineMetricTimeToStream = 0,    ///< @ref GfnStreamTimeline::timeToStreamMs
+    GfnStreamTimelineMetricNetworkTest,         ///< @ref GfnStreamTimeline::networkTestMs
+    GfnStreamTimelineMetricLoading,             ///< @ref GfnStreamTimeline::loadingMs
+    GfnStreamTimelineMetricStartCall,           ///< @ref GfnStreamTimeline::startCallMs
+    GfnStreamTimelineMetricPrepareSaved,        ///< @ref GfnStreamTimeline::prepareSavedMs
+    GfnStreamTimelineMetricCount
+} GfnStreamTimelineMetric;
+
+/// @brief Distribution of a metric over the kept sessions where it is known
+typedef struct GfnStreamTimelineHistogram
+{
+    unsigned int count;             ///< Number of sessions with a value for the metric
+    uint64_t minMs;
+    uint64_t maxMs;
+    uint64_t meanMs;
+    uint64_t p50Ms;
+    uint64_t p90Ms;
+    uint64_t p99Ms;
+    /// Bucket 0 counts values below 1 ms, bucket n counts values from 2^(n-1) ms to below 2^n ms,
+    /// and the last bucket also counts all larger values.
+    unsigned int buckets[GFN_STREAM_TIMELINE_HISTOGRAM_BUCKETS];
+} GfnStreamTimelineHistogram;
+
+///
+/// @par Description
+/// Starts recording stream timelines, and registers the module's stream status callback.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Call once after @ref GfnInitializeSdk, before any tracked start. Can be called again after
+/// @ref GfnStreamTimelineShutdown.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - The timeline is already initialized
+/// @retval gfnUnableToAllocateMemory - The lock could not be created
+/// @return Any error returned by @ref GfnRegisterStreamStatusCallback
+GfnRuntimeError GfnStreamTimelineInitialize(void);
+
+///
+/// @par Description
+/// Stops recording stream timelines and discards them.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Call before @ref GfnShutdownSdk. Waits for status updates being forwarded to the application
+/// callback to return, so do not call from that callback. Status updates and tracked asynchronous
+/// starts that complete afterwards are not recorded.
+void GfnStreamTimelineShutdown(void);
+
+///
+/// @par Description
+/// Registers an application callback that receives every stream status update after the
+/// timeline has recorded it. Replaces any callback registered before.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Use instead of @ref GfnRegisterStreamStatusCallback while the timeline is initialized.
+///
+/// @param streamStatusCallback      - Function to call, or NULL to stop forwarding updates
+/// @param pUserContext              - Pointer to user context passed unmodified to the callback. Can be NULL.
+///
+/// @retval gfnSuccess               - On success
+/// @retval gfnAPINotInit            - @ref GfnStreamTimelineInitialize was not called
+GfnRuntimeError GfnStreamTimelineRegisterStreamStatusCallback(StreamStatusCallbackSig streamStatusCallback, void* pUserContext);
+
+///
+/// @par Description
+/// Calls @ref GfnStartStream and records the session timeline.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Use instead of @ref GfnStartStream. If @ref GfnPrepareStream is still initializing the client
+/// library and the timeline, waits for it first.
+///
+/// @param startStreamInput          - Pointer to a StartStreamInput structure.
+/// @param response                  - Start streaming response.
+///
+/// @retval gfnAPINotInit            - @ref GfnStreamTimelineInitialize was not called, and no running
+///                                    @ref GfnPrepareStream initialized it
+/// @return Otherwise, the result of @ref GfnStartStream
+GfnRuntimeError GfnStartStreamTracked(StartStreamInput* startStreamInput, StartStreamResponse* response);
+
+///
+/// @par Description
+/// Calls @ref GfnStartStreamAsync and records the session timeline.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @par Usage
+/// Use instead of @ref GfnStartStreamAsync. If @ref GfnPrepareStream is still initializing the
+/// client library and the timeline, waits for it first, for at most timeoutMs. The time waited
+/// is deducted from the timeout passed to @ref GfnStartStreamAsync.
+///
+/// @param startStreamInput          - Pointer to a StartStreamInput structure.
+/// @param cb                        - Called once the start completes, after the result has been recorded. Can be NULL.
+/// @param context                   - User context passed unmodified to cb
+/// @param timeoutMs                 - Time after which attempt to start streaming will be aborted.
+///
+/// @retval gfnAPINotInit             - @ref GfnStreamTimelineInitialize was not called, and no running
+///                                     @ref GfnPrepareStream initialized it
+/// @retval gfnTimedOut               - A running @ref GfnPrepareStream did not initialize the timeline
+///                                     within timeoutMs. The stream is not started.
+/// @retval gfnUnableToAllocateMemory - The start could not be tracked. The stream is not started.
+/// @return Otherwise, the result of @ref GfnStartStreamAsync
+GfnRuntimeError GfnStartStreamAsyncTracked(const StartStreamInput* startStreamInput, StartStreamCallbackSig cb, void* context, unsigned int timeoutMs);
+
+///
+/// @par Description
+/// Copies the timeline of the most recent tracked start.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @param pTimeline                 - Receives the timeline
+///
+/// @retval gfnSuccess               - On success
+/// @retval gfnInvalidParameter      - pTimeline is NULL
+/// @retval gfnAPINotInit            - @ref GfnStreamTimelineInitialize was not called
+/// @retval gfnNoData                - No start has been tracked yet
+GfnRuntimeError GfnStreamTimelineGetLatest(GfnStreamTimeline* pTimeline);
+
+///
+/// @par Description
+/// Copies the timelines of the most recent tracked starts, newest first.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @param pTimelines                - Receives up to maxTimelines timelines
+/// @param maxTimelines              - Number of entries pTimelines can hold
+///
+/// @return The number of timelines copied, at most @ref GFN_STREAM_TIMELINE_HISTORY
+unsigned int GfnStreamTimelineGetHistory(GfnStreamTimeline* pTimelines, unsigned int maxTimelines);
+
+///
+/// @par Description
+/// Summarizes a metric over the kept sessions. Sessions where the metric is not known, for
+/// example the time to stream of a start that failed, are not counted.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+///
+/// @param metric                    - The metric to summarize
+/// @param pHistogram                - Receives the distribution
+///
+/// @retval gfnSuccess               - On success, even if no session has a value for the metric
+/// @retval gfnInvalidParameter      - Unknown metric, or pHistogram is NULL
+/// @retval gfnAPINotInit            - @ref GfnStreamTimelineInitialize was not called
+GfnRuntimeError GfnStreamTimelineGetHistogram(GfnStreamTimelineMetric metric, GfnStreamTimelineHistogram* pHistogram);
+
+///
+/// @par Description
+/// Discards the kept sessions. A session that has not finished yet keeps being recorded.
+///
+/// @par Environment
+/// Client
+///
+/// @par Platform
+/// Windows
+void GfnStreamTimelineReset(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_STREAM_TIMELINE_H__
@@ -0,0 +1,264 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_Threading.h"
+
+#include <stdlib.h>
+
+#ifdef __linux__
+#   include <errno.h>
+#   include <time.h>
+#endif
+
+typedef struct gfnSdkThreadStart
+{
+    GfnSdkThreadFn fnThread;
+    void* pContext;
+} gfnSdkThreadStart;
+
+#ifdef _WIN32
+
+bool gfnSdkMutexInit(GfnSdkMutex* pMutex)
+{
+    InitializeCriticalSection(pMutex);
+    return true;
+}
+
+void gfnSdkMutexDestroy(GfnSdkMutex* pMutex)
+{
+    DeleteCriticalSection(pMutex);
+}
+
+void gfnSdkMutexLock(GfnSdkMutex* pMutex)
+{
+    EnterCriticalSection(pMutex);
+}
+
+void gfnSdkMutexUnlock(GfnSdkMutex* pMutex)
+{
+    LeaveCriticalSection(pMutex);
+}
+
+bool gfnSdkCondInit(GfnSdkCondVar* pCond)
+{
+    InitializeConditionVariable(pCond);
+    return true;
+}
+
+void gfnSdkCondDestroy(GfnSdkCondVar* pCond)
+{
+    // Windows condition variables do not hold any resources
+    (void)pCond;
+}
+
+void gfnSdkCondWait(GfnSdkCondVar* pCond, GfnSdkMutex* pMutex)
+{
+    SleepConditionVariableCS(pCond, pMutex, INFINITE);
+}
+
+bool gfnSdkCondTimedWait(GfnSdkCondVar* pCond, GfnSdkMutex* pMutex, uint32_t timeoutMs)
+{
+    return SleepConditionVariableCS(pCond, pMutex, timeoutMs) != FALSE;
+}
+
+void gfnSdkCondSignal(GfnSdkCondVar* pCond)
+{
+    WakeConditionVariable(pCond);
+}
+
+void gfnSdkCondBroadcast(GfnSdkCondVar* pCond)
+{
+    WakeAllConditionVariable(pCond);
+}
+
+static DWORD WINAPI gfnSdkThreadEntry(LPVOID pParam)
+{
+    gfnSdkThreadStart start = *(gfnSdkThreadStart*)pParam;
+    free(pParam);
+    start.fnThread(start.pContext);
+    return 0;
+}
+
+bool gfnSdkThreadCreate(GfnSdkThread* pThread, GfnSdkThreadFn fnThread, void* pContext)
+{
+    gfnSdkThreadStart* pStart = (gfnSdkThreadStart*)malloc(sizeof(gfnSdkThreadStart));
+    if (pStart == NULL)
+    {
+        return false;
+    }
+    pStart->fnThread = fnThread;
+    pStart->pContext = pContext;
+
+    *pThread = CreateThread(NULL, 0, gfnSdkThreadEntry, pStart, 0, NULL);
+    if (*pThread == NULL)
+    {
+        free(pStart);
+        return false;
+    }
+    return true;
+}
+
+void gfnSdkThreadJoin(GfnSdkThread thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+uint64_t gfnSdkGetTimeMs(void)
+{
+    return (uint64_t)GetTickCount64();
+}
+
+void gfnSdkSleepMs(uint32_t sleepMs)
+{
+    Sleep(sleepMs);
+}
+
+#elif __linux__
+
+bool gfnSdkMutexInit(GfnSdkMutex* pMutex)
+{
+    return pthread_mutex_init(pMutex, NULL) == 0;
+}
+
+void gfnSdkMutexDestroy(GfnSdkMutex* pMutex)
+{
+    pthread_mutex_destroy(pMutex);
+}
+
+void gfnSdkMutexLock(GfnSdkMutex* pMutex)
+{
+    pthread_mutex_lock(pMutex);
+}
+
+void gfnSdkMutexUnlock(GfnSdkMutex* pMutex)
+{
+    pthread_mutex_unlock(pMutex);
+}
+
+bool gfnSdkCondInit(GfnSdkCondVar* pCond)
+{
+    pthread_condattr_t attr;
+    bool success = false;
+
+    if (pthread_condattr_init(&attr) != 0)
+    {
+        return false;
+    }
+    // Timed waits must not be affected by wall clock adjustments
+    if (pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0)
+    {
+        success = pthread_cond_init(pCond, &attr) == 0;
+    }
+    pthread_condattr_destroy(&attr);
+    return success;
+}
+
+void gfnSdkCondDestroy(GfnSdkCondVar* pCond)
+{
+    pthread_cond_destroy(pCond);
+}
+
+void gfnSdkCondWait(GfnSdkCondVar* pCond, GfnSdkMutex* pMutex)
+{
+    pthread_cond_wait(pCond, pMutex);
+}
+
+bool gfnSdkCondTimedWait(GfnSdkCondVar* pCond, GfnSdkMutex* pMutex, uint32_t timeoutMs)
+{
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(pCond, pMutex, &deadline) != ETIMEDOUT;
+}
+
+void gfnSdkCondSignal(GfnSdkCondVar* pCond)
+{
+    pthread_cond_signal(pCond);
+}
+
+void gfnSdkCondBroadcast(GfnSdkCondVar* pCond)
+{
+    pthread_cond_broadcast(pCond);
+}
+
+static void* gfnSdkThreadEntry(void* pParam)
+{
+    gfnSdkThreadStart start = *(gfnSdkThreadStart*)pParam;
+    free(pParam);
+    start.fnThread(start.pContext);
+    return NULL;
+}
+
+bool gfnSdkThreadCreate(GfnSdkThread* pThread, GfnSdkThreadFn fnThread, void* pContext)
+{
+    gfnSdkThreadStart* pStart = (gfnSdkThreadStart*)malloc(sizeof(gfnSdkThreadStart));
+    if (pStart == NULL)
+    {
+        return false;
+    }
+    pStart->fnThread = fnThread;
+    pStart->pContext = pContext;
+
+    if (pthread_create(pThread, NULL, gfnSdkThreadEntry, pStart) != 0)
+    {
+        free(pStart);
+        return false;
+    }
+    return true;
+}
+
+void gfnSdkThreadJoin(GfnSdkThread thread)
+{
+    pthread_join(thread, NULL);
+}
+
+uint64_t gfnSdkGetTimeMs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000u + (uint64_t)(now.tv_nsec / 1000000L);
+}
+
+void gfnSdkSleepMs(uint32_t sleepMs)
+{
+    struct timespec duration;
+    duration.tv_sec = sleepMs / 1000;
+    duration.tv_nsec = (long)(sleepMs % 1000) * 1000000L;
+    while (nanosleep(&duration, &duration) != 0 && errno == EINTR)
+    {
+    }
+}
+
+#endif
@@ -0,0 +1,102 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Minimal portable threading primitives used by the optional wrapper helper modules
+//
+// ===============================================================================================
+
+#ifndef __NV_GFNSDK_THREADING_H__
+#define __NV_GFNSDK_THREADING_H__
+
+#include "GfnSdk.h"
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+    typedef CRITICAL_SECTION GfnSdkMutex;
+    typedef CONDITION_VARIABLE GfnSdkCondVar;
+    typedef HANDLE GfnSdkThread;
+#elif __linux__
+#   include <pthread.h>
+    typedef pthread_mutex_t GfnSdkMutex;
+    typedef pthread_cond_t GfnSdkCondVar;
+    typedef pthread_t GfnSdkThread;
+#else
+#   error "Unsupported platform"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Entry point signature for threads created with @ref gfnSdkThreadCreate
+typedef void (*GfnSdkThreadFn)(void* pContext);
+
+/// @brief Initializes a non-recursive mutex. Returns false on failure.
+bool gfnSdkMutexInit(GfnSdkMutex* pMutex);
+/// @brief Releases resources held by a mutex initialized with @ref gfnSdkMutexInit
+void gfnSdkMutexDestroy(GfnSdkMutex* pMutex);
+/// @brief Acquires the mutex, blocking until it is available
+void gfnSdkMutexLock(GfnSdkMutex* pMutex);
+/// @brief Releases the mutex
+void gfnSdkMutexUnlock(GfnSdkMutex* pMutex);
+
+/// @brief Initializes a condition variable. Timed waits are measured against the monotonic clock.
+bool gfnSdkCondInit(GfnSdkCondVar* pCond);
+/// @brief Releases resources held by a condition variable initialized with @ref gfnSdkCondInit
+void gfnSdkCondDestroy(GfnSdkCondVar* pCond);
+/// @brief Atomically releases the mutex and waits for the condition to be signaled
+void gfnSdkCondWait(GfnSdkCondVar* pCond, GfnSdkMutex* pMutex);
+/// @brief Same as @ref gfnSdkCondWait, but gives up after timeoutMs. Returns false on timeout.
+bool gfnSdkCondTimedWait(GfnSdkCondVar* pCond, GfnSdkMutex* pMutex, uint32_t timeoutMs);
+/// @brief Wakes one waiter
+void gfnSdkCondSignal(GfnSdkCondVar* pCond);
+/// @brief Wakes all waiters
+void gfnSdkCondBroadcast(GfnSdkCondVar* pCond);
+
+/// @brief Starts a new thread running fnThread(pContext). Returns false on failure.
+bool gfnSdkThreadCreate(GfnSdkThread* pThread, GfnSdkThreadFn fnThread, void* pContext);
+/// @brief Waits for the thread to exit and releases its resources
+void gfnSdkThreadJoin(GfnSdkThread thread);
+
+/// @brief Returns milliseconds elapsed on a monotonic clock with an unspecified epoch
+uint64_t gfnSdkGetTimeMs(void);
+/// @brief Suspends the calling thread for at least sleepMs
+void gfnSdkSleepMs(uint32_t sleepMs);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_THREADING_H__
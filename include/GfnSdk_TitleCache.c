@@ -0,0 +1,427 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include "GfnSdk_TitleCache.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define GFN_TITLES_DEFAULT_REFRESH_INTERVAL_MS 300000
+#define GFN_TITLES_MIN_SLOTS 16
+
+// Slot of the set. Identifiers are never empty, so a zero length marks a free slot.
+typedef struct gfnTitleSlot
+{
+    uint32_t hash;
+    uint32_t offset;                    // Of the identifier in pchIds
+    uint32_t length;
+} gfnTitleSlot;
+
+struct GfnTitleSet
+{
+    char* pchIds;                       // Copy of the list, with each identifier terminated
+    gfnTitleSlot* pSlots;
+    uint32_t mask;                      // Number of slots - 1, a power of two at least twice the number of titles
+    unsigned int numTitles;
+};
+
+typedef struct gfnTitleCache
+{
+    bool initialized;
+    bool stopping;
+    GfnTitleCacheConfig config;
+
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+    GfnSdkMutex refreshLock;            // Held for a whole refresh, so that refreshes do not overlap
+
+    GfnTitleSet* pSet;                  // Replaced under lock, read under lock
+    uint64_t setBuiltMs;
+
+    GfnSdkThread thread;
+    bool threadValid;
+
+    GfnTitleCacheStats stats;
+} gfnTitleCache;
+
+static gfnTitleCache s_gfnTitles;
+
+static bool gfnTitlesIsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// FNV-1a with a final mix, so that identifiers differing in the last characters spread over the
+// whole table under linear probing. Also returns the length of the identifier.
+static uint32_t gfnTitlesHash(const char* pchId, size_t maxLength, size_t* pLength)
+{
+    uint32_t hash = 2166136261u;
+    size_t length = 0;
+
+    while (length < maxLength && pchId[length] != '\0')
+    {
+        hash = (hash ^ (unsigned char)pchId[length]) * 16777619u;
+        length++;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    *pLength = length;
+    return hash;
+}
+
+static const gfnTitleSlot* gfnTitlesFind(const GfnTitleSet* pSet, const char* pchId, size_t length, uint32_t hash)
+{
+    const gfnTitleSlot* pSlot = NULL;
+    uint32_t i = hash & pSet->mask;
+
+    for (;;)
+    {
+        pSlot = &pSet->pSlots[i];
+        if (pSlot->length == 0)
+        {
+            return pSlot;
+        }
+        if (pSlot->hash == hash && pSlot->length == length && memcmp(pSet->pchIds + pSlot->offset, pchId, length) == 0)
+        {
+            return pSlot;
+        }
+        i = (i + 1) & pSet->mask;
+    }
+}
+
+GfnRuntimeError GfnTitleSetCreate(const char* pchList, GfnTitleSet** ppSet)
+{
+    GfnTitleSet* pSet = NULL;
+    size_t listLength = 0;
+    size_t numEntries = 1;
+    size_t numSlots = GFN_TITLES_MIN_SLOTS;
+    size_t i = 0;
+    size_t start = 0;
+    size_t end = 0;
+    size_t length = 0;
+    uint32_t hash = 0;
+    const gfnTitleSlot* pSlot = NULL;
+
+    if (pchList == NULL || ppSet == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+    *ppSet = NULL;
+    listLength = strlen(pchList);
+    // Offsets and lengths are stored in 32 bits
+    if (listLength >= UINT32_MAX / 2)
+    {
+        return gfnInvalidParameter;
+    }
+    for (i = 0; i < listLength; i++)
+    {
+        numEntries += pchList[i] == ',' ? 1 : 0;
+    }
+    while (numSlots < 2 * numEntries)
+    {
+        numSlots *= 2;
+    }
+
+    pSet = (GfnTitleSet*)calloc(1, sizeof(GfnTitleSet));
+    if (pSet == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    pSet->pchIds = (char*)malloc(listLength + 1);
+    pSet->pSlots = (gfnTitleSlot*)calloc(numSlots, sizeof(gfnTitleSlot));
+    if (pSet->pchIds == NULL || pSet->pSlots == NULL)
+    {
+        GfnTitleSetDestroy(pSet);
+        return gfnUnableToAllocateMemory;
+    }
+    memcpy(pSet->pchIds, pchList, listLength + 1);
+    pSet->mask = (uint32_t)(numSlots - 1);
+
+    for (start = 0; start <= listLength; start = end + 1)
+    {
+        for (end = start; end < listLength && pSet->pchIds[end] != ','; end++)
+        {
+        }
+        pSet->pchIds[end] = '\0';
+        for (i = start; i < end && gfnTitlesIsSpace(pSet->pchIds[i]); i++)
+        {
+        }
+        for (length = end - i; length > 0 && gfnTitlesIsSpace(pSet->pchIds[i + length - 1]); length--)
+        {
+        }
+        if (length == 0)
+        {
+            continue;
+        }
+        pSet->pchIds[i + length] = '\0';
+        hash = gfnTitlesHash(pSet->pchIds + i, length, &length);
+        pSlot = gfnTitlesFind(pSet, pSet->pchIds + i, length, hash);
+        if (pSlot->length == 0)
+        {
+            pSet->pSlots[pSlot - pSet->pSlots].hash = hash;
+            pSet->pSlots[pSlot - pSet->pSlots].offset = (uint32_t)i;
+            pSet->pSlots[pSlot - pSet->pSlots].length = (uint32_t)length;
+            pSet->numTitles++;
+        }
+    }
+
+    *ppSet = pSet;
+    return gfnSuccess;
+}
+
+void GfnTitleSetDestroy(GfnTitleSet* pSet)
+{
+    if (pSet != NULL)
+    {
+        free(pSet->pchIds);
+        free(pSet->pSlots);
+        free(pSet);
+    }
+}
+
+bool GfnTitleSetContains(const GfnTitleSet* pSet, const char* pchPlatformAppId)
+{
+    size_t length = 0;
+    uint32_t hash = 0;
+
+    if (pSet == NULL || pchPlatformAppId == NULL)
+    {
+        return false;
+    }
+    hash = gfnTitlesHash(pchPlatformAppId, (size_t)-1, &length);
+    return length != 0 && gfnTitlesFind(pSet, pchPlatformAppId, length, hash)->length != 0;
+}
+
+unsigned int GfnTitleSetGetCount(const GfnTitleSet* pSet)
+{
+    return pSet != NULL ? pSet->numTitles : 0;
+}
+
+static void gfnTitlesThread(void* pContext)
+{
+    uint64_t nextMs = 0;
+    uint64_t nowMs = 0;
+    bool refresh = false;
+
+    (void)pContext;
+
+    nextMs = gfnSdkGetTimeMs() + s_gfnTitles.config.refreshIntervalMs;
+    gfnSdkMutexLock(&s_gfnTitles.lock);
+    while (!s_gfnTitles.stopping)
+    {
+        nowMs = gfnSdkGetTimeMs();
+        refresh = nowMs >= nextMs;
+        if (!refresh)
+        {
+            gfnSdkCondTimedWait(&s_gfnTitles.cond, &s_gfnTitles.lock, (uint32_t)(nextMs - nowMs));
+            continue;
+        }
+        gfnSdkMutexUnlock(&s_gfnTitles.lock);
+        GfnTitleCacheRefresh();
+        nextMs = gfnSdkGetTimeMs() + s_gfnTitles.config.refreshIntervalMs;
+        gfnSdkMutexLock(&s_gfnTitles.lock);
+    }
+    gfnSdkMutexUnlock(&s_gfnTitles.lock);
+}
+
+GfnRuntimeError GfnTitleCacheInitialize(const GfnTitleCacheConfig* pConfig)
+{
+    if (s_gfnTitles.initialized)
+    {
+        return gfnInvalidParameter;
+    }
+
+    memset(&s_gfnTitles, 0, sizeof(s_gfnTitles));
+    if (pConfig != NULL)
+    {
+        s_gfnTitles.config = *pConfig;
+    }
+    if (s_gfnTitles.config.refreshIntervalMs == 0)
+    {
+        s_gfnTitles.config.refreshIntervalMs = GFN_TITLES_DEFAULT_REFRESH_INTERVAL_MS;
+    }
+    if (!gfnSdkMutexInit(&s_gfnTitles.lock))
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkMutexInit(&s_gfnTitles.refreshLock))
+    {
+        gfnSdkMutexDestroy(&s_gfnTitles.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    if (!gfnSdkCondInit(&s_gfnTitles.cond))
+    {
+        gfnSdkMutexDestroy(&s_gfnTitles.refreshLock);
+        gfnSdkMutexDestroy(&s_gfnTitles.lock);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnTitles.stats.lastRefreshResult = gfnSuccess;
+    s_gfnTitles.initialized = true;
+
+    if (!s_gfnTitles.config.manualRefresh)
+    {
+        s_gfnTitles.threadValid = gfnSdkThreadCreate(&s_gfnTitles.thread, gfnTitlesThread, NULL);
+        if (!s_gfnTitles.threadValid)
+        {
+            GfnTitleCacheShutdown();
+            return gfnUnableToAllocateMemory;
+        }
+    }
+    return GfnTitleCacheRefresh();
+}
+
+void GfnTitleCacheShutdown(void)
+{
+    if (!s_gfnTitles.initialized)
+    {
+        return;
+    }
+
+    gfnSdkMutexLock(&s_gfnTitles.lock);
+    s_gfnTitles.stopping = true;
+    gfnSdkCondBroadcast(&s_gfnTitles.cond);
+    gfnSdkMutexUnlock(&s_gfnTitles.lock);
+    if (s_gfnTitles.threadValid)
+    {
+        gfnSdkThreadJoin(s_gfnTitles.thread);
+    }
+    GfnTitleSetDestroy(s_gfnTitles.pSet);
+
+    s_gfnTitles.initialized = false;
+    gfnSdkCondDestroy(&s_gfnTitles.cond);
+    gfnSdkMutexDestroy(&s_gfnTitles.refreshLock);
+    gfnSdkMutexDestroy(&s_gfnTitles.lock);
+    memset(&s_gfnTitles, 0, sizeof(s_gfnTitles));
+}
+
+GfnRuntimeError GfnTitleCacheRefresh(void)
+{
+    const char* pchList = NULL;
+    GfnTitleSet* pSet = NULL;
+    GfnTitleSet* pOldSet = NULL;
+    uint64_t startMs = 0;
+    GfnRuntimeError result = gfnSuccess;
+
+    if (!s_gfnTitles.initialized)
+    {
+        return gfnAPINotInit;
+    }
+
+    gfnSdkMutexLock(&s_gfnTitles.refreshLock);
+    startMs = gfnSdkGetTimeMs();
+    result = GfnGetTitlesAvailable(&pchList);
+    if (result == gfnSuccess)
+    {
+        result = GfnTitleSetCreate(pchList != NULL ? pchList : "", &pSet);
+    }
+    if (pchList != NULL)
+    {
+        GfnFree(&pchList);
+    }
+
+    // The set is built before the lock is taken, so lookups only wait for the pointer swap
+    gfnSdkMutexLock(&s_gfnTitles.lock);
+    s_gfnTitles.stats.lastRefreshResult = result;
+    if (result == gfnSuccess)
+    {
+        pOldSet = s_gfnTitles.pSet;
+        s_gfnTitles.pSet = pSet;
+        s_gfnTitles.setBuiltMs = gfnSdkGetTimeMs();
+        s_gfnTitles.stats.ready = true;
+        s_gfnTitles.stats.numTitles = pSet->numTitles;
+        s_gfnTitles.stats.numRefreshes++;
+        s_gfnTitles.stats.lastRefreshMs = s_gfnTitles.setBuiltMs - startMs;
+    }
+    else
+    {
+        s_gfnTitles.stats.numRefreshFailures++;
+    }
+    gfnSdkMutexUnlock(&s_gfnTitles.lock);
+    gfnSdkMutexUnlock(&s_gfnTitles.refreshLock);
+
+    // No lookup can still be using the old set, as lookups hold the lock
+    GfnTitleSetDestroy(pOldSet);
+    return result;
+}
+
+GfnRuntimeError GfnIsTitleAvailableCached(const char* platformAppId, bool* isAvailable)
+{
+    size_t length = 0;
+    uint32_t hash = 0;
+    bool answered = false;
+
+    if (isAvailable == NULL || platformAppId == NULL)
+    {
+        return GfnIsTitleAvailable(platformAppId, isAvailable);
+    }
+    if (!s_gfnTitles.initialized)
+    {
+        return GfnIsTitleAvailable(platformAppId, isAvailable);
+    }
+
+    // Hashed before the lock is taken, so the lock is only held for the probe
+    hash = gfnTitlesHash(platformAppId, (size_t)-1, &length);
+    gfnSdkMutexLock(&s_gfnTitles.lock);
+    if (s_gfnTitles.pSet != NULL)
+    {
+        *isAvailable = length != 0 && gfnTitlesFind(s_gfnTitles.pSet, platformAppId, length, hash)->length != 0;
+        answered = true;
+        s_gfnTitles.stats.numLocalLookups++;
+    }
+    else
+    {
+        s_gfnTitles.stats.numSdkLookups++;
+    }
+    gfnSdkMutexUnlock(&s_gfnTitles.lock);
+
+    return answered ? gfnSuccess : GfnIsTitleAvailable(platformAppId, isAvailable);
+}
+
+GfnRuntimeError GfnTitleCacheGetStats(GfnTitleCacheStats* pStats)
+{
+    if (!s_gfnTitles.initialized)
+    {
+        return gfnAPINotInit;
+    }
+    if (pStats == NULL)
+    {
+        return gfnInvalidParameter;
+    }
+
+    gfnSdkMutexLock(&s_gfnTitles.lock);
+    *pStats = s_gfnTitles.stats;
+    if (pStats->ready)
+    {
+        pStats->lastRefreshAgeMs = gfnSdkGetTimeMs() - s_gfnTitles.setBuiltMs;
+    }
+    gfnSdkMutexUnlock(&s_gfnTitles.lock);
+    return gfnSuccess;
+}
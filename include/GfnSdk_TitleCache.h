@@ -0,0 +1,253 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+//
+// ===============================================================================================
+//
+// Locally indexed set of the titles available in the streaming session
+//
+// ===============================================================================================
+/**
+* @file GfnSdk_TitleCache.h
+*
+* Optional local index of @ref GfnGetTitlesAvailable for @ref GfnIsTitleAvailable lookups
+*/
+///
+/// @page title_cache Title Cache
+///
+/// @section title_cache_introduction Introduction
+/// Every call to @ref GfnIsTitleAvailable is a round trip to the GeForce NOW cloud library.
+/// Launchers and storefronts that check each title they show can use the functions in this
+/// header instead:
+///
+/// - @ref GfnGetTitlesAvailable is called once, and the list it returns is parsed into an
+///   immutable open addressing hash set. @ref GfnIsTitleAvailableCached then answers from the
+///   set, without calling into the SDK.
+/// - The set is rebuilt every @ref GfnTitleCacheConfig::refreshIntervalMs in the background, and
+///   whenever @ref GfnTitleCacheRefresh is called. A new set is built on the side and replaces the
+///   old one in a single step, so lookups see either the old or the new list, never a mix.
+/// - Until a list was fetched successfully, @ref GfnIsTitleAvailableCached calls
+///   @ref GfnIsTitleAvailable, so it can be used in place of it from application start.
+///
+/// The sets can also be used directly with @ref GfnTitleSetCreate and @ref GfnTitleSetContains.
+///
+
+#ifndef __NV_GFNSDK_TITLE_CACHE_H__
+#define __NV_GFNSDK_TITLE_CACHE_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Immutable set of platform application identifiers
+typedef struct GfnTitleSet GfnTitleSet;
+
+/// @brief Configuration passed to @ref GfnTitleCacheInitialize. Zero members select the defaults.
+typedef struct GfnTitleCacheConfig
+{
+    unsigned int refreshIntervalMs;     ///< Time between background refreshes, 0 for 300000
+    bool manualRefresh;                 ///< Only refresh when @ref GfnTitleCacheRefresh is called
+} GfnTitleCacheConfig;
+
+/// @brief Statistics of the title cache. Times are in milliseconds.
+typedef struct GfnTitleCacheStats
+{
+    bool ready;                         ///< A list was fetched, and lookups are answered locally
+    unsigned int numTitles;             ///< Titles in the current set
+    unsigned int numRefreshes;          ///< Successful refreshes
+    unsigned int numRefreshFailures;
+    GfnRuntimeError lastRefreshResult;
+    uint64_t lastRefreshMs;             ///< Time to fetch and index the list in the last refresh
+    uint64_t lastRefreshAgeMs;          ///< Time since the current set was built
+    uint64_t numLocalLookups;           ///< Lookups answered from the set
+    uint64_t numSdkLookups;             ///< Lookups passed to @ref GfnIsTitleAvailable
+} GfnTitleCacheStats;
+
+///
+/// @par Description
+/// Builds a set from a comma-delimited list of platform application identifiers, as returned by
+/// @ref GfnGetTitlesAvailable. White space around identifiers, empty entries and duplicates are ignored.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pchList                    - Comma-delimited list. The set keeps a copy.
+/// @param ppSet                      - Receives the set. Release it with @ref GfnTitleSetDestroy.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - pchList or ppSet is NULL
+/// @retval gfnUnableToAllocateMemory - The set could not be allocated
+GfnRuntimeError GfnTitleSetCreate(const char* pchList, GfnTitleSet** ppSet);
+
+///
+/// @par Description
+/// Releases a set created by @ref GfnTitleSetCreate.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+void GfnTitleSetDestroy(GfnTitleSet* pSet);
+
+///
+/// @par Description
+/// Determines whether a set contains a platform application identifier, in O(1).
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// A set is never modified after it is created, so it can be read from any number of threads.
+///
+/// @retval true                      - The set contains pchPlatformAppId
+/// @retval false                     - It does not, or pSet or pchPlatformAppId is NULL
+bool GfnTitleSetContains(const GfnTitleSet* pSet, const char* pchPlatformAppId);
+
+///
+/// @par Description
+/// Returns the number of identifiers in a set.
+///
+/// @par Environment
+/// Cloud and Client
+///
+/// @par Platform
+/// Windows, Linux
+unsigned int GfnTitleSetGetCount(const GfnTitleSet* pSet);
+
+///
+/// @par Description
+/// Sets up the title cache and fetches the list of available titles.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call once after @ref GfnInitializeSdk. The cache is set up even if the first fetch fails;
+/// lookups then fall back to @ref GfnIsTitleAvailable until a later refresh succeeds.
+///
+/// @param pConfig                    - Configuration, or NULL for the defaults
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnInvalidParameter       - The cache is already set up
+/// @retval gfnUnableToAllocateMemory - The cache could not be set up
+/// @return Otherwise, the error of the first fetch, as returned by @ref GfnTitleCacheRefresh
+GfnRuntimeError GfnTitleCacheInitialize(const GfnTitleCacheConfig* pConfig);
+
+///
+/// @par Description
+/// Stops the background refresh and releases the cache.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call before @ref GfnShutdownSdk.
+void GfnTitleCacheShutdown(void);
+
+///
+/// @par Description
+/// Fetches the list of available titles with @ref GfnGetTitlesAvailable, and replaces the set
+/// used by @ref GfnIsTitleAvailableCached with it.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Call when the available titles may have changed. Blocks for the round trip to the SDK.
+/// Concurrent refreshes are performed one after the other. If the fetch fails, the current set is kept.
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnTitleCacheInitialize was not called
+/// @retval gfnUnableToAllocateMemory - The set could not be allocated
+/// @return Otherwise, the error returned by @ref GfnGetTitlesAvailable
+GfnRuntimeError GfnTitleCacheRefresh(void);
+
+///
+/// @par Description
+/// Determines if a title is available to launch in the current streaming session, like
+/// @ref GfnIsTitleAvailable, from the cached list.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @par Usage
+/// Use instead of @ref GfnIsTitleAvailable. Can be called from any thread.
+///
+/// @param platformAppId              - Identifier of the requested title to check
+/// @param isAvailable                - Receives true if the title is available, or false if not
+///
+/// @retval gfnSuccess                - If the query was successful
+/// @retval gfnInvalidParameter       - NULL pointer passed in
+/// @return Otherwise, the error returned by @ref GfnIsTitleAvailable, if the cache is not set up
+///         or no list was fetched yet
+GfnRuntimeError GfnIsTitleAvailableCached(const char* platformAppId, bool* isAvailable);
+
+///
+/// @par Description
+/// Retrieves statistics of the title cache.
+///
+/// @par Environment
+/// Cloud
+///
+/// @par Platform
+/// Windows, Linux
+///
+/// @param pStats                     - Receives the statistics
+///
+/// @retval gfnSuccess                - On success
+/// @retval gfnAPINotInit             - @ref GfnTitleCacheInitialize was not called
+/// @retval gfnInvalidParameter       - pStats is NULL
+GfnRuntimeError GfnTitleCacheGetStats(GfnTitleCacheStats* pStats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NV_GFNSDK_TITLE_CACHE_H__
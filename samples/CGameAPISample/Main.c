@@ -25,8 +25,13 @@
 //
 // Copyright (c) 2019-2021 NVIDIA Corporation. All rights reserved.
 
+#include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "SampleModule.h"
+#include "GfnSdk_InstallPrefetch.h"
+#include "GfnSdk_SavePipeline.h"
+#include "GfnSdk_Threading.h"
 
 #include "GfnCloudCheckUtils.h"
 
@@ -42,6 +47,21 @@ int g_pause_call_counter = 0;
 const char* platformAppId = "GeForce NOW SDK - Sample C App";
 const char* platformId = "GeForce NOW SDK - Sample Test Platform";
 #define CLOUD_CHECK_MIN_NONCE_SIZE 16
+#define SAVE_LOG_PATH "CGameAPISample.save"
+
+// Example game state. It is saved incrementally by the save pipeline in GfnSdk_SavePipeline.h,
+// so that the save and exit callbacks only write what changed since the last background checkpoint.
+typedef struct GameState
+{
+    unsigned int turns;
+    unsigned int score;
+    unsigned char worldFlags[256 * 1024];
+} GameState;
+
+static GameState g_gameState;
+static GfnSdkMutex g_gameStateLock;
+static GfnSaveRegionId g_gameStateRegion;
+static bool g_savePipelineStarted = false;
 
 static char getKeyPress() {
 #ifdef _WIN32
@@ -59,12 +79,99 @@ static char getKeyPress() {
 #endif
 }
 
+// Save pipeline callback: game state is only changed with this lock held
+static void GFN_CALLBACK LockGameState(bool lock, void* pContext)
+{
+    (void)pContext;
+    if (lock)
+    {
+        gfnSdkMutexLock(&g_gameStateLock);
+    }
+    else
+    {
+        gfnSdkMutexUnlock(&g_gameStateLock);
+    }
+}
+
+// Changes a little of the game state, and reports the changed bytes to the save pipeline
+static void PlayTurn()
+{
+    gfnSdkMutexLock(&g_gameStateLock);
+    g_gameState.turns++;
+    g_gameState.score += 10;
+    size_t flag = (size_t)rand() % sizeof(g_gameState.worldFlags);
+    g_gameState.worldFlags[flag] ^= 1;
+    if (g_savePipelineStarted)
+    {
+        GfnSaveMarkDirty(g_gameStateRegion, 0, offsetof(GameState, worldFlags));
+        GfnSaveMarkDirty(g_gameStateRegion, offsetof(GameState, worldFlags) + flag, 1);
+    }
+    gfnSdkMutexUnlock(&g_gameStateLock);
+    printf("Turn %u, score %u\n", g_gameState.turns, g_gameState.score);
+}
+
+// Restores the game state from the save log, then saves it incrementally in the background. The
+// pipeline registers for the save and exit callbacks, flushes the latest changes when they arrive,
+// and then calls AutoSave or ExitApp.
+static void StartSavePipeline()
+{
+    GfnSavePipelineConfig config = { 0 };
+    config.pchLogPath = SAVE_LOG_PATH;
+    config.lockState = LockGameState;
+    config.saveCallback = AutoSave;
+    config.exitCallback = ExitApp;
+
+    GfnSaveRegionDesc region = { "game state", &g_gameState, sizeof(g_gameState) };
+    GfnRuntimeError err = GfnSavePipelineInitialize(&config);
+    if (err == gfnSuccess)
+    {
+        err = GfnSaveAddRegion(&region, &g_gameStateRegion);
+    }
+    if (err == gfnSuccess)
+    {
+        err = GfnSavePipelineLoad();
+        if (err == gfnSuccess)
+        {
+            printf("Restored game state: turn %u, score %u\n", g_gameState.turns, g_gameState.score);
+        }
+        err = GfnSavePipelineStart();
+        g_savePipelineStarted = (err == gfnSuccess);
+    }
+    if (err != gfnSuccess)
+    {
+        printf("Error starting the save pipeline: %d, %s\n", err, GfnErrorToString(err));
+    }
+}
+
+// Registers the install callback through the install prefetch helper. When GeForce NOW installs the
+// title, the helper starts reading the files listed in gfn_prefetch_manifest.txt under the build
+// path into the page cache, then calls InstallApp.
+static void StartInstallPrefetch()
+{
+    GfnInstallPrefetchConfig config = { 0 };
+    config.installCallback = InstallApp;
+
+    GfnRuntimeError err = GfnInstallPrefetchInitialize(&config);
+    if (err == gfnSuccess)
+    {
+        err = GfnInstallPrefetchStart();
+    }
+    if (err != gfnSuccess)
+    {
+        printf("Error registering InstallApp callback: %d, %s\n", err, GfnErrorToString(err));
+    }
+}
+
 static void waitForSpaceBar() {
-    printf("\n\nApplication: In main application loop; Press space bar to exit...\n\n");
+    printf("\n\nApplication: In main application loop; Press space bar to exit, any other key to play a turn...\n\n");
     char c;
     do
     {
         c = getKeyPress();
+        if (c != ' ')
+        {
+            PlayTurn();
+        }
     } while (c != ' ');
 }
 
@@ -91,26 +198,15 @@ void ApplicationInitialize()
         if (bIsCloudEnvironment)
         {
             // Register any implemented callbacks capable of serving requests from the SDK.
-            err = GfnRegisterExitCallback(ExitApp, NULL);
-            if (err != gfnSuccess)
-            {
-                printf("Error registering ExitApp callback: %d, %s\n", err, GfnErrorToString(err));
-            }
+            // ExitApp and AutoSave are called by the save pipeline, after it saved the game state,
+            // and InstallApp by the install prefetch helper, after it started the prefetch.
+            StartSavePipeline();
             err = GfnRegisterPauseCallback(PauseApp, &g_pause_call_counter);
             if (err != gfnSuccess)
             {
                 printf("Error registering PauseApp callback: %d, %s\n", err, GfnErrorToString(err));
             }
-            err = GfnRegisterInstallCallback(InstallApp, NULL);
-            if (err != gfnSuccess)
-            {
-                printf("Error registering InstallApp callback: %d, %s\n", err, GfnErrorToString(err));
-            }
-            err = GfnRegisterSaveCallback(AutoSave, NULL);
-            if (err != gfnSuccess)
-            {
-                printf("Error registering AutoSave callback: %d, %s\n", err, GfnErrorToString(err));
-            }
+            StartInstallPrefetch();
             err = GfnRegisterSessionInitCallback(SessionInit, NULL);
             if (err != gfnSuccess)
             {
@@ -145,6 +241,26 @@ void ApplicationShutdown()
     // Shut down the GeForce NOW Runtime SDK. Note that it's safe to call
     // gfnShutdownRuntimeSdk even if the SDK was not initialized.
     GfnShutdownSdk();
+
+    // Once the callbacks can no longer arrive, save the last changes and stop saving
+    GfnSavePipelineStats stats;
+    if (g_savePipelineStarted && GfnSavePipelineFlush() == gfnSuccess && GfnSavePipelineGetStats(&stats) == gfnSuccess)
+    {
+        printf("Saved game state: %u background checkpoints, %u flushes, last flush %llu ms for %llu bytes, longest flush %llu ms\n",
+            stats.numCheckpoints, stats.numFlushes, (unsigned long long)stats.lastFlushMs,
+            (unsigned long long)stats.lastFlushBytes, (unsigned long long)stats.maxFlushMs);
+    }
+    GfnSavePipelineShutdown();
+
+    GfnInstallPrefetchStats prefetchStats;
+    if (GfnInstallPrefetchGetStats(&prefetchStats) == gfnSuccess && prefetchStats.started)
+    {
+        printf("Install prefetch: %u of %u files, %llu bytes in %llu ms, %u missing, %u over budget (manifest: %s)\n",
+            prefetchStats.numPrefetched, prefetchStats.numFiles, (unsigned long long)prefetchStats.bytesPrefetched,
+            (unsigned long long)prefetchStats.elapsedMs, prefetchStats.numMissing, prefetchStats.numSkipped,
+            GfnErrorToString(prefetchStats.manifestResult));
+    }
+    GfnInstallPrefetchShutdown();
 }
 
 // Example application main
@@ -152,6 +268,8 @@ int main()
 {
     GfnError err = gfnSuccess;
 
+    gfnSdkMutexInit(&g_gameStateLock);
+
     ApplicationInitialize();
 
     // Simple Cloud Check API call
@@ -332,6 +450,7 @@ int main()
     // Application Shutdown
     // It's safe to call ShutdownShieldXLinkSDK even if the SDK was not initialized.
     ApplicationShutdown();
+    gfnSdkMutexDestroy(&g_gameStateLock);
 
     return 0;
 }
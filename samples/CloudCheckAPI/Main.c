@@ -29,6 +29,8 @@
 
 // Sample will use the Helper Wrapper sources to auto-manage SDK library handling
 #include "GfnRuntimeSdk_Wrapper.h"
+#include "GfnSdk_CloudCheckCache.h"
+#include "GfnSdk_Threading.h"
 
 // Leverage the Sample Helpers for GfnCloudCheck() challenge and response data
 #include "GfnCloudCheckUtils.h"
@@ -357,6 +359,123 @@ void CheckIfAnyTypeNoChallenge()
     DoGetCloudType(CC_CLOUD_TYPE_ANY, false);
 }
 
+// Subsystem thread for CachedSecureCloudCheck(), as a game's anti-cheat or entitlement code would run
+static void CachedCloudCheckThread(void* pContext)
+{
+    const char* subsystem = (const char*)pContext;
+    bool bIsCloudEnvironment = false;
+    GfnError result = GfnCloudCheckCached(NULL, NULL, &bIsCloudEnvironment);
+    if (GFNSDK_FAILED(result))
+    {
+        printf("GfnCloudCheckCached(%s): API call returned error: %d, %s\n", subsystem, result, GfnErrorToString(result));
+    }
+    else
+    {
+        printf("GfnCloudCheckCached(%s): Application %s executing in GeForce NOW Cloud environment.\n",
+            subsystem, (bIsCloudEnvironment) ? "is" : "is not");
+    }
+}
+
+// Example method to share GfnCloudCheck() calls between subsystems with the single-flight cache from
+// GfnSdk_CloudCheckCache.h. Two subsystems check at the same time from their own threads: only one
+// call reaches the SDK, and the other waits for its result instead of risking gfnThrottled.
+void CachedSecureCloudCheck()
+{
+    printf("\n\nPerforming Shared Cloud Check via GfnCloudCheckCached from two threads at once...\n");
+
+    // Drop a result cached by an earlier run, so that both threads miss the cache and have to share a call
+    GfnCloudCheckCacheInvalidate();
+    GfnCloudCheckCacheStats before;
+    GfnCloudCheckCacheGetStats(&before);
+
+    const char* subsystems[] = { "anti-cheat", "entitlement" };
+    GfnSdkThread threads[2];
+    bool started[2] = { false, false };
+    for (int i = 0; i < 2; i++)
+    {
+        started[i] = gfnSdkThreadCreate(&threads[i], CachedCloudCheckThread, (void*)subsystems[i]);
+        if (!started[i])
+        {
+            printf("GfnCloudCheckCached: Failed to start the %s thread, calling from this thread instead.\n", subsystems[i]);
+            CachedCloudCheckThread((void*)subsystems[i]);
+        }
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if (started[i])
+        {
+            gfnSdkThreadJoin(threads[i]);
+        }
+    }
+
+    GfnCloudCheckCacheStats after;
+    GfnCloudCheckCacheGetStats(&after);
+    printf("GfnCloudCheckCached: %u SDK call(s) for 2 checks, coalesced=%u hits=%u paced=%u throttledRetries=%u\n",
+        after.misses - before.misses, after.coalesced - before.coalesced, after.hits - before.hits,
+        after.paced - before.paced, after.throttledRetries - before.throttledRetries);
+}
+
+// Example method to validate the GfnCloudCheck() response data off the calling thread, so that
+// a game thread does not hitch on the certificate chain and signature checks. The helpers copy the
+// response data, which is released right away.
+void AsyncExtendedSecureCloudCheck()
+{
+    printf("\n\nPerforming Extended Secure Cloud Check via GfnCloudCheck with asynchronous response data validation...\n");
+
+    char nonce[CLOUD_CHECK_MIN_NONCE_SIZE] = { 0 };
+    if (!GfnCloudCheckGenerateNonce(nonce, CLOUD_CHECK_MIN_NONCE_SIZE))
+    {
+        printf("GfnCloudCheckGenerateNonce failed, GfnCloudCheck() call skipped.\n");
+        return;
+    }
+
+    GfnCloudCheckChallenge challenge = { nonce, CLOUD_CHECK_MIN_NONCE_SIZE };
+    GfnCloudCheckResponse response = { NULL, 0 };
+    bool bIsCloudEnvironment = false;
+    GfnError result = GfnCloudCheck(&challenge, &response, &bIsCloudEnvironment);
+    if (GFNSDK_FAILED(result))
+    {
+        printf("GfnCloudCheck: API call returned error: %d, %s\n", result, GfnErrorToString(result));
+        printf("GfnCloudCheck: Considered not running in GFN.\n");
+        return;
+    }
+    if (!bIsCloudEnvironment || response.attestationData == NULL)
+    {
+        printf("GfnCloudCheck: Application is not executing in GeForce NOW Cloud environment, skipped response data validation.\n");
+        GfnFree(&response.attestationData);
+        return;
+    }
+
+    GfnCloudCheckAsyncVerification* verification = NULL;
+    bool queued = GfnCloudCheckVerifyAttestationDataAsync(response.attestationData, challenge.nonce, challenge.nonceSize,
+        NULL, NULL, &verification);
+    // The response data was copied, no need to keep it around
+    GfnFree(&response.attestationData);
+    if (!queued)
+    {
+        printf("GfnCloudCheck: Failed to queue response data validation. Considered not running in GFN.\n");
+        return;
+    }
+
+    // A game would keep rendering frames here and poll once per frame
+    unsigned int frames = 0;
+    GfnCloudCheckAsyncStatus status;
+    while ((status = GfnCloudCheckWaitAsyncVerification(verification, 16)) == GfnCloudCheckAsyncPending)
+    {
+        frames++;
+    }
+    GfnCloudCheckReleaseAsyncVerification(verification);
+
+    printf("GfnCloudCheck: Response data validated in the background over %u frame(s).\n", frames + 1);
+    if (status == GfnCloudCheckAsyncValid)
+    {
+        printf("GfnCloudCheck: Application is running in GeForce NOW Cloud environment with high level of confidence.\n");
+    }
+    else
+    {
+        printf("GfnCloudCheck: Response data is not valid. Considered not running in GFN.\n");
+    }
+}
 
 // Example application main
 int main()
@@ -370,6 +489,9 @@ int main()
         return -1;
     }
 
+    // Use the default cache lifetime and call pacing
+    GfnCloudCheckCacheInitialize(NULL);
+
     char c;
     do {
         printf("\n");
@@ -379,7 +501,9 @@ int main()
         printf("Press 4 to use GfnGetCloudType to check if this is a trusted game seat\n");
         printf("Press 5 to use GfnGetCloudType to check if this is an open game seat\n");
         printf("Press 6 to use GfnGetCloudType to check if this is a GFN game seat and if so, which type\n");
-        printf("Press 7 to use GfnGetCloudType without a challenge-response\n\n");
+        printf("Press 7 to use GfnGetCloudType without a challenge-response\n");
+        printf("Press 8 to use GfnCloudCheckCached to share one cloud check between two threads\n");
+        printf("Press 9 to use GfnCloudCheck to perform an extended secure cloud check validated in the background\n\n");
         printf("Press space bar to shutdown...\n");
 
         c = getKeyPress();
@@ -407,6 +531,12 @@ int main()
         case '7':
             CheckIfAnyTypeNoChallenge();
             break;
+        case '8':
+            CachedSecureCloudCheck();
+            break;
+        case '9':
+            AsyncExtendedSecureCloudCheck();
+            break;
         case ' ':
             break;
         case 0x1b: // Esc
@@ -416,6 +546,9 @@ int main()
         }
     } while (c != ' ' && c != 0x1b);
 
+    GfnCloudCheckShutdownAsyncVerification();
+    GfnCloudCheckCacheShutdown();
+
     // GFN SDK Shutdown. It's safe to call ShutdownSDK even if the SDK was not initialized.
     SDKShutdown();
 
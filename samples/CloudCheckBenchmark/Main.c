@@ -0,0 +1,1005 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+// Offline benchmark of the CloudCheck attestation verification helpers in GfnCloudCheckUtils.
+// It creates a test certificate authority, injects its root in place of the pinned GFN roots
+// (test-hooks build of the utils only), mints attestation JWTs and measures verification latency.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <openssl/crypto.h>
+
+#include "GfnCloudCheckBase64.h"
+#include "GfnCloudCheckJson.h"
+#include "GfnCloudCheckNonce.h"
+#include "GfnCloudCheckUtils.h"
+#include "TestAttestation.h"
+
+#define BENCHMARK_DEFAULT_ITERATIONS 200
+#define BENCHMARK_NONCE_SIZE 32
+#define BENCHMARK_ROOT_KEY_BITS 4096
+#define BENCHMARK_BASE64_REPETITIONS 20000
+#define BENCHMARK_BATCH_SIZE 128
+#define BENCHMARK_MIN_BATCH_ROUNDS 2
+#define BENCHMARK_JSON_REPETITIONS 200000
+#define BENCHMARK_JSON_RANDOM_MUTATIONS 20000
+#define BENCHMARK_MAX_X5C 3
+#define BENCHMARK_NONCE_COUNT 100000
+
+// OpenSSL allocations are counted through CRYPTO_set_mem_functions, helper allocations through the
+// GFN_CC_MALLOC hook counters of the test-hooks build.
+static uint64_t s_opensslAllocations = 0;
+
+static void* countingOpensslMalloc(size_t size, const char* file, int line)
+{
+    s_opensslAllocations++;
+    return malloc(size);
+}
+
+static void* countingOpensslRealloc(void* ptr, size_t size, const char* file, int line)
+{
+    s_opensslAllocations++;
+    return realloc(ptr, size);
+}
+
+static void countingOpensslFree(void* ptr, const char* file, int line)
+{
+    free(ptr);
+}
+
+static uint64_t getTimeNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int compareU64(const void* a, const void* b)
+{
+    uint64_t lhs = *(const uint64_t*)a;
+    uint64_t rhs = *(const uint64_t*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static void printLatencies(const char* label, uint64_t* samplesNs, unsigned int count)
+{
+    uint64_t total = 0;
+
+    qsort(samplesNs, count, sizeof(uint64_t), compareU64);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        total += samplesNs[i];
+    }
+    printf("%-28s mean %8.1f us  p50 %8.1f us  p90 %8.1f us  p99 %8.1f us\n", label,
+        (double)total / count / 1000.0,
+        (double)samplesNs[count / 2] / 1000.0,
+        (double)samplesNs[(count * 90) / 100] / 1000.0,
+        (double)samplesNs[(count * 99) / 100] / 1000.0);
+}
+
+// Runs `iterations` verifications of the same JWT and records each latency
+static bool runVerifications(const char* jwt, const char* nonce, unsigned int iterations, uint64_t* samplesNs)
+{
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        uint64_t start = getTimeNs();
+        if (!GfnCloudCheckVerifyAttestationData(jwt, nonce, BENCHMARK_NONCE_SIZE))
+        {
+            printf("Verification %u unexpectedly failed\n", i);
+            return false;
+        }
+        samplesNs[i] = getTimeNs() - start;
+    }
+    return true;
+}
+
+// Decodes the three base64url segments of a JWT, as the verification does
+static bool decodeJwtSegments(const char* jwt, size_t jwtLength, unsigned char* output, size_t outputCapacity)
+{
+    const char* segmentStart = jwt;
+    const char* jwtEnd = jwt + jwtLength;
+
+    while (segmentStart < jwtEnd)
+    {
+        const char* segmentEnd = memchr(segmentStart, '.', jwtEnd - segmentStart);
+        size_t decodedLength = 0;
+
+        if (segmentEnd == NULL)
+        {
+            segmentEnd = jwtEnd;
+        }
+        if (GfnBase64Decode(segmentStart, segmentEnd - segmentStart, GfnBase64AlphabetUrl,
+                output, outputCapacity, &decodedLength, NULL) != GfnBase64Success)
+        {
+            return false;
+        }
+        segmentStart = segmentEnd + 1;
+    }
+    return true;
+}
+
+static bool benchmarkBase64(const char* mintedJwt)
+{
+    static const GfnBase64Implementation implementations[] = {
+        GfnBase64ImplementationScalar, GfnBase64ImplementationSse41,
+        GfnBase64ImplementationAvx2, GfnBase64ImplementationNeon
+    };
+    // The minted JWT, plus synthetic JWT-shaped inputs at the ends of the realistic size range
+    const size_t syntheticSizes[] = { 4096, 8192 };
+    char* inputs[3] = { NULL, NULL, NULL };
+    size_t inputLengths[3] = { 0, 0, 0 };
+    unsigned char* output = NULL;
+    bool result = false;
+
+    printf("\n== Base64url decoding of JWT segments ==\n");
+
+    inputs[0] = (char*)mintedJwt;
+    inputLengths[0] = strlen(mintedJwt);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        size_t length = syntheticSizes[i];
+
+        inputs[i + 1] = malloc(length + 1);
+        if (inputs[i + 1] == NULL)
+        {
+            goto end;
+        }
+        for (size_t j = 0; j < length; ++j)
+        {
+            inputs[i + 1][j] = alphabet[rand() % 64];
+        }
+        // header.payload.signature with a 512-byte (RSA-4096) signature
+        inputs[i + 1][length / 8] = '.';
+        inputs[i + 1][length - 684] = '.';
+        inputs[i + 1][length] = '\0';
+        inputLengths[i + 1] = length;
+    }
+
+    output = malloc(GfnBase64DecodedMaxLength(8192) + 64);
+    if (output == NULL)
+    {
+        goto end;
+    }
+
+    for (size_t input = 0; input < 3; ++input)
+    {
+        for (size_t i = 0; i < sizeof(implementations) / sizeof(implementations[0]); ++i)
+        {
+            uint64_t start = 0;
+            uint64_t elapsedNs = 0;
+            char label[64];
+
+            if (!GfnBase64SetImplementation(implementations[i]))
+            {
+                continue;
+            }
+            start = getTimeNs();
+            for (unsigned int repetition = 0; repetition < BENCHMARK_BASE64_REPETITIONS; ++repetition)
+            {
+                if (!decodeJwtSegments(inputs[input], inputLengths[input], output, GfnBase64DecodedMaxLength(8192) + 64))
+                {
+                    printf("Decoding failed\n");
+                    goto end;
+                }
+            }
+            elapsedNs = getTimeNs() - start;
+            snprintf(label, sizeof(label), "%s JWT %zu bytes, %s", input == 0 ? "minted" : "synthetic",
+                inputLengths[input], GfnBase64GetImplementationName());
+            printf("%-40s %8.1f ns/JWT  %8.1f MB/s\n", label,
+                (double)elapsedNs / BENCHMARK_BASE64_REPETITIONS,
+                (double)inputLengths[input] * BENCHMARK_BASE64_REPETITIONS * 1000.0 / (double)elapsedNs);
+        }
+    }
+    result = true;
+
+end:
+    GfnBase64SetImplementation(GfnBase64ImplementationAuto);
+    free(inputs[1]);
+    free(inputs[2]);
+    free(output);
+    return result;
+}
+
+// Reference copy of the strchr/strstr style JWT parsing the utils used before the JSON tokenizer:
+// each key is the first match anywhere in the data, and its value runs to the next quote.
+static const char* legacyFindString(const char* start, const char* end, const char* needle)
+{
+    size_t needleLength = strlen(needle);
+
+    while (start < end && (start = memchr(start, needle[0], end - start)) != NULL)
+    {
+        if ((size_t)(end - start) < needleLength)
+        {
+            return NULL;
+        }
+        if (memcmp(start, needle, needleLength) == 0)
+        {
+            return start;
+        }
+        ++start;
+    }
+    return NULL;
+}
+
+static const char* legacyFindChar(const char* start, const char* end, char c)
+{
+    return start < end ? memchr(start, c, end - start) : NULL;
+}
+
+static bool legacyFindStringValue(const char* start, const char* end, const char* quotedKey, GfnJsonStringView* value)
+{
+    const char* key = legacyFindString(start, end, quotedKey);
+    const char* colon = key != NULL ? legacyFindChar(key, end, ':') : NULL;
+    const char* valueStart = colon != NULL ? legacyFindChar(colon + 1, end, '"') : NULL;
+    const char* valueEnd = valueStart != NULL ? legacyFindChar(valueStart + 1, end, '"') : NULL;
+
+    if (valueEnd == NULL)
+    {
+        return false;
+    }
+    value->data = valueStart + 1;
+    value->length = valueEnd - (valueStart + 1);
+    value->escaped = false;
+    return true;
+}
+
+static bool legacyParseHeader(const char* header, size_t length, GfnJsonStringView* alg, GfnJsonStringView* x5c, unsigned int* numX5c)
+{
+    const char* end = header + length;
+    const char* x5cKey = NULL;
+    const char* colon = NULL;
+    const char* x5cStart = NULL;
+    const char* x5cEnd = NULL;
+    const char* cert = NULL;
+
+    *numX5c = 0;
+    if (legacyFindChar(header, end, '{') == NULL || legacyFindChar(header, end, '}') == NULL ||
+        !legacyFindStringValue(header, end, "\"alg\"", alg))
+    {
+        return false;
+    }
+    if ((x5cKey = legacyFindString(header, end, "\"x5c\"")) == NULL ||
+        (colon = legacyFindChar(x5cKey, end, ':')) == NULL ||
+        (x5cStart = legacyFindChar(colon + 1, end, '[')) == NULL ||
+        (x5cEnd = legacyFindChar(x5cStart + 1, end, ']')) == NULL)
+    {
+        return false;
+    }
+    cert = x5cStart + 1;
+    while ((cert = legacyFindChar(cert, x5cEnd, '"')) != NULL)
+    {
+        const char* certEnd = legacyFindChar(cert + 1, x5cEnd, '"');
+        if (certEnd == NULL || *numX5c >= BENCHMARK_MAX_X5C)
+        {
+            return false;
+        }
+        x5c[*numX5c].data = cert + 1;
+        x5c[*numX5c].length = certEnd - (cert + 1);
+        x5c[*numX5c].escaped = false;
+        ++*numX5c;
+        cert = certEnd + 1;
+    }
+    return true;
+}
+
+static bool legacyParsePayload(const char* payload, size_t length, GfnJsonStringView* nonce)
+{
+    const char* end = payload + length;
+
+    return legacyFindChar(payload, end, '{') != NULL && legacyFindChar(payload, end, '}') != NULL &&
+        (legacyFindStringValue(payload, end, "\"nonce\"", nonce) || legacyFindStringValue(payload, end, "\"ononce\"", nonce));
+}
+
+static bool tokenizerParseHeader(const char* header, size_t length, GfnJsonStringView* alg, GfnJsonStringView* x5c, unsigned int* numX5c)
+{
+    return GfnJsonParseJwtHeader(header, length, alg, x5c, BENCHMARK_MAX_X5C, numX5c, NULL) == GfnJsonJwtSuccess;
+}
+
+static bool tokenizerParsePayload(const char* payload, size_t length, GfnJsonStringView* nonce)
+{
+    return GfnJsonParseJwtPayload(payload, length, nonce, NULL) == GfnJsonJwtSuccess;
+}
+
+// Returns the decoded header or payload (segment 0 or 1) of a JWT, NUL-terminated for printing
+static char* decodeJwtSegment(const char* jwt, unsigned int segment, size_t* length)
+{
+    const char* start = jwt;
+    const char* end = NULL;
+    char* decoded = NULL;
+
+    for (unsigned int i = 0; i < segment; ++i)
+    {
+        start = strchr(start, '.') + 1;
+    }
+    end = strchr(start, '.');
+    decoded = malloc(GfnBase64DecodedMaxLength(end - start) + 1);
+    if (decoded == NULL ||
+        GfnBase64Decode(start, end - start, GfnBase64AlphabetUrl, (unsigned char*)decoded,
+            GfnBase64DecodedMaxLength(end - start), length, NULL) != GfnBase64Success)
+    {
+        free(decoded);
+        return NULL;
+    }
+    decoded[*length] = '\0';
+    return decoded;
+}
+
+// Reads a seed input of the JSON section, NUL-terminated for printing
+static char* readSeedFile(const char* name, size_t* length)
+{
+    char path[1024];
+    FILE* file = NULL;
+    char* data = NULL;
+    long size = 0;
+
+    snprintf(path, sizeof(path), "%s/%s", GFN_CC_BENCHMARK_SEED_DIR, name);
+    file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0 &&
+        (data = malloc((size_t)size + 1)) != NULL)
+    {
+        *length = fread(data, 1, (size_t)size, file);
+        data[*length] = '\0';
+    }
+    fclose(file);
+    return data;
+}
+
+static void printParsedAlg(const char* label, bool accepted, const GfnJsonStringView* alg)
+{
+    if (accepted)
+    {
+        printf("    %-10s accepted, alg \"%.*s\"\n", label, (int)alg->length, alg->data);
+    }
+    else
+    {
+        printf("    %-10s rejected\n", label);
+    }
+}
+
+// Mutates a copy of the data: truncation, single byte replacement, or (seeded) random multi-byte edits.
+// Returns the number of cases the tokenizer rejected; every truncation must be rejected.
+static bool runJsonMutationSweep(const char* label, const char* data, size_t length, bool isHeader)
+{
+    static const char replacements[] = { '"', '{', '}', '[', ']', ':', ',', '\\', ' ', '0', 'x', '\0', '\x1f', '\x80', '\xff' };
+    char* mutated = malloc(length);
+    GfnJsonStringView views[BENCHMARK_MAX_X5C];
+    GfnJsonStringView value;
+    unsigned int numX5c = 0;
+    unsigned int seed = 0x9e3779b9u;
+    size_t cases = 0;
+    size_t rejected = 0;
+    size_t legacyRejected = 0;
+    bool result = true;
+
+    if (mutated == NULL)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        memcpy(mutated, data, i);
+        if (isHeader ? tokenizerParseHeader(mutated, i, &value, views, &numX5c) : tokenizerParsePayload(mutated, i, &value))
+        {
+            printf("    truncation to %zu bytes unexpectedly accepted\n", i);
+            result = false;
+        }
+    }
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        for (size_t r = 0; r < sizeof(replacements); ++r)
+        {
+            if (data[i] == replacements[r])
+            {
+                continue;
+            }
+            memcpy(mutated, data, length);
+            mutated[i] = replacements[r];
+            ++cases;
+            rejected += !(isHeader ? tokenizerParseHeader(mutated, length, &value, views, &numX5c) : tokenizerParsePayload(mutated, length, &value));
+            legacyRejected += !(isHeader ? legacyParseHeader(mutated, length, &value, views, &numX5c) : legacyParsePayload(mutated, length, &value));
+        }
+    }
+
+    for (unsigned int round = 0; round < BENCHMARK_JSON_RANDOM_MUTATIONS; ++round)
+    {
+        unsigned int edits = 0;
+
+        memcpy(mutated, data, length);
+        seed = seed * 1103515245u + 12345u;
+        edits = 1 + (seed >> 16) % 4;
+        for (unsigned int e = 0; e < edits; ++e)
+        {
+            seed = seed * 1103515245u + 12345u;
+            mutated[(seed >> 8) % length] = replacements[(seed >> 20) % sizeof(replacements)];
+        }
+        ++cases;
+        rejected += !(isHeader ? tokenizerParseHeader(mutated, length, &value, views, &numX5c) : tokenizerParsePayload(mutated, length, &value));
+        legacyRejected += !(isHeader ? legacyParseHeader(mutated, length, &value, views, &numX5c) : legacyParsePayload(mutated, length, &value));
+    }
+
+    printf("    %-8s %zu truncations rejected, %zu mutations: tokenizer rejected %zu, legacy rejected %zu\n",
+        label, length, cases, rejected, legacyRejected);
+    free(mutated);
+    return result;
+}
+
+static bool benchmarkJson(const char* mintedJwt)
+{
+    // Inputs the legacy parser misreads: trailing data, a nested alg shadowing the top-level one,
+    // a key hidden in a string value, duplicate members and a raw control character in a string
+    static const char* const adversarialHeaders[] = {
+        "{\"alg\":\"RS512\",\"x5c\":[\"AAAA\"]} trailing",
+        "{\"crit\":{\"alg\":\"RS512\"},\"alg\":\"none\",\"x5c\":[\"AAAA\"]}",
+        "{\"kid\":\"\\\"alg\",\"typ\":\"RS512\",\"alg\":\"none\",\"x5c\":[\"AAAA\"]}",
+        "{\"alg\":\"RS512\",\"alg\":\"none\",\"x5c\":[\"AAAA\"]}",
+        "{\"alg\":\"RS512\",\"x5c\":[\"AA\tAA\"]}",
+    };
+    char* header = NULL;
+    char* payload = NULL;
+    size_t headerLength = 0;
+    size_t payloadLength = 0;
+    GfnJsonStringView alg;
+    GfnJsonStringView x5c[BENCHMARK_MAX_X5C];
+    GfnJsonStringView nonce;
+    unsigned int numX5c = 0;
+    bool result = false;
+
+    printf("\n== JSON parsing of the JWT header and payload ==\n");
+
+    // The committed seeds keep timings and mutation counts comparable between runs; the minted JWT
+    // differs on every run
+    header = readSeedFile("JwtHeader.json", &headerLength);
+    payload = readSeedFile("JwtPayload.json", &payloadLength);
+    if (header != NULL && payload != NULL)
+    {
+        printf("Seed inputs: %s\n", GFN_CC_BENCHMARK_SEED_DIR);
+    }
+    else
+    {
+        printf("Seed inputs not found in %s, using the minted JWT\n", GFN_CC_BENCHMARK_SEED_DIR);
+        free(header);
+        free(payload);
+        header = decodeJwtSegment(mintedJwt, 0, &headerLength);
+        payload = decodeJwtSegment(mintedJwt, 1, &payloadLength);
+        if (header == NULL || payload == NULL)
+        {
+            printf("Failed to decode the minted JWT\n");
+            goto end;
+        }
+    }
+
+    for (int parser = 0; parser < 2; ++parser)
+    {
+        uint64_t start = getTimeNs();
+        uint64_t elapsedNs = 0;
+
+        for (unsigned int repetition = 0; repetition < BENCHMARK_JSON_REPETITIONS; ++repetition)
+        {
+            bool parsed = parser == 0 ?
+                legacyParseHeader(header, headerLength, &alg, x5c, &numX5c) && legacyParsePayload(payload, payloadLength, &nonce) :
+                tokenizerParseHeader(header, headerLength, &alg, x5c, &numX5c) && tokenizerParsePayload(payload, payloadLength, &nonce);
+            if (!parsed || numX5c != 2)
+            {
+                printf("Parsing the JWT header and payload failed\n");
+                goto end;
+            }
+        }
+        elapsedNs = getTimeNs() - start;
+        printf("%-28s %8.1f ns/JWT  %8.1f MB/s  (%zu bytes of JSON)\n", parser == 0 ? "legacy strstr parser" : "streaming tokenizer",
+            (double)elapsedNs / BENCHMARK_JSON_REPETITIONS,
+            (double)(headerLength + payloadLength) * BENCHMARK_JSON_REPETITIONS * 1000.0 / (double)elapsedNs,
+            headerLength + payloadLength);
+    }
+
+    printf("Adversarial headers:\n");
+    for (size_t i = 0; i < sizeof(adversarialHeaders) / sizeof(adversarialHeaders[0]); ++i)
+    {
+        const char* input = adversarialHeaders[i];
+        printf("  %s\n", input);
+        printParsedAlg("legacy", legacyParseHeader(input, strlen(input), &alg, x5c, &numX5c), &alg);
+        printParsedAlg("tokenizer", tokenizerParseHeader(input, strlen(input), &alg, x5c, &numX5c), &alg);
+    }
+
+    printf("Mutation sweep of the header and payload:\n");
+    result = runJsonMutationSweep("header", header, headerLength, true) &&
+        runJsonMutationSweep("payload", payload, payloadLength, false);
+
+end:
+    free(header);
+    free(payload);
+    return result;
+}
+
+static bool benchmarkAllocations(const char* jwt, const char* nonce, unsigned int iterations, uint64_t* samplesNs)
+{
+    GfnCloudCheckAllocationStats before = { 0 };
+    GfnCloudCheckAllocationStats after = { 0 };
+    uint64_t opensslBefore = 0;
+
+    printf("\n== Allocations per verification (chain cache disabled) ==\n");
+
+    GfnCloudCheckSetChainCacheTtl(0);
+    GfnCloudCheckGetTestAllocationStats(&before);
+    opensslBefore = s_opensslAllocations;
+    if (!runVerifications(jwt, nonce, iterations, samplesNs))
+    {
+        return false;
+    }
+    GfnCloudCheckGetTestAllocationStats(&after);
+    printLatencies("full verification", samplesNs, iterations);
+    printf("helper allocations: %.1f (%.0f bytes), OpenSSL allocations: %.1f\n",
+        (double)(after.allocations - before.allocations) / iterations,
+        (double)(after.bytes - before.bytes) / iterations,
+        (double)(s_opensslAllocations - opensslBefore) / iterations);
+    return true;
+}
+
+// The helpers log every rejection; keep that out of the report while timing the invalid cases
+static int silenceStdout(void)
+{
+    int saved = -1;
+    int devNull = open("/dev/null", O_WRONLY);
+
+    fflush(stdout);
+    if (devNull >= 0)
+    {
+        saved = dup(STDOUT_FILENO);
+        dup2(devNull, STDOUT_FILENO);
+        close(devNull);
+    }
+    return saved;
+}
+
+static void restoreStdout(int saved)
+{
+    fflush(stdout);
+    if (saved >= 0)
+    {
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+    }
+}
+
+// Verifies each test case `iterations` times without the chain cache and checks the outcome
+static bool benchmarkCases(const TestAttestationAuthority* authority, unsigned int iterations, uint64_t* samplesNs)
+{
+    char nonce[BENCHMARK_NONCE_SIZE];
+    bool result = true;
+
+    printf("\n== Verification by test case (chain cache disabled) ==\n");
+
+    GfnCloudCheckSetChainCacheTtl(0);
+    for (int testCase = 0; testCase < TestAttestationCaseCount && result; ++testCase)
+    {
+        bool expected = testCase == TestAttestationCaseValid;
+        GfnCloudCheckAllocationStats before = { 0 };
+        GfnCloudCheckAllocationStats after = { 0 };
+        uint64_t opensslBefore = 0;
+        unsigned int mismatches = 0;
+        char* jwt = NULL;
+        int savedStdout = -1;
+
+        if (!GfnCloudCheckGenerateNonce(nonce, sizeof(nonce)) ||
+            (jwt = TestAttestationMintCase(authority, (TestAttestationCase)testCase, nonce, sizeof(nonce))) == NULL)
+        {
+            printf("Failed to mint the %s case\n", TestAttestationCaseName((TestAttestationCase)testCase));
+            return false;
+        }
+
+        GfnCloudCheckGetTestAllocationStats(&before);
+        opensslBefore = s_opensslAllocations;
+        savedStdout = expected ? -1 : silenceStdout();
+        for (unsigned int i = 0; i < iterations; ++i)
+        {
+            uint64_t start = getTimeNs();
+            mismatches += GfnCloudCheckVerifyAttestationData(jwt, nonce, sizeof(nonce)) != expected;
+            samplesNs[i] = getTimeNs() - start;
+        }
+        restoreStdout(savedStdout);
+        GfnCloudCheckGetTestAllocationStats(&after);
+
+        printLatencies(TestAttestationCaseName((TestAttestationCase)testCase), samplesNs, iterations);
+        printf("%-28s %s, helper allocations: %.1f, OpenSSL allocations: %.1f\n", "",
+            expected ? "accepted" : "rejected",
+            (double)(after.allocations - before.allocations) / iterations,
+            (double)(s_opensslAllocations - opensslBefore) / iterations);
+        if (mismatches != 0)
+        {
+            printf("%u verifications of the %s case returned %s\n", mismatches,
+                TestAttestationCaseName((TestAttestationCase)testCase), expected ? "false" : "true");
+            result = false;
+        }
+        free(jwt);
+    }
+    return result;
+}
+
+static bool benchmarkChainCache(const char* jwt, const char* nonce, unsigned int iterations, uint64_t* samplesNs)
+{
+    GfnCloudCheckChainCacheStats before = { 0 };
+    GfnCloudCheckChainCacheStats after = { 0 };
+
+    printf("\n== Verified certificate-chain cache ==\n");
+
+    GfnCloudCheckSetChainCacheTtl(0);
+    if (!runVerifications(jwt, nonce, iterations, samplesNs))
+    {
+        return false;
+    }
+    printLatencies("full chain validation", samplesNs, iterations);
+
+    GfnCloudCheckSetChainCacheTtl(3600);
+    GfnCloudCheckGetChainCacheStats(&before);
+    if (!runVerifications(jwt, nonce, iterations, samplesNs))
+    {
+        return false;
+    }
+    GfnCloudCheckGetChainCacheStats(&after);
+    printLatencies("cached chain", samplesNs, iterations);
+    printf("chain cache hits: %llu, misses: %llu\n",
+        (unsigned long long)(after.hits - before.hits), (unsigned long long)(after.misses - before.misses));
+    return true;
+}
+
+// Verifies `rounds` batches of minted JWTs on `workers` workers and reports the throughput
+static bool runBatchRounds(const char* const* jwts, const char* const* nonces, bool* results, unsigned int workers, unsigned int rounds)
+{
+    uint64_t start = 0;
+    double seconds = 0.0;
+    double perSecond = 0.0;
+
+    GfnCloudCheckShutdownBatchVerification();
+    if (!GfnCloudCheckInitializeBatchVerification(workers))
+    {
+        printf("Failed to start %u batch workers\n", workers);
+        return false;
+    }
+
+    // Warm-up: sizes the scratch buffers and fills the chain caches of the workers
+    if (!GfnCloudCheckVerifyAttestationBatch(jwts, nonces, BENCHMARK_NONCE_SIZE, results, BENCHMARK_BATCH_SIZE))
+    {
+        return false;
+    }
+
+    start = getTimeNs();
+    for (unsigned int round = 0; round < rounds; ++round)
+    {
+        if (!GfnCloudCheckVerifyAttestationBatch(jwts, nonces, BENCHMARK_NONCE_SIZE, results, BENCHMARK_BATCH_SIZE))
+        {
+            return false;
+        }
+    }
+    seconds = (double)(getTimeNs() - start) / 1e9;
+
+    for (unsigned int i = 0; i < BENCHMARK_BATCH_SIZE; ++i)
+    {
+        if (!results[i])
+        {
+            printf("Batch item %u unexpectedly failed\n", i);
+            return false;
+        }
+    }
+
+    perSecond = (double)BENCHMARK_BATCH_SIZE * rounds / seconds;
+    printf("%2u workers %10.0f verifications/s %8.0f verifications/s per core\n", workers, perSecond, perSecond / workers);
+    return true;
+}
+
+static bool benchmarkBatch(const TestAttestationAuthority* authority, unsigned int iterations)
+{
+    char* jwts[BENCHMARK_BATCH_SIZE] = { NULL };
+    char nonces[BENCHMARK_BATCH_SIZE][BENCHMARK_NONCE_SIZE];
+    const char* nonceViews[BENCHMARK_BATCH_SIZE];
+    bool results[BENCHMARK_BATCH_SIZE];
+    long onlineCpus = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int rounds = (iterations + BENCHMARK_BATCH_SIZE - 1) / BENCHMARK_BATCH_SIZE;
+    bool result = false;
+
+    printf("\n== Batch verification, %u JWTs per batch sharing one chain ==\n", BENCHMARK_BATCH_SIZE);
+
+    if (rounds < BENCHMARK_MIN_BATCH_ROUNDS)
+    {
+        rounds = BENCHMARK_MIN_BATCH_ROUNDS;
+    }
+    if (onlineCpus < 1)
+    {
+        onlineCpus = 1;
+    }
+
+    for (unsigned int i = 0; i < BENCHMARK_BATCH_SIZE; ++i)
+    {
+        if (!GfnCloudCheckGenerateNonce(nonces[i], BENCHMARK_NONCE_SIZE))
+        {
+            goto end;
+        }
+        jwts[i] = TestAttestationMintJwt(authority, nonces[i], BENCHMARK_NONCE_SIZE);
+        if (jwts[i] == NULL)
+        {
+            printf("Failed to mint batch JWTs\n");
+            goto end;
+        }
+        nonceViews[i] = nonces[i];
+    }
+
+    // A wrong nonce must only fail its own item
+    nonces[1][0] ^= 1;
+    if (!GfnCloudCheckVerifyAttestationBatch((const char* const*)jwts, nonceViews, BENCHMARK_NONCE_SIZE, results, BENCHMARK_BATCH_SIZE) ||
+        !results[0] || results[1] || !results[2])
+    {
+        printf("Batch results do not match the expected results\n");
+        goto end;
+    }
+    nonces[1][0] ^= 1;
+
+    for (unsigned int workers = 1; workers <= (unsigned int)onlineCpus; workers *= 2)
+    {
+        if (!runBatchRounds((const char* const*)jwts, nonceViews, results, workers, rounds))
+        {
+            goto end;
+        }
+    }
+    if (((unsigned int)onlineCpus & ((unsigned int)onlineCpus - 1)) != 0 &&
+        !runBatchRounds((const char* const*)jwts, nonceViews, results, (unsigned int)onlineCpus, rounds))
+    {
+        goto end;
+    }
+    result = true;
+
+end:
+    GfnCloudCheckShutdownBatchVerification();
+    for (unsigned int i = 0; i < BENCHMARK_BATCH_SIZE; ++i)
+    {
+        free(jwts[i]);
+    }
+    return result;
+}
+
+static const char* nonceStatusName(GfnCloudCheckNonceStatus status)
+{
+    switch (status)
+    {
+    case GfnCloudCheckNonceValid: return "valid";
+    case GfnCloudCheckNonceUnknown: return "unknown";
+    case GfnCloudCheckNonceExpired: return "expired";
+    case GfnCloudCheckNonceAttestationInvalid: return "attestation invalid";
+    default: return "?";
+    }
+}
+
+static bool benchmarkNonces(const TestAttestationAuthority* authority)
+{
+    GfnCloudCheckNonceManagerConfig config = { BENCHMARK_NONCE_SIZE, BENCHMARK_NONCE_COUNT, 0, 0 };
+    GfnCloudCheckNonceManagerConfig shortLived = { BENCHMARK_NONCE_SIZE, 16, 1, 0 };
+    GfnCloudCheckNonceManager* manager = NULL;
+    GfnCloudCheckNonceManagerStats stats;
+    char* nonces = NULL;
+    char* jwt = NULL;
+    uint64_t start = 0;
+    uint64_t verifyNs = 0;
+    uint64_t replayNs = 0;
+    GfnCloudCheckNonceStatus status = GfnCloudCheckNonceValid;
+    GfnCloudCheckNonceStatus replayStatus = GfnCloudCheckNonceValid;
+    bool result = false;
+
+    printf("\n== Nonce manager ==\n");
+
+    nonces = malloc((size_t)BENCHMARK_NONCE_COUNT * BENCHMARK_NONCE_SIZE);
+    manager = GfnCloudCheckNonceManagerCreate(&config);
+    if (nonces == NULL || manager == NULL)
+    {
+        printf("Failed to create the nonce manager\n");
+        goto end;
+    }
+
+    start = getTimeNs();
+    for (unsigned int i = 0; i < BENCHMARK_NONCE_COUNT; ++i)
+    {
+        if (!GfnCloudCheckGenerateNonce(nonces + (size_t)i * BENCHMARK_NONCE_SIZE, BENCHMARK_NONCE_SIZE))
+        {
+            goto end;
+        }
+    }
+    printf("%-36s %8.1f ns/nonce\n", "GfnCloudCheckGenerateNonce", (double)(getTimeNs() - start) / BENCHMARK_NONCE_COUNT);
+
+    start = getTimeNs();
+    for (unsigned int i = 0; i < BENCHMARK_NONCE_COUNT; ++i)
+    {
+        if (!GfnCloudCheckNonceManagerIssue(manager, nonces + (size_t)i * BENCHMARK_NONCE_SIZE))
+        {
+            printf("Issuing nonce %u failed\n", i);
+            goto end;
+        }
+    }
+    GfnCloudCheckNonceManagerGetStats(manager, &stats);
+    printf("%-36s %8.1f ns/nonce  (%llu RNG calls for %u nonces)\n", "issue (prefetched, registered)",
+        (double)(getTimeNs() - start) / BENCHMARK_NONCE_COUNT, (unsigned long long)stats.refills, BENCHMARK_NONCE_COUNT);
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        GfnCloudCheckNonceStatus expected = pass == 0 ? GfnCloudCheckNonceValid : GfnCloudCheckNonceUnknown;
+
+        start = getTimeNs();
+        for (unsigned int i = 0; i < BENCHMARK_NONCE_COUNT; ++i)
+        {
+            if (GfnCloudCheckNonceManagerConsume(manager, nonces + (size_t)i * BENCHMARK_NONCE_SIZE) != expected)
+            {
+                printf("Consuming nonce %u did not return %s\n", i, nonceStatusName(expected));
+                goto end;
+            }
+        }
+        printf("%-36s %8.1f ns/nonce\n", pass == 0 ? "consume outstanding" : "consume replayed (rejected)",
+            (double)(getTimeNs() - start) / BENCHMARK_NONCE_COUNT);
+    }
+
+    // End to end: a replayed attestation is rejected before any parsing or cryptography
+    if (!GfnCloudCheckNonceManagerIssue(manager, nonces) ||
+        (jwt = TestAttestationMintJwt(authority, nonces, BENCHMARK_NONCE_SIZE)) == NULL)
+    {
+        goto end;
+    }
+    start = getTimeNs();
+    status = GfnCloudCheckNonceManagerVerifyAttestation(manager, NULL, jwt, nonces);
+    verifyNs = getTimeNs() - start;
+    start = getTimeNs();
+    replayStatus = GfnCloudCheckNonceManagerVerifyAttestation(manager, NULL, jwt, nonces);
+    replayNs = getTimeNs() - start;
+    printf("first verification: %s in %.1f us, replay: %s in %.1f us\n", nonceStatusName(status), verifyNs / 1000.0,
+        nonceStatusName(replayStatus), replayNs / 1000.0);
+    if (status != GfnCloudCheckNonceValid || replayStatus != GfnCloudCheckNonceUnknown)
+    {
+        goto end;
+    }
+    GfnCloudCheckNonceManagerDestroy(manager);
+
+    // Expiry: a full set of short-lived nonces frees up once they expire
+    manager = GfnCloudCheckNonceManagerCreate(&shortLived);
+    if (manager == NULL)
+    {
+        goto end;
+    }
+    for (unsigned int i = 0; i < shortLived.capacity; ++i)
+    {
+        if (!GfnCloudCheckNonceManagerIssue(manager, nonces + (size_t)i * BENCHMARK_NONCE_SIZE))
+        {
+            goto end;
+        }
+    }
+    usleep(5000);
+    status = GfnCloudCheckNonceManagerConsume(manager, nonces);
+    // The second issue finds the set full again and purges the remaining expired nonces
+    if (status != GfnCloudCheckNonceExpired ||
+        !GfnCloudCheckNonceManagerIssue(manager, nonces + (size_t)shortLived.capacity * BENCHMARK_NONCE_SIZE) ||
+        !GfnCloudCheckNonceManagerIssue(manager, nonces + (size_t)(shortLived.capacity + 1) * BENCHMARK_NONCE_SIZE))
+    {
+        printf("Expired nonce handling failed: %s\n", nonceStatusName(status));
+        goto end;
+    }
+    GfnCloudCheckNonceManagerGetStats(manager, &stats);
+    printf("short-lived set: late consume %s, %llu expired, %u outstanding after 2 more issues\n", nonceStatusName(status),
+        (unsigned long long)stats.expired, stats.outstanding);
+    result = true;
+
+end:
+    GfnCloudCheckNonceManagerDestroy(manager);
+    free(nonces);
+    free(jwt);
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    TestAttestationAuthority authority;
+    char nonce[BENCHMARK_NONCE_SIZE];
+    char* jwt = NULL;
+    uint64_t* samplesNs = NULL;
+    unsigned int iterations = BENCHMARK_DEFAULT_ITERATIONS;
+    int exitCode = 1;
+
+    if (argc > 1)
+    {
+        iterations = (unsigned int)strtoul(argv[1], NULL, 10);
+        if (iterations == 0)
+        {
+            printf("Usage: %s [iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Must happen before OpenSSL allocates anything
+    if (CRYPTO_set_mem_functions(countingOpensslMalloc, countingOpensslRealloc, countingOpensslFree) == 0)
+    {
+        printf("Warning: OpenSSL allocations will not be counted\n");
+    }
+
+#if defined(__GNUC__) && !defined(__OPTIMIZE__)
+    printf("Warning: unoptimized build, configure with -DCMAKE_BUILD_TYPE=Release for representative numbers\n");
+#endif
+
+    printf("Generating test certificate authority...\n");
+    if (!TestAttestationCreateAuthority(&authority, BENCHMARK_ROOT_KEY_BITS))
+    {
+        return 1;
+    }
+
+    if (!GfnCloudCheckSetTestRootCertificates(authority.rootPem, NULL))
+    {
+        goto end;
+    }
+
+    if (!GfnCloudCheckGenerateNonce(nonce, sizeof(nonce)))
+    {
+        goto end;
+    }
+    jwt = TestAttestationMintJwt(&authority, nonce, sizeof(nonce));
+    samplesNs = malloc(sizeof(uint64_t) * iterations);
+    if (jwt == NULL || samplesNs == NULL)
+    {
+        printf("Failed to prepare benchmark data\n");
+        goto end;
+    }
+    printf("JWT size: %zu bytes, iterations: %u\n", strlen(jwt), iterations);
+
+    // Warm-up: loads the test root and sizes the per-thread scratch buffer
+    if (!GfnCloudCheckVerifyAttestationData(jwt, nonce, sizeof(nonce)))
+    {
+        printf("Verification of the minted JWT failed\n");
+        goto end;
+    }
+
+    if (!benchmarkBase64(jwt) ||
+        !benchmarkJson(jwt) ||
+        !benchmarkAllocations(jwt, nonce, iterations, samplesNs) ||
+        !benchmarkCases(&authority, iterations, samplesNs) ||
+        !benchmarkChainCache(jwt, nonce, iterations, samplesNs) ||
+        !benchmarkBatch(&authority, iterations) ||
+        !benchmarkNonces(&authority))
+    {
+        goto end;
+    }
+
+    exitCode = 0;
+
+end:
+    free(samplesNs);
+    free(jwt);
+    TestAttestationDestroyAuthority(&authority);
+    return exitCode;
+}
@@ -0,0 +1,453 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/x509v3.h>
+
+#include "TestAttestation.h"
+
+#define TEST_CERT_VALIDITY_SECONDS  (365L * 24 * 60 * 60)
+#define TEST_LEAF_KEY_BITS  2048
+#define TEST_INTERMEDIATE_KEY_BITS  4096
+#define TEST_MAX_CHAIN_LENGTH  4
+
+static bool AddExtension(X509* cert, X509* issuer, int nid, const char* value)
+{
+    X509V3_CTX ctx;
+    X509_EXTENSION* extension = NULL;
+    bool result = false;
+
+    X509V3_set_ctx(&ctx, issuer, cert, NULL, NULL, 0);
+    extension = X509V3_EXT_conf_nid(NULL, &ctx, nid, value);
+    if (extension != NULL && X509_add_ext(cert, extension, -1) == 1)
+    {
+        result = true;
+    }
+    X509_EXTENSION_free(extension);
+    return result;
+}
+
+// The certificate is valid from notBeforeOffset to notAfterOffset seconds relative to now
+static X509* CreateCertificate(const char* commonName, long serial, EVP_PKEY* subjectKey,
+    X509* issuerCert, EVP_PKEY* issuerKey, bool isCa, long notBeforeOffset, long notAfterOffset)
+{
+    X509* cert = NULL;
+    X509_NAME* name = NULL;
+
+    cert = X509_new();
+    if (cert == NULL)
+    {
+        return NULL;
+    }
+
+    name = X509_get_subject_name(cert);
+    if (X509_set_version(cert, 2) == 0 ||
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), serial) == 0 ||
+        X509_gmtime_adj(X509_getm_notBefore(cert), notBeforeOffset) == NULL ||
+        X509_gmtime_adj(X509_getm_notAfter(cert), notAfterOffset) == NULL ||
+        X509_set_pubkey(cert, subjectKey) == 0 ||
+        X509_NAME_add_entry_by_txt(name, "C", MBSTRING_ASC, (const unsigned char*)"US", -1, -1, 0) == 0 ||
+        X509_NAME_add_entry_by_txt(name, "O", MBSTRING_ASC, (const unsigned char*)"GFN SDK Test", -1, -1, 0) == 0 ||
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)commonName, -1, -1, 0) == 0)
+    {
+        goto fail;
+    }
+
+    // Self-signed when no issuer is given
+    if (issuerCert == NULL)
+    {
+        issuerCert = cert;
+        issuerKey = subjectKey;
+    }
+    if (X509_set_issuer_name(cert, X509_get_subject_name(issuerCert)) == 0)
+    {
+        goto fail;
+    }
+
+    if (!AddExtension(cert, issuerCert, NID_subject_key_identifier, "hash") ||
+        !AddExtension(cert, issuerCert, NID_authority_key_identifier, "keyid:always"))
+    {
+        goto fail;
+    }
+
+    if (isCa)
+    {
+        if (!AddExtension(cert, issuerCert, NID_basic_constraints, "critical,CA:TRUE") ||
+            !AddExtension(cert, issuerCert, NID_key_usage, "critical,keyCertSign,cRLSign"))
+        {
+            goto fail;
+        }
+    }
+    else
+    {
+        if (!AddExtension(cert, issuerCert, NID_basic_constraints, "critical,CA:FALSE") ||
+            !AddExtension(cert, issuerCert, NID_key_usage, "critical,digitalSignature") ||
+            !AddExtension(cert, issuerCert, NID_ext_key_usage, "serverAuth"))
+        {
+            goto fail;
+        }
+    }
+
+    if (X509_sign(cert, issuerKey, EVP_sha256()) == 0)
+    {
+        goto fail;
+    }
+
+    return cert;
+
+fail:
+    X509_free(cert);
+    return NULL;
+}
+
+static char* CertificateToPem(X509* cert)
+{
+    BIO* bio = NULL;
+    char* pem = NULL;
+    char* data = NULL;
+    long length = 0;
+
+    bio = BIO_new(BIO_s_mem());
+    if (bio == NULL || PEM_write_bio_X509(bio, cert) == 0)
+    {
+        BIO_free(bio);
+        return NULL;
+    }
+    length = BIO_get_mem_data(bio, &data);
+    pem = malloc((size_t)length + 1);
+    if (pem != NULL)
+    {
+        memcpy(pem, data, (size_t)length);
+        pem[length] = '\0';
+    }
+    BIO_free(bio);
+    return pem;
+}
+
+bool TestAttestationCreateAuthority(TestAttestationAuthority* authority, int rootKeyBits)
+{
+    memset(authority, 0, sizeof(*authority));
+
+    authority->rootKey = EVP_RSA_gen(rootKeyBits);
+    authority->intermediateKey = EVP_RSA_gen(TEST_INTERMEDIATE_KEY_BITS);
+    authority->leafKey = EVP_RSA_gen(TEST_LEAF_KEY_BITS);
+    if (authority->rootKey == NULL || authority->intermediateKey == NULL || authority->leafKey == NULL)
+    {
+        fprintf(stderr, "Failed to generate test keys\n");
+        goto fail;
+    }
+
+    authority->rootCert = CreateCertificate("GFN Test Root CA", 1, authority->rootKey, NULL, NULL, true,
+        -60, TEST_CERT_VALIDITY_SECONDS);
+    if (authority->rootCert == NULL)
+    {
+        fprintf(stderr, "Failed to create test root certificate\n");
+        goto fail;
+    }
+    authority->intermediateCert = CreateCertificate("GFN Test Intermediate CA", 2, authority->intermediateKey,
+        authority->rootCert, authority->rootKey, true, -60, TEST_CERT_VALIDITY_SECONDS);
+    if (authority->intermediateCert == NULL)
+    {
+        fprintf(stderr, "Failed to create test intermediate certificate\n");
+        goto fail;
+    }
+    authority->leafCert = CreateCertificate("GFN Test Attestation", 3, authority->leafKey,
+        authority->intermediateCert, authority->intermediateKey, false, -60, TEST_CERT_VALIDITY_SECONDS);
+    if (authority->leafCert == NULL)
+    {
+        fprintf(stderr, "Failed to create test leaf certificate\n");
+        goto fail;
+    }
+    // Same key as the valid leaf, but its validity ended a day ago
+    authority->expiredLeafCert = CreateCertificate("GFN Test Attestation (expired)", 4, authority->leafKey,
+        authority->intermediateCert, authority->intermediateKey, false, -2 * 24 * 60 * 60, -24 * 60 * 60);
+    if (authority->expiredLeafCert == NULL)
+    {
+        fprintf(stderr, "Failed to create expired test leaf certificate\n");
+        goto fail;
+    }
+
+    authority->rootPem = CertificateToPem(authority->rootCert);
+    if (authority->rootPem == NULL)
+    {
+        fprintf(stderr, "Failed to encode test root certificate\n");
+        goto fail;
+    }
+
+    return true;
+
+fail:
+    TestAttestationDestroyAuthority(authority);
+    return false;
+}
+
+void TestAttestationDestroyAuthority(TestAttestationAuthority* authority)
+{
+    X509_free(authority->expiredLeafCert);
+    X509_free(authority->leafCert);
+    X509_free(authority->intermediateCert);
+    X509_free(authority->rootCert);
+    EVP_PKEY_free(authority->leafKey);
+    EVP_PKEY_free(authority->intermediateKey);
+    EVP_PKEY_free(authority->rootKey);
+    free(authority->rootPem);
+    memset(authority, 0, sizeof(*authority));
+}
+
+// Standard base64 with padding, as used by x5c entries and the nonce claim
+static char* Base64Encode(const unsigned char* data, size_t dataLen)
+{
+    char* encoded = malloc(4 * ((dataLen + 2) / 3) + 1);
+    if (encoded != NULL)
+    {
+        EVP_EncodeBlock((unsigned char*)encoded, data, (int)dataLen);
+    }
+    return encoded;
+}
+
+// base64url without padding, as used by the JWT segments
+static char* Base64UrlEncode(const unsigned char* data, size_t dataLen)
+{
+    char* encoded = Base64Encode(data, dataLen);
+    size_t length = 0;
+
+    if (encoded == NULL)
+    {
+        return NULL;
+    }
+    length = strlen(encoded);
+    while (length > 0 && encoded[length - 1] == '=')
+    {
+        encoded[--length] = '\0';
+    }
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (encoded[i] == '+')
+        {
+            encoded[i] = '-';
+        }
+        else if (encoded[i] == '/')
+        {
+            encoded[i] = '_';
+        }
+    }
+    return encoded;
+}
+
+static char* CertificateToBase64Der(X509* cert)
+{
+    unsigned char* der = NULL;
+    char* encoded = NULL;
+    int derLen = i2d_X509(cert, &der);
+
+    if (derLen <= 0)
+    {
+        return NULL;
+    }
+    encoded = Base64Encode(der, (size_t)derLen);
+    OPENSSL_free(der);
+    return encoded;
+}
+
+// Mints a JWT carrying the given x5c chain, signed by signingKey; optionally corrupts the signature
+static char* MintJwt(EVP_PKEY* signingKey, X509* const* chain, unsigned int chainLength,
+    const char* nonce, unsigned int nonceSize, bool corruptSignature)
+{
+    char* chainB64[TEST_MAX_CHAIN_LENGTH] = { NULL };
+    size_t chainB64Length = 0;
+    size_t offset = 0;
+    char* nonceB64 = NULL;
+    char* header = NULL;
+    char* payload = NULL;
+    char* headerB64 = NULL;
+    char* payloadB64 = NULL;
+    char* signatureB64 = NULL;
+    unsigned char* signature = NULL;
+    size_t signatureLen = 0;
+    char* signingInput = NULL;
+    char* jwt = NULL;
+    size_t length = 0;
+    EVP_MD_CTX* signCtx = NULL;
+
+    for (unsigned int i = 0; i < chainLength; ++i)
+    {
+        chainB64[i] = CertificateToBase64Der(chain[i]);
+        if (chainB64[i] == NULL)
+        {
+            goto end;
+        }
+        chainB64Length += strlen(chainB64[i]) + 3;
+    }
+    nonceB64 = Base64Encode((const unsigned char*)nonce, nonceSize);
+    if (nonceB64 == NULL)
+    {
+        goto end;
+    }
+
+    length = chainB64Length + 64;
+    header = malloc(length);
+    if (header == NULL)
+    {
+        goto end;
+    }
+    offset = (size_t)snprintf(header, length, "{\"alg\":\"RS512\",\"typ\":\"JWT\",\"x5c\":[");
+    for (unsigned int i = 0; i < chainLength; ++i)
+    {
+        offset += (size_t)snprintf(header + offset, length - offset, "%s\"%s\"", i == 0 ? "" : ",", chainB64[i]);
+    }
+    snprintf(header + offset, length - offset, "]}");
+
+    length = strlen(nonceB64) + 96;
+    payload = malloc(length);
+    if (payload == NULL)
+    {
+        goto end;
+    }
+    snprintf(payload, length, "{\"iss\":\"GFN SDK Test\",\"nonce\":\"%s\",\"cloudType\":\"TRUSTED\"}", nonceB64);
+
+    headerB64 = Base64UrlEncode((const unsigned char*)header, strlen(header));
+    payloadB64 = Base64UrlEncode((const unsigned char*)payload, strlen(payload));
+    if (headerB64 == NULL || payloadB64 == NULL)
+    {
+        goto end;
+    }
+
+    length = strlen(headerB64) + 1 + strlen(payloadB64);
+    signingInput = malloc(length + 1);
+    if (signingInput == NULL)
+    {
+        goto end;
+    }
+    snprintf(signingInput, length + 1, "%s.%s", headerB64, payloadB64);
+
+    signCtx = EVP_MD_CTX_new();
+    if (signCtx == NULL ||
+        EVP_DigestSignInit(signCtx, NULL, EVP_sha512(), NULL, signingKey) != 1 ||
+        EVP_DigestSign(signCtx, NULL, &signatureLen, (const unsigned char*)signingInput, length) != 1)
+    {
+        goto end;
+    }
+    signature = malloc(signatureLen);
+    if (signature == NULL ||
+        EVP_DigestSign(signCtx, signature, &signatureLen, (const unsigned char*)signingInput, length) != 1)
+    {
+        goto end;
+    }
+    if (corruptSignature)
+    {
+        signature[signatureLen / 2] ^= 0x01;
+    }
+    signatureB64 = Base64UrlEncode(signature, signatureLen);
+    if (signatureB64 == NULL)
+    {
+        goto end;
+    }
+
+    jwt = malloc(length + 1 + strlen(signatureB64) + 1);
+    if (jwt != NULL)
+    {
+        sprintf(jwt, "%s.%s", signingInput, signatureB64);
+    }
+
+end:
+    EVP_MD_CTX_free(signCtx);
+    for (unsigned int i = 0; i < chainLength; ++i)
+    {
+        free(chainB64[i]);
+    }
+    free(nonceB64);
+    free(header);
+    free(payload);
+    free(headerB64);
+    free(payloadB64);
+    free(signatureB64);
+    free(signature);
+    free(signingInput);
+    return jwt;
+}
+
+char* TestAttestationMintJwt(const TestAttestationAuthority* authority, const char* nonce, unsigned int nonceSize)
+{
+    return TestAttestationMintCase(authority, TestAttestationCaseValid, nonce, nonceSize);
+}
+
+const char* TestAttestationCaseName(TestAttestationCase testCase)
+{
+    switch (testCase)
+    {
+    case TestAttestationCaseValid: return "valid";
+    case TestAttestationCaseBadSignature: return "bad signature";
+    case TestAttestationCaseWrongNonce: return "wrong nonce";
+    case TestAttestationCaseExpired: return "expired leaf";
+    case TestAttestationCaseOversizedChain: return "oversized chain";
+    default: return "unknown";
+    }
+}
+
+char* TestAttestationMintCase(const TestAttestationAuthority* authority, TestAttestationCase testCase,
+    const char* nonce, unsigned int nonceSize)
+{
+    X509* chain[TEST_MAX_CHAIN_LENGTH] = { authority->leafCert, authority->intermediateCert,
+        authority->intermediateCert, authority->intermediateCert };
+    unsigned int chainLength = 2;
+    char* otherNonce = NULL;
+    char* jwt = NULL;
+
+    switch (testCase)
+    {
+    case TestAttestationCaseValid:
+        break;
+    case TestAttestationCaseBadSignature:
+        return MintJwt(authority->leafKey, chain, chainLength, nonce, nonceSize, true);
+    case TestAttestationCaseWrongNonce:
+        otherNonce = malloc(nonceSize);
+        if (otherNonce == NULL)
+        {
+            return NULL;
+        }
+        memcpy(otherNonce, nonce, nonceSize);
+        otherNonce[0] ^= 0x01;
+        jwt = MintJwt(authority->leafKey, chain, chainLength, otherNonce, nonceSize, false);
+        free(otherNonce);
+        return jwt;
+    case TestAttestationCaseExpired:
+        chain[0] = authority->expiredLeafCert;
+        break;
+    case TestAttestationCaseOversizedChain:
+        // The intermediate repeated up to one certificate more than the verifier accepts
+        chainLength = TEST_MAX_CHAIN_LENGTH;
+        break;
+    default:
+        return NULL;
+    }
+    return MintJwt(authority->leafKey, chain, chainLength, nonce, nonceSize, false);
+}
@@ -0,0 +1,127 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+// Offline helpers for the CloudCheckBenchmark sample: a throw-away certificate authority shaped like
+// the GFN attestation chain (root -> intermediate -> leaf), and minting of attestation JWTs signed
+// with RS512 by the leaf key. Nothing here talks to the GFN service.
+
+#ifndef __GFN_TEST_ATTESTATION_H__
+#define __GFN_TEST_ATTESTATION_H__
+
+#include <stdbool.h>
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Test certificate authority used to mint attestation JWTs.
+     */
+    typedef struct TestAttestationAuthority
+    {
+        EVP_PKEY* rootKey;
+        X509* rootCert;
+        char* rootPem;              ///< PEM encoding of rootCert, for GfnCloudCheckSetTestRootCertificates
+        EVP_PKEY* intermediateKey;
+        X509* intermediateCert;
+        EVP_PKEY* leafKey;
+        X509* leafCert;
+        X509* expiredLeafCert;      ///< Leaf certificate for leafKey whose validity has ended
+    } TestAttestationAuthority;
+
+    /**
+     * @brief Kinds of attestation JWTs minted by TestAttestationMintCase.
+     */
+    typedef enum TestAttestationCase
+    {
+        TestAttestationCaseValid = 0,
+        TestAttestationCaseBadSignature,    ///< The signature does not match the signing input
+        TestAttestationCaseWrongNonce,      ///< The payload carries a different nonce than the requested one
+        TestAttestationCaseExpired,         ///< The leaf certificate in x5c has expired
+        TestAttestationCaseOversizedChain,  ///< x5c carries more certificates than the verifier accepts
+        TestAttestationCaseCount
+    } TestAttestationCase;
+
+    /**
+     * @brief Generates a root CA, an intermediate CA, a leaf certificate and an expired leaf certificate.
+     *
+     * The certificates carry the extensions required by strict chain validation for the SSL server purpose.
+     *
+     * @param authority Storage for the generated keys and certificates.
+     * @param rootKeyBits RSA modulus size of the root key. The GFN roots use 4096.
+     *
+     * @return true on success. On failure the authority is left empty.
+     */
+    bool TestAttestationCreateAuthority(TestAttestationAuthority* authority, int rootKeyBits);
+
+    /**
+     * @brief Releases all keys and certificates of the authority.
+     */
+    void TestAttestationDestroyAuthority(TestAttestationAuthority* authority);
+
+    /**
+     * @brief Mints an attestation JWT in the GFN format for the given nonce.
+     *
+     * The header carries alg RS512 and the leaf and intermediate certificates in x5c, the payload
+     * carries the base64 encoded nonce, and the signature is made with the leaf key.
+     *
+     * @param authority The authority whose leaf key signs the JWT.
+     * @param nonce The nonce to embed.
+     * @param nonceSize The size of nonce in bytes.
+     *
+     * @return NUL-terminated JWT to be released with free(), or NULL on failure.
+     */
+    char* TestAttestationMintJwt(const TestAttestationAuthority* authority, const char* nonce, unsigned int nonceSize);
+
+    /**
+     * @brief Mints a valid or deliberately broken attestation JWT for the given nonce.
+     *
+     * Every case except TestAttestationCaseValid must be rejected by the verifier.
+     *
+     * @param authority The authority whose leaf key signs the JWT.
+     * @param testCase The kind of JWT to mint.
+     * @param nonce The nonce the JWT is requested with.
+     * @param nonceSize The size of nonce in bytes.
+     *
+     * @return NUL-terminated JWT to be released with free(), or NULL on failure.
+     */
+    char* TestAttestationMintCase(const TestAttestationAuthority* authority, TestAttestationCase testCase,
+        const char* nonce, unsigned int nonceSize);
+
+    /**
+     * @brief Returns a short description of a test case, e.g. "bad signature".
+     */
+    const char* TestAttestationCaseName(TestAttestationCase testCase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__GFN_TEST_ATTESTATION_H__
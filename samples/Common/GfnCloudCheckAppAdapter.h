@@ -16,7 +16,12 @@
 #define CC_LOG(...)
 #endif
 
+// Can be predefined (e.g. on the compiler command line) to route allocations to the application allocator.
+#ifndef GFN_CC_MALLOC
 #define GFN_CC_MALLOC(size) malloc(size)
+#endif
+#ifndef GFN_CC_FREE
 #define GFN_CC_FREE(ptr) free(ptr)
+#endif
 
 #endif //__GFN_CLOUD_CHECK_APP_ADAPTER_H__
@@ -0,0 +1,492 @@
+// This file contains the Base64 and Base64Url decoders used by the CloudCheck utils.
+// Game/application devs are free to use this implementation (*.h/*.c) files and integrate within their build system.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <GfnCloudCheckBase64.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define GFN_BASE64_X86 1
+#   include <immintrin.h>
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       include <intrin.h>
+#       define GFN_BASE64_TARGET(isa)
+#   else
+#       define GFN_BASE64_TARGET(isa) __attribute__((target(isa)))
+#   endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   define GFN_BASE64_NEON 1
+#   include <arm_neon.h>
+#endif
+
+#define BASE64_INVALID 0xff
+
+// Maps each character to its 6-bit value, BASE64_INVALID marks characters outside the alphabet
+static const unsigned char s_StandardDecodeTable[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+static const unsigned char s_UrlDecodeTable[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0x3f,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/*
+ * A block decoder converts as many whole blocks of valid input as it can and returns the number of
+ * input characters consumed, always a multiple of 4. It stops before the first block that contains
+ * an invalid character, or when the destination has no room for its full vector store; the scalar
+ * loop continues from there and reports errors with their exact offset.
+ */
+typedef size_t (*GfnBase64BlockDecoder)(const char* src, size_t srcLength, unsigned char char62, unsigned char char63,
+    unsigned char* dest, size_t destCapacity);
+
+#ifdef GFN_BASE64_X86
+
+// Translates 16 characters to 6-bit values. Returns false if any of them is outside the alphabet.
+GFN_BASE64_TARGET("sse4.1")
+static inline bool TranslateSse41(__m128i in, __m128i char62, __m128i char63, __m128i* values)
+{
+    __m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), in));
+    __m128i isLower = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), in));
+    __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), in));
+    __m128i is62 = _mm_cmpeq_epi8(in, char62);
+    __m128i is63 = _mm_cmpeq_epi8(in, char63);
+    __m128i valid = _mm_or_si128(_mm_or_si128(isUpper, isLower), _mm_or_si128(isDigit, _mm_or_si128(is62, is63)));
+    __m128i offset;
+
+    if (_mm_movemask_epi8(valid) != 0xffff)
+    {
+        return false;
+    }
+
+    // The classes are disjoint, so the per-class offsets can be combined with OR
+    offset = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(isUpper, _mm_set1_epi8(-'A')), _mm_and_si128(isLower, _mm_set1_epi8(26 - 'a'))),
+        _mm_or_si128(_mm_and_si128(isDigit, _mm_set1_epi8(52 - '0')),
+            _mm_or_si128(_mm_and_si128(is62, _mm_sub_epi8(_mm_set1_epi8(62), char62)),
+                         _mm_and_si128(is63, _mm_sub_epi8(_mm_set1_epi8(63), char63)))));
+    *values = _mm_add_epi8(in, offset);
+    return true;
+}
+
+GFN_BASE64_TARGET("sse4.1")
+static size_t DecodeBlocksSse41(const char* src, size_t srcLength, unsigned char char62, unsigned char char63,
+    unsigned char* dest, size_t destCapacity)
+{
+    const __m128i char62Vector = _mm_set1_epi8((char)char62);
+    const __m128i char63Vector = _mm_set1_epi8((char)char63);
+    const __m128i packShuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t consumed = 0;
+    size_t produced = 0;
+
+    // 16 characters produce 12 bytes, the store writes 16
+    while (srcLength - consumed >= 16 && destCapacity - produced >= 16)
+    {
+        __m128i values;
+        __m128i merged;
+
+        if (!TranslateSse41(_mm_loadu_si128((const __m128i*)(src + consumed)), char62Vector, char63Vector, &values))
+        {
+            break;
+        }
+
+        // [a b c d] -> 16-bit (a << 6 | b), (c << 6 | d) -> 32-bit (a << 18 | b << 12 | c << 6 | d)
+        merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128((__m128i*)(dest + produced), _mm_shuffle_epi8(merged, packShuffle));
+
+        consumed += 16;
+        produced += 12;
+    }
+    return consumed;
+}
+
+GFN_BASE64_TARGET("avx2")
+static inline bool TranslateAvx2(__m256i in, __m256i char62, __m256i char63, __m256i* values)
+{
+    __m256i isUpper = _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), in));
+    __m256i isLower = _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), in));
+    __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), in));
+    __m256i is62 = _mm256_cmpeq_epi8(in, char62);
+    __m256i is63 = _mm256_cmpeq_epi8(in, char63);
+    __m256i valid = _mm256_or_si256(_mm256_or_si256(isUpper, isLower), _mm256_or_si256(isDigit, _mm256_or_si256(is62, is63)));
+    __m256i offset;
+
+    if ((uint32_t)_mm256_movemask_epi8(valid) != 0xffffffffu)
+    {
+        return false;
+    }
+
+    offset = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(isUpper, _mm256_set1_epi8(-'A')), _mm256_and_si256(isLower, _mm256_set1_epi8(26 - 'a'))),
+        _mm256_or_si256(_mm256_and_si256(isDigit, _mm256_set1_epi8(52 - '0')),
+            _mm256_or_si256(_mm256_and_si256(is62, _mm256_sub_epi8(_mm256_set1_epi8(62), char62)),
+                            _mm256_and_si256(is63, _mm256_sub_epi8(_mm256_set1_epi8(63), char63)))));
+    *values = _mm256_add_epi8(in, offset);
+    return true;
+}
+
+GFN_BASE64_TARGET("avx2")
+static size_t DecodeBlocksAvx2(const char* src, size_t srcLength, unsigned char char62, unsigned char char63,
+    unsigned char* dest, size_t destCapacity)
+{
+    const __m256i char62Vector = _mm256_set1_epi8((char)char62);
+    const __m256i char63Vector = _mm256_set1_epi8((char)char63);
+    const __m256i packShuffle = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i packPermute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    size_t consumed = 0;
+    size_t produced = 0;
+
+    // 32 characters produce 24 bytes, the store writes 32
+    while (srcLength - consumed >= 32 && destCapacity - produced >= 32)
+    {
+        __m256i values;
+        __m256i merged;
+
+        if (!TranslateAvx2(_mm256_loadu_si256((const __m256i*)(src + consumed)), char62Vector, char63Vector, &values))
+        {
+            break;
+        }
+
+        merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        // Each 128-bit lane holds 12 bytes; move them next to each other
+        merged = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, packShuffle), packPermute);
+        _mm256_storeu_si256((__m256i*)(dest + produced), merged);
+
+        consumed += 32;
+        produced += 24;
+    }
+    return consumed;
+}
+
+static bool CpuSupportsSse41(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 1);
+    return (cpuInfo[2] & (1 << 19)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.1") != 0;
+#endif
+}
+
+static bool CpuSupportsAvx2(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 0);
+    if (cpuInfo[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(cpuInfo, 1);
+    // The OS must save the YMM registers (OSXSAVE and XCR0 bits 1-2)
+    if ((cpuInfo[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(cpuInfo, 7, 0);
+    return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // GFN_BASE64_X86
+
+#ifdef GFN_BASE64_NEON
+
+// Translates 16 characters to 6-bit values and clears lanes of validAll that are outside the alphabet
+static inline uint8x16_t TranslateNeon(uint8x16_t in, uint8x16_t char62, uint8x16_t char63, uint8x16_t* validAll)
+{
+    uint8x16_t isUpper = vandq_u8(vcgeq_u8(in, vdupq_n_u8('A')), vcleq_u8(in, vdupq_n_u8('Z')));
+    uint8x16_t isLower = vandq_u8(vcgeq_u8(in, vdupq_n_u8('a')), vcleq_u8(in, vdupq_n_u8('z')));
+    uint8x16_t isDigit = vandq_u8(vcgeq_u8(in, vdupq_n_u8('0')), vcleq_u8(in, vdupq_n_u8('9')));
+    uint8x16_t is62 = vceqq_u8(in, char62);
+    uint8x16_t is63 = vceqq_u8(in, char63);
+    uint8x16_t offset;
+
+    *validAll = vandq_u8(*validAll, vorrq_u8(vorrq_u8(isUpper, isLower), vorrq_u8(isDigit, vorrq_u8(is62, is63))));
+
+    offset = vorrq_u8(
+        vorrq_u8(vandq_u8(isUpper, vdupq_n_u8((uint8_t)-'A')), vandq_u8(isLower, vdupq_n_u8((uint8_t)(26 - 'a')))),
+        vorrq_u8(vandq_u8(isDigit, vdupq_n_u8((uint8_t)(52 - '0'))),
+            vorrq_u8(vandq_u8(is62, vsubq_u8(vdupq_n_u8(62), char62)),
+                     vandq_u8(is63, vsubq_u8(vdupq_n_u8(63), char63)))));
+    return vaddq_u8(in, offset);
+}
+
+static size_t DecodeBlocksNeon(const char* src, size_t srcLength, unsigned char char62, unsigned char char63,
+    unsigned char* dest, size_t destCapacity)
+{
+    const uint8x16_t char62Vector = vdupq_n_u8(char62);
+    const uint8x16_t char63Vector = vdupq_n_u8(char63);
+    size_t consumed = 0;
+    size_t produced = 0;
+
+    // 64 characters produce exactly 48 bytes
+    while (srcLength - consumed >= 64 && destCapacity - produced >= 48)
+    {
+        uint8x16x4_t in = vld4q_u8((const uint8_t*)src + consumed);
+        uint8x16_t validAll = vdupq_n_u8(0xff);
+        uint8x16_t a = TranslateNeon(in.val[0], char62Vector, char63Vector, &validAll);
+        uint8x16_t b = TranslateNeon(in.val[1], char62Vector, char63Vector, &validAll);
+        uint8x16_t c = TranslateNeon(in.val[2], char62Vector, char63Vector, &validAll);
+        uint8x16_t d = TranslateNeon(in.val[3], char62Vector, char63Vector, &validAll);
+        uint8x16x3_t out;
+
+        if (vminvq_u8(validAll) != 0xff)
+        {
+            break;
+        }
+
+        out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+        vst3q_u8(dest + produced, out);
+
+        consumed += 64;
+        produced += 48;
+    }
+    return consumed;
+}
+
+#endif // GFN_BASE64_NEON
+
+typedef struct GfnBase64Dispatch
+{
+    GfnBase64Implementation implementation;
+    GfnBase64BlockDecoder decodeBlocks;     // NULL for the scalar implementation
+    const char* name;
+} GfnBase64Dispatch;
+
+static const GfnBase64Dispatch s_ScalarDispatch = { GfnBase64ImplementationScalar, NULL, "scalar" };
+#ifdef GFN_BASE64_X86
+static const GfnBase64Dispatch s_Sse41Dispatch = { GfnBase64ImplementationSse41, DecodeBlocksSse41, "sse4.1" };
+static const GfnBase64Dispatch s_Avx2Dispatch = { GfnBase64ImplementationAvx2, DecodeBlocksAvx2, "avx2" };
+#endif
+#ifdef GFN_BASE64_NEON
+static const GfnBase64Dispatch s_NeonDispatch = { GfnBase64ImplementationNeon, DecodeBlocksNeon, "neon" };
+#endif
+
+// Resolved on first use. Concurrent first calls resolve to the same value, so the race is benign.
+static const GfnBase64Dispatch* volatile s_Dispatch = NULL;
+
+static const GfnBase64Dispatch* FindDispatch(GfnBase64Implementation implementation)
+{
+    switch (implementation)
+    {
+    case GfnBase64ImplementationAuto:
+#ifdef GFN_BASE64_X86
+        if (CpuSupportsAvx2())
+        {
+            return &s_Avx2Dispatch;
+        }
+        if (CpuSupportsSse41())
+        {
+            return &s_Sse41Dispatch;
+        }
+#endif
+#ifdef GFN_BASE64_NEON
+        // NEON is mandatory on ARM64
+        return &s_NeonDispatch;
+#endif
+        return &s_ScalarDispatch;
+    case GfnBase64ImplementationScalar:
+        return &s_ScalarDispatch;
+#ifdef GFN_BASE64_X86
+    case GfnBase64ImplementationSse41:
+        return CpuSupportsSse41() ? &s_Sse41Dispatch : NULL;
+    case GfnBase64ImplementationAvx2:
+        return CpuSupportsAvx2() ? &s_Avx2Dispatch : NULL;
+#endif
+#ifdef GFN_BASE64_NEON
+    case GfnBase64ImplementationNeon:
+        return &s_NeonDispatch;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+static const GfnBase64Dispatch* GetDispatch(void)
+{
+    const GfnBase64Dispatch* dispatch = s_Dispatch;
+    if (dispatch == NULL)
+    {
+        dispatch = FindDispatch(GfnBase64ImplementationAuto);
+        s_Dispatch = dispatch;
+    }
+    return dispatch;
+}
+
+bool GfnBase64SetImplementation(GfnBase64Implementation implementation)
+{
+    const GfnBase64Dispatch* dispatch = FindDispatch(implementation);
+    if (dispatch == NULL)
+    {
+        return false;
+    }
+    s_Dispatch = dispatch;
+    return true;
+}
+
+const char* GfnBase64GetImplementationName(void)
+{
+    return GetDispatch()->name;
+}
+
+size_t GfnBase64DecodedMaxLength(size_t encodedLength)
+{
+    return (encodedLength / 4) * 3 + ((encodedLength % 4) * 3) / 4;
+}
+
+// Returns the offset of the first character of src[0, length) that is outside the alphabet
+static size_t FindInvalidCharacter(const char* src, size_t length, const unsigned char* table)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (table[(uint8_t)src[i]] == BASE64_INVALID)
+        {
+            return i;
+        }
+    }
+    return length;
+}
+
+GfnBase64Status GfnBase64Decode(const char* src, size_t srcLength, GfnBase64Alphabet alphabet,
+    unsigned char* dest, size_t destCapacity, size_t* decodedLength, size_t* errorOffset)
+{
+    const unsigned char* table = (alphabet == GfnBase64AlphabetUrl) ? s_UrlDecodeTable : s_StandardDecodeTable;
+    unsigned char char62 = (alphabet == GfnBase64AlphabetUrl) ? '-' : '+';
+    unsigned char char63 = (alphabet == GfnBase64AlphabetUrl) ? '_' : '/';
+    const GfnBase64Dispatch* dispatch = GetDispatch();
+    size_t dataLength = srcLength;
+    size_t padding = 0;
+    size_t remainder = 0;
+    size_t outputLength = 0;
+    size_t consumed = 0;
+    unsigned char* output = dest;
+    size_t errorAt = 0;
+    GfnBase64Status status = GfnBase64Success;
+
+    // Up to two trailing '=' complete the last group of four
+    while (dataLength > 0 && padding < 2 && src[dataLength - 1] == '=')
+    {
+        dataLength--;
+        padding++;
+    }
+    if (padding > 0 && (srcLength % 4) != 0)
+    {
+        status = GfnBase64InvalidPadding;
+        errorAt = dataLength;
+        goto fail;
+    }
+
+    remainder = dataLength % 4;
+    if (remainder == 1)
+    {
+        status = GfnBase64InvalidLength;
+        errorAt = dataLength - 1;
+        goto fail;
+    }
+
+    outputLength = (dataLength / 4) * 3 + (remainder ? remainder - 1 : 0);
+    if (outputLength > destCapacity)
+    {
+        status = GfnBase64BufferTooSmall;
+        errorAt = 0;
+        goto fail;
+    }
+
+    if (dispatch->decodeBlocks != NULL)
+    {
+        consumed = dispatch->decodeBlocks(src, dataLength, char62, char63, dest, destCapacity);
+        output = dest + (consumed / 4) * 3;
+    }
+
+    for (; consumed + 4 <= dataLength; consumed += 4)
+    {
+        unsigned char a = table[(uint8_t)src[consumed]];
+        unsigned char b = table[(uint8_t)src[consumed + 1]];
+        unsigned char c = table[(uint8_t)src[consumed + 2]];
+        unsigned char d = table[(uint8_t)src[consumed + 3]];
+
+        // Valid values fit in 6 bits, BASE64_INVALID has the top bit set
+        if (((a | b | c | d) & 0x80) != 0)
+        {
+            status = GfnBase64InvalidCharacter;
+            errorAt = consumed + FindInvalidCharacter(src + consumed, 4, table);
+            goto fail;
+        }
+        *output++ = (uint8_t)((a << 2) | (b >> 4));
+        *output++ = (uint8_t)((b << 4) | (c >> 2));
+        *output++ = (uint8_t)((c << 6) | d);
+    }
+
+    if (remainder > 0)
+    {
+        size_t invalidAt = FindInvalidCharacter(src + consumed, remainder, table);
+        unsigned char a = 0;
+        unsigned char b = 0;
+        unsigned char c = 0;
+
+        if (invalidAt < remainder)
+        {
+            status = GfnBase64InvalidCharacter;
+            errorAt = consumed + invalidAt;
+            goto fail;
+        }
+        a = table[(uint8_t)src[consumed]];
+        b = table[(uint8_t)src[consumed + 1]];
+        *output++ = (uint8_t)((a << 2) | (b >> 4));
+        if (remainder == 3)
+        {
+            c = table[(uint8_t)src[consumed + 2]];
+            *output++ = (uint8_t)((b << 4) | (c >> 2));
+        }
+    }
+
+    *decodedLength = output - dest;
+    return GfnBase64Success;
+
+fail:
+    if (errorOffset != NULL)
+    {
+        *errorOffset = errorAt;
+    }
+    return status;
+}
@@ -0,0 +1,96 @@
+// This header file contains the Base64 and Base64Url decoders used by the CloudCheck utils.
+// The decoders validate their input strictly and use SSE4.1/AVX2 (x86-64) or NEON (ARM64) kernels
+// when the CPU supports them, falling back to a portable scalar implementation otherwise.
+// Game/application devs are free to use this implementation (*.h/*.c) files and integrate
+// within their build system.
+
+#ifndef __GFN_CLOUD_CHECK_BASE64_H__
+#define __GFN_CLOUD_CHECK_BASE64_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Alphabet of the encoded data.
+     */
+    typedef enum GfnBase64Alphabet
+    {
+        GfnBase64AlphabetStandard = 0,  ///< RFC 4648 section 4: '+' and '/'
+        GfnBase64AlphabetUrl = 1        ///< RFC 4648 section 5: '-' and '_', as used by JWT segments
+    } GfnBase64Alphabet;
+
+    /**
+     * @brief Result of a decode operation.
+     */
+    typedef enum GfnBase64Status
+    {
+        GfnBase64Success = 0,
+        GfnBase64InvalidCharacter,  ///< A character outside the alphabet, or '=' before the end of the data
+        GfnBase64InvalidLength,     ///< The number of data characters cannot encode whole bytes
+        GfnBase64InvalidPadding,    ///< Padding present but the padded length is not a multiple of 4
+        GfnBase64BufferTooSmall     ///< The destination cannot hold the decoded data
+    } GfnBase64Status;
+
+    /**
+     * @brief Decoder implementations, for benchmarking and testing.
+     */
+    typedef enum GfnBase64Implementation
+    {
+        GfnBase64ImplementationAuto = 0,    ///< Best implementation supported by the CPU
+        GfnBase64ImplementationScalar,
+        GfnBase64ImplementationSse41,
+        GfnBase64ImplementationAvx2,
+        GfnBase64ImplementationNeon
+    } GfnBase64Implementation;
+
+    /**
+     * @brief Returns the maximum number of bytes that encoded data of the given length decodes to.
+     *
+     * @param encodedLength The length of the encoded data in characters.
+     *
+     * @return The destination capacity sufficient for GfnBase64Decode.
+     */
+    size_t GfnBase64DecodedMaxLength(size_t encodedLength);
+
+    /**
+     * @brief Decodes Base64 or Base64Url data in a single pass.
+     *
+     * Padding is optional for both alphabets; if present it must complete the last group of four.
+     * Whitespace and line breaks are not accepted.
+     *
+     * @param src The encoded data. Does not need to be NUL-terminated.
+     * @param srcLength The length of the encoded data in characters.
+     * @param alphabet The alphabet of the encoded data.
+     * @param dest Destination buffer for the decoded data.
+     * @param destCapacity The size of the destination buffer in bytes.
+     * @param decodedLength Storage for the number of decoded bytes. Set on success only.
+     * @param errorOffset Optional storage for the offset of the first offending character in src. Set on failure only.
+     *
+     * @return GfnBase64Success, or the reason the input was rejected.
+     */
+    GfnBase64Status GfnBase64Decode(const char* src, size_t srcLength, GfnBase64Alphabet alphabet,
+        unsigned char* dest, size_t destCapacity, size_t* decodedLength, size_t* errorOffset);
+
+    /**
+     * @brief Selects the decoder implementation used by GfnBase64Decode.
+     *
+     * @param implementation The implementation to use, or GfnBase64ImplementationAuto to pick the best one.
+     *
+     * @return true if the implementation is supported by this build and CPU, false otherwise (selection unchanged).
+     */
+    bool GfnBase64SetImplementation(GfnBase64Implementation implementation);
+
+    /**
+     * @brief Returns a short name of the decoder implementation in use, e.g. "avx2" or "scalar".
+     */
+    const char* GfnBase64GetImplementationName(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__GFN_CLOUD_CHECK_BASE64_H__
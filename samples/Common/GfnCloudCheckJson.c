@@ -0,0 +1,811 @@
+// This file contains the streaming JSON tokenizer used by the CloudCheck utils.
+// Game/application devs are free to use this implementation (*.h/*.c) files and integrate within their build system.
+
+#include <string.h>
+
+#include <GfnCloudCheckJson.h>
+
+// SSE2 is part of x86-64 and NEON of ARM64, so neither needs a CPU check; AVX2 is used when supported
+#if defined(__x86_64__) || defined(_M_X64)
+#   define GFN_JSON_SSE2 1
+#   include <immintrin.h>
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       include <intrin.h>
+#       define GFN_JSON_TARGET(isa)
+#   else
+#       define GFN_JSON_TARGET(isa) __attribute__((target(isa)))
+#   endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   define GFN_JSON_NEON 1
+#   include <arm_neon.h>
+#endif
+
+// What the tokenizer accepts next
+enum
+{
+    StateValue = 0,         // a value: the document, after ':' or after ',' in an array
+    StateValueOrArrayEnd,   // after '['
+    StateKeyOrObjectEnd,    // after '{'
+    StateKey,               // after ',' in an object
+    StateColon,             // after a key
+    StateCommaOrEnd,        // after a value inside an object or array
+    StateDone,              // after the top-level value
+    StateError
+};
+
+void GfnJsonTokenizerInit(GfnJsonTokenizer* tokenizer, const char* data, size_t length)
+{
+    tokenizer->start = data;
+    tokenizer->current = data;
+    tokenizer->end = data + length;
+    tokenizer->depth = 0;
+    tokenizer->arrayContainers = 0;
+    tokenizer->state = StateValue;
+}
+
+size_t GfnJsonGetOffset(const GfnJsonTokenizer* tokenizer)
+{
+    return tokenizer->current - tokenizer->start;
+}
+
+bool GfnJsonTokenEquals(const GfnJsonToken* token, const char* text)
+{
+    size_t length = strlen(text);
+    return (token->type == GfnJsonTokenKey || token->type == GfnJsonTokenString) && !token->escaped &&
+        token->length == length && memcmp(token->value, text, length) == 0;
+}
+
+static GfnJsonTokenType Fail(GfnJsonTokenizer* tokenizer, GfnJsonToken* token)
+{
+    tokenizer->state = StateError;
+    token->type = GfnJsonTokenError;
+    token->value = tokenizer->current;
+    token->length = 0;
+    return GfnJsonTokenError;
+}
+
+static bool IsHexDigit(unsigned char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static bool IsDigit(unsigned char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Returns the length of the UTF-8 sequence at p, or 0 if it is malformed, overlong or a surrogate
+static size_t Utf8SequenceLength(const unsigned char* p, const unsigned char* end)
+{
+    unsigned char lead = p[0];
+    unsigned char min = 0x80;
+    unsigned char max = 0xbf;
+    size_t length = 0;
+
+    if (lead >= 0xc2 && lead <= 0xdf)
+    {
+        length = 2;
+    }
+    else if (lead >= 0xe0 && lead <= 0xef)
+    {
+        length = 3;
+        min = (lead == 0xe0) ? 0xa0 : 0x80;
+        max = (lead == 0xed) ? 0x9f : 0xbf;
+    }
+    else if (lead >= 0xf0 && lead <= 0xf4)
+    {
+        length = 4;
+        min = (lead == 0xf0) ? 0x90 : 0x80;
+        max = (lead == 0xf4) ? 0x8f : 0xbf;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if ((size_t)(end - p) < length || p[1] < min || p[1] > max)
+    {
+        return 0;
+    }
+    for (size_t i = 2; i < length; i++)
+    {
+        if (p[i] < 0x80 || p[i] > 0xbf)
+        {
+            return 0;
+        }
+    }
+    return length;
+}
+
+// Broadcasts a byte to all bytes of a 64-bit word
+#define GFN_JSON_BYTES(b) (0x0101010101010101ull * (uint64_t)(b))
+
+// Returns non-zero if any byte of the word is below n (n <= 0x80)
+#define GFN_JSON_HAS_LESS(v, n) (((v) - GFN_JSON_BYTES(n)) & ~(v) & GFN_JSON_BYTES(0x80))
+
+// Returns true if none of the 8 bytes at p needs a closer look: no quote, backslash,
+// control character or non-ASCII byte. Certificates and nonces are long runs of such bytes.
+static bool IsPlainAsciiWord(const unsigned char* p)
+{
+    uint64_t v = 0;
+    memcpy(&v, p, sizeof(v));
+    return ((v & GFN_JSON_BYTES(0x80)) | GFN_JSON_HAS_LESS(v, 0x20) |
+        GFN_JSON_HAS_LESS(v ^ GFN_JSON_BYTES('"'), 1) | GFN_JSON_HAS_LESS(v ^ GFN_JSON_BYTES('\\'), 1)) == 0;
+}
+
+#ifdef GFN_JSON_SSE2
+static unsigned int CountTrailingZeros(unsigned int mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+static bool CpuSupportsAvx2(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 0);
+    if (cpuInfo[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(cpuInfo, 1);
+    // The OS must save the YMM registers (OSXSAVE and XCR0 bits 1-2)
+    if ((cpuInfo[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(cpuInfo, 7, 0);
+    return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+// Resolved on first use. Concurrent first calls resolve to the same value, so the race is benign.
+static volatile int s_UseAvx2 = -1;
+
+// Returns the first special byte at or after p, or the position where fewer than 32 bytes are left
+GFN_JSON_TARGET("avx2")
+static const unsigned char* FindStringSpecialByteAvx2(const unsigned char* p, const unsigned char* end)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i space = _mm256_set1_epi8(0x20);
+
+    while (end - p >= 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        // Signed compare: control characters and all non-ASCII bytes are below 0x20
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+            _mm256_cmpgt_epi8(space, v));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return p + CountTrailingZeros(mask);
+        }
+        p += 32;
+    }
+    return p;
+}
+#endif
+
+// Returns the first byte at or after p that IsPlainAsciiWord would flag, or end.
+// The contents are only read, 16 or 32 bytes at a time where SIMD is available.
+static const unsigned char* FindStringSpecialByte(const unsigned char* p, const unsigned char* end)
+{
+#if defined(GFN_JSON_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+
+    if (s_UseAvx2 < 0)
+    {
+        s_UseAvx2 = CpuSupportsAvx2() ? 1 : 0;
+    }
+    if (s_UseAvx2)
+    {
+        p = FindStringSpecialByteAvx2(p, end);
+        if (end - p >= 32)
+        {
+            return p;
+        }
+    }
+    while (end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        // Signed compare: control characters and all non-ASCII bytes are below 0x20
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmplt_epi8(v, space));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return p + CountTrailingZeros(mask);
+        }
+        p += 16;
+    }
+#elif defined(GFN_JSON_NEON)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+
+    while (end - p >= 16)
+    {
+        uint8x16_t v = vld1q_u8(p);
+        uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)),
+            vorrq_u8(vcltq_u8(v, vdupq_n_u8(0x20)), vcgeq_u8(v, vdupq_n_u8(0x80))));
+        if (vmaxvq_u8(special) != 0)
+        {
+            break;
+        }
+        p += 16;
+    }
+#endif
+    while (end - p >= 8 && IsPlainAsciiWord(p))
+    {
+        p += 8;
+    }
+    while (p < end && *p != '"' && *p != '\\' && *p >= 0x20 && *p < 0x80)
+    {
+        p++;
+    }
+    return p;
+}
+
+// Scans a string starting at the opening quote. On success current is past the closing quote.
+static bool ScanString(GfnJsonTokenizer* tokenizer, GfnJsonToken* token)
+{
+    const unsigned char* p = (const unsigned char*)tokenizer->current + 1;
+    const unsigned char* end = (const unsigned char*)tokenizer->end;
+
+    token->value = (const char*)p;
+    token->escaped = false;
+
+    while (p < end)
+    {
+        unsigned char c = 0;
+
+        p = FindStringSpecialByte(p, end);
+        if (p >= end)
+        {
+            break;
+        }
+
+        c = *p;
+        if (c == '"')
+        {
+            token->length = (const char*)p - token->value;
+            tokenizer->current = (const char*)p + 1;
+            return true;
+        }
+        if (c < 0x20)
+        {
+            break;
+        }
+        if (c == '\\')
+        {
+            token->escaped = true;
+            if (end - p < 2)
+            {
+                break;
+            }
+            c = p[1];
+            if (c == 'u')
+            {
+                if (end - p < 6 || !IsHexDigit(p[2]) || !IsHexDigit(p[3]) || !IsHexDigit(p[4]) || !IsHexDigit(p[5]))
+                {
+                    break;
+                }
+                p += 6;
+            }
+            else if (c == '"' || c == '\\' || c == '/' || c == 'b' || c == 'f' || c == 'n' || c == 'r' || c == 't')
+            {
+                p += 2;
+            }
+            else
+            {
+                break;
+            }
+        }
+        else if (c < 0x80)
+        {
+            p++;
+        }
+        else
+        {
+            size_t length = Utf8SequenceLength(p, end);
+            if (length == 0)
+            {
+                break;
+            }
+            p += length;
+        }
+    }
+
+    tokenizer->current = (const char*)p;
+    return false;
+}
+
+// Scans a number, following the JSON grammar -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool ScanNumber(GfnJsonTokenizer* tokenizer, GfnJsonToken* token)
+{
+    const unsigned char* p = (const unsigned char*)tokenizer->current;
+    const unsigned char* end = (const unsigned char*)tokenizer->end;
+
+    token->value = tokenizer->current;
+    if (p < end && *p == '-')
+    {
+        p++;
+    }
+    if (p >= end || !IsDigit(*p))
+    {
+        tokenizer->current = (const char*)p;
+        return false;
+    }
+    if (*p == '0')
+    {
+        p++;
+    }
+    else
+    {
+        while (p < end && IsDigit(*p))
+        {
+            p++;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        p++;
+        if (p >= end || !IsDigit(*p))
+        {
+            tokenizer->current = (const char*)p;
+            return false;
+        }
+        while (p < end && IsDigit(*p))
+        {
+            p++;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        if (p < end && (*p == '+' || *p == '-'))
+        {
+            p++;
+        }
+        if (p >= end || !IsDigit(*p))
+        {
+            tokenizer->current = (const char*)p;
+            return false;
+        }
+        while (p < end && IsDigit(*p))
+        {
+            p++;
+        }
+    }
+
+    token->length = (const char*)p - token->value;
+    tokenizer->current = (const char*)p;
+    return true;
+}
+
+static bool ScanLiteral(GfnJsonTokenizer* tokenizer, GfnJsonToken* token, const char* literal, size_t length)
+{
+    if ((size_t)(tokenizer->end - tokenizer->current) < length || memcmp(tokenizer->current, literal, length) != 0)
+    {
+        return false;
+    }
+    token->value = tokenizer->current;
+    token->length = length;
+    tokenizer->current += length;
+    return true;
+}
+
+// Sets the state after a complete value or container at the current depth
+static void EndValue(GfnJsonTokenizer* tokenizer)
+{
+    tokenizer->state = (tokenizer->depth == 0) ? StateDone : StateCommaOrEnd;
+}
+
+static bool InArray(const GfnJsonTokenizer* tokenizer)
+{
+    return tokenizer->depth > 0 && (tokenizer->arrayContainers & (1u << (tokenizer->depth - 1))) != 0;
+}
+
+static GfnJsonTokenType StartContainer(GfnJsonTokenizer* tokenizer, GfnJsonToken* token, bool isArray)
+{
+    if (tokenizer->depth >= GFN_JSON_MAX_DEPTH)
+    {
+        return Fail(tokenizer, token);
+    }
+    token->type = isArray ? GfnJsonTokenArrayStart : GfnJsonTokenObjectStart;
+    token->value = tokenizer->current;
+    token->length = 1;
+    tokenizer->current++;
+    if (isArray)
+    {
+        tokenizer->arrayContainers |= 1u << tokenizer->depth;
+    }
+    else
+    {
+        tokenizer->arrayContainers &= ~(1u << tokenizer->depth);
+    }
+    tokenizer->depth++;
+    tokenizer->state = isArray ? StateValueOrArrayEnd : StateKeyOrObjectEnd;
+    return token->type;
+}
+
+static GfnJsonTokenType EndContainer(GfnJsonTokenizer* tokenizer, GfnJsonToken* token)
+{
+    token->type = InArray(tokenizer) ? GfnJsonTokenArrayEnd : GfnJsonTokenObjectEnd;
+    token->value = tokenizer->current;
+    token->length = 1;
+    tokenizer->current++;
+    tokenizer->depth--;
+    token->depth = tokenizer->depth;
+    EndValue(tokenizer);
+    return token->type;
+}
+
+static GfnJsonTokenType ScanValue(GfnJsonTokenizer* tokenizer, GfnJsonToken* token)
+{
+    switch (*tokenizer->current)
+    {
+    case '{':
+        return StartContainer(tokenizer, token, false);
+    case '[':
+        return StartContainer(tokenizer, token, true);
+    case '"':
+        if (!ScanString(tokenizer, token))
+        {
+            return Fail(tokenizer, token);
+        }
+        token->type = GfnJsonTokenString;
+        break;
+    case 't':
+        if (!ScanLiteral(tokenizer, token, "true", 4))
+        {
+            return Fail(tokenizer, token);
+        }
+        token->type = GfnJsonTokenTrue;
+        break;
+    case 'f':
+        if (!ScanLiteral(tokenizer, token, "false", 5))
+        {
+            return Fail(tokenizer, token);
+        }
+        token->type = GfnJsonTokenFalse;
+        break;
+    case 'n':
+        if (!ScanLiteral(tokenizer, token, "null", 4))
+        {
+            return Fail(tokenizer, token);
+        }
+        token->type = GfnJsonTokenNull;
+        break;
+    default:
+        if (!ScanNumber(tokenizer, token))
+        {
+            return Fail(tokenizer, token);
+        }
+        token->type = GfnJsonTokenNumber;
+        break;
+    }
+    EndValue(tokenizer);
+    return token->type;
+}
+
+GfnJsonTokenType GfnJsonNextToken(GfnJsonTokenizer* tokenizer, GfnJsonToken* token)
+{
+    token->escaped = false;
+
+    for (;;)
+    {
+        char c = 0;
+
+        if (tokenizer->state == StateError)
+        {
+            return Fail(tokenizer, token);
+        }
+
+        while (tokenizer->current < tokenizer->end &&
+            (*tokenizer->current == ' ' || *tokenizer->current == '\t' || *tokenizer->current == '\n' || *tokenizer->current == '\r'))
+        {
+            tokenizer->current++;
+        }
+        token->depth = tokenizer->depth;
+
+        if (tokenizer->current >= tokenizer->end)
+        {
+            if (tokenizer->state != StateDone)
+            {
+                return Fail(tokenizer, token);
+            }
+            token->type = GfnJsonTokenEnd;
+            token->value = tokenizer->current;
+            token->length = 0;
+            return GfnJsonTokenEnd;
+        }
+
+        c = *tokenizer->current;
+        switch (tokenizer->state)
+        {
+        case StateValue:
+            return ScanValue(tokenizer, token);
+
+        case StateValueOrArrayEnd:
+            if (c == ']')
+            {
+                return EndContainer(tokenizer, token);
+            }
+            return ScanValue(tokenizer, token);
+
+        case StateKeyOrObjectEnd:
+            if (c == '}')
+            {
+                return EndContainer(tokenizer, token);
+            }
+            // fall through
+        case StateKey:
+            if (c != '"' || !ScanString(tokenizer, token))
+            {
+                return Fail(tokenizer, token);
+            }
+            token->type = GfnJsonTokenKey;
+            tokenizer->state = StateColon;
+            return GfnJsonTokenKey;
+
+        case StateColon:
+            if (c != ':')
+            {
+                return Fail(tokenizer, token);
+            }
+            tokenizer->current++;
+            tokenizer->state = StateValue;
+            break;
+
+        case StateCommaOrEnd:
+            if (c == ',')
+            {
+                tokenizer->current++;
+                tokenizer->state = InArray(tokenizer) ? StateValue : StateKey;
+                break;
+            }
+            if ((c == ']' && InArray(tokenizer)) || (c == '}' && !InArray(tokenizer)))
+            {
+                return EndContainer(tokenizer, token);
+            }
+            return Fail(tokenizer, token);
+
+        default:
+            // Anything but whitespace after the top-level value
+            return Fail(tokenizer, token);
+        }
+    }
+}
+
+// Compares the name of an unescaped key token with a string literal, length first
+#define GFN_JSON_KEY_IS(token, literal) \
+    ((token).length == sizeof(literal) - 1 && memcmp((token).value, literal, sizeof(literal) - 1) == 0)
+
+// Reads the value of a member of interest, which must be a string
+static GfnJsonJwtStatus ReadStringMember(GfnJsonTokenizer* tokenizer, GfnJsonStringView* view)
+{
+    GfnJsonToken token;
+
+    switch (GfnJsonNextToken(tokenizer, &token))
+    {
+    case GfnJsonTokenString:
+        view->data = token.value;
+        view->length = token.length;
+        view->escaped = token.escaped;
+        return GfnJsonJwtSuccess;
+    case GfnJsonTokenError:
+        return GfnJsonJwtMalformed;
+    default:
+        return GfnJsonJwtInvalidField;
+    }
+}
+
+// Reads the rest of the document after the top-level object was closed
+static GfnJsonJwtStatus ReadDocumentEnd(GfnJsonTokenizer* tokenizer)
+{
+    GfnJsonToken token;
+    return (GfnJsonNextToken(tokenizer, &token) == GfnJsonTokenEnd) ? GfnJsonJwtSuccess : GfnJsonJwtMalformed;
+}
+
+GfnJsonJwtStatus GfnJsonParseJwtHeader(const char* header, size_t headerLength, GfnJsonStringView* alg,
+    GfnJsonStringView x5c[], unsigned int maxX5c, unsigned int* numX5c, size_t* errorOffset)
+{
+    GfnJsonTokenizer tokenizer;
+    GfnJsonToken token;
+    GfnJsonJwtStatus status = GfnJsonJwtSuccess;
+    bool haveAlg = false;
+    bool haveX5c = false;
+
+    *numX5c = 0;
+    GfnJsonTokenizerInit(&tokenizer, header, headerLength);
+    if (GfnJsonNextToken(&tokenizer, &token) != GfnJsonTokenObjectStart)
+    {
+        status = GfnJsonJwtMalformed;
+        goto end;
+    }
+
+    for (;;)
+    {
+        GfnJsonTokenType type = GfnJsonNextToken(&tokenizer, &token);
+        if (type == GfnJsonTokenError)
+        {
+            status = GfnJsonJwtMalformed;
+            goto end;
+        }
+        if (type == GfnJsonTokenObjectEnd && token.depth == 0)
+        {
+            break;
+        }
+        // Skip everything but the member names of the top-level object, including nested values
+        if (type != GfnJsonTokenKey || token.depth != 1)
+        {
+            continue;
+        }
+        if (token.escaped)
+        {
+            // An escaped name could spell a member of interest; JWT encoders never escape names
+            status = GfnJsonJwtInvalidField;
+            goto end;
+        }
+
+        if (GFN_JSON_KEY_IS(token, "alg"))
+        {
+            if (haveAlg)
+            {
+                status = GfnJsonJwtDuplicateField;
+                goto end;
+            }
+            haveAlg = true;
+            status = ReadStringMember(&tokenizer, alg);
+            if (status != GfnJsonJwtSuccess)
+            {
+                goto end;
+            }
+        }
+        else if (GFN_JSON_KEY_IS(token, "x5c"))
+        {
+            if (haveX5c)
+            {
+                status = GfnJsonJwtDuplicateField;
+                goto end;
+            }
+            haveX5c = true;
+            type = GfnJsonNextToken(&tokenizer, &token);
+            if (type != GfnJsonTokenArrayStart)
+            {
+                status = (type == GfnJsonTokenError) ? GfnJsonJwtMalformed : GfnJsonJwtInvalidField;
+                goto end;
+            }
+            while ((type = GfnJsonNextToken(&tokenizer, &token)) == GfnJsonTokenString)
+            {
+                if (*numX5c >= maxX5c)
+                {
+                    status = GfnJsonJwtTooManyValues;
+                    goto end;
+                }
+                x5c[*numX5c].data = token.value;
+                x5c[*numX5c].length = token.length;
+                x5c[*numX5c].escaped = token.escaped;
+                (*numX5c)++;
+            }
+            if (type != GfnJsonTokenArrayEnd)
+            {
+                status = (type == GfnJsonTokenError) ? GfnJsonJwtMalformed : GfnJsonJwtInvalidField;
+                goto end;
+            }
+        }
+    }
+
+    status = ReadDocumentEnd(&tokenizer);
+    if (status == GfnJsonJwtSuccess && (!haveAlg || *numX5c == 0))
+    {
+        status = GfnJsonJwtMissingField;
+    }
+
+end:
+    if (status != GfnJsonJwtSuccess)
+    {
+        *numX5c = 0;
+        if (errorOffset != NULL)
+        {
+            *errorOffset = GfnJsonGetOffset(&tokenizer);
+        }
+    }
+    return status;
+}
+
+GfnJsonJwtStatus GfnJsonParseJwtPayload(const char* payload, size_t payloadLength, GfnJsonStringView* nonce, size_t* errorOffset)
+{
+    GfnJsonTokenizer tokenizer;
+    GfnJsonToken token;
+    GfnJsonJwtStatus status = GfnJsonJwtSuccess;
+    GfnJsonStringView ononce = { NULL, 0, false };
+    bool haveNonce = false;
+    bool haveOnonce = false;
+
+    GfnJsonTokenizerInit(&tokenizer, payload, payloadLength);
+    if (GfnJsonNextToken(&tokenizer, &token) != GfnJsonTokenObjectStart)
+    {
+        status = GfnJsonJwtMalformed;
+        goto end;
+    }
+
+    for (;;)
+    {
+        GfnJsonTokenType type = GfnJsonNextToken(&tokenizer, &token);
+        if (type == GfnJsonTokenError)
+        {
+            status = GfnJsonJwtMalformed;
+            goto end;
+        }
+        if (type == GfnJsonTokenObjectEnd && token.depth == 0)
+        {
+            break;
+        }
+        if (type != GfnJsonTokenKey || token.depth != 1)
+        {
+            continue;
+        }
+        if (token.escaped)
+        {
+            status = GfnJsonJwtInvalidField;
+            goto end;
+        }
+
+        if (GFN_JSON_KEY_IS(token, "nonce"))
+        {
+            if (haveNonce)
+            {
+                status = GfnJsonJwtDuplicateField;
+                goto end;
+            }
+            haveNonce = true;
+            status = ReadStringMember(&tokenizer, nonce);
+        }
+        else if (GFN_JSON_KEY_IS(token, "ononce"))
+        {
+            if (haveOnonce)
+            {
+                status = GfnJsonJwtDuplicateField;
+                goto end;
+            }
+            haveOnonce = true;
+            status = ReadStringMember(&tokenizer, &ononce);
+        }
+        if (status != GfnJsonJwtSuccess)
+        {
+            goto end;
+        }
+    }
+
+    status = ReadDocumentEnd(&tokenizer);
+    if (status == GfnJsonJwtSuccess && !haveNonce)
+    {
+        if (haveOnonce)
+        {
+            *nonce = ononce;
+        }
+        else
+        {
+            status = GfnJsonJwtMissingField;
+        }
+    }
+
+end:
+    if (status != GfnJsonJwtSuccess && errorOffset != NULL)
+    {
+        *errorOffset = GfnJsonGetOffset(&tokenizer);
+    }
+    return status;
+}
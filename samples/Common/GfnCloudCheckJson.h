@@ -0,0 +1,162 @@
+// This header file contains the streaming JSON tokenizer used by the CloudCheck utils to parse the
+// JWT header and payload. It works on (pointer, length) views, never copies or modifies its input,
+// and strictly rejects anything that is not valid JSON (RFC 8259).
+// Game/application devs are free to use this implementation (*.h/*.c) files and integrate
+// within their build system.
+
+#ifndef __GFN_CLOUD_CHECK_JSON_H__
+#define __GFN_CLOUD_CHECK_JSON_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Maximum nesting depth of objects and arrays accepted by the tokenizer.
+     */
+#define GFN_JSON_MAX_DEPTH 32
+
+    /**
+     * @brief Type of a token returned by GfnJsonNextToken.
+     */
+    typedef enum GfnJsonTokenType
+    {
+        GfnJsonTokenEnd = 0,        ///< End of the document, after the top-level value
+        GfnJsonTokenError,          ///< Malformed input; every later call returns this again
+        GfnJsonTokenObjectStart,
+        GfnJsonTokenObjectEnd,
+        GfnJsonTokenArrayStart,
+        GfnJsonTokenArrayEnd,
+        GfnJsonTokenKey,            ///< Member name of an object
+        GfnJsonTokenString,
+        GfnJsonTokenNumber,
+        GfnJsonTokenTrue,
+        GfnJsonTokenFalse,
+        GfnJsonTokenNull
+    } GfnJsonTokenType;
+
+    /**
+     * @brief A token, as a view into the tokenized data.
+     */
+    typedef struct GfnJsonToken
+    {
+        GfnJsonTokenType type;
+        const char* value;      ///< Keys and strings: contents without the quotes. Other tokens: the token text.
+        size_t length;          ///< Length of value in bytes
+        bool escaped;           ///< Keys and strings: the contents contain escape sequences, which are not decoded
+        unsigned int depth;     ///< Number of enclosing objects and arrays; members of the top-level object are at depth 1
+    } GfnJsonToken;
+
+    /**
+     * @brief Tokenizer state. Initialize with GfnJsonTokenizerInit.
+     */
+    typedef struct GfnJsonTokenizer
+    {
+        const char* start;
+        const char* current;
+        const char* end;
+        unsigned int depth;
+        uint32_t arrayContainers;   ///< Bit n is set when the container at depth n + 1 is an array
+        int state;
+    } GfnJsonTokenizer;
+
+    /**
+     * @brief Prepares a tokenizer for a JSON document.
+     *
+     * @param tokenizer The tokenizer.
+     * @param data The JSON document. Does not need to be NUL-terminated and must outlive the tokens.
+     * @param length The length of the document in bytes.
+     */
+    void GfnJsonTokenizerInit(GfnJsonTokenizer* tokenizer, const char* data, size_t length);
+
+    /**
+     * @brief Returns the next token of the document.
+     *
+     * The document must consist of exactly one value, optionally surrounded by whitespace.
+     * Strings must be valid UTF-8 without unescaped control characters, and escape sequences and
+     * numbers must follow the JSON grammar.
+     *
+     * @param tokenizer The tokenizer.
+     * @param token Storage for the token.
+     *
+     * @return The type of the token, also stored in token->type.
+     */
+    GfnJsonTokenType GfnJsonNextToken(GfnJsonTokenizer* tokenizer, GfnJsonToken* token);
+
+    /**
+     * @brief Returns the offset in the document where tokenizing stopped, e.g. of the first malformed byte.
+     */
+    size_t GfnJsonGetOffset(const GfnJsonTokenizer* tokenizer);
+
+    /**
+     * @brief Compares the contents of a key or string token with a NUL-terminated string.
+     *
+     * @return true if the token is unescaped and equal to the string, false otherwise.
+     */
+    bool GfnJsonTokenEquals(const GfnJsonToken* token, const char* text);
+
+    /**
+     * @brief Result of parsing a JWT header or payload.
+     */
+    typedef enum GfnJsonJwtStatus
+    {
+        GfnJsonJwtSuccess = 0,
+        GfnJsonJwtMalformed,        ///< Not valid JSON, or not an object
+        GfnJsonJwtMissingField,     ///< A required member is missing
+        GfnJsonJwtInvalidField,     ///< A member has the wrong type, or its name is escaped
+        GfnJsonJwtDuplicateField,   ///< A member of interest appears more than once
+        GfnJsonJwtTooManyValues     ///< More x5c certificates than the caller can hold
+    } GfnJsonJwtStatus;
+
+    /**
+     * @brief Contents of a JSON string, as a view into the parsed data.
+     */
+    typedef struct GfnJsonStringView
+    {
+        const char* data;       ///< Contents without the quotes
+        size_t length;
+        bool escaped;           ///< The contents contain escape sequences, which are not decoded
+    } GfnJsonStringView;
+
+    /**
+     * @brief Extracts the alg and x5c members of a JWT header in one pass.
+     *
+     * Only members of the top-level object are considered; names nested in other values or
+     * appearing inside strings are ignored.
+     *
+     * @param header The decoded JWT header.
+     * @param headerLength The length of the header in bytes.
+     * @param alg Storage for the alg string.
+     * @param x5c Storage for the x5c certificate strings.
+     * @param maxX5c The number of entries x5c can hold.
+     * @param numX5c Storage for the number of x5c certificates. At least 1 on success.
+     * @param errorOffset Optional storage for the offset of the error in the header. Set on failure only.
+     *
+     * @return GfnJsonJwtSuccess, or the reason the header was rejected.
+     */
+    GfnJsonJwtStatus GfnJsonParseJwtHeader(const char* header, size_t headerLength, GfnJsonStringView* alg,
+        GfnJsonStringView x5c[], unsigned int maxX5c, unsigned int* numX5c, size_t* errorOffset);
+
+    /**
+     * @brief Extracts the nonce of a JWT payload in one pass.
+     *
+     * Uses the "nonce" member of the top-level object, or the "ononce" member if there is no "nonce".
+     *
+     * @param payload The decoded JWT payload.
+     * @param payloadLength The length of the payload in bytes.
+     * @param nonce Storage for the nonce string.
+     * @param errorOffset Optional storage for the offset of the error in the payload. Set on failure only.
+     *
+     * @return GfnJsonJwtSuccess, or the reason the payload was rejected.
+     */
+    GfnJsonJwtStatus GfnJsonParseJwtPayload(const char* payload, size_t payloadLength, GfnJsonStringView* nonce, size_t* errorOffset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__GFN_CLOUD_CHECK_JSON_H__
@@ -0,0 +1,368 @@
+// This file contains the nonce manager used to issue CloudCheck challenges and to reject replays.
+// Game/application devs are free to use this implementation (*.h/*.c) files and integrate within their build system.
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#include <GfnCloudCheckNonce.h>
+#include <GfnCloudCheckAppAdapter.h>
+
+#define DEFAULT_NONCE_SIZE 32
+#define DEFAULT_CAPACITY 65536
+#define DEFAULT_LIFETIME_MS 60000
+#define DEFAULT_PREFETCH_NONCES 256
+#define MIN_NONCE_SIZE 16
+#define MAX_CAPACITY (1u << 26)
+
+#ifdef _WIN32
+typedef SRWLOCK GfnNonceLock;
+#define NonceLockInit(lock) InitializeSRWLock(lock)
+#define NonceLockDestroy(lock)
+#define NonceLockAcquire(lock) AcquireSRWLockExclusive(lock)
+#define NonceLockRelease(lock) ReleaseSRWLockExclusive(lock)
+#else
+typedef pthread_mutex_t GfnNonceLock;
+#define NonceLockInit(lock) pthread_mutex_init(lock, NULL)
+#define NonceLockDestroy(lock) pthread_mutex_destroy(lock)
+#define NonceLockAcquire(lock) pthread_mutex_lock(lock)
+#define NonceLockRelease(lock) pthread_mutex_unlock(lock)
+#endif
+
+/*
+ * Outstanding nonces live in a linear-probing hash table of at least twice the capacity, so probe
+ * sequences stay short. A slot is empty when its expiry time is 0. Removal uses backward-shift
+ * deletion, which keeps lookups O(1) without tombstones.
+ */
+struct GfnCloudCheckNonceManager
+{
+    GfnNonceLock lock;
+    unsigned int nonceSize;
+    unsigned int capacity;
+    uint64_t lifetimeMs;
+    uint64_t hashSeed;
+
+    uint64_t* expiresAt;        // per slot, 0 if the slot is empty
+    unsigned char* nonces;      // nonceSize bytes per slot
+    size_t mask;                // number of slots - 1
+    unsigned int count;
+    uint64_t nextPurgeMs;       // no outstanding nonce expires before this time
+
+    unsigned char* pool;        // prefetched random bytes; consumed bytes are wiped
+    unsigned int poolSize;
+    unsigned int poolUsed;
+
+    GfnCloudCheckNonceManagerStats stats;
+};
+
+static uint64_t GetMonotonicTimeMs(void)
+{
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+// Zeroes memory in a way the compiler cannot elide
+static void WipeMemory(void* data, size_t size)
+{
+    volatile unsigned char* p = (volatile unsigned char*)data;
+    while (size--)
+    {
+        *p++ = 0;
+    }
+}
+
+static size_t HashNonce(const GfnCloudCheckNonceManager* manager, const unsigned char* nonce)
+{
+    uint64_t h = 0;
+
+    // Issued nonces are random, but consumed ones come from the network: mix with a secret seed
+    memcpy(&h, nonce, sizeof(h));
+    h ^= manager->hashSeed;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return (size_t)h & manager->mask;
+}
+
+static unsigned char* SlotNonce(const GfnCloudCheckNonceManager* manager, size_t slot)
+{
+    return manager->nonces + slot * manager->nonceSize;
+}
+
+// Returns the slot holding the nonce, or the empty slot ending its probe sequence
+static size_t FindSlot(const GfnCloudCheckNonceManager* manager, const unsigned char* nonce)
+{
+    size_t slot = HashNonce(manager, nonce);
+
+    while (manager->expiresAt[slot] != 0 && memcmp(SlotNonce(manager, slot), nonce, manager->nonceSize) != 0)
+    {
+        slot = (slot + 1) & manager->mask;
+    }
+    return slot;
+}
+
+static void RemoveSlot(GfnCloudCheckNonceManager* manager, size_t slot)
+{
+    size_t next = slot;
+
+    // Shift later members of the probe sequence back so no lookup passes an empty slot early
+    for (;;)
+    {
+        size_t home = 0;
+
+        next = (next + 1) & manager->mask;
+        if (manager->expiresAt[next] == 0)
+        {
+            break;
+        }
+        home = HashNonce(manager, SlotNonce(manager, next));
+        // Keep the entry if its home lies cyclically in (slot, next]
+        if ((slot <= next) ? (slot < home && home <= next) : (slot < home || home <= next))
+        {
+            continue;
+        }
+        manager->expiresAt[slot] = manager->expiresAt[next];
+        memcpy(SlotNonce(manager, slot), SlotNonce(manager, next), manager->nonceSize);
+        slot = next;
+    }
+
+    manager->expiresAt[slot] = 0;
+    WipeMemory(SlotNonce(manager, slot), manager->nonceSize);
+    manager->count--;
+}
+
+// Removes all expired nonces. Runs only when the set is full, at most once per expiry time.
+static void PurgeExpired(GfnCloudCheckNonceManager* manager, uint64_t now)
+{
+    uint64_t nextPurgeMs = now + manager->lifetimeMs;
+    size_t slot = 0;
+
+    while (slot <= manager->mask)
+    {
+        uint64_t expiresAt = manager->expiresAt[slot];
+        if (expiresAt != 0 && expiresAt <= now)
+        {
+            // Backward shift may move an unvisited entry into this slot, so look at it again
+            RemoveSlot(manager, slot);
+            manager->stats.expired++;
+            continue;
+        }
+        if (expiresAt != 0 && expiresAt < nextPurgeMs)
+        {
+            nextPurgeMs = expiresAt;
+        }
+        slot++;
+    }
+    manager->nextPurgeMs = nextPurgeMs;
+}
+
+// Takes nonceSize random bytes from the prefetched pool, refilling it in one call when exhausted
+static bool TakeRandomBytes(GfnCloudCheckNonceManager* manager, unsigned char* dest)
+{
+    if (manager->poolSize - manager->poolUsed < manager->nonceSize)
+    {
+        if (!GfnCloudCheckGenerateNonce((char*)manager->pool, manager->poolSize))
+        {
+            return false;
+        }
+        manager->poolUsed = 0;
+        manager->stats.refills++;
+    }
+
+    memcpy(dest, manager->pool + manager->poolUsed, manager->nonceSize);
+    WipeMemory(manager->pool + manager->poolUsed, manager->nonceSize);
+    manager->poolUsed += manager->nonceSize;
+    return true;
+}
+
+GfnCloudCheckNonceManager* GfnCloudCheckNonceManagerCreate(const GfnCloudCheckNonceManagerConfig* config)
+{
+    GfnCloudCheckNonceManager* manager = NULL;
+    unsigned int nonceSize = (config != NULL && config->nonceSize != 0) ? config->nonceSize : DEFAULT_NONCE_SIZE;
+    unsigned int capacity = (config != NULL && config->capacity != 0) ? config->capacity : DEFAULT_CAPACITY;
+    uint64_t lifetimeMs = (config != NULL && config->lifetimeMs != 0) ? config->lifetimeMs : DEFAULT_LIFETIME_MS;
+    unsigned int prefetchSize = (config != NULL && config->prefetchSize != 0) ? config->prefetchSize : DEFAULT_PREFETCH_NONCES * nonceSize;
+    size_t slots = 16;
+
+    if (nonceSize < MIN_NONCE_SIZE || nonceSize > GFN_CLOUD_CHECK_NONCE_MAX_SIZE || capacity > MAX_CAPACITY || prefetchSize < nonceSize)
+    {
+        GFN_CC_LOG("Invalid nonce manager configuration\n");
+        return NULL;
+    }
+    while (slots < (size_t)capacity * 2)
+    {
+        slots *= 2;
+    }
+
+    manager = (GfnCloudCheckNonceManager*)GFN_CC_MALLOC(sizeof(GfnCloudCheckNonceManager));
+    if (manager == NULL)
+    {
+        GFN_CC_LOG("Failed to allocate nonce manager\n");
+        return NULL;
+    }
+    memset(manager, 0, sizeof(*manager));
+    manager->nonceSize = nonceSize;
+    manager->capacity = capacity;
+    manager->lifetimeMs = lifetimeMs;
+    manager->mask = slots - 1;
+    // Round down to whole nonces; the pool starts empty and is filled on first use
+    manager->poolSize = prefetchSize - prefetchSize % nonceSize;
+    manager->poolUsed = manager->poolSize;
+
+    manager->expiresAt = (uint64_t*)GFN_CC_MALLOC(slots * sizeof(uint64_t));
+    manager->nonces = (unsigned char*)GFN_CC_MALLOC(slots * nonceSize);
+    manager->pool = (unsigned char*)GFN_CC_MALLOC(manager->poolSize);
+    if (manager->expiresAt == NULL || manager->nonces == NULL || manager->pool == NULL)
+    {
+        GFN_CC_LOG("Failed to allocate nonce manager storage\n");
+        goto fail;
+    }
+    memset(manager->expiresAt, 0, slots * sizeof(uint64_t));
+    memset(manager->nonces, 0, slots * nonceSize);
+    memset(manager->pool, 0, manager->poolSize);
+
+    if (!GfnCloudCheckGenerateNonce((char*)&manager->hashSeed, sizeof(manager->hashSeed)))
+    {
+        goto fail;
+    }
+
+    NonceLockInit(&manager->lock);
+    return manager;
+
+fail:
+    GFN_CC_FREE(manager->expiresAt);
+    GFN_CC_FREE(manager->nonces);
+    GFN_CC_FREE(manager->pool);
+    GFN_CC_FREE(manager);
+    return NULL;
+}
+
+void GfnCloudCheckNonceManagerDestroy(GfnCloudCheckNonceManager* manager)
+{
+    if (manager == NULL)
+    {
+        return;
+    }
+
+    NonceLockDestroy(&manager->lock);
+    WipeMemory(manager->nonces, (manager->mask + 1) * manager->nonceSize);
+    WipeMemory(manager->pool, manager->poolSize);
+    GFN_CC_FREE(manager->expiresAt);
+    GFN_CC_FREE(manager->nonces);
+    GFN_CC_FREE(manager->pool);
+    GFN_CC_FREE(manager);
+}
+
+unsigned int GfnCloudCheckNonceManagerGetNonceSize(const GfnCloudCheckNonceManager* manager)
+{
+    return manager->nonceSize;
+}
+
+bool GfnCloudCheckNonceManagerIssue(GfnCloudCheckNonceManager* manager, char* nonce)
+{
+    uint64_t now = GetMonotonicTimeMs();
+    size_t slot = 0;
+    bool result = false;
+
+    NonceLockAcquire(&manager->lock);
+
+    if (manager->count >= manager->capacity && now >= manager->nextPurgeMs)
+    {
+        PurgeExpired(manager, now);
+    }
+    if (manager->count >= manager->capacity)
+    {
+        GFN_CC_LOG("Too many outstanding nonces (%u)\n", manager->count);
+        goto end;
+    }
+
+    // A repeated draw is astronomically unlikely, but would make two challenges indistinguishable
+    do
+    {
+        if (!TakeRandomBytes(manager, (unsigned char*)nonce))
+        {
+            goto end;
+        }
+        slot = FindSlot(manager, (const unsigned char*)nonce);
+    } while (manager->expiresAt[slot] != 0);
+
+    memcpy(SlotNonce(manager, slot), nonce, manager->nonceSize);
+    manager->expiresAt[slot] = now + manager->lifetimeMs;
+    manager->count++;
+    manager->stats.issued++;
+    result = true;
+
+end:
+    if (!result)
+    {
+        manager->stats.issueFailures++;
+    }
+    NonceLockRelease(&manager->lock);
+    return result;
+}
+
+GfnCloudCheckNonceStatus GfnCloudCheckNonceManagerConsume(GfnCloudCheckNonceManager* manager, const char* nonce)
+{
+    uint64_t now = GetMonotonicTimeMs();
+    GfnCloudCheckNonceStatus status = GfnCloudCheckNonceUnknown;
+    size_t slot = 0;
+
+    NonceLockAcquire(&manager->lock);
+
+    slot = FindSlot(manager, (const unsigned char*)nonce);
+    if (manager->expiresAt[slot] == 0)
+    {
+        manager->stats.unknown++;
+    }
+    else
+    {
+        status = (manager->expiresAt[slot] <= now) ? GfnCloudCheckNonceExpired : GfnCloudCheckNonceValid;
+        if (status == GfnCloudCheckNonceValid)
+        {
+            manager->stats.consumed++;
+        }
+        else
+        {
+            manager->stats.expired++;
+        }
+        RemoveSlot(manager, slot);
+    }
+
+    NonceLockRelease(&manager->lock);
+    return status;
+}
+
+GfnCloudCheckNonceStatus GfnCloudCheckNonceManagerVerifyAttestation(GfnCloudCheckNonceManager* manager,
+    GfnCloudCheckVerifier* verifier, const char* jwt, const char* nonce)
+{
+    GfnCloudCheckNonceStatus status = GfnCloudCheckNonceManagerConsume(manager, nonce);
+    bool valid = false;
+
+    if (status != GfnCloudCheckNonceValid)
+    {
+        return status;
+    }
+
+    valid = (verifier != NULL) ?
+        GfnCloudCheckVerifierVerify(verifier, jwt, nonce, manager->nonceSize) :
+        GfnCloudCheckVerifyAttestationData(jwt, nonce, manager->nonceSize);
+    return valid ? GfnCloudCheckNonceValid : GfnCloudCheckNonceAttestationInvalid;
+}
+
+void GfnCloudCheckNonceManagerGetStats(GfnCloudCheckNonceManager* manager, GfnCloudCheckNonceManagerStats* stats)
+{
+    NonceLockAcquire(&manager->lock);
+    *stats = manager->stats;
+    stats->outstanding = manager->count;
+    NonceLockRelease(&manager->lock);
+}
@@ -0,0 +1,140 @@
+// This header file contains the nonce manager used to issue CloudCheck challenges and to reject
+// replayed or expired attestations. It hands out nonces from random bytes prefetched in large
+// batches and tracks issued, unconsumed nonces in a time-bounded open-addressing hash set.
+// Game/application devs are free to use this implementation (*.h/*.c) files and integrate
+// within their build system.
+
+#ifndef __GFN_CLOUD_CHECK_NONCE_H__
+#define __GFN_CLOUD_CHECK_NONCE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <GfnCloudCheckUtils.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Maximum nonce size supported by the nonce manager, in bytes.
+     */
+#define GFN_CLOUD_CHECK_NONCE_MAX_SIZE 64
+
+    /**
+     * @brief Configuration of a nonce manager. Zero members select the defaults.
+     */
+    typedef struct GfnCloudCheckNonceManagerConfig
+    {
+        unsigned int nonceSize;         ///< Size of each nonce in bytes, 16 to GFN_CLOUD_CHECK_NONCE_MAX_SIZE. Default 32.
+        unsigned int capacity;          ///< Maximum number of outstanding nonces. Default 65536.
+        uint64_t lifetimeMs;            ///< Time after issue at which a nonce expires. Default 60000.
+        unsigned int prefetchSize;      ///< Random bytes fetched per refill. Default 256 nonces.
+    } GfnCloudCheckNonceManagerConfig;
+
+    /**
+     * @brief Result of consuming a nonce.
+     */
+    typedef enum GfnCloudCheckNonceStatus
+    {
+        GfnCloudCheckNonceValid = 0,            ///< The nonce was outstanding and is now consumed
+        GfnCloudCheckNonceUnknown,              ///< Never issued by this manager, or already consumed (replay)
+        GfnCloudCheckNonceExpired,              ///< Issued, but its lifetime has passed; now removed
+        GfnCloudCheckNonceAttestationInvalid    ///< The nonce was consumed, but the attestation data failed verification
+    } GfnCloudCheckNonceStatus;
+
+    /**
+     * @brief Counters of a nonce manager.
+     */
+    typedef struct GfnCloudCheckNonceManagerStats
+    {
+        uint64_t issued;            ///< Nonces handed out
+        uint64_t consumed;          ///< Nonces consumed before they expired
+        uint64_t unknown;           ///< Consume attempts with unknown or replayed nonces
+        uint64_t expired;           ///< Nonces that expired, whether consumed late or purged
+        uint64_t issueFailures;     ///< Issue calls that failed because the set was full or the RNG failed
+        uint64_t refills;           ///< Calls to the random number generator
+        unsigned int outstanding;   ///< Nonces currently in the set, including expired ones not purged yet
+    } GfnCloudCheckNonceManagerStats;
+
+    /**
+     * @brief Opaque nonce manager.
+     *
+     * All functions taking a manager can be called concurrently from any thread.
+     */
+    typedef struct GfnCloudCheckNonceManager GfnCloudCheckNonceManager;
+
+    /**
+     * @brief Creates a nonce manager.
+     *
+     * @param config The configuration, or NULL for the defaults.
+     *
+     * @return The manager, or NULL if the configuration is invalid or an allocation fails.
+     */
+    GfnCloudCheckNonceManager* GfnCloudCheckNonceManagerCreate(const GfnCloudCheckNonceManagerConfig* config);
+
+    /**
+     * @brief Destroys a nonce manager, wiping the prefetched random bytes and outstanding nonces.
+     */
+    void GfnCloudCheckNonceManagerDestroy(GfnCloudCheckNonceManager* manager);
+
+    /**
+     * @brief Returns the size in bytes of the nonces issued by the manager.
+     */
+    unsigned int GfnCloudCheckNonceManagerGetNonceSize(const GfnCloudCheckNonceManager* manager);
+
+    /**
+     * @brief Issues a new nonce and records it as outstanding until it is consumed or expires.
+     *
+     * The random bytes come from a prefetched batch, so the random number generator is called
+     * once per prefetchSize bytes rather than once per nonce.
+     *
+     * @param manager The nonce manager.
+     * @param nonce Storage for the nonce, GfnCloudCheckNonceManagerGetNonceSize bytes.
+     *
+     * @return true if the nonce is issued, false if capacity nonces are outstanding and none
+     *         has expired, or the random number generator failed.
+     */
+    bool GfnCloudCheckNonceManagerIssue(GfnCloudCheckNonceManager* manager, char* nonce);
+
+    /**
+     * @brief Consumes an outstanding nonce in O(1).
+     *
+     * Lookup and removal happen atomically: of several concurrent calls with the same nonce,
+     * exactly one returns GfnCloudCheckNonceValid.
+     *
+     * @param manager The nonce manager.
+     * @param nonce The nonce, GfnCloudCheckNonceManagerGetNonceSize bytes.
+     *
+     * @return GfnCloudCheckNonceValid, GfnCloudCheckNonceUnknown or GfnCloudCheckNonceExpired.
+     */
+    GfnCloudCheckNonceStatus GfnCloudCheckNonceManagerConsume(GfnCloudCheckNonceManager* manager, const char* nonce);
+
+    /**
+     * @brief Consumes the nonce, then validates the attestation data returned for it.
+     *
+     * Replayed, unknown and expired nonces are rejected before any parsing or cryptography.
+     * The nonce is consumed even if the attestation data turns out to be invalid.
+     *
+     * @param manager The nonce manager.
+     * @param verifier The verifier to use, or NULL to use the calling thread's verifier.
+     * @param jwt The attestation data (JWT) to validate.
+     * @param nonce The nonce the attestation data was requested with.
+     *
+     * @return GfnCloudCheckNonceValid if the nonce was outstanding and the attestation data is valid,
+     *         otherwise the reason it was rejected.
+     */
+    GfnCloudCheckNonceStatus GfnCloudCheckNonceManagerVerifyAttestation(GfnCloudCheckNonceManager* manager,
+        GfnCloudCheckVerifier* verifier, const char* jwt, const char* nonce);
+
+    /**
+     * @brief Retrieves the counters of a nonce manager.
+     */
+    void GfnCloudCheckNonceManagerGetStats(GfnCloudCheckNonceManager* manager, GfnCloudCheckNonceManagerStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__GFN_CLOUD_CHECK_NONCE_H__
@@ -5,6 +5,9 @@
 #ifndef __GFN_CLOUD_CHECK_UTILS_H__
 #define __GFN_CLOUD_CHECK_UTILS_H__
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +29,7 @@ extern "C" {
      * @brief Validates attestation data received in CloudCheck API response represented as a JWT.
      *
      * This function performs a series of steps to validate the integrity of attestation data.
+     * It can be called from any thread; each calling thread gets its own GfnCloudCheckVerifier.
      *
      * @param attestationData The attestation data in JWT format.
      * @param nonce The nonce value to match with the value in the payload.
@@ -34,6 +38,272 @@ extern "C" {
      */
     bool GfnCloudCheckVerifyAttestationData(const char* jwt, const char* nonce, unsigned int nonceSize);
 
+    /**
+     * @brief Returns the scratch buffer size needed to verify a JWT of the given length.
+     *
+     * @param jwtLength The length of the JWT in characters, without the NUL terminator.
+     *
+     * @return The minimum scratch size in bytes for GfnCloudCheckVerifyAttestationDataWithScratch.
+     */
+    size_t GfnCloudCheckGetVerificationScratchSize(size_t jwtLength);
+
+    /**
+     * @brief Validates attestation data using a caller-provided scratch buffer.
+     *
+     * Behaves like GfnCloudCheckVerifyAttestationData, but the JWT is parsed in place and all
+     * decoded data is kept in the scratch buffer, so the helpers make no heap allocations
+     * (GFN_CC_MALLOC) on the success path. The scratch buffer can be reused across calls
+     * but not shared between concurrent calls.
+     *
+     * @param jwt The attestation data in JWT format.
+     * @param nonce The nonce value to match with the value in the payload.
+     * @param nonceSize The size of nonce in bytes.
+     * @param scratch Scratch buffer of at least GfnCloudCheckGetVerificationScratchSize(strlen(jwt)) bytes.
+     * @param scratchSize The size of the scratch buffer in bytes.
+     *
+     * @return true if the JWT response is valid, false otherwise.
+     */
+    bool GfnCloudCheckVerifyAttestationDataWithScratch(const char* jwt, const char* nonce, unsigned int nonceSize, void* scratch, size_t scratchSize);
+
+    /**
+     * @brief Counters of the verified certificate-chain cache.
+     */
+    typedef struct GfnCloudCheckChainCacheStats
+    {
+        uint64_t hits;      ///< Verifications that reused a previously validated chain
+        uint64_t misses;    ///< Verifications that performed full chain validation
+    } GfnCloudCheckChainCacheStats;
+
+    /**
+     * @brief Sets how long a validated certificate chain is reused.
+     *
+     * Attestation data signed by a chain that was validated within the TTL, and whose certificates
+     * have not expired, only needs its signature checked. The default TTL is one hour.
+     * On Windows, chain validation is cached by CryptoAPI and this setting has no effect.
+     *
+     * @param ttlSeconds Time to keep a validated chain. 0 disables and clears the cache.
+     */
+    void GfnCloudCheckSetChainCacheTtl(unsigned int ttlSeconds);
+
+    /**
+     * @brief Removes all validated certificate chains from the cache.
+     */
+    void GfnCloudCheckClearChainCache(void);
+
+    /**
+     * @brief Retrieves the chain cache hit and miss counters.
+     *
+     * On Windows the counters are always zero.
+     *
+     * @param stats Storage for the counters.
+     */
+    void GfnCloudCheckGetChainCacheStats(GfnCloudCheckChainCacheStats* stats);
+
+    /**
+     * @brief Opaque attestation verifier.
+     *
+     * A verifier owns the parsed pinned roots, the OpenSSL store and digest contexts, a chain cache
+     * and scratch memory, all reused across verifications. On Windows it owns the pinned root store,
+     * a chain engine that trusts only those roots, the SHA-512 provider and scratch memory; chain
+     * results are cached by CryptoAPI instead. Verifiers share no state with each other,
+     * so any number of them can verify concurrently; a single verifier must not be used by more
+     * than one thread at a time. Create one verifier per thread.
+     */
+    typedef struct GfnCloudCheckVerifier GfnCloudCheckVerifier;
+
+    /**
+     * @brief Creates a verifier and parses the pinned root certificates into it.
+     *
+     * The chain cache of the verifier starts with the TTL set by GfnCloudCheckSetChainCacheTtl.
+     *
+     * @return The verifier, or NULL on failure. Release with GfnCloudCheckVerifierDestroy.
+     */
+    GfnCloudCheckVerifier* GfnCloudCheckVerifierCreate(void);
+
+    /**
+     * @brief Validates attestation data with a verifier.
+     *
+     * Performs the same checks as GfnCloudCheckVerifyAttestationData. After the first call, the
+     * helpers make no heap allocations (GFN_CC_MALLOC) unless a longer JWT than before is verified.
+     *
+     * @param verifier The verifier, not used concurrently by another thread.
+     * @param jwt The attestation data in JWT format.
+     * @param nonce The nonce value to match with the value in the payload.
+     * @param nonceSize The size of nonce in bytes.
+     *
+     * @return true if the JWT response is valid, false otherwise.
+     */
+    bool GfnCloudCheckVerifierVerify(GfnCloudCheckVerifier* verifier, const char* jwt, const char* nonce, unsigned int nonceSize);
+
+    /**
+     * @brief Releases a verifier and everything it owns.
+     *
+     * @param verifier The verifier to release. NULL is ignored.
+     */
+    void GfnCloudCheckVerifierDestroy(GfnCloudCheckVerifier* verifier);
+
+    /**
+     * @brief Retrieves the hit and miss counters of the private chain cache of a verifier.
+     *
+     * On Windows the counters are always zero.
+     *
+     * @param verifier The verifier.
+     * @param stats Storage for the counters.
+     */
+    void GfnCloudCheckVerifierGetChainCacheStats(const GfnCloudCheckVerifier* verifier, GfnCloudCheckChainCacheStats* stats);
+
+    /**
+     * @brief Starts the worker pool used by GfnCloudCheckVerifyAttestationBatch.
+     *
+     * Each worker owns a GfnCloudCheckVerifier. Calling this is optional: the first batch starts
+     * one worker per online CPU. On Windows the workers are threads of a private Windows thread
+     * pool, each using the verifier of its thread, and the calling thread verifies alongside them.
+     *
+     * @param workerCount The number of workers, or 0 for one per online CPU.
+     *
+     * @return true if the workers started, false on failure or if the pool is already running.
+     */
+    bool GfnCloudCheckInitializeBatchVerification(unsigned int workerCount);
+
+    /**
+     * @brief Validates a batch of attestation JWTs on the worker pool.
+     *
+     * Each JWT is checked as by GfnCloudCheckVerifyAttestationData. JWTs with byte-identical
+     * headers carry the same certificate chain, which is then validated only once per batch
+     * (on Windows, CryptoAPI caches the chain validation instead).
+     * Batches submitted from several threads are run one after the other.
+     *
+     * @param jwts The attestation data in JWT format, one per item.
+     * @param nonces The nonce expected in the payload of each JWT.
+     * @param nonceSize The size of every nonce in bytes.
+     * @param results Storage for the validation result of each JWT.
+     * @param count The number of items.
+     *
+     * @return true if the batch was processed and results are set, false if it could not be run
+     *         (all results are then false).
+     */
+    bool GfnCloudCheckVerifyAttestationBatch(const char* const jwts[], const char* const nonces[], unsigned int nonceSize, bool results[], size_t count);
+
+    /**
+     * @brief Stops the batch worker pool and releases its verifiers.
+     *
+     * Waits for a batch in progress to complete. A later batch restarts the pool.
+     */
+    void GfnCloudCheckShutdownBatchVerification(void);
+
+    /**
+     * @brief State of an asynchronous verification.
+     */
+    typedef enum GfnCloudCheckAsyncStatus
+    {
+        GfnCloudCheckAsyncPending = 0,  ///< Queued or in progress
+        GfnCloudCheckAsyncValid,        ///< The JWT response is valid
+        GfnCloudCheckAsyncInvalid,      ///< The JWT response is not valid, or could not be verified
+        GfnCloudCheckAsyncCanceled      ///< Dropped from the queue by GfnCloudCheckShutdownAsyncVerification
+    } GfnCloudCheckAsyncStatus;
+
+    /**
+     * @brief Handle of an asynchronous verification.
+     */
+    typedef struct GfnCloudCheckAsyncVerification GfnCloudCheckAsyncVerification;
+
+    /**
+     * @brief Receives the result of an asynchronous verification.
+     *
+     * Invoked on the background worker, or on the thread calling GfnCloudCheckShutdownAsyncVerification
+     * for canceled verifications. Must not block for long, as it delays the verifications queued after it.
+     *
+     * @param status GfnCloudCheckAsyncValid, GfnCloudCheckAsyncInvalid or GfnCloudCheckAsyncCanceled.
+     * @param context The context passed to GfnCloudCheckVerifyAttestationDataAsync.
+     */
+    typedef void (*GfnCloudCheckAsyncCallback)(GfnCloudCheckAsyncStatus status, void* context);
+
+    /**
+     * @brief Queues validation of attestation data to a background worker.
+     *
+     * Performs the same checks as GfnCloudCheckVerifyAttestationData without blocking the calling
+     * thread. The JWT and nonce are copied, so the response can be released with GfnFree as soon
+     * as this function returns. Verifications complete in the order they were queued.
+     *
+     * @param jwt The attestation data in JWT format.
+     * @param nonce The nonce value to match with the value in the payload.
+     * @param nonceSize The size of nonce in bytes.
+     * @param callback Optional callback receiving the result.
+     * @param context Passed to the callback.
+     * @param handle Optional storage for a handle to poll or wait on the result. Must be released
+     *        with GfnCloudCheckReleaseAsyncVerification. At least one of callback and handle is required.
+     *
+     * @return true if the verification was queued, false otherwise (the callback is not invoked).
+     */
+    bool GfnCloudCheckVerifyAttestationDataAsync(const char* jwt, const char* nonce, unsigned int nonceSize,
+        GfnCloudCheckAsyncCallback callback, void* context, GfnCloudCheckAsyncVerification** handle);
+
+    /**
+     * @brief Returns the current state of an asynchronous verification without blocking.
+     *
+     * @param handle The handle returned by GfnCloudCheckVerifyAttestationDataAsync.
+     *
+     * @return The state of the verification. GfnCloudCheckAsyncInvalid for a NULL handle.
+     */
+    GfnCloudCheckAsyncStatus GfnCloudCheckPollAsyncVerification(GfnCloudCheckAsyncVerification* handle);
+
+    /**
+     * @brief Waits for an asynchronous verification to complete.
+     *
+     * @param handle The handle returned by GfnCloudCheckVerifyAttestationDataAsync.
+     * @param timeoutMs Maximum time to wait in milliseconds.
+     *
+     * @return The state of the verification, GfnCloudCheckAsyncPending if the timeout expired.
+     */
+    GfnCloudCheckAsyncStatus GfnCloudCheckWaitAsyncVerification(GfnCloudCheckAsyncVerification* handle, unsigned int timeoutMs);
+
+    /**
+     * @brief Releases a handle. The verification itself still completes and invokes its callback.
+     *
+     * @param handle The handle to release. NULL is ignored.
+     */
+    void GfnCloudCheckReleaseAsyncVerification(GfnCloudCheckAsyncVerification* handle);
+
+    /**
+     * @brief Stops the background worker.
+     *
+     * Waits for the verification in progress to complete, and completes the queued ones with
+     * GfnCloudCheckAsyncCanceled. A later GfnCloudCheckVerifyAttestationDataAsync restarts the worker.
+     */
+    void GfnCloudCheckShutdownAsyncVerification(void);
+
+#ifdef GFN_CLOUD_CHECK_ENABLE_TEST_HOOKS
+    /**
+     * @brief Replaces the pinned root certificates with test roots. Test builds only.
+     *
+     * Must be called before the first verifier is created, which includes the first call to
+     * GfnCloudCheckVerifyAttestationData. A NULL argument keeps the corresponding pinned root.
+     *
+     * @param pemRootCert1 PEM encoded replacement for the first pinned root. Must outlive all verifications.
+     * @param pemRootCert2 PEM encoded replacement for the second pinned root. Must outlive all verifications.
+     *
+     * @return true if the test roots will be used, false if a verifier was already created.
+     */
+    bool GfnCloudCheckSetTestRootCertificates(const char* pemRootCert1, const char* pemRootCert2);
+
+    /**
+     * @brief Allocation counters of the GFN_CC_MALLOC/GFN_CC_FREE hooks. Test builds only.
+     */
+    typedef struct GfnCloudCheckAllocationStats
+    {
+        uint64_t allocations;   ///< Number of GFN_CC_MALLOC calls
+        uint64_t frees;         ///< Number of GFN_CC_FREE calls
+        uint64_t bytes;         ///< Total bytes requested through GFN_CC_MALLOC
+    } GfnCloudCheckAllocationStats;
+
+    /**
+     * @brief Retrieves the cumulative allocation counters of the CloudCheck utils. Test builds only.
+     *
+     * @param stats Storage for the counters.
+     */
+    void GfnCloudCheckGetTestAllocationStats(GfnCloudCheckAllocationStats* stats);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,11 +4,15 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include <openssl/err.h>
 #include <openssl/rand.h>
 #include <openssl/evp.h>
 #include <openssl/pem.h>
+#include <openssl/sha.h>
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
 #include <openssl/x509_vfy.h>
@@ -16,6 +20,38 @@
 
 #include <GfnCloudCheckUtils.h>
 #include <GfnCloudCheckAppAdapter.h>
+#include <GfnCloudCheckBase64.h>
+#include <GfnCloudCheckJson.h>
+
+#ifdef GFN_CLOUD_CHECK_ENABLE_TEST_HOOKS
+#include <stdatomic.h>
+
+// Test builds count every allocation made through the adapter hooks
+static atomic_uint_fast64_t s_TestAllocations = 0;
+static atomic_uint_fast64_t s_TestFrees = 0;
+static atomic_uint_fast64_t s_TestAllocatedBytes = 0;
+
+static void* TestHookMalloc(size_t size)
+{
+    atomic_fetch_add(&s_TestAllocations, 1);
+    atomic_fetch_add(&s_TestAllocatedBytes, size);
+    return GFN_CC_MALLOC(size);
+}
+
+static void TestHookFree(void* ptr)
+{
+    if (ptr != NULL)
+    {
+        atomic_fetch_add(&s_TestFrees, 1);
+    }
+    GFN_CC_FREE(ptr);
+}
+
+#undef GFN_CC_MALLOC
+#undef GFN_CC_FREE
+#define GFN_CC_MALLOC(size) TestHookMalloc(size)
+#define GFN_CC_FREE(ptr) TestHookFree(ptr)
+#endif
 
 char s_RootPublicCert1[] =
     "-----BEGIN CERTIFICATE-----\n"
@@ -92,6 +128,75 @@ char s_RootPublicCert2[] =
 
 #define MAX_NUMBER_OF_X5C_CERTS  3
 #define MAX_CERTIFICATE_CHAIN_LEN  4
+#define NUMBER_OF_PINNED_ROOT_CERTS  2
+// Extra room per decode so the vectorized base64 kernels can use full-width stores up to the end
+#define GFN_CC_BASE64_VECTOR_SLACK  32
+
+#ifdef GFN_CLOUD_CHECK_ENABLE_TEST_HOOKS
+static const char* s_TestRootPemCerts[NUMBER_OF_PINNED_ROOT_CERTS] = { NULL, NULL };
+static atomic_bool s_VerifierCreated = false;
+#endif
+
+#define CHAIN_CACHE_MAX_ENTRIES  8
+#define CHAIN_CACHE_DEFAULT_TTL_SECONDS  3600
+
+/*
+ * Cache of certificate chains that already passed validation, keyed by the SHA-256 of the
+ * concatenated DER encoding of the x5c certificates. An entry holds a reference to the leaf
+ * public key and expires at the earliest notAfter of the verified chain or after the TTL,
+ * whichever comes first. The least recently used entry is evicted when the cache is full.
+ */
+typedef struct GfnCloudCheckChainCacheEntry
+{
+    bool valid;
+    unsigned char fingerprint[SHA256_DIGEST_LENGTH];
+    EVP_PKEY* leafPubKey;
+    time_t expiresAt;
+    uint64_t lastUsed;
+} GfnCloudCheckChainCacheEntry;
+
+typedef struct GfnCloudCheckChainCache
+{
+    pthread_mutex_t lock;
+    unsigned int ttlSeconds;
+    uint64_t useCounter;
+    uint64_t hits;
+    uint64_t misses;
+    GfnCloudCheckChainCacheEntry entries[CHAIN_CACHE_MAX_ENTRIES];
+} GfnCloudCheckChainCache;
+
+static GfnCloudCheckChainCache s_ChainCache = { PTHREAD_MUTEX_INITIALIZER, CHAIN_CACHE_DEFAULT_TTL_SECONDS, 0, 0, 0, { { 0 } } };
+
+/*
+ * Everything a verification needs, owned by one verifier so that verifiers on different threads
+ * share no state. The pinned roots are parsed into the trust store once at creation, and the
+ * store context, digest contexts, certificate stacks and scratch memory are reused across calls.
+ * Verifiers created through GfnCloudCheckVerifierCreate have a private chain cache; the per-thread
+ * verifiers behind GfnCloudCheckVerifyAttestationData use the process-wide s_ChainCache.
+ */
+struct GfnCloudCheckVerifier
+{
+    X509* rootCerts[NUMBER_OF_PINNED_ROOT_CERTS];
+    X509_STORE* trustStore;
+    X509_STORE_CTX* storeCtx;
+    EVP_MD_CTX* signatureCtx;
+    EVP_MD_CTX* fingerprintCtx;
+    STACK_OF(X509)* certChain;
+    STACK_OF(X509)* untrustedCerts;
+    GfnCloudCheckChainCache* chainCache;
+    GfnCloudCheckChainCache ownChainCache;
+    unsigned char* scratch;
+    size_t scratchSize;
+};
+
+/*
+ * DER encoding of a certificate received in the x5c field of the JWT header.
+ */
+typedef struct GfnCloudCheckDerCert
+{
+    unsigned char* der;
+    size_t derLen;
+} GfnCloudCheckDerCert;
 
 /**
  * @brief Generates a random nonce.
@@ -115,504 +220,297 @@ bool GfnCloudCheckGenerateNonce(char* buffer, unsigned int bufferSize)
 }
 
 
+/*
+ * Bump allocator over the single scratch buffer of a verification. All intermediate data
+ * (decoded JWT segments, x5c DER certificates and the decoded nonce) is carved out of it,
+ * so parsing does not touch the heap.
+ */
+typedef struct GfnCloudCheckArena
+{
+    unsigned char* base;
+    size_t size;
+    size_t used;
+} GfnCloudCheckArena;
+
 /**
- * @brief Decodes a Base64-encoded string and returns the decoded data.
- *
- * This function takes a Base64-encoded string and decodes it into raw binary data.
+ * @brief Reserves memory from the scratch arena.
  *
- * @param src The Base64-encoded string to be decoded.
- * @param dest A pointer to the destination buffer where the decoded data will be stored.
- *             The caller is responsible for freeing this buffer.
+ * @param arena The scratch arena.
+ * @param size The number of bytes to reserve.
  *
- * @return The length of the decoded data in bytes. Returns 0 if the decoding fails.
+ * @return Pointer to the reserved memory, or NULL if the arena is exhausted.
  */
-static int Base64Decode(const char* src, unsigned char** dest)
+static unsigned char* ArenaAlloc(GfnCloudCheckArena* arena, size_t size)
 {
-    unsigned char decodeTable[256];
-    unsigned char* output = NULL;
-    unsigned char* outputPosition = 0;
-    unsigned char block[4];
-    unsigned char decodedCharacter;
-    size_t inputLength = 0;
-    size_t outputLength = 0;
-    int padding = 0;
-    int count = 0;
-    int encodedBytes = 0;
-    const unsigned char base64Table[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    unsigned char* memory = NULL;
 
-    // Generate decode table
-    memset(decodeTable, 0x80, 256);
-    for (int i = 0; i < 64; i++)
+    if (size > arena->size - arena->used)
     {
-        decodeTable[base64Table[i]] = (unsigned char)i;
+        GFN_CC_LOG("Verification scratch buffer exhausted\n");
+        return NULL;
     }
-    decodeTable['='] = 0;
+    memory = arena->base + arena->used;
+    arena->used += size;
+    return memory;
+}
 
-    // Calculate length of output buffer
-    inputLength = strlen(src);
-    if (inputLength == 0)
-    {
-        GFN_CC_LOG("Empty src string\n");
-        return 0;
-    }
-    for (size_t i = 0; i < inputLength; i++)
-    {
-        if (decodeTable[(uint8_t)src[i]] != 0x80)
-        {
-            encodedBytes++;
-        }
-    }
-    if (encodedBytes == 0)
+/**
+ * @brief Decodes Base64 or Base64Url encoded data into the scratch arena.
+ *
+ * @param src The encoded data. Does not need to be NUL-terminated.
+ * @param srcLen The length of the encoded data.
+ * @param alphabet The alphabet of the encoded data.
+ * @param arena The scratch arena the decoded data is stored in.
+ * @param dest Storage for a pointer to the decoded data.
+ * @param destLen Storage for the length of the decoded data.
+ *
+ * @return true if the data is well-formed and at least one byte is decoded, false otherwise.
+ */
+static bool Base64DecodeToArena(const char* src, size_t srcLen, GfnBase64Alphabet alphabet, GfnCloudCheckArena* arena, unsigned char** dest, size_t* destLen)
+{
+    unsigned char* output = NULL;
+    size_t outputLen = 0;
+    size_t reservedLen = GfnBase64DecodedMaxLength(srcLen) + GFN_CC_BASE64_VECTOR_SLACK;
+    size_t errorOffset = 0;
+    GfnBase64Status status = GfnBase64Success;
+
+    output = ArenaAlloc(arena, reservedLen);
+    if (output == NULL)
     {
-        return 0;
+        return false;
     }
-    outputLength = (encodedBytes / 4) * 3;
 
-    // Allocate output buffer
-    output = (unsigned char*)GFN_CC_MALLOC(outputLength);
-    if (!output)
+    status = GfnBase64Decode(src, srcLen, alphabet, output, reservedLen, &outputLen, &errorOffset);
+
+    // Give the unused tail of the reservation back to the arena
+    arena->used = (output - arena->base) + (status == GfnBase64Success ? outputLen : 0);
+
+    if (status != GfnBase64Success)
     {
-        GFN_CC_LOG("Failed to allocate memory for output buffer\n");
-        return 0;
+        GFN_CC_LOG("Malformed base64 data (error %d at offset %zu of %zu)\n", (int)status, errorOffset, srcLen);
+        return false;
     }
-    memset(output, 0, outputLength);
-
-    outputPosition = output;
-    for (size_t i = 0; i < inputLength; i++)
+    if (outputLen == 0)
     {
-        decodedCharacter = decodeTable[(uint8_t)src[i]];
-        if (decodedCharacter == 0x80)
-        {
-            continue;
-        }
-        if (src[i] == '=')
-        {
-            padding++;
-        }
-        block[count] = decodedCharacter;
-        count++;
-        if (count == 4)
-        {
-            *outputPosition++ = (uint8_t)((block[0] << 2) | (block[1] >> 4));
-            *outputPosition++ = (uint8_t)((block[1] << 4) | (block[2] >> 2));
-            *outputPosition++ = (uint8_t)((block[2] << 6) | block[3]);
-            count = 0;
-
-            if (padding != 0)
-            {
-                if (padding == 1)
-                {
-                    outputPosition--;
-                }
-                else if (padding == 2)
-                {
-                    outputPosition -= 2;
-                }
-                else
-                {
-                    GFN_CC_FREE(output);
-                    return 0;
-                }
-                break;
-            }
-        }
+        GFN_CC_LOG("Empty base64 data\n");
+        return false;
     }
-    outputLength = outputPosition - output;
+
     *dest = output;
-    return outputLength;
+    *destLen = outputLen;
+    return true;
 }
 
-
 /**
- * @brief Decodes a Base64Url-encoded string and returns the decoded data.
+ * @brief Decodes the base64 contents of a JSON string value into the scratch arena.
  *
- * This function takes a Base64Url-encoded string and decodes it into raw binary data.
+ * JSON encoders may escape '/' as "\/"; such values are unescaped into the arena before decoding.
+ * Any other escape sequence is rejected, as it cannot appear in base64 data.
  *
- * @param src The Base64Url-encoded string to be decoded.
- * @param dest A pointer to the destination buffer where the decoded data will be stored.
- *             The caller is responsible for freeing this buffer.
+ * @param view The JSON string contents, as returned by the tokenizer.
+ * @param arena The scratch arena the decoded data is stored in.
+ * @param dest Storage for a pointer to the decoded data.
+ * @param destLen Storage for the length of the decoded data.
  *
- * @return The length of the decoded data in bytes. Returns 0 if the decoding fails.
+ * @return true if the value is decoded successfully, false otherwise.
  */
-static int Base64UrlDecode(const char* src, unsigned char** dest)
+static bool DecodeJsonBase64Value(const GfnJsonStringView* view, GfnCloudCheckArena* arena, unsigned char** dest, size_t* destLen)
 {
-    size_t inputLength = strlen(src);
-    size_t bufferLength = 0;
-    size_t padding = 0;
-    int destSize = 0;
+    const char* value = view->data;
+    size_t valueLen = view->length;
+    char* unescaped = NULL;
+    size_t unescapedLen = 0;
+    size_t arenaMark = arena->used;
+    bool result = false;
 
-    // Create a local buffer of (src length + 4) size for transformation
-    char* buffer = GFN_CC_MALLOC(inputLength + 4);
-    if (!buffer)
+    // The tokenizer already flagged escape sequences, so unescaped values are not scanned again
+    if (!view->escaped)
     {
-        GFN_CC_LOG("Failed to allocate local buffer\n");
-        return 0;
+        return Base64DecodeToArena(value, valueLen, GfnBase64AlphabetStandard, arena, dest, destLen);
     }
 
-    bufferLength = inputLength;
-
-    // Calculate the number of '=' characters needed to make the input size a multiple of 4
-    padding = (4 - (inputLength % 4)) % 4;
-    bufferLength += padding;
-
-    // Copy the input to the result buffer and append padding characters
-    strcpy(buffer, src);
-    for (size_t i = 0; i < padding; i++)
+    unescaped = (char*)ArenaAlloc(arena, valueLen);
+    if (unescaped == NULL)
     {
-        buffer[inputLength + i] = '=';
+        return false;
     }
-    buffer[bufferLength] = '\0';
-
-    // Replace '-' with '+' and '_' with '/'
-    for (size_t i = 0; i < bufferLength; i++)
+    for (size_t i = 0; i < valueLen; i++)
     {
-        if (buffer[i] == '-')
+        if (value[i] == '\\')
         {
-            buffer[i] = '+';
-        }
-        else if (buffer[i] == '_')
-        {
-            buffer[i] = '/';
+            if (i + 1 >= valueLen || value[i + 1] != '/')
+            {
+                GFN_CC_LOG("Unexpected escape sequence in base64 value at offset %zu\n", i);
+                arena->used = arenaMark;
+                return false;
+            }
+            i++;
         }
+        unescaped[unescapedLen++] = value[i];
+    }
+
+    result = Base64DecodeToArena(unescaped, unescapedLen, GfnBase64AlphabetStandard, arena, dest, destLen);
+    if (result)
+    {
+        // Move the decoded data over the unescaped copy, which is no longer needed
+        memmove(unescaped, *dest, *destLen);
+        *dest = (unsigned char*)unescaped;
+        arena->used = arenaMark + *destLen;
     }
+    else
+    {
+        arena->used = arenaMark;
+    }
+    return result;
+}
 
-    // Call the Base64Decode function to decode the modified buffer
-    destSize = Base64Decode(buffer, dest);
-    GFN_CC_FREE(buffer);
-    return destSize;
+/**
+ * @brief Finds the first occurrence of a character in the range [start, end).
+ *
+ * @return Pointer to the character, or NULL if not found.
+ */
+static const char* FindChar(const char* start, const char* end, char c)
+{
+    if (start >= end)
+    {
+        return NULL;
+    }
+    return memchr(start, c, end - start);
 }
 
 /**
  * @brief Parses a JSON-formatted header string to extract information.
- * Instead of utilizing a standard open-source software, a simple custom parser is implemented
- * to allow integration into games/applications without concerns about licensing/legal issues.
+ * Instead of utilizing a standard open-source software, a small streaming tokenizer
+ * (GfnCloudCheckJson.h) is used to allow integration into games/applications without
+ * concerns about licensing/legal issues.
  *
  * This function extracts information from a JSON-formatted header string,
- * specifically checking and parsing the "alg" and "x5c" fields.
+ * specifically checking and parsing the "alg" and "x5c" members of the top-level object.
+ * The header is tokenized in a single pass and strictly validated; only the decoded
+ * certificates are written to the scratch arena.
  *
  * @param header The JSON formatted header bytes to be parsed.
  * @param headerLen The length of the JSON formatted header bytes to be parsed.
- * @param pX5CCerts A pointer to an array of strings to store x5c certificates.
- *                   The caller is responsible for freeing each string and the array.
+ * @param arena The scratch arena the decoded certificates are stored in.
+ * @param pX5CCerts A pointer to an array to store the DER encoding of the x5c certificates.
  * @param numOfX5CCerts A pointer to an integer to store the number of x5c certificates found.
  *                      Set to 0 if none are found or if parsing fails.
  *
  * @return true if the header is successfully parsed, false otherwise.
  */
-static bool ParseHeaderJson(const unsigned char* header, const size_t headerLen, char** pX5CCerts, unsigned int* numOfX5CCerts)
+static bool ParseHeaderJson(const unsigned char* header, const size_t headerLen, GfnCloudCheckArena* arena, GfnCloudCheckDerCert* pX5CCerts, unsigned int* numOfX5CCerts)
 {
-    bool result = false;
-    char *headerCopy = NULL;
-    char *algValue = NULL;
-    size_t x5cCertLen = 0;
-    size_t pemCertLen = 0;
-    char* pemCert = NULL;
-    char* pemCertPtr = NULL;
-    const char* start = NULL;
-    const char* end = NULL;
-    char* algKey = NULL;
-    char* colon = NULL;
-    char* algValueStart = NULL;
-    char* algValueEnd = NULL;
-    char* x5cKey = NULL;
-    int algLen = 0;
-    char* x5cStart = NULL;
-    char* x5cEnd = NULL;
-    int i = 0;
-    char* x5cCert = NULL;
-
-    const char PemHeader[] = "-----BEGIN CERTIFICATE-----\n";
-    const char PemTrailer[] = "\n-----END CERTIFICATE-----";
-    size_t pemHeaderLen = 0;
-    size_t pemTrailerLen = 0;
+    GfnJsonStringView alg = { NULL, 0, false };
+    GfnJsonStringView x5c[MAX_NUMBER_OF_X5C_CERTS];
+    unsigned int numX5c = 0;
+    size_t errorOffset = 0;
+    GfnJsonJwtStatus status = GfnJsonJwtSuccess;
 
     *numOfX5CCerts = 0;
 
-    headerCopy = GFN_CC_MALLOC(sizeof(char) * (headerLen + 1));
-    if (headerCopy == NULL)
+    status = GfnJsonParseJwtHeader((const char*)header, headerLen, &alg, x5c, MAX_NUMBER_OF_X5C_CERTS, &numX5c, &errorOffset);
+    if (status != GfnJsonJwtSuccess)
     {
-        GFN_CC_LOG("Failed to allocate memory for copy of header\n");
+        GFN_CC_LOG("Failed to parse the header, status %d at offset %zu\n", (int)status, errorOffset);
         return false;
     }
-    memcpy(headerCopy, header, headerLen);
-    headerCopy[headerLen] = '\0';
-
-    start = strchr(headerCopy, '{');
-    end = strchr(headerCopy, '}');
-    if (start == NULL || end == NULL)
-    {
-        GFN_CC_LOG("Failed to parse start and end delimiters in the header\n");
-        result = false;
-        goto end;
-    }
-    algKey = strstr(start + 1, "\"alg\"");
-    if (algKey == NULL)
-    {
-        GFN_CC_LOG("Failed to parse alg key in the header\n");
-        result = false;
-        goto end;
-    }
-    colon = strchr(algKey, ':');
-    if (colon == NULL)
-    {
-        GFN_CC_LOG("Failed to parse alg key separator in the header\n");
-        result = false;
-        goto end;
-    }
-    algValueStart = strchr(colon + 1, '\"');
-    if (algValueStart == NULL)
-    {
-        GFN_CC_LOG("Failed to parse alg value start in the header\n");
-        result = false;
-        goto end;
-    }
-    algValueEnd = strchr(algValueStart + 1, '\"');
-    if (algValueEnd == NULL)
-    {
-        GFN_CC_LOG("Failed to parse alg value end in the header\n");
-        result = false;
-        goto end;
-    }
-    algLen = algValueEnd - algValueStart;
-    algValue = GFN_CC_MALLOC(algLen);
-    if (algValue == NULL)
-    {
-        GFN_CC_LOG("Failed to allocate memory for alg field in the header\n");
-        result = false;
-        goto end;
-    }
-    memset(algValue, 0, algLen);
-    memcpy(algValue, algValueStart + 1, algLen - 1);
-    if (strcmp(algValue, "RS512") != 0)
+    if (alg.escaped || alg.length != strlen("RS512") || memcmp(alg.data, "RS512", alg.length) != 0)
     {
         GFN_CC_LOG("Failed to verify alg field in the header\n");
-        result = false;
-        goto end;
-    }
-
-    // Parse x5c field
-    x5cKey = strstr(start + 1, "\"x5c\"");
-    if (x5cKey == NULL)
-    {
-        GFN_CC_LOG("Failed to parse x5c key in the header\n");
-        result = false;
-        goto end;
-    }
-    colon = strchr(x5cKey, ':');
-    if (colon == NULL)
-    {
-        GFN_CC_LOG("Failed to parse x5c key separator in the header\n");
-        result = false;
-        goto end;
-    }
-    x5cStart = strchr(colon + 1, '[');
-    if (x5cStart == NULL)
-    {
-        GFN_CC_LOG("Failed to parse x5c start in the header\n");
-        result = false;
-        goto end;
-    }
-    x5cEnd = strchr(x5cStart + 1, ']');
-    if (x5cEnd == NULL)
-    {
-        GFN_CC_LOG("Failed to parse x5c end in the header\n");
-        result = false;
-        goto end;
+        return false;
     }
 
-    // Extract certificates
-    i = 0;
-    x5cCert = strtok(x5cStart + 1, ",");
-
-    pemHeaderLen = strlen(PemHeader);
-    pemTrailerLen = strlen(PemTrailer);
-
-    while ((x5cCert != NULL) && (x5cCert < x5cEnd))
+    for (unsigned int i = 0; i < numX5c; i++)
     {
-        if (i >= MAX_NUMBER_OF_X5C_CERTS)
-        {
-            GFN_CC_LOG("Certificate count of %i exceeds expected %d\n", i, MAX_NUMBER_OF_X5C_CERTS);
-            result = false;
-            goto end;
-        }
-
-        x5cCertLen = strlen(x5cCert) - 2; // don't count leading and trailing '"'
-
-        pemCertLen = x5cCertLen + pemHeaderLen + pemTrailerLen + 1;
-
-        pemCert = GFN_CC_MALLOC(pemCertLen);
-        if (pemCert == NULL)
+        if (!DecodeJsonBase64Value(&x5c[i], arena, &pX5CCerts[i].der, &pX5CCerts[i].derLen))
         {
-            GFN_CC_LOG("Failed to allocate memory for x5c cert %d\n", i);
-            result = false;
-            goto end;
+            GFN_CC_LOG("Failed to decode x5c cert %u\n", i);
+            return false;
         }
-        memset(pemCert, '\0', pemCertLen);
-
-        pemCertPtr = pemCert;
-
-        memcpy(pemCertPtr, PemHeader, pemHeaderLen);
-        pemCertPtr += pemHeaderLen;
-        memcpy(pemCertPtr, x5cCert+1, x5cCertLen);
-        pemCertPtr += x5cCertLen;
-        memcpy(pemCertPtr, PemTrailer, pemTrailerLen);
-        pemCertPtr += pemTrailerLen;
-
-
-        pX5CCerts[i++] = pemCert;
-        *numOfX5CCerts = i;
-
-        // splitting with both , and ] to account for the last cert not having a
-        // trailing ,
-        x5cCert = strtok(NULL, ",]");
     }
 
-    result = true;
-
-end:
-    if (headerCopy != NULL)
-    {
-        GFN_CC_FREE(headerCopy);
-    }
-    if (algValue != NULL)
-    {
-        GFN_CC_FREE(algValue);
-    }
-    if (!result && *numOfX5CCerts > 0)
-    {
-        for (size_t i = 0; i < *numOfX5CCerts; i++)
-        {
-            if (pX5CCerts[i] != NULL)
-            {
-                GFN_CC_FREE(pX5CCerts[i]);
-                pX5CCerts[i] = NULL;
-            }
-        }
-        *numOfX5CCerts = 0;
-    }
-    return result;
+    *numOfX5CCerts = numX5c;
+    return true;
 }
 
 
 /**
  * @brief Parses a JSON-formatted payload string to verify a nonce value.
- * Instead of utilizing a standard open-source software, a simple custom parser is implemented
- * to allow integration into games/applications without concerns about licensing/legal issues.
+ * Instead of utilizing a standard open-source software, a small streaming tokenizer
+ * (GfnCloudCheckJson.h) is used to allow integration into games/applications without
+ * concerns about licensing/legal issues.
  *
- * This function extracts and decodes the "nonce" field from a JSON-formatted payload string
- * and compares it with a provided nonce value to verify its authenticity.
+ * This function extracts and decodes the "nonce" (or "ononce") member of the top-level object
+ * of a JSON-formatted payload string and compares it with a provided nonce value to verify its authenticity.
  *
  * @param payload The JSON formatted payload bytes to be parsed.
  * @param payloadLen The length of the JSON formatted payload bytes to be parsed.
+ * @param arena The scratch arena the decoded nonce is stored in.
  * @param nonce The nonce value to be compared with the decoded nonce from the payload.
  * @param nonceSize The size of nonce in bytes.
  *
  * @return true if the nonce value in the payload matches the provided nonce; false otherwise.
  */
-static bool ParsePayloadJson(const unsigned char* payload, const size_t payloadLen, const char* nonce, unsigned int nonceSize)
+static bool ParsePayloadJson(const unsigned char* payload, const size_t payloadLen, GfnCloudCheckArena* arena, const char* nonce, unsigned int nonceSize)
 {
-    bool result = false;
+    GfnJsonStringView nonceValue = { NULL, 0, false };
+    size_t errorOffset = 0;
+    GfnJsonJwtStatus status = GfnJsonJwtSuccess;
     unsigned char* decodedNonce = NULL;
+    size_t decodedNonceLen = 0;
 
-    char *payloadCopy = NULL;
-    const char* start = NULL;
-    const char* end = NULL;
-    char* nonceKey = NULL;
-    char* colon = NULL;
-    char* nonceValueStart = NULL;
-    char* nonceValueEnd = NULL;
-    int nonceLen = 0;
-    char* nonceValue = NULL;
-
-    payloadCopy = GFN_CC_MALLOC(sizeof(char) * (payloadLen + 1));
-    if (payloadCopy == NULL)
-    {
-        GFN_CC_LOG("Failed to allocate memory for copy of header\n");
-        result = false;
-        goto end;
-    }
-    memcpy(payloadCopy, payload, payloadLen);
-    payloadCopy[payloadLen] = '\0';
-
-    start = strchr(payloadCopy, '{');
-    end = strchr(payloadCopy, '}');
-    if (start == NULL || end == NULL)
-    {
-        GFN_CC_LOG("Failed to parse start and end delimiters in the payload\n");
-        result = false;
-        goto end;
-    }
-    nonceKey = strstr(start + 1, "\"nonce\"");
-    if (nonceKey == NULL)
-    {
-        nonceKey = strstr(start + 1, "\"ononce\"");
-        if (nonceKey == NULL)
-        {
-            GFN_CC_LOG("Failed to parse nonce key in the payload\n");
-            result = false;
-            goto end;
-        }
-    }
-    colon = strchr(nonceKey, ':');
-    if (colon == NULL)
-    {
-        GFN_CC_LOG("Failed to parse nonce key separator in the payload\n");
-        result = false;
-        goto end;
-    }
-    nonceValueStart = strchr(colon + 1, '\"');
-    if (nonceValueStart == NULL)
-    {
-        GFN_CC_LOG("Failed to parse nonce value start in the payload\n");
-        GFN_CC_LOG("Missing nonce field\n");
-        result = false;
-        goto end;
-    }
-    nonceValueEnd = strchr(nonceValueStart + 1, '\"');
-    if (nonceValueEnd == NULL)
+    status = GfnJsonParseJwtPayload((const char*)payload, payloadLen, &nonceValue, &errorOffset);
+    if (status != GfnJsonJwtSuccess)
     {
-        GFN_CC_LOG("Failed to parse nonce value end in the payload\n");
-        result = false;
-        goto end;
-    }
-    nonceLen = nonceValueEnd - nonceValueStart;
-    nonceValue = GFN_CC_MALLOC(nonceLen);
-    if (nonceValue == NULL)
-    {
-        GFN_CC_LOG("Failed to allocate memory for nonce value in the payload\n");
-        result = false;
-        goto end;
+        GFN_CC_LOG("Failed to parse the payload, status %d at offset %zu\n", (int)status, errorOffset);
+        return false;
     }
-    memset(nonceValue, 0, nonceLen);
-    memcpy(nonceValue, nonceValueStart + 1, (size_t)nonceLen - 1);
 
-    if (Base64Decode(nonceValue, &decodedNonce))
+    if (!DecodeJsonBase64Value(&nonceValue, arena, &decodedNonce, &decodedNonceLen))
     {
-        if (memcmp(decodedNonce, nonce, nonceSize) != 0)
-        {
-            GFN_CC_LOG("Failed to match nonce value in the payload with input nonce\n");
-            result = false;
-        }
-        else
-        {
-            result = true;
-        }
+        GFN_CC_LOG("Failed to decode nonce value in the payload\n");
+        return false;
     }
 
-end:
-    if (payloadCopy != NULL)
+    if (decodedNonceLen != nonceSize || memcmp(decodedNonce, nonce, nonceSize) != 0)
     {
-        GFN_CC_FREE(payloadCopy);
+        GFN_CC_LOG("Failed to match nonce value in the payload with input nonce\n");
+        return false;
     }
-    if (nonceValue != NULL)
+
+    return true;
+}
+
+/*
+ * @brief Create an OpenSSL X.509 object from a DER encoded certificate.
+ *
+ * @param der The DER encoded certificate.
+ * @param derLen The length of the DER encoded certificate.
+ * @param outputCert Storage location for the X.509 object
+ *
+ * @return true if X.509 object is constructed successfully, false otherwise.
+ */
+static bool CreateX509Cert(const unsigned char *der, const size_t derLen, X509 **outputCert)
+{
+    const unsigned char *derPtr = der;
+    X509 *cert = NULL;
+
+    cert = d2i_X509(NULL, &derPtr, (long)derLen);
+    if (cert == NULL)
     {
-        GFN_CC_FREE(nonceValue);
+        GFN_CC_LOG("Unable to parse certificate\n");
+        return false;
     }
-    if (decodedNonce != NULL)
+
+    if (derPtr != der + derLen)
     {
-        GFN_CC_FREE(decodedNonce);
+        GFN_CC_LOG("Unexpected trailing data after certificate\n");
+        X509_free(cert);
+        return false;
     }
-    return result;
+
+    *outputCert = cert;
+    return true;
 }
 
 /*
@@ -624,7 +522,7 @@ end:
  *
  * @return true if X.509 object is constructed successfully, false otherwise.
  */
-static bool CreateX509Cert(char *certStr, const size_t certStrLen, X509 **outputCert)
+static bool CreateX509CertFromPem(const char *certStr, const size_t certStrLen, X509 **outputCert)
 {
     bool result = false;
     BIO *certBio = NULL;
@@ -662,19 +560,19 @@ end:
 /*
  * @brief Adds a certificate to a certificate chain
  *
- * Creates a X509 certificate from a certificate string and adds it to the certificate chain
+ * Creates a X509 certificate from a DER encoded certificate and adds it to the certificate chain
  *
- * @param cert The PEM certificate string to be added to the certificate chain
+ * @param cert The DER encoded certificate to be added to the certificate chain
  * @param certChain The chain to which the certificate is added.
  *
  * @return true if the certificate is added successfully, false otherwise.
  */
-static bool AddCertificateToChain(char *cert, STACK_OF(X509) *certChain)
+static bool AddCertificateToChain(const GfnCloudCheckDerCert *cert, STACK_OF(X509) *certChain)
 {
     bool result = false;
     X509 *certX509 = NULL;
 
-    if (!CreateX509Cert(cert, strlen(cert), &certX509))
+    if (!CreateX509Cert(cert->der, cert->derLen, &certX509))
     {
         GFN_CC_LOG("Failed to create X509 certificate\n");
         goto end;
@@ -700,78 +598,120 @@ end:
 }
 
 /*
- * @brief Create a certificate chain containing the passed in certificates
+ * @brief Fill a certificate chain with the passed in certificates
  *
- * Creates a STACK_OF(X509) from the passed in certificate strings
+ * Parses the passed in DER certificates into an empty STACK_OF(X509). The pinned roots are not part
+ * of this chain; they are held in the trust store of the verifier. On failure the certificates
+ * already added are left in the chain for the caller to release.
  *
- * @param x5cCerts The certificate strings received from the cloud check response JWT
- * @param numX5cCerts The number of certificate strings received from the cloud check response JWT
- * @param rootCert The root certificate to be appended to this certificate chain
- * @param certChain The output STACK_OF(X509) certificate chain
+ * @param x5cCerts The DER certificates received from the cloud check response JWT
+ * @param numX5cCerts The number of certificates received from the cloud check response JWT
+ * @param certChain The empty STACK_OF(X509) certificate chain to fill
  *
  * @return true if the certificate chain is created successfully, false otherwise.
  */
-static bool CreateX509CertificateChain(char *x5cCerts[], size_t numX5cCerts, char *rootCert, STACK_OF(X509) **certChain)
+static bool CreateX509CertificateChain(const GfnCloudCheckDerCert x5cCerts[], size_t numX5cCerts, STACK_OF(X509) *certChain)
 {
-    bool result = false;
+    for (size_t i = 0; i < numX5cCerts; ++i)
+    {
+        if (!AddCertificateToChain(&x5cCerts[i], certChain))
+        {
+            GFN_CC_LOG("Failed to add (%zu) received certificate\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
 
-    STACK_OF(X509) *chain = NULL;
+/*
+ * @brief Parses the pinned root certificates and builds the trust store of a verifier.
+ *
+ * The store carries the verification parameters (strict mode, depth and purpose) so that the
+ * store context initialized from it inherits them on every verification.
+ *
+ * @param verifier The verifier whose rootCerts and trustStore are set. Released by the caller on failure.
+ *
+ * @return true if the trust store is ready, false otherwise.
+ */
+static bool InitializeTrustStore(GfnCloudCheckVerifier* verifier)
+{
+    const char* rootPemCerts[NUMBER_OF_PINNED_ROOT_CERTS] = { s_RootPublicCert1, s_RootPublicCert2 };
 
-    chain = sk_X509_new_null();
-    if (chain == NULL)
+#ifdef GFN_CLOUD_CHECK_ENABLE_TEST_HOOKS
+    for (size_t i = 0; i < NUMBER_OF_PINNED_ROOT_CERTS; ++i)
     {
-        GFN_CC_LOG("Failed to create certificate stack for chain\n");
-        goto end;
+        if (s_TestRootPemCerts[i] != NULL)
+        {
+            rootPemCerts[i] = s_TestRootPemCerts[i];
+        }
     }
+#endif
 
-    for (size_t i = 0; i < numX5cCerts; ++i)
+    verifier->trustStore = X509_STORE_new();
+    if (verifier->trustStore == NULL)
+    {
+        GFN_CC_LOG("Failed to create a certificate store\n");
+        return false;
+    }
+
+    for (size_t i = 0; i < NUMBER_OF_PINNED_ROOT_CERTS; ++i)
     {
-        if (!AddCertificateToChain(x5cCerts[i], chain))
+        if (!CreateX509CertFromPem(rootPemCerts[i], strlen(rootPemCerts[i]), &verifier->rootCerts[i]))
         {
-            GFN_CC_LOG("Failed to add (%zu) received certificate\n", i);
-            goto end;
+            GFN_CC_LOG("Failed to parse pinned root certificate %zu\n", i + 1);
+            return false;
+        }
+        if (X509_STORE_add_cert(verifier->trustStore, verifier->rootCerts[i]) == 0)
+        {
+            GFN_CC_LOG("Failed to add root certificate %zu to certificate store\n", i + 1);
+            return false;
         }
     }
 
-    if (!AddCertificateToChain(rootCert, chain))
+    if (X509_STORE_set_flags(verifier->trustStore, X509_V_FLAG_X509_STRICT) == 0)
     {
-        GFN_CC_LOG("Failed to add root certificate\n");
-        goto end;
+        GFN_CC_LOG("Failed to set strict verification flag for certificate chain\n");
+        return false;
     }
 
+    X509_STORE_set_depth(verifier->trustStore, MAX_CERTIFICATE_CHAIN_LEN-2); // only count intermediate certs
 
-    *certChain = chain;
-    result = true;
-
-end:
-    if (result)
+    // Enable additional checks based on keyUsage, extendedKeyUsage, and basicConstraints
+    if (X509_STORE_set_purpose(verifier->trustStore, X509_PURPOSE_SSL_SERVER) == 0)
     {
-        return result;
+        GFN_CC_LOG("Failed to set purpose for certificate chain\n");
+        return false;
     }
 
-    sk_X509_pop_free(chain, X509_free);
-
-    return result;
+    return true;
 }
 
 /*
- * @brief Verifies the received certificates against the pinned root certificate.
+ * @brief Verifies the received certificates against the pinned root certificates.
  *
- * @param certChain X.509 stack of certificates to verify. Expected to contain target (leaf) + intermediate + root
+ * Both pinned roots are in the trust store, so the chain is built and validated in a single pass
+ * regardless of which root issued it.
+ *
+ * @param verifier The verifier holding the trust store and the reusable store context.
+ * @param certChain X.509 stack of certificates to verify. Expected to contain target (leaf) + intermediates
+ * @param chainExpiresAt Storage for the earliest notAfter time of the verified chain, including the root
  *
  * @return true if the certificate chain is validated successfully, false otherwise.
  */
-static bool VerifyX509CertificateChain(STACK_OF(X509) *certChain)
+static bool VerifyX509CertificateChain(GfnCloudCheckVerifier* verifier, STACK_OF(X509) *certChain, time_t* chainExpiresAt)
 {
     bool result = false;
-    size_t numCerts = 0;
+    int numCerts = 0;
     X509 *leafCertX509 = NULL;
-    X509 *rootCertX509 = NULL;
+    STACK_OF(X509) *verifiedChain = NULL;
+    time_t now = 0;
+    time_t expiresAt = 0;
+    int days = 0;
+    int seconds = 0;
 
-    STACK_OF(X509) *untrustedCertsX509 = NULL;
-    X509_STORE *certStore = NULL;
-    X509_STORE_CTX *certStoreCtx = NULL;
-    X509_VERIFY_PARAM *certChainVerifyParams = NULL;
+    STACK_OF(X509) *untrustedCertsX509 = verifier->untrustedCerts;
+    X509_STORE_CTX *certStoreCtx = verifier->storeCtx;
 
     numCerts = sk_X509_num(certChain);
     if (numCerts <= 0)
@@ -780,7 +720,7 @@ static bool VerifyX509CertificateChain(STACK_OF(X509) *certChain)
         goto end;
     }
 
-    if (numCerts > MAX_CERTIFICATE_CHAIN_LEN)
+    if (numCerts > MAX_CERTIFICATE_CHAIN_LEN-1) // the root comes from the trust store
     {
         GFN_CC_LOG("Certificate chain too long\n");
         goto end;
@@ -794,84 +734,24 @@ static bool VerifyX509CertificateChain(STACK_OF(X509) *certChain)
         goto end;
     }
 
-    // get root certificate
-    rootCertX509 = sk_X509_value(certChain, numCerts-1);
-    if (rootCertX509 == NULL)
+    // Untrusted chain (list of certificates that can be used to build the certificate chain),
+    // i.e. the received certificates without the target certificate. The stack does not own them.
+    for (int i = 1; i < numCerts; ++i)
     {
-        GFN_CC_LOG("Failed to get the root certificate\n");
-        goto end;
+        if (sk_X509_push(untrustedCertsX509, sk_X509_value(certChain, i)) == 0)
+        {
+            GFN_CC_LOG("Failed to build the untrusted certificate stack\n");
+            goto end;
+        }
     }
 
-    // Create untrusted chain (list of certificates that can be used to build the certificate chain)
-    untrustedCertsX509 = sk_X509_dup(certChain);
-    if (untrustedCertsX509 == NULL)
+    // The verification parameters are inherited from the trust store
+    if (X509_STORE_CTX_init(certStoreCtx, verifier->trustStore, leafCertX509, untrustedCertsX509) == 0)
     {
-        GFN_CC_LOG("Failed to create a copy of the certificate chain\n");
+        GFN_CC_LOG("Failed to initialize context for X509 store\n");
         goto end;
     }
 
-    // remove the target and the root certificate
-    if (sk_X509_shift(untrustedCertsX509) == NULL)
-    {
-        GFN_CC_LOG("Failed to remove leaf certificate from certificate chain copy\n");
-        goto end;
-    }
-    if (sk_X509_pop(untrustedCertsX509) == NULL)
-    {
-        GFN_CC_LOG("Failed to remove root certificate from certificate chain copy\n");
-        goto end;
-    }
-
-    // create store
-    certStore = X509_STORE_new();
-    if (certStore == NULL)
-    {
-        GFN_CC_LOG("Failed to create a certificate store\n");
-        goto end;
-    }
-
-    if (X509_STORE_add_cert(certStore, rootCertX509) == 0)
-    {
-        GFN_CC_LOG("Failed to add root certificate to certificate store\n");
-        goto end;
-    }
-
-
-    // Create context for the chain verification
-    certStoreCtx = X509_STORE_CTX_new();
-    if (certStoreCtx == NULL)
-    {
-        GFN_CC_LOG("Failed to create context for X509 store\n");
-        goto end;
-    }
-
-
-    if (X509_STORE_CTX_init(certStoreCtx, certStore, leafCertX509, untrustedCertsX509) == 0)
-    {
-        GFN_CC_LOG("Failed to initialize context for X509 store\n");
-        goto end;
-    }
-
-    // Create parameters for the chain verification
-    certChainVerifyParams = X509_VERIFY_PARAM_new();
-    if (X509_VERIFY_PARAM_set_flags(certChainVerifyParams, X509_V_FLAG_X509_STRICT) == 0)
-    {
-        GFN_CC_LOG("Failed to set strict verification flag for certificate chain\n");
-        goto end;
-    }
-
-    X509_VERIFY_PARAM_set_depth(certChainVerifyParams, MAX_CERTIFICATE_CHAIN_LEN-2); // only count intermediate certs
-
-    // Enable additional checks based on keyUsage, extendedKeyUsage, and basicConstraints
-    if (X509_VERIFY_PARAM_set_purpose(certChainVerifyParams, X509_PURPOSE_SSL_SERVER) == 0)
-    {
-        GFN_CC_LOG("Failed to set purpose for certificate chain\n");
-        goto end;
-    }
-
-    X509_STORE_CTX_set0_param(certStoreCtx, certChainVerifyParams);
-    certChainVerifyParams = NULL;
-
     if (X509_STORE_CTX_verify(certStoreCtx) <= 0)
     {
         int error = X509_STORE_CTX_get_error(certStoreCtx);
@@ -880,13 +760,32 @@ static bool VerifyX509CertificateChain(STACK_OF(X509) *certChain)
         goto end;
     }
 
+    // The chain stays valid until the first of its certificates expires
+    verifiedChain = X509_STORE_CTX_get0_chain(certStoreCtx);
+    now = time(NULL);
+    expiresAt = now;
+    for (int i = 0; i < sk_X509_num(verifiedChain); ++i)
+    {
+        time_t certExpiresAt = 0;
+        if (ASN1_TIME_diff(&days, &seconds, NULL, X509_get0_notAfter(sk_X509_value(verifiedChain, i))) == 0)
+        {
+            GFN_CC_LOG("Failed to read the notAfter time of certificate %d\n", i);
+            goto end;
+        }
+        certExpiresAt = now + (time_t)days * 24 * 60 * 60 + seconds;
+        if (i == 0 || certExpiresAt < expiresAt)
+        {
+            expiresAt = certExpiresAt;
+        }
+    }
+    *chainExpiresAt = expiresAt;
+
     result = true;
 
 end:
-    sk_X509_free(untrustedCertsX509);
-    X509_STORE_free(certStore);
-    X509_STORE_CTX_free(certStoreCtx);
-    X509_VERIFY_PARAM_free(certChainVerifyParams);
+    // Keep the store context and stack allocations for the next verification
+    X509_STORE_CTX_cleanup(certStoreCtx);
+    sk_X509_zero(untrustedCertsX509);
 
     return result;
 }
@@ -898,39 +797,17 @@ end:
  * @param dataLen The length of the signed data.
  * @param signature The signature to be verified.
  * @param signatureLen The length of the signature.
- * @param certChain The certificate stack containing the leaf certificate.
+ * @param leafPubKey The public key of the validated leaf certificate.
+ * @param digestVerificationCtx The reusable digest context of the verifier.
  *
  * @return true if the signature is successfully verified, false otherwise.
  */
-static bool VerifySignature(const unsigned char *data, size_t dataLen, const unsigned char *signature, size_t signatureLen, STACK_OF(X509) *certChain)
+static bool VerifySignature(const unsigned char *data, size_t dataLen, const unsigned char *signature, size_t signatureLen, EVP_PKEY *leafPubKey, EVP_MD_CTX *digestVerificationCtx)
 {
     bool result = false;
 
-    EVP_MD_CTX *digestVerificationCtx = NULL;
-    EVP_PKEY *leafPubKey = NULL;
     int verifyStatus = 0;
 
-    X509 *leafCertifcateX509 = sk_X509_value(certChain, 0);
-    if (leafCertifcateX509 == NULL)
-    {
-        GFN_CC_LOG("Failed to get the leaf certificate\n");
-        goto end;
-    }
-
-    leafPubKey = X509_get0_pubkey(leafCertifcateX509);
-    if (leafPubKey == NULL)
-    {
-        GFN_CC_LOG("Failed to get the leaf public key\n");
-        goto end;
-    }
-
-    digestVerificationCtx = EVP_MD_CTX_new();
-    if (digestVerificationCtx == NULL)
-    {
-        GFN_CC_LOG("Failed to create message digest context\n");
-        goto end;
-    }
-
     if (EVP_DigestVerifyInit(digestVerificationCtx, NULL, EVP_sha512(), NULL, leafPubKey) == 0)
     {
         GFN_CC_LOG("Failed to initialize message digest verification context\n");
@@ -947,238 +824,1347 @@ static bool VerifySignature(const unsigned char *data, size_t dataLen, const uns
     result = true;
 
 end:
-    EVP_MD_CTX_free(digestVerificationCtx);
+    // Releases the key context of this verification but keeps the digest context itself
+    EVP_MD_CTX_reset(digestVerificationCtx);
 
     return result;
 }
 
 /**
- * @brief Validates attestation data received in CloudCheck API response represented as a JWT.
+ * @brief Computes the chain cache key for the received x5c certificates.
  *
- * This function performs following series of steps to validate the integrity of attestation data.
-
- * JWT Format: base64url(header).base64url(data).base64url(RSASHA512(base64url(header).base64url(data)))
- * 1.Parse JWT to extract header, data, signature
- * 2.Parse header
- *   a.Extract Certificate chain from x5c field
- *   b.Match alg field to RS512 string
- * 3.Parse data and match nonce field with input value of nonce
- * 4.Append root certificate to the Certificate chain in #2a, and validate the Certificate chain
- * 5.Generate Hash of (base64url(header).base64url(data))
- * 6.Decrypt signature using public key of the first certificate in the list
- * 7.If decrypted signature in #6 matches with hash value in #5, indicates JWT is valid
+ * The key is the SHA-256 of the concatenated DER encoding of the certificates, in the order
+ * they appear in the x5c field.
  *
- * @param attestationData The attestation data in JWT format.
- * @param nonce The nonce value to match with the value in the payload.
- * @param nonceSize The size of nonce in bytes.
+ * @param x5cCerts The DER certificates from the x5c field.
+ * @param numX5cCerts The number of certificates.
+ * @param fingerprint Storage for the SHA-256 digest.
+ * @param digestCtx The reusable digest context of the verifier.
  *
- * @return true if the JWT response is valid, false otherwise.
+ * @return true if the fingerprint is computed successfully, false otherwise.
  */
-bool GfnCloudCheckVerifyAttestationData(const char* jwt, const char* nonce, unsigned int nonceSize)
+static bool ComputeChainFingerprint(const GfnCloudCheckDerCert x5cCerts[], size_t numX5cCerts, unsigned char fingerprint[SHA256_DIGEST_LENGTH], EVP_MD_CTX *digestCtx)
 {
     bool result = false;
 
-    size_t jwtLen = 0;
-
-    size_t headerLen = 0;
-    char* header = NULL;
-
-    size_t payloadLen = 0;
-    char* payload = NULL;
+    if (EVP_DigestInit_ex(digestCtx, EVP_sha256(), NULL) == 0)
+    {
+        GFN_CC_LOG("Failed to initialize chain fingerprint digest\n");
+        goto end;
+    }
 
-    size_t signatureLen = 0;
-    char* signature = NULL;
+    for (size_t i = 0; i < numX5cCerts; ++i)
+    {
+        if (EVP_DigestUpdate(digestCtx, x5cCerts[i].der, x5cCerts[i].derLen) == 0)
+        {
+            GFN_CC_LOG("Failed to update chain fingerprint digest\n");
+            goto end;
+        }
+    }
 
-    size_t decodedHeaderLen = 0;
-    unsigned char* decodedHeader = NULL;
+    if (EVP_DigestFinal_ex(digestCtx, fingerprint, NULL) == 0)
+    {
+        GFN_CC_LOG("Failed to finalize chain fingerprint digest\n");
+        goto end;
+    }
 
-    size_t decodedPayloadLen = 0;
-    unsigned char* decodedPayload = NULL;
+    result = true;
 
-    size_t decodedSignatureLen = 0;
-    unsigned char* decodedSignature = NULL;
+end:
+    return result;
+}
 
-    size_t dataLen = 0;
-    unsigned char* data = NULL;
+/**
+ * @brief Looks up an unexpired validated chain in the chain cache.
+ *
+ * Updates the hit and miss counters. Expired entries found during the lookup are released.
+ *
+ * @param cache The chain cache to search.
+ * @param fingerprint The chain cache key.
+ *
+ * @return A new reference to the cached leaf public key, which the caller must free with
+ *         EVP_PKEY_free, or NULL on a cache miss.
+ */
+static EVP_PKEY* LookupChainCache(GfnCloudCheckChainCache* cache, const unsigned char fingerprint[SHA256_DIGEST_LENGTH])
+{
+    EVP_PKEY* leafPubKey = NULL;
+    time_t now = time(NULL);
 
-    char* x5cCerts[MAX_NUMBER_OF_X5C_CERTS] = { 0 };
-    unsigned int numX5cCerts = 0;
-    char* hashedData = NULL;
+    pthread_mutex_lock(&cache->lock);
+    for (size_t i = 0; i < CHAIN_CACHE_MAX_ENTRIES; ++i)
+    {
+        GfnCloudCheckChainCacheEntry* entry = &cache->entries[i];
+        if (!entry->valid || memcmp(entry->fingerprint, fingerprint, SHA256_DIGEST_LENGTH) != 0)
+        {
+            continue;
+        }
+        if (now >= entry->expiresAt)
+        {
+            EVP_PKEY_free(entry->leafPubKey);
+            memset(entry, 0, sizeof(*entry));
+            break;
+        }
+        if (EVP_PKEY_up_ref(entry->leafPubKey) == 1)
+        {
+            entry->lastUsed = ++cache->useCounter;
+            leafPubKey = entry->leafPubKey;
+        }
+        break;
+    }
+    if (leafPubKey != NULL)
+    {
+        cache->hits++;
+    }
+    else
+    {
+        cache->misses++;
+    }
+    pthread_mutex_unlock(&cache->lock);
 
-    char *firstDot = NULL;
-    char *secondDot = NULL;
+    return leafPubKey;
+}
 
-    STACK_OF(X509) *certChain = NULL;
+/**
+ * @brief Stores a validated chain in the chain cache, evicting the least recently used entry if needed.
+ *
+ * Nothing is stored when the cache is disabled (TTL of 0).
+ *
+ * @param cache The chain cache to update.
+ * @param fingerprint The chain cache key.
+ * @param leafPubKey The public key of the validated leaf certificate. The cache takes its own reference.
+ * @param chainExpiresAt The earliest notAfter time of the validated chain.
+ */
+static void InsertChainCache(GfnCloudCheckChainCache* cache, const unsigned char fingerprint[SHA256_DIGEST_LENGTH], EVP_PKEY* leafPubKey, time_t chainExpiresAt)
+{
+    GfnCloudCheckChainCacheEntry* target = NULL;
+    time_t now = time(NULL);
+    time_t expiresAt = 0;
 
-    firstDot = strchr(jwt, '.');
-    if (firstDot == NULL)
+    pthread_mutex_lock(&cache->lock);
+    if (cache->ttlSeconds == 0)
     {
-        GFN_CC_LOG("Invalid jwt format\n");
-        return false;
+        pthread_mutex_unlock(&cache->lock);
+        return;
     }
 
-    secondDot = strchr(firstDot + 1, '.');
-    if (secondDot == NULL)
+    expiresAt = now + (time_t)cache->ttlSeconds;
+    if (chainExpiresAt < expiresAt)
     {
-        GFN_CC_LOG("Invalid jwt format\n");
-        return false;
+        expiresAt = chainExpiresAt;
     }
 
-    headerLen = firstDot - jwt;
-    header = GFN_CC_MALLOC(headerLen + 1);
-    if (header == NULL)
+    for (size_t i = 0; i < CHAIN_CACHE_MAX_ENTRIES; ++i)
     {
-        GFN_CC_LOG("Failed to allocate memory for header\n");
-        return false;
+        GfnCloudCheckChainCacheEntry* entry = &cache->entries[i];
+        if (entry->valid && memcmp(entry->fingerprint, fingerprint, SHA256_DIGEST_LENGTH) == 0)
+        {
+            target = entry;
+            break;
+        }
+        if (target == NULL || (target->valid && (!entry->valid || entry->lastUsed < target->lastUsed)))
+        {
+            target = entry;
+        }
     }
-    memcpy(header, jwt, headerLen);
-    header[headerLen] = '\0';
 
-    payloadLen = secondDot - (firstDot + 1);
-    payload = GFN_CC_MALLOC(payloadLen + 1);
-    if (payload == NULL)
+    if (EVP_PKEY_up_ref(leafPubKey) == 1)
     {
-        GFN_CC_LOG("Failed to allocate memory for payload\n");
-        GFN_CC_FREE(header);
-        return false;
+        if (target->valid)
+        {
+            EVP_PKEY_free(target->leafPubKey);
+        }
+        target->valid = true;
+        memcpy(target->fingerprint, fingerprint, SHA256_DIGEST_LENGTH);
+        target->leafPubKey = leafPubKey;
+        target->expiresAt = expiresAt;
+        target->lastUsed = ++cache->useCounter;
     }
-    memcpy(payload, firstDot + 1, payloadLen);
-    payload[payloadLen] = '\0';
+    pthread_mutex_unlock(&cache->lock);
+}
 
-    jwtLen = strlen(jwt);
-    signatureLen = (jwt + jwtLen) - (secondDot + 1);
-    signature = GFN_CC_MALLOC(signatureLen + 1);
-    if (signature == NULL)
+/**
+ * @brief Validates the received x5c chain, using the chain cache when possible.
+ *
+ * @param verifier The verifier holding the trust store, contexts and chain cache.
+ * @param x5cCerts The DER certificates from the x5c field.
+ * @param numX5cCerts The number of certificates.
+ *
+ * @return A reference to the validated leaf public key, which the caller must free with
+ *         EVP_PKEY_free, or NULL if the chain could not be validated.
+ */
+static EVP_PKEY* GetValidatedLeafPublicKey(GfnCloudCheckVerifier* verifier, const GfnCloudCheckDerCert x5cCerts[], size_t numX5cCerts)
+{
+    EVP_PKEY* leafPubKey = NULL;
+    STACK_OF(X509) *certChain = verifier->certChain;
+    unsigned char fingerprint[SHA256_DIGEST_LENGTH];
+    bool haveFingerprint = false;
+    time_t chainExpiresAt = 0;
+
+    haveFingerprint = ComputeChainFingerprint(x5cCerts, numX5cCerts, fingerprint, verifier->fingerprintCtx);
+    if (haveFingerprint)
     {
-        GFN_CC_LOG("Failed to allocate memory for signature\n");
-        GFN_CC_FREE(header);
-        GFN_CC_FREE(payload);
-        return false;
+        leafPubKey = LookupChainCache(verifier->chainCache, fingerprint);
+        if (leafPubKey != NULL)
+        {
+            return leafPubKey;
+        }
     }
-    memcpy(signature, secondDot+1, signatureLen);
-    signature[signatureLen] = '\0';
-
 
-    decodedHeaderLen = Base64UrlDecode(header, &decodedHeader);
-    if (decodedHeaderLen == 0)
+    if (!CreateX509CertificateChain(x5cCerts, numX5cCerts, certChain))
     {
-        GFN_CC_LOG("Failed to Base64Url decode header\n");
+        GFN_CC_LOG("Failed to create certificate stack\n");
         goto end;
     }
 
-    decodedPayloadLen = Base64UrlDecode(payload, &decodedPayload);
-    if (decodedPayloadLen == 0)
+    if (!VerifyX509CertificateChain(verifier, certChain, &chainExpiresAt))
     {
-        GFN_CC_LOG("Failed to Base64Url decode payload\n");
+        GFN_CC_LOG("Failed to validate certificate chain against pinned root certificates\n");
         goto end;
     }
 
-    decodedSignatureLen = Base64UrlDecode(signature, &decodedSignature);
-    if (decodedSignatureLen == 0)
+    leafPubKey = X509_get_pubkey(sk_X509_value(certChain, 0));
+    if (leafPubKey == NULL)
     {
-        GFN_CC_LOG("Failed to Base64Url decode signature\n");
+        GFN_CC_LOG("Failed to get the leaf public key\n");
         goto end;
     }
 
-
-    if (!ParseHeaderJson(decodedHeader, decodedHeaderLen, x5cCerts, &numX5cCerts))
+    if (haveFingerprint)
     {
-        GFN_CC_LOG("Failed to parse header json\n");
-        goto end;
+        InsertChainCache(verifier->chainCache, fingerprint, leafPubKey, chainExpiresAt);
     }
 
-    if (!ParsePayloadJson(decodedPayload, decodedPayloadLen, nonce, nonceSize))
+end:
+    // Release the certificates but keep the stack for the next verification
+    while (sk_X509_num(certChain) > 0)
     {
-        GFN_CC_LOG("Failed to parse payload json\n");
-        goto end;
+        X509_free(sk_X509_pop(certChain));
     }
 
+    return leafPubKey;
+}
 
-    if (!CreateX509CertificateChain(x5cCerts, numX5cCerts, s_RootPublicCert1, &certChain))
+/**
+ * @brief Releases all entries of a chain cache.
+ *
+ * @param cache The chain cache to clear.
+ */
+static void ClearChainCache(GfnCloudCheckChainCache* cache)
+{
+    pthread_mutex_lock(&cache->lock);
+    for (size_t i = 0; i < CHAIN_CACHE_MAX_ENTRIES; ++i)
     {
-        GFN_CC_LOG("Failed to create certificate stack with Public Cert 1\n");
-        goto end;
+        if (cache->entries[i].valid)
+        {
+            EVP_PKEY_free(cache->entries[i].leafPubKey);
+        }
+        memset(&cache->entries[i], 0, sizeof(cache->entries[i]));
     }
+    pthread_mutex_unlock(&cache->lock);
+}
 
-    if (!VerifyX509CertificateChain(certChain))
+void GfnCloudCheckSetChainCacheTtl(unsigned int ttlSeconds)
+{
+    pthread_mutex_lock(&s_ChainCache.lock);
+    s_ChainCache.ttlSeconds = ttlSeconds;
+    pthread_mutex_unlock(&s_ChainCache.lock);
+    if (ttlSeconds == 0)
     {
-        GFN_CC_LOG("Failed to validate certificate chain with Public Cert 1, trying with Public Cert 2\n");
-        if (!CreateX509CertificateChain(x5cCerts, numX5cCerts, s_RootPublicCert2, &certChain))
-        {
-            GFN_CC_LOG("Failed to create certificate stack with Public Cert 2\n");
-            goto end;
-        }
-        if (!VerifyX509CertificateChain(certChain))
-        {
-            GFN_CC_LOG("Failed to validate certificate chain with Public Cert 2\n");
-            goto end;
-        }        
+        GfnCloudCheckClearChainCache();
     }
+}
+
+void GfnCloudCheckClearChainCache(void)
+{
+    ClearChainCache(&s_ChainCache);
+}
 
-    // verify signature of (header + "." + payload)
-    dataLen = secondDot - jwt;
-    data = GFN_CC_MALLOC(dataLen);
-    if (data == NULL)
+void GfnCloudCheckGetChainCacheStats(GfnCloudCheckChainCacheStats* stats)
+{
+    if (stats == NULL)
     {
-        GFN_CC_LOG("Failed to allocate memory for data object\n");
-        goto end;
+        return;
+    }
+    pthread_mutex_lock(&s_ChainCache.lock);
+    stats->hits = s_ChainCache.hits;
+    stats->misses = s_ChainCache.misses;
+    pthread_mutex_unlock(&s_ChainCache.lock);
+}
+
+#ifdef GFN_CLOUD_CHECK_ENABLE_TEST_HOOKS
+bool GfnCloudCheckSetTestRootCertificates(const char* pemRootCert1, const char* pemRootCert2)
+{
+    if (atomic_load(&s_VerifierCreated))
+    {
+        GFN_CC_LOG("Test root certificates must be set before the first verifier is created\n");
+        return false;
     }
-    memcpy(data, jwt, dataLen);
+    s_TestRootPemCerts[0] = pemRootCert1;
+    s_TestRootPemCerts[1] = pemRootCert2;
+    return true;
+}
 
-    if (!VerifySignature(data, dataLen, decodedSignature, decodedSignatureLen, certChain))
+void GfnCloudCheckGetTestAllocationStats(GfnCloudCheckAllocationStats* stats)
+{
+    if (stats == NULL)
     {
-        GFN_CC_LOG("Failed to verify signature\n");
-        goto end;
+        return;
     }
+    stats->allocations = atomic_load(&s_TestAllocations);
+    stats->frees = atomic_load(&s_TestFrees);
+    stats->bytes = atomic_load(&s_TestAllocatedBytes);
+}
+#endif
 
-    result = true;
+static void FreeVerifier(GfnCloudCheckVerifier* verifier)
+{
+    ClearChainCache(&verifier->ownChainCache);
+    pthread_mutex_destroy(&verifier->ownChainCache.lock);
+    sk_X509_free(verifier->untrustedCerts);
+    sk_X509_pop_free(verifier->certChain, X509_free);
+    EVP_MD_CTX_free(verifier->fingerprintCtx);
+    EVP_MD_CTX_free(verifier->signatureCtx);
+    X509_STORE_CTX_free(verifier->storeCtx);
+    X509_STORE_free(verifier->trustStore);
+    for (size_t i = 0; i < NUMBER_OF_PINNED_ROOT_CERTS; ++i)
+    {
+        X509_free(verifier->rootCerts[i]);
+    }
+    GFN_CC_FREE(verifier->scratch);
+    GFN_CC_FREE(verifier);
+}
 
-end:
-    // Free x5c certificates
-    if (numX5cCerts > 0)
+GfnCloudCheckVerifier* GfnCloudCheckVerifierCreate(void)
+{
+    GfnCloudCheckVerifier* verifier = NULL;
+
+#ifdef GFN_CLOUD_CHECK_ENABLE_TEST_HOOKS
+    atomic_store(&s_VerifierCreated, true);
+#endif
+
+    verifier = GFN_CC_MALLOC(sizeof(GfnCloudCheckVerifier));
+    if (verifier == NULL)
     {
-        for (size_t i = 0; i < numX5cCerts; i++)
-        {
-            if (x5cCerts[i] != NULL)
-            {
-                GFN_CC_FREE(x5cCerts[i]);
-            }
-        }
+        GFN_CC_LOG("Failed to allocate verifier\n");
+        return NULL;
+    }
+    memset(verifier, 0, sizeof(*verifier));
+
+    if (pthread_mutex_init(&verifier->ownChainCache.lock, NULL) != 0)
+    {
+        GFN_CC_LOG("Failed to initialize verifier chain cache\n");
+        GFN_CC_FREE(verifier);
+        return NULL;
     }
-    if (header != NULL)
+    pthread_mutex_lock(&s_ChainCache.lock);
+    verifier->ownChainCache.ttlSeconds = s_ChainCache.ttlSeconds;
+    pthread_mutex_unlock(&s_ChainCache.lock);
+    verifier->chainCache = &verifier->ownChainCache;
+
+    if (!InitializeTrustStore(verifier))
     {
-        GFN_CC_FREE(header);
+        GFN_CC_LOG("Failed to load pinned root certificates\n");
+        goto fail;
     }
-    if (payload != NULL)
+
+    verifier->storeCtx = X509_STORE_CTX_new();
+    verifier->signatureCtx = EVP_MD_CTX_new();
+    verifier->fingerprintCtx = EVP_MD_CTX_new();
+    verifier->certChain = sk_X509_new_reserve(NULL, MAX_CERTIFICATE_CHAIN_LEN);
+    verifier->untrustedCerts = sk_X509_new_reserve(NULL, MAX_CERTIFICATE_CHAIN_LEN);
+    if (verifier->storeCtx == NULL || verifier->signatureCtx == NULL || verifier->fingerprintCtx == NULL ||
+        verifier->certChain == NULL || verifier->untrustedCerts == NULL)
     {
-        GFN_CC_FREE(payload);
+        GFN_CC_LOG("Failed to create verification contexts\n");
+        goto fail;
     }
-    if (signature != NULL)
+
+    return verifier;
+
+fail:
+    FreeVerifier(verifier);
+    return NULL;
+}
+
+void GfnCloudCheckVerifierDestroy(GfnCloudCheckVerifier* verifier)
+{
+    if (verifier != NULL)
     {
-        GFN_CC_FREE(signature);
+        FreeVerifier(verifier);
     }
-    if (decodedHeader != NULL)
+}
+
+void GfnCloudCheckVerifierGetChainCacheStats(const GfnCloudCheckVerifier* verifier, GfnCloudCheckChainCacheStats* stats)
+{
+    if (verifier == NULL || stats == NULL)
     {
-        GFN_CC_FREE(decodedHeader);
+        return;
     }
-    if (decodedPayload != NULL)
+    stats->hits = verifier->ownChainCache.hits;
+    stats->misses = verifier->ownChainCache.misses;
+}
+
+/*
+ * Per-thread verifiers backing GfnCloudCheckVerifyAttestationData and
+ * GfnCloudCheckVerifyAttestationDataWithScratch. They share the process-wide chain cache,
+ * and are destroyed when their thread exits.
+ */
+static pthread_key_t s_ThreadVerifierKey;
+static pthread_once_t s_ThreadVerifierKeyOnce = PTHREAD_ONCE_INIT;
+static bool s_ThreadVerifierKeyCreated = false;
+
+static void DestroyThreadVerifier(void* verifier)
+{
+    GfnCloudCheckVerifierDestroy(verifier);
+}
+
+static void CreateThreadVerifierKey(void)
+{
+    s_ThreadVerifierKeyCreated = (pthread_key_create(&s_ThreadVerifierKey, DestroyThreadVerifier) == 0);
+}
+
+/**
+ * @brief Returns the verifier of the calling thread, creating it on first use.
+ *
+ * @return The verifier, or NULL if it could not be created.
+ */
+static GfnCloudCheckVerifier* GetThreadVerifier(void)
+{
+    GfnCloudCheckVerifier* verifier = NULL;
+
+    if (pthread_once(&s_ThreadVerifierKeyOnce, CreateThreadVerifierKey) != 0 || !s_ThreadVerifierKeyCreated)
     {
-        GFN_CC_FREE(decodedPayload);
+        return NULL;
     }
-    if (decodedSignature != NULL)
+
+    verifier = pthread_getspecific(s_ThreadVerifierKey);
+    if (verifier != NULL)
     {
-        GFN_CC_FREE(decodedSignature);
+        return verifier;
     }
-    if (hashedData != NULL)
+
+    verifier = GfnCloudCheckVerifierCreate();
+    if (verifier == NULL)
     {
-        GFN_CC_FREE(hashedData);
+        return NULL;
     }
-    if (data != NULL)
+    verifier->chainCache = &s_ChainCache;
+    if (pthread_setspecific(s_ThreadVerifierKey, verifier) != 0)
     {
-        GFN_CC_FREE(data);
+        GfnCloudCheckVerifierDestroy(verifier);
+        return NULL;
     }
+    return verifier;
+}
 
-    sk_X509_pop_free(certChain, X509_free);
+size_t GfnCloudCheckGetVerificationScratchSize(size_t jwtLength)
+{
+    // Decoded segments take 3/4 of the JWT. The x5c certificates and the nonce decoded out of them
+    // take at most 3/4 of that again, or all of it while an escaped value is being unescaped.
+    // Add room for the vector stores of the last decode.
+    return 2 * jwtLength + 2 * GFN_CC_BASE64_VECTOR_SLACK;
+}
 
-    return result;
+/**
+ * @brief Validates attestation data received in CloudCheck API response represented as a JWT.
+ *
+ * This function performs following series of steps to validate the integrity of attestation data.
+
+ * JWT Format: base64url(header).base64url(data).base64url(RSASHA512(base64url(header).base64url(data)))
+ * 1.Parse JWT to extract header, data, signature
+ * 2.Parse header
+ *   a.Extract Certificate chain from x5c field
+ *   b.Match alg field to RS512 string
+ * 3.Parse data and match nonce field with input value of nonce
+ * 4.Validate the Certificate chain in #2a against the pinned root certificates, unless the same
+ *   chain was validated recently and is still in the chain cache
+ * 5.Generate Hash of (base64url(header).base64url(data))
+ * 6.Decrypt signature using public key of the first certificate in the list
+ * 7.If decrypted signature in #6 matches with hash value in #5, indicates JWT is valid
+ *
+ * The JWT is parsed in place, and all decoded data is stored in the given scratch buffer.
+ *
+ * @param verifier The verifier whose trust store, contexts and chain cache are used.
+ * @param attestationData The attestation data in JWT format.
+ * @param nonce The nonce value to match with the value in the payload.
+ * @param nonceSize The size of nonce in bytes.
+ * @param scratch Scratch buffer of at least GfnCloudCheckGetVerificationScratchSize(strlen(jwt)) bytes.
+ * @param scratchSize The size of the scratch buffer.
+ * @param chainLeafPubKey Leaf public key of a header that is byte-identical to the JWT header and
+ *        was already checked with ValidateHeaderChain, or NULL. When set, steps 2 and 4 are skipped.
+ *
+ * @return true if the JWT response is valid, false otherwise.
+ */
+static bool VerifyWithScratch(GfnCloudCheckVerifier* verifier, const char* jwt, const char* nonce, unsigned int nonceSize,
+    void* scratch, size_t scratchSize, EVP_PKEY* chainLeafPubKey)
+{
+    bool result = false;
+
+    size_t jwtLen = 0;
+    const char* jwtEnd = NULL;
+    const char* firstDot = NULL;
+    const char* secondDot = NULL;
+
+    GfnCloudCheckArena arena = { 0 };
+
+    unsigned char* decodedHeader = NULL;
+    size_t decodedHeaderLen = 0;
+    unsigned char* decodedPayload = NULL;
+    size_t decodedPayloadLen = 0;
+    unsigned char* decodedSignature = NULL;
+    size_t decodedSignatureLen = 0;
+
+    GfnCloudCheckDerCert x5cCerts[MAX_NUMBER_OF_X5C_CERTS] = { { 0 } };
+    unsigned int numX5cCerts = 0;
+
+    EVP_PKEY *leafPubKey = NULL;
+
+    if (jwt == NULL || nonce == NULL)
+    {
+        GFN_CC_LOG("Invalid parameters\n");
+        return false;
+    }
+
+    jwtLen = strlen(jwt);
+    jwtEnd = jwt + jwtLen;
+    if (scratch == NULL || scratchSize < GfnCloudCheckGetVerificationScratchSize(jwtLen))
+    {
+        GFN_CC_LOG("Verification scratch buffer too small\n");
+        return false;
+    }
+    arena.base = scratch;
+    arena.size = scratchSize;
+
+    firstDot = FindChar(jwt, jwtEnd, '.');
+    if (firstDot == NULL)
+    {
+        GFN_CC_LOG("Invalid jwt format\n");
+        return false;
+    }
+
+    secondDot = FindChar(firstDot + 1, jwtEnd, '.');
+    if (secondDot == NULL)
+    {
+        GFN_CC_LOG("Invalid jwt format\n");
+        return false;
+    }
+
+    if (!Base64DecodeToArena(firstDot + 1, secondDot - (firstDot + 1), GfnBase64AlphabetUrl, &arena, &decodedPayload, &decodedPayloadLen))
+    {
+        GFN_CC_LOG("Failed to Base64Url decode payload\n");
+        goto end;
+    }
+
+    if (!Base64DecodeToArena(secondDot + 1, jwtEnd - (secondDot + 1), GfnBase64AlphabetUrl, &arena, &decodedSignature, &decodedSignatureLen))
+    {
+        GFN_CC_LOG("Failed to Base64Url decode signature\n");
+        goto end;
+    }
+
+    if (chainLeafPubKey == NULL)
+    {
+        if (!Base64DecodeToArena(jwt, firstDot - jwt, GfnBase64AlphabetUrl, &arena, &decodedHeader, &decodedHeaderLen))
+        {
+            GFN_CC_LOG("Failed to Base64Url decode header\n");
+            goto end;
+        }
+
+        if (!ParseHeaderJson(decodedHeader, decodedHeaderLen, &arena, x5cCerts, &numX5cCerts))
+        {
+            GFN_CC_LOG("Failed to parse header json\n");
+            goto end;
+        }
+    }
+
+    if (!ParsePayloadJson(decodedPayload, decodedPayloadLen, &arena, nonce, nonceSize))
+    {
+        GFN_CC_LOG("Failed to parse payload json\n");
+        goto end;
+    }
+
+    if (chainLeafPubKey != NULL)
+    {
+        if (EVP_PKEY_up_ref(chainLeafPubKey) != 1)
+        {
+            GFN_CC_LOG("Failed to reference the leaf public key\n");
+            goto end;
+        }
+        leafPubKey = chainLeafPubKey;
+    }
+    else
+    {
+        leafPubKey = GetValidatedLeafPublicKey(verifier, x5cCerts, numX5cCerts);
+        if (leafPubKey == NULL)
+        {
+            GFN_CC_LOG("Failed to validate certificate chain\n");
+            goto end;
+        }
+    }
+
+    // verify signature of (header + "." + payload), directly from the JWT
+    if (!VerifySignature((const unsigned char*)jwt, secondDot - jwt, decodedSignature, decodedSignatureLen, leafPubKey, verifier->signatureCtx))
+    {
+        GFN_CC_LOG("Failed to verify signature\n");
+        goto end;
+    }
+
+    result = true;
+
+end:
+    EVP_PKEY_free(leafPubKey);
+
+    return result;
+}
+
+/**
+ * @brief Grows the scratch buffer of a verifier to at least the given size.
+ *
+ * The buffer only grows, to the largest JWT verified so far.
+ *
+ * @param verifier The verifier.
+ * @param scratchSize The required scratch size in bytes.
+ *
+ * @return true if the scratch buffer is large enough, false if it could not be allocated.
+ */
+static bool ReserveVerifierScratch(GfnCloudCheckVerifier* verifier, size_t scratchSize)
+{
+    if (verifier->scratchSize >= scratchSize)
+    {
+        return true;
+    }
+    GFN_CC_FREE(verifier->scratch);
+    verifier->scratchSize = 0;
+    verifier->scratch = GFN_CC_MALLOC(scratchSize);
+    if (verifier->scratch == NULL)
+    {
+        GFN_CC_LOG("Failed to allocate verification scratch buffer\n");
+        return false;
+    }
+    verifier->scratchSize = scratchSize;
+    return true;
+}
+
+bool GfnCloudCheckVerifierVerify(GfnCloudCheckVerifier* verifier, const char* jwt, const char* nonce, unsigned int nonceSize)
+{
+    if (verifier == NULL || jwt == NULL)
+    {
+        GFN_CC_LOG("Invalid parameters\n");
+        return false;
+    }
+
+    if (!ReserveVerifierScratch(verifier, GfnCloudCheckGetVerificationScratchSize(strlen(jwt))))
+    {
+        return false;
+    }
+    return VerifyWithScratch(verifier, jwt, nonce, nonceSize, verifier->scratch, verifier->scratchSize, NULL);
+}
+
+bool GfnCloudCheckVerifyAttestationDataWithScratch(const char* jwt, const char* nonce, unsigned int nonceSize, void* scratch, size_t scratchSize)
+{
+    GfnCloudCheckVerifier* verifier = GetThreadVerifier();
+
+    if (verifier == NULL)
+    {
+        GFN_CC_LOG("Failed to create verifier\n");
+        return false;
+    }
+    return VerifyWithScratch(verifier, jwt, nonce, nonceSize, scratch, scratchSize, NULL);
+}
+
+/**
+ * @brief Validates attestation data received in CloudCheck API response represented as a JWT.
+ *
+ * Thin wrapper over GfnCloudCheckVerifierVerify, using a verifier owned by the calling thread.
+ *
+ * @param attestationData The attestation data in JWT format.
+ * @param nonce The nonce value to match with the value in the payload.
+ * @param nonceSize The size of nonce in bytes.
+ *
+ * @return true if the JWT response is valid, false otherwise.
+ */
+bool GfnCloudCheckVerifyAttestationData(const char* jwt, const char* nonce, unsigned int nonceSize)
+{
+    GfnCloudCheckVerifier* verifier = GetThreadVerifier();
+
+    if (verifier == NULL)
+    {
+        GFN_CC_LOG("Failed to create verifier\n");
+        return false;
+    }
+    return GfnCloudCheckVerifierVerify(verifier, jwt, nonce, nonceSize);
+}
+
+#define BATCH_MAX_WORKERS  64
+#define BATCH_NO_GROUP  ((size_t)-1)
+
+/**
+ * @brief Validates the certificate chain carried in a JWT header segment.
+ *
+ * Checks the alg field and validates the x5c chain, as steps 2 and 4 of the JWT verification.
+ *
+ * @param verifier The verifier whose trust store, contexts, chain cache and scratch are used.
+ * @param header The base64url encoded header segment of the JWT.
+ * @param headerLen The length of the header segment.
+ *
+ * @return A reference to the validated leaf public key, which the caller must free with
+ *         EVP_PKEY_free, or NULL if the header or chain is invalid.
+ */
+static EVP_PKEY* ValidateHeaderChain(GfnCloudCheckVerifier* verifier, const char* header, size_t headerLen)
+{
+    GfnCloudCheckArena arena = { 0 };
+    unsigned char* decodedHeader = NULL;
+    size_t decodedHeaderLen = 0;
+    GfnCloudCheckDerCert x5cCerts[MAX_NUMBER_OF_X5C_CERTS] = { { 0 } };
+    unsigned int numX5cCerts = 0;
+
+    if (!ReserveVerifierScratch(verifier, GfnCloudCheckGetVerificationScratchSize(headerLen)))
+    {
+        return NULL;
+    }
+    arena.base = verifier->scratch;
+    arena.size = verifier->scratchSize;
+
+    if (!Base64DecodeToArena(header, headerLen, GfnBase64AlphabetUrl, &arena, &decodedHeader, &decodedHeaderLen))
+    {
+        GFN_CC_LOG("Failed to Base64Url decode header\n");
+        return NULL;
+    }
+
+    if (!ParseHeaderJson(decodedHeader, decodedHeaderLen, &arena, x5cCerts, &numX5cCerts))
+    {
+        GFN_CC_LOG("Failed to parse header json\n");
+        return NULL;
+    }
+
+    return GetValidatedLeafPublicKey(verifier, x5cCerts, numX5cCerts);
+}
+
+/*
+ * JWTs of a batch whose header segments are byte-identical carry the same x5c chain. Their chain
+ * is validated once, in a first phase over the distinct headers, and the second phase only checks
+ * the nonce and signature of every JWT against the shared leaf public key.
+ */
+typedef struct GfnCloudCheckBatchGroup
+{
+    const char* header;
+    size_t headerLen;
+    EVP_PKEY* leafPubKey;   // NULL if the header or its chain is invalid
+} GfnCloudCheckBatchGroup;
+
+typedef struct GfnCloudCheckBatchJob
+{
+    const char* const* jwts;
+    const char* const* nonces;
+    unsigned int nonceSize;
+    bool* results;
+    size_t* itemGroups;     // group of each JWT, or BATCH_NO_GROUP for a malformed JWT
+    GfnCloudCheckBatchGroup* groups;
+} GfnCloudCheckBatchJob;
+
+typedef enum GfnCloudCheckBatchPhase
+{
+    BatchPhaseChains,
+    BatchPhaseItems
+} GfnCloudCheckBatchPhase;
+
+/*
+ * Fixed pool of workers, each owning a GfnCloudCheckVerifier. A batch runs one phase at a time:
+ * the caller publishes the phase under the lock and bumps the generation, the workers claim
+ * indices until the phase is exhausted, and the last worker to finish wakes the caller.
+ */
+typedef struct GfnCloudCheckBatchPool
+{
+    pthread_mutex_t batchLock;  // serializes batches, initialization and shutdown
+    bool initialized;
+    unsigned int numWorkers;
+    pthread_t threads[BATCH_MAX_WORKERS];
+    GfnCloudCheckVerifier* verifiers[BATCH_MAX_WORKERS];
+
+    pthread_mutex_t lock;       // protects the phase state below
+    pthread_cond_t workAvailable;
+    pthread_cond_t workDone;
+    bool stopping;
+    uint64_t generation;
+    GfnCloudCheckBatchPhase phase;
+    GfnCloudCheckBatchJob* job;
+    size_t nextIndex;
+    size_t endIndex;
+    unsigned int busyWorkers;
+} GfnCloudCheckBatchPool;
+
+static GfnCloudCheckBatchPool s_BatchPool = { PTHREAD_MUTEX_INITIALIZER, false, 0, { 0 }, { NULL },
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, false, 0, BatchPhaseChains, NULL, 0, 0, 0 };
+
+static void RunBatchTask(GfnCloudCheckVerifier* verifier, GfnCloudCheckBatchJob* job, GfnCloudCheckBatchPhase phase, size_t index)
+{
+    if (phase == BatchPhaseChains)
+    {
+        job->groups[index].leafPubKey = ValidateHeaderChain(verifier, job->groups[index].header, job->groups[index].headerLen);
+        return;
+    }
+
+    if (job->itemGroups[index] == BATCH_NO_GROUP || job->groups[job->itemGroups[index]].leafPubKey == NULL)
+    {
+        job->results[index] = false;
+        return;
+    }
+    job->results[index] = ReserveVerifierScratch(verifier, GfnCloudCheckGetVerificationScratchSize(strlen(job->jwts[index]))) &&
+        VerifyWithScratch(verifier, job->jwts[index], job->nonces[index], job->nonceSize,
+            verifier->scratch, verifier->scratchSize, job->groups[job->itemGroups[index]].leafPubKey);
+}
+
+static void* BatchWorkerMain(void* arg)
+{
+    GfnCloudCheckVerifier* verifier = (GfnCloudCheckVerifier*)arg;
+    uint64_t seenGeneration = 0;
+
+    pthread_mutex_lock(&s_BatchPool.lock);
+    for (;;)
+    {
+        while (!s_BatchPool.stopping && s_BatchPool.generation == seenGeneration)
+        {
+            pthread_cond_wait(&s_BatchPool.workAvailable, &s_BatchPool.lock);
+        }
+        if (s_BatchPool.stopping)
+        {
+            break;
+        }
+        seenGeneration = s_BatchPool.generation;
+
+        while (s_BatchPool.nextIndex < s_BatchPool.endIndex)
+        {
+            GfnCloudCheckBatchJob* job = s_BatchPool.job;
+            GfnCloudCheckBatchPhase phase = s_BatchPool.phase;
+            size_t index = s_BatchPool.nextIndex++;
+
+            pthread_mutex_unlock(&s_BatchPool.lock);
+            RunBatchTask(verifier, job, phase, index);
+            pthread_mutex_lock(&s_BatchPool.lock);
+        }
+
+        if (--s_BatchPool.busyWorkers == 0)
+        {
+            pthread_cond_signal(&s_BatchPool.workDone);
+        }
+    }
+    pthread_mutex_unlock(&s_BatchPool.lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Runs one phase of a batch on the worker pool and waits for it to complete.
+ */
+static void RunBatchPhase(GfnCloudCheckBatchJob* job, GfnCloudCheckBatchPhase phase, size_t count)
+{
+    pthread_mutex_lock(&s_BatchPool.lock);
+    s_BatchPool.job = job;
+    s_BatchPool.phase = phase;
+    s_BatchPool.nextIndex = 0;
+    s_BatchPool.endIndex = count;
+    s_BatchPool.busyWorkers = s_BatchPool.numWorkers;
+    s_BatchPool.generation++;
+    pthread_cond_broadcast(&s_BatchPool.workAvailable);
+    while (s_BatchPool.busyWorkers > 0)
+    {
+        pthread_cond_wait(&s_BatchPool.workDone, &s_BatchPool.lock);
+    }
+    s_BatchPool.job = NULL;
+    pthread_mutex_unlock(&s_BatchPool.lock);
+}
+
+/**
+ * @brief Stops the workers and releases their verifiers. Called with batchLock held.
+ */
+static void StopBatchWorkers(void)
+{
+    pthread_mutex_lock(&s_BatchPool.lock);
+    s_BatchPool.stopping = true;
+    pthread_cond_broadcast(&s_BatchPool.workAvailable);
+    pthread_mutex_unlock(&s_BatchPool.lock);
+
+    for (unsigned int i = 0; i < s_BatchPool.numWorkers; ++i)
+    {
+        pthread_join(s_BatchPool.threads[i], NULL);
+        GfnCloudCheckVerifierDestroy(s_BatchPool.verifiers[i]);
+        s_BatchPool.verifiers[i] = NULL;
+    }
+    s_BatchPool.numWorkers = 0;
+    s_BatchPool.stopping = false;
+    s_BatchPool.initialized = false;
+}
+
+/**
+ * @brief Creates the verifiers and starts the workers. Called with batchLock held.
+ *
+ * @param workerCount The number of workers, or 0 for one per online CPU.
+ *
+ * @return true if all workers started, false otherwise (no workers are left running).
+ */
+static bool StartBatchWorkers(unsigned int workerCount)
+{
+    if (workerCount == 0)
+    {
+        long onlineCpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workerCount = onlineCpus > 0 ? (unsigned int)onlineCpus : 1;
+    }
+    if (workerCount > BATCH_MAX_WORKERS)
+    {
+        workerCount = BATCH_MAX_WORKERS;
+    }
+
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        s_BatchPool.verifiers[i] = GfnCloudCheckVerifierCreate();
+        if (s_BatchPool.verifiers[i] == NULL)
+        {
+            GFN_CC_LOG("Failed to create verifier for batch worker %u\n", i);
+            StopBatchWorkers();
+            return false;
+        }
+        if (pthread_create(&s_BatchPool.threads[i], NULL, BatchWorkerMain, s_BatchPool.verifiers[i]) != 0)
+        {
+            GFN_CC_LOG("Failed to start batch worker %u\n", i);
+            GfnCloudCheckVerifierDestroy(s_BatchPool.verifiers[i]);
+            s_BatchPool.verifiers[i] = NULL;
+            StopBatchWorkers();
+            return false;
+        }
+        s_BatchPool.numWorkers = i + 1;
+    }
+    s_BatchPool.initialized = true;
+    return true;
+}
+
+bool GfnCloudCheckInitializeBatchVerification(unsigned int workerCount)
+{
+    bool result = false;
+
+    pthread_mutex_lock(&s_BatchPool.batchLock);
+    if (s_BatchPool.initialized)
+    {
+        GFN_CC_LOG("Batch verification is already initialized\n");
+    }
+    else
+    {
+        result = StartBatchWorkers(workerCount);
+    }
+    pthread_mutex_unlock(&s_BatchPool.batchLock);
+
+    return result;
+}
+
+void GfnCloudCheckShutdownBatchVerification(void)
+{
+    pthread_mutex_lock(&s_BatchPool.batchLock);
+    if (s_BatchPool.initialized)
+    {
+        StopBatchWorkers();
+    }
+    pthread_mutex_unlock(&s_BatchPool.batchLock);
+}
+
+/**
+ * @brief Assigns every JWT of a batch to the group of its header segment.
+ *
+ * Uses an open-addressing table keyed by the FNV-1a hash of the header segment.
+ *
+ * @param job The batch, whose itemGroups and groups are filled in.
+ * @param count The number of JWTs.
+ * @param table Scratch table of tableSize entries.
+ * @param tableSize A power of two larger than count.
+ *
+ * @return The number of groups.
+ */
+static size_t GroupBatchByHeader(GfnCloudCheckBatchJob* job, size_t count, size_t* table, size_t tableSize)
+{
+    size_t numGroups = 0;
+
+    for (size_t i = 0; i < tableSize; ++i)
+    {
+        table[i] = BATCH_NO_GROUP;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const char* jwt = job->jwts[i];
+        const char* dot = NULL;
+        size_t headerLen = 0;
+        uint64_t hash = 14695981039346656037ull;
+        size_t slot = 0;
+
+        job->itemGroups[i] = BATCH_NO_GROUP;
+        if (jwt == NULL || job->nonces[i] == NULL)
+        {
+            continue;
+        }
+        dot = strchr(jwt, '.');
+        if (dot == NULL)
+        {
+            continue;
+        }
+        headerLen = dot - jwt;
+        for (size_t j = 0; j < headerLen; ++j)
+        {
+            hash = (hash ^ (unsigned char)jwt[j]) * 1099511628211ull;
+        }
+
+        for (slot = hash & (tableSize - 1); table[slot] != BATCH_NO_GROUP; slot = (slot + 1) & (tableSize - 1))
+        {
+            const GfnCloudCheckBatchGroup* group = &job->groups[table[slot]];
+            if (group->headerLen == headerLen && memcmp(group->header, jwt, headerLen) == 0)
+            {
+                break;
+            }
+        }
+        if (table[slot] == BATCH_NO_GROUP)
+        {
+            job->groups[numGroups].header = jwt;
+            job->groups[numGroups].headerLen = headerLen;
+            job->groups[numGroups].leafPubKey = NULL;
+            table[slot] = numGroups++;
+        }
+        job->itemGroups[i] = table[slot];
+    }
+
+    return numGroups;
+}
+
+bool GfnCloudCheckVerifyAttestationBatch(const char* const jwts[], const char* const nonces[], unsigned int nonceSize, bool results[], size_t count)
+{
+    bool result = false;
+    GfnCloudCheckBatchJob job = { 0 };
+    size_t tableSize = 1;
+    size_t numGroups = 0;
+    unsigned char* memory = NULL;
+
+    if (jwts == NULL || nonces == NULL || results == NULL)
+    {
+        GFN_CC_LOG("Invalid parameters\n");
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        results[i] = false;
+    }
+    if (count == 0)
+    {
+        return true;
+    }
+
+    while (tableSize < 2 * count)
+    {
+        tableSize <<= 1;
+    }
+    memory = GFN_CC_MALLOC(count * (sizeof(size_t) + sizeof(GfnCloudCheckBatchGroup)) + tableSize * sizeof(size_t));
+    if (memory == NULL)
+    {
+        GFN_CC_LOG("Failed to allocate batch state\n");
+        return false;
+    }
+    job.jwts = jwts;
+    job.nonces = nonces;
+    job.nonceSize = nonceSize;
+    job.results = results;
+    job.groups = (GfnCloudCheckBatchGroup*)memory;
+    job.itemGroups = (size_t*)(memory + count * sizeof(GfnCloudCheckBatchGroup));
+    numGroups = GroupBatchByHeader(&job, count, job.itemGroups + count, tableSize);
+
+    pthread_mutex_lock(&s_BatchPool.batchLock);
+    if (!s_BatchPool.initialized && !StartBatchWorkers(0))
+    {
+        pthread_mutex_unlock(&s_BatchPool.batchLock);
+        goto end;
+    }
+    RunBatchPhase(&job, BatchPhaseChains, numGroups);
+    RunBatchPhase(&job, BatchPhaseItems, count);
+    pthread_mutex_unlock(&s_BatchPool.batchLock);
+
+    result = true;
+
+end:
+    for (size_t i = 0; i < numGroups; ++i)
+    {
+        EVP_PKEY_free(job.groups[i].leafPubKey);
+    }
+    GFN_CC_FREE(memory);
+
+    return result;
+}
+
+/*
+ * Asynchronous verifications are queued in FIFO order to a single background worker that owns a
+ * GfnCloudCheckVerifier. Each request holds its own copies of the JWT and nonce and is referenced
+ * by the queue and by the caller's handle, if any; it is freed when both released it.
+ */
+struct GfnCloudCheckAsyncVerification
+{
+    GfnCloudCheckAsyncVerification* next;
+    unsigned int refCount;              // protected by s_AsyncVerification.lock
+    GfnCloudCheckAsyncStatus status;    // protected by s_AsyncVerification.lock
+    GfnCloudCheckAsyncCallback callback;
+    void* context;
+    char* jwt;
+    char* nonce;
+    unsigned int nonceSize;
+};
+
+typedef struct GfnCloudCheckAsyncWorker
+{
+    pthread_mutex_t lock;
+    pthread_cond_t workAvailable;
+    pthread_cond_t completed;
+    bool running;
+    bool stopping;
+    pthread_t thread;
+    GfnCloudCheckAsyncVerification* head;
+    GfnCloudCheckAsyncVerification* tail;
+} GfnCloudCheckAsyncWorker;
+
+static GfnCloudCheckAsyncWorker s_AsyncVerification = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER, false, false, 0, NULL, NULL };
+
+/**
+ * @brief Drops a reference to a request and frees it with the last one. Called with the lock held.
+ */
+static void ReleaseAsyncRequestLocked(GfnCloudCheckAsyncVerification* request)
+{
+    if (--request->refCount == 0)
+    {
+        // The copy of the nonce is not needed anymore
+        memset(request->nonce, 0, request->nonceSize);
+        GFN_CC_FREE(request);
+    }
+}
+
+/**
+ * @brief Publishes the result of a request and invokes its callback. Called without the lock held.
+ */
+static void CompleteAsyncRequest(GfnCloudCheckAsyncVerification* request, GfnCloudCheckAsyncStatus status)
+{
+    pthread_mutex_lock(&s_AsyncVerification.lock);
+    request->status = status;
+    pthread_cond_broadcast(&s_AsyncVerification.completed);
+    pthread_mutex_unlock(&s_AsyncVerification.lock);
+
+    if (request->callback != NULL)
+    {
+        request->callback(status, request->context);
+    }
+
+    pthread_mutex_lock(&s_AsyncVerification.lock);
+    ReleaseAsyncRequestLocked(request);
+    pthread_mutex_unlock(&s_AsyncVerification.lock);
+}
+
+static void* AsyncVerificationWorkerMain(void* arg)
+{
+    GfnCloudCheckVerifier* verifier = GfnCloudCheckVerifierCreate();
+
+    (void)arg;
+    pthread_mutex_lock(&s_AsyncVerification.lock);
+    for (;;)
+    {
+        GfnCloudCheckAsyncVerification* request = NULL;
+        bool valid = false;
+
+        while (!s_AsyncVerification.stopping && s_AsyncVerification.head == NULL)
+        {
+            pthread_cond_wait(&s_AsyncVerification.workAvailable, &s_AsyncVerification.lock);
+        }
+        if (s_AsyncVerification.stopping)
+        {
+            break;
+        }
+        request = s_AsyncVerification.head;
+        s_AsyncVerification.head = request->next;
+        if (s_AsyncVerification.head == NULL)
+        {
+            s_AsyncVerification.tail = NULL;
+        }
+        pthread_mutex_unlock(&s_AsyncVerification.lock);
+
+        if (verifier == NULL)
+        {
+            GFN_CC_LOG("Asynchronous verification has no verifier\n");
+        }
+        else
+        {
+            valid = GfnCloudCheckVerifierVerify(verifier, request->jwt, request->nonce, request->nonceSize);
+        }
+        CompleteAsyncRequest(request, valid ? GfnCloudCheckAsyncValid : GfnCloudCheckAsyncInvalid);
+
+        pthread_mutex_lock(&s_AsyncVerification.lock);
+    }
+    pthread_mutex_unlock(&s_AsyncVerification.lock);
+
+    GfnCloudCheckVerifierDestroy(verifier);
+    return NULL;
+}
+
+bool GfnCloudCheckVerifyAttestationDataAsync(const char* jwt, const char* nonce, unsigned int nonceSize,
+    GfnCloudCheckAsyncCallback callback, void* context, GfnCloudCheckAsyncVerification** handle)
+{
+    GfnCloudCheckAsyncVerification* request = NULL;
+    size_t jwtLen = 0;
+
+    if (handle != NULL)
+    {
+        *handle = NULL;
+    }
+    if (jwt == NULL || nonce == NULL || (callback == NULL && handle == NULL))
+    {
+        GFN_CC_LOG("Invalid parameters\n");
+        return false;
+    }
+
+    // The request, the JWT and the nonce share one allocation
+    jwtLen = strlen(jwt);
+    request = GFN_CC_MALLOC(sizeof(GfnCloudCheckAsyncVerification) + jwtLen + 1 + nonceSize);
+    if (request == NULL)
+    {
+        GFN_CC_LOG("Failed to allocate asynchronous verification\n");
+        return false;
+    }
+    memset(request, 0, sizeof(*request));
+    request->jwt = (char*)(request + 1);
+    memcpy(request->jwt, jwt, jwtLen + 1);
+    request->nonce = request->jwt + jwtLen + 1;
+    memcpy(request->nonce, nonce, nonceSize);
+    request->nonceSize = nonceSize;
+    request->callback = callback;
+    request->context = context;
+    request->status = GfnCloudCheckAsyncPending;
+    request->refCount = (handle != NULL) ? 2 : 1;
+
+    pthread_mutex_lock(&s_AsyncVerification.lock);
+    if (s_AsyncVerification.stopping)
+    {
+        pthread_mutex_unlock(&s_AsyncVerification.lock);
+        GFN_CC_LOG("Asynchronous verification is shutting down\n");
+        GFN_CC_FREE(request);
+        return false;
+    }
+    if (!s_AsyncVerification.running)
+    {
+        if (pthread_create(&s_AsyncVerification.thread, NULL, AsyncVerificationWorkerMain, NULL) != 0)
+        {
+            pthread_mutex_unlock(&s_AsyncVerification.lock);
+            GFN_CC_LOG("Failed to start asynchronous verification worker\n");
+            GFN_CC_FREE(request);
+            return false;
+        }
+        s_AsyncVerification.running = true;
+    }
+    if (s_AsyncVerification.tail != NULL)
+    {
+        s_AsyncVerification.tail->next = request;
+    }
+    else
+    {
+        s_AsyncVerification.head = request;
+    }
+    s_AsyncVerification.tail = request;
+    pthread_cond_signal(&s_AsyncVerification.workAvailable);
+    pthread_mutex_unlock(&s_AsyncVerification.lock);
+
+    if (handle != NULL)
+    {
+        *handle = request;
+    }
+    return true;
+}
+
+GfnCloudCheckAsyncStatus GfnCloudCheckPollAsyncVerification(GfnCloudCheckAsyncVerification* handle)
+{
+    GfnCloudCheckAsyncStatus status = GfnCloudCheckAsyncInvalid;
+
+    if (handle == NULL)
+    {
+        return status;
+    }
+    pthread_mutex_lock(&s_AsyncVerification.lock);
+    status = handle->status;
+    pthread_mutex_unlock(&s_AsyncVerification.lock);
+
+    return status;
+}
+
+GfnCloudCheckAsyncStatus GfnCloudCheckWaitAsyncVerification(GfnCloudCheckAsyncVerification* handle, unsigned int timeoutMs)
+{
+    GfnCloudCheckAsyncStatus status = GfnCloudCheckAsyncInvalid;
+    struct timespec deadline;
+
+    if (handle == NULL)
+    {
+        return status;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&s_AsyncVerification.lock);
+    while (handle->status == GfnCloudCheckAsyncPending)
+    {
+        if (pthread_cond_timedwait(&s_AsyncVerification.completed, &s_AsyncVerification.lock, &deadline) != 0)
+        {
+            break;
+        }
+    }
+    status = handle->status;
+    pthread_mutex_unlock(&s_AsyncVerification.lock);
+
+    return status;
+}
+
+void GfnCloudCheckReleaseAsyncVerification(GfnCloudCheckAsyncVerification* handle)
+{
+    if (handle == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&s_AsyncVerification.lock);
+    ReleaseAsyncRequestLocked(handle);
+    pthread_mutex_unlock(&s_AsyncVerification.lock);
+}
+
+void GfnCloudCheckShutdownAsyncVerification(void)
+{
+    GfnCloudCheckAsyncVerification* canceled = NULL;
+    pthread_t thread;
+    bool running = false;
+
+    pthread_mutex_lock(&s_AsyncVerification.lock);
+    running = s_AsyncVerification.running;
+    thread = s_AsyncVerification.thread;
+    canceled = s_AsyncVerification.head;
+    s_AsyncVerification.head = NULL;
+    s_AsyncVerification.tail = NULL;
+    s_AsyncVerification.stopping = true;
+    pthread_cond_broadcast(&s_AsyncVerification.workAvailable);
+    pthread_mutex_unlock(&s_AsyncVerification.lock);
+
+    // The verification in progress, if any, completes normally
+    if (running)
+    {
+        pthread_join(thread, NULL);
+    }
+
+    while (canceled != NULL)
+    {
+        GfnCloudCheckAsyncVerification* next = canceled->next;
+        CompleteAsyncRequest(canceled, GfnCloudCheckAsyncCanceled);
+        canceled = next;
+    }
+
+    pthread_mutex_lock(&s_AsyncVerification.lock);
+    s_AsyncVerification.running = false;
+    s_AsyncVerification.stopping = false;
+    pthread_mutex_unlock(&s_AsyncVerification.lock);
 }
@@ -18,6 +18,8 @@
 
 #include <GfnCloudCheckUtils.h>
 #include <GfnCloudCheckAppAdapter.h>
+#include <GfnCloudCheckBase64.h>
+#include <GfnCloudCheckJson.h>
 
 BYTE s_RootPublicCert1[] =
     "MIIF6TCCA9GgAwIBAgIUG6WcoUvnieCfcaAv8z5jEHQBT60wDQYJKoZIhvcNAQEL"
@@ -89,6 +91,37 @@ BYTE s_RootPublicCert2[] =
 
 #define MAX_NUMBER_OF_X5C_CERTS  3
 #define MAX_CERTIFICATE_CHAIN_LEN  4
+#define NUMBER_OF_PINNED_ROOT_CERTS  2
+// Extra room per decode so the vectorized base64 kernels can use full-width stores up to the end
+#define GFN_CC_BASE64_VECTOR_SLACK  32
+// Upper bound of the DER encoding of a pinned root certificate, decoded on the stack
+#define MAX_ROOT_CERT_DER_LEN  2048
+#define SHA512_HASH_LEN  64
+
+/*
+ * DER encoding of a certificate received in the x5c field of the JWT header.
+ */
+typedef struct GfnCloudCheckDerCert
+{
+    unsigned char* der;
+    size_t derLen;
+} GfnCloudCheckDerCert;
+
+/*
+ * Everything a verification needs, owned by one verifier so that verifiers on different threads
+ * share no state. The pinned roots are decoded once at creation into a memory store, which is the
+ * exclusive trust anchor of the verifier's chain engine, and the hash provider and scratch memory
+ * are reused across calls.
+ */
+struct GfnCloudCheckVerifier
+{
+    PCCERT_CONTEXT rootCerts[NUMBER_OF_PINNED_ROOT_CERTS];
+    HCERTSTORE rootStore;
+    HCERTCHAINENGINE chainEngine;   // NULL if the OS has no exclusive root support
+    BCRYPT_ALG_HANDLE hashAlg;
+    unsigned char* scratch;
+    size_t scratchSize;
+};
 
 /**
  * @brief Generates a random nonce.
@@ -115,516 +148,316 @@ bool GfnCloudCheckGenerateNonce(char* nonce, unsigned int nonceSize)
     return true;
 }
 
+/*
+ * Bump allocator over the single scratch buffer of a verification. All intermediate data
+ * (decoded JWT segments, x5c DER certificates and the decoded nonce) is carved out of it,
+ * so parsing does not touch the heap.
+ */
+typedef struct GfnCloudCheckArena
+{
+    unsigned char* base;
+    size_t size;
+    size_t used;
+} GfnCloudCheckArena;
+
 /**
- * @brief Decodes a Base64-encoded string and returns the decoded data.
- *
- * This function takes a Base64-encoded string and decodes it into raw binary data.
+ * @brief Reserves memory from the scratch arena.
  *
- * @param src The Base64-encoded string to be decoded.
- * @param dest A pointer to the destination buffer where the decoded data will be stored.
- *             The caller is responsible for freeing this buffer.
+ * @param arena The scratch arena.
+ * @param size The number of bytes to reserve.
  *
- * @return The length of the decoded data in bytes. Returns 0 if the decoding fails.
+ * @return Pointer to the reserved memory, or NULL if the arena is exhausted.
  */
-static int Base64Decode(const unsigned char* src, unsigned char** dest)
+static unsigned char* ArenaAlloc(GfnCloudCheckArena* arena, size_t size)
 {
-    unsigned char decodeTable[256];
-    unsigned char* output = NULL;
-    unsigned char* outputPosition = 0;
-    unsigned char block[4];
-    unsigned char decodedCharacter;
-    size_t inputLength = 0;
-    size_t outputLength = 0;
-    int padding = 0;
-    int count = 0;
-    int encodedBytes = 0;
-    const unsigned char base64Table[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    unsigned char* memory = NULL;
 
-    // Generate decode table
-    memset(decodeTable, 0x80, 256);
-    for (int i = 0; i < 64; i++)
+    if (size > arena->size - arena->used)
     {
-        decodeTable[base64Table[i]] = (unsigned char)i;
+        GFN_CC_LOG("Verification scratch buffer exhausted\n");
+        return NULL;
     }
-    decodeTable['='] = 0;
+    memory = arena->base + arena->used;
+    arena->used += size;
+    return memory;
+}
 
-    // Calculate length of output buffer
-    inputLength = strlen((const char*)src);
-    if (inputLength == 0)
-    {
-        GFN_CC_LOG("Empty src string\n");
-        return 0;
-    }
-    for (unsigned int i = 0; i < inputLength; i++)
-    {
-        if (decodeTable[src[i]] != 0x80)
-        {
-            encodedBytes++;
-        }
-    }
-    if (encodedBytes == 0)
+/**
+ * @brief Decodes Base64 or Base64Url encoded data into the scratch arena with the shared decoder
+ * (GfnCloudCheckBase64.h).
+ *
+ * @param src The encoded data. Does not need to be NUL-terminated.
+ * @param srcLen The length of the encoded data.
+ * @param alphabet The alphabet of the encoded data.
+ * @param arena The scratch arena the decoded data is stored in.
+ * @param dest Storage for a pointer to the decoded data.
+ * @param destLen Storage for the length of the decoded data.
+ *
+ * @return true if the data is well-formed and at least one byte is decoded, false otherwise.
+ */
+static bool Base64DecodeToArena(const char* src, size_t srcLen, GfnBase64Alphabet alphabet, GfnCloudCheckArena* arena, unsigned char** dest, size_t* destLen)
+{
+    unsigned char* output = NULL;
+    size_t outputLen = 0;
+    size_t reservedLen = GfnBase64DecodedMaxLength(srcLen) + GFN_CC_BASE64_VECTOR_SLACK;
+    size_t errorOffset = 0;
+    GfnBase64Status status = GfnBase64Success;
+
+    output = ArenaAlloc(arena, reservedLen);
+    if (output == NULL)
     {
-        return 0;
+        return false;
     }
-    outputLength = (encodedBytes / 4) * 3;
 
-    // Allocate output buffer
-    output = (unsigned char*)GFN_CC_MALLOC(outputLength);
-    if (!output)
+    status = GfnBase64Decode(src, srcLen, alphabet, output, reservedLen, &outputLen, &errorOffset);
+
+    // Give the unused tail of the reservation back to the arena
+    arena->used = (output - arena->base) + (status == GfnBase64Success ? outputLen : 0);
+
+    if (status != GfnBase64Success)
     {
-        GFN_CC_LOG("Failed to allocate memory for output buffer\n");
-        return 0;
+        GFN_CC_LOG("Malformed base64 data (error %d at offset %zu of %zu)\n", (int)status, errorOffset, srcLen);
+        return false;
     }
-    memset(output, 0, outputLength);
-
-    outputPosition = output;
-    for (unsigned int i = 0; i < inputLength; i++)
+    if (outputLen == 0)
     {
-        decodedCharacter = decodeTable[src[i]];
-        if (decodedCharacter == 0x80)
-        {
-            continue;
-        }
-        if (src[i] == '=')
-        {
-            padding++;
-        }
-        block[count] = decodedCharacter;
-        count++;
-        if (count == 4)
-        {
-            *outputPosition++ = (uint8_t)((block[0] << 2) | (block[1] >> 4));
-            *outputPosition++ = (uint8_t)((block[1] << 4) | (block[2] >> 2));
-            *outputPosition++ = (uint8_t)((block[2] << 6) | block[3]);
-            count = 0;
-
-            if (padding != 0)
-            {
-                if (padding == 1)
-                {
-                    outputPosition--;
-                }
-                else if (padding == 2)
-                {
-                    outputPosition -= 2;
-                }
-                else
-                {
-                    GFN_CC_FREE(output);
-                    return 0;
-                }
-                break;
-            }
-        }
+        GFN_CC_LOG("Empty base64 data\n");
+        return false;
     }
-    outputLength = outputPosition - output;
+
     *dest = output;
-    return (int)outputLength;
+    *destLen = outputLen;
+    return true;
 }
 
 /**
- * @brief Decodes a Base64Url-encoded string and returns the decoded data.
+ * @brief Decodes the base64 contents of a JSON string value into the scratch arena.
  *
- * This function takes a Base64Url-encoded string and decodes it into raw binary data.
+ * JSON encoders may escape '/' as "\/"; such values are unescaped into the arena before decoding.
+ * Any other escape sequence is rejected, as it cannot appear in base64 data.
  *
- * @param src The Base64Url-encoded string to be decoded.
- * @param dest A pointer to the destination buffer where the decoded data will be stored.
- *             The caller is responsible for freeing this buffer.
+ * @param value The JSON string view.
+ * @param arena The scratch arena the decoded data is stored in.
+ * @param dest Storage for a pointer to the decoded data.
+ * @param destLen Storage for the length of the decoded data.
  *
- * @return The length of the decoded data in bytes. Returns 0 if the decoding fails.
+ * @return true if the value is decoded successfully, false otherwise.
  */
-static int Base64UrlDecode(const char* src, unsigned char** dest)
+static bool DecodeJsonBase64Value(const GfnJsonStringView* value, GfnCloudCheckArena* arena, unsigned char** dest, size_t* destLen)
 {
-    size_t inputLength = strlen(src);
-    size_t padding = 0;
+    char* unescaped = NULL;
+    size_t unescapedLen = 0;
+    size_t arenaMark = arena->used;
+    bool result = false;
 
-    // Create a local buffer of (src length + 4) size for transformation
-    char* buffer = (char* )GFN_CC_MALLOC(inputLength + 4);
-    if (!buffer)
+    // The tokenizer already flagged escape sequences, so unescaped values are not scanned again
+    if (!value->escaped)
     {
-        GFN_CC_LOG("Failed to allocate local buffer\n");
-        return 0;
+        return Base64DecodeToArena(value->data, value->length, GfnBase64AlphabetStandard, arena, dest, destLen);
     }
 
-    size_t bufferLength = inputLength;
-
-    // Calculate the number of '=' characters needed to make the input size a multiple of 4
-    padding = (4 - (inputLength % 4)) % 4;
-    bufferLength += padding;
-
-    // Copy the input to the result buffer and append padding characters
-    strcpy(buffer, src);
-    for (size_t i = 0; i < padding; i++)
+    unescaped = (char*)ArenaAlloc(arena, value->length);
+    if (unescaped == NULL)
     {
-        buffer[inputLength + i] = '=';
+        return false;
     }
-    buffer[bufferLength] = '\0';
-
-    // Replace '-' with '+' and '_' with '/'
-    for (size_t i = 0; i < bufferLength; i++)
+    for (size_t i = 0; i < value->length; i++)
     {
-        if (buffer[i] == '-')
+        if (value->data[i] == '\\')
         {
-            buffer[i] = '+';
-        }
-        else if (buffer[i] == '_')
-        {
-            buffer[i] = '/';
+            if (i + 1 >= value->length || value->data[i + 1] != '/')
+            {
+                GFN_CC_LOG("Unexpected escape sequence in base64 value at offset %zu\n", i);
+                arena->used = arenaMark;
+                return false;
+            }
+            i++;
         }
+        unescaped[unescapedLen++] = value->data[i];
     }
 
-    // Call the Base64Decode function to decode the modified buffer
-    int destSize = Base64Decode((unsigned char* )buffer, dest);
-    GFN_CC_FREE(buffer);
-    return destSize;
+    result = Base64DecodeToArena(unescaped, unescapedLen, GfnBase64AlphabetStandard, arena, dest, destLen);
+    if (result)
+    {
+        // Move the decoded data over the unescaped copy, which is no longer needed
+        memmove(unescaped, *dest, *destLen);
+        *dest = (unsigned char*)unescaped;
+        arena->used = arenaMark + *destLen;
+    }
+    else
+    {
+        arena->used = arenaMark;
+    }
+    return result;
 }
 
 /**
  * @brief Parses a JSON-formatted header string to extract information.
- * Instead of utilizing a standard open-source software, a simple custom parser is implemented
- * to allow integration into games/applications without concerns about licensing/legal issues.
+ * Instead of utilizing a standard open-source software, a small streaming tokenizer
+ * (GfnCloudCheckJson.h) is used to allow integration into games/applications without
+ * concerns about licensing/legal issues.
  *
  * This function extracts information from a JSON-formatted header string,
- * specifically checking and parsing the "alg" and "x5c" fields.
+ * specifically checking and parsing the "alg" and "x5c" members of the top-level object.
+ * The header is tokenized in a single pass and strictly validated; only the decoded
+ * certificates are written to the scratch arena.
  *
  * @param header The JSON formatted header string to be parsed.
- * @param pX5CCerts A pointer to an array of strings to store x5c certificates.
- *                   The caller is responsible for freeing each string and the array.
+ * @param headerLen The length of the JSON formatted header string.
+ * @param arena The scratch arena the decoded certificates are stored in.
+ * @param pX5CCerts A pointer to an array to store the DER encoding of the x5c certificates.
  * @param numOfX5CCerts A pointer to an integer to store the number of x5c certificates found.
  *                      Set to 0 if none are found or if parsing fails.
  *
  * @return true if the header is successfully parsed, false otherwise.
  */
-static bool ParseHeaderJson(const unsigned char* header, const size_t headerLen, char** pX5CCerts, unsigned int* numOfX5CCerts)
+static bool ParseHeaderJson(const unsigned char* header, const size_t headerLen, GfnCloudCheckArena* arena, GfnCloudCheckDerCert* pX5CCerts, unsigned int* numOfX5CCerts)
 {
-    bool result = false;
-    char* headerCopy = NULL;
-    char* algValue = NULL;
+    GfnJsonStringView alg = { NULL, 0, false };
+    GfnJsonStringView x5c[MAX_NUMBER_OF_X5C_CERTS];
+    unsigned int numX5c = 0;
+    size_t errorOffset = 0;
+    GfnJsonJwtStatus status = GfnJsonJwtSuccess;
 
     *numOfX5CCerts = 0;
 
-    headerCopy = GFN_CC_MALLOC(sizeof(char) * (headerLen + 1));
-    if (headerCopy == NULL)
+    status = GfnJsonParseJwtHeader((const char*)header, headerLen, &alg, x5c, MAX_NUMBER_OF_X5C_CERTS, &numX5c, &errorOffset);
+    if (status != GfnJsonJwtSuccess)
     {
-        GFN_CC_LOG("Failed to allocate memory for copy of header\n");
+        GFN_CC_LOG("Failed to parse the header, status %d at offset %zu\n", (int)status, errorOffset);
         return false;
     }
-    memcpy(headerCopy, header, headerLen);
-    headerCopy[headerLen] = '\0';
-
-    const char* start = strchr(headerCopy, '{');
-    const char* end = strchr(headerCopy, '}');
-    if (start == NULL || end == NULL)
-    {
-        GFN_CC_LOG("Failed to parse start and end delimiters in the header\n");
-        result = false;
-        goto end;
-    }
-    char* algKey = strstr(start + 1, "\"alg\"");
-    if (algKey == NULL)
-    {
-        GFN_CC_LOG("Failed to parse alg key in the header\n");
-        result = false;
-        goto end;
-    }
-    char* colon = strchr(algKey, ':');
-    if (colon == NULL)
-    {
-        GFN_CC_LOG("Failed to parse alg key separator in the header\n");
-        result = false;
-        goto end;
-    }
-    char* algValueStart = strchr(colon + 1, '\"');
-    if (algValueStart == NULL)
-    {
-        GFN_CC_LOG("Failed to parse alg value start in the header\n");
-        result = false;
-        goto end;
-    }
-    char* algValueEnd = strchr(algValueStart + 1, '\"');
-    if (algValueEnd == NULL)
-    {
-        GFN_CC_LOG("Failed to parse alg value end in the header\n");
-        result = false;
-        goto end;
-    }
-    int algLen = (int)(algValueEnd - algValueStart);
-    algValue = GFN_CC_MALLOC(algLen);
-    if (algValue == NULL)
-    {
-        GFN_CC_LOG("Failed to allocate memory for alg field in the header\n");
-        result = false;
-        goto end;
-    }
-    memset(algValue, 0, algLen);
-    memcpy(algValue, algValueStart + 1, algLen - 1);
-    if (strcmp(algValue, "RS512") != 0)
+    if (alg.escaped || alg.length != strlen("RS512") || memcmp(alg.data, "RS512", alg.length) != 0)
     {
         GFN_CC_LOG("Failed to verify alg field in the header\n");
-        result = false;
-        goto end;
-    }
-
-    // Parse x5c field
-    char* x5cKey = strstr(start + 1, "\"x5c\"");
-    if (x5cKey == NULL)
-    {
-        GFN_CC_LOG("Failed to parse x5c key in the header\n");
-        result = false;
-        goto end;
-    }
-    colon = strchr(x5cKey, ':');
-    if (colon == NULL)
-    {
-        GFN_CC_LOG("Failed to parse x5c key separator in the header\n");
-        result = false;
-        goto end;
-    }
-    char* x5cStart = strchr(colon + 1, '[');
-    if (x5cStart == NULL)
-    {
-        GFN_CC_LOG("Failed to parse x5c start in the header\n");
-        result = false;
-        goto end;
-    }
-    char* x5cEnd = strchr(x5cStart + 1, ']');
-    if (x5cEnd == NULL)
-    {
-        GFN_CC_LOG("Failed to parse x5c end in the header\n");
-        result = false;
-        goto end;
+        return false;
     }
 
     // Extract certificates
-    unsigned int i = 0;
-    char* x5cCert = strtok(x5cStart + 1, ",");
-    while ((x5cCert != NULL) && (x5cCert < x5cEnd))
+    for (unsigned int i = 0; i < numX5c; i++)
     {
-        if (i >= MAX_NUMBER_OF_X5C_CERTS)
-        {
-            GFN_CC_LOG("Certificate count of %i exceeds expected %d\n", i, MAX_NUMBER_OF_X5C_CERTS);
-            result = false;
-            goto end;
-        }
-
-        size_t certLength = strlen(x5cCert);
-        char* cert = GFN_CC_MALLOC(certLength + 1);
-        if (cert == NULL)
+        if (!DecodeJsonBase64Value(&x5c[i], arena, &pX5CCerts[i].der, &pX5CCerts[i].derLen))
         {
-            GFN_CC_LOG("Failed to allocate memory for x5c cert %d\n", i);
-            result = false;
-            goto end;
+            GFN_CC_LOG("Failed to decode x5c cert %u\n", i);
+            return false;
         }
-        memcpy(cert, x5cCert, certLength);
-        pX5CCerts[i++] = cert;
-        *numOfX5CCerts = i;
-
-        // splitting with both , and ] to account for the last cert not having a
-        // trailing ,
-        x5cCert = strtok(NULL, ",]");
     }
 
-    result = true;
-
-end:
-    if (headerCopy != NULL)
-    {
-        GFN_CC_FREE(headerCopy);
-    }
-    if (algValue != NULL)
-    {
-        GFN_CC_FREE(algValue);
-    }
-    if (!result && *numOfX5CCerts > 0)
-    {
-        for (i = 0; i < *numOfX5CCerts; i++)
-        {
-            if (pX5CCerts[i] != NULL)
-            {
-                GFN_CC_FREE(pX5CCerts[i]);
-                pX5CCerts[i] = NULL;
-            }
-        }
-        *numOfX5CCerts = 0;
-    }
-    return result;
+    *numOfX5CCerts = numX5c;
+    return true;
 }
 
 /**
  * @brief Parses a JSON-formatted payload string to verify a nonce value.
- * Instead of utilizing a standard open-source software, a simple custom parser is implemented
- * to allow integration into games/applications without concerns about licensing/legal issues.
+ * Instead of utilizing a standard open-source software, a small streaming tokenizer
+ * (GfnCloudCheckJson.h) is used to allow integration into games/applications without
+ * concerns about licensing/legal issues.
  *
- * This function extracts and decodes the "nonce" field from a JSON-formatted payload string
- * and compares it with a provided nonce value to verify its authenticity.
+ * This function extracts and decodes the "nonce" (or "ononce") member of the top-level object
+ * of a JSON-formatted payload string and compares it with a provided nonce value to verify its authenticity.
  *
  * @param payload The JSON formatted payload string to be parsed.
+ * @param payloadLen The length of the JSON formatted payload string.
+ * @param arena The scratch arena the decoded nonce is stored in.
  * @param nonce The nonce value to be compared with the decoded nonce from the payload.
  * @param nonceSize The size of nonce in bytes.
  *
  * @return true if the nonce value in the payload matches the provided nonce; false otherwise.
  */
-static bool ParsePayloadJson(const unsigned char* payload, const size_t payloadLen, const char* nonce, unsigned int nonceSize)
+static bool ParsePayloadJson(const unsigned char* payload, const size_t payloadLen, GfnCloudCheckArena* arena, const char* nonce, unsigned int nonceSize)
 {
-    bool result = false;
+    GfnJsonStringView nonceView = { NULL, 0, false };
+    size_t errorOffset = 0;
+    GfnJsonJwtStatus status = GfnJsonJwtSuccess;
     unsigned char* decodedNonce = NULL;
-    char* nonceValue = NULL;
-    char* payloadCopy = NULL;
+    size_t decodedNonceLen = 0;
 
-    payloadCopy = GFN_CC_MALLOC(sizeof(char) * (payloadLen + 1));
-    if (payloadCopy == NULL)
+    status = GfnJsonParseJwtPayload((const char*)payload, payloadLen, &nonceView, &errorOffset);
+    if (status != GfnJsonJwtSuccess)
     {
-        GFN_CC_LOG("Failed to allocate memory for copy of header\n");
-        result = false;
-        goto end;
+        GFN_CC_LOG("Failed to parse the payload, status %d at offset %zu\n", (int)status, errorOffset);
+        return false;
     }
-    memcpy(payloadCopy, payload, payloadLen);
-    payloadCopy[payloadLen] = '\0';
 
-    const char* start = strchr(payloadCopy, '{');
-    const char* end = strchr(payloadCopy, '}');
-    if (start == NULL || end == NULL)
-    {
-        GFN_CC_LOG("Failed to parse start and end delimiters in the payload\n");
-        result = false;
-        goto end;
-    }
-    char* nonceKey = strstr(start + 1, "\"nonce\"");
-    if (nonceKey == NULL)
-    {
-        nonceKey = strstr(start + 1, "\"ononce\"");
-        if (nonceKey == NULL)
-        {
-            GFN_CC_LOG("Failed to parse nonce key in the payload\n");
-            result = false;
-            goto end;
-        }
-    }
-    char* colon = strchr(nonceKey, ':');
-    if (colon == NULL)
-    {
-        GFN_CC_LOG("Failed to parse nonce key separator in the payload\n");
-        result = false;
-        goto end;
-    }
-    char* nonceValueStart = strchr(colon + 1, '\"');
-    if (nonceValueStart == NULL)
-    {
-        GFN_CC_LOG("Failed to parse nonce value start in the payload\n");
-        GFN_CC_LOG("Missing nonce field\n");
-        result = false;
-        goto end;
-    }
-    char* nonceValueEnd = strchr(nonceValueStart + 1, '\"');
-    if (nonceValueEnd == NULL)
-    {
-        GFN_CC_LOG("Failed to parse nonce value end in the payload\n");
-        result = false;
-        goto end;
-    }
-    int nonceLen = (int)(nonceValueEnd - nonceValueStart);
-    nonceValue = GFN_CC_MALLOC(nonceLen);
-    if (nonceValue == NULL)
+    if (!DecodeJsonBase64Value(&nonceView, arena, &decodedNonce, &decodedNonceLen))
     {
-        GFN_CC_LOG("Failed to allocate memory for nonce value in the payload\n");
-        result = false;
-        goto end;
+        GFN_CC_LOG("Failed to decode nonce value in the payload\n");
+        return false;
     }
-    memset(nonceValue, 0, nonceLen);
-    memcpy(nonceValue, nonceValueStart + 1, (size_t)nonceLen - 1);
 
-    if (Base64Decode((unsigned char*)nonceValue, &decodedNonce))
+    if (decodedNonceLen != nonceSize || memcmp(decodedNonce, nonce, nonceSize) != 0)
     {
-        if (memcmp(decodedNonce, nonce, nonceSize) != 0)
-        {
-            GFN_CC_LOG("Failed to match nonce value in the payload with input nonce\n");
-            result = false;
-        }
-        else
-        {
-            result = true;
-        }
+        GFN_CC_LOG("Failed to match nonce value in the payload with input nonce\n");
+        return false;
     }
 
-end:
-    if (payloadCopy != NULL)
-    {
-        GFN_CC_FREE(payloadCopy);
-    }
-    if (nonceValue != NULL)
+    return true;
+}
+
+/**
+ * @brief Creates a certificate context for a pinned root certificate.
+ *
+ * The Base64-encoded certificate is decoded on the stack.
+ *
+ * @param rootCert The Base64-encoded root certificate.
+ * @param pcRootCert Storage for the created certificate context. The caller is responsible for freeing it.
+ *
+ * @return true if the certificate context is successfully created, false otherwise.
+ */
+static bool CreateRootCertificateContext(const unsigned char* rootCert, PCCERT_CONTEXT* pcRootCert)
+{
+    unsigned char cert[MAX_ROOT_CERT_DER_LEN];
+    size_t certSize = 0;
+
+    if (GfnBase64Decode((const char*)rootCert, strlen((const char*)rootCert), GfnBase64AlphabetStandard,
+            cert, sizeof(cert), &certSize, NULL) != GfnBase64Success)
     {
-        GFN_CC_FREE(nonceValue);
+        GFN_CC_LOG("Failed to decode root certificate\n");
+        return false;
     }
-    if (decodedNonce != NULL)
+    *pcRootCert = CertCreateCertificateContext(X509_ASN_ENCODING, cert, (DWORD)certSize);
+    if (*pcRootCert == NULL)
     {
-        GFN_CC_FREE(decodedNonce);
+        GFN_CC_LOG("Failed to create root certificate context, error: %x\n", GetLastError());
+        return false;
     }
-    return result;
+    return true;
 }
 
 /**
- * @brief Creates an array of certificate contexts from Base64-encoded x5c certificates.
+ * @brief Creates an array of certificate contexts from DER encoded x5c certificates.
  *
- * This function takes an array of Base64-encoded x5c certificates, decodes them, and creates
- * PCCERT_CONTEXT structures for each certificate. The resulting array includes both leaf and
- * root certificates.
+ * This function takes an array of DER encoded x5c certificates and creates PCCERT_CONTEXT
+ * structures for each certificate.
  *
- * @param x5cCerts An array of Base64-encoded x5c certificates.
+ * @param x5cCerts An array of DER encoded x5c certificates.
  * @param numOfCerts The number of certificates in the x5cCerts array.
- * @param rootCert The root certificate to be appended to this certificate chain
  * @param pcCertArray Pointer to the array that will store the created PCCERT_CONTEXT structures.
  *                    The caller is responsible for freeing the memory associated with this array.
  *
  * @return true if the certificate contexts are successfully created, false otherwise.
  */
-bool CreateCertificateContext(char** x5cCerts, unsigned int numOfCerts, unsigned char *rootCert, PCCERT_CONTEXT* pcCertArray)
+bool CreateCertificateContext(const GfnCloudCheckDerCert* x5cCerts, unsigned int numOfCerts, PCCERT_CONTEXT* pcCertArray)
 {
-    unsigned char* cert = NULL;
-    int certSize = 0;
     PCCERT_CONTEXT pcCertContext = NULL;
 
-    if (numOfCerts > MAX_CERTIFICATE_CHAIN_LEN - 1)
+    if (numOfCerts > MAX_NUMBER_OF_X5C_CERTS)
     {
-        GFN_CC_LOG("Number of received certificates (%d) larger than limit (%d)\n", numOfCerts, MAX_CERTIFICATE_CHAIN_LEN);
+        GFN_CC_LOG("Number of received certificates (%d) larger than limit (%d)\n", numOfCerts, MAX_NUMBER_OF_X5C_CERTS);
         return false;
     }
 
     // Iterate through x5c Certificates and create the PC_CERT_CONTEXT
     for (unsigned int i = 0; i < numOfCerts; i++)
     {
-        certSize = Base64Decode((unsigned char*)x5cCerts[i], &cert);
-        if (certSize == 0)
-        {
-            GFN_CC_LOG("Failed to decode %d x5cCertificate \n", i);
-            return false;
-        }
-        pcCertContext = CertCreateCertificateContext(X509_ASN_ENCODING, cert, certSize);
+        pcCertContext = CertCreateCertificateContext(X509_ASN_ENCODING, x5cCerts[i].der, (DWORD)x5cCerts[i].derLen);
         if (pcCertContext == NULL)
         {
             GFN_CC_LOG("Failed to create %d certificate context, error:.%x\n", i, GetLastError());
-            GFN_CC_FREE(cert);
             return false;
         }
         pcCertArray[i] = pcCertContext;
-        GFN_CC_FREE(cert);
-    }
-
-    // Create the PC_CERT_CONTEXT for root certificate
-    certSize = Base64Decode(rootCert, &cert);
-    if (certSize == 0)
-    {
-        GFN_CC_LOG("Failed to decode root certificate\n");
-        return false;
-    }
-    pcCertContext = CertCreateCertificateContext(X509_ASN_ENCODING, cert, certSize);
-    if (pcCertContext == NULL)
-    {
-        GFN_CC_LOG("Failed to create root certificate context, error: %x\n", GetLastError());
-        GFN_CC_FREE(cert);
-        return false;
     }
-    pcCertArray[numOfCerts] = pcCertContext;
-    GFN_CC_FREE(cert);
     return true;
 }
 
@@ -632,60 +465,25 @@ bool CreateCertificateContext(char** x5cCerts, unsigned int numOfCerts, unsigned
  * @brief Generates the SHA-512 hash of the given data.
  *
  * This function uses the Windows Cryptography API to generate the SHA-512 hash
- * of the provided data.
+ * of the provided data. The hash object is allocated by CNG, so no memory is
+ * requested through GFN_CC_MALLOC.
  *
+ * @param algHandle SHA-512 algorithm provider, opened by the verifier.
  * @param data Pointer to the data to be hashed.
  * @param dataSize Size of the data in bytes.
- * @param output Pointer to the buffer that will store the resulting hash.
- *               The caller is responsible for freeing this buffer.
- * @param outputSize Pointer to the variable that will store the size of the hash output.
+ * @param output Buffer that receives the SHA512_HASH_LEN byte hash.
  *
  * @return true if the hash is successfully generated, false otherwise.
  */
-bool GenerateHash(const unsigned char* data, unsigned long dataSize, unsigned char** output, unsigned long* outputSize)
+bool GenerateHash(BCRYPT_ALG_HANDLE algHandle, const unsigned char* data, unsigned long dataSize, unsigned char output[SHA512_HASH_LEN])
 {
     NTSTATUS status = S_OK;
 
-    // Handle to default crypto provider
-    BCRYPT_ALG_HANDLE algHandle = NULL;
-
     // Handle to hash object
     BCRYPT_HASH_HANDLE hashObjectHandle = NULL;
-    unsigned char* hashObject = NULL;
-    unsigned long hashObjectLength = 0;
-    unsigned long resultLength = 0;
-
-    // Initialize OUT parameters
-    *output = NULL;
-    *outputSize = 0;
-
-    // Get a handle to a cryptographic provider
-    status = BCryptOpenAlgorithmProvider(&algHandle, BCRYPT_SHA512_ALGORITHM,NULL, 0);
-    if (!BCRYPT_SUCCESS(status))
-    {
-        GFN_CC_LOG("Failed to open Algorithm provider, error: %x\n", GetLastError());
-        goto cleanUp;
-    }
-
-    // Get size of hash object
-    status = BCryptGetProperty(algHandle, BCRYPT_OBJECT_LENGTH, (PUCHAR)&hashObjectLength, sizeof(hashObjectLength), &resultLength, 0);
-    if (!BCRYPT_SUCCESS(status))
-    {
-        GFN_CC_LOG("Failed to get size of hash object, error: %x\n", GetLastError());
-        goto cleanUp;
-    }
-
-    // Allocate memory for hash object
-    hashObject = (unsigned char* )GFN_CC_MALLOC(hashObjectLength);
-    if (hashObject == NULL)
-    {
-        GFN_CC_LOG("Failed to allocate memory for hash object\n");
-        status = HRESULT_FROM_WIN32(ERROR_OUTOFMEMORY);
-        goto cleanUp;
-    }
 
-    // Create hash object
-    status = BCryptCreateHash(algHandle,&hashObjectHandle, hashObject, hashObjectLength, NULL, 0, 0);
+    // Create hash object, letting CNG allocate its memory
+    status = BCryptCreateHash(algHandle, &hashObjectHandle, NULL, 0, NULL, 0, 0);
     if (!BCRYPT_SUCCESS(status))
     {
         GFN_CC_LOG("Failed to create hash object, error: %x\n", GetLastError());
@@ -700,24 +498,8 @@ bool GenerateHash(const unsigned char* data, unsigned long dataSize, unsigned ch
         goto cleanUp;
     }
 
-    // Get size of final hash buffer
-    status = BCryptGetProperty(algHandle, BCRYPT_HASH_LENGTH, (PUCHAR)outputSize, sizeof(*outputSize), &resultLength, 0);
-    if (!BCRYPT_SUCCESS(status))
-    {
-        goto cleanUp;
-    }
-
-    // Allocate memory for hashed output
-    *output = (unsigned char* )GFN_CC_MALLOC(*outputSize);
-    if (*output == NULL)
-    {
-        GFN_CC_LOG("Failed to allocate memory for hash output\n");
-        status = HRESULT_FROM_WIN32(ERROR_OUTOFMEMORY);
-        goto cleanUp;
-    }
-
     // Compute the hash and receive it in the buffer
-    status = BCryptFinishHash(hashObjectHandle, (PUCHAR)*output, *outputSize, 0);
+    status = BCryptFinishHash(hashObjectHandle, (PUCHAR)output, SHA512_HASH_LEN, 0);
     if (!BCRYPT_SUCCESS(status))
     {
         GFN_CC_LOG("Failed to compute the hash, error: %x\n", GetLastError());
@@ -728,20 +510,7 @@ bool GenerateHash(const unsigned char* data, unsigned long dataSize, unsigned ch
 cleanUp:
     if (hashObjectHandle != NULL)
     {
-        BCryptDestroyHash(&hashObjectHandle);
-    }
-    if (hashObject != NULL)
-    {
-        GFN_CC_FREE(hashObject);
-    }
-    if (!BCRYPT_SUCCESS(status))
-    {
-        if (*output != NULL)
-        {
-            GFN_CC_FREE(*output);
-        }
-        *output = NULL;
-        *outputSize = 0;
+        BCryptDestroyHash(hashObjectHandle);
     }
     return status != S_OK ? false : true;
 }
@@ -811,12 +580,15 @@ bool CheckCertificateExtensions(PCCERT_CONTEXT pCertContext, const char* certLab
         }
     }
 
-    // Check Key Usage
+    // Check Key Usage. The decoded structures fit in a stack buffer for the GFN certificates,
+    // larger ones are allocated.
+    ULONGLONG localBuffer[64];
     DWORD cbKeyUsage = 0;
 
     if (CertGetEnhancedKeyUsage(pCertContext, CERT_FIND_EXT_ONLY_ENHKEY_USAGE_FLAG, NULL, &cbKeyUsage))
     {
-        PCERT_ENHKEY_USAGE pEnhKeyUsage = (PCERT_ENHKEY_USAGE)GFN_CC_MALLOC(cbKeyUsage);
+        PCERT_ENHKEY_USAGE pEnhKeyUsage = (cbKeyUsage <= sizeof(localBuffer)) ?
+            (PCERT_ENHKEY_USAGE)localBuffer : (PCERT_ENHKEY_USAGE)GFN_CC_MALLOC(cbKeyUsage);
         if (pEnhKeyUsage)
         {
             if (CertGetEnhancedKeyUsage(pCertContext, CERT_FIND_EXT_ONLY_ENHKEY_USAGE_FLAG, pEnhKeyUsage, &cbKeyUsage))
@@ -836,7 +608,10 @@ bool CheckCertificateExtensions(PCCERT_CONTEXT pCertContext, const char* certLab
                     result = false;
                 }
             }
-            GFN_CC_FREE(pEnhKeyUsage);
+            if (pEnhKeyUsage != (PCERT_ENHKEY_USAGE)localBuffer)
+            {
+                GFN_CC_FREE(pEnhKeyUsage);
+            }
         }
     }
 
@@ -846,7 +621,8 @@ bool CheckCertificateExtensions(PCCERT_CONTEXT pCertContext, const char* certLab
 
     if (CertGetCertificateContextProperty(pCertContext, CERT_POLICIES_PROP_ID, NULL, &cbPolicies))
     {
-        pPoliciesInfo = (PCERT_POLICIES_INFO)GFN_CC_MALLOC(cbPolicies);
+        pPoliciesInfo = (cbPolicies <= sizeof(localBuffer)) ?
+            (PCERT_POLICIES_INFO)localBuffer : (PCERT_POLICIES_INFO)GFN_CC_MALLOC(cbPolicies);
         if (pPoliciesInfo)
         {
             if (CertGetCertificateContextProperty(pCertContext, CERT_POLICIES_PROP_ID, pPoliciesInfo, &cbPolicies))
@@ -857,7 +633,10 @@ bool CheckCertificateExtensions(PCCERT_CONTEXT pCertContext, const char* certLab
                     GFN_CC_LOG("  Policy: %s\n", pPoliciesInfo->rgPolicyInfo[i].pszPolicyIdentifier);
                 }
             }
-            GFN_CC_FREE(pPoliciesInfo);
+            if (pPoliciesInfo != (PCERT_POLICIES_INFO)localBuffer)
+            {
+                GFN_CC_FREE(pPoliciesInfo);
+            }
         }
     }
 
@@ -920,18 +699,42 @@ bool CheckRevocationStatus(PCCERT_CONTEXT pCertContext, const char* certLabel)
     return result;
 }
 
+/**
+ * @brief Checks whether a certificate is one of the pinned root certificates of a verifier.
+ *
+ * @param verifier The verifier holding the pinned roots.
+ * @param pCertContext The certificate to check.
+ *
+ * @return true if the certificate is byte-identical to a pinned root, false otherwise.
+ */
+static bool IsPinnedRootCertificate(const GfnCloudCheckVerifier* verifier, PCCERT_CONTEXT pCertContext)
+{
+    for (int i = 0; i < NUMBER_OF_PINNED_ROOT_CERTS; i++)
+    {
+        if (pCertContext->cbCertEncoded == verifier->rootCerts[i]->cbCertEncoded &&
+            memcmp(pCertContext->pbCertEncoded, verifier->rootCerts[i]->pbCertEncoded, pCertContext->cbCertEncoded) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * @brief Validates a certificate chain composed of x5c certificates.
  *
  * This function validates a certificate chain containing x5c certificates.
  * It opens a certificate store in memory, adds the x5c certificates to the store,
- * builds the certificate chain, performs time validity checks, and verifies the chain against SSL policy.
+ * builds the certificate chain with the verifier's chain engine, which trusts only the pinned roots,
+ * performs time validity checks, and verifies the chain against SSL policy.
  *
+ * @param verifier The verifier whose pinned roots and chain engine are used.
  * @param pcCertArray An array of PCCERT_CONTEXT pointers representing x5c certificates.
+ * @param numOfCerts The number of certificates in pcCertArray.
  *
  * @return true if the certificate chain is successfully validated, false otherwise.
  */
-bool ValidateCertificateChain(PCCERT_CONTEXT* pcCertArray)
+bool ValidateCertificateChain(const GfnCloudCheckVerifier* verifier, PCCERT_CONTEXT* pcCertArray, unsigned int numOfCerts)
 {
     bool  result = 0;
     HCERTSTORE hMemStore = NULL;
@@ -946,7 +749,7 @@ bool ValidateCertificateChain(PCCERT_CONTEXT* pcCertArray)
     }
 
     // Add all x5c certificates to this store
-    for (int i = 0; i < MAX_CERTIFICATE_CHAIN_LEN; i++)
+    for (unsigned int i = 0; i < numOfCerts; i++)
     {
         if (!CertAddEncodedCertificateToStore(hMemStore, X509_ASN_ENCODING, pcCertArray[i]->pbCertEncoded, pcCertArray[i]->cbCertEncoded, CERT_STORE_ADD_USE_EXISTING, NULL))
         {
@@ -956,6 +759,20 @@ bool ValidateCertificateChain(PCCERT_CONTEXT* pcCertArray)
         }
     }
 
+    // Without an exclusive root engine the pinned roots are only offered as additional certificates
+    if (verifier->chainEngine == NULL)
+    {
+        for (int i = 0; i < NUMBER_OF_PINNED_ROOT_CERTS; i++)
+        {
+            if (!CertAddCertificateContextToStore(hMemStore, verifier->rootCerts[i], CERT_STORE_ADD_USE_EXISTING, NULL))
+            {
+                GFN_CC_LOG("Failed to add pinned root %i to the store, error: %x\n", i, GetLastError());
+                result = false;
+                goto end;
+            }
+        }
+    }
+
     // Build the certificate chain
     CERT_ENHKEY_USAGE enhkeyUsage;
     enhkeyUsage.cUsageIdentifier = 0;
@@ -976,7 +793,7 @@ bool ValidateCertificateChain(PCCERT_CONTEXT* pcCertArray)
         CERT_CHAIN_DISABLE_AUTH_ROOT_AUTO_UPDATE;     // Don't auto-update root store
 
     // Get the certificate chain from the store
-    if (!CertGetCertificateChain(NULL, pcCertArray[0], NULL, hMemStore, &chainPara, chainFlags, NULL, &pChainContext))
+    if (!CertGetCertificateChain(verifier->chainEngine, pcCertArray[0], NULL, hMemStore, &chainPara, chainFlags, NULL, &pChainContext))
     {
         GFN_CC_LOG("Failed to get certificate chain, error: %x\n", GetLastError());
         result = false;
@@ -1008,12 +825,9 @@ bool ValidateCertificateChain(PCCERT_CONTEXT* pcCertArray)
         }
 
         // Get the root certificate from the chain (last element)
-        // Compare with our pinned root certificate
+        // Compare with our pinned root certificates
         const PCCERT_CONTEXT pRootCertInChain = pChainContext->rgpChain[0]->rgpElement[MAX_CERTIFICATE_CHAIN_LEN - 1]->pCertContext;
-        if (pRootCertInChain->cbCertEncoded != pcCertArray[MAX_CERTIFICATE_CHAIN_LEN - 1]->cbCertEncoded ||
-            memcmp(pRootCertInChain->pbCertEncoded, 
-                   pcCertArray[MAX_CERTIFICATE_CHAIN_LEN - 1]->pbCertEncoded,
-                   pRootCertInChain->cbCertEncoded) != 0)
+        if (!IsPinnedRootCertificate(verifier, pRootCertInChain))
         {
             GFN_CC_LOG("Root certificate in chain does not match pinned root certificate\n");
             result = false;
@@ -1119,6 +933,14 @@ bool VerifySignature(char* decodedSignature, int signatureLen, char* hashedData,
     return result;
 }
 
+size_t GfnCloudCheckGetVerificationScratchSize(size_t jwtLength)
+{
+    // Decoded segments take 3/4 of the JWT. The x5c certificates and the nonce decoded out of them
+    // take at most 3/4 of that again, or all of it while an escaped value is being unescaped.
+    // Add room for the vector stores of the last decode.
+    return 2 * jwtLength + 2 * GFN_CC_BASE64_VECTOR_SLACK;
+}
+
 /**
  * @brief Validates attestation data received in CloudCheck API response represented as a JWT.
  *
@@ -1130,31 +952,33 @@ bool VerifySignature(char* decodedSignature, int signatureLen, char* hashedData,
  *   a.Extract Certificate chain from x5c field
  *   b.Match alg field to RS512 string
  * 3.Parse data and match nonce field with input value of nonce
- * 4.Append root certificate to the Certificate chain in #2a, and validate the Certificate chain
+ * 4.Validate the Certificate chain in #2a against the pinned root certificates
  * 5.Generate Hash of (base64url(header).base64url(data))
  * 6.Decrypt signature using public key of the first certificate in the list
  * 7.If decrypted signature in #6 matches with hash value in #5, indicates JWT is valid
  *
- * @param attestationData The attestation data in JWT format.
+ * The JWT is parsed in place, and all decoded data is stored in the given scratch buffer.
+ *
+ * @param verifier The verifier whose pinned roots, chain engine and hash provider are used.
+ * @param jwt The attestation data in JWT format.
  * @param nonce The nonce value to match with the value in the payload.
  * @param nonceSize The size of nonce in bytes.
+ * @param scratch Scratch buffer of at least GfnCloudCheckGetVerificationScratchSize(strlen(jwt)) bytes.
+ * @param scratchSize The size of the scratch buffer.
  *
  * @return true if the JWT response is valid, false otherwise.
  */
-bool GfnCloudCheckVerifyAttestationData(const char* jwt, const char* nonce, unsigned int nonceSize)
+static bool VerifyWithScratch(GfnCloudCheckVerifier* verifier, const char* jwt, const char* nonce, unsigned int nonceSize,
+    void* scratch, size_t scratchSize)
 {
     bool result = false;
 
     size_t jwtLen = 0;
+    const char* jwtEnd = NULL;
+    const char* firstDot = NULL;
+    const char* secondDot = NULL;
 
-    size_t headerLen = 0;
-    char* header = NULL;
-
-    size_t payloadLen = 0;
-    char* payload = NULL;
-
-    size_t signatureLen = 0;
-    char* signature = NULL;
+    GfnCloudCheckArena arena = { 0 };
 
     size_t decodedHeaderLen = 0;
     unsigned char* decodedHeader = NULL;
@@ -1165,140 +989,94 @@ bool GfnCloudCheckVerifyAttestationData(const char* jwt, const char* nonce, unsi
     size_t decodedSignatureLen = 0;
     unsigned char* decodedSignature = NULL;
 
-    size_t dataLen = 0;
-    unsigned char* data = NULL;
-
-    char* x5cCerts[MAX_NUMBER_OF_X5C_CERTS] = { 0 };
+    GfnCloudCheckDerCert x5cCerts[MAX_NUMBER_OF_X5C_CERTS] = { { 0 } };
     unsigned int numX5cCerts = 0;
 
-    char* hashedData = NULL;
-    unsigned int hashedDataLen = 0;
+    unsigned char hashedData[SHA512_HASH_LEN];
 
-    char* firstDot = NULL;
-    char* secondDot = NULL;
+    PCCERT_CONTEXT pcCertContextArray[MAX_NUMBER_OF_X5C_CERTS] = { 0 };
 
-    PCCERT_CONTEXT pcCertContextArray[MAX_CERTIFICATE_CHAIN_LEN] = { 0 };
-
-    firstDot = strchr(jwt, '.');
-    if (firstDot == NULL)
+    if (jwt == NULL || nonce == NULL)
     {
-        GFN_CC_LOG("Invalid jwt format\n");
-        return false;
-    }
-
-    secondDot = strchr(firstDot + 1, '.');
-    if (secondDot == NULL)
-    {
-        GFN_CC_LOG("Invalid jwt format\n");
+        GFN_CC_LOG("Invalid parameters\n");
         return false;
     }
 
-    headerLen = firstDot - jwt;
-    header = GFN_CC_MALLOC(headerLen + 1);
-    if (header == NULL)
+    jwtLen = strlen(jwt);
+    jwtEnd = jwt + jwtLen;
+    if (scratch == NULL || scratchSize < GfnCloudCheckGetVerificationScratchSize(jwtLen))
     {
-        GFN_CC_LOG("Failed to allocate memory for header\n");
+        GFN_CC_LOG("Verification scratch buffer too small\n");
         return false;
     }
-    memcpy(header, jwt, headerLen);
-    header[headerLen] = '\0';
+    arena.base = scratch;
+    arena.size = scratchSize;
 
-    payloadLen = secondDot - (firstDot + 1);
-    payload = GFN_CC_MALLOC(payloadLen + 1);
-    if (payload == NULL)
+    firstDot = memchr(jwt, '.', jwtLen);
+    if (firstDot == NULL)
     {
-        GFN_CC_LOG("Failed to allocate memory for payload\n");
-        GFN_CC_FREE(header);
+        GFN_CC_LOG("Invalid jwt format\n");
         return false;
     }
-    memcpy(payload, firstDot + 1, payloadLen);
-    payload[payloadLen] = '\0';
 
-    jwtLen = strlen(jwt);
-    signatureLen = (jwt + jwtLen) - (secondDot + 1);
-
-    signature = GFN_CC_MALLOC(signatureLen + 1);
-    if (signature == NULL)
+    secondDot = memchr(firstDot + 1, '.', jwtEnd - (firstDot + 1));
+    if (secondDot == NULL)
     {
-        GFN_CC_LOG("Failed to allocate memory for signature\n");
-        GFN_CC_FREE(header);
-        GFN_CC_FREE(payload);
+        GFN_CC_LOG("Invalid jwt format\n");
         return false;
     }
-    memcpy(signature, secondDot+1, signatureLen);
-    signature[signatureLen] = '\0';
 
-    decodedHeaderLen = Base64UrlDecode(header, &decodedHeader);
-    if (decodedHeaderLen == 0)
+    // The segments are decoded directly out of the JWT
+    if (!Base64DecodeToArena(jwt, firstDot - jwt, GfnBase64AlphabetUrl, &arena, &decodedHeader, &decodedHeaderLen))
     {
         GFN_CC_LOG("Failed to Base64Url decode header\n");
         goto end;
     }
 
-    decodedPayloadLen = Base64UrlDecode(payload, &decodedPayload);
-    if (decodedPayloadLen == 0)
+    if (!Base64DecodeToArena(firstDot + 1, secondDot - (firstDot + 1), GfnBase64AlphabetUrl, &arena, &decodedPayload, &decodedPayloadLen))
     {
         GFN_CC_LOG("Failed to Base64Url decode payload\n");
         goto end;
     }
 
-    decodedSignatureLen = Base64UrlDecode(signature, &decodedSignature);
-    if (decodedSignatureLen == 0)
+    if (!Base64DecodeToArena(secondDot + 1, jwtEnd - (secondDot + 1), GfnBase64AlphabetUrl, &arena, &decodedSignature, &decodedSignatureLen))
     {
         GFN_CC_LOG("Failed to Base64Url decode signature\n");
         goto end;
     }
 
-    if (!ParseHeaderJson(decodedHeader, decodedHeaderLen, x5cCerts, &numX5cCerts))
+    if (!ParseHeaderJson(decodedHeader, decodedHeaderLen, &arena, x5cCerts, &numX5cCerts))
     {
         GFN_CC_LOG("Failed to parse header json\n");
         goto end;
     }
 
-    if (!ParsePayloadJson(decodedPayload, decodedPayloadLen, nonce, nonceSize))
+    if (!ParsePayloadJson(decodedPayload, decodedPayloadLen, &arena, nonce, nonceSize))
     {
         GFN_CC_LOG("Failed to parse payload json\n");
         goto end;
     }
 
-    if (!CreateCertificateContext(x5cCerts, numX5cCerts, s_RootPublicCert1, pcCertContextArray))
+    if (!CreateCertificateContext(x5cCerts, numX5cCerts, pcCertContextArray))
     {
-        GFN_CC_LOG("Failed to create certificate context from x5c and s_rootPublicCert1\n");
+        GFN_CC_LOG("Failed to create certificate context from x5c\n");
         goto end;
     }
 
-    if (!ValidateCertificateChain(pcCertContextArray))
-    {
-        GFN_CC_LOG("Failed to validate certificate chain with Public Cert 1, trying with Public Cert 2\n");
-        if (!CreateCertificateContext(x5cCerts, numX5cCerts, s_RootPublicCert2, pcCertContextArray))
-        {
-            GFN_CC_LOG("Failed to create certificate context from x5c and s_rootPublicCert2\n");
-            goto end;
-        }
-        if (!ValidateCertificateChain(pcCertContextArray))
-        {
-            GFN_CC_LOG("Failed to validate certificate chain with Public Cert 2\n");
-            goto end;
-        }        
-    }
-
-    // To create Hash of data = (payload + header), allocate and copy data from jwt
-    dataLen = secondDot - jwt;
-    data = GFN_CC_MALLOC(dataLen);
-    if (data == NULL)
+    if (!ValidateCertificateChain(verifier, pcCertContextArray, numX5cCerts))
     {
-        GFN_CC_LOG("Failed to allocate memory for data object\n");
+        GFN_CC_LOG("Failed to validate certificate chain\n");
         goto end;
     }
-    memcpy(data, jwt, dataLen);
 
-    if (!GenerateHash(data, (unsigned long)dataLen, (unsigned char**)&hashedData, (unsigned long*)&hashedDataLen))
+    // Hash of (header + "." + payload), directly from the JWT
+    if (!GenerateHash(verifier->hashAlg, (const unsigned char*)jwt, (unsigned long)(secondDot - jwt), hashedData))
     {
         GFN_CC_LOG("Failed to generate data hash\n");
         goto end;
     }
 
-    if (!VerifySignature((char*)decodedSignature, (int)decodedSignatureLen, hashedData, hashedDataLen, pcCertContextArray[0]))
+    if (!VerifySignature((char*)decodedSignature, (int)decodedSignatureLen, (char*)hashedData, SHA512_HASH_LEN, pcCertContextArray[0]))
     {
         GFN_CC_LOG("Failed to verify signature\n");
         goto end;
@@ -1309,56 +1087,693 @@ bool GfnCloudCheckVerifyAttestationData(const char* jwt, const char* nonce, unsi
     }
 
 end:
-    // Free x5c certificates
-    if (numX5cCerts > 0)
+    // Free certificate context array
+    for (int i = 0; i < MAX_NUMBER_OF_X5C_CERTS; i++)
     {
-        for (unsigned int i = 0; i < numX5cCerts; i++)
+        if (pcCertContextArray[i] != NULL)
         {
-            if (x5cCerts[i] != NULL)
-            {
-                GFN_CC_FREE(x5cCerts[i]);
-            }
+            CertFreeCertificateContext(pcCertContextArray[i]);
         }
     }
-    // Free certificate context array
-    for (int i = 0; i < MAX_CERTIFICATE_CHAIN_LEN; i++)
+    return result;
+}
+
+void GfnCloudCheckSetChainCacheTtl(unsigned int ttlSeconds)
+{
+    // Chain validation results are cached by CryptoAPI on Windows
+    (void)ttlSeconds;
+}
+
+void GfnCloudCheckClearChainCache(void)
+{
+}
+
+void GfnCloudCheckGetChainCacheStats(GfnCloudCheckChainCacheStats* stats)
+{
+    if (stats != NULL)
     {
-        if (pcCertContextArray[i] != NULL)
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+static void FreeVerifier(GfnCloudCheckVerifier* verifier)
+{
+    if (verifier->chainEngine != NULL)
+    {
+        CertFreeCertificateChainEngine(verifier->chainEngine);
+    }
+    if (verifier->rootStore != NULL)
+    {
+        CertCloseStore(verifier->rootStore, 0);
+    }
+    for (int i = 0; i < NUMBER_OF_PINNED_ROOT_CERTS; i++)
+    {
+        if (verifier->rootCerts[i] != NULL)
         {
-            CertFreeCertificateContext(pcCertContextArray[i]);
+            CertFreeCertificateContext(verifier->rootCerts[i]);
         }
     }
-    if (header != NULL)
+    if (verifier->hashAlg != NULL)
+    {
+        BCryptCloseAlgorithmProvider(verifier->hashAlg, 0);
+    }
+    GFN_CC_FREE(verifier->scratch);
+    GFN_CC_FREE(verifier);
+}
+
+GfnCloudCheckVerifier* GfnCloudCheckVerifierCreate(void)
+{
+    GfnCloudCheckVerifier* verifier = NULL;
+    CERT_CHAIN_ENGINE_CONFIG engineConfig;
+
+    verifier = (GfnCloudCheckVerifier*)GFN_CC_MALLOC(sizeof(GfnCloudCheckVerifier));
+    if (verifier == NULL)
+    {
+        GFN_CC_LOG("Failed to allocate verifier\n");
+        return NULL;
+    }
+    memset(verifier, 0, sizeof(*verifier));
+
+    if (!CreateRootCertificateContext(s_RootPublicCert1, &verifier->rootCerts[0]) ||
+        !CreateRootCertificateContext(s_RootPublicCert2, &verifier->rootCerts[1]))
+    {
+        GFN_CC_LOG("Failed to load pinned root certificates\n");
+        goto fail;
+    }
+
+    verifier->rootStore = CertOpenStore(CERT_STORE_PROV_MEMORY, 0, (HCRYPTPROV)NULL, 0, NULL);
+    if (verifier->rootStore == NULL)
+    {
+        GFN_CC_LOG("Failed to open root certificate store, error: %x\n", GetLastError());
+        goto fail;
+    }
+    for (int i = 0; i < NUMBER_OF_PINNED_ROOT_CERTS; i++)
+    {
+        if (!CertAddCertificateContextToStore(verifier->rootStore, verifier->rootCerts[i], CERT_STORE_ADD_USE_EXISTING, NULL))
+        {
+            GFN_CC_LOG("Failed to add pinned root %i to the store, error: %x\n", i, GetLastError());
+            goto fail;
+        }
+    }
+
+    // Chains are built against the pinned roots only. Exclusive roots need Windows 7 or later;
+    // without them chain building falls back to the default engine.
+    memset(&engineConfig, 0, sizeof(engineConfig));
+    engineConfig.cbSize = sizeof(engineConfig);
+    engineConfig.hExclusiveRoot = verifier->rootStore;
+    if (!CertCreateCertificateChainEngine(&engineConfig, &verifier->chainEngine))
+    {
+        GFN_CC_LOG("Failed to create exclusive root chain engine, error: %x\n", GetLastError());
+        verifier->chainEngine = NULL;
+    }
+
+    if (!BCRYPT_SUCCESS(BCryptOpenAlgorithmProvider(&verifier->hashAlg, BCRYPT_SHA512_ALGORITHM, NULL, 0)))
+    {
+        GFN_CC_LOG("Failed to open Algorithm provider, error: %x\n", GetLastError());
+        verifier->hashAlg = NULL;
+        goto fail;
+    }
+
+    return verifier;
+
+fail:
+    FreeVerifier(verifier);
+    return NULL;
+}
+
+void GfnCloudCheckVerifierDestroy(GfnCloudCheckVerifier* verifier)
+{
+    if (verifier != NULL)
+    {
+        FreeVerifier(verifier);
+    }
+}
+
+void GfnCloudCheckVerifierGetChainCacheStats(const GfnCloudCheckVerifier* verifier, GfnCloudCheckChainCacheStats* stats)
+{
+    (void)verifier;
+    if (stats != NULL)
+    {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+/*
+ * Per-thread verifiers backing GfnCloudCheckVerifyAttestationData and
+ * GfnCloudCheckVerifyAttestationDataWithScratch. They are destroyed when their thread exits.
+ */
+static INIT_ONCE s_ThreadVerifierInitOnce = INIT_ONCE_STATIC_INIT;
+static DWORD s_ThreadVerifierIndex = FLS_OUT_OF_INDEXES;
+
+static VOID NTAPI DestroyThreadVerifier(PVOID verifier)
+{
+    GfnCloudCheckVerifierDestroy((GfnCloudCheckVerifier*)verifier);
+}
+
+static BOOL CALLBACK AllocateThreadVerifierIndex(PINIT_ONCE initOnce, PVOID parameter, PVOID* context)
+{
+    (void)initOnce;
+    (void)parameter;
+    (void)context;
+    s_ThreadVerifierIndex = FlsAlloc(DestroyThreadVerifier);
+    return s_ThreadVerifierIndex != FLS_OUT_OF_INDEXES;
+}
+
+/**
+ * @brief Returns the verifier of the calling thread, creating it on first use.
+ *
+ * @return The verifier, or NULL if it could not be created.
+ */
+static GfnCloudCheckVerifier* GetThreadVerifier(void)
+{
+    GfnCloudCheckVerifier* verifier = NULL;
+
+    if (!InitOnceExecuteOnce(&s_ThreadVerifierInitOnce, AllocateThreadVerifierIndex, NULL, NULL))
+    {
+        return NULL;
+    }
+
+    verifier = (GfnCloudCheckVerifier*)FlsGetValue(s_ThreadVerifierIndex);
+    if (verifier != NULL)
+    {
+        return verifier;
+    }
+
+    verifier = GfnCloudCheckVerifierCreate();
+    if (verifier == NULL)
+    {
+        return NULL;
+    }
+    if (!FlsSetValue(s_ThreadVerifierIndex, verifier))
+    {
+        GfnCloudCheckVerifierDestroy(verifier);
+        return NULL;
+    }
+    return verifier;
+}
+
+/**
+ * @brief Grows the scratch buffer of a verifier to at least the given size.
+ *
+ * The buffer only grows, to the largest JWT verified so far.
+ *
+ * @param verifier The verifier.
+ * @param scratchSize The required scratch size in bytes.
+ *
+ * @return true if the scratch buffer is large enough, false if it could not be allocated.
+ */
+static bool ReserveVerifierScratch(GfnCloudCheckVerifier* verifier, size_t scratchSize)
+{
+    if (verifier->scratchSize >= scratchSize)
+    {
+        return true;
+    }
+    GFN_CC_FREE(verifier->scratch);
+    verifier->scratchSize = 0;
+    verifier->scratch = GFN_CC_MALLOC(scratchSize);
+    if (verifier->scratch == NULL)
+    {
+        GFN_CC_LOG("Failed to allocate verification scratch buffer\n");
+        return false;
+    }
+    verifier->scratchSize = scratchSize;
+    return true;
+}
+
+bool GfnCloudCheckVerifierVerify(GfnCloudCheckVerifier* verifier, const char* jwt, const char* nonce, unsigned int nonceSize)
+{
+    if (verifier == NULL || jwt == NULL)
+    {
+        GFN_CC_LOG("Invalid parameters\n");
+        return false;
+    }
+
+    if (!ReserveVerifierScratch(verifier, GfnCloudCheckGetVerificationScratchSize(strlen(jwt))))
+    {
+        return false;
+    }
+    return VerifyWithScratch(verifier, jwt, nonce, nonceSize, verifier->scratch, verifier->scratchSize);
+}
+
+bool GfnCloudCheckVerifyAttestationDataWithScratch(const char* jwt, const char* nonce, unsigned int nonceSize, void* scratch, size_t scratchSize)
+{
+    GfnCloudCheckVerifier* verifier = GetThreadVerifier();
+
+    if (verifier == NULL)
+    {
+        GFN_CC_LOG("Failed to create verifier\n");
+        return false;
+    }
+    return VerifyWithScratch(verifier, jwt, nonce, nonceSize, scratch, scratchSize);
+}
+
+/**
+ * @brief Validates attestation data received in CloudCheck API response represented as a JWT.
+ *
+ * Thin wrapper over GfnCloudCheckVerifierVerify, using a verifier owned by the calling thread.
+ *
+ * @param attestationData The attestation data in JWT format.
+ * @param nonce The nonce value to match with the value in the payload.
+ * @param nonceSize The size of nonce in bytes.
+ *
+ * @return true if the JWT response is valid, false otherwise.
+ */
+bool GfnCloudCheckVerifyAttestationData(const char* jwt, const char* nonce, unsigned int nonceSize)
+{
+    GfnCloudCheckVerifier* verifier = GetThreadVerifier();
+
+    if (verifier == NULL)
+    {
+        GFN_CC_LOG("Failed to create verifier\n");
+        return false;
+    }
+    return GfnCloudCheckVerifierVerify(verifier, jwt, nonce, nonceSize);
+}
+
+#define BATCH_MAX_WORKERS  64
+
+typedef struct GfnCloudCheckBatchJob
+{
+    const char* const* jwts;
+    const char* const* nonces;
+    unsigned int nonceSize;
+    bool* results;
+    size_t count;
+    volatile LONG64 nextIndex;
+} GfnCloudCheckBatchJob;
+
+/*
+ * Batches run on a private Windows thread pool. The caller submits one work callback per worker
+ * and then claims items alongside them; every thread verifies with its own per-thread verifier.
+ * s_BatchLock serializes batches, initialization and shutdown.
+ */
+static SRWLOCK s_BatchLock = SRWLOCK_INIT;
+static PTP_POOL s_BatchPool = NULL;
+static TP_CALLBACK_ENVIRON s_BatchEnvironment;
+static unsigned int s_BatchWorkers = 0;
+
+static void RunBatchItems(GfnCloudCheckBatchJob* job)
+{
+    GfnCloudCheckVerifier* verifier = GetThreadVerifier();
+
+    for (;;)
     {
-        GFN_CC_FREE(header);
+        size_t index = (size_t)(InterlockedIncrement64(&job->nextIndex) - 1);
+        if (index >= job->count)
+        {
+            break;
+        }
+        job->results[index] = verifier != NULL && job->jwts[index] != NULL && job->nonces[index] != NULL &&
+            GfnCloudCheckVerifierVerify(verifier, job->jwts[index], job->nonces[index], job->nonceSize);
     }
-    if (payload != NULL)
+}
+
+static VOID CALLBACK BatchWorkCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work)
+{
+    (void)instance;
+    (void)work;
+    RunBatchItems((GfnCloudCheckBatchJob*)context);
+}
+
+static bool StartBatchPool(unsigned int workerCount)
+{
+    if (workerCount == 0)
     {
-        GFN_CC_FREE(payload);
+        workerCount = (unsigned int)GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
     }
-    if (signature != NULL)
+    if (workerCount == 0)
     {
-        GFN_CC_FREE(signature);
+        workerCount = 1;
     }
-    if (decodedHeader != NULL)
+    if (workerCount > BATCH_MAX_WORKERS)
     {
-        GFN_CC_FREE(decodedHeader);
+        workerCount = BATCH_MAX_WORKERS;
     }
-    if (decodedPayload != NULL)
+
+    s_BatchPool = CreateThreadpool(NULL);
+    if (s_BatchPool == NULL)
     {
-        GFN_CC_FREE(decodedPayload);
+        GFN_CC_LOG("Failed to create batch thread pool, error: %x\n", GetLastError());
+        return false;
     }
-    if (decodedSignature != NULL)
+    SetThreadpoolThreadMaximum(s_BatchPool, workerCount);
+    if (!SetThreadpoolThreadMinimum(s_BatchPool, 1))
     {
-        GFN_CC_FREE(decodedSignature);
+        GFN_CC_LOG("Failed to start batch thread pool, error: %x\n", GetLastError());
+        CloseThreadpool(s_BatchPool);
+        s_BatchPool = NULL;
+        return false;
     }
-    if (hashedData != NULL)
+    InitializeThreadpoolEnvironment(&s_BatchEnvironment);
+    SetThreadpoolCallbackPool(&s_BatchEnvironment, s_BatchPool);
+    s_BatchWorkers = workerCount;
+    return true;
+}
+
+bool GfnCloudCheckInitializeBatchVerification(unsigned int workerCount)
+{
+    bool result = false;
+
+    AcquireSRWLockExclusive(&s_BatchLock);
+    if (s_BatchPool != NULL)
     {
-        GFN_CC_FREE(hashedData);
+        GFN_CC_LOG("Batch verification is already initialized\n");
     }
-    if (data != NULL)
+    else
     {
-        GFN_CC_FREE(data);
+        result = StartBatchPool(workerCount);
     }
+    ReleaseSRWLockExclusive(&s_BatchLock);
+
     return result;
 }
+
+bool GfnCloudCheckVerifyAttestationBatch(const char* const jwts[], const char* const nonces[], unsigned int nonceSize, bool results[], size_t count)
+{
+    GfnCloudCheckBatchJob job = { 0 };
+    PTP_WORK work = NULL;
+
+    if (jwts == NULL || nonces == NULL || results == NULL)
+    {
+        GFN_CC_LOG("Invalid parameters\n");
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        results[i] = false;
+    }
+    if (count == 0)
+    {
+        return true;
+    }
+
+    job.jwts = jwts;
+    job.nonces = nonces;
+    job.nonceSize = nonceSize;
+    job.results = results;
+    job.count = count;
+    job.nextIndex = 0;
+
+    // Batches submitted from several threads are run one after the other
+    AcquireSRWLockExclusive(&s_BatchLock);
+    if (s_BatchPool == NULL && !StartBatchPool(0))
+    {
+        ReleaseSRWLockExclusive(&s_BatchLock);
+        return false;
+    }
+
+    // If no work object can be created the caller verifies the whole batch by itself
+    work = CreateThreadpoolWork(BatchWorkCallback, &job, &s_BatchEnvironment);
+    if (work != NULL)
+    {
+        size_t submissions = (count - 1 < s_BatchWorkers) ? count - 1 : s_BatchWorkers;
+        for (size_t i = 0; i < submissions; ++i)
+        {
+            SubmitThreadpoolWork(work);
+        }
+    }
+    else
+    {
+        GFN_CC_LOG("Failed to create batch work, error: %x\n", GetLastError());
+    }
+
+    RunBatchItems(&job);
+
+    if (work != NULL)
+    {
+        WaitForThreadpoolWorkCallbacks(work, FALSE);
+        CloseThreadpoolWork(work);
+    }
+    ReleaseSRWLockExclusive(&s_BatchLock);
+    return true;
+}
+
+void GfnCloudCheckShutdownBatchVerification(void)
+{
+    AcquireSRWLockExclusive(&s_BatchLock);
+    if (s_BatchPool != NULL)
+    {
+        // Pool threads exit once idle; their verifiers are destroyed with them
+        DestroyThreadpoolEnvironment(&s_BatchEnvironment);
+        CloseThreadpool(s_BatchPool);
+        s_BatchPool = NULL;
+        s_BatchWorkers = 0;
+    }
+    ReleaseSRWLockExclusive(&s_BatchLock);
+}
+
+/*
+ * Asynchronous verifications are queued in FIFO order to a single background worker thread.
+ * Each request holds its own copies of the JWT and nonce and is referenced by the queue and by
+ * the caller's handle, if any; it is freed when both released it.
+ */
+struct GfnCloudCheckAsyncVerification
+{
+    GfnCloudCheckAsyncVerification* next;
+    unsigned int refCount;              // protected by s_AsyncLock
+    GfnCloudCheckAsyncStatus status;    // protected by s_AsyncLock
+    GfnCloudCheckAsyncCallback callback;
+    void* context;
+    char* jwt;
+    char* nonce;
+    unsigned int nonceSize;
+};
+
+static INIT_ONCE s_AsyncInitOnce = INIT_ONCE_STATIC_INIT;
+static CRITICAL_SECTION s_AsyncLock;
+static CONDITION_VARIABLE s_AsyncWorkAvailable = CONDITION_VARIABLE_INIT;
+static CONDITION_VARIABLE s_AsyncCompleted = CONDITION_VARIABLE_INIT;
+static HANDLE s_AsyncThread = NULL;
+static bool s_AsyncStopping = false;
+static GfnCloudCheckAsyncVerification* s_AsyncHead = NULL;
+static GfnCloudCheckAsyncVerification* s_AsyncTail = NULL;
+
+static BOOL CALLBACK InitializeAsyncLock(PINIT_ONCE initOnce, PVOID parameter, PVOID* context)
+{
+    (void)initOnce;
+    (void)parameter;
+    (void)context;
+    InitializeCriticalSection(&s_AsyncLock);
+    return TRUE;
+}
+
+static void ReleaseAsyncRequestLocked(GfnCloudCheckAsyncVerification* request)
+{
+    if (--request->refCount == 0)
+    {
+        SecureZeroMemory(request->nonce, request->nonceSize);
+        GFN_CC_FREE(request);
+    }
+}
+
+static void CompleteAsyncRequest(GfnCloudCheckAsyncVerification* request, GfnCloudCheckAsyncStatus status)
+{
+    EnterCriticalSection(&s_AsyncLock);
+    request->status = status;
+    WakeAllConditionVariable(&s_AsyncCompleted);
+    LeaveCriticalSection(&s_AsyncLock);
+
+    if (request->callback != NULL)
+    {
+        request->callback(status, request->context);
+    }
+
+    EnterCriticalSection(&s_AsyncLock);
+    ReleaseAsyncRequestLocked(request);
+    LeaveCriticalSection(&s_AsyncLock);
+}
+
+static DWORD WINAPI AsyncVerificationWorkerMain(LPVOID parameter)
+{
+    (void)parameter;
+    EnterCriticalSection(&s_AsyncLock);
+    for (;;)
+    {
+        GfnCloudCheckAsyncVerification* request = NULL;
+        bool valid = false;
+
+        while (!s_AsyncStopping && s_AsyncHead == NULL)
+        {
+            SleepConditionVariableCS(&s_AsyncWorkAvailable, &s_AsyncLock, INFINITE);
+        }
+        if (s_AsyncStopping)
+        {
+            break;
+        }
+        request = s_AsyncHead;
+        s_AsyncHead = request->next;
+        if (s_AsyncHead == NULL)
+        {
+            s_AsyncTail = NULL;
+        }
+        LeaveCriticalSection(&s_AsyncLock);
+
+        valid = GfnCloudCheckVerifyAttestationData(request->jwt, request->nonce, request->nonceSize);
+        CompleteAsyncRequest(request, valid ? GfnCloudCheckAsyncValid : GfnCloudCheckAsyncInvalid);
+
+        EnterCriticalSection(&s_AsyncLock);
+    }
+    LeaveCriticalSection(&s_AsyncLock);
+    return 0;
+}
+
+bool GfnCloudCheckVerifyAttestationDataAsync(const char* jwt, const char* nonce, unsigned int nonceSize,
+    GfnCloudCheckAsyncCallback callback, void* context, GfnCloudCheckAsyncVerification** handle)
+{
+    GfnCloudCheckAsyncVerification* request = NULL;
+    size_t jwtLen = 0;
+
+    if (handle != NULL)
+    {
+        *handle = NULL;
+    }
+    if (jwt == NULL || nonce == NULL || (callback == NULL && handle == NULL))
+    {
+        GFN_CC_LOG("Invalid parameters\n");
+        return false;
+    }
+    InitOnceExecuteOnce(&s_AsyncInitOnce, InitializeAsyncLock, NULL, NULL);
+
+    // The request, the JWT and the nonce share one allocation
+    jwtLen = strlen(jwt);
+    request = (GfnCloudCheckAsyncVerification*)GFN_CC_MALLOC(sizeof(GfnCloudCheckAsyncVerification) + jwtLen + 1 + nonceSize);
+    if (request == NULL)
+    {
+        GFN_CC_LOG("Failed to allocate asynchronous verification\n");
+        return false;
+    }
+    memset(request, 0, sizeof(*request));
+    request->jwt = (char*)(request + 1);
+    memcpy(request->jwt, jwt, jwtLen + 1);
+    request->nonce = request->jwt + jwtLen + 1;
+    memcpy(request->nonce, nonce, nonceSize);
+    request->nonceSize = nonceSize;
+    request->callback = callback;
+    request->context = context;
+    request->status = GfnCloudCheckAsyncPending;
+    request->refCount = (handle != NULL) ? 2 : 1;
+
+    EnterCriticalSection(&s_AsyncLock);
+    if (s_AsyncStopping)
+    {
+        LeaveCriticalSection(&s_AsyncLock);
+        GFN_CC_LOG("Asynchronous verification is shutting down\n");
+        GFN_CC_FREE(request);
+        return false;
+    }
+    if (s_AsyncThread == NULL)
+    {
+        s_AsyncThread = CreateThread(NULL, 0, AsyncVerificationWorkerMain, NULL, 0, NULL);
+        if (s_AsyncThread == NULL)
+        {
+            LeaveCriticalSection(&s_AsyncLock);
+            GFN_CC_LOG("Failed to start asynchronous verification worker\n");
+            GFN_CC_FREE(request);
+            return false;
+        }
+    }
+    if (s_AsyncTail != NULL)
+    {
+        s_AsyncTail->next = request;
+    }
+    else
+    {
+        s_AsyncHead = request;
+    }
+    s_AsyncTail = request;
+    WakeConditionVariable(&s_AsyncWorkAvailable);
+    LeaveCriticalSection(&s_AsyncLock);
+
+    if (handle != NULL)
+    {
+        *handle = request;
+    }
+    return true;
+}
+
+GfnCloudCheckAsyncStatus GfnCloudCheckPollAsyncVerification(GfnCloudCheckAsyncVerification* handle)
+{
+    GfnCloudCheckAsyncStatus status = GfnCloudCheckAsyncInvalid;
+
+    if (handle == NULL)
+    {
+        return status;
+    }
+    EnterCriticalSection(&s_AsyncLock);
+    status = handle->status;
+    LeaveCriticalSection(&s_AsyncLock);
+    return status;
+}
+
+GfnCloudCheckAsyncStatus GfnCloudCheckWaitAsyncVerification(GfnCloudCheckAsyncVerification* handle, unsigned int timeoutMs)
+{
+    GfnCloudCheckAsyncStatus status = GfnCloudCheckAsyncInvalid;
+    ULONGLONG deadline = 0;
+
+    if (handle == NULL)
+    {
+        return status;
+    }
+    deadline = GetTickCount64() + timeoutMs;
+
+    EnterCriticalSection(&s_AsyncLock);
+    while (handle->status == GfnCloudCheckAsyncPending)
+    {
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline ||
+            !SleepConditionVariableCS(&s_AsyncCompleted, &s_AsyncLock, (DWORD)(deadline - now)))
+        {
+            break;
+        }
+    }
+    status = handle->status;
+    LeaveCriticalSection(&s_AsyncLock);
+    return status;
+}
+
+void GfnCloudCheckReleaseAsyncVerification(GfnCloudCheckAsyncVerification* handle)
+{
+    if (handle == NULL)
+    {
+        return;
+    }
+    EnterCriticalSection(&s_AsyncLock);
+    ReleaseAsyncRequestLocked(handle);
+    LeaveCriticalSection(&s_AsyncLock);
+}
+
+void GfnCloudCheckShutdownAsyncVerification(void)
+{
+    GfnCloudCheckAsyncVerification* canceled = NULL;
+    HANDLE thread = NULL;
+
+    InitOnceExecuteOnce(&s_AsyncInitOnce, InitializeAsyncLock, NULL, NULL);
+
+    EnterCriticalSection(&s_AsyncLock);
+    thread = s_AsyncThread;
+    canceled = s_AsyncHead;
+    s_AsyncHead = NULL;
+    s_AsyncTail = NULL;
+    s_AsyncStopping = true;
+    WakeAllConditionVariable(&s_AsyncWorkAvailable);
+    LeaveCriticalSection(&s_AsyncLock);
+
+    // The verification in progress, if any, completes normally
+    if (thread != NULL)
+    {
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+    }
+
+    while (canceled != NULL)
+    {
+        GfnCloudCheckAsyncVerification* next = canceled->next;
+        CompleteAsyncRequest(canceled, GfnCloudCheckAsyncCanceled);
+        canceled = next;
+    }
+
+    EnterCriticalSection(&s_AsyncLock);
+    s_AsyncThread = NULL;
+    s_AsyncStopping = false;
+    LeaveCriticalSection(&s_AsyncLock);
+}
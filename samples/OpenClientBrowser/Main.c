@@ -31,6 +31,7 @@
 
 // Sample will use the Helper Wrapper sources to auto-manage SDK library handling
 #include "GfnRuntimeSdk_Wrapper.h"
+#include "GfnSdk_OpenUrlScheduler.h"
 
 // Max url on most browsers is 2048, so max encoded string + null character is 2733
 #define MAX_URL_LEN_WITH_NULL 2048
@@ -86,7 +87,7 @@ static char waitForInput()
     do
     {
         c = getKeyPress();
-    } while (c != ' ' && (c < '1' || c > '7'));
+    } while (c != ' ' && (c < '1' || c > '8'));
     return c;
 }
 
@@ -348,6 +349,47 @@ void DoStressTest(const char* url)
     }
 }
 
+// Completion callback for URLs sent through the client-side scheduler. This is called on the
+// scheduler thread, so only print to the console here.
+static void GFN_CALLBACK OnScheduledUrlComplete(GfnRuntimeError result, const char* url, void* context)
+{
+    printf("Scheduled request %d for %s completed with %d(%s)\n", (int)(size_t)context, url, result, GfnErrorToString(result));
+}
+
+// Same burst as DoStressTest, but sent through the client-side scheduler in GfnSdk_OpenUrlScheduler.h.
+// Nothing is throttled: the scheduler holds requests back until the rate limits allow them, and
+// collapses duplicate URLs that are still waiting in the queue.
+void DoScheduledStressTest(void)
+{
+    char url[128];
+    char buffer[256];
+    GfnError result;
+    unsigned int queued;
+
+    for (int i = 0; i < 10; i++)
+    {
+        // Every other request repeats the previous URL, and will be collapsed if it is still queued
+        sprintf(url, "https://www.nvidia.com/en-us/geforce-now/?request=%d", i / 2);
+        result = GfnOpenURLOnClientScheduled(url, OnScheduledUrlComplete, (void*)(size_t)i);
+        if (result != gfnSuccess)
+        {
+            sprintf(buffer, "Unexpected error %%d(%%s) received when queuing request %d", i);
+            ShowError(buffer, result, false);
+        }
+    }
+    // Requests the server would reject are failed locally without spending any tokens
+    result = GfnOpenURLOnClientScheduled("https://www.nvidia.com/\">< ^`{|", OnScheduledUrlComplete, NULL);
+    ShowError("URL with invalid characters was rejected locally with %d(%s).", result, false);
+
+    while ((queued = GfnOpenUrlSchedulerGetQueuedCount()) > 0)
+    {
+        sprintf(buffer, "%u URL requests waiting for the rate limit...", queued);
+        ShowStatus(buffer, false);
+        DoSleep(1);
+    }
+    ShowStatus("All scheduled URL requests were sent.", false);
+}
+
 void DisplayPrompt()
 {
     ShowText(" ");
@@ -358,6 +400,7 @@ void DisplayPrompt()
     ShowText("Press 5 to attempt to send a NULL URL");
     ShowText("Press 6 to attempt to send a URL with invalid characters");
     ShowText("Press 7 to send TOO MANY URLs in a short timeframe");
+    ShowText("Press 8 to send the same burst of URLs through the client-side scheduler");
     ShowText(" ");
     ShowText("Press space bar to exit...");
 
@@ -391,6 +434,12 @@ int main()
     }
     else
     {
+        result = GfnOpenUrlSchedulerInitialize();
+        if (GFNSDK_FAILED(result))
+        {
+            ShowError("Unable to start the Open URL scheduler: %d(%s)", result, false);
+        }
+
         char c;
         do {
 #if __linux__
@@ -437,10 +486,16 @@ int main()
             case '7':
                 DoStressTest("https://www.nvidia.com/en-us/geforce-now/");
                 break;
+            case '8':
+                DoScheduledStressTest();
+                break;
             default:
                 break;
             }
         } while (c != ' ');
+
+        // Requests still waiting for the rate limit are completed with gfnCanceled
+        GfnOpenUrlSchedulerShutdown();
     }
 
     // GFN SDK Shutdown. It's safe to call ShutdownSDK even if the SDK was not initialized.
@@ -25,10 +25,15 @@
 //
 // Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
 
+#include <limits.h>
 #include <stdio.h>
+#include <string.h>
 
 // Sample will use the Helper Wrapper sources to auto-manage SDK library handling
 #include "GfnRuntimeSdk_Wrapper.h"
+#include "GfnSdk_PreloadPipeline.h"
+#include "GfnSdk_PreloadSnapshot.h"
+#include "GfnSdk_Threading.h"
 
 #ifdef _WIN32
 #   include <conio.h>
@@ -137,26 +142,187 @@ bool BasicCloudCheck()
     return bIsCloudEnvironment;
 }
 
-GfnApplicationCallbackResult GFN_CALLBACK SessionInit(const char* params, void* pContext)
+// Application data loaded by the preload pipeline. The loads are simulated with a sleep; a real
+// application would read, parse or decompress its data, or upload it to the GPU, in LoadAsset.
+typedef struct SampleAsset
+{
+    const char* name;
+    GfnPreloadStage stage;      // Common data loads during pre-warm, user data once a user connects
+    bool critical;              // Needed before the first frame can be shown to the user
+    int priority;               // User data with a higher priority loads first
+    unsigned int loadMs;        // Simulated load time
+    int dependencies[2];        // Indexes of earlier assets that must be loaded first, -1 for none
+} SampleAsset;
+
+static SampleAsset s_assets[] =
+{
+    { "config",             GfnPreloadStageCommon,  true,   0,  20,     { -1, -1 } },
+    { "shaders",            GfnPreloadStageCommon,  true,   0,  400,    { 0, -1 } },
+    { "textures",           GfnPreloadStageCommon,  true,   0,  600,    { 0, -1 } },
+    { "audio banks",        GfnPreloadStageCommon,  false,  0,  300,    { 0, -1 } },
+    { "level geometry",     GfnPreloadStageCommon,  true,   0,  500,    { 0, -1 } },
+    { "navigation mesh",    GfnPreloadStageCommon,  false,  0,  250,    { 4, -1 } },
+    { "user profile",       GfnPreloadStageUser,    true,   10, 150,    { -1, -1 } },
+    { "save game",          GfnPreloadStageUser,    true,   5,  300,    { 6, 4 } },
+    { "user settings",      GfnPreloadStageUser,    true,   5,  50,     { 6, -1 } },
+    { "friends list",       GfnPreloadStageUser,    false,  0,  400,    { 6, -1 } },
+};
+
+#define SAMPLE_ASSET_COUNT (sizeof(s_assets) / sizeof(s_assets[0]))
+
+// Common data prepared by an earlier pre-warm. Change the build id whenever the application or
+// the layout of its prepared data changes, so that older snapshots are ignored.
+#define SAMPLE_SNAPSHOT_PATH "GfnPreWarmSample.snapshot"
+#define SAMPLE_SNAPSHOT_BUILD_ID 1
+
+static GfnPreloadSnapshot* s_snapshot = NULL;               // Set if an earlier pre-warm left a valid snapshot
+static GfnPreloadSnapshotWriter* s_snapshotWriter = NULL;   // Otherwise collects the common data to save
+
+// Runs on a preload pipeline worker thread, in parallel with other loads
+static GfnRuntimeError GFN_CALLBACK LoadAsset(const char* sessionParams, void* pContext)
+{
+    SampleAsset* asset = (SampleAsset*)pContext;
+    GfnPreloadTaskId id = (GfnPreloadTaskId)(asset - s_assets);
+    const void* prepared = NULL;
+    if (asset->stage == GfnPreloadStageCommon && s_snapshot != NULL
+        && GfnPreloadSnapshotFindSection(s_snapshot, id, &prepared, NULL) == gfnSuccess)
+    {
+        // Use the prepared data in place, straight from the read-only mapping
+        printf("Mapped %s from the snapshot\n", asset->name);
+        return gfnSuccess;
+    }
+
+    if (sessionParams != NULL)
+    {
+        printf("Loading %s for session: %s\n", asset->name, sessionParams);
+    }
+    else
+    {
+        printf("Loading %s...\n", asset->name);
+    }
+    gfnSdkSleepMs(asset->loadMs);
+
+    // A real application adds the data it prepared, using offsets rather than pointers
+    if (asset->stage == GfnPreloadStageCommon && s_snapshotWriter != NULL)
+    {
+        return GfnPreloadSnapshotWriterAddSection(s_snapshotWriter, id, asset->name, strlen(asset->name) + 1);
+    }
+    return gfnSuccess;
+}
+
+// Maps the common data prepared by an earlier pre-warm, or sets up saving it for the next one
+static void OpenSnapshot()
+{
+    GfnPreloadSnapshotInfo info;
+    GfnError result = GfnPreloadSnapshotOpen(SAMPLE_SNAPSHOT_PATH, SAMPLE_SNAPSHOT_BUILD_ID, &s_snapshot);
+    if (result == gfnSuccess && GfnPreloadSnapshotGetInfo(s_snapshot, &info) == gfnSuccess)
+    {
+        printf("Mapped the pre-warm snapshot: %u sections, %llu bytes, validated in %llu ms\n", info.numSections,
+            (unsigned long long)info.fileSize, (unsigned long long)info.openMs);
+        return;
+    }
+    printf("No usable pre-warm snapshot (%d, %s), preparing the common data\n", result, GfnErrorToString(result));
+    if (GfnPreloadSnapshotWriterCreate(&s_snapshotWriter) != gfnSuccess)
+    {
+        s_snapshotWriter = NULL;
+    }
+}
+
+// Saves the common data for later pre-warms, once the common stage finished. An incomplete
+// common stage is not saved, so the next pre-warm prepares everything again.
+static void SaveSnapshot()
+{
+    GfnPreloadPipelineStats stats;
+    GfnError result = gfnSuccess;
+    if (s_snapshotWriter == NULL || GfnPreloadPipelineGetStats(&stats) != gfnSuccess
+        || stats.stages[GfnPreloadStageCommon].numSucceeded != stats.stages[GfnPreloadStageCommon].numTasks)
+    {
+        return;
+    }
+    result = GfnPreloadSnapshotWriterSave(s_snapshotWriter, SAMPLE_SNAPSHOT_PATH, SAMPLE_SNAPSHOT_BUILD_ID);
+    if (result != gfnSuccess)
+    {
+        printf("Failed to save the pre-warm snapshot: %d, %s\n", result, GfnErrorToString(result));
+    }
+    GfnPreloadSnapshotWriterDestroy(s_snapshotWriter);
+    s_snapshotWriter = NULL;
+}
+
+// Called by the preload pipeline once it reported ready to GeForce NOW, which is required within
+// 30 seconds of SessionInit. Non-critical and deferred user data keeps loading in the background.
+static void GFN_CALLBACK OnAppReady(bool success, const GfnPreloadPipelineStats* pStats, void* pContext)
 {
     (void)pContext;
-    // Callback for when GeForce NOW a user connects to the game seat to start a streaming session.
-    // Since a user is connected, now user data can be loaded
-    // Respond within 30 seconds with a call to gfnAppReady API
-    printf("SessionInit: %s\n", params);
-    printf("Loading user data now...\n");
-    // Report that the loading was successful and application is ready for streaming to begin
-    GfnError result = GfnAppReady(true, "All Good!");
-    if (result == gfnSuccess)
+    if (pStats->readyResult == gfnSuccess)
     {
-        printf("Reported 'AppReady' with success to the SDK.\n");
+        printf("Reported 'AppReady' %s to the SDK, %llu ms after SessionInit.\n", success ? "with success" : "with failure",
+            (unsigned long long)pStats->timeToReadyMs);
+        if (pStats->readyAtDeadline)
+        {
+            printf("The ready deadline was reached with %u critical loads pending.\n", pStats->numCriticalPending);
+        }
+        printf("%u loads were deferred until after ready.\n", pStats->numDeferred);
     }
     else
     {
-        printf("Failed to report 'AppReady' to the SDK: %d, %s\n", result, GfnErrorToString(result));
+        printf("Failed to report 'AppReady' to the SDK: %d, %s\n", pStats->readyResult, GfnErrorToString(pStats->readyResult));
+    }
+}
+
+static void PrintStageTiming(const char* name, GfnPreloadStage stage)
+{
+    GfnPreloadPipelineStats stats;
+    const GfnPreloadStageStats* pStage = &stats.stages[stage];
+    if (GfnPreloadPipelineGetStats(&stats) != gfnSuccess)
+    {
+        return;
     }
+    printf("%s stage: %u tasks (%u failed, %u skipped) in %llu ms, %llu ms of loading on %u threads, %u steals\n",
+        name, pStage->numTasks, pStage->numFailed, pStage->numSkipped, (unsigned long long)pStage->wallMs,
+        (unsigned long long)pStage->taskMs, stats.numThreads, stats.numSteals);
+}
+
+// Adds the application data to the preload pipeline and starts loading the common data.
+// The pipeline registers the SessionInit callback, loads the user data once it arrives,
+// and calls GfnAppReady as soon as all critical data is loaded, or once the ready deadline
+// comes close, whichever happens first.
+static bool StartPreload()
+{
+    GfnPreloadPipelineConfig config = { 0 };
+    config.readyCallback = OnAppReady;
+
+    OpenSnapshot();
 
-    return crCallbackSuccess;
+    GfnError result = GfnPreloadPipelineInitialize(&config);
+    for (unsigned int i = 0; i < SAMPLE_ASSET_COUNT && result == gfnSuccess; i++)
+    {
+        GfnPreloadTaskId dependencies[2];
+        GfnPreloadTaskDesc task = { 0 };
+        task.pchName = s_assets[i].name;
+        task.stage = s_assets[i].stage;
+        task.critical = s_assets[i].critical;
+        task.priority = s_assets[i].priority;
+        task.estimatedMs = s_assets[i].loadMs;
+        task.run = LoadAsset;
+        task.pUserContext = &s_assets[i];
+        task.pDependencies = dependencies;
+        // Task ids are assigned in order, so asset indexes double as ids
+        for (unsigned int d = 0; d < 2 && s_assets[i].dependencies[d] >= 0; d++)
+        {
+            dependencies[task.numDependencies++] = (GfnPreloadTaskId)s_assets[i].dependencies[d];
+        }
+        result = GfnPreloadAddTask(&task, NULL);
+    }
+    if (result == gfnSuccess)
+    {
+        result = GfnPreloadPipelineStart();
+    }
+    if (result != gfnSuccess)
+    {
+        printf("Error starting the preload pipeline: %d, %s\n", result, GfnErrorToString(result));
+        return false;
+    }
+    return true;
 }
 
 // Example application main
@@ -187,18 +353,25 @@ int main()
         // seen by the user when they connect to the system via streaming session.
         // No user data should be loaded at this time as no user is connected to the system.
         printf("Loading common (non-user) data now...\n");
-        
-        // Once loading is done, signal to GFN that the application is ready for a user session
-        GfnError result = GfnRegisterSessionInitCallback(SessionInit, NULL);
-        if (result != gfnSuccess)
+        if (StartPreload())
         {
-            printf("Error registering SessionInit callback: %d, %s\n", result, GfnErrorToString(result));
+            GfnPreloadPipelineWait(GfnPreloadStageCommon, UINT_MAX);
+            PrintStageTiming("Common", GfnPreloadStageCommon);
+            SaveSnapshot();
+
+            // User data loads once a user connects and SessionInit arrives
+            printf("Waiting for a user to connect...\n");
+            GfnPreloadPipelineWait(GfnPreloadStageUser, UINT_MAX);
+            PrintStageTiming("User", GfnPreloadStageUser);
         }
     }
 
     // Application shutdown requires calling GFN SDK Shutdown first.
     // It's safe to call ShutdownSDK even if the SDK was not initialized.
     SDKShutdown();
+    GfnPreloadPipelineShutdown();
+    GfnPreloadSnapshotWriterDestroy(s_snapshotWriter);
+    GfnPreloadSnapshotClose(s_snapshot);
 
     // Ready for application exit based on Spacebar press.
     waitForSpaceBar();
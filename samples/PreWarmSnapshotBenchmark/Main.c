@@ -0,0 +1,613 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+// Offline benchmark of the pre-warm snapshot in GfnSdk_PreloadSnapshot. It prepares a set of
+// common data through the preload pipeline from scratch and writes it to a snapshot, then
+// compares the common stage time against later pre-warms that map the snapshot instead,
+// including the fallback when the snapshot is stale, damaged or missing.
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#ifndef _WIN32
+#   include <time.h>
+#endif
+
+#include "GfnSdk_PreloadPipeline.h"
+#include "GfnSdk_PreloadSnapshot.h"
+#include "GfnSdk_Threading.h"
+
+#define BENCHMARK_DEFAULT_PATH "PreWarmSnapshotBenchmark.snapshot"
+#define BENCHMARK_BUILD_ID 0x0001000000000001ULL
+#define BENCHMARK_THREADS 4
+#define BENCHMARK_WARM_RUNS 5
+#define BENCHMARK_CONFIG_ENTRIES 200000
+#define BENCHMARK_LOOKUP_SIZE (1 << 20)
+#define BENCHMARK_TERRAIN_SIZE 1024
+#define BENCHMARK_TERRAIN_OCTAVES 6
+#define BENCHMARK_INDEX_CAPACITY (1 << 19)
+#define BENCHMARK_QUERIES 10000
+
+// Section ids of the common data
+enum
+{
+    SECTION_CONFIG = 1,
+    SECTION_LOOKUP,
+    SECTION_TERRAIN,
+    SECTION_INDEX,
+    SECTION_COUNT
+};
+
+// Parsed configuration: a header, the entries sorted by key, then the key strings. References
+// are offsets from the start of the section, so the section can be used from any mapping.
+typedef struct ConfigHeader
+{
+    uint32_t numEntries;
+    uint32_t entriesOffset;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+} ConfigHeader;
+
+typedef struct ConfigEntry
+{
+    uint32_t keyOffset;
+    uint32_t keyLength;
+    int32_t value;
+    uint32_t reserved;
+} ConfigEntry;
+
+// Key index over the configuration: the capacity, then open-addressing slots holding an entry
+// index plus one, 0 for empty
+typedef struct IndexHeader
+{
+    uint32_t capacity;
+    uint32_t reserved;
+} IndexHeader;
+
+typedef struct ParsedEntry
+{
+    const char* key;
+    uint32_t keyLength;
+    int32_t value;
+} ParsedEntry;
+
+// Common data of one pre-warm, each section either prepared or mapped from the snapshot
+typedef struct CommonData
+{
+    const void* sections[SECTION_COUNT];
+    size_t sizes[SECTION_COUNT];
+    void* owned[SECTION_COUNT];
+    GfnPreloadSnapshot* snapshot;       // Source of the data, NULL to prepare it
+    GfnPreloadSnapshotWriter* writer;   // Receives the prepared data, NULL to not save it
+} CommonData;
+
+static uint64_t getTimeUs(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart * 1000000
+        + counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+#endif
+}
+
+static uint32_t hashBytes(const void* data, size_t length)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint32_t hash = 2166136261u;
+    size_t i = 0;
+    for (i = 0; i < length; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hashInt(uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x7feb352dU;
+    value ^= value >> 15;
+    value *= 0x846ca68bU;
+    value ^= value >> 16;
+    return value;
+}
+
+// Maps the section from the snapshot, returns false if it must be prepared
+static bool mapSection(CommonData* data, uint32_t id)
+{
+    return data->snapshot != NULL
+        && GfnPreloadSnapshotFindSection(data->snapshot, id, &data->sections[id], &data->sizes[id]) == gfnSuccess;
+}
+
+// Keeps a prepared section, and adds it to the snapshot being written
+static GfnRuntimeError finishSection(CommonData* data, uint32_t id, void* section, size_t size)
+{
+    data->owned[id] = section;
+    data->sections[id] = section;
+    data->sizes[id] = size;
+    if (data->writer != NULL)
+    {
+        return GfnPreloadSnapshotWriterAddSection(data->writer, id, section, size);
+    }
+    return gfnSuccess;
+}
+
+static int compareParsedEntries(const void* a, const void* b)
+{
+    const ParsedEntry* left = (const ParsedEntry*)a;
+    const ParsedEntry* right = (const ParsedEntry*)b;
+    uint32_t length = left->keyLength < right->keyLength ? left->keyLength : right->keyLength;
+    int result = memcmp(left->key, right->key, length);
+    if (result != 0)
+    {
+        return result;
+    }
+    return (left->keyLength > right->keyLength) - (left->keyLength < right->keyLength);
+}
+
+// Generates a configuration file in text form, parses it and sorts the settings by key
+static GfnRuntimeError GFN_CALLBACK prepareConfig(const char* sessionParams, void* context)
+{
+    CommonData* data = (CommonData*)context;
+    (void)sessionParams;
+    if (mapSection(data, SECTION_CONFIG))
+    {
+        return gfnSuccess;
+    }
+
+    size_t textCapacity = (size_t)BENCHMARK_CONFIG_ENTRIES * 48;
+    char* text = (char*)malloc(textCapacity);
+    ParsedEntry* entries = (ParsedEntry*)malloc(BENCHMARK_CONFIG_ENTRIES * sizeof(ParsedEntry));
+    if (text == NULL || entries == NULL)
+    {
+        free(text);
+        free(entries);
+        return gfnUnableToAllocateMemory;
+    }
+    size_t textLength = 0;
+    for (uint32_t i = 0; i < BENCHMARK_CONFIG_ENTRIES; i++)
+    {
+        // 7919 is coprime with the entry count, so every key appears once, out of order
+        uint32_t key = (uint32_t)(((uint64_t)i * 7919) % BENCHMARK_CONFIG_ENTRIES);
+        textLength += (size_t)snprintf(text + textLength, textCapacity - textLength, "group%03u.setting%06u = %d\n",
+            key % 1000, key, (int)(hashInt(key) & 0xffff));
+    }
+
+    uint32_t numEntries = 0;
+    size_t stringsSize = 0;
+    const char* line = text;
+    const char* end = text + textLength;
+    while (line < end && numEntries < BENCHMARK_CONFIG_ENTRIES)
+    {
+        const char* lineEnd = (const char*)memchr(line, '\n', (size_t)(end - line));
+        const char* separator = NULL;
+        if (lineEnd == NULL)
+        {
+            lineEnd = end;
+        }
+        for (separator = line; separator < lineEnd && *separator != '='; separator++)
+        {
+        }
+        if (separator < lineEnd)
+        {
+            const char* keyEnd = separator;
+            while (keyEnd > line && keyEnd[-1] == ' ')
+            {
+                keyEnd--;
+            }
+            entries[numEntries].key = line;
+            entries[numEntries].keyLength = (uint32_t)(keyEnd - line);
+            entries[numEntries].value = (int32_t)strtol(separator + 1, NULL, 10);
+            stringsSize += entries[numEntries].keyLength;
+            numEntries++;
+        }
+        line = lineEnd + 1;
+    }
+    qsort(entries, numEntries, sizeof(ParsedEntry), compareParsedEntries);
+
+    size_t size = sizeof(ConfigHeader) + numEntries * sizeof(ConfigEntry) + stringsSize;
+    unsigned char* section = (unsigned char*)malloc(size);
+    if (section == NULL)
+    {
+        free(text);
+        free(entries);
+        return gfnUnableToAllocateMemory;
+    }
+    ConfigHeader* header = (ConfigHeader*)section;
+    ConfigEntry* outEntries = (ConfigEntry*)(section + sizeof(ConfigHeader));
+    header->numEntries = numEntries;
+    header->entriesOffset = sizeof(ConfigHeader);
+    header->stringsOffset = (uint32_t)(sizeof(ConfigHeader) + numEntries * sizeof(ConfigEntry));
+    header->stringsSize = (uint32_t)stringsSize;
+    uint32_t stringOffset = header->stringsOffset;
+    for (uint32_t i = 0; i < numEntries; i++)
+    {
+        memcpy(section + stringOffset, entries[i].key, entries[i].keyLength);
+        outEntries[i].keyOffset = stringOffset;
+        outEntries[i].keyLength = entries[i].keyLength;
+        outEntries[i].value = entries[i].value;
+        outEntries[i].reserved = 0;
+        stringOffset += entries[i].keyLength;
+    }
+    free(text);
+    free(entries);
+    return finishSection(data, SECTION_CONFIG, section, size);
+}
+
+// Bakes a lookup table of an expensive function
+static GfnRuntimeError GFN_CALLBACK prepareLookup(const char* sessionParams, void* context)
+{
+    CommonData* data = (CommonData*)context;
+    (void)sessionParams;
+    if (mapSection(data, SECTION_LOOKUP))
+    {
+        return gfnSuccess;
+    }
+
+    float* table = (float*)malloc(BENCHMARK_LOOKUP_SIZE * sizeof(float));
+    if (table == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    for (uint32_t i = 0; i < BENCHMARK_LOOKUP_SIZE; i++)
+    {
+        float x = (float)i / BENCHMARK_LOOKUP_SIZE;
+        table[i] = expf(sinf(x * 20.0f)) * cosf(x * 7.0f) + sqrtf(x);
+    }
+    return finishSection(data, SECTION_LOOKUP, table, BENCHMARK_LOOKUP_SIZE * sizeof(float));
+}
+
+static float latticeValue(uint32_t x, uint32_t y, uint32_t octave)
+{
+    return (float)(hashInt(x * 73856093u ^ y * 19349663u ^ octave * 83492791u) & 0xffff) / 65535.0f;
+}
+
+// Generates a terrain height map from several octaves of value noise
+static GfnRuntimeError GFN_CALLBACK prepareTerrain(const char* sessionParams, void* context)
+{
+    CommonData* data = (CommonData*)context;
+    (void)sessionParams;
+    if (mapSection(data, SECTION_TERRAIN))
+    {
+        return gfnSuccess;
+    }
+
+    size_t size = (size_t)BENCHMARK_TERRAIN_SIZE * BENCHMARK_TERRAIN_SIZE * sizeof(float);
+    float* heights = (float*)malloc(size);
+    if (heights == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    for (uint32_t y = 0; y < BENCHMARK_TERRAIN_SIZE; y++)
+    {
+        for (uint32_t x = 0; x < BENCHMARK_TERRAIN_SIZE; x++)
+        {
+            float height = 0.0f;
+            float amplitude = 1.0f;
+            for (uint32_t octave = 0; octave < BENCHMARK_TERRAIN_OCTAVES; octave++)
+            {
+                float scale = (float)(4u << octave) / BENCHMARK_TERRAIN_SIZE;
+                float fx = x * scale;
+                float fy = y * scale;
+                uint32_t x0 = (uint32_t)fx;
+                uint32_t y0 = (uint32_t)fy;
+                float tx = fx - x0;
+                float ty = fy - y0;
+                tx = tx * tx * (3.0f - 2.0f * tx);
+                ty = ty * ty * (3.0f - 2.0f * ty);
+                float top = latticeValue(x0, y0, octave) * (1.0f - tx) + latticeValue(x0 + 1, y0, octave) * tx;
+                float bottom = latticeValue(x0, y0 + 1, octave) * (1.0f - tx) + latticeValue(x0 + 1, y0 + 1, octave) * tx;
+                height += amplitude * (top * (1.0f - ty) + bottom * ty);
+                amplitude *= 0.5f;
+            }
+            heights[y * BENCHMARK_TERRAIN_SIZE + x] = height;
+        }
+    }
+    return finishSection(data, SECTION_TERRAIN, heights, size);
+}
+
+// Builds the key index over the configuration, which it depends on
+static GfnRuntimeError GFN_CALLBACK prepareIndex(const char* sessionParams, void* context)
+{
+    CommonData* data = (CommonData*)context;
+    (void)sessionParams;
+    if (mapSection(data, SECTION_INDEX))
+    {
+        return gfnSuccess;
+    }
+
+    const unsigned char* config = (const unsigned char*)data->sections[SECTION_CONFIG];
+    const ConfigHeader* configHeader = (const ConfigHeader*)config;
+    const ConfigEntry* entries = (const ConfigEntry*)(config + configHeader->entriesOffset);
+    size_t size = sizeof(IndexHeader) + BENCHMARK_INDEX_CAPACITY * sizeof(uint32_t);
+    unsigned char* section = (unsigned char*)calloc(1, size);
+    if (section == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    IndexHeader* header = (IndexHeader*)section;
+    uint32_t* slots = (uint32_t*)(section + sizeof(IndexHeader));
+    header->capacity = BENCHMARK_INDEX_CAPACITY;
+    for (uint32_t i = 0; i < configHeader->numEntries; i++)
+    {
+        uint32_t slot = hashBytes(config + entries[i].keyOffset, entries[i].keyLength) & (BENCHMARK_INDEX_CAPACITY - 1);
+        while (slots[slot] != 0)
+        {
+            slot = (slot + 1) & (BENCHMARK_INDEX_CAPACITY - 1);
+        }
+        slots[slot] = i + 1;
+    }
+    return finishSection(data, SECTION_INDEX, section, size);
+}
+
+// Looks up a setting the way the application would, through the index
+static bool findSetting(const CommonData* data, const char* key, int32_t* value)
+{
+    const unsigned char* config = (const unsigned char*)data->sections[SECTION_CONFIG];
+    const ConfigHeader* configHeader = (const ConfigHeader*)config;
+    const ConfigEntry* entries = (const ConfigEntry*)(config + configHeader->entriesOffset);
+    const IndexHeader* index = (const IndexHeader*)data->sections[SECTION_INDEX];
+    const uint32_t* slots = (const uint32_t*)((const unsigned char*)index + sizeof(IndexHeader));
+    size_t length = strlen(key);
+    uint32_t slot = hashBytes(key, length) & (index->capacity - 1);
+    while (slots[slot] != 0)
+    {
+        const ConfigEntry* entry = &entries[slots[slot] - 1];
+        if (entry->keyLength == length && memcmp(config + entry->keyOffset, key, length) == 0)
+        {
+            *value = entry->value;
+            return true;
+        }
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+    return false;
+}
+
+// Fingerprint of the common data, to check that mapped data matches prepared data
+static uint64_t fingerprint(const CommonData* data)
+{
+    uint64_t result = 0;
+    char key[32];
+    int32_t value = 0;
+    for (uint32_t id = SECTION_CONFIG; id < SECTION_COUNT; id++)
+    {
+        result = result * 31 + hashBytes(data->sections[id], data->sizes[id]);
+    }
+    for (uint32_t i = 0; i < BENCHMARK_QUERIES; i++)
+    {
+        uint32_t setting = hashInt(i) % BENCHMARK_CONFIG_ENTRIES;
+        snprintf(key, sizeof(key), "group%03u.setting%06u", setting % 1000, setting);
+        if (!findSetting(data, key, &value))
+        {
+            return 0;
+        }
+        result += (uint64_t)value;
+    }
+    return result;
+}
+
+static void releaseCommonData(CommonData* data)
+{
+    for (uint32_t id = 0; id < SECTION_COUNT; id++)
+    {
+        free(data->owned[id]);
+    }
+    GfnPreloadSnapshotClose(data->snapshot);
+    memset(data, 0, sizeof(*data));
+}
+
+static unsigned int countMapped(const CommonData* data)
+{
+    unsigned int mapped = 0;
+    for (uint32_t id = SECTION_CONFIG; id < SECTION_COUNT; id++)
+    {
+        mapped += (data->owned[id] == NULL) ? 1 : 0;
+    }
+    return mapped;
+}
+
+// Runs the common stage of a pre-warm through the preload pipeline
+static bool runCommonStage(CommonData* data, uint64_t* stageUs)
+{
+    GfnPreloadPipelineConfig config = { 0 };
+    GfnPreloadTaskDesc task = { 0 };
+    GfnPreloadPipelineStats stats;
+    GfnPreloadTaskId configTask = 0;
+    GfnPreloadTaskSig tasks[] = { prepareLookup, prepareTerrain };
+    const char* names[] = { "lookup", "terrain" };
+    uint64_t start = 0;
+    bool ok = false;
+
+    config.numThreads = BENCHMARK_THREADS;
+    config.manualSessionInit = true;
+    if (GfnPreloadPipelineInitialize(&config) != gfnSuccess)
+    {
+        return false;
+    }
+
+    task.stage = GfnPreloadStageCommon;
+    task.critical = true;
+    task.pUserContext = data;
+    task.pchName = "config";
+    task.run = prepareConfig;
+    ok = GfnPreloadAddTask(&task, &configTask) == gfnSuccess;
+    for (unsigned int i = 0; i < 2 && ok; i++)
+    {
+        task.pchName = names[i];
+        task.run = tasks[i];
+        ok = GfnPreloadAddTask(&task, NULL) == gfnSuccess;
+    }
+    task.pchName = "index";
+    task.run = prepareIndex;
+    task.pDependencies = &configTask;
+    task.numDependencies = 1;
+    ok = ok && GfnPreloadAddTask(&task, NULL) == gfnSuccess;
+
+    start = getTimeUs();
+    ok = ok && GfnPreloadPipelineStart() == gfnSuccess && GfnPreloadPipelineWait(GfnPreloadStageCommon, UINT_MAX) == gfnSuccess;
+    *stageUs = getTimeUs() - start;
+    ok = ok && GfnPreloadPipelineGetStats(&stats) == gfnSuccess && stats.stages[GfnPreloadStageCommon].numSucceeded == SECTION_COUNT - 1;
+    GfnPreloadPipelineShutdown();
+    return ok;
+}
+
+// Opens the snapshot like a pre-warm would, falling back to preparing the data if it is not usable
+static bool runPreWarm(const char* path, uint64_t buildId, CommonData* data, uint64_t* totalUs, uint64_t* openUs,
+    GfnRuntimeError* openResult)
+{
+    uint64_t start = getTimeUs();
+    uint64_t stageUs = 0;
+    memset(data, 0, sizeof(*data));
+    *openResult = GfnPreloadSnapshotOpen(path, buildId, &data->snapshot);
+    *openUs = getTimeUs() - start;
+    bool ok = runCommonStage(data, &stageUs);
+    *totalUs = getTimeUs() - start;
+    return ok;
+}
+
+static int compareU64(const void* a, const void* b)
+{
+    uint64_t left = *(const uint64_t*)a;
+    uint64_t right = *(const uint64_t*)b;
+    return (left > right) - (left < right);
+}
+
+static bool damageSnapshot(const char* path)
+{
+    FILE* file = fopen(path, "r+b");
+    long size = 0;
+    int byte = 0;
+    bool ok = false;
+    if (file == NULL)
+    {
+        return false;
+    }
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 && fseek(file, size / 2, SEEK_SET) == 0
+        && (byte = fgetc(file)) != EOF && fseek(file, size / 2, SEEK_SET) == 0)
+    {
+        ok = fputc(byte ^ 0x01, file) != EOF;
+    }
+    return (fclose(file) == 0) && ok;
+}
+
+static bool benchmarkFallback(const char* label, const char* path, uint64_t buildId, uint64_t expected, GfnRuntimeError expectedResult)
+{
+    CommonData data;
+    GfnRuntimeError openResult = gfnSuccess;
+    uint64_t totalUs = 0;
+    uint64_t openUs = 0;
+    bool ok = runPreWarm(path, buildId, &data, &totalUs, &openUs, &openResult);
+    ok = ok && openResult == expectedResult && countMapped(&data) == 0 && fingerprint(&data) == expected;
+    printf("%-36s %10.1f ms  (open: %d, %s)\n", label, totalUs / 1000.0, openResult, GfnErrorToString(openResult));
+    releaseCommonData(&data);
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = (argc > 1) ? argv[1] : BENCHMARK_DEFAULT_PATH;
+    CommonData data;
+    GfnPreloadSnapshotInfo info;
+    GfnRuntimeError openResult = gfnSuccess;
+    uint64_t coldUs = 0;
+    uint64_t saveUs = 0;
+    uint64_t warmUs[BENCHMARK_WARM_RUNS];
+    uint64_t openUs[BENCHMARK_WARM_RUNS];
+    uint64_t expected = 0;
+    uint64_t start = 0;
+    bool ok = true;
+
+    printf("Pre-warm snapshot benchmark: %u config entries, %u lookup entries, %ux%u terrain, %u threads\n\n",
+        BENCHMARK_CONFIG_ENTRIES, BENCHMARK_LOOKUP_SIZE, BENCHMARK_TERRAIN_SIZE, BENCHMARK_TERRAIN_SIZE, BENCHMARK_THREADS);
+    remove(path);
+
+    // First pre-warm: nothing to map, prepare the data and save it
+    memset(&data, 0, sizeof(data));
+    if (GfnPreloadSnapshotWriterCreate(&data.writer) != gfnSuccess || !runCommonStage(&data, &coldUs))
+    {
+        printf("Failed to prepare the common data\n");
+        return 1;
+    }
+    expected = fingerprint(&data);
+    start = getTimeUs();
+    if (GfnPreloadSnapshotWriterSave(data.writer, path, BENCHMARK_BUILD_ID) != gfnSuccess)
+    {
+        printf("Failed to write the snapshot to %s\n", path);
+        return 1;
+    }
+    saveUs = getTimeUs() - start;
+    GfnPreloadSnapshotWriterDestroy(data.writer);
+    data.writer = NULL;
+    releaseCommonData(&data);
+    printf("%-36s %10.1f ms\n", "common stage, prepared from scratch", coldUs / 1000.0);
+    printf("%-36s %10.1f ms\n", "writing the snapshot", saveUs / 1000.0);
+
+    // Later pre-warms map the snapshot
+    for (unsigned int run = 0; run < BENCHMARK_WARM_RUNS && ok; run++)
+    {
+        ok = runPreWarm(path, BENCHMARK_BUILD_ID, &data, &warmUs[run], &openUs[run], &openResult) && openResult == gfnSuccess
+            && GfnPreloadSnapshotGetInfo(data.snapshot, &info) == gfnSuccess
+            && countMapped(&data) == SECTION_COUNT - 1 && fingerprint(&data) == expected;
+        releaseCommonData(&data);
+    }
+    if (!ok)
+    {
+        printf("Mapped data does not match the prepared data\n");
+        remove(path);
+        return 1;
+    }
+    qsort(warmUs, BENCHMARK_WARM_RUNS, sizeof(uint64_t), compareU64);
+    qsort(openUs, BENCHMARK_WARM_RUNS, sizeof(uint64_t), compareU64);
+    printf("%-36s %10.1f ms  (min %.1f ms, of which %.1f ms to map and validate %llu KB)\n", "common stage, mapped from snapshot",
+        warmUs[BENCHMARK_WARM_RUNS / 2] / 1000.0, warmUs[0] / 1000.0, openUs[BENCHMARK_WARM_RUNS / 2] / 1000.0,
+        (unsigned long long)(info.fileSize / 1024));
+    printf("%-36s %10.1fx\n", "speedup", (double)coldUs / (double)(warmUs[BENCHMARK_WARM_RUNS / 2] ? warmUs[BENCHMARK_WARM_RUNS / 2] : 1));
+
+    // Fallback paths: the data is prepared again
+    printf("\n");
+    ok = benchmarkFallback("fallback, snapshot of another build", path, BENCHMARK_BUILD_ID + 1, expected, gfnIncompatibleVersion);
+    ok = damageSnapshot(path) && benchmarkFallback("fallback, damaged snapshot", path, BENCHMARK_BUILD_ID, expected, gfnNoData) && ok;
+    remove(path);
+    ok = benchmarkFallback("fallback, no snapshot", path, BENCHMARK_BUILD_ID, expected, gfnNoData) && ok;
+    if (!ok)
+    {
+        printf("A fallback pre-warm did not behave as expected\n");
+        return 1;
+    }
+    return 0;
+}
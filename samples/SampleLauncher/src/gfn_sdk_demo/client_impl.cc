@@ -55,6 +55,14 @@ class MessageHandler : public CefMessageRouterBrowserSide::Handler {
     return false;
   }
 
+  // Called when a pending query is canceled, e.g. because its browser closed
+  // or navigated away. The command may still be running on a worker thread.
+  void OnQueryCanceled(CefRefPtr<CefBrowser> browser,
+                       CefRefPtr<CefFrame> frame,
+                       int64 query_id) OVERRIDE {
+    GfnSdkHelperCancelQuery(query_id);
+  }
+
  private:
   const CefString startup_url_;
 
@@ -134,13 +142,16 @@ bool Client::DoClose(CefRefPtr<CefBrowser> browser) {
 void Client::OnBeforeClose(CefRefPtr<CefBrowser> browser) {
   CEF_REQUIRE_UI_THREAD();
 
+  // Cancel the pending queries of the browser.
+  message_router_->OnBeforeClose(browser);
+
   if (--browser_ct_ == 0) {
     // Free the router when the last browser is closed.
     message_router_->RemoveHandler(message_handler_.get());
     message_handler_.reset();
     message_router_ = NULL;
-   
-    GfnShutdownSdk();
+
+    GfnSdkHelperShutdown();
     shared::g_browserHost = NULL;
   }
 
@@ -27,13 +27,28 @@
 
 #include "gfn_sdk_demo/gfn_sdk_helper.h"
 
+#include "include/base/cef_bind.h"
 #include "include/cef_parser.h"
 #include "include/cef_command_line.h"
+#include "include/wrapper/cef_closure_task.h"
+#include "include/wrapper/cef_helpers.h"
 #include "shared/client_util.h"
 #include "shared/defines.h"
 #include "shared/main.h"
 #include "GfnRuntimeSdk_Wrapper.h"  //Helper functions that wrap Library-based APIs
+#include "GfnSdk_StreamControl.h"
+#include "GfnSdk_StreamPrepare.h"
+#include "GfnSdk_StreamTimeline.h"
+#include "GfnSdk_TitleCache.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef _WIN32
 #   define HELPER_CALLBACK __stdcall
@@ -47,6 +62,7 @@
 CefString GFN_SDK_INIT = "GFN_SDK_INIT";
 CefString GFN_SDK_SHUTDOWN = "GFN_SDK_SHUTDOWN";
 CefString GFN_SDK_STREAM_ACTION = "GFN_SDK_STREAM_ACTION";
+CefString GFN_SDK_PREPARE_STREAM = "GFN_SDK_PREPARE_STREAM";
 CefString GFN_SDK_IS_RUNNING_IN_CLOUD = "GFN_SDK_IS_RUNNING_IN_CLOUD";
 CefString GFN_SDK_IS_RUNNING_IN_CLOUD_SECURE = "GFN_SDK_IS_RUNNING_IN_CLOUD_SECURE";
 CefString GFN_SDK_CLOUD_CHECK_WITH_VALIDATION = "GFN_SDK_CLOUD_CHECK_WITH_VALIDATION";
@@ -107,16 +123,305 @@ static void logGfnSdkData()
     }
 }
 
+// SDK calls can block for seconds, for example while the SDK library loads or the GeForce NOW
+// client is contacted, so queries are handled on these worker threads instead of the UI thread
+#define GFN_SDK_WORKER_THREADS 2
+// Time after which stream start and stop attempts are aborted, once issued to the SDK
+#define GFN_STREAM_START_TIMEOUT_MS (5 * 60 * 1000)
+#define GFN_STREAM_STOP_TIMEOUT_MS (30 * 1000)
+
+namespace {
+
+// Responses are posted to the UI thread until GfnSdkHelperShutdown runs. The GFN SDK is shut down in
+// the background after that, possibly past CefShutdown, when CefPostTask must no longer be called.
+std::mutex s_responseLock;
+bool s_responsesClosed = false;
+
+// A query handled off the UI thread. Success and Failure may be called from any thread, and post
+// the response to the UI thread, where the message router callback is completed unless the query
+// was canceled in the meantime.
+class GfnSdkQuery : public CefBaseRefCounted {
+ public:
+  GfnSdkQuery(int64 query_id, bool persistent, CefRefPtr<CefMessageRouterBrowserSide::Callback> callback)
+      : query_id_(query_id), persistent_(persistent), callback_(callback), canceled_(false), start_handle_(0) {}
+
+  void Success(const CefString& response) {
+    Post(base::Bind(&GfnSdkQuery::Complete, this, true, 0, response));
+  }
+
+  void Failure(int error_code, const CefString& error_message) {
+    Post(base::Bind(&GfnSdkQuery::Complete, this, false, error_code, error_message));
+  }
+
+  bool IsCanceled() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return canceled_;
+  }
+
+  // Remembers the stream start the query waits for, so that canceling the query cancels it
+  void SetStartStreamHandle(GfnStartStreamHandle handle) {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      if (!canceled_) {
+        start_handle_ = handle;
+        return;
+      }
+    }
+    GfnCancelStartStream(handle);
+  }
+
+  // Called on the UI thread. Does not block on the SDK.
+  void Cancel() {
+    GfnStartStreamHandle handle = 0;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      canceled_ = true;
+      handle = start_handle_;
+      start_handle_ = 0;
+    }
+    callback_ = nullptr;
+    if (handle != 0) {
+      GfnCancelStartStream(handle);
+    }
+  }
+
+ private:
+  static void Post(const base::Closure& task) {
+    std::lock_guard<std::mutex> lock(s_responseLock);
+    if (!s_responsesClosed)
+      CefPostTask(TID_UI, task);
+  }
+
+  void Complete(bool success, int error_code, const CefString& response);
+
+  const int64 query_id_;
+  const bool persistent_;
+  CefRefPtr<CefMessageRouterBrowserSide::Callback> callback_;  // UI thread only
+
+  std::mutex lock_;
+  bool canceled_;
+  GfnStartStreamHandle start_handle_;
+
+  IMPLEMENT_REFCOUNTING(GfnSdkQuery);
+  DISALLOW_COPY_AND_ASSIGN(GfnSdkQuery);
+};
+
+// Queries waiting for a response, by query id. UI thread only.
+std::map<int64, CefRefPtr<GfnSdkQuery>> s_queries;
+
+void GfnSdkQuery::Complete(bool success, int error_code, const CefString& response) {
+  CEF_REQUIRE_UI_THREAD();
+
+  if (IsCanceled() || !callback_)
+    return;
+
+  if (success)
+    callback_->Success(response);
+  else
+    callback_->Failure(error_code, response);
+
+  if (!persistent_) {
+    callback_ = nullptr;
+    s_queries.erase(query_id_);
+  }
+}
+
+// Fixed set of threads running query commands in the order they were posted. An exclusive task,
+// such as initializing or shutting down the SDK, waits for the running tasks to finish and runs
+// alone, so no other command sees the SDK half initialized.
+class GfnSdkWorkerPool {
+ public:
+  GfnSdkWorkerPool() : running_(0), exclusive_running_(false), stopped_(false) {}
+  ~GfnSdkWorkerPool() { Stop(); }
+
+  bool Post(const std::function<void()>& task, bool exclusive) {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (stopped_)
+      return false;
+    if (threads_.empty()) {
+      for (int i = 0; i < GFN_SDK_WORKER_THREADS; i++)
+        threads_.push_back(std::thread(&GfnSdkWorkerPool::Run, this));
+    }
+    tasks_.push_back(Task{ task, exclusive });
+    cond_.notify_all();
+    return true;
+  }
+
+  // Drops the tasks that have not started, and waits for the running ones
+  void Stop() {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      stopped_ = true;
+      tasks_.clear();
+      threads.swap(threads_);
+      cond_.notify_all();
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+  }
+
+ private:
+  struct Task {
+    std::function<void()> run;
+    bool exclusive;
+  };
+
+  bool CanRunNext() const {
+    return !tasks_.empty() && !exclusive_running_ && (!tasks_.front().exclusive || running_ == 0);
+  }
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(lock_);
+    for (;;) {
+      cond_.wait(lock, [this] { return stopped_ || CanRunNext(); });
+      if (stopped_)
+        return;
+
+      Task task = tasks_.front();
+      tasks_.pop_front();
+      running_++;
+      exclusive_running_ = task.exclusive;
+
+      lock.unlock();
+      task.run();
+      lock.lock();
+
+      running_--;
+      exclusive_running_ = false;
+      cond_.notify_all();
+    }
+  }
+
+  std::mutex lock_;
+  std::condition_variable cond_;
+  std::deque<Task> tasks_;
+  std::vector<std::thread> threads_;
+  int running_;
+  bool exclusive_running_;
+  bool stopped_;
+
+  DISALLOW_COPY_AND_ASSIGN(GfnSdkWorkerPool);
+};
+
+GfnSdkWorkerPool s_workerPool;
+
+}  // namespace
+
 // Callback function for handling stream status callbacks
 static void HELPER_CALLBACK handleStreamStatusCallback(GfnStreamStatus status, void* context);
 static void HELPER_CALLBACK handleNetworkStatusCallback(GfnNetworkStatusUpdateData* pNetworkStatus, void* context);
 static void HELPER_CALLBACK handleClientInfoCallback(GfnClientInfoUpdateData* pClientUpdate, void* context);
-static CefMessageRouterBrowserSide::Callback* s_registerStreamStatusCallback = nullptr;
-static CefMessageRouterBrowserSide::Callback* s_registerNetworkStatusCallback = nullptr;
-static CefMessageRouterBrowserSide::Callback* s_registerClientInfoCallback = nullptr;
-
 static void HELPER_CALLBACK handleMessageCallback(GfnString* pStrData, void* context);
-static CefMessageRouterBrowserSide::Callback* s_registerMessageCallback = nullptr;
+
+// Persistent queries registered for SDK notifications, which arrive on SDK threads
+static std::mutex s_registrationLock;
+static CefRefPtr<GfnSdkQuery> s_registerStreamStatusCallback;
+static CefRefPtr<GfnSdkQuery> s_registerNetworkStatusCallback;
+static CefRefPtr<GfnSdkQuery> s_registerClientInfoCallback;
+static CefRefPtr<GfnSdkQuery> s_registerMessageCallback;
+
+static void setRegistration(CefRefPtr<GfnSdkQuery>* registration, CefRefPtr<GfnSdkQuery> query)
+{
+    std::lock_guard<std::mutex> lock(s_registrationLock);
+    *registration = query;
+}
+
+static CefRefPtr<GfnSdkQuery> getRegistration(const CefRefPtr<GfnSdkQuery>* registration)
+{
+    std::lock_guard<std::mutex> lock(s_registrationLock);
+    return *registration;
+}
+
+// Set when stream starts are recorded in the stream timeline, which is only available on the client
+static std::atomic<bool> s_streamTimelineEnabled(false);
+// Set when stream starts and stops go through stream control, which is only available on the client
+static std::atomic<bool> s_streamControlEnabled(false);
+
+static void logStreamTimeline()
+{
+    GfnStreamTimeline timeline;
+    GfnStreamTimelineHistogram histogram;
+
+    if (!s_streamTimelineEnabled || GfnStreamTimelineGetLatest(&timeline) != GfnError::gfnSuccess)
+    {
+        return;
+    }
+    LOG(INFO) << "Stream session " << timeline.sessionId << " for title " << timeline.uiTitleId
+        << ": time to stream " << timeline.timeToStreamMs << " ms, network test " << timeline.networkTestMs
+        << " ms, loading " << timeline.loadingMs << " ms, saved by preparing " << timeline.prepareSavedMs
+        << " ms, GFN downloaded " << timeline.downloaded;
+    if (GfnStreamTimelineGetHistogram(GfnStreamTimelineMetricTimeToStream, &histogram) == GfnError::gfnSuccess && histogram.count > 0)
+    {
+        LOG(INFO) << "Time to stream over the last " << histogram.count << " sessions: p50 " << histogram.p50Ms
+            << " ms, p90 " << histogram.p90Ms << " ms, max " << histogram.maxMs << " ms";
+    }
+}
+
+static void HELPER_CALLBACK handlePrepareStreamCallback(GfnError status, const GfnPrepareStreamState* pState, void* context)
+{
+    LOG(INFO) << "Stream prepared for title " << pState->uiTitleId << ": " << GfnErrorToString(status)
+        << ", library " << pState->libraryMs << " ms, timeline " << pState->timelineMs << " ms";
+}
+
+static bool startStreamResult(GfnError err, const StartStreamResponse* response, std::string& msg)
+{
+    logStreamTimeline();
+    msg = "gfnStartStream = " + std::string(GfnErrorToString(err));
+    if (err != GfnError::gfnSuccess)
+    {
+        LOG(ERROR) << "launch game error: " << msg;
+        return false;
+    }
+    msg = msg + ", GFN Downloaded & Installed = " + (response->downloaded ? "Yes" : "Not needed");
+    LOG(INFO) << "launch game response. Downloaded GeForceNOW? : " << response->downloaded;
+    return true;
+}
+
+static bool stopStreamResult(GfnError err, std::string& msg)
+{
+    msg = "gfnStopStream = " + std::string(GfnErrorToString(err));
+    if (err != GfnError::gfnSuccess)
+    {
+        LOG(ERROR) << "Stream stop error: " << msg;
+        return false;
+    }
+    LOG(INFO) << "Stream stop success";
+    return true;
+}
+
+static void respondStreamAction(CefRefPtr<GfnSdkQuery> callback, bool actionSuccess, const std::string& msg)
+{
+    CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
+    response_dict->SetBool("actionSuccess", actionSuccess);
+    response_dict->SetString("errorMessage", CefString(msg.c_str()));
+
+    CefString response(DictToJson(response_dict));
+    callback->Success(response);
+}
+
+// Called on the stream control thread, with the query that requested the start as context
+static void HELPER_CALLBACK handleStartStreamCallback(GfnError result, StartStreamResponse* response, void* context)
+{
+    GfnSdkQuery* query = static_cast<GfnSdkQuery*>(context);
+    StartStreamResponse emptyResponse = { 0 };
+    std::string msg;
+    bool actionSuccess = startStreamResult(result, response ? response : &emptyResponse, msg);
+
+    respondStreamAction(query, actionSuccess, msg);
+    query->Release();
+}
+
+// Called on the stream control thread, with the query that requested the stop as context
+static void HELPER_CALLBACK handleStopStreamCallback(GfnError result, void* context)
+{
+    GfnSdkQuery* query = static_cast<GfnSdkQuery*>(context);
+    std::string msg;
+    bool actionSuccess = stopStreamResult(result, msg);
+
+    respondStreamAction(query, actionSuccess, msg);
+    query->Release();
+}
 
 static GfnError initGFN()
 {
@@ -126,6 +431,15 @@ static GfnError initGFN()
     case GfnError::gfnSuccess:
         LOG(INFO) << "succeeded at initializing GFNRuntime SDK";
         logGfnSdkData();
+        // Title availability is answered from a local copy of the available titles, refreshed in
+        // the background. gfnInvalidParameter means the cache is already running from an earlier GFN_SDK_INIT.
+        {
+            GfnError cacheErr = GfnTitleCacheInitialize(nullptr);
+            if (cacheErr != GfnError::gfnSuccess && cacheErr != GfnError::gfnInvalidParameter)
+            {
+                LOG(ERROR) << "title cache not ready, using GfnIsTitleAvailable: " << GfnErrorToString(cacheErr);
+            }
+        }
         break;
     case GfnError::gfnInitSuccessClientOnly:
         LOG(INFO) << "succeeded at initializing client-only GFNRuntime SDK";
@@ -134,20 +448,95 @@ static GfnError initGFN()
         LOG(ERROR) << "error initializing: " << GfnErrorToString(err);
     }
 
+    if (err == GfnError::gfnInitSuccessClientOnly)
+    {
+        // gfnInvalidParameter means the module is already running from an earlier GFN_SDK_INIT
+        GfnError timelineErr = GfnStreamTimelineInitialize();
+        s_streamTimelineEnabled = (timelineErr == GfnError::gfnSuccess || timelineErr == GfnError::gfnInvalidParameter);
+        if (!s_streamTimelineEnabled)
+        {
+            LOG(ERROR) << "stream timeline not available: " << GfnErrorToString(timelineErr);
+        }
+        else
+        {
+            GfnPrepareStreamInitialize();
+        }
+
+        GfnError controlErr = GfnStreamControlInitialize();
+        s_streamControlEnabled = (controlErr == GfnError::gfnSuccess || controlErr == GfnError::gfnInvalidParameter);
+        if (!s_streamControlEnabled)
+        {
+            LOG(ERROR) << "stream control not available: " << GfnErrorToString(controlErr);
+        }
+    }
+
     return err;
 }
 
-bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
-    CefRefPtr<CefFrame> frame,
-    int64 query_id,
-    const CefString& request,
-    bool persistent,
-    CefRefPtr<CefMessageRouterBrowserSide::Callback> callback)
+static GfnError shutdownGFN()
 {
-    CefRefPtr<CefValue> requestValue = CefParseJSON(request, JSON_PARSER_RFC);
+    if (s_streamControlEnabled)
+    {
+        GfnStreamControlShutdown();
+        s_streamControlEnabled = false;
+    }
+    if (s_streamTimelineEnabled)
+    {
+        GfnPrepareStreamShutdown();
+        GfnStreamTimelineShutdown();
+        s_streamTimelineEnabled = false;
+    }
+    GfnTitleCacheShutdown();
+    return GfnShutdownSdk();
+}
 
-    CefRefPtr<CefDictionaryValue> dict = requestValue->GetDictionary();
-    CefString command = dict->GetString("command");
+// Commands handled by runGfnSdkCommand
+static bool isGfnSdkCommand(const CefString& command)
+{
+    static const CefString* const commands[] = {
+        &GFN_SDK_INIT,
+        &GFN_SDK_SHUTDOWN,
+        &GFN_SDK_IS_RUNNING_IN_CLOUD,
+        &GFN_SDK_IS_RUNNING_IN_CLOUD_SECURE,
+        &GFN_SDK_CLOUD_CHECK_WITH_VALIDATION,
+        &GFN_SDK_CLOUD_CHECK_NO_VALIDATION,
+        &GFN_SDK_IS_TITLE_AVAILABLE,
+        &GFN_SDK_GET_AVAILABLE_TITLES,
+        &GFN_SDK_STREAM_ACTION,
+        &GFN_SDK_PREPARE_STREAM,
+        &GFN_SDK_SEND_MESSAGE,
+        &GFN_SDK_REGISTER_MESSAGE_CALLBACK,
+        &GFN_SDK_GET_CLIENT_IP,
+        &GFN_SDK_GET_CLIENT_COUNTRY_CODE,
+        &GFN_SDK_GET_CLIENT_LANGUAGE_CODE,
+        &GFN_SDK_REGISTER_STREAM_STATUS_CALLBACK,
+        &GFN_SDK_GET_PARTNER_SECURE_DATA,
+        &GFN_SDK_GET_PARTNER_DATA,
+        &GET_CLIENT_INFO,
+        &GFN_SDK_REGISTER_CLIENT_INFO_CALLBACK,
+        &GFN_SDK_REGISTER_NETWORK_STATUS_CALLBACK,
+        &GET_SESSION_INFO,
+        &GFN_SDK_OPEN_URL_ON_CLIENT,
+    };
+
+    for (const CefString* known : commands)
+    {
+        if (command == *known)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Runs a query command on a worker thread. The response is delivered through callback, which
+// completes the query on the UI thread.
+static void runGfnSdkCommand(const CefString& command, CefRefPtr<CefDictionaryValue> dict, CefRefPtr<GfnSdkQuery> callback)
+{
+    if (callback->IsCanceled())
+    {
+        return;
+    }
 
     /**
      * Query command for initializing the GFN SDK. Should be called once during launcher startup
@@ -163,7 +552,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
 
         CefString response(DictToJson(response_dict));
         callback->Success(response);
-        return true;
+        return;
     }
     /**
      * Query command for shutting down the GFN SDK. Should be called once the SDK is no longer needed.
@@ -171,14 +560,14 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
      */
     if (command == GFN_SDK_SHUTDOWN)
     {
-        GfnError err = GfnShutdownSdk();
+        GfnError err = shutdownGFN();
         CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
         response_dict->SetBool("success", (err == GfnError::gfnSuccess));
         response_dict->SetString("errorMessage", GfnErrorToString(err));
 
         CefString response(DictToJson(response_dict));
         callback->Success(response);
-        return true;
+        return;
     }
     /**
      * Calls into GFN SDK to determine whether the sample launcher is being executed inside
@@ -202,7 +591,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         CefString response(DictToJson(response_dict));
         callback->Success(response);
 
-        return true;
+        return;
     }
     /**
     * Calls into GFN SDK securely to determine whether the sample launcher is being executed inside
@@ -229,7 +618,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         CefString response(DictToJson(response_dict));
         callback->Success(response);
 
-        return true;
+        return;
     }
     /**
     * Calls into GFN SDK securely to determine whether the sample launcher is being executed inside
@@ -277,7 +666,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         LOG(INFO) << "Cloud environment : " << bCloudCheck;
         CefString resp(DictToJson(response_dict));
         callback->Success(resp);
-        return true;
+        return;
     }
     /**
     * Calls into GFN SDK securely to determine whether the sample launcher is being executed inside
@@ -300,7 +689,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         LOG(INFO) << "Cloud environment : " << bCloudCheckSimple;
         CefString resp(DictToJson(response_dict));
         callback->Success(resp);
-        return true;
+        return;
     }
     /**
      * Calls into GFN SDK to determine if a specific title is available to stream right now
@@ -313,7 +702,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         {
             std::string pchappId = dict->GetString("appId").ToString();
             bool available = false;
-            GfnError err = GfnIsTitleAvailable(pchappId.c_str(), &available);
+            GfnError err = GfnIsTitleAvailableCached(pchappId.c_str(), &available);
             if (err != GfnError::gfnSuccess)
             {
                 LOG(ERROR) << "is title available error: " << GfnErrorToString(err);
@@ -333,7 +722,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
 
         CefString response(DictToJson(response_dict));
         callback->Success(response);
-        return true;
+        return;
     }
     /**
      * Calls into GFN SDK to determine all titles available to stream right now directly from the
@@ -359,7 +748,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         CefString response(DictToJson(response_dict));
         callback->Success(response);
 
-        return true;
+        return;
     }
     /**
      * Calls into GFN SDK to initiate a new GeForce NOW streaming session and launch the specified
@@ -395,17 +784,27 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
 
                 startStreamInput.pchPartnerData = "This is example custom data";
 
-                GfnError err = GfnStartStream(&startStreamInput, &response);
-                msg = "gfnStartStream = " + std::string(GfnErrorToString(err));
-                if (err != GfnError::gfnSuccess)
+                if (s_streamControlEnabled)
                 {
+                    // Completed by handleStartStreamCallback. Canceling the query cancels the start.
+                    GfnStartStreamHandle handle = 0;
+                    callback->AddRef();
+                    GfnError err = GfnStartStreamCancellable(&startStreamInput, handleStartStreamCallback, callback.get(),
+                        GFN_STREAM_START_TIMEOUT_MS, &handle);
+                    if (err == GfnError::gfnSuccess)
+                    {
+                        callback->SetStartStreamHandle(handle);
+                        return;
+                    }
+                    callback->Release();
+                    msg = "GfnStartStreamCancellable = " + std::string(GfnErrorToString(err));
                     LOG(ERROR) << "launch game error: " << msg;
                 }
                 else
                 {
-                    actionSuccess = true;
-                    msg = msg + ", GFN Downloaded & Installed = " + (response.downloaded ? "Yes" : "Not needed");
-                    LOG(INFO) << "launch game response. Downloaded GeForceNOW? : " << response.downloaded;
+                    GfnError err = s_streamTimelineEnabled ? GfnStartStreamTracked(&startStreamInput, &response)
+                                                           : GfnStartStream(&startStreamInput, &response);
+                    actionSuccess = startStreamResult(err, &response, msg);
                 }
             }
             else
@@ -416,26 +815,49 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         else
         {
             LOG(INFO) << "Received request to stop a session";
-            GfnError err = GfnStopStream();
-            msg = "gfnStopStream = " + std::string(GfnErrorToString(err));
-            if (err != GfnError::gfnSuccess)
+            if (s_streamControlEnabled)
             {
+                // Completed by handleStopStreamCallback, once the starts requested before it are done
+                callback->AddRef();
+                GfnError err = GfnStopStreamSequenced(handleStopStreamCallback, callback.get(), GFN_STREAM_STOP_TIMEOUT_MS);
+                if (err == GfnError::gfnSuccess)
+                {
+                    return;
+                }
+                callback->Release();
+                msg = "GfnStopStreamSequenced = " + std::string(GfnErrorToString(err));
                 LOG(ERROR) << "Stream stop error: " << msg;
             }
             else
             {
-                actionSuccess = true;
-                LOG(INFO) << "Stream stop success";
+                actionSuccess = stopStreamResult(GfnStopStream(), msg);
             }
         }
 
+        respondStreamAction(callback, actionSuccess, msg);
+        return;
+    }
+    /**
+     * Prepares a stream start for the title the user is looking at, so that a later stream action
+     * for it does not have to do the client-side setup. Returns without waiting for it.
+     */
+    else if (command == GFN_SDK_PREPARE_STREAM)
+    {
+        GfnError err = GfnError::gfnAPINotInit;
+        if (s_streamTimelineEnabled && dict->HasKey("gfnTitleId"))
+        {
+            GfnPrepareStreamInput prepareInput = { GfnDisplayLanguage::gfnDefaultLanguage, 0 };
+            prepareInput.uiTitleId = dict->GetInt("gfnTitleId");
+            err = GfnPrepareStream(&prepareInput, handlePrepareStreamCallback, nullptr);
+        }
+
         CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
-        response_dict->SetBool("actionSuccess", actionSuccess);
-        response_dict->SetString("errorMessage", CefString(msg.c_str()));
+        response_dict->SetBool("success", err == GfnError::gfnSuccess);
+        response_dict->SetString("errorMessage", GfnErrorToString(err));
 
         CefString response(DictToJson(response_dict));
         callback->Success(response);
-        return true;
+        return;
     }
     else if (command == GFN_SDK_SEND_MESSAGE)
     {
@@ -466,18 +888,18 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
 
         CefString response(DictToJson(response_dict));
         callback->Success(response);
-        return true;
+        return;
     }
     else if (command == GFN_SDK_REGISTER_MESSAGE_CALLBACK)
     {
-        s_registerMessageCallback = callback;
+        setRegistration(&s_registerMessageCallback, callback);
 
         GfnError err = GfnRegisterMessageCallback(reinterpret_cast<MessageCallbackSig>(&handleMessageCallback), nullptr);
         if (err != GfnError::gfnSuccess)
         {
             LOG(ERROR) << "Failed to register Message Callback: " << GfnErrorToString(err);
         }
-        return true;
+        return;
     }
     /**
      * Calls into GFN SDK to get the user's current local IP address. This is meant to be
@@ -505,7 +927,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         CefString response(DictToJson(response_dict));
         callback->Success(response);
 
-        return true;
+        return;
     }
     /**
      * Calls into GFN SDK to get the user's country code. This is meant to be
@@ -531,7 +953,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
 
         CefString response(DictToJson(response_dict));
         callback->Success(response);
-        return true;
+        return;
     }
 
     /**
@@ -564,21 +986,24 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         {
             GfnFree(&clientLanguageCode);
         }
-        return true;
+        return;
     }
     /**
      * Registers for callback notifications during a streaming session.
      */
     else if (command == GFN_SDK_REGISTER_STREAM_STATUS_CALLBACK)
     {
-        s_registerStreamStatusCallback = callback;
+        setRegistration(&s_registerStreamStatusCallback, callback);
 
-        GfnError err = GfnRegisterStreamStatusCallback(reinterpret_cast<StreamStatusCallbackSig>(&handleStreamStatusCallback), nullptr);
+        // The stream timeline owns the SDK's stream status callback, and forwards the updates
+        GfnError err = s_streamTimelineEnabled
+            ? GfnStreamTimelineRegisterStreamStatusCallback(reinterpret_cast<StreamStatusCallbackSig>(&handleStreamStatusCallback), nullptr)
+            : GfnRegisterStreamStatusCallback(reinterpret_cast<StreamStatusCallbackSig>(&handleStreamStatusCallback), nullptr);
         if (err != GfnError::gfnSuccess)
         {
             LOG(ERROR) << "Failed to register Stream Status Callback: " << GfnErrorToString(err);
         }
-        return true;
+        return;
     }
     /**
      * Requests a copy of the token data that was passed into partnerSecureData as part of the call to one
@@ -604,7 +1029,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         CefString response(DictToJson(response_dict));
         callback->Success(response);
 
-        return true;
+        return;
     }
     /**
      * Requests a copy of the custom data that was passed into pchPartnerData as part of the
@@ -631,17 +1056,7 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         CefString response(DictToJson(response_dict));
         callback->Success(response);
 
-        return true;
-    }
-    else if (command == GET_TCP_PORT)
-    {
-        CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
-        response_dict->SetString("port", shared::g_activePort);
-
-        CefString response(DictToJson(response_dict));
-        callback->Success(response);
-
-        return true;
+        return;
     }
     else if (command == GET_CLIENT_INFO)
     {
@@ -671,53 +1086,35 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         CefString response(DictToJson(response_dict));
         LOG(INFO) << "GfnGetClientInfo data: " << response.ToString();
         callback->Success(response);
-        return true;
+        return;
     }
     /**
      * Registers for callback notifications for on-seat client info updates
      */
     else if (command == GFN_SDK_REGISTER_CLIENT_INFO_CALLBACK)
     {
-        s_registerClientInfoCallback = callback;
+        setRegistration(&s_registerClientInfoCallback, callback);
 
         GfnError err = GfnRegisterClientInfoCallback(reinterpret_cast<ClientInfoCallbackSig>(&handleClientInfoCallback), nullptr);
         if (err != GfnError::gfnSuccess)
         {
             LOG(ERROR) << "Failed to register Client Info Callback: " << GfnErrorToString(err);
         }
-        return true;
+        return;
     }
     /**
      * Registers for callback notifications for on-seat network latency updates
      */
     else if (command == GFN_SDK_REGISTER_NETWORK_STATUS_CALLBACK)
     {
-        s_registerNetworkStatusCallback = callback;
+        setRegistration(&s_registerNetworkStatusCallback, callback);
 
         GfnError err = GfnRegisterNetworkStatusCallback(reinterpret_cast<NetworkStatusCallbackSig>(&handleNetworkStatusCallback), 5 * 1000, nullptr);
         if (err != GfnError::gfnSuccess)
         {
             LOG(ERROR) << "Failed to register Network Latency Callback: " << GfnErrorToString(err);
         }
-        return true;
-    }
-    else if (command == GET_OVERRIDE_URI)
-    {
-        CefString override_uri = "";
-        CefRefPtr<CefCommandLine> command_line = CefCommandLine::GetGlobalCommandLine();
-
-        if (command_line->HasSwitch("override_uri"))
-        {
-            override_uri = command_line->GetSwitchValue("override_uri");
-        }
-
-        CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
-        response_dict->SetString("overrideURI", override_uri);
-
-        CefString response(DictToJson(response_dict));
-        LOG(INFO) << "Override URI: " << response.ToString();
-        callback->Success(response);
-        return true;
+        return;
     }
     else if (command == GET_SESSION_INFO)
     {
@@ -743,50 +1140,194 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
         CefString response(DictToJson(response_dict));
         LOG(INFO) << "GfnGetSessionInfo data: " << response.ToString();
         callback->Success(response);
-        return true;
+        return;
     }
-    else if (command == GFN_SDK_GET_ADDITIONAL_SUPPORTED_TITLES)
+    else if (command == GFN_SDK_OPEN_URL_ON_CLIENT)
     {
-        CefRefPtr<CefListValue> titles_list = CefListValue::Create();
+        CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
+        GfnError error = GfnOpenURLOnClient("https://www.nvidia.com/en-us/geforce-now/");
+        LOG(INFO) << "GfnOpenURLOnClient error result: " << error;
+        response_dict->SetString("status", GfnErrorToString(error));
+        if (error != GfnError::gfnSuccess)
+        {
+            LOG(ERROR) << "Open URL on Client data error: " << GfnErrorToString(error);
+        }
+        CefString response(DictToJson(response_dict));
+        callback->Success(response);
+        return;
+    }
+    // Not reached: GfnSdkHelper only posts the commands accepted by isGfnSdkCommand
+    LOG(ERROR) << "Unhandled command value: " << command;
+    callback->Failure(-1, "Unknown command");
+}
 
-        // Custom title CMS ids could be added here to titles_list
+bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
+    CefRefPtr<CefFrame> frame,
+    int64 query_id,
+    const CefString& request,
+    bool persistent,
+    CefRefPtr<CefMessageRouterBrowserSide::Callback> callback)
+{
+    CEF_REQUIRE_UI_THREAD();
+
+    CefRefPtr<CefValue> requestValue = CefParseJSON(request, JSON_PARSER_RFC);
+
+    CefRefPtr<CefDictionaryValue> dict = requestValue->GetDictionary();
+    CefString command = dict->GetString("command");
 
+    /**
+     * Commands that do not call into the GFN SDK are answered right away.
+     */
+    if (command == GET_TCP_PORT)
+    {
         CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
-        response_dict->SetList("titles", titles_list);
+        response_dict->SetString("port", shared::g_activePort);
 
         CefString response(DictToJson(response_dict));
         callback->Success(response);
 
         return true;
     }
-    else if (command == GFN_SDK_OPEN_URL_ON_CLIENT)
+    else if (command == GET_OVERRIDE_URI)
     {
-        CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
-        GfnError error = GfnOpenURLOnClient("https://www.nvidia.com/en-us/geforce-now/");
-        LOG(INFO) << "GfnOpenURLOnClient error result: " << error;
-        response_dict->SetString("status", GfnErrorToString(error));
-        if (error != GfnError::gfnSuccess)
+        CefString override_uri = "";
+        CefRefPtr<CefCommandLine> command_line = CefCommandLine::GetGlobalCommandLine();
+
+        if (command_line->HasSwitch("override_uri"))
         {
-            LOG(ERROR) << "Open URL on Client data error: " << GfnErrorToString(error);
+            override_uri = command_line->GetSwitchValue("override_uri");
         }
+
+        CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
+        response_dict->SetString("overrideURI", override_uri);
+
         CefString response(DictToJson(response_dict));
+        LOG(INFO) << "Override URI: " << response.ToString();
         callback->Success(response);
         return true;
     }
-    LOG(ERROR) << "Unknown command value: " << command;
+    else if (command == GFN_SDK_GET_ADDITIONAL_SUPPORTED_TITLES)
+    {
+        CefRefPtr<CefListValue> titles_list = CefListValue::Create();
 
-    return false;
+        // Custom title CMS ids could be added here to titles_list
+
+        CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
+        response_dict->SetList("titles", titles_list);
+
+        CefString response(DictToJson(response_dict));
+        callback->Success(response);
+
+        return true;
+    }
+
+    /**
+     * Everything else calls into the GFN SDK, which can block, and is handled on a worker thread.
+     * GFN_SDK_INIT and GFN_SDK_SHUTDOWN run alone, after the commands posted before them.
+     * Unknown commands are left to other handlers.
+     */
+    if (!isGfnSdkCommand(command))
+    {
+        LOG(ERROR) << "Unknown command value: " << command;
+        return false;
+    }
+    if (s_responsesClosed)
+    {
+        LOG(ERROR) << "GFN SDK helper is shut down, dropping command: " << command;
+        return false;
+    }
+    CefRefPtr<GfnSdkQuery> query = new GfnSdkQuery(query_id, persistent, callback);
+    bool exclusive = (command == GFN_SDK_INIT || command == GFN_SDK_SHUTDOWN);
+    if (!s_workerPool.Post(std::bind(&runGfnSdkCommand, command, dict, query), exclusive))
+    {
+        LOG(ERROR) << "GFN SDK helper is shut down, dropping command: " << command;
+        return false;
+    }
+    s_queries[query_id] = query;
+    return true;
+}
+
+void GfnSdkHelperCancelQuery(int64 query_id)
+{
+    CEF_REQUIRE_UI_THREAD();
+
+    auto it = s_queries.find(query_id);
+    if (it != s_queries.end())
+    {
+        it->second->Cancel();
+        s_queries.erase(it);
+    }
+}
+
+namespace {
+
+// Shuts the GFN SDK down off the UI thread. The process waits for it when it exits; this object
+// is defined after the state the shutdown uses, so it is destroyed first.
+class GfnSdkShutdownThread {
+ public:
+  GfnSdkShutdownThread() {}
+  ~GfnSdkShutdownThread() {
+    if (thread_.joinable())
+      thread_.join();
+  }
+
+  void Start(const std::function<void()>& task) {
+    if (!thread_.joinable())
+      thread_ = std::thread(task);
+  }
+
+ private:
+  std::thread thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(GfnSdkShutdownThread);
+};
+
+GfnSdkShutdownThread s_shutdownThread;
+
+}  // namespace
+
+void GfnSdkHelperShutdown()
+{
+    CEF_REQUIRE_UI_THREAD();
+
+    for (auto& entry : s_queries)
+    {
+        entry.second->Cancel();
+    }
+    s_queries.clear();
+    setRegistration(&s_registerStreamStatusCallback, nullptr);
+    setRegistration(&s_registerNetworkStatusCallback, nullptr);
+    setRegistration(&s_registerClientInfoCallback, nullptr);
+    setRegistration(&s_registerMessageCallback, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(s_responseLock);
+        s_responsesClosed = true;
+    }
+
+    // Commands that already started finish first, and their responses are dropped. Without stream
+    // control, a running stream start can block for up to GFN_STREAM_START_TIMEOUT_MS, so the UI
+    // thread does not wait for it.
+    s_shutdownThread.Start([] {
+        s_workerPool.Stop();
+        shutdownGFN();
+    });
 }
 
 void HELPER_CALLBACK handleStreamStatusCallback(GfnStreamStatus status, void* context)
 {
-    if (s_registerStreamStatusCallback)
+    if (status == GfnStreamStatusDone || status == GfnStreamStatusError)
+    {
+        logStreamTimeline();
+    }
+    CefRefPtr<GfnSdkQuery> callback = getRegistration(&s_registerStreamStatusCallback);
+    if (callback)
     {
         CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
         response_dict->SetString("status", GfnStreamStatusToString(status));
 
         CefString response(DictToJson(response_dict));
-        s_registerStreamStatusCallback->Success(response);
+        callback->Success(response);
     }
 }
 
@@ -796,13 +1337,14 @@ void HELPER_CALLBACK handleNetworkStatusCallback(GfnNetworkStatusUpdateData* pNe
     {
         return;
     }
-    if (s_registerNetworkStatusCallback && pNetworkStatus->updateType == gfnRTDAverageLatency)
+    CefRefPtr<GfnSdkQuery> callback = getRegistration(&s_registerNetworkStatusCallback);
+    if (callback && pNetworkStatus->updateType == gfnRTDAverageLatency)
     {
         CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
         response_dict->SetInt("rtd", pNetworkStatus->data.RTDAverageLatencyMs);
 
         CefString response(DictToJson(response_dict));
-        s_registerNetworkStatusCallback->Success(response);
+        callback->Success(response);
     }
 }
 void HELPER_CALLBACK handleClientInfoCallback(GfnClientInfoUpdateData* pClientUpdate, void* context)
@@ -811,7 +1353,8 @@ void HELPER_CALLBACK handleClientInfoCallback(GfnClientInfoUpdateData* pClientUp
     {
         return;
     }
-    if (s_registerClientInfoCallback)
+    CefRefPtr<GfnSdkQuery> callback = getRegistration(&s_registerClientInfoCallback);
+    if (callback)
     {
         CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
         switch (pClientUpdate->updateType)
@@ -838,19 +1381,20 @@ void HELPER_CALLBACK handleClientInfoCallback(GfnClientInfoUpdateData* pClientUp
         }
 
         CefString response(DictToJson(response_dict));
-        s_registerClientInfoCallback->Success(response);
+        callback->Success(response);
     }
 }
 
 void HELPER_CALLBACK handleMessageCallback(GfnString* pStrData, void* context)
 {
-    if (s_registerMessageCallback)
+    CefRefPtr<GfnSdkQuery> callback = getRegistration(&s_registerMessageCallback);
+    if (callback)
     {
         CefRefPtr<CefDictionaryValue> response_dict = CefDictionaryValue::Create();
 
         response_dict->SetString("message", std::string(pStrData->pchString, pStrData->length));
 
         CefString response(DictToJson(response_dict));
-        s_registerMessageCallback->Success(response);
+        callback->Success(response);
     }
 }
@@ -38,4 +38,11 @@ bool GfnSdkHelper(CefRefPtr<CefBrowser> browser,
                   bool persistent,
                   CefRefPtr<CefMessageRouterBrowserSide::Callback> callback);
 
+// Cancels a query passed to GfnSdkHelper, whose response is then dropped. UI thread only.
+void GfnSdkHelperCancelQuery(int64 query_id);
+
+// Cancels all queries, and shuts down the GFN SDK on a background thread once the worker threads
+// finish. Returns without waiting; the process waits for the shutdown when it exits. UI thread only.
+void GfnSdkHelperShutdown();
+
 #endif
\ No newline at end of file
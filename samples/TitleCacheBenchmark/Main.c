@@ -0,0 +1,250 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2024 NVIDIA Corporation. All rights reserved.
+
+// Offline benchmark of the title set in GfnSdk_TitleCache. It builds a set from a list of 10000
+// platform application identifiers, like the one returned by GfnGetTitlesAvailable, and compares
+// lookups in the set against searching the list itself. In a GFN session, it also compares
+// GfnIsTitleAvailableCached against GfnIsTitleAvailable.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#ifndef _WIN32
+#   include <time.h>
+#endif
+
+#include "GfnSdk_TitleCache.h"
+#include "GfnSdk_Threading.h"
+
+#define BENCHMARK_TITLES 10000
+#define BENCHMARK_BUILD_RUNS 21
+#define BENCHMARK_SET_LOOKUPS 2000000
+#define BENCHMARK_LIST_LOOKUPS 20000
+#define BENCHMARK_SDK_LOOKUPS 2000
+#define BENCHMARK_ID_SIZE 32
+
+static uint64_t getTimeUs(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart * 1000000
+        + counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+#endif
+}
+
+static uint32_t nextRandom(uint32_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static int compareU64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// Identifiers in the formats used by the stores: numeric ones, and prefixed alphanumeric ones.
+// Even indices are in the list, odd indices are not.
+static void makeId(unsigned int index, char* id)
+{
+    static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    uint32_t state = 2463534242u + index * 2654435761u;
+    if (index % 4 < 2)
+    {
+        snprintf(id, BENCHMARK_ID_SIZE, "%u", 100000u + index * 7u);
+        return;
+    }
+    int length = snprintf(id, BENCHMARK_ID_SIZE, "%s:", (index % 8 < 4) ? "store" : "catalog");
+    for (int i = 0; i < 12; i++)
+    {
+        id[length++] = digits[nextRandom(&state) % 36];
+    }
+    id[length] = '\0';
+}
+
+// What a caller without the set does with the list: walk it for every lookup
+static bool listContains(const char* list, const char* id)
+{
+    size_t length = strlen(id);
+    const char* entry = list;
+    while (entry != NULL)
+    {
+        const char* end = strchr(entry, ',');
+        size_t entryLength = end ? (size_t)(end - entry) : strlen(entry);
+        if (entryLength == length && memcmp(entry, id, length) == 0)
+        {
+            return true;
+        }
+        entry = end ? end + 1 : NULL;
+    }
+    return false;
+}
+
+static void compareWithSdk(char (*ids)[BENCHMARK_ID_SIZE])
+{
+    bool isCloud = false;
+    if (GFNSDK_FAILED(GfnInitializeSdk(gfnDefaultLanguage)) || GfnIsRunningInCloud(&isCloud) != gfnSuccess || !isCloud)
+    {
+        printf("\nNot in a GFN session, skipping the comparison with GfnIsTitleAvailable\n");
+        GfnShutdownSdk();
+        return;
+    }
+
+    GfnTitleCacheConfig config = { 0 };
+    config.manualRefresh = true;
+    GfnRuntimeError err = GfnTitleCacheInitialize(&config);
+    GfnTitleCacheStats stats;
+    if (err != gfnSuccess || GfnTitleCacheGetStats(&stats) != gfnSuccess)
+    {
+        printf("\nFailed to fetch the available titles: %d, %s\n", err, GfnErrorToString(err));
+        GfnTitleCacheShutdown();
+        GfnShutdownSdk();
+        return;
+    }
+
+    unsigned int mismatches = 0;
+    uint64_t sdkUs = 0;
+    uint64_t cachedUs = 0;
+    for (unsigned int i = 0; i < BENCHMARK_SDK_LOOKUPS; i++)
+    {
+        bool available = false;
+        bool cached = false;
+        uint64_t start = getTimeUs();
+        GfnIsTitleAvailable(ids[i], &available);
+        sdkUs += getTimeUs() - start;
+        start = getTimeUs();
+        GfnIsTitleAvailableCached(ids[i], &cached);
+        cachedUs += getTimeUs() - start;
+        mismatches += (available != cached) ? 1 : 0;
+    }
+    printf("\nIn the GFN session: %u available titles, fetched and indexed in %llu ms\n", stats.numTitles,
+        (unsigned long long)stats.lastRefreshMs);
+    printf("%-36s %10.1f us\n", "GfnIsTitleAvailable", (double)sdkUs / BENCHMARK_SDK_LOOKUPS);
+    printf("%-36s %10.3f us  (%u different answers)\n", "GfnIsTitleAvailableCached", (double)cachedUs / BENCHMARK_SDK_LOOKUPS, mismatches);
+    GfnTitleCacheShutdown();
+    GfnShutdownSdk();
+}
+
+int main(void)
+{
+    // Identifiers 2 * i are in the list, 2 * i + 1 are not
+    char (*ids)[BENCHMARK_ID_SIZE] = malloc(2 * BENCHMARK_TITLES * sizeof(*ids));
+    char* list = malloc((size_t)BENCHMARK_TITLES * BENCHMARK_ID_SIZE);
+    unsigned int* queries = malloc(BENCHMARK_SET_LOOKUPS * sizeof(unsigned int));
+    if (ids == NULL || list == NULL || queries == NULL)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+    size_t listLength = 0;
+    for (unsigned int i = 0; i < 2 * BENCHMARK_TITLES; i++)
+    {
+        makeId(i, ids[i]);
+        if (i % 2 == 0)
+        {
+            listLength += (size_t)sprintf(list + listLength, "%s%s", listLength ? "," : "", ids[i]);
+        }
+    }
+    uint32_t state = 88172645u;
+    for (unsigned int i = 0; i < BENCHMARK_SET_LOOKUPS; i++)
+    {
+        queries[i] = nextRandom(&state) % (2 * BENCHMARK_TITLES);
+    }
+    printf("Title set benchmark: %u titles, %zu KB list, half of the lookups miss\n\n", BENCHMARK_TITLES, listLength / 1024);
+
+    // Building the set, as done by every refresh
+    uint64_t buildUs[BENCHMARK_BUILD_RUNS];
+    GfnTitleSet* set = NULL;
+    for (unsigned int run = 0; run < BENCHMARK_BUILD_RUNS; run++)
+    {
+        GfnTitleSetDestroy(set);
+        uint64_t start = getTimeUs();
+        if (GfnTitleSetCreate(list, &set) != gfnSuccess)
+        {
+            printf("Failed to build the set\n");
+            return 1;
+        }
+        buildUs[run] = getTimeUs() - start;
+    }
+    qsort(buildUs, BENCHMARK_BUILD_RUNS, sizeof(uint64_t), compareU64);
+    printf("%-36s %10.1f us  (min %.1f us)\n", "building the set", (double)buildUs[BENCHMARK_BUILD_RUNS / 2], (double)buildUs[0]);
+
+    // Every identifier must be found or not found as expected
+    unsigned int errors = GfnTitleSetGetCount(set) == BENCHMARK_TITLES ? 0 : 1;
+    for (unsigned int i = 0; i < 2 * BENCHMARK_TITLES; i++)
+    {
+        errors += (GfnTitleSetContains(set, ids[i]) != (i % 2 == 0)) ? 1 : 0;
+        errors += (i < BENCHMARK_LIST_LOOKUPS / 4 && listContains(list, ids[i]) != (i % 2 == 0)) ? 1 : 0;
+    }
+    if (errors != 0)
+    {
+        printf("%u wrong answers\n", errors);
+        return 1;
+    }
+
+    unsigned int found = 0;
+    uint64_t start = getTimeUs();
+    for (unsigned int i = 0; i < BENCHMARK_SET_LOOKUPS; i++)
+    {
+        found += GfnTitleSetContains(set, ids[queries[i]]) ? 1 : 0;
+    }
+    uint64_t setUs = getTimeUs() - start;
+
+    start = getTimeUs();
+    for (unsigned int i = 0; i < BENCHMARK_LIST_LOOKUPS; i++)
+    {
+        found += listContains(list, ids[queries[i]]) ? 1 : 0;
+    }
+    uint64_t listUs = getTimeUs() - start;
+
+    double setNs = (double)setUs * 1000.0 / BENCHMARK_SET_LOOKUPS;
+    double listNs = (double)listUs * 1000.0 / BENCHMARK_LIST_LOOKUPS;
+    printf("%-36s %10.1f ns\n", "lookup in the set", setNs);
+    printf("%-36s %10.1f ns\n", "lookup by searching the list", listNs);
+    printf("%-36s %10.1fx  (%u found)\n", "speedup", listNs / (setNs > 0.0 ? setNs : 1.0), found);
+    GfnTitleSetDestroy(set);
+
+    compareWithSdk(ids);
+
+    free(queries);
+    free(list);
+    free(ids);
+    return 0;
+}
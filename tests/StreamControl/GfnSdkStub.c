@@ -0,0 +1,216 @@
+// Stub of the client library entry points used by stream control, see GfnSdkStub.h
+
+#include "GfnSdkStub.h"
+#include "GfnSdk_StreamTimeline.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define GFN_STUB_MAX_REQUESTS 64
+#define GFN_STUB_MAX_LOG 256
+
+typedef struct gfnStubRequest
+{
+    bool start;
+    StartStreamCallbackSig startCb;
+    StopStreamCallbackSig stopCb;
+    void* context;
+    uint32_t delayMs;
+    unsigned int timeoutMs;
+} gfnStubRequest;
+
+typedef struct gfnStubState
+{
+    bool syncReady;
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+    uint32_t startDelayMs;
+    uint32_t stopDelayMs;
+    unsigned int inProgress;
+    unsigned int overlaps;
+    GfnSdkThread threads[GFN_STUB_MAX_REQUESTS];
+    unsigned int threadCount;
+    char log[GFN_STUB_MAX_LOG];
+    size_t logLength;
+} gfnStubState;
+
+static gfnStubState s_gfnStub;
+
+// Called with the lock held
+static void gfnStubLog(char entry)
+{
+    if (s_gfnStub.logLength + 1 < GFN_STUB_MAX_LOG)
+    {
+        s_gfnStub.log[s_gfnStub.logLength++] = entry;
+        s_gfnStub.log[s_gfnStub.logLength] = '\0';
+    }
+    gfnSdkCondBroadcast(&s_gfnStub.cond);
+}
+
+static void gfnStubRequestThread(void* pContext)
+{
+    gfnStubRequest* pRequest = (gfnStubRequest*)pContext;
+    GfnRuntimeError result = gfnSuccess;
+    StartStreamResponse response;
+
+    if (pRequest->start && pRequest->delayMs > pRequest->timeoutMs)
+    {
+        gfnSdkSleepMs(pRequest->timeoutMs);
+        result = gfnTimedOut;
+    }
+    else
+    {
+        gfnSdkSleepMs(pRequest->delayMs);
+    }
+
+    // Log completion before calling back, the callback may already issue the next request
+    gfnSdkMutexLock(&s_gfnStub.lock);
+    gfnStubLog(pRequest->start ? (result == gfnSuccess ? 'S' : 'T') : 'P');
+    s_gfnStub.inProgress--;
+    gfnSdkMutexUnlock(&s_gfnStub.lock);
+
+    if (pRequest->start)
+    {
+        memset(&response, 0, sizeof(response));
+        response.downloaded = true;
+        pRequest->startCb(result, &response, pRequest->context);
+    }
+    else
+    {
+        pRequest->stopCb(result, pRequest->context);
+    }
+    free(pRequest);
+}
+
+static GfnRuntimeError gfnStubIssue(gfnStubRequest* pRequest)
+{
+    gfnSdkMutexLock(&s_gfnStub.lock);
+    if (s_gfnStub.threadCount == GFN_STUB_MAX_REQUESTS)
+    {
+        gfnSdkMutexUnlock(&s_gfnStub.lock);
+        free(pRequest);
+        return gfnUnableToAllocateMemory;
+    }
+    if (s_gfnStub.inProgress > 0)
+    {
+        s_gfnStub.overlaps++;
+    }
+    s_gfnStub.inProgress++;
+    pRequest->delayMs = pRequest->start ? s_gfnStub.startDelayMs : s_gfnStub.stopDelayMs;
+    gfnStubLog(pRequest->start ? 's' : 'p');
+    if (!gfnSdkThreadCreate(&s_gfnStub.threads[s_gfnStub.threadCount], gfnStubRequestThread, pRequest))
+    {
+        s_gfnStub.inProgress--;
+        gfnSdkMutexUnlock(&s_gfnStub.lock);
+        free(pRequest);
+        return gfnUnableToAllocateMemory;
+    }
+    s_gfnStub.threadCount++;
+    gfnSdkMutexUnlock(&s_gfnStub.lock);
+    return gfnSuccess;
+}
+
+void GfnStubReset(uint32_t startDelayMs, uint32_t stopDelayMs)
+{
+    unsigned int i = 0;
+
+    if (!s_gfnStub.syncReady)
+    {
+        gfnSdkMutexInit(&s_gfnStub.lock);
+        gfnSdkCondInit(&s_gfnStub.cond);
+        s_gfnStub.syncReady = true;
+    }
+
+    for (i = 0; i < s_gfnStub.threadCount; i++)
+    {
+        gfnSdkThreadJoin(s_gfnStub.threads[i]);
+    }
+    gfnSdkMutexLock(&s_gfnStub.lock);
+    s_gfnStub.threadCount = 0;
+    s_gfnStub.startDelayMs = startDelayMs;
+    s_gfnStub.stopDelayMs = stopDelayMs;
+    s_gfnStub.overlaps = 0;
+    s_gfnStub.log[0] = '\0';
+    s_gfnStub.logLength = 0;
+    gfnSdkMutexUnlock(&s_gfnStub.lock);
+}
+
+bool GfnStubWaitLog(const char* expected, uint32_t timeoutMs)
+{
+    uint64_t deadlineMs = gfnSdkGetTimeMs() + timeoutMs;
+    uint64_t nowMs = 0;
+    bool equal = false;
+
+    gfnSdkMutexLock(&s_gfnStub.lock);
+    while (s_gfnStub.logLength < strlen(expected))
+    {
+        nowMs = gfnSdkGetTimeMs();
+        if (nowMs >= deadlineMs)
+        {
+            break;
+        }
+        gfnSdkCondTimedWait(&s_gfnStub.cond, &s_gfnStub.lock, (uint32_t)(deadlineMs - nowMs));
+    }
+    equal = strcmp(s_gfnStub.log, expected) == 0;
+    gfnSdkMutexUnlock(&s_gfnStub.lock);
+    return equal;
+}
+
+void GfnStubGetLog(char* pchLog, size_t size)
+{
+    gfnSdkMutexLock(&s_gfnStub.lock);
+    strncpy(pchLog, s_gfnStub.log, size - 1);
+    pchLog[size - 1] = '\0';
+    gfnSdkMutexUnlock(&s_gfnStub.lock);
+}
+
+unsigned int GfnStubGetOverlaps(void)
+{
+    unsigned int overlaps = 0;
+
+    gfnSdkMutexLock(&s_gfnStub.lock);
+    overlaps = s_gfnStub.overlaps;
+    gfnSdkMutexUnlock(&s_gfnStub.lock);
+    return overlaps;
+}
+
+GfnRuntimeError GfnStartStreamAsync(const StartStreamInput* startStreamInput, StartStreamCallbackSig cb, void* context, unsigned int timeoutMs)
+{
+    gfnStubRequest* pRequest = (gfnStubRequest*)calloc(1, sizeof(gfnStubRequest));
+
+    (void)startStreamInput;
+    if (pRequest == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    pRequest->start = true;
+    pRequest->startCb = cb;
+    pRequest->context = context;
+    pRequest->timeoutMs = timeoutMs;
+    return gfnStubIssue(pRequest);
+}
+
+GfnRuntimeError GfnStopStreamAsync(StopStreamCallbackSig cb, void* context, unsigned int timeoutMs)
+{
+    gfnStubRequest* pRequest = (gfnStubRequest*)calloc(1, sizeof(gfnStubRequest));
+
+    if (pRequest == NULL)
+    {
+        return gfnUnableToAllocateMemory;
+    }
+    pRequest->stopCb = cb;
+    pRequest->context = context;
+    pRequest->timeoutMs = timeoutMs;
+    return gfnStubIssue(pRequest);
+}
+
+// The stream timeline is not initialized, so stream control falls back to GfnStartStreamAsync
+GfnRuntimeError GfnStartStreamAsyncTracked(const StartStreamInput* startStreamInput, StartStreamCallbackSig cb, void* context, unsigned int timeoutMs)
+{
+    (void)startStreamInput;
+    (void)cb;
+    (void)context;
+    (void)timeoutMs;
+    return gfnAPINotInit;
+}
@@ -0,0 +1,41 @@
+// Stub of the client library entry points used by stream control (GfnSdk_StreamControl.h).
+//
+// Starts and stops complete on a thread of their own after an injected delay. A start whose
+// delay exceeds its timeout completes with gfnTimedOut when the timeout expires. Every request
+// and completion is appended to a log:
+//
+// - 's' start issued, 'S' start succeeded, 'T' start timed out
+// - 'p' stop issued, 'P' stop completed
+//
+// The stub also counts requests issued while another one was still in progress, which stream
+// control must never do.
+
+#ifndef __GFN_SDK_STUB_H__
+#define __GFN_SDK_STUB_H__
+
+#include "GfnRuntimeSdk_Wrapper.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Waits for every request in progress to complete, clears the log and sets the delays
+void GfnStubReset(uint32_t startDelayMs, uint32_t stopDelayMs);
+
+/// @brief Waits until the log holds at least as many entries as expected, for at most timeoutMs.
+/// Returns true if the log then equals expected.
+bool GfnStubWaitLog(const char* expected, uint32_t timeoutMs);
+
+/// @brief Copies the log to pchLog, NUL-terminated
+void GfnStubGetLog(char* pchLog, size_t size);
+
+/// @brief Returns the number of requests issued while another request was in progress
+unsigned int GfnStubGetOverlaps(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __GFN_SDK_STUB_H__
@@ -0,0 +1,334 @@
+// State machine tests of stream control (GfnSdk_StreamControl.h) against the stub client library.
+//
+// Usage: GfnSdkStreamControlTest <case>
+// Each case initializes stream control, drives it with injected start and stop delays, checks the
+// requests that reached the stub, the callback results and their order, and the counters, then
+// shuts it down. Returns 0 if every check passed.
+
+#include "GfnSdkStub.h"
+#include "GfnSdk_StreamControl.h"
+#include "GfnSdk_Threading.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define GFN_TEST_MAX_CALLBACKS 16
+#define GFN_TEST_WAIT_MS 5000
+#define GFN_TEST_TIMEOUT_MS 10000
+
+#define GFN_TEST_CHECK(condition) gfnTestCheck((condition), #condition, __LINE__)
+
+typedef struct gfnTestState
+{
+    GfnSdkMutex lock;
+    GfnSdkCondVar cond;
+    GfnRuntimeError results[GFN_TEST_MAX_CALLBACKS];
+    char order[GFN_TEST_MAX_CALLBACKS + 1];   // Ids of the completed callbacks, in completion order
+    unsigned int count;
+    unsigned int failures;
+} gfnTestState;
+
+static gfnTestState s_gfnTest;
+
+static void gfnTestCheck(bool passed, const char* pchCondition, int line)
+{
+    char log[256];
+
+    if (!passed)
+    {
+        GfnStubGetLog(log, sizeof(log));
+        printf("Main.c:%d: check failed: %s (stub log \"%s\", callbacks \"%s\")\n", line, pchCondition, log, s_gfnTest.order);
+        s_gfnTest.failures++;
+    }
+}
+
+static void gfnTestRecord(GfnRuntimeError result, void* context)
+{
+    unsigned int id = (unsigned int)(size_t)context;
+
+    gfnSdkMutexLock(&s_gfnTest.lock);
+    if (id < GFN_TEST_MAX_CALLBACKS && s_gfnTest.count < GFN_TEST_MAX_CALLBACKS)
+    {
+        s_gfnTest.results[id] = result;
+        s_gfnTest.order[s_gfnTest.count++] = (char)('0' + id);
+    }
+    gfnSdkCondBroadcast(&s_gfnTest.cond);
+    gfnSdkMutexUnlock(&s_gfnTest.lock);
+}
+
+static void GFN_CALLBACK gfnTestStartDone(GfnRuntimeError result, StartStreamResponse* response, void* context)
+{
+    (void)response;
+    gfnTestRecord(result, context);
+}
+
+static void GFN_CALLBACK gfnTestStopDone(GfnRuntimeError result, void* context)
+{
+    gfnTestRecord(result, context);
+}
+
+// Waits until count callbacks completed, and returns their ids in completion order
+static const char* gfnTestWaitCallbacks(unsigned int count)
+{
+    uint64_t deadlineMs = gfnSdkGetTimeMs() + GFN_TEST_WAIT_MS;
+    uint64_t nowMs = 0;
+
+    gfnSdkMutexLock(&s_gfnTest.lock);
+    while (s_gfnTest.count < count)
+    {
+        nowMs = gfnSdkGetTimeMs();
+        if (nowMs >= deadlineMs)
+        {
+            break;
+        }
+        gfnSdkCondTimedWait(&s_gfnTest.cond, &s_gfnTest.lock, (uint32_t)(deadlineMs - nowMs));
+    }
+    gfnSdkMutexUnlock(&s_gfnTest.lock);
+    return s_gfnTest.order;
+}
+
+static void gfnTestBegin(uint32_t startDelayMs, uint32_t stopDelayMs)
+{
+    gfnSdkMutexInit(&s_gfnTest.lock);
+    gfnSdkCondInit(&s_gfnTest.cond);
+    GfnStubReset(startDelayMs, stopDelayMs);
+    GFN_TEST_CHECK(GfnStreamControlInitialize() == gfnSuccess);
+}
+
+static void gfnTestEnd(void)
+{
+    GfnStreamControlShutdown();
+    GfnStubReset(0, 0);
+    GFN_TEST_CHECK(GfnStubGetOverlaps() == 0);
+}
+
+static GfnStreamControlStats gfnTestStats(void)
+{
+    GfnStreamControlStats stats;
+
+    memset(&stats, 0, sizeof(stats));
+    GFN_TEST_CHECK(GfnStreamControlGetStats(&stats) == gfnSuccess);
+    return stats;
+}
+
+// A double click joins the start in progress; a start with other partner data does not
+static void gfnTestCoalesce(void)
+{
+    StartStreamInput input = { 100, "partner", NULL };
+    StartStreamInput other = { 100, "other", NULL };
+    GfnStartStreamHandle handle1 = 0;
+    GfnStartStreamHandle handle2 = 0;
+    GfnStreamControlStats stats;
+
+    gfnTestBegin(100, 50);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)1, GFN_TEST_TIMEOUT_MS, &handle1) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)2, GFN_TEST_TIMEOUT_MS, &handle2) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&other, gfnTestStartDone, (void*)3, GFN_TEST_TIMEOUT_MS, NULL) == gfnSuccess);
+    GFN_TEST_CHECK(handle1 != 0 && handle2 != 0 && handle1 != handle2);
+
+    GFN_TEST_CHECK(strcmp(gfnTestWaitCallbacks(3), "123") == 0);
+    GFN_TEST_CHECK(GfnStubWaitLog("sSsS", GFN_TEST_WAIT_MS));
+    GFN_TEST_CHECK(s_gfnTest.results[1] == gfnSuccess && s_gfnTest.results[2] == gfnSuccess && s_gfnTest.results[3] == gfnSuccess);
+    stats = gfnTestStats();
+    GFN_TEST_CHECK(stats.startsRequested == 3 && stats.startsIssued == 2 && stats.startsCoalesced == 1);
+    gfnTestEnd();
+}
+
+// A start canceled while it waits behind a stop is never issued
+static void gfnTestCancelQueued(void)
+{
+    StartStreamInput input = { 100, NULL, NULL };
+    GfnStartStreamHandle handle = 0;
+    GfnStreamControlStats stats;
+
+    gfnTestBegin(100, 100);
+    GFN_TEST_CHECK(GfnStopStreamSequenced(gfnTestStopDone, (void*)1, GFN_TEST_TIMEOUT_MS) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)2, GFN_TEST_TIMEOUT_MS, &handle) == gfnSuccess);
+    GFN_TEST_CHECK(GfnCancelStartStream(handle) == gfnSuccess);
+    GFN_TEST_CHECK(GfnCancelStartStream(handle) == gfnInvalidParameter);
+
+    GFN_TEST_CHECK(strcmp(gfnTestWaitCallbacks(2), "21") == 0);
+    GFN_TEST_CHECK(s_gfnTest.results[2] == gfnCanceled && s_gfnTest.results[1] == gfnSuccess);
+    gfnSdkSleepMs(200);
+    GFN_TEST_CHECK(GfnStubWaitLog("pP", 0));
+    stats = gfnTestStats();
+    GFN_TEST_CHECK(stats.startsIssued == 0 && stats.startsCanceled == 1 && stats.startsSequenced == 1);
+    gfnTestEnd();
+}
+
+// A start canceled while the SDK runs it completes right away, and the stream it then opens is
+// stopped again
+static void gfnTestCancelInFlight(void)
+{
+    StartStreamInput input = { 100, NULL, NULL };
+    GfnStartStreamHandle handle = 0;
+    GfnStreamControlStats stats;
+
+    gfnTestBegin(200, 50);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)1, GFN_TEST_TIMEOUT_MS, &handle) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStubWaitLog("s", GFN_TEST_WAIT_MS));
+    GFN_TEST_CHECK(GfnCancelStartStream(handle) == gfnSuccess);
+
+    // The callback does not wait for the SDK
+    GFN_TEST_CHECK(strcmp(gfnTestWaitCallbacks(1), "1") == 0);
+    GFN_TEST_CHECK(s_gfnTest.results[1] == gfnCanceled);
+    GFN_TEST_CHECK(GfnStubWaitLog("s", 0));
+
+    GFN_TEST_CHECK(GfnStubWaitLog("sSpP", GFN_TEST_WAIT_MS));
+    stats = gfnTestStats();
+    GFN_TEST_CHECK(stats.startsIssued == 1 && stats.startsCanceled == 1 && stats.streamsAbandoned == 1 && stats.stopsIssued == 1);
+    gfnTestEnd();
+}
+
+// A stop requested while a start runs is issued once the start completes
+static void gfnTestStopAfterStart(void)
+{
+    StartStreamInput input = { 100, NULL, NULL };
+    GfnStreamControlStats stats;
+
+    gfnTestBegin(150, 50);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)1, GFN_TEST_TIMEOUT_MS, NULL) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStubWaitLog("s", GFN_TEST_WAIT_MS));
+    GFN_TEST_CHECK(GfnStopStreamSequenced(gfnTestStopDone, (void*)2, GFN_TEST_TIMEOUT_MS) == gfnSuccess);
+    // A second stop joins the queued one
+    GFN_TEST_CHECK(GfnStopStreamSequenced(gfnTestStopDone, (void*)3, GFN_TEST_TIMEOUT_MS) == gfnSuccess);
+
+    GFN_TEST_CHECK(strcmp(gfnTestWaitCallbacks(3), "123") == 0);
+    GFN_TEST_CHECK(GfnStubWaitLog("sSpP", GFN_TEST_WAIT_MS));
+    stats = gfnTestStats();
+    GFN_TEST_CHECK(stats.startsIssued == 1 && stats.stopsIssued == 1 && stats.streamsAbandoned == 0);
+    gfnTestEnd();
+}
+
+// A start requested behind a stop waits for it; starts queued when a stop is requested are canceled
+static void gfnTestStartAfterStop(void)
+{
+    StartStreamInput input = { 100, NULL, NULL };
+    GfnStreamControlStats stats;
+
+    gfnTestBegin(50, 150);
+    GFN_TEST_CHECK(GfnStopStreamSequenced(gfnTestStopDone, (void*)1, GFN_TEST_TIMEOUT_MS) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStubWaitLog("p", GFN_TEST_WAIT_MS));
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)2, GFN_TEST_TIMEOUT_MS, NULL) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStopStreamSequenced(gfnTestStopDone, (void*)3, GFN_TEST_TIMEOUT_MS) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)4, GFN_TEST_TIMEOUT_MS, NULL) == gfnSuccess);
+
+    GFN_TEST_CHECK(strcmp(gfnTestWaitCallbacks(4), "2134") == 0);
+    GFN_TEST_CHECK(s_gfnTest.results[2] == gfnCanceled && s_gfnTest.results[4] == gfnSuccess);
+    GFN_TEST_CHECK(GfnStubWaitLog("pPpPsS", GFN_TEST_WAIT_MS));
+    stats = gfnTestStats();
+    GFN_TEST_CHECK(stats.startsIssued == 1 && stats.startsCanceled == 1 && stats.startsSequenced == 2 && stats.stopsIssued == 2);
+    gfnTestEnd();
+}
+
+// A start that times out reports it, is not stopped even when abandoned, and does not hold up
+// the next request
+static void gfnTestTimeout(void)
+{
+    StartStreamInput input = { 100, NULL, NULL };
+    StartStreamInput other = { 200, NULL, NULL };
+    GfnStartStreamHandle handle = 0;
+    GfnStreamControlStats stats;
+
+    gfnTestBegin(200, 50);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)1, 50, NULL) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&other, gfnTestStartDone, (void*)2, GFN_TEST_TIMEOUT_MS, NULL) == gfnSuccess);
+    GFN_TEST_CHECK(strcmp(gfnTestWaitCallbacks(2), "12") == 0);
+    GFN_TEST_CHECK(s_gfnTest.results[1] == gfnTimedOut && s_gfnTest.results[2] == gfnSuccess);
+    GFN_TEST_CHECK(GfnStubWaitLog("sTsS", GFN_TEST_WAIT_MS));
+
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)3, 50, &handle) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStubWaitLog("sTsSs", GFN_TEST_WAIT_MS));
+    GFN_TEST_CHECK(GfnCancelStartStream(handle) == gfnSuccess);
+    GFN_TEST_CHECK(strcmp(gfnTestWaitCallbacks(3), "123") == 0);
+    GFN_TEST_CHECK(GfnStubWaitLog("sTsSsT", GFN_TEST_WAIT_MS));
+    gfnSdkSleepMs(100);
+    GFN_TEST_CHECK(GfnStubWaitLog("sTsSsT", 0));
+    stats = gfnTestStats();
+    GFN_TEST_CHECK(stats.startsIssued == 3 && stats.streamsAbandoned == 0 && stats.stopsIssued == 0);
+    gfnTestEnd();
+}
+
+// Shutdown waits for the request in progress and cancels the queued ones before it returns
+static void gfnTestShutdown(void)
+{
+    StartStreamInput input = { 100, NULL, NULL };
+
+    gfnTestBegin(150, 50);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)1, GFN_TEST_TIMEOUT_MS, NULL) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStubWaitLog("s", GFN_TEST_WAIT_MS));
+    GFN_TEST_CHECK(GfnStopStreamSequenced(gfnTestStopDone, (void*)2, GFN_TEST_TIMEOUT_MS) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)3, GFN_TEST_TIMEOUT_MS, NULL) == gfnSuccess);
+
+    GfnStreamControlShutdown();
+    GFN_TEST_CHECK(s_gfnTest.count == 3);
+    GFN_TEST_CHECK(s_gfnTest.results[1] == gfnSuccess && s_gfnTest.results[2] == gfnCanceled && s_gfnTest.results[3] == gfnCanceled);
+    GFN_TEST_CHECK(GfnStubWaitLog("sS", 0));
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)4, GFN_TEST_TIMEOUT_MS, NULL) == gfnAPINotInit);
+    gfnTestEnd();
+}
+
+// Shutdown gives up on a request the SDK does not complete in time, and ignores its completion
+static void gfnTestShutdownDeadline(void)
+{
+    StartStreamInput input = { 100, NULL, NULL };
+    uint64_t startMs = 0;
+    uint64_t elapsedMs = 0;
+
+    gfnTestBegin(GFN_STREAM_CONTROL_SHUTDOWN_WAIT_MS + 500, 50);
+    GFN_TEST_CHECK(GfnStartStreamCancellable(&input, gfnTestStartDone, (void*)1, GFN_TEST_TIMEOUT_MS, NULL) == gfnSuccess);
+    GFN_TEST_CHECK(GfnStubWaitLog("s", GFN_TEST_WAIT_MS));
+
+    startMs = gfnSdkGetTimeMs();
+    GfnStreamControlShutdown();
+    elapsedMs = gfnSdkGetTimeMs() - startMs;
+    GFN_TEST_CHECK(elapsedMs >= GFN_STREAM_CONTROL_SHUTDOWN_WAIT_MS - 50 && elapsedMs < GFN_STREAM_CONTROL_SHUTDOWN_WAIT_MS + 400);
+    GFN_TEST_CHECK(s_gfnTest.count == 1 && s_gfnTest.results[1] == gfnCanceled);
+
+    // Stream control can be initialized again while the SDK still holds the abandoned start
+    GFN_TEST_CHECK(GfnStreamControlInitialize() == gfnSuccess);
+    GFN_TEST_CHECK(GfnStubWaitLog("sS", GFN_TEST_WAIT_MS));
+    gfnSdkSleepMs(50);
+    GFN_TEST_CHECK(s_gfnTest.count == 1);
+    gfnTestEnd();
+}
+
+typedef struct gfnTestCase
+{
+    const char* pchName;
+    void (*fnTest)(void);
+} gfnTestCase;
+
+static const gfnTestCase s_gfnTestCases[] =
+{
+    { "Coalesce", gfnTestCoalesce },
+    { "CancelQueued", gfnTestCancelQueued },
+    { "CancelInFlight", gfnTestCancelInFlight },
+    { "StopAfterStart", gfnTestStopAfterStart },
+    { "StartAfterStop", gfnTestStartAfterStop },
+    { "Timeout", gfnTestTimeout },
+    { "Shutdown", gfnTestShutdown },
+    { "ShutdownDeadline", gfnTestShutdownDeadline },
+};
+
+int main(int argc, char* argv[])
+{
+    size_t i = 0;
+
+    if (argc != 2)
+    {
+        printf("Usage: %s <case>\n", argv[0]);
+        return 2;
+    }
+    for (i = 0; i < sizeof(s_gfnTestCases) / sizeof(s_gfnTestCases[0]); i++)
+    {
+        if (strcmp(argv[1], s_gfnTestCases[i].pchName) == 0)
+        {
+            s_gfnTestCases[i].fnTest();
+            printf("%s: %s\n", argv[1], s_gfnTest.failures == 0 ? "passed" : "FAILED");
+            return s_gfnTest.failures == 0 ? 0 : 1;
+        }
+    }
+    printf("Unknown case: %s\n", argv[1]);
+    return 2;
+}